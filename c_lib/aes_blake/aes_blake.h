@@ -0,0 +1,592 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_H
+#define AES_BLAKE_H
+
+#include "aes_blake_types.h"
+#include "aes_blake_pool.h"
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    /*
+     * Number of AES round keys derived per block (AES_BLAKE_ROUNDS in the Python reference).
+     * Override at compile time with -DAES_BLAKE_ROUNDS=<n>, which changes all outputs.
+     */
+    #ifndef AES_BLAKE_ROUNDS
+    #define AES_BLAKE_ROUNDS 11
+    #endif
+
+    #define AES_BLAKE256_KEY_BYTES      32
+    #define AES_BLAKE256_NONCE_BYTES    32
+    #define AES_BLAKE256_CONTEXT_BYTES  64
+    #define AES_BLAKE256_GROUP_BYTES    32
+    #define AES_BLAKE256_TAG_BYTES      32
+
+    #define AES_BLAKE512_KEY_BYTES      64
+    #define AES_BLAKE512_NONCE_BYTES    64
+    #define AES_BLAKE512_CONTEXT_BYTES  128
+    #define AES_BLAKE512_GROUP_BYTES    64
+    #define AES_BLAKE512_TAG_BYTES      64
+
+    #if defined(__cplusplus)
+    #define AES_BLAKE_CACHE_ALIGNED alignas(64)
+    #elif defined(_MSC_VER)
+    #define AES_BLAKE_CACHE_ALIGNED __declspec(align(64))
+    #else
+    #define AES_BLAKE_CACHE_ALIGNED _Alignas(64)
+    #endif
+
+
+    /*
+     * Reusable key object of AES-Blake256 holding the digested cipher context.
+     * It is cache-line aligned and read-only after aes_blake256_key_init, so
+     * many threads may share it. All fields are private to the library.
+     */
+    typedef struct {
+        AES_BLAKE_CACHE_ALIGNED uint32_t init_state[16];
+        uint32_t key_words[8];
+    } AESBlake256Key;
+
+    /*
+     * Reusable key object of AES-Blake512, see AESBlake256Key.
+     */
+    typedef struct {
+        AES_BLAKE_CACHE_ALIGNED uint64_t init_state[16];
+        uint64_t key_words[8];
+    } AESBlake512Key;
+
+    /*
+     * Streaming state of one AES-Blake256 message. Its memory use does not depend
+     * on the message size. All fields are private to the library, `scratch` is
+     * set when the context lives in an arena, see aes_blake256_ctx_init_arena.
+     */
+    typedef struct {
+        uint32_t init_state[16];
+        uint32_t knc[16];
+        uint64_t block_counter;
+        uint8_t checksums[AES_BLAKE256_GROUP_BYTES];
+        uint8_t header_checksums[AES_BLAKE256_GROUP_BYTES];
+        uint8_t partial[AES_BLAKE256_GROUP_BYTES];
+        size_t partial_len;
+        int phase;
+        int mode;
+        void *scratch;
+    } AESBlake256Ctx;
+
+    /*
+     * Streaming state of one AES-Blake512 message, see AESBlake256Ctx.
+     */
+    typedef struct {
+        uint64_t init_state[16];
+        uint64_t knc[16];
+        uint64_t block_counter;
+        uint8_t checksums[AES_BLAKE512_GROUP_BYTES];
+        uint8_t header_checksums[AES_BLAKE512_GROUP_BYTES];
+        uint8_t partial[AES_BLAKE512_GROUP_BYTES];
+        size_t partial_len;
+        int phase;
+        int mode;
+        void *scratch;
+    } AESBlake512Ctx;
+
+
+    /*
+     * One message of a batch call. `auth_tag` is written by the encrypt and read
+     * by the decrypt batch functions, and `status` receives the message result.
+     */
+    typedef struct {
+        const uint8_t *nonce;
+        const uint8_t *input;
+        size_t input_len;
+        const uint8_t *header;
+        size_t header_len;
+        uint8_t *output;
+        uint8_t *auth_tag;
+        AESBlakeStatus status;
+    } AESBlakeMessage;
+
+
+    /* --- AES-Blake256 --- */
+    AESBlakeStatus aes_blake256_encrypt(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    void aes_blake256_key_init(
+        AESBlake256Key *key_obj,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES]
+    );
+
+    void aes_blake256_key_wipe(AESBlake256Key *key_obj);
+
+    AESBlakeStatus aes_blake256_encrypt_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_verify(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_verify_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_verified(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_verified_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_encrypt_batch(
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_batch(
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake256_encrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_encrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_reencrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *old_key_obj,
+        const uint8_t old_nonce[AES_BLAKE256_NONCE_BYTES],
+        const AESBlake256Key *new_key_obj,
+        const uint8_t new_nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t new_ciphertext[],
+        uint8_t new_auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    void aes_blake256_ctx_init(
+        AESBlake256Ctx *ctx,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES]
+    );
+
+    void aes_blake256_ctx_init_with_key(
+        AESBlake256Ctx *ctx,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES]
+    );
+
+    size_t aes_blake256_ctx_size(void);
+
+    AESBlake256Ctx *aes_blake256_ctx_init_arena(
+        void *arena,
+        size_t arena_len,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_ctx_encrypt_update(
+        AESBlake256Ctx *ctx,
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        uint8_t ciphertext[],
+        size_t *ciphertext_len
+    );
+
+    AESBlakeStatus aes_blake256_ctx_decrypt_update(
+        AESBlake256Ctx *ctx,
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        uint8_t plaintext[],
+        size_t *plaintext_len
+    );
+
+    AESBlakeStatus aes_blake256_ctx_update_header(
+        AESBlake256Ctx *ctx,
+        const uint8_t header[],
+        size_t header_len
+    );
+
+    AESBlakeStatus aes_blake256_ctx_encrypt_final(
+        AESBlake256Ctx *ctx,
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_ctx_decrypt_final(
+        AESBlake256Ctx *ctx,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+
+    /* --- AES-Blake512 --- */
+    AESBlakeStatus aes_blake512_encrypt(
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt(
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    void aes_blake512_key_init(
+        AESBlake512Key *key_obj,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES]
+    );
+
+    void aes_blake512_key_wipe(AESBlake512Key *key_obj);
+
+    AESBlakeStatus aes_blake512_encrypt_with_key(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_with_key(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_verify(
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_verify_with_key(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_verified(
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_verified_with_key(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_encrypt_batch(
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_batch(
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake512_encrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_encrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_reencrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake512Key *old_key_obj,
+        const uint8_t old_nonce[AES_BLAKE512_NONCE_BYTES],
+        const AESBlake512Key *new_key_obj,
+        const uint8_t new_nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t new_ciphertext[],
+        uint8_t new_auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    void aes_blake512_ctx_init(
+        AESBlake512Ctx *ctx,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES]
+    );
+
+    void aes_blake512_ctx_init_with_key(
+        AESBlake512Ctx *ctx,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES]
+    );
+
+    size_t aes_blake512_ctx_size(void);
+
+    AESBlake512Ctx *aes_blake512_ctx_init_arena(
+        void *arena,
+        size_t arena_len,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_ctx_encrypt_update(
+        AESBlake512Ctx *ctx,
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        uint8_t ciphertext[],
+        size_t *ciphertext_len
+    );
+
+    AESBlakeStatus aes_blake512_ctx_decrypt_update(
+        AESBlake512Ctx *ctx,
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        uint8_t plaintext[],
+        size_t *plaintext_len
+    );
+
+    AESBlakeStatus aes_blake512_ctx_update_header(
+        AESBlake512Ctx *ctx,
+        const uint8_t header[],
+        size_t header_len
+    );
+
+    AESBlakeStatus aes_blake512_ctx_encrypt_final(
+        AESBlake512Ctx *ctx,
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_ctx_decrypt_final(
+        AESBlake512Ctx *ctx,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_H
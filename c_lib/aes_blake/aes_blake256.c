@@ -0,0 +1,2448 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_block.h"
+#include "blake_types.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_shared.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_stats.h"
+#include "aes_blake_fused.h"
+#include "aes_blake_chunked.h"
+#include "aes_blake_schedule.h"
+#include "aes_blake_multibuffer.h"
+
+#define BLOCK_COUNT  2
+#define GROUP_BYTES  AES_BLAKE256_GROUP_BYTES
+#define TAG_BYTES    AES_BLAKE256_TAG_BYTES
+
+/* Groups passed to the AES backend per call, so that wide kernels can work on several counters. */
+#define BATCH_GROUPS 8
+#define BATCH_BYTES  (BATCH_GROUPS * GROUP_BYTES)
+#define BATCH_KEYS   (BATCH_GROUPS * BLOCK_COUNT * AES_BLAKE_ROUNDS)
+
+/* Key derivation jobs of the batch functions staged per window, see BatchWindow. */
+#define BATCH_JOBS   32
+
+
+/*
+ * Scratch memory of the range functions: the round keys of the batch in flight
+ * and of the next one, and one batch of staged output. With the masked pipeline
+ * the round keys are held masked and `key_masks` holds their masks. The one-shot
+ * functions keep it on the stack, arena-backed streaming contexts in the caller's arena.
+ */
+typedef struct {
+    uint8_t round_keys[2][BATCH_KEYS][16];
+    uint8_t key_masks[2][BATCH_KEYS][16];
+    uint8_t batch[BATCH_BYTES];
+} RangeScratch;
+
+
+/*
+ * The masked keygen and the masked AES backend, when both are selected, pass the
+ * round keys of the range functions as two shares that are never recombined.
+ */
+static int masked_pipeline(void) {
+    return blake32_select_derive_keys() == blake32_masked_derive_keys
+        && aes_select_backend()->encrypt_x2 == aes_encrypt_blocks_x2_masked;
+}
+
+
+/*
+ * Points `key_masks` at the masks of the two round key slots of `scratch`, or
+ * at NULL while the range functions use plain round keys.
+ */
+static void range_key_masks(RangeScratch *scratch, uint8_t (*key_masks[2])[16]) {
+    const int masked = masked_pipeline();
+    key_masks[0] = masked ? scratch->key_masks[0] : NULL;
+    key_masks[1] = masked ? scratch->key_masks[1] : NULL;
+}
+
+
+/*
+ * Wipes the round keys and key masks of a scratch before it goes out of scope.
+ */
+static void wipe_scratch_keys(RangeScratch *scratch) {
+    secure_wipe(scratch->round_keys, sizeof(scratch->round_keys));
+    secure_wipe(scratch->key_masks, sizeof(scratch->key_masks));
+}
+
+
+/*
+ * Computes the key-nonce composite of one message from a prepared key object.
+ */
+static void compute_knc(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        uint32_t knc[16]
+) {
+    uint32_t nonce_words[8];
+    load_words32_be(nonce_words, nonce, 8);
+    blake32_optimized_compute_knc(key_obj->key_words, nonce_words, knc);
+}
+
+
+/*
+ * Derives the round keys of up to BATCH_GROUPS consecutive block groups,
+ * the first one using `block_counter`. With `key_masks` the keys are derived
+ * masked by the masked keygen, see `range_key_masks`.
+ */
+static void derive_group_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        const size_t group_count,
+        uint8_t round_keys[][16],
+        uint8_t key_masks[][16]
+) {
+    AES_BLAKE_STATS_START(keygen_start);
+    if (key_masks != NULL) {
+        blake32_masked_derive_key_shares(
+            init_state, knc, AES_BLAKE_ROUNDS, block_counter, group_count, domain, round_keys, key_masks
+        );
+    } else {
+        blake32_derive_keys_many(init_state, knc, AES_BLAKE_ROUNDS, block_counter, group_count, domain, round_keys);
+    }
+    AES_BLAKE_STATS_STOP(keygen_start, AESBlakePhase_KEYGEN);
+}
+
+
+/*
+ * AES pass over `group_count` groups whose round keys are already derived, `input`
+ * and `output` may be the same buffer, so the range functions need no staging copy.
+ */
+static void encrypt_keyed_groups(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const size_t group_count
+) {
+    AES_BLAKE_STATS_START(aes_start);
+    if (key_masks != NULL) {
+        aes_encrypt_blocks_x2_masked_shares(input, output, round_keys, key_masks, AES_BLAKE_ROUNDS, group_count);
+    } else {
+        aes_select_backend()->encrypt_x2(input, output, round_keys, AES_BLAKE_ROUNDS, group_count);
+    }
+    AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+}
+
+
+static void decrypt_keyed_groups(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const size_t group_count
+) {
+    AES_BLAKE_STATS_START(aes_start);
+    if (key_masks != NULL) {
+        aes_decrypt_blocks_x2_masked_shares(input, output, round_keys, key_masks, AES_BLAKE_ROUNDS, group_count);
+    } else {
+        aes_select_backend()->decrypt_x2(input, output, round_keys, AES_BLAKE_ROUNDS, group_count);
+    }
+    AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+}
+
+
+/*
+ * Encrypts up to BATCH_GROUPS consecutive block groups in-place, the first one
+ * using `block_counter`. A single group goes through the fused kernel when it
+ * is usable, which keeps its round keys in registers, or else through the lazy
+ * kernel on the T-table backend, which derives them one round at a time.
+ */
+static void encrypt_groups(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t groups[],
+        const size_t group_count,
+        RangeScratch *scratch
+) {
+    if (group_count == 1 && aes_blake256_fused_usable()) {
+        aes_blake256_fused_encrypt_group(init_state, knc, block_counter, domain, groups);
+        return;
+    }
+    if (group_count == 1 && aes_blake256_lazy_usable()) {
+        aes_blake256_lazy_encrypt_group(init_state, knc, block_counter, domain, groups);
+        return;
+    }
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+    derive_group_keys(init_state, knc, block_counter, domain, group_count, scratch->round_keys[0], key_masks[0]);
+    encrypt_keyed_groups(groups, groups, scratch->round_keys[0], key_masks[0], group_count);
+}
+
+
+/*
+ * Length of the batch at `offset` of a `length` byte range.
+ */
+static size_t batch_length(const size_t length, const size_t offset) {
+    return length - offset < BATCH_BYTES ? length - offset : BATCH_BYTES;
+}
+
+
+/*
+ * Derives the round keys of the batch at `offset` of a `length` byte range whose
+ * first group uses block counter `first_counter`, if the range has such a batch.
+ *
+ * The range functions are software pipelined around this: the keys of batch i + 1
+ * are derived right after the AES pass of batch i has been issued and before its
+ * output is consumed. The two passes are independent, so the out-of-order core runs
+ * the AES rounds of one batch alongside the Blake rounds of the next instead of
+ * leaving the AES units idle while the keys are derived.
+ */
+static void derive_batch_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const KDFDomain domain,
+        const size_t length,
+        const size_t offset,
+        const uint64_t first_counter,
+        uint8_t round_keys[][16],
+        uint8_t key_masks[][16]
+) {
+    if (offset < length) {
+        const size_t group_count = batch_length(length, offset) / GROUP_BYTES;
+        derive_group_keys(init_state, knc, first_counter + offset / GROUP_BYTES, domain, group_count, round_keys, key_masks);
+    }
+}
+
+
+/*
+ * XORs every group of `data` into the running group checksum.
+ */
+static void checksum_groups(uint8_t checksums[GROUP_BYTES], const uint8_t data[], const size_t length) {
+    AES_BLAKE_STATS_START(checksum_start);
+    for (size_t offset = 0; offset < length; offset += GROUP_BYTES) {
+        checksum_xor(checksums, data + offset, GROUP_BYTES);
+    }
+    AES_BLAKE_STATS_STOP(checksum_start, AESBlakePhase_CHECKSUM);
+}
+
+
+/*
+ * AES pass over keyed groups that also XORs the plaintext groups into `checksums`.
+ * With a backend that has fused checksum kernels each plaintext byte is read once,
+ * the checksums stay in registers for the whole pass and the time counts as AES.
+ * Other backends fall back to a separate checksum pass over the same batch.
+ */
+static void encrypt_summed_groups(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const size_t group_count,
+        uint8_t checksums[GROUP_BYTES]
+) {
+    const AES_Backend *backend = aes_select_backend();
+    if (key_masks != NULL || backend->encrypt_x2_sum == NULL) {
+        checksum_groups(checksums, input, group_count * GROUP_BYTES);
+        encrypt_keyed_groups(input, output, round_keys, key_masks, group_count);
+        return;
+    }
+    AES_BLAKE_STATS_START(aes_start);
+    backend->encrypt_x2_sum(input, output, round_keys, AES_BLAKE_ROUNDS, group_count, checksums);
+    AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+}
+
+
+static void decrypt_summed_groups(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const size_t group_count,
+        uint8_t checksums[GROUP_BYTES]
+) {
+    const AES_Backend *backend = aes_select_backend();
+    if (key_masks != NULL || backend->decrypt_x2_sum == NULL) {
+        decrypt_keyed_groups(input, output, round_keys, key_masks, group_count);
+        checksum_groups(checksums, output, group_count * GROUP_BYTES);
+        return;
+    }
+    AES_BLAKE_STATS_START(aes_start);
+    backend->decrypt_x2_sum(input, output, round_keys, AES_BLAKE_ROUNDS, group_count, checksums);
+    AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+}
+
+
+/*
+ * Encrypts `length` bytes of plaintext, starting at message group `first_group`,
+ * into `ciphertext` and XORs the plaintext groups into `checksums`.
+ */
+static void encrypt_range(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t plaintext[],
+        uint8_t ciphertext[],
+        const size_t length,
+        const uint64_t first_group,
+        uint8_t checksums[GROUP_BYTES],
+        RangeScratch *scratch
+) {
+    size_t slot = 0;
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+
+    derive_batch_keys(init_state, knc, KDFDomain_MSG, length, 0, first_group, scratch->round_keys[0], key_masks[0]);
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES, slot ^= 1) {
+        const size_t batch_len = batch_length(length, offset);
+        encrypt_summed_groups(plaintext + offset, ciphertext + offset, scratch->round_keys[slot], key_masks[slot], batch_len / GROUP_BYTES, checksums);
+        derive_batch_keys(init_state, knc, KDFDomain_MSG, length, offset + BATCH_BYTES, first_group, scratch->round_keys[slot ^ 1], key_masks[slot ^ 1]);
+    }
+}
+
+
+/*
+ * Decrypts `length` bytes of ciphertext, starting at message group `first_group`,
+ * into `plaintext` and XORs the plaintext groups into `checksums`.
+ */
+static void decrypt_range(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t ciphertext[],
+        uint8_t plaintext[],
+        const size_t length,
+        const uint64_t first_group,
+        uint8_t checksums[GROUP_BYTES],
+        RangeScratch *scratch
+) {
+    size_t slot = 0;
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+
+    derive_batch_keys(init_state, knc, KDFDomain_MSG, length, 0, first_group, scratch->round_keys[0], key_masks[0]);
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES, slot ^= 1) {
+        const size_t batch_len = batch_length(length, offset);
+        decrypt_summed_groups(ciphertext + offset, plaintext + offset, scratch->round_keys[slot], key_masks[slot], batch_len / GROUP_BYTES, checksums);
+        derive_batch_keys(init_state, knc, KDFDomain_MSG, length, offset + BATCH_BYTES, first_group, scratch->round_keys[slot ^ 1], key_masks[slot ^ 1]);
+    }
+}
+
+
+/*
+ * Encrypts `length` bytes of header in the HDR domain, starting at block counter
+ * `first_counter`, and XORs the encrypted groups into `header_checksums`.
+ */
+static void checksum_header_range(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t header[],
+        const size_t length,
+        const uint64_t first_counter,
+        uint8_t header_checksums[GROUP_BYTES],
+        RangeScratch *scratch
+) {
+    AES_BLAKE_STATS_START(header_start);
+    size_t slot = 0;
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+
+    derive_batch_keys(init_state, knc, KDFDomain_HDR, length, 0, first_counter, scratch->round_keys[0], key_masks[0]);
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES, slot ^= 1) {
+        const size_t batch_len = batch_length(length, offset);
+        encrypt_keyed_groups(header + offset, scratch->batch, scratch->round_keys[slot], key_masks[slot], batch_len / GROUP_BYTES);
+        derive_batch_keys(init_state, knc, KDFDomain_HDR, length, offset + BATCH_BYTES, first_counter, scratch->round_keys[slot ^ 1], key_masks[slot ^ 1]);
+        checksum_groups(header_checksums, scratch->batch, batch_len);
+    }
+    AES_BLAKE_STATS_STOP(header_start, AESBlakePhase_HEADER);
+}
+
+
+/*
+ * Computes the plaintext checksums of `length` bytes of ciphertext, starting at
+ * message group `first_group`, without writing any plaintext out. Each batch is
+ * decrypted into the scratch batch, which is wiped before returning, so memory
+ * use stays at one batch whatever the message length.
+ */
+static void checksum_ciphertext_range(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t ciphertext[],
+        const size_t length,
+        const uint64_t first_group,
+        uint8_t checksums[GROUP_BYTES],
+        RangeScratch *scratch
+) {
+    size_t slot = 0;
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+
+    derive_batch_keys(init_state, knc, KDFDomain_MSG, length, 0, first_group, scratch->round_keys[0], key_masks[0]);
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES, slot ^= 1) {
+        const size_t batch_len = batch_length(length, offset);
+        decrypt_summed_groups(ciphertext + offset, scratch->batch, scratch->round_keys[slot], key_masks[slot], batch_len / GROUP_BYTES, checksums);
+        derive_batch_keys(init_state, knc, KDFDomain_MSG, length, offset + BATCH_BYTES, first_group, scratch->round_keys[slot ^ 1], key_masks[slot ^ 1]);
+    }
+    secure_wipe(scratch->batch, sizeof(scratch->batch));
+}
+
+
+/*
+ * Encrypts the plaintext checksums in the CHK domain at `block_counter`, the first
+ * counter after the message and header, and XORs them with the header checksums.
+ */
+static void finish_auth_tag(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const uint8_t checksums[GROUP_BYTES],
+        const uint8_t header_checksums[GROUP_BYTES],
+        uint8_t auth_tag[TAG_BYTES],
+        RangeScratch *scratch
+) {
+    AES_BLAKE_STATS_START(finalize_start);
+    uint8_t group[GROUP_BYTES];
+    memcpy(group, checksums, GROUP_BYTES);
+    encrypt_groups(init_state, knc, block_counter, KDFDomain_CHK, group, 1, scratch);
+    checksum_xor(group, header_checksums, GROUP_BYTES);
+    memcpy(auth_tag, group, TAG_BYTES);
+    AES_BLAKE_STATS_STOP(finalize_start, AESBlakePhase_FINALIZE);
+}
+
+
+/*
+ * Computes the auth tag from the plaintext checksums and the header. Header groups
+ * are encrypted in the HDR domain with block counters continuing after the message,
+ * then the checksums are encrypted in the CHK domain and XORed with the header checksums.
+ */
+static void compute_auth_tag(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t header[],
+        const size_t header_len,
+        const uint64_t block_counter,
+        const uint8_t checksums[GROUP_BYTES],
+        uint8_t auth_tag[TAG_BYTES],
+        RangeScratch *scratch
+) {
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    checksum_header_range(init_state, knc, header, header_len, block_counter, header_checksums, scratch);
+
+    const uint64_t chk_counter = block_counter + header_len / GROUP_BYTES;
+    finish_auth_tag(init_state, knc, chk_counter, checksums, header_checksums, auth_tag, scratch);
+}
+
+
+/*
+ * Prepares a reusable key object by digesting the cipher context once. The
+ * object is never modified by the encrypt and decrypt functions, so many
+ * threads may share it. Only the nonce mixing is left to each message.
+ */
+void aes_blake256_key_init(
+        AESBlake256Key *key_obj,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES]
+) {
+    uint32_t context_words[16];
+    load_words32_be(key_obj->key_words, key, 8);
+    load_words32_be(context_words, context, 16);
+    blake32_select_digest_context()(key_obj->init_state, key_obj->key_words, context_words);
+}
+
+
+/*
+ * Wipes the key material held by a key object.
+ */
+void aes_blake256_key_wipe(AESBlake256Key *key_obj) {
+    secure_wipe(key_obj, sizeof(*key_obj));
+}
+
+
+/*
+ * Same as `aes_blake256_encrypt`, with the key and context taken from a key object.
+ */
+AESBlakeStatus aes_blake256_encrypt_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (plaintext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    RangeScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    encrypt_range(key_obj->init_state, knc, plaintext, ciphertext, plaintext_len, 0, checksums, &scratch);
+
+    const uint64_t block_counter = plaintext_len / GROUP_BYTES;
+    compute_auth_tag(key_obj->init_state, knc, header, header_len, block_counter, checksums, auth_tag, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt`, with the key and context taken from a key object.
+ */
+AESBlakeStatus aes_blake256_decrypt_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    RangeScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    decrypt_range(key_obj->init_state, knc, ciphertext, plaintext, ciphertext_len, 0, checksums, &scratch);
+
+    const uint64_t block_counter = ciphertext_len / GROUP_BYTES;
+    uint8_t expected_tag[TAG_BYTES];
+    compute_auth_tag(key_obj->init_state, knc, header, header_len, block_counter, checksums, expected_tag, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(knc, sizeof(knc));
+
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    if (!tags_equal) {
+        secure_wipe(plaintext, ciphertext_len);
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Checks the auth tag of a ciphertext without producing any plaintext, see
+ * `checksum_ciphertext_range`. Returns AESBlakeStatus_OK when the tag matches.
+ */
+AESBlakeStatus aes_blake256_verify_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    RangeScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    checksum_ciphertext_range(key_obj->init_state, knc, ciphertext, ciphertext_len, 0, checksums, &scratch);
+
+    const uint64_t block_counter = ciphertext_len / GROUP_BYTES;
+    uint8_t expected_tag[TAG_BYTES];
+    compute_auth_tag(key_obj->init_state, knc, header, header_len, block_counter, checksums, expected_tag, &scratch);
+    wipe_scratch_keys(&scratch);
+
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    secure_wipe(knc, sizeof(knc));
+    return tags_equal ? AESBlakeStatus_OK : AESBlakeStatus_AUTH_FAILED;
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt_with_key`, but the auth tag is verified by a
+ * checksum-only pass before anything is written. Forged messages are rejected
+ * without touching the plaintext buffer, at the cost of decrypting valid
+ * messages twice. The plaintext may alias the ciphertext.
+ */
+AESBlakeStatus aes_blake256_decrypt_verified_with_key(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    const AESBlakeStatus status = aes_blake256_verify_with_key(
+        key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag
+    );
+    if (status != AESBlakeStatus_OK) {
+        return status;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    RangeScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    decrypt_range(key_obj->init_state, knc, ciphertext, plaintext, ciphertext_len, 0, checksums, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Block groups sharing one key derivation and AES backend call in the batch
+ * functions. Messages are collected until their groups, including one CHK
+ * group each, fill a window, and larger messages are processed one by one.
+ */
+typedef struct {
+    AESBlakeMessage *msgs[BATCH_JOBS];
+    uint32_t knc[BATCH_JOBS][16];
+    size_t msg_count;
+    size_t job_count;
+} BatchWindow;
+
+
+/*
+ * memcpy that accepts NULL pointers for empty messages and headers.
+ */
+static void copy_bytes(uint8_t dst[], const uint8_t src[], const size_t length) {
+    if (length > 0) {
+        memcpy(dst, src, length);
+    }
+}
+
+
+/*
+ * Returns the number of key derivation jobs of a message, one per message
+ * and header group plus the CHK group of the auth tag.
+ */
+static size_t message_jobs(const AESBlakeMessage *msg) {
+    return msg->input_len / GROUP_BYTES + msg->header_len / GROUP_BYTES + 1;
+}
+
+
+/*
+ * Processes every message of a window in one pass. The groups are staged in
+ * the order MSG groups of all messages, then HDR groups, then CHK groups, so
+ * that the decryption of the message groups is a single backend call and the
+ * encryption of the header and checksum groups another one.
+ */
+static void process_window(
+        const AESBlake256Key *key_obj,
+        BatchWindow *window,
+        const int decrypt
+) {
+    Blake32KeyJob jobs[BATCH_JOBS];
+    uint8_t data[BATCH_JOBS * GROUP_BYTES];
+    uint8_t round_keys[BATCH_JOBS * BLOCK_COUNT * AES_BLAKE_ROUNDS][16];
+    size_t msg_first[BATCH_JOBS], hdr_first[BATCH_JOBS];
+    size_t job = 0;
+
+    for (size_t i = 0; i < window->msg_count; i++) {
+        const AESBlakeMessage *msg = window->msgs[i];
+        msg_first[i] = job;
+        for (size_t g = 0; g < msg->input_len / GROUP_BYTES; g++, job++) {
+            jobs[job] = (Blake32KeyJob){window->knc[i], g, KDFDomain_MSG, NULL};
+        }
+        copy_bytes(data + msg_first[i] * GROUP_BYTES, msg->input, msg->input_len);
+    }
+    const size_t msg_jobs = job;
+
+    for (size_t i = 0; i < window->msg_count; i++) {
+        const AESBlakeMessage *msg = window->msgs[i];
+        const uint64_t first_counter = msg->input_len / GROUP_BYTES;
+        hdr_first[i] = job;
+        for (size_t g = 0; g < msg->header_len / GROUP_BYTES; g++, job++) {
+            jobs[job] = (Blake32KeyJob){window->knc[i], first_counter + g, KDFDomain_HDR, NULL};
+        }
+        copy_bytes(data + hdr_first[i] * GROUP_BYTES, msg->header, msg->header_len);
+    }
+    const size_t chk_first = job;
+
+    for (size_t i = 0; i < window->msg_count; i++, job++) {
+        const AESBlakeMessage *msg = window->msgs[i];
+        const uint64_t chk_counter = (msg->input_len + msg->header_len) / GROUP_BYTES;
+        jobs[job] = (Blake32KeyJob){window->knc[i], chk_counter, KDFDomain_CHK, NULL};
+    }
+
+    AES_BLAKE_STATS_START(keygen_start);
+    blake32_derive_keys_jobs(key_obj->init_state, jobs, AES_BLAKE_ROUNDS, job, round_keys);
+    AES_BLAKE_STATS_STOP(keygen_start, AESBlakePhase_KEYGEN);
+
+    const AES_Backend *backend = aes_select_backend();
+    if (decrypt) {
+        AES_BLAKE_STATS_START(aes_start);
+        backend->decrypt_x2(data, data, round_keys, AES_BLAKE_ROUNDS, msg_jobs);
+        AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+    }
+    for (size_t i = 0; i < window->msg_count; i++) {
+        const AESBlakeMessage *msg = window->msgs[i];
+        uint8_t *checksums = data + (chk_first + i) * GROUP_BYTES;
+        memset(checksums, 0, GROUP_BYTES);
+        checksum_groups(checksums, decrypt ? data + msg_first[i] * GROUP_BYTES : msg->input, msg->input_len);
+    }
+    AES_BLAKE_STATS_START(aes_start);
+    if (decrypt) {
+        backend->encrypt_x2(
+            data + msg_jobs * GROUP_BYTES,
+            data + msg_jobs * GROUP_BYTES,
+            &round_keys[msg_jobs * BLOCK_COUNT * AES_BLAKE_ROUNDS],
+            AES_BLAKE_ROUNDS,
+            job - msg_jobs
+        );
+    } else {
+        backend->encrypt_x2(data, data, round_keys, AES_BLAKE_ROUNDS, job);
+    }
+    AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+
+    for (size_t i = 0; i < window->msg_count; i++) {
+        AESBlakeMessage *msg = window->msgs[i];
+        uint8_t auth_tag[TAG_BYTES];
+        memcpy(auth_tag, data + (chk_first + i) * GROUP_BYTES, TAG_BYTES);
+        checksum_groups(auth_tag, data + hdr_first[i] * GROUP_BYTES, msg->header_len);
+
+        if (!decrypt) {
+            memcpy(msg->auth_tag, auth_tag, TAG_BYTES);
+            msg->status = AESBlakeStatus_OK;
+        } else if (!auth_tags_equal(auth_tag, msg->auth_tag, TAG_BYTES)) {
+            msg->status = AESBlakeStatus_AUTH_FAILED;
+        } else {
+            msg->status = AESBlakeStatus_OK;
+        }
+
+        // Plaintext of a failed message stays in the staging buffer, its output is zeroed
+        if (msg->status == AESBlakeStatus_OK) {
+            copy_bytes(msg->output, data + msg_first[i] * GROUP_BYTES, msg->input_len);
+        } else if (msg->input_len > 0) {
+            secure_wipe(msg->output, msg->input_len);
+        }
+    }
+    secure_wipe(data, sizeof(data));
+    secure_wipe(round_keys, sizeof(round_keys));
+    secure_wipe(window->knc, sizeof(window->knc));
+    window->msg_count = 0;
+    window->job_count = 0;
+}
+
+
+/*
+ * Shared body of the batch functions.
+ */
+static AESBlakeStatus process_batch(
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count,
+        const int decrypt
+) {
+    BatchWindow window;
+    window.msg_count = 0;
+    window.job_count = 0;
+
+    for (size_t i = 0; i < msg_count; i++) {
+        AESBlakeMessage *msg = &msgs[i];
+        if (msg->input_len % GROUP_BYTES != 0 || msg->header_len % GROUP_BYTES != 0) {
+            msg->status = AESBlakeStatus_INVALID_LENGTH;
+            continue;
+        }
+        // Messages too large for a window, or all of them with the masked pipeline, go one by one
+        const size_t jobs = message_jobs(msg);
+        if (jobs > BATCH_JOBS || masked_pipeline()) {
+            msg->status = decrypt
+                ? aes_blake256_decrypt_with_key(
+                    key_obj, msg->nonce, msg->input, msg->input_len,
+                    msg->header, msg->header_len, msg->auth_tag, msg->output
+                )
+                : aes_blake256_encrypt_with_key(
+                    key_obj, msg->nonce, msg->input, msg->input_len,
+                    msg->header, msg->header_len, msg->output, msg->auth_tag
+                );
+            continue;
+        }
+        if (window.job_count + jobs > BATCH_JOBS) {
+            process_window(key_obj, &window, decrypt);
+        }
+        compute_knc(key_obj, msg->nonce, window.knc[window.msg_count]);
+        window.msgs[window.msg_count++] = msg;
+        window.job_count += jobs;
+    }
+    if (window.msg_count > 0) {
+        process_window(key_obj, &window, decrypt);
+    }
+
+    for (size_t i = 0; i < msg_count; i++) {
+        if (msgs[i].status != AESBlakeStatus_OK) {
+            return msgs[i].status;
+        }
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Encrypts many independent messages under one key object. The key derivation
+ * and AES rounds of small messages are interleaved across messages so that the
+ * SIMD lanes stay full, which makes throughput in messages per second much higher
+ * than calling `aes_blake256_encrypt_with_key` in a loop. Every message receives
+ * its own status, and the first non-OK status is returned.
+ */
+AESBlakeStatus aes_blake256_encrypt_batch(
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch(key_obj, msgs, msg_count, 0);
+}
+
+
+/*
+ * Decrypts many independent messages under one key object, see
+ * `aes_blake256_encrypt_batch`. The `auth_tag` of every message is
+ * verified, and failed messages get AESBlakeStatus_AUTH_FAILED with
+ * their output zeroed.
+ */
+AESBlakeStatus aes_blake256_decrypt_batch(
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch(key_obj, msgs, msg_count, 1);
+}
+
+
+/*
+ * Encrypts the plaintext into the caller-provided ciphertext buffer and
+ * outputs the auth tag. Plaintext and header lengths must be multiples
+ * of AES_BLAKE256_GROUP_BYTES. The ciphertext may alias the plaintext.
+ */
+AESBlakeStatus aes_blake256_encrypt(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_encrypt_with_key(
+        &key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Decrypts the ciphertext into the caller-provided plaintext buffer and verifies
+ * the auth tag. On AESBlakeStatus_AUTH_FAILED the plaintext buffer is zeroed, it
+ * only holds unauthenticated data while the call runs, see `aes_blake256_decrypt_verified`
+ * to never write it at all. The plaintext may alias the ciphertext.
+ */
+AESBlakeStatus aes_blake256_decrypt(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_decrypt_with_key(
+        &key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Checks the auth tag of a ciphertext without producing any plaintext,
+ * see `aes_blake256_verify_with_key`.
+ */
+AESBlakeStatus aes_blake256_verify(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_verify_with_key(
+        &key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Two-pass decryption that never writes unauthenticated plaintext and needs no
+ * memory beyond one batch on the stack, see `aes_blake256_decrypt_verified_with_key`.
+ */
+AESBlakeStatus aes_blake256_decrypt_verified(
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_decrypt_verified_with_key(
+        &key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Work of one parallel call. The block counters of the message groups and the
+ * header groups that follow them form one range, which is split evenly over the
+ * tasks. A task whose range crosses the end of the message also checksums the
+ * start of its header part, so the HDR domain runs alongside the MSG domain and
+ * only the final CHK step waits for both. Each task writes its output in place
+ * and leaves its partial checksums in its own slots, which are XOR-reduced afterwards.
+ * Tasks copy the keygen context to their own stack before use, so on a NUMA pool
+ * each node reads a local copy instead of the caller's.
+ */
+typedef struct {
+    const uint32_t *init_state;
+    const uint32_t *knc;
+    const uint8_t *input;
+    uint8_t *output;
+    const uint8_t *header;
+    size_t msg_groups;
+    size_t group_count;
+    size_t task_count;
+    uint8_t (*checksums)[GROUP_BYTES];
+    uint8_t (*header_checksums)[GROUP_BYTES];
+} ParallelJob;
+
+
+/*
+ * Splits the block counter range of task `task_index` into its message
+ * groups [msg_begin, msg_end) and its header groups [hdr_begin, hdr_end).
+ */
+static void task_range(
+        const ParallelJob *job,
+        const size_t task_index,
+        size_t *msg_begin,
+        size_t *msg_end,
+        size_t *hdr_begin,
+        size_t *hdr_end
+) {
+    const size_t begin = job->group_count * task_index / job->task_count;
+    const size_t end = job->group_count * (task_index + 1) / job->task_count;
+    *msg_begin = begin < job->msg_groups ? begin : job->msg_groups;
+    *msg_end = end < job->msg_groups ? end : job->msg_groups;
+    *hdr_begin = begin > job->msg_groups ? begin : job->msg_groups;
+    *hdr_end = end > job->msg_groups ? end : job->msg_groups;
+}
+
+
+/*
+ * Checksums the header groups of one task in the HDR domain, header group `g`
+ * uses block counter `job->msg_groups + g` as in `compute_auth_tag`.
+ */
+static void header_task(
+        const ParallelJob *job,
+        const size_t task_index,
+        const size_t begin,
+        const size_t end,
+        RangeScratch *scratch
+) {
+    if (begin < end) {
+        checksum_header_range(
+            job->init_state, job->knc, job->header + (begin - job->msg_groups) * GROUP_BYTES,
+            (end - begin) * GROUP_BYTES, begin, job->header_checksums[task_index], scratch
+        );
+    }
+}
+
+
+/*
+ * Returns a copy of `shared` that reads the keygen context from `init_state`
+ * and `knc` in the frame of the calling task.
+ */
+static ParallelJob local_job(const ParallelJob *shared, uint32_t init_state[16], uint32_t knc[16]) {
+    memcpy(init_state, shared->init_state, 16 * sizeof(uint32_t));
+    memcpy(knc, shared->knc, 16 * sizeof(uint32_t));
+    ParallelJob job = *shared;
+    job.init_state = init_state;
+    job.knc = knc;
+    return job;
+}
+
+
+/*
+ * Places every task of a job on a NUMA pool on the node holding the middle of
+ * its input, or of its output where the input page is unknown, so that tasks
+ * run next to their data. Returns NULL for a pool on a single node.
+ */
+static const int *place_tasks(const AESBlakePool *pool, const ParallelJob *job, int task_nodes[]) {
+    if (aes_blake_pool_node_count(pool) < 2 || job->task_count < 2) {
+        return NULL;
+    }
+    const void *inputs[AES_BLAKE_POOL_MAX_TASKS];
+    const void *outputs[AES_BLAKE_POOL_MAX_TASKS];
+    int output_nodes[AES_BLAKE_POOL_MAX_TASKS];
+    for (size_t i = 0; i < job->task_count; i++) {
+        size_t msg_begin, msg_end, hdr_begin, hdr_end;
+        task_range(job, i, &msg_begin, &msg_end, &hdr_begin, &hdr_end);
+        if (msg_begin < msg_end) {
+            const size_t offset = (msg_begin + msg_end) / 2 * GROUP_BYTES;
+            inputs[i] = job->input + offset;
+            outputs[i] = job->output + offset;
+        } else {
+            inputs[i] = outputs[i] = job->header + ((hdr_begin + hdr_end) / 2 - job->msg_groups) * GROUP_BYTES;
+        }
+    }
+    aes_blake_pool_page_nodes(pool, inputs, job->task_count, task_nodes);
+    aes_blake_pool_page_nodes(pool, outputs, job->task_count, output_nodes);
+    for (size_t i = 0; i < job->task_count; i++) {
+        if (task_nodes[i] < 0) {
+            task_nodes[i] = output_nodes[i];
+        }
+    }
+    return task_nodes;
+}
+
+
+static void encrypt_task(void *arg, const size_t task_index) {
+    const ParallelJob *shared = arg;
+    size_t msg_begin, msg_end, hdr_begin, hdr_end;
+    task_range(shared, task_index, &msg_begin, &msg_end, &hdr_begin, &hdr_end);
+
+    uint32_t init_state[16], knc[16];
+    const ParallelJob job = local_job(shared, init_state, knc);
+    RangeScratch scratch;
+    const size_t offset = msg_begin * GROUP_BYTES;
+    encrypt_range(
+        job.init_state, job.knc, job.input + offset, job.output + offset,
+        (msg_end - msg_begin) * GROUP_BYTES, msg_begin, job.checksums[task_index], &scratch
+    );
+    header_task(&job, task_index, hdr_begin, hdr_end, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(init_state, sizeof(init_state));
+    secure_wipe(knc, sizeof(knc));
+}
+
+
+static void decrypt_task(void *arg, const size_t task_index) {
+    const ParallelJob *shared = arg;
+    size_t msg_begin, msg_end, hdr_begin, hdr_end;
+    task_range(shared, task_index, &msg_begin, &msg_end, &hdr_begin, &hdr_end);
+
+    uint32_t init_state[16], knc[16];
+    const ParallelJob job = local_job(shared, init_state, knc);
+    RangeScratch scratch;
+    const size_t offset = msg_begin * GROUP_BYTES;
+    decrypt_range(
+        job.init_state, job.knc, job.input + offset, job.output + offset,
+        (msg_end - msg_begin) * GROUP_BYTES, msg_begin, job.checksums[task_index], &scratch
+    );
+    header_task(&job, task_index, hdr_begin, hdr_end, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(init_state, sizeof(init_state));
+    secure_wipe(knc, sizeof(knc));
+}
+
+
+/*
+ * Runs `task_fn` over the message and the header on the pool, XOR-reduces the
+ * partial checksums and computes the auth tag from them in the CHK domain.
+ */
+static void run_parallel(
+        AESBlakePool *pool,
+        const AESBlakeTaskFunc task_fn,
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t input[],
+        uint8_t output[],
+        const size_t length,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t auth_tag[TAG_BYTES]
+) {
+    uint8_t partials[AES_BLAKE_POOL_MAX_TASKS][GROUP_BYTES] = {{0}};
+    uint8_t header_partials[AES_BLAKE_POOL_MAX_TASKS][GROUP_BYTES] = {{0}};
+    ParallelJob job;
+    job.init_state = init_state;
+    job.knc = knc;
+    job.input = input;
+    job.output = output;
+    job.header = header;
+    job.msg_groups = length / GROUP_BYTES;
+    job.group_count = (length + header_len) / GROUP_BYTES;
+    job.task_count = aes_blake_pool_task_count(pool, length + header_len);
+    job.checksums = partials;
+    job.header_checksums = header_partials;
+
+    int task_nodes[AES_BLAKE_POOL_MAX_TASKS];
+    const int *placement = place_tasks(pool, &job, task_nodes);
+    aes_blake_pool_run_placed(pool, task_fn, &job, job.task_count, placement);
+
+    uint8_t checksums[GROUP_BYTES] = {0};
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    for (size_t i = 0; i < job.task_count; i++) {
+        checksum_xor(checksums, partials[i], GROUP_BYTES);
+        checksum_xor(header_checksums, header_partials[i], GROUP_BYTES);
+    }
+    RangeScratch scratch;
+    finish_auth_tag(init_state, knc, job.group_count, checksums, header_checksums, auth_tag, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(partials, sizeof(partials));
+    secure_wipe(checksums, sizeof(checksums));
+}
+
+
+/*
+ * Same as `aes_blake256_encrypt`, with the message and the header split over the
+ * threads of `pool`. The output is identical to the single-threaded function. The
+ * ciphertext may alias the plaintext.
+ */
+AESBlakeStatus aes_blake256_encrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_encrypt_parallel_with_key(
+        pool, &key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt`, with the message and the header split over the
+ * threads of `pool`. The plaintext is zeroed on AESBlakeStatus_AUTH_FAILED and
+ * may alias the ciphertext.
+ */
+AESBlakeStatus aes_blake256_decrypt_parallel(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    const AESBlakeStatus status = aes_blake256_decrypt_parallel_with_key(
+        pool, &key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext
+    );
+    aes_blake256_key_wipe(&key_obj);
+    return status;
+}
+
+
+/*
+ * Same as `aes_blake256_encrypt_parallel`, with the key and context taken from a key object.
+ */
+AESBlakeStatus aes_blake256_encrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (plaintext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    run_parallel(
+        pool, encrypt_task, key_obj->init_state, knc, plaintext, ciphertext, plaintext_len, header, header_len, auth_tag
+    );
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt_parallel`, with the key and context taken from a key object.
+ */
+AESBlakeStatus aes_blake256_decrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    uint8_t expected_tag[TAG_BYTES];
+    run_parallel(
+        pool, decrypt_task, key_obj->init_state, knc, ciphertext, plaintext, ciphertext_len, header, header_len, expected_tag
+    );
+    secure_wipe(knc, sizeof(knc));
+
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    if (!tags_equal) {
+        secure_wipe(plaintext, ciphertext_len);
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Decrypts `length` bytes of ciphertext under one key and nonce and encrypts the
+ * plaintext under another, starting at message group `first_group`, and XORs the
+ * plaintext groups into `checksums`. The plaintext of a batch only ever lives in
+ * the scratch batch, which is wiped before returning. The new keys of a batch are
+ * derived while its decryption is in flight, the old keys of the next batch while
+ * its encryption is, so the keygen of one key hides behind the AES pass of the other.
+ */
+static void reencrypt_range(
+        const ParallelJob *from,
+        const ParallelJob *to,
+        const uint8_t ciphertext[],
+        uint8_t new_ciphertext[],
+        const size_t length,
+        const uint64_t first_group,
+        uint8_t checksums[GROUP_BYTES],
+        RangeScratch *scratch
+) {
+    uint8_t (*key_masks[2])[16];
+    range_key_masks(scratch, key_masks);
+
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES) {
+        const size_t group_count = batch_length(length, offset) / GROUP_BYTES;
+        derive_batch_keys(from->init_state, from->knc, KDFDomain_MSG, length, offset, first_group, scratch->round_keys[0], key_masks[0]);
+        decrypt_summed_groups(ciphertext + offset, scratch->batch, scratch->round_keys[0], key_masks[0], group_count, checksums);
+        derive_batch_keys(to->init_state, to->knc, KDFDomain_MSG, length, offset, first_group, scratch->round_keys[1], key_masks[1]);
+        encrypt_keyed_groups(scratch->batch, new_ciphertext + offset, scratch->round_keys[1], key_masks[1], group_count);
+    }
+    secure_wipe(scratch->batch, sizeof(scratch->batch));
+}
+
+
+/*
+ * Shared state of the tasks of one re-encryption call: the job of the old key,
+ * whose input and output are the old and new ciphertexts, and the job of the new
+ * key, of which only the keygen context and the header checksums are used. Both
+ * keys checksum the same plaintext, so the message checksums are kept once.
+ */
+typedef struct {
+    ParallelJob from;
+    ParallelJob to;
+} ReencryptJob;
+
+
+static void reencrypt_task(void *arg, const size_t task_index) {
+    const ReencryptJob *shared = arg;
+    size_t msg_begin, msg_end, hdr_begin, hdr_end;
+    task_range(&shared->from, task_index, &msg_begin, &msg_end, &hdr_begin, &hdr_end);
+
+    uint32_t from_state[16], from_knc[16], to_state[16], to_knc[16];
+    const ParallelJob from = local_job(&shared->from, from_state, from_knc);
+    const ParallelJob to = local_job(&shared->to, to_state, to_knc);
+    RangeScratch scratch;
+    const size_t offset = msg_begin * GROUP_BYTES;
+    reencrypt_range(
+        &from, &to, from.input + offset, from.output + offset,
+        (msg_end - msg_begin) * GROUP_BYTES, msg_begin, from.checksums[task_index], &scratch
+    );
+    header_task(&from, task_index, hdr_begin, hdr_end, &scratch);
+    header_task(&to, task_index, hdr_begin, hdr_end, &scratch);
+    wipe_scratch_keys(&scratch);
+    secure_wipe(from_state, sizeof(from_state));
+    secure_wipe(from_knc, sizeof(from_knc));
+    secure_wipe(to_state, sizeof(to_state));
+    secure_wipe(to_knc, sizeof(to_knc));
+}
+
+
+/*
+ * Moves a ciphertext from one key and nonce to another in a single pass, split over
+ * the threads of `pool`, for re-keying data at rest. The output is identical to
+ * decrypting with the old key and encrypting the result with the new one, but no
+ * plaintext is written to memory outside per-task scratch, and each group is read
+ * and written once. The old auth tag is checked before `new_auth_tag` is written,
+ * on AESBlakeStatus_AUTH_FAILED a separate new ciphertext is zeroed. The new
+ * ciphertext may alias the old one, the old tag is then verified by a checksum-only
+ * pass first and a forged message is rejected with the old ciphertext untouched.
+ */
+AESBlakeStatus aes_blake256_reencrypt_parallel_with_key(
+        AESBlakePool *pool,
+        const AESBlake256Key *old_key_obj,
+        const uint8_t old_nonce[AES_BLAKE256_NONCE_BYTES],
+        const AESBlake256Key *new_key_obj,
+        const uint8_t new_nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t new_ciphertext[],
+        uint8_t new_auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    const int in_place = new_ciphertext == ciphertext;
+    if (in_place) {
+        const AESBlakeStatus status = aes_blake256_verify_with_key(
+            old_key_obj, old_nonce, ciphertext, ciphertext_len, header, header_len, auth_tag
+        );
+        if (status != AESBlakeStatus_OK) {
+            return status;
+        }
+    }
+
+    uint32_t old_knc[16], new_knc[16];
+    compute_knc(old_key_obj, old_nonce, old_knc);
+    compute_knc(new_key_obj, new_nonce, new_knc);
+
+    uint8_t partials[AES_BLAKE_POOL_MAX_TASKS][GROUP_BYTES] = {{0}};
+    uint8_t old_header_partials[AES_BLAKE_POOL_MAX_TASKS][GROUP_BYTES] = {{0}};
+    uint8_t new_header_partials[AES_BLAKE_POOL_MAX_TASKS][GROUP_BYTES] = {{0}};
+    ReencryptJob job;
+    job.from.init_state = old_key_obj->init_state;
+    job.from.knc = old_knc;
+    job.from.input = ciphertext;
+    job.from.output = new_ciphertext;
+    job.from.header = header;
+    job.from.msg_groups = ciphertext_len / GROUP_BYTES;
+    job.from.group_count = (ciphertext_len + header_len) / GROUP_BYTES;
+    job.from.task_count = aes_blake_pool_task_count(pool, ciphertext_len + header_len);
+    job.from.checksums = partials;
+    job.from.header_checksums = old_header_partials;
+    job.to = job.from;
+    job.to.init_state = new_key_obj->init_state;
+    job.to.knc = new_knc;
+    job.to.header_checksums = new_header_partials;
+
+    int task_nodes[AES_BLAKE_POOL_MAX_TASKS];
+    const int *placement = place_tasks(pool, &job.from, task_nodes);
+    aes_blake_pool_run_placed(pool, reencrypt_task, &job, job.from.task_count, placement);
+
+    uint8_t checksums[GROUP_BYTES] = {0};
+    uint8_t old_header_checksums[GROUP_BYTES] = {0};
+    uint8_t new_header_checksums[GROUP_BYTES] = {0};
+    for (size_t i = 0; i < job.from.task_count; i++) {
+        checksum_xor(checksums, partials[i], GROUP_BYTES);
+        checksum_xor(old_header_checksums, old_header_partials[i], GROUP_BYTES);
+        checksum_xor(new_header_checksums, new_header_partials[i], GROUP_BYTES);
+    }
+    RangeScratch scratch;
+    uint8_t expected_tag[TAG_BYTES];
+    finish_auth_tag(
+        old_key_obj->init_state, old_knc, job.from.group_count, checksums, old_header_checksums, expected_tag, &scratch
+    );
+    wipe_scratch_keys(&scratch);
+    secure_wipe(old_knc, sizeof(old_knc));
+    secure_wipe(partials, sizeof(partials));
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    if (!tags_equal) {
+        if (!in_place) {
+            secure_wipe(new_ciphertext, ciphertext_len);
+        }
+        secure_wipe(checksums, sizeof(checksums));
+        secure_wipe(new_knc, sizeof(new_knc));
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    finish_auth_tag(
+        new_key_obj->init_state, new_knc, job.from.group_count, checksums, new_header_checksums, new_auth_tag, &scratch
+    );
+    wipe_scratch_keys(&scratch);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(new_knc, sizeof(new_knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Shared state of the tasks of one chunked container call. Task `t` handles the
+ * chunks [first_chunk + chunk_count * t / task_count, ...) of the call and writes
+ * its verification result to `failed[t]`.
+ */
+typedef struct {
+    const uint32_t *init_state;
+    const uint32_t *knc;
+    const AESBlakeChunkedInfo *info;
+    const uint8_t *header_checksums;
+    const uint8_t *input;
+    uint8_t *output;
+    uint64_t first_chunk;
+    size_t chunk_count;
+    uint64_t offset;
+    size_t length;
+    size_t task_count;
+    int *failed;
+} ChunkedJob;
+
+
+/*
+ * Checksums the index header and the user header of a chunked container in the
+ * HDR domain, the index header zero padded to one group at block counter 0 and
+ * the user header at the block counters after it.
+ */
+static void chunked_header_checksums(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t header_checksums[GROUP_BYTES]
+) {
+    RangeScratch scratch;
+    uint8_t index_group[GROUP_BYTES] = {0};
+    memcpy(index_group, index_header, AES_BLAKE_CHUNKED_HEADER_BYTES);
+    checksum_header_range(init_state, knc, index_group, GROUP_BYTES, 0, header_checksums, &scratch);
+    checksum_header_range(init_state, knc, header, header_len, 1, header_checksums, &scratch);
+    wipe_scratch_keys(&scratch);
+}
+
+
+static size_t chunk_plaintext_len(const AESBlakeChunkedInfo *info, const uint64_t chunk) {
+    const uint64_t begin = chunk * info->chunk_bytes;
+    const uint64_t rest = info->plaintext_len - begin;
+    return (size_t)(rest < info->chunk_bytes ? rest : info->chunk_bytes);
+}
+
+
+static void chunk_task_range(const ChunkedJob *job, const size_t task_index, uint64_t *begin, uint64_t *end) {
+    *begin = job->first_chunk + job->chunk_count * task_index / job->task_count;
+    *end = job->first_chunk + job->chunk_count * (task_index + 1) / job->task_count;
+}
+
+
+/*
+ * Encrypts the chunks of one task into their frames. The partial last group of
+ * the message is zero padded in a stack buffer.
+ */
+static void chunked_encrypt_task(void *arg, const size_t task_index) {
+    const ChunkedJob *job = arg;
+    const AESBlakeChunkedInfo *info = job->info;
+    uint64_t begin, end;
+    chunk_task_range(job, task_index, &begin, &end);
+
+    RangeScratch scratch;
+    for (uint64_t chunk = begin; chunk < end; chunk++) {
+        const uint64_t position = chunk * info->chunk_bytes;
+        const uint8_t *src = job->input + position;
+        uint8_t *frame = job->output + AES_BLAKE_CHUNKED_HEADER_BYTES + chunk * (info->chunk_bytes + TAG_BYTES);
+        const size_t len = chunk_plaintext_len(info, chunk);
+        const size_t full = len / GROUP_BYTES * GROUP_BYTES;
+        uint8_t checksums[GROUP_BYTES] = {0};
+
+        encrypt_range(job->init_state, job->knc, src, frame, full, position / GROUP_BYTES, checksums, &scratch);
+        if (full < len) {
+            uint8_t group[GROUP_BYTES] = {0};
+            memcpy(group, src + full, len - full);
+            encrypt_range(
+                job->init_state, job->knc, group, frame + full, GROUP_BYTES, (position + full) / GROUP_BYTES, checksums, &scratch
+            );
+            secure_wipe(group, sizeof(group));
+        }
+        const size_t ciphertext_len = (len + GROUP_BYTES - 1) / GROUP_BYTES * GROUP_BYTES;
+        finish_auth_tag(job->init_state, job->knc, chunk, checksums, job->header_checksums, frame + ciphertext_len, &scratch);
+        secure_wipe(checksums, sizeof(checksums));
+    }
+    wipe_scratch_keys(&scratch);
+}
+
+
+/*
+ * Decrypts plaintext bytes [s, e) of one chunk into `out` and checks the chunk tag.
+ * All groups of the chunk are checksummed, those outside the range without writing
+ * any plaintext out and the partial groups at the range ends through a stack buffer.
+ */
+static int decrypt_chunk(
+        const ChunkedJob *job,
+        const uint64_t chunk,
+        const uint8_t frame[],
+        const size_t s,
+        const size_t e,
+        uint8_t out[],
+        RangeScratch *scratch
+) {
+    const size_t ciphertext_len = (chunk_plaintext_len(job->info, chunk) + GROUP_BYTES - 1) / GROUP_BYTES * GROUP_BYTES;
+    const uint64_t first_group = chunk * job->info->chunk_bytes / GROUP_BYTES;
+    size_t lo = s < e ? s / GROUP_BYTES * GROUP_BYTES : 0;
+    size_t hi = s < e ? (e + GROUP_BYTES - 1) / GROUP_BYTES * GROUP_BYTES : 0;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    uint8_t group[GROUP_BYTES];
+
+    checksum_ciphertext_range(job->init_state, job->knc, frame, lo, first_group, checksums, scratch);
+    checksum_ciphertext_range(
+        job->init_state, job->knc, frame + hi, ciphertext_len - hi, first_group + hi / GROUP_BYTES, checksums, scratch
+    );
+    if (lo < hi && s % GROUP_BYTES != 0) {
+        const size_t head_end = e < lo + GROUP_BYTES ? e : lo + GROUP_BYTES;
+        decrypt_range(job->init_state, job->knc, frame + lo, group, GROUP_BYTES, first_group + lo / GROUP_BYTES, checksums, scratch);
+        memcpy(out, group + (s - lo), head_end - s);
+        lo += GROUP_BYTES;
+    }
+    if (lo < hi && e % GROUP_BYTES != 0) {
+        const size_t tail = hi - GROUP_BYTES;
+        decrypt_range(job->init_state, job->knc, frame + tail, group, GROUP_BYTES, first_group + tail / GROUP_BYTES, checksums, scratch);
+        memcpy(out + (tail - s), group, e - tail);
+        hi = tail;
+    }
+    decrypt_range(job->init_state, job->knc, frame + lo, out + (lo - s), hi - lo, first_group + lo / GROUP_BYTES, checksums, scratch);
+    secure_wipe(group, sizeof(group));
+
+    uint8_t expected_tag[TAG_BYTES];
+    finish_auth_tag(job->init_state, job->knc, chunk, checksums, job->header_checksums, expected_tag, scratch);
+    const int tags_equal = auth_tags_equal(expected_tag, frame + ciphertext_len, TAG_BYTES);
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    return tags_equal;
+}
+
+
+static void chunked_decrypt_task(void *arg, const size_t task_index) {
+    const ChunkedJob *job = arg;
+    const AESBlakeChunkedInfo *info = job->info;
+    const uint64_t range_end = job->offset + job->length;
+    uint64_t begin, end;
+    chunk_task_range(job, task_index, &begin, &end);
+
+    RangeScratch scratch;
+    int failed = 0;
+    for (uint64_t chunk = begin; chunk < end; chunk++) {
+        const uint64_t position = chunk * info->chunk_bytes;
+        const uint64_t chunk_end = position + chunk_plaintext_len(info, chunk);
+        const uint8_t *frame = job->input + (chunk - job->first_chunk) * (info->chunk_bytes + TAG_BYTES);
+        const uint64_t s = job->offset > position ? job->offset : position;
+        const uint64_t e = range_end < chunk_end ? range_end : chunk_end;
+        if (s < e) {
+            failed |= !decrypt_chunk(
+                job, chunk, frame, (size_t)(s - position), (size_t)(e - position), job->output + (s - job->offset), &scratch
+            );
+        } else {
+            failed |= !decrypt_chunk(job, chunk, frame, 0, 0, job->output, &scratch);
+        }
+    }
+    wipe_scratch_keys(&scratch);
+    job->failed[task_index] = failed;
+}
+
+
+/*
+ * Runs `task_fn` over `chunk_count` chunks from `first_chunk` on the pool, with
+ * at most one task per chunk. Returns nonzero if any chunk failed verification.
+ */
+static int run_chunked(AESBlakePool *pool, const AESBlakeTaskFunc task_fn, ChunkedJob *job, const uint64_t work_bytes) {
+    int failed[AES_BLAKE_POOL_MAX_TASKS] = {0};
+    const size_t task_count = aes_blake_pool_task_count(pool, (size_t)work_bytes);
+    job->task_count = task_count < job->chunk_count ? task_count : job->chunk_count;
+    job->failed = failed;
+    aes_blake_pool_run(pool, task_fn, job, job->task_count);
+
+    int any_failed = 0;
+    for (size_t i = 0; i < job->task_count; i++) {
+        any_failed |= failed[i];
+    }
+    return any_failed;
+}
+
+
+/*
+ * Encrypts a message into a seekable chunked container of
+ * `aes_blake_chunked_container_size` bytes, see aes_blake_chunked.h. The chunks
+ * are split over the threads of `pool`, the header must be whole groups.
+ */
+AESBlakeStatus aes_blake256_chunked_encrypt(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const size_t chunk_bytes,
+        uint8_t container[]
+) {
+    AESBlakeChunkedInfo info;
+    if (header_len % GROUP_BYTES != 0 ||
+        aes_blake_chunked_info_init(&info, AES_BLAKE256_CHUNKED_VARIANT, plaintext_len, chunk_bytes) != AESBlakeStatus_OK) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    aes_blake_chunked_format_header(&info, container);
+    chunked_header_checksums(key_obj->init_state, knc, container, header, header_len, header_checksums);
+
+    ChunkedJob job = {0};
+    job.init_state = key_obj->init_state;
+    job.knc = knc;
+    job.info = &info;
+    job.header_checksums = header_checksums;
+    job.input = plaintext;
+    job.output = container;
+    job.chunk_count = (size_t)info.chunk_count;
+    run_chunked(pool, chunked_encrypt_task, &job, plaintext_len);
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Decrypts plaintext bytes [offset, offset + length) of a chunked container and
+ * verifies every chunk they touch. `frames` holds the container bytes found by
+ * `aes_blake_chunked_locate`, so a ranged read only fetches and decrypts the
+ * chunks of the range. The plaintext is zeroed on AESBlakeStatus_AUTH_FAILED.
+ */
+AESBlakeStatus aes_blake256_chunked_decrypt_range(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t frames[],
+        const size_t frames_len,
+        const uint64_t offset,
+        const size_t length,
+        uint8_t plaintext[]
+) {
+    AESBlakeChunkedInfo info;
+    uint64_t frames_offset, expected_len;
+    if (header_len % GROUP_BYTES != 0 ||
+        aes_blake_chunked_parse_header(index_header, &info) != AESBlakeStatus_OK ||
+        info.variant != AES_BLAKE256_CHUNKED_VARIANT ||
+        aes_blake_chunked_locate(&info, offset, length, &frames_offset, &expected_len) != AESBlakeStatus_OK ||
+        expected_len != frames_len) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    chunked_header_checksums(key_obj->init_state, knc, index_header, header, header_len, header_checksums);
+
+    ChunkedJob job = {0};
+    job.init_state = key_obj->init_state;
+    job.knc = knc;
+    job.info = &info;
+    job.header_checksums = header_checksums;
+    job.input = frames;
+    job.output = plaintext;
+    const uint64_t frame_bytes = info.chunk_bytes + TAG_BYTES;
+    job.first_chunk = (frames_offset - AES_BLAKE_CHUNKED_HEADER_BYTES) / frame_bytes;
+    job.chunk_count = (size_t)((frames_len + frame_bytes - 1) / frame_bytes);
+    job.offset = offset;
+    job.length = length;
+
+    const int failed = run_chunked(pool, chunked_decrypt_task, &job, frames_len);
+    secure_wipe(knc, sizeof(knc));
+    if (failed) {
+        secure_wipe(plaintext, length);
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/* Round keys of one block group in a key schedule, see aes_blake_schedule.h. */
+#define SCHEDULE_GROUP_KEYS  (BLOCK_COUNT * AES_BLAKE_ROUNDS)
+#define SCHEDULE_GROUP_BYTES (SCHEDULE_GROUP_KEYS * 16)
+
+
+/*
+ * Bytes of the key schedule of a message of `ciphertext_len` bytes with a
+ * `header_len` byte header, or 0 when the lengths are not whole groups or the
+ * schedule would not fit a size_t.
+ */
+size_t aes_blake256_schedule_size(const size_t ciphertext_len, const size_t header_len) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return 0;
+    }
+    const size_t groups = ciphertext_len / GROUP_BYTES + header_len / GROUP_BYTES + 1;
+    if (groups > (SIZE_MAX - AES_BLAKE_SCHEDULE_HEADER_BYTES) / SCHEDULE_GROUP_BYTES) {
+        return 0;
+    }
+    return AES_BLAKE_SCHEDULE_HEADER_BYTES + groups * SCHEDULE_GROUP_BYTES;
+}
+
+
+/*
+ * Derives the key schedule of every block counter that the decryption of a message
+ * with these lengths uses, see aes_blake_schedule.h. `schedule_len` must be
+ * `aes_blake256_schedule_size` of the same lengths.
+ */
+AESBlakeStatus aes_blake256_schedule_export(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const size_t ciphertext_len,
+        const size_t header_len,
+        uint8_t schedule[],
+        const size_t schedule_len
+) {
+    const size_t expected_len = aes_blake256_schedule_size(ciphertext_len, header_len);
+    if (expected_len == 0 || schedule_len != expected_len) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    const AESBlakeScheduleInfo info = {
+        AES_BLAKE256_SCHEDULE_VARIANT, ciphertext_len / GROUP_BYTES, header_len / GROUP_BYTES
+    };
+    aes_blake_schedule_format_header(&info, schedule);
+
+    uint8_t (*keys)[16] = (uint8_t (*)[16])(schedule + AES_BLAKE_SCHEDULE_HEADER_BYTES);
+    const size_t message_groups = (size_t)info.message_groups;
+    const size_t header_groups = (size_t)info.header_groups;
+    derive_group_keys(key_obj->init_state, knc, 0, KDFDomain_MSG, message_groups, keys, NULL);
+    keys += message_groups * SCHEDULE_GROUP_KEYS;
+    derive_group_keys(key_obj->init_state, knc, message_groups, KDFDomain_HDR, header_groups, keys, NULL);
+    keys += header_groups * SCHEDULE_GROUP_KEYS;
+    derive_group_keys(key_obj->init_state, knc, message_groups + header_groups, KDFDomain_CHK, 1, keys, NULL);
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt_with_key`, with the round keys read from a schedule
+ * exported for the same key, nonce and lengths, so that no keys are derived. A
+ * schedule of other lengths is rejected, one of another key or nonce fails the tag.
+ */
+AESBlakeStatus aes_blake256_decrypt_with_schedule(
+        const uint8_t schedule[],
+        const size_t schedule_len,
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    AESBlakeScheduleInfo info;
+    const size_t expected_len = aes_blake256_schedule_size(ciphertext_len, header_len);
+    if (expected_len == 0 || schedule_len != expected_len ||
+        aes_blake_schedule_parse_header(schedule, &info) != AESBlakeStatus_OK ||
+        info.variant != AES_BLAKE256_SCHEDULE_VARIANT ||
+        info.message_groups != ciphertext_len / GROUP_BYTES || info.header_groups != header_len / GROUP_BYTES) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    const uint8_t (*keys)[16] = (const uint8_t (*)[16])(schedule + AES_BLAKE_SCHEDULE_HEADER_BYTES);
+    const size_t message_groups = ciphertext_len / GROUP_BYTES;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    if (message_groups > 0) {
+        decrypt_summed_groups(ciphertext, plaintext, keys, NULL, message_groups, checksums);
+    }
+    keys += message_groups * SCHEDULE_GROUP_KEYS;
+
+    AES_BLAKE_STATS_START(header_start);
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    uint8_t batch[BATCH_BYTES];
+    for (size_t offset = 0; offset < header_len; offset += BATCH_BYTES) {
+        const size_t batch_len = batch_length(header_len, offset);
+        encrypt_keyed_groups(header + offset, batch, keys, NULL, batch_len / GROUP_BYTES);
+        checksum_groups(header_checksums, batch, batch_len);
+        keys += batch_len / GROUP_BYTES * SCHEDULE_GROUP_KEYS;
+    }
+    AES_BLAKE_STATS_STOP(header_start, AESBlakePhase_HEADER);
+
+    uint8_t expected_tag[TAG_BYTES];
+    encrypt_keyed_groups(checksums, expected_tag, keys, NULL, 1);
+    checksum_xor(expected_tag, header_checksums, GROUP_BYTES);
+    secure_wipe(checksums, sizeof(checksums));
+
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    if (!tags_equal) {
+        secure_wipe(plaintext, ciphertext_len);
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Encrypt or decrypt function for a group-aligned message range.
+ */
+typedef void (*RangeFunc)(
+    const uint32_t init_state[16],
+    const uint32_t knc[16],
+    const uint8_t input[],
+    uint8_t output[],
+    size_t length,
+    uint64_t first_group,
+    uint8_t checksums[GROUP_BYTES],
+    RangeScratch *scratch
+);
+
+
+/*
+ * Scratch of a streaming context, in its arena if it has one and `local` otherwise.
+ */
+static RangeScratch *ctx_scratch(const AESBlake256Ctx *ctx, RangeScratch *local) {
+    return ctx->scratch != NULL ? (RangeScratch *)ctx->scratch : local;
+}
+
+
+/*
+ * Starts a streaming AES-Blake256 operation. The message is passed with
+ * ctx_encrypt_update or ctx_decrypt_update, then the header with
+ * ctx_update_header, and the auth tag is produced or checked by the
+ * matching final function, which also wipes the context.
+ */
+void aes_blake256_ctx_init(
+        AESBlake256Ctx *ctx,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES]
+) {
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+    aes_blake256_ctx_init_with_key(ctx, &key_obj, nonce);
+    aes_blake256_key_wipe(&key_obj);
+}
+
+
+/*
+ * Same as `aes_blake256_ctx_init`, with the key and context taken from a key object.
+ */
+void aes_blake256_ctx_init_with_key(
+        AESBlake256Ctx *ctx,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES]
+) {
+    memset(ctx, 0, sizeof(*ctx));
+    memcpy(ctx->init_state, key_obj->init_state, sizeof(ctx->init_state));
+    compute_knc(key_obj, nonce, ctx->knc);
+    ctx->phase = CTX_PHASE_MESSAGE;
+    ctx->mode = CTX_MODE_NONE;
+}
+
+
+/* The context and its scratch each start on a cache line of the arena. */
+#define ARENA_ALIGN      64
+#define ARENA_CTX_BYTES  ((sizeof(AESBlake256Ctx) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+
+/*
+ * Bytes of arena that `aes_blake256_ctx_init_arena` needs for one context and
+ * all of its scratch memory, for an arena at any address.
+ */
+size_t aes_blake256_ctx_size(void) {
+    return ARENA_CTX_BYTES + sizeof(RangeScratch) + ARENA_ALIGN - 1;
+}
+
+
+/*
+ * Same as `aes_blake256_ctx_init_with_key`, with the context and all the round
+ * key and staging buffers of its update and final calls placed in the caller's
+ * arena of at least `aes_blake256_ctx_size()` bytes. The calls then touch no
+ * scratch memory outside the arena and never allocate. The final functions
+ * wipe the whole arena. Returns the context, or NULL if the arena is too small.
+ */
+AESBlake256Ctx *aes_blake256_ctx_init_arena(
+        void *arena,
+        const size_t arena_len,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES]
+) {
+    if (arena == NULL || arena_len < aes_blake256_ctx_size()) {
+        return NULL;
+    }
+    const uintptr_t address = (uintptr_t)arena;
+    uint8_t *base = (uint8_t *)arena + ((ARENA_ALIGN - address % ARENA_ALIGN) % ARENA_ALIGN);
+    AESBlake256Ctx *ctx = (AESBlake256Ctx *)base;
+    aes_blake256_ctx_init_with_key(ctx, key_obj, nonce);
+    ctx->scratch = base + ARENA_CTX_BYTES;
+    return ctx;
+}
+
+
+/*
+ * Feeds message bytes through `process`. Whole groups are written to `output`
+ * right away, a trailing partial group is buffered until the next call.
+ */
+static AESBlakeStatus ctx_update(
+        AESBlake256Ctx *ctx,
+        const int mode,
+        const RangeFunc process,
+        const uint8_t input[],
+        size_t input_len,
+        uint8_t output[],
+        size_t *output_len
+) {
+    *output_len = 0;
+    if (ctx->phase != CTX_PHASE_MESSAGE || (ctx->mode != CTX_MODE_NONE && ctx->mode != mode)) {
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    ctx->mode = mode;
+
+    RangeScratch local;
+    RangeScratch *scratch = ctx_scratch(ctx, &local);
+    size_t produced = 0;
+    if (ctx->partial_len > 0) {
+        const size_t missing = GROUP_BYTES - ctx->partial_len;
+        const size_t take = input_len < missing ? input_len : missing;
+        copy_bytes(ctx->partial + ctx->partial_len, input, take);
+        ctx->partial_len += take;
+        input += take;
+        input_len -= take;
+
+        if (ctx->partial_len < GROUP_BYTES) {
+            return AESBlakeStatus_OK;
+        }
+        process(
+            ctx->init_state, ctx->knc, ctx->partial, output, GROUP_BYTES, ctx->block_counter, ctx->checksums, scratch
+        );
+        ctx->block_counter += 1;
+        ctx->partial_len = 0;
+        produced = GROUP_BYTES;
+    }
+
+    const size_t aligned_len = input_len - input_len % GROUP_BYTES;
+    process(
+        ctx->init_state, ctx->knc, input, output + produced, aligned_len, ctx->block_counter, ctx->checksums, scratch
+    );
+    ctx->block_counter += aligned_len / GROUP_BYTES;
+    produced += aligned_len;
+
+    copy_bytes(ctx->partial, input + aligned_len, input_len - aligned_len);
+    ctx->partial_len = input_len - aligned_len;
+    *output_len = produced;
+    if (scratch == &local) {
+        wipe_scratch_keys(&local);
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Encrypts the next part of the message. Any length is accepted, `ciphertext`
+ * must have room for plaintext_len + AES_BLAKE256_GROUP_BYTES - 1 bytes and
+ * `ciphertext_len` receives the number of bytes written. The ciphertext may
+ * alias the plaintext only while every update length is a multiple of
+ * AES_BLAKE256_GROUP_BYTES.
+ */
+AESBlakeStatus aes_blake256_ctx_encrypt_update(
+        AESBlake256Ctx *ctx,
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        uint8_t ciphertext[],
+        size_t *ciphertext_len
+) {
+    return ctx_update(ctx, CTX_MODE_ENCRYPT, encrypt_range, plaintext, plaintext_len, ciphertext, ciphertext_len);
+}
+
+
+/*
+ * Decrypts the next part of the message, see aes_blake256_ctx_encrypt_update.
+ * The plaintext is unauthenticated until aes_blake256_ctx_decrypt_final succeeds.
+ */
+AESBlakeStatus aes_blake256_ctx_decrypt_update(
+        AESBlake256Ctx *ctx,
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        uint8_t plaintext[],
+        size_t *plaintext_len
+) {
+    return ctx_update(ctx, CTX_MODE_DECRYPT, decrypt_range, ciphertext, ciphertext_len, plaintext, plaintext_len);
+}
+
+
+/*
+ * Feeds the next part of the header. Header block counters continue after the
+ * message, so the message must be complete and group-aligned before the first call.
+ */
+AESBlakeStatus aes_blake256_ctx_update_header(
+        AESBlake256Ctx *ctx,
+        const uint8_t header[],
+        size_t header_len
+) {
+    if (ctx->phase == CTX_PHASE_DONE) {
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    if (ctx->phase == CTX_PHASE_MESSAGE) {
+        if (ctx->partial_len != 0) {
+            return AESBlakeStatus_INVALID_LENGTH;
+        }
+        ctx->phase = CTX_PHASE_HEADER;
+    }
+
+    RangeScratch local;
+    RangeScratch *scratch = ctx_scratch(ctx, &local);
+    if (ctx->partial_len > 0) {
+        const size_t missing = GROUP_BYTES - ctx->partial_len;
+        const size_t take = header_len < missing ? header_len : missing;
+        copy_bytes(ctx->partial + ctx->partial_len, header, take);
+        ctx->partial_len += take;
+        header += take;
+        header_len -= take;
+
+        if (ctx->partial_len < GROUP_BYTES) {
+            return AESBlakeStatus_OK;
+        }
+        checksum_header_range(
+            ctx->init_state, ctx->knc, ctx->partial, GROUP_BYTES, ctx->block_counter, ctx->header_checksums, scratch
+        );
+        ctx->block_counter += 1;
+        ctx->partial_len = 0;
+    }
+
+    const size_t aligned_len = header_len - header_len % GROUP_BYTES;
+    checksum_header_range(
+        ctx->init_state, ctx->knc, header, aligned_len, ctx->block_counter, ctx->header_checksums, scratch
+    );
+    ctx->block_counter += aligned_len / GROUP_BYTES;
+
+    copy_bytes(ctx->partial, header + aligned_len, header_len - aligned_len);
+    ctx->partial_len = header_len - aligned_len;
+    if (scratch == &local) {
+        wipe_scratch_keys(&local);
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Computes the auth tag of a streaming context whose message and header
+ * have both been fed completely.
+ */
+static AESBlakeStatus ctx_auth_tag(const AESBlake256Ctx *ctx, uint8_t auth_tag[TAG_BYTES]) {
+    if (ctx->phase == CTX_PHASE_DONE) {
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    if (ctx->partial_len != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    RangeScratch local;
+    RangeScratch *scratch = ctx_scratch(ctx, &local);
+    finish_auth_tag(
+        ctx->init_state, ctx->knc, ctx->block_counter, ctx->checksums, ctx->header_checksums, auth_tag, scratch
+    );
+    if (scratch == &local) {
+        wipe_scratch_keys(&local);
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+static void ctx_wipe(AESBlake256Ctx *ctx) {
+    if (ctx->scratch != NULL) {
+        secure_wipe(ctx->scratch, sizeof(RangeScratch));
+    }
+    secure_wipe(ctx, sizeof(*ctx));
+    ctx->phase = CTX_PHASE_DONE;
+}
+
+
+/*
+ * Outputs the auth tag of a streaming encryption and wipes the context.
+ * The total message and header lengths must be multiples of AES_BLAKE256_GROUP_BYTES.
+ */
+AESBlakeStatus aes_blake256_ctx_encrypt_final(
+        AESBlake256Ctx *ctx,
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (ctx->mode == CTX_MODE_DECRYPT) {
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    const AESBlakeStatus status = ctx_auth_tag(ctx, auth_tag);
+    if (status == AESBlakeStatus_OK) {
+        ctx_wipe(ctx);
+    }
+    return status;
+}
+
+
+/*
+ * Verifies the auth tag of a streaming decryption and wipes the context.
+ * On AESBlakeStatus_AUTH_FAILED all plaintext output must be discarded.
+ */
+AESBlakeStatus aes_blake256_ctx_decrypt_final(
+        AESBlake256Ctx *ctx,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (ctx->mode == CTX_MODE_ENCRYPT) {
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    uint8_t expected_tag[TAG_BYTES];
+    const AESBlakeStatus status = ctx_auth_tag(ctx, expected_tag);
+    if (status != AESBlakeStatus_OK) {
+        return status;
+    }
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    ctx_wipe(ctx);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    return tags_equal ? AESBlakeStatus_OK : AESBlakeStatus_AUTH_FAILED;
+}
+
+
+/* --- Multi-buffer streams --- */
+
+/* Consecutive groups a lane advances by per pass, and the round keys of one group. */
+#define MB_LANE_GROUPS 4
+#define MB_GROUP_KEYS  (BLOCK_COUNT * AES_BLAKE_ROUNDS)
+#define MB_PASS_GROUPS (AES_BLAKE_MB_MAX_LANES * MB_LANE_GROUPS)
+
+/* Updates from this size fill the wide kernels on their own and bypass the lanes. */
+#define MB_DIRECT_BYTES (BATCH_GROUPS * GROUP_BYTES)
+
+
+/*
+ * Sets up an empty multi-buffer manager with `lane_count` lanes, or
+ * AES_BLAKE256_MB_LANES for 0, and at most AES_BLAKE_MB_MAX_LANES.
+ */
+void aes_blake256_mb_init(AESBlake256MultiBuffer *mb, const size_t lane_count) {
+    memset(mb, 0, sizeof(*mb));
+    mb->lane_count = lane_count == 0 ? AES_BLAKE256_MB_LANES : lane_count;
+    if (mb->lane_count > AES_BLAKE_MB_MAX_LANES) {
+        mb->lane_count = AES_BLAKE_MB_MAX_LANES;
+    }
+}
+
+
+/*
+ * Returns the number of submitted jobs that the manager has not returned yet.
+ */
+size_t aes_blake256_mb_in_flight(const AESBlake256MultiBuffer *mb) {
+    size_t count = 0;
+    for (size_t i = 0; i < mb->lane_count; i++) {
+        count += mb->lanes[i].job != NULL;
+    }
+    return count;
+}
+
+
+static int mb_holds_ctx(const AESBlake256MultiBuffer *mb, const AESBlake256Ctx *ctx) {
+    for (size_t i = 0; i < mb->lane_count; i++) {
+        if (mb->lanes[i].job != NULL && mb->lanes[i].job->ctx == ctx) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Places a job in a free lane. Like `ctx_update`, bytes completing a partial group
+ * of the context go to its partial buffer, which then becomes the lead group of the
+ * lane. A job that completes no group, that is rejected, or that is large enough
+ * to run through the context on its own, is done right away.
+ */
+static void mb_place(AESBlake256MultiBuffer *mb, AESBlake256MbLane *lane, AESBlake256StreamJob *job) {
+    AESBlake256Ctx *ctx = job->ctx;
+    const int mode = job->decrypt ? CTX_MODE_DECRYPT : CTX_MODE_ENCRYPT;
+    job->status = AESBlakeStatus_OK;
+    job->output_len = 0;
+
+    memset(lane, 0, sizeof(*lane));
+    if (ctx->phase != CTX_PHASE_MESSAGE || (ctx->mode != CTX_MODE_NONE && ctx->mode != mode) || mb_holds_ctx(mb, ctx)) {
+        job->status = AESBlakeStatus_INVALID_STATE;
+        lane->job = job;
+        return;
+    }
+    lane->job = job;
+    if (job->input_len >= MB_DIRECT_BYTES) {
+        const RangeFunc process = job->decrypt ? decrypt_range : encrypt_range;
+        job->status = ctx_update(ctx, mode, process, job->input, job->input_len, job->output, &job->output_len);
+        return;
+    }
+    ctx->mode = mode;
+    lane->input = job->input;
+
+    size_t input_len = job->input_len;
+    if (ctx->partial_len > 0) {
+        const size_t missing = GROUP_BYTES - ctx->partial_len;
+        const size_t take = input_len < missing ? input_len : missing;
+        copy_bytes(ctx->partial + ctx->partial_len, job->input, take);
+        ctx->partial_len += take;
+        lane->input += take;
+        input_len -= take;
+
+        if (ctx->partial_len < GROUP_BYTES) {
+            return;
+        }
+        ctx->partial_len = 0;
+        lane->lead = 1;
+        lane->group_count = 1;
+    }
+    lane->group_count += input_len / GROUP_BYTES;
+    lane->tail_len = input_len % GROUP_BYTES;
+}
+
+
+static int mb_lane_done(const AESBlake256MbLane *lane) {
+    return lane->job != NULL && lane->groups_done == lane->group_count;
+}
+
+
+/*
+ * Stages the next `count` groups of a lane, its lead group coming from the partial buffer.
+ */
+static void mb_stage_groups(const AESBlake256MbLane *lane, uint8_t data[], const size_t count) {
+    size_t group = lane->groups_done;
+    if (lane->lead && group == 0) {
+        memcpy(data, lane->job->ctx->partial, GROUP_BYTES);
+        data += GROUP_BYTES;
+        group++;
+    }
+    const size_t whole_done = group - (size_t)lane->lead;
+    copy_bytes(data, lane->input + whole_done * GROUP_BYTES, (lane->groups_done + count - group) * GROUP_BYTES);
+}
+
+
+/*
+ * Masked pipeline version of the keygen and AES calls of `mb_pass`. The lanes
+ * have keys of their own, so each one goes through the range helpers separately
+ * and its round keys stay in two shares.
+ */
+static void mb_crypt_masked(
+        AESBlake256MbLane *const busy[],
+        const size_t first[],
+        const size_t taken[],
+        const size_t lanes,
+        const size_t encrypt_lanes,
+        uint8_t data[]
+) {
+    RangeScratch scratch;
+    for (size_t j = 0; j < lanes; j++) {
+        const AESBlake256Ctx *ctx = busy[j]->job->ctx;
+        uint8_t *groups = data + first[j] * GROUP_BYTES;
+        derive_group_keys(
+            ctx->init_state, ctx->knc, ctx->block_counter, KDFDomain_MSG, taken[j],
+            scratch.round_keys[0], scratch.key_masks[0]
+        );
+        if (j < encrypt_lanes) {
+            encrypt_keyed_groups(groups, groups, scratch.round_keys[0], scratch.key_masks[0], taken[j]);
+        } else {
+            decrypt_keyed_groups(groups, groups, scratch.round_keys[0], scratch.key_masks[0], taken[j]);
+        }
+    }
+    wipe_scratch_keys(&scratch);
+}
+
+
+/*
+ * Advances every busy lane by up to MB_LANE_GROUPS groups. The groups are staged
+ * lane by lane with the encrypting lanes first, so that the keys of all lanes are
+ * derived in one call and each direction is one AES backend call.
+ */
+static void mb_pass(AESBlake256MultiBuffer *mb) {
+    Blake32KeyJob jobs[MB_PASS_GROUPS];
+    uint8_t data[MB_PASS_GROUPS * GROUP_BYTES];
+    uint8_t round_keys[MB_PASS_GROUPS * MB_GROUP_KEYS][16];
+    AESBlake256MbLane *busy[AES_BLAKE_MB_MAX_LANES];
+    size_t first[AES_BLAKE_MB_MAX_LANES], taken[AES_BLAKE_MB_MAX_LANES];
+    size_t lanes = 0, count = 0, encrypt_count = 0, encrypt_lanes = 0;
+
+    for (int decrypt = 0; decrypt < 2; decrypt++) {
+        for (size_t i = 0; i < mb->lane_count; i++) {
+            AESBlake256MbLane *lane = &mb->lanes[i];
+            if (lane->job == NULL || mb_lane_done(lane) || (lane->job->decrypt != 0) != decrypt) {
+                continue;
+            }
+            const AESBlake256Ctx *ctx = lane->job->ctx;
+            const size_t left = lane->group_count - lane->groups_done;
+            const size_t take = left < MB_LANE_GROUPS ? left : MB_LANE_GROUPS;
+            for (size_t g = 0; g < take; g++) {
+                jobs[count + g] = (Blake32KeyJob){ctx->knc, ctx->block_counter + g, KDFDomain_MSG, ctx->init_state};
+            }
+            mb_stage_groups(lane, data + count * GROUP_BYTES, take);
+            busy[lanes] = lane;
+            first[lanes] = count;
+            taken[lanes++] = take;
+            count += take;
+        }
+        if (!decrypt) {
+            encrypt_count = count;
+            encrypt_lanes = lanes;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    for (size_t j = 0; j < encrypt_lanes; j++) {
+        checksum_groups(busy[j]->job->ctx->checksums, data + first[j] * GROUP_BYTES, taken[j] * GROUP_BYTES);
+    }
+    if (masked_pipeline()) {
+        mb_crypt_masked(busy, first, taken, lanes, encrypt_lanes, data);
+    } else {
+        AES_BLAKE_STATS_START(keygen_start);
+        blake32_derive_keys_jobs(jobs[0].init_state, jobs, AES_BLAKE_ROUNDS, count, round_keys);
+        AES_BLAKE_STATS_STOP(keygen_start, AESBlakePhase_KEYGEN);
+
+        const AES_Backend *backend = aes_select_backend();
+        AES_BLAKE_STATS_START(aes_start);
+        if (encrypt_count > 0) {
+            backend->encrypt_x2(data, data, round_keys, AES_BLAKE_ROUNDS, encrypt_count);
+        }
+        if (count > encrypt_count) {
+            backend->decrypt_x2(
+                data + encrypt_count * GROUP_BYTES,
+                data + encrypt_count * GROUP_BYTES,
+                &round_keys[encrypt_count * MB_GROUP_KEYS],
+                AES_BLAKE_ROUNDS,
+                count - encrypt_count
+            );
+        }
+        AES_BLAKE_STATS_STOP(aes_start, AESBlakePhase_AES);
+    }
+    for (size_t j = encrypt_lanes; j < lanes; j++) {
+        checksum_groups(busy[j]->job->ctx->checksums, data + first[j] * GROUP_BYTES, taken[j] * GROUP_BYTES);
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+        AESBlake256MbLane *lane = busy[j];
+        memcpy(lane->job->output + lane->groups_done * GROUP_BYTES, data + first[j] * GROUP_BYTES, taken[j] * GROUP_BYTES);
+        lane->job->ctx->block_counter += taken[j];
+        lane->groups_done += taken[j];
+    }
+    secure_wipe(data, count * GROUP_BYTES);
+}
+
+
+/*
+ * Runs passes until the busy lane with the fewest groups left is done.
+ */
+static void mb_run(AESBlake256MultiBuffer *mb) {
+    size_t fewest = 0;
+    int busy = 0;
+    for (size_t i = 0; i < mb->lane_count; i++) {
+        const AESBlake256MbLane *lane = &mb->lanes[i];
+        if (lane->job != NULL) {
+            const size_t left = lane->group_count - lane->groups_done;
+            fewest = !busy || left < fewest ? left : fewest;
+            busy = 1;
+        }
+    }
+    for (size_t pass = 0; pass < (fewest + MB_LANE_GROUPS - 1) / MB_LANE_GROUPS; pass++) {
+        mb_pass(mb);
+    }
+}
+
+
+/*
+ * Frees the first done lane and returns its job, after buffering the job's
+ * trailing partial group in the context, or returns NULL if no lane is done.
+ */
+static AESBlake256StreamJob *mb_pop(AESBlake256MultiBuffer *mb) {
+    for (size_t i = 0; i < mb->lane_count; i++) {
+        AESBlake256MbLane *lane = &mb->lanes[i];
+        if (!mb_lane_done(lane)) {
+            continue;
+        }
+        AESBlake256StreamJob *job = lane->job;
+        if (job->status == AESBlakeStatus_OK && (lane->group_count > 0 || lane->tail_len > 0)) {
+            const size_t whole_groups = lane->group_count - (size_t)lane->lead;
+            copy_bytes(job->ctx->partial, lane->input + whole_groups * GROUP_BYTES, lane->tail_len);
+            job->ctx->partial_len = lane->tail_len;
+            job->output_len = lane->group_count * GROUP_BYTES;
+        }
+        memset(lane, 0, sizeof(*lane));
+        return job;
+    }
+    return NULL;
+}
+
+
+/*
+ * Submits a message update of a streaming context to the manager and returns
+ * a completed job or NULL, see aes_blake_multibuffer.h. Passes run only when
+ * the job took the last free lane, so up to `lane_count` streams share them.
+ */
+AESBlake256StreamJob *aes_blake256_mb_submit(AESBlake256MultiBuffer *mb, AESBlake256StreamJob *job) {
+    size_t free_lanes = 0;
+    AESBlake256MbLane *free_lane = NULL;
+    for (size_t i = 0; i < mb->lane_count; i++) {
+        if (mb->lanes[i].job == NULL) {
+            free_lane = free_lane == NULL ? &mb->lanes[i] : free_lane;
+            free_lanes++;
+        }
+    }
+    mb_place(mb, free_lane, job);
+    if (free_lanes == 1) {
+        mb_run(mb);
+    }
+    return mb_pop(mb);
+}
+
+
+/*
+ * Runs the jobs in flight, with whatever lanes are busy, until one of them
+ * completes and returns it. Returns NULL once every job has been returned.
+ */
+AESBlake256StreamJob *aes_blake256_mb_flush(AESBlake256MultiBuffer *mb) {
+    mb_run(mb);
+    return mb_pop(mb);
+}
@@ -0,0 +1,177 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include "aes_block.h"
+#include "blake_cpu.h"
+#include "blake_types.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_fused.h"
+
+#if defined(BLAKE_ARCH_X86) && defined(AES_ARCH_X86)
+
+#include <wmmintrin.h>
+#include "blake32_rows_sse41.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FUSED_TARGET __attribute__((target("aes,sse4.1")))
+#else
+#define FUSED_TARGET
+#endif
+
+
+/*
+ * State words 4..7 in row 1 as a big-endian 128-bit round key, the byte
+ * order that `blake32_derive_keys` writes and the AES kernels load.
+ */
+static inline FUSED_TARGET __m128i round_key(const __m128i row1) {
+    const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm_shuffle_epi8(row1, bswap);
+}
+
+
+/*
+ * AES-Blake256 column exchange, the odd columns are swapped between the two blocks.
+ */
+static inline FUSED_TARGET void exchange_columns_x2(__m128i *a, __m128i *b) {
+    const __m128i t = _mm_blend_epi16(*a, *b, 0xCC);
+    *b = _mm_blend_epi16(*b, *a, 0xCC);
+    *a = t;
+}
+
+
+/*
+ * Encrypts one AES-Blake256 group in place, equivalent to `blake32_derive_keys` followed
+ * by `aes_encrypt_blocks_x2_aesni`. Each keygen round yields the round keys of both
+ * blocks in registers, which the AES round uses right away. Callers must check
+ * `aes_blake256_fused_usable` first.
+ */
+FUSED_TARGET void aes_blake256_fused_encrypt_group(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE256_GROUP_BYTES]
+) {
+    const uint8_t n_rounds = AES_BLAKE_ROUNDS - 1;
+    __m128i r1[4], r2[4], mr[4];
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_rows(mr, knc);
+
+    __m128i s0 = _mm_loadu_si128((const __m128i *)group);
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(group + 16));
+
+    // First round
+    mix_rows(r1, mr);
+    mix_rows(r2, mr);
+    s0 = _mm_xor_si128(s0, round_key(r1[1]));
+    s1 = _mm_xor_si128(s1, round_key(r2[1]));
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        permute_rows(mr);
+        mix_rows(r1, mr);
+        mix_rows(r2, mr);
+        exchange_columns_x2(&s0, &s1);
+        s0 = _mm_aesenc_si128(s0, round_key(r1[1]));
+        s1 = _mm_aesenc_si128(s1, round_key(r2[1]));
+    }
+
+    // Final round
+    permute_rows(mr);
+    mix_rows(r1, mr);
+    mix_rows(r2, mr);
+    s0 = _mm_aesenclast_si128(s0, round_key(r1[1]));
+    s1 = _mm_aesenclast_si128(s1, round_key(r2[1]));
+    exchange_columns_x2(&s0, &s1);
+
+    _mm_storeu_si128((__m128i *)group, s0);
+    _mm_storeu_si128((__m128i *)(group + 16), s1);
+}
+
+#else
+
+void aes_blake256_fused_encrypt_group(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE256_GROUP_BYTES]
+) {
+    (void)init_state;
+    (void)knc;
+    (void)block_counter;
+    (void)domain;
+    (void)group;
+}
+
+#endif
+
+
+/*
+ * Returns non-zero when the selected AES backend is an AES-NI one, which
+ * implies SSE4.1. Any other backend, including a forced one, keeps the
+ * separate keygen and AES passes, and so does a forced masked keygen.
+ */
+int aes_blake256_fused_usable(void) {
+#if defined(BLAKE_ARCH_X86) && defined(AES_ARCH_X86)
+    if (blake32_select_derive_keys() == blake32_masked_derive_keys) {
+        return 0;
+    }
+    const AES_BlocksFunc encrypt_x2 = aes_select_backend()->encrypt_x2;
+    return encrypt_x2 == aes_encrypt_blocks_x2_aesni
+        || encrypt_x2 == aes_encrypt_blocks_x2_vaes_avx2
+        || encrypt_x2 == aes_encrypt_blocks_x2_vaes_avx512;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Adapts `blake32_optimized_key_stream_next` to AES_RoundKeysFunc.
+ */
+static void next_stream_keys(void *ctx, uint8_t round_keys[][16]) {
+    blake32_optimized_key_stream_next((Blake32KeyStream *)ctx, round_keys);
+}
+
+
+/*
+ * Portable counterpart of `aes_blake256_fused_encrypt_group` for the T-table backend.
+ * A key stream yields the round keys of each AES round right before it, so only the
+ * Blake states and one round of keys are live instead of the whole key schedule.
+ * Callers must check `aes_blake256_lazy_usable` first.
+ */
+void aes_blake256_lazy_encrypt_group(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE256_GROUP_BYTES]
+) {
+    Blake32KeyStream stream;
+    blake32_optimized_key_stream_init(&stream, init_state, knc, block_counter, domain);
+    aes_encrypt_group_x2_lazy_optimized(group, group, AES_BLAKE_ROUNDS, next_stream_keys, &stream);
+}
+
+
+/*
+ * Returns non-zero when the selected AES backend is the T-table one.
+ * A forced masked keygen keeps the separate keygen and AES passes.
+ */
+int aes_blake256_lazy_usable(void) {
+    if (blake32_select_derive_keys() == blake32_masked_derive_keys) {
+        return 0;
+    }
+    return aes_select_backend()->encrypt_x2 == aes_encrypt_blocks_x2_optimized;
+}
@@ -0,0 +1,222 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_block.h"
+#include "blake_types.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_shared.h"
+#include "aes_blake_reduced.h"
+
+#define GROUP_BYTES  AES_BLAKE256_GROUP_BYTES
+#define TAG_BYTES    AES_BLAKE256_TAG_BYTES
+
+#define BATCH_GROUPS 8
+#define BATCH_BYTES  (BATCH_GROUPS * GROUP_BYTES)
+#define BATCH_KEYS   (BATCH_GROUPS * 2 * AES_BLAKE_ROUNDS)
+
+_Static_assert(AES_BLAKE_REDUCED_VERSION == BLAKE_REDUCED_PROFILE_VERSION, "cipher and keygen profile versions differ");
+
+
+/*
+ * Round keys of one batch and one batch of staged header output.
+ */
+typedef struct {
+    uint8_t round_keys[BATCH_KEYS][16];
+    uint8_t batch[BATCH_BYTES];
+} ReducedScratch;
+
+
+static void compute_knc(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        uint32_t knc[16]
+) {
+    uint32_t nonce_words[8];
+    load_words32_be(nonce_words, nonce, 8);
+    blake32_optimized_compute_knc(key_obj->key_words, nonce_words, knc);
+}
+
+
+static size_t batch_groups(const size_t length, const size_t offset) {
+    return (length - offset < BATCH_BYTES ? length - offset : BATCH_BYTES) / GROUP_BYTES;
+}
+
+
+/*
+ * Encrypts `length` bytes of plaintext in the MSG domain from block counter 0
+ * and XORs the plaintext groups into `checksums`.
+ */
+static void encrypt_message(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t plaintext[],
+        uint8_t ciphertext[],
+        const size_t length,
+        uint8_t checksums[GROUP_BYTES],
+        ReducedScratch *scratch
+) {
+    const AES_Backend *backend = aes_select_backend();
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES) {
+        const size_t group_count = batch_groups(length, offset);
+        blake32_derive_keys_many_reduced(
+            init_state, knc, AES_BLAKE_ROUNDS, offset / GROUP_BYTES, group_count, KDFDomain_MSG, scratch->round_keys
+        );
+        if (backend->encrypt_x2_sum != NULL) {
+            backend->encrypt_x2_sum(plaintext + offset, ciphertext + offset, scratch->round_keys, AES_BLAKE_ROUNDS, group_count, checksums);
+            continue;
+        }
+        for (size_t group = 0; group < group_count; group++) {
+            checksum_xor(checksums, plaintext + offset + group * GROUP_BYTES, GROUP_BYTES);
+        }
+        backend->encrypt_x2(plaintext + offset, ciphertext + offset, scratch->round_keys, AES_BLAKE_ROUNDS, group_count);
+    }
+}
+
+
+static void decrypt_message(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t ciphertext[],
+        uint8_t plaintext[],
+        const size_t length,
+        uint8_t checksums[GROUP_BYTES],
+        ReducedScratch *scratch
+) {
+    const AES_Backend *backend = aes_select_backend();
+    for (size_t offset = 0; offset < length; offset += BATCH_BYTES) {
+        const size_t group_count = batch_groups(length, offset);
+        blake32_derive_keys_many_reduced(
+            init_state, knc, AES_BLAKE_ROUNDS, offset / GROUP_BYTES, group_count, KDFDomain_MSG, scratch->round_keys
+        );
+        if (backend->decrypt_x2_sum != NULL) {
+            backend->decrypt_x2_sum(ciphertext + offset, plaintext + offset, scratch->round_keys, AES_BLAKE_ROUNDS, group_count, checksums);
+            continue;
+        }
+        backend->decrypt_x2(ciphertext + offset, plaintext + offset, scratch->round_keys, AES_BLAKE_ROUNDS, group_count);
+        for (size_t group = 0; group < group_count; group++) {
+            checksum_xor(checksums, plaintext + offset + group * GROUP_BYTES, GROUP_BYTES);
+        }
+    }
+}
+
+
+/*
+ * Same auth tag as the standard profile: header groups are encrypted in the HDR
+ * domain with block counters continuing after the message, the plaintext checksums
+ * in the CHK domain after the header, and the two results are XORed together.
+ */
+static void compute_auth_tag(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t header[],
+        const size_t header_len,
+        const uint64_t block_counter,
+        const uint8_t checksums[GROUP_BYTES],
+        uint8_t auth_tag[TAG_BYTES],
+        ReducedScratch *scratch
+) {
+    const AES_Backend *backend = aes_select_backend();
+    uint8_t header_checksums[GROUP_BYTES] = {0};
+    for (size_t offset = 0; offset < header_len; offset += BATCH_BYTES) {
+        const size_t group_count = batch_groups(header_len, offset);
+        blake32_derive_keys_many_reduced(
+            init_state, knc, AES_BLAKE_ROUNDS, block_counter + offset / GROUP_BYTES, group_count, KDFDomain_HDR, scratch->round_keys
+        );
+        backend->encrypt_x2(header + offset, scratch->batch, scratch->round_keys, AES_BLAKE_ROUNDS, group_count);
+        for (size_t group = 0; group < group_count; group++) {
+            checksum_xor(header_checksums, scratch->batch + group * GROUP_BYTES, GROUP_BYTES);
+        }
+    }
+
+    const uint64_t chk_counter = block_counter + header_len / GROUP_BYTES;
+    uint8_t group[GROUP_BYTES];
+    blake32_derive_keys_many_reduced(init_state, knc, AES_BLAKE_ROUNDS, chk_counter, 1, KDFDomain_CHK, scratch->round_keys);
+    backend->encrypt_x2(checksums, group, scratch->round_keys, AES_BLAKE_ROUNDS, 1);
+    checksum_xor(group, header_checksums, GROUP_BYTES);
+    memcpy(auth_tag, group, TAG_BYTES);
+}
+
+
+/*
+ * Encrypts the plaintext with the reduced keygen profile, see aes_blake_reduced.h.
+ * Lengths must be multiples of AES_BLAKE256_GROUP_BYTES, the ciphertext may alias
+ * the plaintext.
+ */
+AESBlakeStatus aes_blake256_reduced_encrypt(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (plaintext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    ReducedScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    encrypt_message(key_obj->init_state, knc, plaintext, ciphertext, plaintext_len, checksums, &scratch);
+    compute_auth_tag(key_obj->init_state, knc, header, header_len, plaintext_len / GROUP_BYTES, checksums, auth_tag, &scratch);
+    secure_wipe(&scratch, sizeof(scratch));
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(knc, sizeof(knc));
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Decrypts a ciphertext of `aes_blake256_reduced_encrypt` and verifies its
+ * auth tag. On AESBlakeStatus_AUTH_FAILED the plaintext buffer is zeroed.
+ */
+AESBlakeStatus aes_blake256_reduced_decrypt(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    if (ciphertext_len % GROUP_BYTES != 0 || header_len % GROUP_BYTES != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+
+    uint32_t knc[16];
+    compute_knc(key_obj, nonce, knc);
+
+    ReducedScratch scratch;
+    uint8_t checksums[GROUP_BYTES] = {0};
+    uint8_t expected_tag[TAG_BYTES];
+    decrypt_message(key_obj->init_state, knc, ciphertext, plaintext, ciphertext_len, checksums, &scratch);
+    compute_auth_tag(key_obj->init_state, knc, header, header_len, ciphertext_len / GROUP_BYTES, checksums, expected_tag, &scratch);
+    secure_wipe(&scratch, sizeof(scratch));
+    secure_wipe(checksums, sizeof(checksums));
+    secure_wipe(knc, sizeof(knc));
+
+    const int tags_equal = auth_tags_equal(expected_tag, auth_tag, TAG_BYTES);
+    secure_wipe(expected_tag, sizeof(expected_tag));
+    if (!tags_equal) {
+        secure_wipe(plaintext, ciphertext_len);
+        return AESBlakeStatus_AUTH_FAILED;
+    }
+    return AESBlakeStatus_OK;
+}
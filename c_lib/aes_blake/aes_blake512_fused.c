@@ -0,0 +1,223 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include "aes_block.h"
+#include "blake_cpu.h"
+#include "blake_types.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_fused.h"
+
+#if defined(BLAKE_ARCH_X86) && defined(AES_ARCH_X86)
+
+#include <wmmintrin.h>
+#include "blake64_rows_avx2.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FUSED_TARGET __attribute__((target("aes,avx2")))
+#else
+#define FUSED_TARGET
+#endif
+
+
+/*
+ * State words 4/5 and 6/7 in row 1 as two big-endian 128-bit round keys, the
+ * byte order that `blake64_derive_keys` writes and the AES kernels load.
+ */
+static inline FUSED_TARGET void round_keys(__m128i *key_a, __m128i *key_b, const __m256i row1) {
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    );
+    const __m256i keys = _mm256_shuffle_epi8(row1, bswap);
+    *key_a = _mm256_castsi256_si128(keys);
+    *key_b = _mm256_extracti128_si256(keys, 1);
+}
+
+
+/*
+ * Returns the vector made of column 0 of `a`, column 1 of `b`, column 2 of `c` and column 3 of `d`.
+ */
+static inline FUSED_TARGET __m128i pick_columns(
+        const __m128i a,
+        const __m128i b,
+        const __m128i c,
+        const __m128i d
+) {
+    const __m128i ab = _mm_blend_epi16(a, b, 0x0C);
+    const __m128i cd = _mm_blend_epi16(c, d, 0xC0);
+    return _mm_blend_epi16(ab, cd, 0xF0);
+}
+
+
+/*
+ * AES-Blake512 column exchange, column `c` of block `i` comes from block `(i + c) % 4`.
+ */
+static inline FUSED_TARGET void exchange_columns_x4(__m128i s[4]) {
+    const __m128i t0 = pick_columns(s[0], s[1], s[2], s[3]);
+    const __m128i t1 = pick_columns(s[1], s[2], s[3], s[0]);
+    const __m128i t2 = pick_columns(s[2], s[3], s[0], s[1]);
+    const __m128i t3 = pick_columns(s[3], s[0], s[1], s[2]);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+/*
+ * Runs one keygen round on both states and returns the round keys of the four blocks.
+ */
+static inline FUSED_TARGET void next_round_keys(
+        __m256i r1[4],
+        __m256i r2[4],
+        const __m256i ms[4],
+        __m128i keys[4]
+) {
+    mix_rows(r1, ms);
+    mix_rows(r2, ms);
+    round_keys(&keys[0], &keys[1], r1[1]);
+    round_keys(&keys[2], &keys[3], r2[1]);
+}
+
+
+/*
+ * Encrypts one AES-Blake512 group in place, equivalent to `blake64_derive_keys` followed
+ * by `aes_encrypt_blocks_x4_aesni`, see `aes_blake256_fused_encrypt_group`.
+ */
+FUSED_TARGET void aes_blake512_fused_encrypt_group(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE512_GROUP_BYTES]
+) {
+    const uint8_t n_rounds = AES_BLAKE_ROUNDS - 1;
+    __m256i r1[4], r2[4], ms[4];
+    __m128i s[4], keys[4];
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_schedule(ms, knc);
+
+    // First round
+    next_round_keys(r1, r2, ms, keys);
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(group + 16 * i)), keys[i]);
+    }
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        permute_schedule(ms);
+        next_round_keys(r1, r2, ms, keys);
+        exchange_columns_x4(s);
+        for (int i = 0; i < 4; i++) {
+            s[i] = _mm_aesenc_si128(s[i], keys[i]);
+        }
+    }
+
+    // Final round
+    permute_schedule(ms);
+    next_round_keys(r1, r2, ms, keys);
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_aesenclast_si128(s[i], keys[i]);
+    }
+    exchange_columns_x4(s);
+
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(group + 16 * i), s[i]);
+    }
+}
+
+#else
+
+void aes_blake512_fused_encrypt_group(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE512_GROUP_BYTES]
+) {
+    (void)init_state;
+    (void)knc;
+    (void)block_counter;
+    (void)domain;
+    (void)group;
+}
+
+#endif
+
+
+/*
+ * Returns non-zero when the selected AES backend is an AES-NI one and the CPU
+ * supports AVX2 for the keygen rows. Any other backend, including a forced one,
+ * keeps the separate keygen and AES passes, and so does a forced masked keygen.
+ * The AVX2 check is cached on first use, detection is deterministic so
+ * concurrent first calls store the same value.
+ */
+int aes_blake512_fused_usable(void) {
+#if defined(BLAKE_ARCH_X86) && defined(AES_ARCH_X86)
+    if (blake64_select_derive_keys() == blake64_masked_derive_keys) {
+        return 0;
+    }
+    static int avx2_support = -1;
+    if (avx2_support < 0) {
+        avx2_support = blake_cpu_has_avx2();
+    }
+    const AES_BlocksFunc encrypt_x4 = aes_select_backend()->encrypt_x4;
+    return avx2_support && (
+        encrypt_x4 == aes_encrypt_blocks_x4_aesni
+        || encrypt_x4 == aes_encrypt_blocks_x4_vaes_avx2
+        || encrypt_x4 == aes_encrypt_blocks_x4_vaes_avx512
+    );
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Adapts `blake64_optimized_key_stream_next` to AES_RoundKeysFunc.
+ */
+static void next_stream_keys(void *ctx, uint8_t round_keys[][16]) {
+    blake64_optimized_key_stream_next((Blake64KeyStream *)ctx, round_keys);
+}
+
+
+/*
+ * Portable counterpart of `aes_blake512_fused_encrypt_group` for the T-table backend.
+ * A key stream yields the round keys of each AES round right before it, so only the
+ * Blake states and one round of keys are live instead of the whole key schedule.
+ * Callers must check `aes_blake512_lazy_usable` first.
+ */
+void aes_blake512_lazy_encrypt_group(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t group[AES_BLAKE512_GROUP_BYTES]
+) {
+    Blake64KeyStream stream;
+    blake64_optimized_key_stream_init(&stream, init_state, knc, block_counter, domain);
+    aes_encrypt_group_x4_lazy_optimized(group, group, AES_BLAKE_ROUNDS, next_stream_keys, &stream);
+}
+
+
+/*
+ * Returns non-zero when the selected AES backend is the T-table one.
+ * A forced masked keygen keeps the separate keygen and AES passes.
+ */
+int aes_blake512_lazy_usable(void) {
+    if (blake64_select_derive_keys() == blake64_masked_derive_keys) {
+        return 0;
+    }
+    return aes_select_backend()->encrypt_x4 == aes_encrypt_blocks_x4_optimized;
+}
@@ -0,0 +1,135 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_blake_chunked.h"
+
+static const uint8_t CHUNKED_MAGIC[4] = {'A', 'B', 'C', 'K'};
+
+
+static void store_be(uint8_t out[], const uint64_t value, const size_t byte_count) {
+    for (size_t i = 0; i < byte_count; i++) {
+        out[i] = (uint8_t)(value >> (8 * (byte_count - 1 - i)));
+    }
+}
+
+
+static uint64_t load_be(const uint8_t in[], const size_t byte_count) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < byte_count; i++) {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+
+/*
+ * Describes the container of a `plaintext_len` byte message. The chunk size must
+ * be a whole number of groups of the variant and fit the 32-bit header field.
+ */
+AESBlakeStatus aes_blake_chunked_info_init(
+        AESBlakeChunkedInfo *info,
+        const int variant,
+        const uint64_t plaintext_len,
+        const uint64_t chunk_bytes
+) {
+    if (variant != AES_BLAKE256_CHUNKED_VARIANT && variant != AES_BLAKE512_CHUNKED_VARIANT) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    const size_t group_bytes = variant == AES_BLAKE256_CHUNKED_VARIANT ? AES_BLAKE256_GROUP_BYTES : AES_BLAKE512_GROUP_BYTES;
+    if (chunk_bytes == 0 || chunk_bytes % group_bytes != 0 || chunk_bytes > UINT32_MAX || plaintext_len > UINT64_MAX / 4) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    info->variant = variant;
+    info->chunk_bytes = chunk_bytes;
+    info->plaintext_len = plaintext_len;
+    info->chunk_count = plaintext_len == 0 ? 1 : (plaintext_len + chunk_bytes - 1) / chunk_bytes;
+    info->group_bytes = group_bytes;
+    info->tag_bytes = variant == AES_BLAKE256_CHUNKED_VARIANT ? AES_BLAKE256_TAG_BYTES : AES_BLAKE512_TAG_BYTES;
+    return AESBlakeStatus_OK;
+}
+
+
+void aes_blake_chunked_format_header(
+        const AESBlakeChunkedInfo *info,
+        uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES]
+) {
+    memset(index_header, 0, AES_BLAKE_CHUNKED_HEADER_BYTES);
+    memcpy(index_header, CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC));
+    index_header[4] = AES_BLAKE_CHUNKED_VERSION;
+    index_header[5] = info->variant == AES_BLAKE256_CHUNKED_VARIANT ? 1 : 2;
+    store_be(index_header + 8, info->chunk_bytes, 4);
+    store_be(index_header + 16, info->plaintext_len, 8);
+}
+
+
+/*
+ * Reads an index header. The header is only authenticated by the chunk tags,
+ * so a parsed header must not be trusted before a range has been decrypted.
+ */
+AESBlakeStatus aes_blake_chunked_parse_header(
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        AESBlakeChunkedInfo *info
+) {
+    const uint64_t reserved = load_be(index_header + 6, 2) | load_be(index_header + 12, 4) | load_be(index_header + 24, 8);
+    if (memcmp(index_header, CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC)) != 0 ||
+        index_header[4] != AES_BLAKE_CHUNKED_VERSION || reserved != 0 ||
+        (index_header[5] != 1 && index_header[5] != 2)) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    const int variant = index_header[5] == 1 ? AES_BLAKE256_CHUNKED_VARIANT : AES_BLAKE512_CHUNKED_VARIANT;
+    return aes_blake_chunked_info_init(info, variant, load_be(index_header + 16, 8), load_be(index_header + 8, 4));
+}
+
+
+/*
+ * Ciphertext bytes of chunk `chunk`, its plaintext rounded up to whole groups.
+ */
+static uint64_t chunk_ciphertext_len(const AESBlakeChunkedInfo *info, const uint64_t chunk) {
+    const uint64_t begin = chunk * info->chunk_bytes;
+    const uint64_t end = begin + info->chunk_bytes < info->plaintext_len ? begin + info->chunk_bytes : info->plaintext_len;
+    return (end - begin + info->group_bytes - 1) / info->group_bytes * info->group_bytes;
+}
+
+
+uint64_t aes_blake_chunked_container_size(const AESBlakeChunkedInfo *info) {
+    const uint64_t last = info->chunk_count - 1;
+    const uint64_t frames = last * (info->chunk_bytes + info->tag_bytes) + chunk_ciphertext_len(info, last) + info->tag_bytes;
+    return AES_BLAKE_CHUNKED_HEADER_BYTES + frames;
+}
+
+
+/*
+ * Finds the frames that must be read to decrypt plaintext bytes [offset, offset + length),
+ * as an offset into the container and a byte count. A range of zero bytes maps to
+ * the frame of the chunk holding `offset`, so that even an empty message is verified.
+ */
+AESBlakeStatus aes_blake_chunked_locate(
+        const AESBlakeChunkedInfo *info,
+        const uint64_t offset,
+        const uint64_t length,
+        uint64_t *frames_offset,
+        uint64_t *frames_len
+) {
+    if (offset > info->plaintext_len || length > info->plaintext_len - offset) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    const uint64_t frame_bytes = info->chunk_bytes + info->tag_bytes;
+    uint64_t first = offset / info->chunk_bytes;
+    first = first < info->chunk_count ? first : info->chunk_count - 1;
+    const uint64_t last = length > 0 ? (offset + length - 1) / info->chunk_bytes : first;
+
+    *frames_offset = AES_BLAKE_CHUNKED_HEADER_BYTES + first * frame_bytes;
+    *frames_len = (last - first) * frame_bytes + chunk_ciphertext_len(info, last) + info->tag_bytes;
+    return AESBlakeStatus_OK;
+}
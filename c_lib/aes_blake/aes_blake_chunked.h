@@ -0,0 +1,149 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_CHUNKED_H
+#define AES_BLAKE_CHUNKED_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * Seekable chunked container. The plaintext is split into chunks of
+     * `chunk_bytes`, each stored as a frame of its ciphertext and its own auth tag:
+     *
+     *     index header || ct_0 || tag_0 || ct_1 || tag_1 || ... || ct_n-1 || tag_n-1
+     *
+     * Chunk `i` is encrypted at the block counters of its groups within the whole
+     * message, so any range can be decrypted by going straight to its counter, and
+     * its checksum is finalized in the CHK domain at block counter `i`. The last
+     * chunk is zero padded to whole groups, an empty message has one empty chunk.
+     * The index header and the user header are checksummed in the HDR domain,
+     * index header first, and the result is folded into every chunk tag, which
+     * binds each chunk to its position, the chunk size and the message length.
+     *
+     * Index header, integers big endian:
+     *
+     *     0..3   magic "ABCK"        8..11   chunk_bytes          16..23  plaintext_len
+     *     4      format version 1    12..15  reserved, zero       24..31  reserved, zero
+     *     5      1 for AES-Blake256 and 2 for AES-Blake512, 6..7 reserved, zero
+     */
+    #define AES_BLAKE_CHUNKED_HEADER_BYTES        32
+    #define AES_BLAKE_CHUNKED_VERSION             1
+    #define AES_BLAKE_CHUNKED_DEFAULT_CHUNK_BYTES (64 * 1024)
+
+    #define AES_BLAKE256_CHUNKED_VARIANT 256
+    #define AES_BLAKE512_CHUNKED_VARIANT 512
+
+    typedef struct {
+        int variant;
+        uint64_t chunk_bytes;
+        uint64_t plaintext_len;
+        uint64_t chunk_count;
+        size_t group_bytes;
+        size_t tag_bytes;
+    } AESBlakeChunkedInfo;
+
+    AESBlakeStatus aes_blake_chunked_info_init(
+        AESBlakeChunkedInfo *info,
+        int variant,
+        uint64_t plaintext_len,
+        uint64_t chunk_bytes
+    );
+
+    void aes_blake_chunked_format_header(
+        const AESBlakeChunkedInfo *info,
+        uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES]
+    );
+
+    AESBlakeStatus aes_blake_chunked_parse_header(
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        AESBlakeChunkedInfo *info
+    );
+
+    uint64_t aes_blake_chunked_container_size(const AESBlakeChunkedInfo *info);
+
+    AESBlakeStatus aes_blake_chunked_locate(
+        const AESBlakeChunkedInfo *info,
+        uint64_t offset,
+        uint64_t length,
+        uint64_t *frames_offset,
+        uint64_t *frames_len
+    );
+
+    AESBlakeStatus aes_blake256_chunked_encrypt(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        size_t chunk_bytes,
+        uint8_t container[]
+    );
+
+    AESBlakeStatus aes_blake256_chunked_decrypt_range(
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t frames[],
+        size_t frames_len,
+        uint64_t offset,
+        size_t length,
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_chunked_encrypt(
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        size_t chunk_bytes,
+        uint8_t container[]
+    );
+
+    AESBlakeStatus aes_blake512_chunked_decrypt_range(
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t index_header[AES_BLAKE_CHUNKED_HEADER_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t frames[],
+        size_t frames_len,
+        uint64_t offset,
+        size_t length,
+        uint8_t plaintext[]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_CHUNKED_H
@@ -0,0 +1,517 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_blake_file.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#define FILE_USE_MMAP 0
+#include <io.h>
+#else
+#define FILE_USE_MMAP 1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#define PADDING_MARKER 0x80
+
+
+typedef AESBlakeStatus (*EncryptParallelFunc)(
+    AESBlakePool *, const uint8_t *, const uint8_t *, const uint8_t *,
+    const uint8_t *, size_t, const uint8_t *, size_t, uint8_t *, uint8_t *
+);
+
+typedef AESBlakeStatus (*DecryptParallelFunc)(
+    AESBlakePool *, const uint8_t *, const uint8_t *, const uint8_t *,
+    const uint8_t *, size_t, const uint8_t *, size_t, const uint8_t *, uint8_t *
+);
+
+
+typedef struct {
+    size_t group_bytes;
+    size_t tag_bytes;
+    EncryptParallelFunc encrypt;
+    DecryptParallelFunc decrypt;
+} FileVariant;
+
+static const FileVariant variant256 = {
+    AES_BLAKE256_GROUP_BYTES,
+    AES_BLAKE256_TAG_BYTES,
+    aes_blake256_encrypt_parallel,
+    aes_blake256_decrypt_parallel
+};
+
+static const FileVariant variant512 = {
+    AES_BLAKE512_GROUP_BYTES,
+    AES_BLAKE512_TAG_BYTES,
+    aes_blake512_encrypt_parallel,
+    aes_blake512_decrypt_parallel
+};
+
+
+/*
+ * Contents of the input file followed by `extra` writable zero bytes, so that
+ * the padding can be appended in place.
+ */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t map_len;
+#if FILE_USE_MMAP
+    dev_t dev;
+    ino_t ino;
+#endif
+} InputFile;
+
+
+/*
+ * Writable view of the first `len` bytes of the output file. The bytes go to a
+ * temporary file next to `path`, which only replaces `path` once the whole
+ * operation succeeded.
+ */
+typedef struct {
+    const char *path;
+    char *tmp_path;
+    uint8_t *data;
+    size_t len;
+#if FILE_USE_MMAP
+    int fd;
+#else
+    FILE *file;
+#endif
+} OutputFile;
+
+
+/* Returns `path` with the given suffix appended, or NULL when out of memory. */
+static char *temp_path(const char *path, const char *suffix) {
+    const size_t path_len = strlen(path);
+    const size_t suffix_len = strlen(suffix);
+    char *tmp = malloc(path_len + suffix_len + 1);
+    if (tmp != NULL) {
+        memcpy(tmp, path, path_len);
+        memcpy(tmp + path_len, suffix, suffix_len + 1);
+    }
+    return tmp;
+}
+
+
+#if FILE_USE_MMAP
+
+static void advise_sequential(void *addr, const size_t len, const int prefetch) {
+    if (len == 0) {
+        return;
+    }
+    madvise(addr, len, MADV_SEQUENTIAL);
+    if (prefetch) {
+        madvise(addr, len, MADV_WILLNEED);
+    }
+#if defined(MADV_HUGEPAGE)
+    madvise(addr, len, MADV_HUGEPAGE);
+#endif
+}
+
+
+/*
+ * Reserves an anonymous zero mapping of the padded size and maps the file
+ * privately over its start. The bytes between the end of file and the end of
+ * its last page read as zero and the following pages are anonymous, so the
+ * padding costs one copy-on-write page instead of a copy of the whole file.
+ */
+static int open_input(const char *path, const size_t extra, InputFile *in) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size > SIZE_MAX - extra - page) {
+        close(fd);
+        return 0;
+    }
+    in->len = (size_t)st.st_size;
+    in->map_len = (in->len + extra + page - 1) / page * page;
+    in->data = NULL;
+    in->dev = st.st_dev;
+    in->ino = st.st_ino;
+
+    if (in->map_len > 0) {
+        void *base = mmap(NULL, in->map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        if (in->len > 0) {
+            const int prot = PROT_READ | PROT_WRITE;
+            if (mmap(base, in->len, prot, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(base, in->map_len);
+                close(fd);
+                return 0;
+            }
+        }
+        in->data = base;
+        advise_sequential(in->data, in->len, 1);
+    }
+    close(fd);
+    return 1;
+}
+
+
+static void close_input(InputFile *in) {
+    if (in->data != NULL) {
+        munmap(in->data, in->map_len);
+    }
+}
+
+
+/*
+ * Creates a temporary output with its final size next to `path` and maps it
+ * shared, so that the workers of the pool write the result directly into the
+ * page cache. The blocks are allocated up front, a full disk fails here instead
+ * of raising SIGBUS while the mapping is written back. An existing file at
+ * `path` is left alone until `close_output` renames the result over it.
+ */
+static int open_output(const char *path, const InputFile *in, const size_t len, OutputFile *out) {
+    out->path = path;
+    out->data = NULL;
+    out->len = len;
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_dev == in->dev && st.st_ino == in->ino) {
+        return 0;
+    }
+    out->tmp_path = temp_path(path, ".XXXXXX");
+    if (out->tmp_path == NULL) {
+        return 0;
+    }
+    out->fd = mkstemp(out->tmp_path);
+    if (out->fd < 0) {
+        free(out->tmp_path);
+        return 0;
+    }
+    fcntl(out->fd, F_SETFD, FD_CLOEXEC);
+    int ok = ftruncate(out->fd, (off_t)len) == 0;
+#if defined(__linux__)
+    ok = ok && (len == 0 || posix_fallocate(out->fd, 0, (off_t)len) != ENOSPC);
+#endif
+    if (ok && len > 0) {
+        void *data = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, out->fd, 0);
+        ok = data != MAP_FAILED;
+        if (ok) {
+            out->data = data;
+            advise_sequential(out->data, len, 0);
+        }
+    }
+    if (!ok) {
+        close(out->fd);
+        unlink(out->tmp_path);
+        free(out->tmp_path);
+    }
+    return ok;
+}
+
+
+/*
+ * Flushes the directory entry of `path` to disk. File systems that cannot sync
+ * a directory report EINVAL, which is not treated as an error.
+ */
+static int sync_parent_dir(const char *path) {
+    char *dir = temp_path(path, "");
+    if (dir == NULL) {
+        return 0;
+    }
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+        dir[0] = '.';
+        dir[1] = '\0';
+    } else if (slash == dir) {
+        dir[1] = '\0';
+    } else {
+        slash[0] = '\0';
+    }
+    const int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int ok = fd >= 0 && (fsync(fd) == 0 || errno == EINVAL);
+    if (fd >= 0) {
+        ok = close(fd) == 0 && ok;
+    }
+    free(dir);
+    return ok;
+}
+
+
+/*
+ * Keeps the first `keep_len` bytes of the output and renames it over the target
+ * path, or removes the temporary file if `keep` is zero. The file is synced
+ * before the rename and its directory after it, so that a crash leaves either
+ * the old file or the complete new one at `path`.
+ */
+static int close_output(OutputFile *out, const size_t keep_len, const int keep) {
+    if (out->data != NULL) {
+        munmap(out->data, out->len);
+    }
+    // With keep zero the file is removed below, so it is neither truncated nor synced
+    int ok = keep && ftruncate(out->fd, (off_t)keep_len) == 0;
+    ok = ok && fsync(out->fd) == 0;
+    ok = close(out->fd) == 0 && ok;
+    ok = ok && rename(out->tmp_path, out->path) == 0;
+    if (!ok) {
+        unlink(out->tmp_path);
+    }
+    free(out->tmp_path);
+    return ok && sync_parent_dir(out->path);
+}
+
+#else
+
+/*
+ * Portable fallback without memory mapping, the whole file is read into memory.
+ */
+static int open_input(const char *path, const size_t extra, InputFile *in) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    int ok = _fseeki64(file, 0, SEEK_END) == 0;
+    const long long size = ok ? _ftelli64(file) : -1;
+    ok = size >= 0 && (unsigned long long)size <= SIZE_MAX - extra - 1 && _fseeki64(file, 0, SEEK_SET) == 0;
+    if (ok) {
+        in->len = (size_t)size;
+        in->map_len = in->len + extra;
+        in->data = calloc(in->map_len + 1, 1);
+        ok = in->data != NULL && fread(in->data, 1, in->len, file) == in->len;
+        if (!ok) {
+            free(in->data);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+
+static void close_input(InputFile *in) {
+    free(in->data);
+}
+
+
+static int open_output(const char *path, const InputFile *in, const size_t len, OutputFile *out) {
+    (void)in;
+    out->path = path;
+    out->len = len;
+    out->tmp_path = temp_path(path, ".tmp");
+    out->data = calloc(len + 1, 1);
+    if (out->tmp_path == NULL || out->data == NULL) {
+        free(out->tmp_path);
+        free(out->data);
+        return 0;
+    }
+    out->file = fopen(out->tmp_path, "wb");
+    if (out->file == NULL) {
+        free(out->tmp_path);
+        free(out->data);
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * Windows does not rename over an existing file, the target is removed first.
+ * The file is committed to disk before it replaces the target.
+ */
+static int close_output(OutputFile *out, const size_t keep_len, const int keep) {
+    int ok = keep && fwrite(out->data, 1, keep_len, out->file) == keep_len;
+    ok = ok && fflush(out->file) == 0 && _commit(_fileno(out->file)) == 0;
+    ok = fclose(out->file) == 0 && ok;
+    free(out->data);
+    if (ok) {
+        remove(out->path);
+        ok = rename(out->tmp_path, out->path) == 0;
+    }
+    if (!ok) {
+        remove(out->tmp_path);
+    }
+    free(out->tmp_path);
+    return ok;
+}
+
+#endif
+
+
+static AESBlakeStatus encrypt_file(
+        const FileVariant *variant,
+        AESBlakePool *pool,
+        const uint8_t *key,
+        const uint8_t *nonce,
+        const uint8_t *context,
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    if (header_len % variant->group_bytes != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    InputFile in;
+    if (!open_input(input_path, variant->group_bytes, &in)) {
+        return AESBlakeStatus_IO_ERROR;
+    }
+    const size_t padded_len = in.len / variant->group_bytes * variant->group_bytes + variant->group_bytes;
+    in.data[in.len] = PADDING_MARKER;
+
+    OutputFile out;
+    if (!open_output(output_path, &in, padded_len + variant->tag_bytes, &out)) {
+        close_input(&in);
+        return AESBlakeStatus_IO_ERROR;
+    }
+    AESBlakeStatus status = variant->encrypt(
+        pool, key, nonce, context,
+        in.data, padded_len,
+        header, header_len,
+        out.data, out.data + padded_len
+    );
+    if (!close_output(&out, out.len, status == AESBlakeStatus_OK) && status == AESBlakeStatus_OK) {
+        status = AESBlakeStatus_IO_ERROR;
+    }
+    close_input(&in);
+    return status;
+}
+
+
+/*
+ * Returns the length of the plaintext before the padding of the last group,
+ * or SIZE_MAX if the padding is malformed. The marker must be inside the last
+ * group, an all zero last group is malformed even if the group before it ends
+ * in a 0x80 byte.
+ */
+static size_t strip_padding(const uint8_t data[], const size_t len, const size_t group_bytes) {
+    size_t i = len;
+    while (i > len - group_bytes && data[i - 1] == 0) {
+        i--;
+    }
+    return i > len - group_bytes && data[i - 1] == PADDING_MARKER ? i - 1 : SIZE_MAX;
+}
+
+
+static AESBlakeStatus decrypt_file(
+        const FileVariant *variant,
+        AESBlakePool *pool,
+        const uint8_t *key,
+        const uint8_t *nonce,
+        const uint8_t *context,
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    if (header_len % variant->group_bytes != 0) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    InputFile in;
+    if (!open_input(input_path, 0, &in)) {
+        return AESBlakeStatus_IO_ERROR;
+    }
+    if (in.len < variant->group_bytes + variant->tag_bytes ||
+        (in.len - variant->tag_bytes) % variant->group_bytes != 0) {
+        close_input(&in);
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    const size_t ciphertext_len = in.len - variant->tag_bytes;
+
+    OutputFile out;
+    if (!open_output(output_path, &in, ciphertext_len, &out)) {
+        close_input(&in);
+        return AESBlakeStatus_IO_ERROR;
+    }
+    AESBlakeStatus status = variant->decrypt(
+        pool, key, nonce, context,
+        in.data, ciphertext_len,
+        header, header_len,
+        in.data + ciphertext_len,
+        out.data
+    );
+    size_t plaintext_len = 0;
+    if (status == AESBlakeStatus_OK) {
+        // Authentic padding can only be malformed if it was not written by encrypt_file
+        plaintext_len = strip_padding(out.data, ciphertext_len, variant->group_bytes);
+        if (plaintext_len == SIZE_MAX) {
+            status = AESBlakeStatus_INVALID_LENGTH;
+        }
+    }
+    if (!close_output(&out, plaintext_len, status == AESBlakeStatus_OK) && status == AESBlakeStatus_OK) {
+        status = AESBlakeStatus_IO_ERROR;
+    }
+    close_input(&in);
+    return status;
+}
+
+
+AESBlakeStatus aes_blake256_encrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    return encrypt_file(&variant256, pool, key, nonce, context, header, header_len, input_path, output_path);
+}
+
+
+AESBlakeStatus aes_blake256_decrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    return decrypt_file(&variant256, pool, key, nonce, context, header, header_len, input_path, output_path);
+}
+
+
+AESBlakeStatus aes_blake512_encrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    return encrypt_file(&variant512, pool, key, nonce, context, header, header_len, input_path, output_path);
+}
+
+
+AESBlakeStatus aes_blake512_decrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t header[],
+        const size_t header_len,
+        const char *input_path,
+        const char *output_path
+) {
+    return decrypt_file(&variant512, pool, key, nonce, context, header, header_len, input_path, output_path);
+}
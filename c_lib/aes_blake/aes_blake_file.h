@@ -0,0 +1,97 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_FILE_H
+#define AES_BLAKE_FILE_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * File encryption on top of the parallel API. The input file is memory mapped,
+     * padded with a 0x80 byte and zeros to a whole number of groups and encrypted
+     * straight into the memory mapped output file, which ends in the auth tag:
+     *
+     *     ciphertext of (plaintext || 0x80 || 0x00...) || auth_tag
+     *
+     * The padding is always between 1 and GROUP_BYTES bytes and is authenticated
+     * along with the rest of the ciphertext. The header is not stored in the file,
+     * it must be passed to decryption again and be a whole number of groups long.
+     * Input and output must be different files. The output is written to a
+     * temporary file readable by its owner only, next to the output path, and is
+     * renamed over it only once the operation succeeded. On any failure the
+     * temporary file is removed and an existing output is left untouched, so a
+     * failed decryption never leaves plaintext behind. The temporary file is
+     * synced to disk before the rename and its directory after it, a failure of
+     * that last sync is reported although the new output is already in place.
+     */
+
+    AESBlakeStatus aes_blake256_encrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const char *input_path,
+        const char *output_path
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE256_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE256_CONTEXT_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const char *input_path,
+        const char *output_path
+    );
+
+    AESBlakeStatus aes_blake512_encrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const char *input_path,
+        const char *output_path
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_file(
+        AESBlakePool *pool,
+        const uint8_t key[AES_BLAKE512_KEY_BYTES],
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t context[AES_BLAKE512_CONTEXT_BYTES],
+        const uint8_t header[],
+        size_t header_len,
+        const char *input_path,
+        const char *output_path
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_FILE_H
@@ -0,0 +1,83 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_FUSED_H
+#define AES_BLAKE_FUSED_H
+
+#include "blake_types.h"
+#include "aes_blake.h"
+
+#ifdef __cplusplus
+#include <cstdint>
+extern "C" {
+#else
+#include <stdint.h>
+#endif
+
+
+    /*
+     * Fused keygen and AES kernels for one block group. The round keys go from the
+     * Blake state registers straight into the AES rounds, with no key buffer in between.
+     * Only encryption can be fused, as decryption consumes the keys in reverse order.
+     * The kernels are usable when the selected AES backend runs on AES-NI anyway.
+     */
+    int aes_blake256_fused_usable(void);
+
+    void aes_blake256_fused_encrypt_group(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t group[AES_BLAKE256_GROUP_BYTES]
+    );
+
+    int aes_blake512_fused_usable(void);
+
+    void aes_blake512_fused_encrypt_group(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t group[AES_BLAKE512_GROUP_BYTES]
+    );
+
+
+    /*
+     * Lazy keygen kernels for one block group on the portable T-table backend.
+     * Each round key is derived right before its AES round, with the same output
+     * as the separate keygen and AES passes. Encryption only, like the fused kernels.
+     */
+    int aes_blake256_lazy_usable(void);
+
+    void aes_blake256_lazy_encrypt_group(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t group[AES_BLAKE256_GROUP_BYTES]
+    );
+
+    int aes_blake512_lazy_usable(void);
+
+    void aes_blake512_lazy_encrypt_group(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t group[AES_BLAKE512_GROUP_BYTES]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_FUSED_H
@@ -0,0 +1,142 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_MULTIBUFFER_H
+#define AES_BLAKE_MULTIBUFFER_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * Multi-buffer engine for many independent streams, each with its own key and
+     * nonce. A manager holds up to `lane_count` message updates of different streaming
+     * contexts and advances them in lock-step, up to four block groups per lane and
+     * pass, with one key derivation call for all lanes of a pass and one AES backend
+     * call for all lanes of each direction. Streams fed one after another leave most
+     * SIMD lanes idle when their updates are short, in the manager every lane of the
+     * wide kernels carries a group of another stream. Updates long enough to fill the
+     * wide kernels on their own run straight through their context when submitted.
+     *
+     * `aes_blake256_mb_submit` places a job in a free lane and runs passes only once
+     * every lane is taken, until the shortest job completes. It returns a completed
+     * job, not necessarily the one submitted, or NULL while none has completed.
+     * `aes_blake256_mb_flush` runs the jobs in flight with partly filled lanes and
+     * returns one completed job per call, NULL when the manager is empty. Jobs return
+     * in the order they complete, so callers match them up by `user_data`.
+     *
+     * A job feeds `input` to its context like `aes_blake256_ctx_encrypt_update`,
+     * or `aes_blake256_ctx_decrypt_update` when `decrypt` is set, with the same rules
+     * for the output buffer and `output_len`. The header and final calls are made on
+     * the context as usual once its jobs have returned. A context must not have more
+     * than one job in flight, nor be used otherwise meanwhile. The job, its context
+     * and buffers must stay valid until the job returns. The manager sets `status`
+     * and `output_len`, and holds no key material outside the contexts.
+     */
+    #define AES_BLAKE_MB_MAX_LANES 16
+
+    /* Lanes of a manager initialized with a lane count of 0. */
+    #define AES_BLAKE256_MB_LANES  16
+    #define AES_BLAKE512_MB_LANES  8
+
+    typedef struct {
+        AESBlake256Ctx *ctx;
+        const uint8_t *input;
+        size_t input_len;
+        uint8_t *output;
+        int decrypt;
+        void *user_data;
+
+        AESBlakeStatus status;
+        size_t output_len;
+    } AESBlake256StreamJob;
+
+    typedef struct {
+        AESBlake512Ctx *ctx;
+        const uint8_t *input;
+        size_t input_len;
+        uint8_t *output;
+        int decrypt;
+        void *user_data;
+
+        AESBlakeStatus status;
+        size_t output_len;
+    } AESBlake512StreamJob;
+
+    /*
+     * Lane state of a manager, all fields are private to the library. `lead` is set
+     * when the first group of a lane is the one completed in the context's partial
+     * buffer, `groups_done` counts the groups processed of `group_count` and the last
+     * `tail_len` input bytes are buffered in the context once the lane completes.
+     */
+    typedef struct {
+        AESBlake256StreamJob *job;
+        const uint8_t *input;
+        size_t group_count;
+        size_t groups_done;
+        size_t tail_len;
+        int lead;
+    } AESBlake256MbLane;
+
+    typedef struct {
+        AESBlake512StreamJob *job;
+        const uint8_t *input;
+        size_t group_count;
+        size_t groups_done;
+        size_t tail_len;
+        int lead;
+    } AESBlake512MbLane;
+
+    typedef struct {
+        size_t lane_count;
+        AESBlake256MbLane lanes[AES_BLAKE_MB_MAX_LANES];
+    } AESBlake256MultiBuffer;
+
+    typedef struct {
+        size_t lane_count;
+        AESBlake512MbLane lanes[AES_BLAKE_MB_MAX_LANES];
+    } AESBlake512MultiBuffer;
+
+
+    /* --- AES-Blake256 --- */
+    void aes_blake256_mb_init(AESBlake256MultiBuffer *mb, size_t lane_count);
+
+    AESBlake256StreamJob *aes_blake256_mb_submit(AESBlake256MultiBuffer *mb, AESBlake256StreamJob *job);
+
+    AESBlake256StreamJob *aes_blake256_mb_flush(AESBlake256MultiBuffer *mb);
+
+    size_t aes_blake256_mb_in_flight(const AESBlake256MultiBuffer *mb);
+
+
+    /* --- AES-Blake512 --- */
+    void aes_blake512_mb_init(AESBlake512MultiBuffer *mb, size_t lane_count);
+
+    AESBlake512StreamJob *aes_blake512_mb_submit(AESBlake512MultiBuffer *mb, AESBlake512StreamJob *job);
+
+    AESBlake512StreamJob *aes_blake512_mb_flush(AESBlake512MultiBuffer *mb);
+
+    size_t aes_blake512_mb_in_flight(const AESBlake512MultiBuffer *mb);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_MULTIBUFFER_H
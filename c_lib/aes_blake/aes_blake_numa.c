@@ -0,0 +1,218 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_blake_numa.h"
+
+#if defined(__linux__)
+#include <stdio.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+
+static void single_node(NumaTopology *topology) {
+    memset(topology, 0, sizeof(NumaTopology));
+    topology->node_count = 1;
+}
+
+
+#if defined(__linux__) && defined(SYS_move_pages)
+
+/*
+ * Parses a sysfs list such as "0-3,8,10-11" into `mask`, returns the number of
+ * entries set or 0 when the file is missing or malformed.
+ */
+static size_t read_sysfs_list(const char *path, uint64_t mask[NUMA_MAX_CPUS / 64]) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char line[4096];
+    const int ok = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    if (!ok) {
+        return 0;
+    }
+
+    size_t count = 0;
+    const char *p = line;
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        const unsigned long first = strtoul(p, &end, 10);
+        unsigned long last = first;
+        if (*end == '-') {
+            last = strtoul(end + 1, &end, 10);
+        }
+        for (unsigned long i = first; i <= last && i < NUMA_MAX_CPUS; i++) {
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+            count++;
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+
+/*
+ * Reads the online memory nodes and their CPUs. Nodes without CPUs are skipped,
+ * as no worker can run there, and pages on them are reported as unplaced.
+ */
+void numa_topology_load(NumaTopology *topology) {
+    single_node(topology);
+    uint64_t online[NUMA_MAX_CPUS / 64] = {0};
+    if (read_sysfs_list("/sys/devices/system/node/online", online) < 2) {
+        return;
+    }
+    size_t node_count = 0;
+    for (int id = 0; id < NUMA_MAX_CPUS && node_count < NUMA_MAX_NODES; id++) {
+        if (!(online[id / 64] >> (id % 64) & 1)) {
+            continue;
+        }
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        const size_t cpus = read_sysfs_list(path, topology->cpu_masks[node_count]);
+        if (cpus > 0) {
+            topology->node_ids[node_count] = id;
+            topology->cpu_counts[node_count] = cpus;
+            node_count++;
+        }
+    }
+    if (node_count < 2) {
+        single_node(topology);
+        return;
+    }
+    topology->node_count = node_count;
+}
+
+
+/*
+ * Restricts the calling thread to the CPUs of `node`. Returns zero on failure,
+ * in which case the thread keeps running unpinned.
+ */
+int numa_pin_current_thread(const NumaTopology *topology, const size_t node) {
+    if (topology->node_count < 2 || node >= topology->node_count) {
+        return 0;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+        if (topology->cpu_masks[node][cpu / 64] >> (cpu % 64) & 1) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+
+/*
+ * Returns the node of the CPU the calling thread runs on, or -1 if unknown.
+ */
+int numa_current_node(const NumaTopology *topology) {
+    if (topology->node_count < 2) {
+        return -1;
+    }
+    const int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= NUMA_MAX_CPUS) {
+        return -1;
+    }
+    for (size_t node = 0; node < topology->node_count; node++) {
+        if (topology->cpu_masks[node][cpu / 64] >> (cpu % 64) & 1) {
+            return (int)node;
+        }
+    }
+    return -1;
+}
+
+
+/*
+ * Looks up the node holding the page of each address with one move_pages query,
+ * which only reports and moves nothing when no target nodes are given. Pages that
+ * are not faulted in yet or sit on a node without CPUs get -1.
+ */
+void numa_page_nodes(
+        const NumaTopology *topology,
+        const void *const addrs[],
+        const size_t count,
+        int nodes[]
+) {
+    for (size_t i = 0; i < count; i++) {
+        nodes[i] = -1;
+    }
+    if (topology->node_count < 2 || count == 0) {
+        return;
+    }
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t page_mask = ~(uintptr_t)(page_size > 0 ? page_size - 1 : 4095);
+
+    void *pages[256];
+    int status[256];
+    for (size_t done = 0; done < count; ) {
+        const size_t batch = count - done < 256 ? count - done : 256;
+        for (size_t i = 0; i < batch; i++) {
+            pages[i] = (void *)((uintptr_t)addrs[done + i] & page_mask);
+        }
+        if (syscall(SYS_move_pages, 0, (unsigned long)batch, pages, NULL, status, 0) != 0) {
+            return;
+        }
+        for (size_t i = 0; i < batch; i++) {
+            for (size_t node = 0; node < topology->node_count; node++) {
+                if (status[i] == topology->node_ids[node]) {
+                    nodes[done + i] = (int)node;
+                }
+            }
+        }
+        done += batch;
+    }
+}
+
+#else
+
+void numa_topology_load(NumaTopology *topology) {
+    single_node(topology);
+}
+
+
+int numa_pin_current_thread(const NumaTopology *topology, const size_t node) {
+    (void)topology;
+    (void)node;
+    return 0;
+}
+
+
+int numa_current_node(const NumaTopology *topology) {
+    (void)topology;
+    return -1;
+}
+
+
+void numa_page_nodes(
+        const NumaTopology *topology,
+        const void *const addrs[],
+        const size_t count,
+        int nodes[]
+) {
+    (void)topology;
+    (void)addrs;
+    for (size_t i = 0; i < count; i++) {
+        nodes[i] = -1;
+    }
+}
+
+#endif
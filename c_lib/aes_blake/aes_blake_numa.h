@@ -0,0 +1,54 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_NUMA_H
+#define AES_BLAKE_NUMA_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    /*
+     * NUMA topology of the host as seen by the worker pool, internal to aes_blake_lib.
+     * Nodes are numbered by their index in `node_ids`, which holds the OS node numbers.
+     * Only Linux is supported, read from sysfs without libnuma. Other systems and hosts
+     * with one memory node see a single node, for which every call is a no-op.
+     */
+    #define NUMA_MAX_NODES 16
+    #define NUMA_MAX_CPUS  1024
+
+    typedef struct {
+        size_t node_count;
+        int node_ids[NUMA_MAX_NODES];
+        size_t cpu_counts[NUMA_MAX_NODES];
+        uint64_t cpu_masks[NUMA_MAX_NODES][NUMA_MAX_CPUS / 64];
+    } NumaTopology;
+
+    void numa_topology_load(NumaTopology *topology);
+
+    int numa_pin_current_thread(const NumaTopology *topology, size_t node);
+
+    int numa_current_node(const NumaTopology *topology);
+
+    void numa_page_nodes(const NumaTopology *topology, const void *const addrs[], size_t count, int nodes[]);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_NUMA_H
@@ -0,0 +1,351 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_blake_pool.h"
+#include "aes_blake_thread.h"
+#include "aes_blake_numa.h"
+
+
+typedef struct {
+    AESBlakePool *pool;
+    int node;
+} WorkerSlot;
+
+
+/*
+ * Workers sleep on `work_ready` until a job is posted, then claim task indices
+ * from `next_task` one at a time until none are left. The thread that posted the
+ * job claims tasks as well and waits on `work_done` for the stragglers. In a NUMA
+ * pool every worker is pinned to the node in its slot, and when a job places its
+ * tasks, workers claim the unclaimed tasks of their own node first, then unplaced
+ * tasks and only then the tasks of other nodes, so a node idles only when no work
+ * is left anywhere.
+ */
+struct AESBlakePool {
+    worker_mutex_t lock;
+    worker_mutex_t run_lock;
+    worker_cond_t work_ready;
+    worker_cond_t work_done;
+
+    AESBlakeTaskFunc task_fn;
+    void *task_arg;
+    size_t task_count;
+    size_t next_task;
+    size_t pending_tasks;
+    int shutdown;
+
+    const int *task_nodes;
+    uint8_t claimed[AES_BLAKE_POOL_MAX_TASKS];
+
+    size_t thread_count;
+    size_t started_threads;
+    worker_thread_t *threads;
+    WorkerSlot *slots;
+    NumaTopology topology;
+};
+
+
+/*
+ * Claims the next task for a thread on `node`, which is -1 for an unpinned
+ * thread. Must be called with the pool lock held and a task left to claim.
+ */
+static size_t claim_task(AESBlakePool *pool, const int node) {
+    if (pool->task_nodes == NULL) {
+        return pool->next_task++;
+    }
+    size_t local = SIZE_MAX, unplaced = SIZE_MAX, remote = SIZE_MAX;
+    for (size_t i = 0; i < pool->task_count; i++) {
+        if (pool->claimed[i]) {
+            continue;
+        }
+        const int task_node = pool->task_nodes[i];
+        if (task_node >= 0 && task_node == node) {
+            local = i;
+            break;
+        }
+        if (task_node < 0 && unplaced == SIZE_MAX) {
+            unplaced = i;
+        }
+        if (task_node >= 0 && remote == SIZE_MAX) {
+            remote = i;
+        }
+    }
+    const size_t task_index = local != SIZE_MAX ? local : unplaced != SIZE_MAX ? unplaced : remote;
+    pool->claimed[task_index] = 1;
+    pool->next_task++;
+    return task_index;
+}
+
+
+/*
+ * Runs tasks of the current job until every index has been claimed.
+ * Must be called with the pool lock held, returns with it held.
+ */
+static void run_claimed_tasks(AESBlakePool *pool, const int node) {
+    while (pool->task_fn != NULL && pool->next_task < pool->task_count) {
+        const size_t task_index = claim_task(pool, node);
+        const AESBlakeTaskFunc task_fn = pool->task_fn;
+        void *task_arg = pool->task_arg;
+
+        mutex_unlock(&pool->lock);
+        task_fn(task_arg, task_index);
+        mutex_lock(&pool->lock);
+
+        if (--pool->pending_tasks == 0) {
+            cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+
+WORKER_THREAD_FUNC(worker_main) {
+    const WorkerSlot *slot = arg;
+    AESBlakePool *pool = slot->pool;
+    if (slot->node >= 0) {
+        numa_pin_current_thread(&pool->topology, (size_t)slot->node);
+    }
+    mutex_lock(&pool->lock);
+    while (!pool->shutdown) {
+        if (pool->task_fn == NULL || pool->next_task >= pool->task_count) {
+            cond_wait(&pool->work_ready, &pool->lock);
+            continue;
+        }
+        run_claimed_tasks(pool, slot->node);
+    }
+    mutex_unlock(&pool->lock);
+    WORKER_THREAD_RETURN;
+}
+
+
+/*
+ * Allocates a pool with the topology loaded when `numa` is set, and starts its
+ * workers. A NUMA pool on several nodes assigns the workers to the nodes in
+ * proportion to their CPU counts.
+ */
+static AESBlakePool *create_pool(size_t thread_count, const int numa) {
+    if (thread_count == 0) {
+        thread_count = online_cpu_count() - 1;
+    }
+    AESBlakePool *pool = calloc(1, sizeof(AESBlakePool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (thread_count > 0) {
+        pool->threads = calloc(thread_count, sizeof(worker_thread_t));
+        pool->slots = calloc(thread_count, sizeof(WorkerSlot));
+        if (pool->threads == NULL || pool->slots == NULL) {
+            free(pool->threads);
+            free(pool->slots);
+            free(pool);
+            return NULL;
+        }
+    }
+    if (numa) {
+        numa_topology_load(&pool->topology);
+    } else {
+        pool->topology.node_count = 1;
+    }
+    mutex_init(&pool->lock);
+    mutex_init(&pool->run_lock);
+    cond_init(&pool->work_ready);
+    cond_init(&pool->work_done);
+
+    size_t total_cpus = 0;
+    for (size_t node = 0; node < pool->topology.node_count; node++) {
+        total_cpus += pool->topology.cpu_counts[node];
+    }
+    for (size_t i = 0; i < thread_count; i++) {
+        pool->slots[i].pool = pool;
+        pool->slots[i].node = -1;
+        if (pool->topology.node_count > 1) {
+            // Worker i takes the node its share of the CPU list falls on
+            size_t cpu = i * total_cpus / thread_count, node = 0;
+            while (cpu >= pool->topology.cpu_counts[node]) {
+                cpu -= pool->topology.cpu_counts[node++];
+            }
+            pool->slots[i].node = (int)node;
+        }
+        if (!thread_start(&pool->threads[i], worker_main, &pool->slots[i])) {
+            break;
+        }
+        pool->started_threads++;
+    }
+    pool->thread_count = pool->started_threads;
+    if (thread_count > 0 && pool->started_threads == 0) {
+        aes_blake_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+
+/*
+ * Creates a pool of `thread_count` worker threads which live until the pool is
+ * destroyed. A count of 0 starts one worker per online CPU besides the caller.
+ * Returns NULL when the pool cannot be allocated or no thread can be started.
+ */
+AESBlakePool *aes_blake_pool_create(const size_t thread_count) {
+    return create_pool(thread_count, 0);
+}
+
+
+/*
+ * Same as `aes_blake_pool_create`, with the workers spread over the NUMA nodes of
+ * the host and pinned to the CPUs of their node. On a host with one memory node,
+ * or where the topology cannot be read, the pool is the same as a plain one.
+ */
+AESBlakePool *aes_blake_pool_create_numa(const size_t thread_count) {
+    return create_pool(thread_count, 1);
+}
+
+
+/*
+ * Stops and joins all worker threads and frees the pool. Accepts NULL.
+ */
+void aes_blake_pool_destroy(AESBlakePool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    cond_broadcast(&pool->work_ready);
+    mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->started_threads; i++) {
+        thread_join(pool->threads[i]);
+    }
+    cond_destroy(&pool->work_done);
+    cond_destroy(&pool->work_ready);
+    mutex_destroy(&pool->run_lock);
+    mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->slots);
+    free(pool);
+}
+
+
+/*
+ * Returns the number of worker threads, not counting the calling thread.
+ */
+size_t aes_blake_pool_thread_count(const AESBlakePool *pool) {
+    return pool == NULL ? 0 : pool->thread_count;
+}
+
+
+/*
+ * Returns the number of NUMA nodes the workers are spread over, 1 for a plain
+ * pool, a NULL pool or a host with one memory node.
+ */
+size_t aes_blake_pool_node_count(const AESBlakePool *pool) {
+    return pool == NULL ? 1 : pool->topology.node_count;
+}
+
+
+/*
+ * Writes the node index of the page holding each of `addrs` to `nodes`, in the
+ * numbering of `aes_blake_pool_run_placed`. Pages not faulted in yet and every
+ * page of a single-node pool get -1.
+ */
+void aes_blake_pool_page_nodes(
+        const AESBlakePool *pool,
+        const void *const addrs[],
+        const size_t count,
+        int nodes[]
+) {
+    if (pool == NULL) {
+        for (size_t i = 0; i < count; i++) {
+            nodes[i] = -1;
+        }
+        return;
+    }
+    numa_page_nodes(&pool->topology, addrs, count, nodes);
+}
+
+
+/*
+ * Returns how many tasks `work_bytes` of data should be split into: a few per
+ * thread for load balancing, but no task smaller than AES_BLAKE_POOL_MIN_TASK_BYTES.
+ */
+size_t aes_blake_pool_task_count(const AESBlakePool *pool, const size_t work_bytes) {
+    const size_t balanced = 4 * (aes_blake_pool_thread_count(pool) + 1);
+    size_t task_count = work_bytes / AES_BLAKE_POOL_MIN_TASK_BYTES;
+    if (task_count > balanced) {
+        task_count = balanced;
+    }
+    if (task_count > AES_BLAKE_POOL_MAX_TASKS) {
+        task_count = AES_BLAKE_POOL_MAX_TASKS;
+    }
+    return task_count > 0 ? task_count : 1;
+}
+
+
+/*
+ * Calls `task_fn(arg, i)` for every i in [0, task_count) on the pool threads and
+ * the calling thread, returning once all calls have finished. Calls from several
+ * threads are serialized. A NULL pool runs all tasks on the calling thread.
+ */
+void aes_blake_pool_run(
+        AESBlakePool *pool,
+        const AESBlakeTaskFunc task_fn,
+        void *arg,
+        const size_t task_count
+) {
+    aes_blake_pool_run_placed(pool, task_fn, arg, task_count, NULL);
+}
+
+
+/*
+ * Same as `aes_blake_pool_run`, with task i preferring the workers of node
+ * `task_nodes[i]`, or any worker if that is -1. Placement only orders the claims,
+ * every task still runs exactly once. A NULL `task_nodes` places no task.
+ */
+void aes_blake_pool_run_placed(
+        AESBlakePool *pool,
+        const AESBlakeTaskFunc task_fn,
+        void *arg,
+        const size_t task_count,
+        const int task_nodes[]
+) {
+    if (pool == NULL || pool->thread_count == 0 || task_count < 2) {
+        for (size_t i = 0; i < task_count; i++) {
+            task_fn(arg, i);
+        }
+        return;
+    }
+    mutex_lock(&pool->run_lock);
+    mutex_lock(&pool->lock);
+
+    pool->task_fn = task_fn;
+    pool->task_arg = arg;
+    pool->task_count = task_count;
+    pool->next_task = 0;
+    pool->pending_tasks = task_count;
+    pool->task_nodes = task_count <= AES_BLAKE_POOL_MAX_TASKS ? task_nodes : NULL;
+    if (pool->task_nodes != NULL) {
+        memset(pool->claimed, 0, task_count);
+    }
+    cond_broadcast(&pool->work_ready);
+
+    run_claimed_tasks(pool, numa_current_node(&pool->topology));
+    while (pool->pending_tasks > 0) {
+        cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->task_fn = NULL;
+    pool->task_arg = NULL;
+    pool->task_nodes = NULL;
+
+    mutex_unlock(&pool->lock);
+    mutex_unlock(&pool->run_lock);
+}
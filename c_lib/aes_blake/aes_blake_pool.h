@@ -0,0 +1,62 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_POOL_H
+#define AES_BLAKE_POOL_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+
+    /* Upper bound on the number of tasks one parallel call is split into. */
+    #define AES_BLAKE_POOL_MAX_TASKS 256
+
+    /* Smallest amount of message data worth handing to a separate task. */
+    #define AES_BLAKE_POOL_MIN_TASK_BYTES (64 * 1024)
+
+    typedef struct AESBlakePool AESBlakePool;
+
+    typedef void (*AESBlakeTaskFunc)(void *arg, size_t task_index);
+
+    AESBlakePool *aes_blake_pool_create(size_t thread_count);
+
+    AESBlakePool *aes_blake_pool_create_numa(size_t thread_count);
+
+    void aes_blake_pool_destroy(AESBlakePool *pool);
+
+    size_t aes_blake_pool_thread_count(const AESBlakePool *pool);
+
+    size_t aes_blake_pool_node_count(const AESBlakePool *pool);
+
+    void aes_blake_pool_page_nodes(const AESBlakePool *pool, const void *const addrs[], size_t count, int nodes[]);
+
+    size_t aes_blake_pool_task_count(const AESBlakePool *pool, size_t work_bytes);
+
+    void aes_blake_pool_run(AESBlakePool *pool, AESBlakeTaskFunc task_fn, void *arg, size_t task_count);
+
+    void aes_blake_pool_run_placed(
+        AESBlakePool *pool,
+        AESBlakeTaskFunc task_fn,
+        void *arg,
+        size_t task_count,
+        const int task_nodes[]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_POOL_H
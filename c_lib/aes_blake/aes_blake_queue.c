@@ -0,0 +1,534 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_blake_queue.h"
+#include "aes_blake_shared.h"
+#include "aes_blake_thread.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#define QUEUE_NOTIFY_FD 0
+#else
+#define QUEUE_NOTIFY_FD 1
+#include <fcntl.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+_Static_assert(
+    sizeof(AESBlakeIovec) == sizeof(struct iovec) &&
+    offsetof(AESBlakeIovec, iov_base) == offsetof(struct iovec, iov_base) &&
+    offsetof(AESBlakeIovec, iov_len) == offsetof(struct iovec, iov_len),
+    "AESBlakeIovec must match struct iovec"
+);
+#endif
+
+/*
+ * Output that straddles two segments is staged here. An update of less than
+ * two groups produces less than three groups, see write_update.
+ */
+#define BOUNCE_BYTES (3 * AES_BLAKE512_GROUP_BYTES)
+
+
+/*
+ * Jobs wait in the `queued` list until a worker takes the oldest one whose
+ * context is not in `running`, which keeps the jobs of each context in order.
+ * Jobs without a callback move to the `done` list when finished, and the
+ * `notify` fds signal the event loop. `unfinished` counts queued and running jobs.
+ */
+struct AESBlakeQueue {
+    worker_mutex_t lock;
+    worker_cond_t work_ready;
+    worker_cond_t idle;
+
+    AESBlakeQueueJob *queued_head;
+    AESBlakeQueueJob *queued_tail;
+    AESBlakeQueueJob *done_head;
+    AESBlakeQueueJob *done_tail;
+    size_t unfinished;
+    int shutdown;
+
+    void **running;
+    int notify_read;
+    int notify_write;
+
+    size_t thread_count;
+    size_t started_threads;
+    worker_thread_t *threads;
+};
+
+
+static size_t group_bytes(const AESBlakeQueueJob *job) {
+    return job->variant == AES_BLAKE256_QUEUE_VARIANT ? AES_BLAKE256_GROUP_BYTES : AES_BLAKE512_GROUP_BYTES;
+}
+
+
+static AESBlakeStatus ctx_update(
+        const AESBlakeQueueJob *job,
+        const uint8_t input[],
+        const size_t input_len,
+        uint8_t output[],
+        size_t *output_len
+) {
+    if (job->variant == AES_BLAKE256_QUEUE_VARIANT) {
+        return job->op == AESBlakeQueueOp_ENCRYPT_UPDATE
+            ? aes_blake256_ctx_encrypt_update(job->ctx, input, input_len, output, output_len)
+            : aes_blake256_ctx_decrypt_update(job->ctx, input, input_len, output, output_len);
+    }
+    return job->op == AESBlakeQueueOp_ENCRYPT_UPDATE
+        ? aes_blake512_ctx_encrypt_update(job->ctx, input, input_len, output, output_len)
+        : aes_blake512_ctx_decrypt_update(job->ctx, input, input_len, output, output_len);
+}
+
+
+/*
+ * Position in the output segments of a job.
+ */
+typedef struct {
+    const AESBlakeIovec *segments;
+    size_t count;
+    size_t index;
+    size_t offset;
+} OutputCursor;
+
+
+/*
+ * Room left in the current segment, after skipping the segments that are full.
+ */
+static size_t cursor_room(OutputCursor *cursor) {
+    while (cursor->index < cursor->count && cursor->offset == cursor->segments[cursor->index].iov_len) {
+        cursor->index++;
+        cursor->offset = 0;
+    }
+    return cursor->index < cursor->count ? cursor->segments[cursor->index].iov_len - cursor->offset : 0;
+}
+
+
+static void cursor_scatter(OutputCursor *cursor, const uint8_t data[], size_t length) {
+    while (length > 0) {
+        const size_t room = cursor_room(cursor);
+        const size_t take = length < room ? length : room;
+        memcpy((uint8_t *)cursor->segments[cursor->index].iov_base + cursor->offset, data, take);
+        cursor->offset += take;
+        data += take;
+        length -= take;
+    }
+}
+
+
+static size_t iovec_total(const AESBlakeIovec segments[], const size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (segments[i].iov_len > SIZE_MAX - total) {
+            return SIZE_MAX;
+        }
+        total += segments[i].iov_len;
+    }
+    return total;
+}
+
+
+/*
+ * Feeds every input segment to the context. Each update writes straight into the
+ * current output segment while it has room for the worst case of the update,
+ * which is its input plus a buffered partial group. Only the updates that cross
+ * a segment boundary are cut to under two groups and staged through `bounce`.
+ */
+static AESBlakeStatus write_update(AESBlakeQueueJob *job, uint8_t bounce[BOUNCE_BYTES]) {
+    const size_t group = group_bytes(job);
+    const size_t input_len = iovec_total(job->input, job->input_count);
+    if (input_len > SIZE_MAX - group || iovec_total(job->output, job->output_count) < input_len + group - 1) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    OutputCursor cursor = {job->output, job->output_count, 0, 0};
+
+    for (size_t i = 0; i < job->input_count; i++) {
+        const uint8_t *data = job->input[i].iov_base;
+        size_t remaining = job->input[i].iov_len;
+
+        while (remaining > 0) {
+            const size_t room = cursor_room(&cursor);
+            size_t produced = 0;
+            size_t piece;
+            AESBlakeStatus status;
+
+            if (room >= group) {
+                piece = remaining < room - (group - 1) ? remaining : room - (group - 1);
+                uint8_t *output = (uint8_t *)job->output[cursor.index].iov_base + cursor.offset;
+                status = ctx_update(job, data, piece, output, &produced);
+                cursor.offset += produced;
+            } else {
+                piece = remaining < room + group ? remaining : room + group;
+                status = ctx_update(job, data, piece, bounce, &produced);
+                cursor_scatter(&cursor, bounce, produced);
+            }
+            if (status != AESBlakeStatus_OK) {
+                return status;
+            }
+            job->output_len += produced;
+            data += piece;
+            remaining -= piece;
+        }
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+static AESBlakeStatus update_header(const AESBlakeQueueJob *job) {
+    for (size_t i = 0; i < job->input_count; i++) {
+        const AESBlakeStatus status = job->variant == AES_BLAKE256_QUEUE_VARIANT
+            ? aes_blake256_ctx_update_header(job->ctx, job->input[i].iov_base, job->input[i].iov_len)
+            : aes_blake512_ctx_update_header(job->ctx, job->input[i].iov_base, job->input[i].iov_len);
+        if (status != AESBlakeStatus_OK) {
+            return status;
+        }
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+static AESBlakeStatus run_job(AESBlakeQueueJob *job) {
+    const int is256 = job->variant == AES_BLAKE256_QUEUE_VARIANT;
+    switch (job->op) {
+        case AESBlakeQueueOp_ENCRYPT_UPDATE:
+        case AESBlakeQueueOp_DECRYPT_UPDATE: {
+            uint8_t bounce[BOUNCE_BYTES];
+            const AESBlakeStatus status = write_update(job, bounce);
+            secure_wipe(bounce, sizeof(bounce));
+            return status;
+        }
+        case AESBlakeQueueOp_UPDATE_HEADER:
+            return update_header(job);
+        case AESBlakeQueueOp_ENCRYPT_FINAL:
+            return is256
+                ? aes_blake256_ctx_encrypt_final(job->ctx, job->auth_tag)
+                : aes_blake512_ctx_encrypt_final(job->ctx, job->auth_tag);
+        case AESBlakeQueueOp_DECRYPT_FINAL:
+            return is256
+                ? aes_blake256_ctx_decrypt_final(job->ctx, job->auth_tag)
+                : aes_blake512_ctx_decrypt_final(job->ctx, job->auth_tag);
+    }
+    return AESBlakeStatus_INVALID_STATE;
+}
+
+
+static void notify_signal(const AESBlakeQueue *queue) {
+#if QUEUE_NOTIFY_FD
+    if (queue->notify_write >= 0) {
+#if defined(__linux__)
+        const uint64_t one = 1;
+#else
+        const uint8_t one = 1;
+#endif
+        /* A full pipe or counter is already readable, so a failed write loses nothing. */
+        ssize_t written = write(queue->notify_write, &one, sizeof(one));
+        (void)written;
+    }
+#else
+    (void)queue;
+#endif
+}
+
+
+static void notify_clear(const AESBlakeQueue *queue) {
+#if QUEUE_NOTIFY_FD
+    uint8_t sink[64];
+    while (queue->notify_read >= 0 && read(queue->notify_read, sink, sizeof(sink)) > 0) {
+    }
+#else
+    (void)queue;
+#endif
+}
+
+
+static int notify_open(AESBlakeQueue *queue) {
+    queue->notify_read = -1;
+    queue->notify_write = -1;
+#if QUEUE_NOTIFY_FD && defined(__linux__)
+    queue->notify_read = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    queue->notify_write = queue->notify_read;
+    return queue->notify_read >= 0;
+#elif QUEUE_NOTIFY_FD
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    queue->notify_read = fds[0];
+    queue->notify_write = fds[1];
+    return 1;
+#else
+    return 1;
+#endif
+}
+
+
+static void notify_close(const AESBlakeQueue *queue) {
+#if QUEUE_NOTIFY_FD
+    if (queue->notify_read >= 0) {
+        close(queue->notify_read);
+    }
+    if (queue->notify_write >= 0 && queue->notify_write != queue->notify_read) {
+        close(queue->notify_write);
+    }
+#else
+    (void)queue;
+#endif
+}
+
+
+static int ctx_running(const AESBlakeQueue *queue, const void *ctx) {
+    for (size_t i = 0; i < queue->thread_count; i++) {
+        if (queue->running[i] == ctx) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Unlinks the oldest queued job whose context is idle and records the context
+ * in `slot`. Must be called with the queue lock held. Returns NULL if no job can run.
+ */
+static AESBlakeQueueJob *take_job(AESBlakeQueue *queue, void **slot) {
+    AESBlakeQueueJob *prev = NULL;
+    for (AESBlakeQueueJob *job = queue->queued_head; job != NULL; prev = job, job = job->next) {
+        if (ctx_running(queue, job->ctx)) {
+            continue;
+        }
+        if (prev == NULL) {
+            queue->queued_head = job->next;
+        } else {
+            prev->next = job->next;
+        }
+        if (queue->queued_tail == job) {
+            queue->queued_tail = prev;
+        }
+        job->next = NULL;
+        *slot = job->ctx;
+        return job;
+    }
+    return NULL;
+}
+
+
+static void **free_slot(const AESBlakeQueue *queue) {
+    for (size_t i = 0; i < queue->thread_count; i++) {
+        if (queue->running[i] == NULL) {
+            return &queue->running[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*
+ * Queued jobs are finished before the workers exit, so that every
+ * submitted job completes even when the queue is being destroyed.
+ */
+WORKER_THREAD_FUNC(worker_main) {
+    AESBlakeQueue *queue = arg;
+    mutex_lock(&queue->lock);
+    for (;;) {
+        void **slot = free_slot(queue);
+        AESBlakeQueueJob *job = take_job(queue, slot);
+        if (job == NULL) {
+            if (queue->shutdown && queue->queued_head == NULL) {
+                break;
+            }
+            cond_wait(&queue->work_ready, &queue->lock);
+            continue;
+        }
+        mutex_unlock(&queue->lock);
+
+        job->status = run_job(job);
+        const AESBlakeQueueCallback callback = job->callback;
+        if (callback != NULL) {
+            callback(job);
+        }
+
+        mutex_lock(&queue->lock);
+        *slot = NULL;
+        if (callback == NULL) {
+            if (queue->done_tail == NULL) {
+                queue->done_head = job;
+            } else {
+                queue->done_tail->next = job;
+            }
+            queue->done_tail = job;
+            notify_signal(queue);
+        }
+        if (--queue->unfinished == 0) {
+            cond_broadcast(&queue->idle);
+        }
+        if (queue->queued_head != NULL) {
+            cond_broadcast(&queue->work_ready);
+        }
+    }
+    mutex_unlock(&queue->lock);
+    WORKER_THREAD_RETURN;
+}
+
+
+/*
+ * Creates a queue drained by `thread_count` dedicated crypto threads. A count of 0
+ * starts one per online CPU besides the event loop thread, and at least one.
+ * Returns NULL when the queue, its notify fd or its threads cannot be created.
+ */
+AESBlakeQueue *aes_blake_queue_create(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = online_cpu_count() > 1 ? online_cpu_count() - 1 : 1;
+    }
+    AESBlakeQueue *queue = calloc(1, sizeof(AESBlakeQueue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->threads = calloc(thread_count, sizeof(worker_thread_t));
+    queue->running = calloc(thread_count, sizeof(void *));
+    if (queue->threads == NULL || queue->running == NULL || !notify_open(queue)) {
+        notify_close(queue);
+        free(queue->running);
+        free(queue->threads);
+        free(queue);
+        return NULL;
+    }
+    mutex_init(&queue->lock);
+    cond_init(&queue->work_ready);
+    cond_init(&queue->idle);
+
+    /* Workers scan `running` up to thread_count, so it is fixed before they start. */
+    queue->thread_count = thread_count;
+    for (size_t i = 0; i < thread_count; i++) {
+        if (!thread_start(&queue->threads[i], worker_main, queue)) {
+            break;
+        }
+        queue->started_threads++;
+    }
+    if (queue->started_threads == 0) {
+        aes_blake_queue_destroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+
+/*
+ * Finishes all submitted jobs, stops and joins the crypto threads and frees the
+ * queue. Accepts NULL. Must not be called from a job callback.
+ */
+void aes_blake_queue_destroy(AESBlakeQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    mutex_lock(&queue->lock);
+    queue->shutdown = 1;
+    cond_broadcast(&queue->work_ready);
+    mutex_unlock(&queue->lock);
+
+    for (size_t i = 0; i < queue->started_threads; i++) {
+        thread_join(queue->threads[i]);
+    }
+    cond_destroy(&queue->idle);
+    cond_destroy(&queue->work_ready);
+    mutex_destroy(&queue->lock);
+    notify_close(queue);
+    free(queue->running);
+    free(queue->threads);
+    free(queue);
+}
+
+
+/*
+ * Appends a job to the queue and returns without waiting for it. Fails with
+ * AESBlakeStatus_INVALID_LENGTH for an unknown variant or op, and with
+ * AESBlakeStatus_INVALID_STATE once the queue is being destroyed.
+ */
+AESBlakeStatus aes_blake_queue_submit(AESBlakeQueue *queue, AESBlakeQueueJob *job) {
+    if (job->variant != AES_BLAKE256_QUEUE_VARIANT && job->variant != AES_BLAKE512_QUEUE_VARIANT) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    if ((unsigned)job->op > AESBlakeQueueOp_DECRYPT_FINAL) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    job->status = AESBlakeStatus_OK;
+    job->output_len = 0;
+    job->next = NULL;
+
+    mutex_lock(&queue->lock);
+    if (queue->shutdown) {
+        mutex_unlock(&queue->lock);
+        return AESBlakeStatus_INVALID_STATE;
+    }
+    if (queue->queued_tail == NULL) {
+        queue->queued_head = job;
+    } else {
+        queue->queued_tail->next = job;
+    }
+    queue->queued_tail = job;
+    queue->unfinished++;
+    cond_broadcast(&queue->work_ready);
+    mutex_unlock(&queue->lock);
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * File descriptor that becomes readable when jobs without a callback have
+ * completed, for registering with epoll, poll or select. It is reset by
+ * aes_blake_queue_poll. Returns -1 on platforms without one.
+ */
+int aes_blake_queue_notify_fd(const AESBlakeQueue *queue) {
+    return queue->notify_read;
+}
+
+
+/*
+ * Moves up to `max_jobs` completed jobs without a callback into `jobs`, in
+ * completion order, and returns their count. Never blocks.
+ */
+size_t aes_blake_queue_poll(AESBlakeQueue *queue, AESBlakeQueueJob *jobs[], const size_t max_jobs) {
+    notify_clear(queue);
+    mutex_lock(&queue->lock);
+    size_t count = 0;
+    while (count < max_jobs && queue->done_head != NULL) {
+        AESBlakeQueueJob *job = queue->done_head;
+        queue->done_head = job->next;
+        job->next = NULL;
+        jobs[count++] = job;
+    }
+    if (queue->done_head == NULL) {
+        queue->done_tail = NULL;
+    } else {
+        notify_signal(queue);
+    }
+    mutex_unlock(&queue->lock);
+    return count;
+}
+
+
+/*
+ * Blocks until every submitted job has completed and its callback has returned.
+ */
+void aes_blake_queue_drain(AESBlakeQueue *queue) {
+    mutex_lock(&queue->lock);
+    while (queue->unfinished > 0) {
+        cond_wait(&queue->idle, &queue->lock);
+    }
+    mutex_unlock(&queue->lock);
+}
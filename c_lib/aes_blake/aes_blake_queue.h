@@ -0,0 +1,106 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_QUEUE_H
+#define AES_BLAKE_QUEUE_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * Offload queue for streaming contexts. Jobs are submitted from an event loop
+     * and run on dedicated crypto threads, so that encryption overlaps with socket
+     * I/O. Jobs of one context run one at a time in submission order, jobs of
+     * different contexts run concurrently. Completion is reported through the
+     * job callback on the crypto thread, or when the job has no callback, by
+     * making the notify fd readable and returning the job from aes_blake_queue_poll.
+     */
+    #define AES_BLAKE256_QUEUE_VARIANT 256
+    #define AES_BLAKE512_QUEUE_VARIANT 512
+
+    typedef struct AESBlakeQueue AESBlakeQueue;
+
+    /*
+     * One scatter/gather segment. Has the layout of `struct iovec` on POSIX
+     * systems, so arrays filled for readv and writev can be passed as they are.
+     */
+    typedef struct {
+        void *iov_base;
+        size_t iov_len;
+    } AESBlakeIovec;
+
+    typedef enum {
+        AESBlakeQueueOp_ENCRYPT_UPDATE = 0,
+        AESBlakeQueueOp_DECRYPT_UPDATE = 1,
+        AESBlakeQueueOp_UPDATE_HEADER = 2,
+        AESBlakeQueueOp_ENCRYPT_FINAL = 3,
+        AESBlakeQueueOp_DECRYPT_FINAL = 4
+    } AESBlakeQueueOp;
+
+    typedef struct AESBlakeQueueJob AESBlakeQueueJob;
+
+    typedef void (*AESBlakeQueueCallback)(AESBlakeQueueJob *job);
+
+    /*
+     * A job is owned by the caller and must stay valid, together with its context,
+     * segments and tag, until it completes, which for a job without a callback is
+     * when aes_blake_queue_poll returns it. The update ops feed the bytes of
+     * `input` to the context and write the result across `output`, which must not
+     * overlap the input and must hold the input length plus one group less one
+     * byte, and `output_len` receives the count written. UPDATE_HEADER reads only
+     * `input`, the final ops read or write only `auth_tag`. The queue sets
+     * `status` before completion and `next` is private to it.
+     */
+    struct AESBlakeQueueJob {
+        int variant;
+        AESBlakeQueueOp op;
+        void *ctx;
+        const AESBlakeIovec *input;
+        size_t input_count;
+        const AESBlakeIovec *output;
+        size_t output_count;
+        uint8_t *auth_tag;
+        AESBlakeQueueCallback callback;
+        void *user_data;
+
+        AESBlakeStatus status;
+        size_t output_len;
+        AESBlakeQueueJob *next;
+    };
+
+    AESBlakeQueue *aes_blake_queue_create(size_t thread_count);
+
+    void aes_blake_queue_destroy(AESBlakeQueue *queue);
+
+    AESBlakeStatus aes_blake_queue_submit(AESBlakeQueue *queue, AESBlakeQueueJob *job);
+
+    int aes_blake_queue_notify_fd(const AESBlakeQueue *queue);
+
+    size_t aes_blake_queue_poll(AESBlakeQueue *queue, AESBlakeQueueJob *jobs[], size_t max_jobs);
+
+    void aes_blake_queue_drain(AESBlakeQueue *queue);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_QUEUE_H
@@ -0,0 +1,90 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_REDUCED_H
+#define AES_BLAKE_REDUCED_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * Reduced keygen cipher profile. Same construction, key objects and block
+     * counter layout as the standard profile, but the round keys come from the
+     * reduced keygen profile, which takes two keys from every Blake mix step and
+     * so needs (AES_BLAKE_ROUNDS + 1) / 2 mix steps per stream, not AES_BLAKE_ROUNDS.
+     * Ciphertexts and tags are not compatible with the standard profile, both sides
+     * have to opt in. The profile is versioned: a future version gets new functions,
+     * and since the version is not stored in the output, the caller must record it.
+     * The keygen is less conservative than the standard one, use it only where
+     * keygen throughput matters more than the safety margin.
+     */
+    #define AES_BLAKE_REDUCED_VERSION 1
+
+    AESBlakeStatus aes_blake256_reduced_encrypt(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_reduced_decrypt(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_reduced_encrypt(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_reduced_decrypt(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_REDUCED_H
@@ -0,0 +1,77 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_blake_schedule.h"
+#include "aes_blake_shared.h"
+
+static const uint8_t SCHEDULE_MAGIC[4] = {'A', 'B', 'K', 'S'};
+
+
+static void store_be(uint8_t out[], const uint64_t value, const size_t byte_count) {
+    for (size_t i = 0; i < byte_count; i++) {
+        out[i] = (uint8_t)(value >> (8 * (byte_count - 1 - i)));
+    }
+}
+
+
+static uint64_t load_be(const uint8_t in[], const size_t byte_count) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < byte_count; i++) {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+
+void aes_blake_schedule_format_header(
+        const AESBlakeScheduleInfo *info,
+        uint8_t schedule_header[AES_BLAKE_SCHEDULE_HEADER_BYTES]
+) {
+    memset(schedule_header, 0, AES_BLAKE_SCHEDULE_HEADER_BYTES);
+    memcpy(schedule_header, SCHEDULE_MAGIC, sizeof(SCHEDULE_MAGIC));
+    schedule_header[4] = AES_BLAKE_SCHEDULE_VERSION;
+    schedule_header[5] = info->variant == AES_BLAKE256_SCHEDULE_VARIANT ? 1 : 2;
+    schedule_header[6] = AES_BLAKE_ROUNDS;
+    store_be(schedule_header + 8, info->message_groups, 8);
+    store_be(schedule_header + 16, info->header_groups, 8);
+}
+
+
+/*
+ * Reads a schedule header. Schedules of another format version or round count
+ * are rejected, they would decrypt to garbage and fail the tag check anyway.
+ */
+AESBlakeStatus aes_blake_schedule_parse_header(
+        const uint8_t schedule_header[AES_BLAKE_SCHEDULE_HEADER_BYTES],
+        AESBlakeScheduleInfo *info
+) {
+    const uint64_t reserved = schedule_header[7] | load_be(schedule_header + 24, 8);
+    if (memcmp(schedule_header, SCHEDULE_MAGIC, sizeof(SCHEDULE_MAGIC)) != 0 ||
+        schedule_header[4] != AES_BLAKE_SCHEDULE_VERSION || schedule_header[6] != AES_BLAKE_ROUNDS ||
+        reserved != 0 || (schedule_header[5] != 1 && schedule_header[5] != 2)) {
+        return AESBlakeStatus_INVALID_LENGTH;
+    }
+    info->variant = schedule_header[5] == 1 ? AES_BLAKE256_SCHEDULE_VARIANT : AES_BLAKE512_SCHEDULE_VARIANT;
+    info->message_groups = load_be(schedule_header + 8, 8);
+    info->header_groups = load_be(schedule_header + 16, 8);
+    return AESBlakeStatus_OK;
+}
+
+
+/*
+ * Wipes the round keys held by a schedule.
+ */
+void aes_blake_schedule_wipe(uint8_t schedule[], const size_t schedule_len) {
+    secure_wipe(schedule, schedule_len);
+}
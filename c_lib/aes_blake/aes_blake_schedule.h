@@ -0,0 +1,119 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_SCHEDULE_H
+#define AES_BLAKE_SCHEDULE_H
+
+#include "aes_blake.h"
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    /*
+     * Precomputed key schedule of one (key, nonce) pair and message shape. It holds
+     * the round keys of every block counter a decryption of that message uses, so
+     * an object that is decrypted over and over skips the key derivation entirely:
+     *
+     *     schedule header || keys of message groups || keys of header groups || keys of CHK group
+     *
+     * Each group takes AES_BLAKE_ROUNDS round keys per block, laid out like the
+     * keys of one counter of `blake*_derive_keys_many`. A schedule is as secret
+     * as the key it was derived from, store it like one and wipe it with
+     * `aes_blake_schedule_wipe`. The caller owns the memory, so it alone decides
+     * how many schedules stay around, use `aes_blake*_schedule_size` to budget it.
+     *
+     * Schedule header, integers big endian:
+     *
+     *     0..3   magic "ABKS"        8..15   message groups       24..31  reserved, zero
+     *     4      format version 1    16..23  header groups
+     *     5      1 for AES-Blake256 and 2 for AES-Blake512, 6 AES_BLAKE_ROUNDS, 7 reserved, zero
+     */
+    #define AES_BLAKE_SCHEDULE_HEADER_BYTES 32
+    #define AES_BLAKE_SCHEDULE_VERSION      1
+
+    #define AES_BLAKE256_SCHEDULE_VARIANT 256
+    #define AES_BLAKE512_SCHEDULE_VARIANT 512
+
+    typedef struct {
+        int variant;
+        uint64_t message_groups;
+        uint64_t header_groups;
+    } AESBlakeScheduleInfo;
+
+    void aes_blake_schedule_format_header(
+        const AESBlakeScheduleInfo *info,
+        uint8_t schedule_header[AES_BLAKE_SCHEDULE_HEADER_BYTES]
+    );
+
+    AESBlakeStatus aes_blake_schedule_parse_header(
+        const uint8_t schedule_header[AES_BLAKE_SCHEDULE_HEADER_BYTES],
+        AESBlakeScheduleInfo *info
+    );
+
+    void aes_blake_schedule_wipe(uint8_t schedule[], size_t schedule_len);
+
+    size_t aes_blake256_schedule_size(size_t ciphertext_len, size_t header_len);
+
+    AESBlakeStatus aes_blake256_schedule_export(
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        size_t ciphertext_len,
+        size_t header_len,
+        uint8_t schedule[],
+        size_t schedule_len
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_with_schedule(
+        const uint8_t schedule[],
+        size_t schedule_len,
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    size_t aes_blake512_schedule_size(size_t ciphertext_len, size_t header_len);
+
+    AESBlakeStatus aes_blake512_schedule_export(
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        size_t ciphertext_len,
+        size_t header_len,
+        uint8_t schedule[],
+        size_t schedule_len
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_with_schedule(
+        const uint8_t schedule[],
+        size_t schedule_len,
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_SCHEDULE_H
@@ -0,0 +1,80 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes_blake_shared.h"
+
+
+/*
+ * Reads `word_count` big-endian 32-bit words from a byte array.
+ */
+void load_words32_be(uint32_t out[], const uint8_t in[], const size_t word_count) {
+    for (size_t i = 0; i < word_count; i++) {
+        const uint8_t *p = in + 4 * i;
+        out[i] = (uint32_t)p[0] << 24
+               | (uint32_t)p[1] << 16
+               | (uint32_t)p[2] <<  8
+               | (uint32_t)p[3];
+    }
+}
+
+
+/*
+ * Reads `word_count` big-endian 64-bit words from a byte array.
+ */
+void load_words64_be(uint64_t out[], const uint8_t in[], const size_t word_count) {
+    for (size_t i = 0; i < word_count; i++) {
+        const uint8_t *p = in + 8 * i;
+        out[i] = (uint64_t)p[0] << 56
+               | (uint64_t)p[1] << 48
+               | (uint64_t)p[2] << 40
+               | (uint64_t)p[3] << 32
+               | (uint64_t)p[4] << 24
+               | (uint64_t)p[5] << 16
+               | (uint64_t)p[6] <<  8
+               | (uint64_t)p[7];
+    }
+}
+
+
+/*
+ * XORs a group of data blocks into the per-block running checksums.
+ */
+void checksum_xor(uint8_t checksum[], const uint8_t data[], const size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        checksum[i] ^= data[i];
+    }
+}
+
+
+/*
+ * Compares two auth tags in constant time. Returns 1 when equal, 0 otherwise.
+ */
+int auth_tags_equal(const uint8_t tag_a[], const uint8_t tag_b[], const size_t length) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; i++) {
+        diff |= tag_a[i] ^ tag_b[i];
+    }
+    return diff == 0;
+}
+
+
+/*
+ * Zeroes `length` bytes through a volatile pointer, so that wiping
+ * key material cannot be optimized away as a dead store.
+ */
+void secure_wipe(void *buffer, const size_t length) {
+    volatile uint8_t *p = buffer;
+    for (size_t i = 0; i < length; i++) {
+        p[i] = 0;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_SHARED_H
+#define AES_BLAKE_SHARED_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    /* Phases and modes of the streaming contexts */
+    #define CTX_PHASE_MESSAGE  0
+    #define CTX_PHASE_HEADER   1
+    #define CTX_PHASE_DONE     2
+
+    #define CTX_MODE_NONE      0
+    #define CTX_MODE_ENCRYPT   1
+    #define CTX_MODE_DECRYPT   2
+
+    void load_words32_be(uint32_t out[], const uint8_t in[], size_t word_count);
+
+    void load_words64_be(uint64_t out[], const uint8_t in[], size_t word_count);
+
+    void checksum_xor(uint8_t checksum[], const uint8_t data[], size_t length);
+
+    int auth_tags_equal(const uint8_t tag_a[], const uint8_t tag_b[], size_t length);
+
+    void secure_wipe(void *buffer, size_t length);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_SHARED_H
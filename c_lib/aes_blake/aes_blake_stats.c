@@ -0,0 +1,172 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_blake_stats.h"
+
+
+static const char *phase_names[AESBlakePhase_COUNT] = {
+    "keygen", "aes", "checksum", "header", "finalize"
+};
+
+
+/*
+ * Returns the name of a phase as used in metrics, or NULL for an unknown phase.
+ */
+const char *aes_blake_stats_phase_name(const AESBlakePhase phase) {
+    return (unsigned)phase < AESBlakePhase_COUNT ? phase_names[phase] : NULL;
+}
+
+
+#if defined(AES_BLAKE_STATS)
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define STATS_COUNTER_TSC
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define STATS_COUNTER_CNTVCT
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#define STATS_THREAD_LOCAL __declspec(thread)
+#else
+#define STATS_THREAD_LOCAL _Thread_local
+#endif
+
+
+/*
+ * Counters of one thread. Only the owning thread writes them, with relaxed
+ * load/store pairs that compile to plain moves, so the hot path takes no lock
+ * and no atomic read-modify-write. Blocks are pushed onto a global lock-free
+ * list on first use and never freed, so the counts of exited threads remain
+ * part of the totals.
+ */
+typedef struct StatsBlock {
+    _Atomic uint64_t ticks[AESBlakePhase_COUNT];
+    _Atomic uint64_t calls[AESBlakePhase_COUNT];
+    struct StatsBlock *next;
+} StatsBlock;
+
+static _Atomic(StatsBlock *) stats_blocks = NULL;
+static STATS_THREAD_LOCAL StatsBlock *thread_block = NULL;
+
+
+static StatsBlock *get_thread_block(void) {
+    StatsBlock *block = thread_block;
+    if (block == NULL) {
+        block = calloc(1, sizeof(StatsBlock));
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = atomic_load_explicit(&stats_blocks, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(
+            &stats_blocks, &block->next, block, memory_order_release, memory_order_relaxed
+        )) {}
+        thread_block = block;
+    }
+    return block;
+}
+
+
+static void add_relaxed(_Atomic uint64_t *counter, const uint64_t value) {
+    const uint64_t current = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, current + value, memory_order_relaxed);
+}
+
+
+int aes_blake_stats_enabled(void) {
+    return 1;
+}
+
+
+/*
+ * Reads the cycle counter of the running CPU.
+ */
+uint64_t aes_blake_stats_now(void) {
+#if defined(STATS_COUNTER_TSC)
+    return (uint64_t)__rdtsc();
+#elif defined(STATS_COUNTER_CNTVCT)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+/*
+ * Adds the ticks since `start` and one call to `phase` of the calling thread.
+ */
+void aes_blake_stats_record(const AESBlakePhase phase, const uint64_t start) {
+    const uint64_t elapsed = aes_blake_stats_now() - start;
+    StatsBlock *block = get_thread_block();
+    if (block != NULL) {
+        add_relaxed(&block->ticks[phase], elapsed);
+        add_relaxed(&block->calls[phase], 1);
+    }
+}
+
+
+/*
+ * Sums the counters of every thread into `stats`. Counts of calls that are
+ * in flight may or may not be included, each counter is read atomically.
+ */
+void aes_blake_stats_snapshot(AESBlakeStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    const StatsBlock *block = atomic_load_explicit(&stats_blocks, memory_order_acquire);
+    for (; block != NULL; block = block->next) {
+        for (int p = 0; p < AESBlakePhase_COUNT; p++) {
+            stats->ticks[p] += atomic_load_explicit(&block->ticks[p], memory_order_relaxed);
+            stats->calls[p] += atomic_load_explicit(&block->calls[p], memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+int aes_blake_stats_enabled(void) {
+    return 0;
+}
+
+
+uint64_t aes_blake_stats_now(void) {
+    return 0;
+}
+
+
+void aes_blake_stats_record(const AESBlakePhase phase, const uint64_t start) {
+    (void)phase;
+    (void)start;
+}
+
+
+/*
+ * Instrumentation is compiled out, so every counter reads as zero.
+ */
+void aes_blake_stats_snapshot(AESBlakeStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
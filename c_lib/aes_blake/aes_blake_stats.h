@@ -0,0 +1,76 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_STATS_H
+#define AES_BLAKE_STATS_H
+
+#ifdef __cplusplus
+#include <cstdint>
+extern "C" {
+#else
+#include <stdint.h>
+#endif
+
+
+    /*
+     * Hot-path phases timed by the instrumentation layer. HEADER and FINALIZE
+     * include the KEYGEN and AES time they spend, the other phases do not nest.
+     * Column exchange is fused into the AES kernels and counted as AES time, as is
+     * the plaintext checksum on backends with fused checksum kernels, and
+     * the batch functions, which fuse the tag passes, only record the first three.
+     */
+    typedef enum {
+        AESBlakePhase_KEYGEN = 0,
+        AESBlakePhase_AES = 1,
+        AESBlakePhase_CHECKSUM = 2,
+        AESBlakePhase_HEADER = 3,
+        AESBlakePhase_FINALIZE = 4,
+        AESBlakePhase_COUNT = 5
+    } AESBlakePhase;
+
+    /*
+     * Cycle counter ticks and calls per phase, summed over all threads that have
+     * used the library. Ticks are rdtsc on x86, cntvct on ARM64, nanoseconds elsewhere.
+     */
+    typedef struct {
+        uint64_t ticks[AESBlakePhase_COUNT];
+        uint64_t calls[AESBlakePhase_COUNT];
+    } AESBlakeStats;
+
+    int aes_blake_stats_enabled(void);
+
+    void aes_blake_stats_snapshot(AESBlakeStats *stats);
+
+    const char *aes_blake_stats_phase_name(AESBlakePhase phase);
+
+    uint64_t aes_blake_stats_now(void);
+
+    void aes_blake_stats_record(AESBlakePhase phase, uint64_t start);
+
+
+    /*
+     * Library-internal timing hooks. Unless the library is built with
+     * AES_BLAKE_STATS defined they expand to nothing.
+     */
+#if defined(AES_BLAKE_STATS)
+    #define AES_BLAKE_STATS_START(var) const uint64_t var = aes_blake_stats_now()
+    #define AES_BLAKE_STATS_STOP(var, phase) aes_blake_stats_record(phase, var)
+#else
+    #define AES_BLAKE_STATS_START(var) ((void)0)
+    #define AES_BLAKE_STATS_STOP(var, phase) ((void)0)
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_STATS_H
@@ -0,0 +1,86 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_THREAD_H
+#define AES_BLAKE_THREAD_H
+
+#include <stddef.h>
+
+
+/*
+ * Thin threading layer over Win32 and pthreads, shared by the worker pool
+ * and the offload queue. Internal to aes_blake_lib.
+ */
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+
+typedef HANDLE worker_thread_t;
+typedef CRITICAL_SECTION worker_mutex_t;
+typedef CONDITION_VARIABLE worker_cond_t;
+
+#define WORKER_THREAD_FUNC(name) static DWORD WINAPI name(LPVOID arg)
+#define WORKER_THREAD_RETURN return 0
+
+static inline int thread_start(worker_thread_t *thread, LPTHREAD_START_ROUTINE fn, void *arg) {
+    *thread = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *thread != NULL;
+}
+static inline void thread_join(const worker_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+static inline void mutex_init(worker_mutex_t *mutex) { InitializeCriticalSection(mutex); }
+static inline void mutex_destroy(worker_mutex_t *mutex) { DeleteCriticalSection(mutex); }
+static inline void mutex_lock(worker_mutex_t *mutex) { EnterCriticalSection(mutex); }
+static inline void mutex_unlock(worker_mutex_t *mutex) { LeaveCriticalSection(mutex); }
+static inline void cond_init(worker_cond_t *cond) { InitializeConditionVariable(cond); }
+static inline void cond_destroy(worker_cond_t *cond) { (void)cond; }
+static inline void cond_wait(worker_cond_t *cond, worker_mutex_t *mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+static inline void cond_broadcast(worker_cond_t *cond) { WakeAllConditionVariable(cond); }
+
+static inline size_t online_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwNumberOfProcessors;
+}
+
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t worker_thread_t;
+typedef pthread_mutex_t worker_mutex_t;
+typedef pthread_cond_t worker_cond_t;
+
+#define WORKER_THREAD_FUNC(name) static void *name(void *arg)
+#define WORKER_THREAD_RETURN return NULL
+
+static inline int thread_start(worker_thread_t *thread, void *(*fn)(void *), void *arg) {
+    return pthread_create(thread, NULL, fn, arg) == 0;
+}
+static inline void thread_join(const worker_thread_t thread) { pthread_join(thread, NULL); }
+static inline void mutex_init(worker_mutex_t *mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void mutex_destroy(worker_mutex_t *mutex) { pthread_mutex_destroy(mutex); }
+static inline void mutex_lock(worker_mutex_t *mutex) { pthread_mutex_lock(mutex); }
+static inline void mutex_unlock(worker_mutex_t *mutex) { pthread_mutex_unlock(mutex); }
+static inline void cond_init(worker_cond_t *cond) { pthread_cond_init(cond, NULL); }
+static inline void cond_destroy(worker_cond_t *cond) { pthread_cond_destroy(cond); }
+static inline void cond_wait(worker_cond_t *cond, worker_mutex_t *mutex) { pthread_cond_wait(cond, mutex); }
+static inline void cond_broadcast(worker_cond_t *cond) { pthread_cond_broadcast(cond); }
+
+static inline size_t online_cpu_count(void) {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
+#endif
+
+#endif //AES_BLAKE_THREAD_H
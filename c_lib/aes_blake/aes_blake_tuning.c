@@ -0,0 +1,563 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_block.h"
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_tuning.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* Default threshold before calibration, and the measured message sizes */
+#define DEFAULT_PARALLEL_BYTES (8 * AES_BLAKE_POOL_MIN_TASK_BYTES)
+#define CALIBRATE_MIN_BYTES    (2 * AES_BLAKE_POOL_MIN_TASK_BYTES)
+#define CALIBRATE_MAX_BYTES    ((size_t)16 << 20)
+#define CALIBRATE_RUNS         3
+
+/* Once a size takes this long inline and the parallel path wins, larger sizes are not measured */
+#define CALIBRATE_ENOUGH_SECONDS 0.02
+
+/* Messages of a batch call staged for the batch API at a time */
+#define STAGE_MESSAGES 64
+
+
+/*
+ * Entry points of one variant behind a common signature. The key object is
+ * passed as void * so that both variants fit the same table.
+ */
+typedef AESBlakeStatus (*InlineFunc)(
+    const void *key_obj, const uint8_t *nonce, const uint8_t *input, size_t input_len,
+    const uint8_t *header, size_t header_len, uint8_t *output, uint8_t *auth_tag
+);
+
+typedef AESBlakeStatus (*ParallelFunc)(
+    AESBlakePool *pool, const void *key_obj, const uint8_t *nonce, const uint8_t *input, size_t input_len,
+    const uint8_t *header, size_t header_len, uint8_t *output, uint8_t *auth_tag
+);
+
+typedef AESBlakeStatus (*BatchFunc)(const void *key_obj, AESBlakeMessage msgs[], size_t msg_count);
+
+typedef struct {
+    InlineFunc encrypt;
+    ParallelFunc parallel[2];
+    BatchFunc batch[2];
+} TuningVariant;
+
+
+static AESBlakeStatus encrypt256(
+        const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake256_encrypt_with_key(key_obj, nonce, input, input_len, header, header_len, output, auth_tag);
+}
+
+static AESBlakeStatus encrypt_parallel256(
+        AESBlakePool *pool, const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake256_encrypt_parallel_with_key(pool, key_obj, nonce, input, input_len, header, header_len, output, auth_tag);
+}
+
+static AESBlakeStatus decrypt_parallel256(
+        AESBlakePool *pool, const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake256_decrypt_parallel_with_key(pool, key_obj, nonce, input, input_len, header, header_len, auth_tag, output);
+}
+
+static AESBlakeStatus encrypt_batch256(const void *key_obj, AESBlakeMessage msgs[], const size_t msg_count) {
+    return aes_blake256_encrypt_batch(key_obj, msgs, msg_count);
+}
+
+static AESBlakeStatus decrypt_batch256(const void *key_obj, AESBlakeMessage msgs[], const size_t msg_count) {
+    return aes_blake256_decrypt_batch(key_obj, msgs, msg_count);
+}
+
+static AESBlakeStatus encrypt512(
+        const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake512_encrypt_with_key(key_obj, nonce, input, input_len, header, header_len, output, auth_tag);
+}
+
+static AESBlakeStatus encrypt_parallel512(
+        AESBlakePool *pool, const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake512_encrypt_parallel_with_key(pool, key_obj, nonce, input, input_len, header, header_len, output, auth_tag);
+}
+
+static AESBlakeStatus decrypt_parallel512(
+        AESBlakePool *pool, const void *key_obj, const uint8_t *nonce, const uint8_t *input, const size_t input_len,
+        const uint8_t *header, const size_t header_len, uint8_t *output, uint8_t *auth_tag
+) {
+    return aes_blake512_decrypt_parallel_with_key(pool, key_obj, nonce, input, input_len, header, header_len, auth_tag, output);
+}
+
+static AESBlakeStatus encrypt_batch512(const void *key_obj, AESBlakeMessage msgs[], const size_t msg_count) {
+    return aes_blake512_encrypt_batch(key_obj, msgs, msg_count);
+}
+
+static AESBlakeStatus decrypt_batch512(const void *key_obj, AESBlakeMessage msgs[], const size_t msg_count) {
+    return aes_blake512_decrypt_batch(key_obj, msgs, msg_count);
+}
+
+
+static const TuningVariant variant256 = {
+    encrypt256,
+    {encrypt_parallel256, decrypt_parallel256},
+    {encrypt_batch256, decrypt_batch256}
+};
+
+static const TuningVariant variant512 = {
+    encrypt512,
+    {encrypt_parallel512, decrypt_parallel512},
+    {encrypt_batch512, decrypt_batch512}
+};
+
+
+static double now_seconds(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+
+/*
+ * Fills `tuning` with the backend and pool it applies to and a default threshold,
+ * which stands until the profile is calibrated or loaded. Without worker threads
+ * the parallel path never wins.
+ */
+void aes_blake_tuning_init(AESBlakeTuning *tuning, const AESBlakePool *pool) {
+    memset(tuning, 0, sizeof(AESBlakeTuning));
+    snprintf(tuning->backend, sizeof(tuning->backend), "%s", aes_select_backend()->name);
+    tuning->thread_count = aes_blake_pool_thread_count(pool);
+    const size_t threshold = tuning->thread_count > 0 ? DEFAULT_PARALLEL_BYTES : AES_BLAKE_TUNING_NEVER;
+    tuning->parallel_min_bytes256 = threshold;
+    tuning->parallel_min_bytes512 = threshold;
+}
+
+
+/*
+ * Shortest of CALIBRATE_RUNS timings of one encryption of `length` bytes, inline
+ * when `pool` is NULL and on the pool otherwise.
+ */
+static double time_encrypt(
+        const TuningVariant *variant,
+        AESBlakePool *pool,
+        const void *key_obj,
+        uint8_t buffer[],
+        const size_t length
+) {
+    static const uint8_t nonce[AES_BLAKE512_NONCE_BYTES] = {0};
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+    double best = 0.0;
+    for (int run = 0; run < CALIBRATE_RUNS; run++) {
+        const double start = now_seconds();
+        if (pool == NULL) {
+            variant->encrypt(key_obj, nonce, buffer, length, NULL, 0, buffer, auth_tag);
+        } else {
+            variant->parallel[0](pool, key_obj, nonce, buffer, length, NULL, 0, buffer, auth_tag);
+        }
+        const double elapsed = now_seconds() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+
+/*
+ * Returns the smallest measured size from which the parallel path is at least
+ * 10% faster at every larger measured size, or AES_BLAKE_TUNING_NEVER.
+ */
+static size_t calibrate_variant(
+        const TuningVariant *variant,
+        AESBlakePool *pool,
+        const void *key_obj,
+        uint8_t buffer[]
+) {
+    size_t threshold = AES_BLAKE_TUNING_NEVER;
+    for (size_t length = CALIBRATE_MIN_BYTES; length <= CALIBRATE_MAX_BYTES; length *= 2) {
+        const double inline_time = time_encrypt(variant, NULL, key_obj, buffer, length);
+        const double parallel_time = time_encrypt(variant, pool, key_obj, buffer, length);
+        if (parallel_time < 0.9 * inline_time) {
+            threshold = threshold == AES_BLAKE_TUNING_NEVER ? length : threshold;
+            if (inline_time > CALIBRATE_ENOUGH_SECONDS) {
+                break;
+            }
+        } else {
+            threshold = AES_BLAKE_TUNING_NEVER;
+        }
+    }
+    return threshold;
+}
+
+
+/*
+ * Measures the inline and the parallel path of both variants with the current
+ * backend on messages from 128 KiB up to 16 MiB and stores the crossovers in
+ * `tuning`. Takes from tens of milliseconds on hardware AES to a few seconds on
+ * the slowest software backends. Keeps the defaults if no buffer can be allocated.
+ */
+void aes_blake_tuning_calibrate(AESBlakeTuning *tuning, AESBlakePool *pool) {
+    aes_blake_tuning_init(tuning, pool);
+    if (tuning->thread_count == 0) {
+        return;
+    }
+    uint8_t *buffer = calloc(1, CALIBRATE_MAX_BYTES);
+    if (buffer == NULL) {
+        return;
+    }
+    static const uint8_t key[AES_BLAKE512_KEY_BYTES] = {0};
+    static const uint8_t context[AES_BLAKE512_CONTEXT_BYTES] = {0};
+
+    AESBlake256Key key256;
+    aes_blake256_key_init(&key256, key, context);
+    tuning->parallel_min_bytes256 = calibrate_variant(&variant256, pool, &key256, buffer);
+    aes_blake256_key_wipe(&key256);
+
+    AESBlake512Key key512;
+    aes_blake512_key_init(&key512, key, context);
+    tuning->parallel_min_bytes512 = calibrate_variant(&variant512, pool, &key512, buffer);
+    aes_blake512_key_wipe(&key512);
+    free(buffer);
+}
+
+
+/*
+ * Writes `tuning` to `path` as text. Returns nonzero on success.
+ */
+int aes_blake_tuning_save(const AESBlakeTuning *tuning, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    const int written = fprintf(
+        file, "aes_blake_tuning %d\nbackend %s\nthreads %zu\nparallel_min_bytes256 %zu\nparallel_min_bytes512 %zu\n",
+        AES_BLAKE_TUNING_VERSION, tuning->backend, tuning->thread_count,
+        tuning->parallel_min_bytes256, tuning->parallel_min_bytes512
+    );
+    return (fclose(file) == 0) & (written > 0);
+}
+
+
+/*
+ * Reads a profile written by `aes_blake_tuning_save` into `tuning`. Returns zero
+ * and leaves `tuning` unchanged if the file is missing or malformed, comes from
+ * another version, or was measured with another backend or thread count than the
+ * current backend and `pool`.
+ */
+int aes_blake_tuning_load(AESBlakeTuning *tuning, const AESBlakePool *pool, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    AESBlakeTuning loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    int version = 0;
+    const int fields = fscanf(
+        file, "aes_blake_tuning %d backend %31s threads %zu parallel_min_bytes256 %zu parallel_min_bytes512 %zu",
+        &version, loaded.backend, &loaded.thread_count, &loaded.parallel_min_bytes256, &loaded.parallel_min_bytes512
+    );
+    fclose(file);
+
+    if (fields != 5 || version != AES_BLAKE_TUNING_VERSION
+            || strcmp(loaded.backend, aes_select_backend()->name) != 0
+            || loaded.thread_count != aes_blake_pool_thread_count(pool)) {
+        return 0;
+    }
+    *tuning = loaded;
+    return 1;
+}
+
+
+/*
+ * Loads the profile cached at `cache_path`, or calibrates a new one and caches it
+ * there when the cached one is missing or stale. A NULL `cache_path` always
+ * calibrates and caches nothing.
+ */
+void aes_blake_tuning_setup(AESBlakeTuning *tuning, AESBlakePool *pool, const char *cache_path) {
+    if (cache_path != NULL && aes_blake_tuning_load(tuning, pool, cache_path)) {
+        return;
+    }
+    aes_blake_tuning_calibrate(tuning, pool);
+    if (cache_path != NULL) {
+        aes_blake_tuning_save(tuning, cache_path);
+    }
+}
+
+
+/*
+ * Whether `bytes` of work should go to the pool. A pool other than the one the
+ * profile was measured with may have no threads to hand the work to.
+ */
+static int use_pool(const AESBlakePool *pool, const size_t threshold, const size_t bytes) {
+    return aes_blake_pool_thread_count(pool) > 0 && bytes >= threshold;
+}
+
+
+/*
+ * Batch API calls over slices of staged messages, one slice per task.
+ */
+typedef struct {
+    BatchFunc batch;
+    const void *key_obj;
+    AESBlakeMessage *msgs;
+    size_t msg_count;
+    size_t task_count;
+} BatchJob;
+
+
+static void batch_task(void *arg, const size_t task_index) {
+    const BatchJob *job = arg;
+    const size_t begin = job->msg_count * task_index / job->task_count;
+    const size_t end = job->msg_count * (task_index + 1) / job->task_count;
+    job->batch(job->key_obj, job->msgs + begin, end - begin);
+}
+
+
+/*
+ * Runs the staged messages through the batch API, split over the pool when
+ * their total size reaches the threshold.
+ */
+static void run_staged(
+        const BatchFunc batch,
+        AESBlakePool *pool,
+        const size_t threshold,
+        const void *key_obj,
+        AESBlakeMessage staged[],
+        const size_t staged_count,
+        const size_t staged_bytes
+) {
+    if (!use_pool(pool, threshold, staged_bytes)) {
+        batch(key_obj, staged, staged_count);
+        return;
+    }
+    BatchJob job = {batch, key_obj, staged, staged_count, 0};
+    const size_t task_count = aes_blake_pool_task_count(pool, staged_bytes);
+    job.task_count = task_count < staged_count ? task_count : staged_count;
+    aes_blake_pool_run(pool, batch_task, &job, job.task_count);
+}
+
+
+/*
+ * Sends the messages at or above the threshold to the parallel path one at a time
+ * and stages the others, in windows of STAGE_MESSAGES, for the batch API. Returns
+ * the first non-OK message status like the batch API does.
+ */
+static AESBlakeStatus process_batch_auto(
+        const TuningVariant *variant,
+        const size_t threshold,
+        AESBlakePool *pool,
+        const void *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count,
+        const int decrypt
+) {
+    AESBlakeMessage staged[STAGE_MESSAGES];
+    size_t staged_index[STAGE_MESSAGES];
+    for (size_t window = 0; window < msg_count; window += STAGE_MESSAGES) {
+        const size_t window_end = msg_count - window < STAGE_MESSAGES ? msg_count : window + STAGE_MESSAGES;
+        size_t staged_count = 0, staged_bytes = 0;
+
+        for (size_t i = window; i < window_end; i++) {
+            AESBlakeMessage *msg = &msgs[i];
+            const size_t bytes = msg->input_len + msg->header_len;
+            if (use_pool(pool, threshold, bytes)) {
+                msg->status = variant->parallel[decrypt](
+                    pool, key_obj, msg->nonce, msg->input, msg->input_len,
+                    msg->header, msg->header_len, msg->output, msg->auth_tag
+                );
+                continue;
+            }
+            staged[staged_count] = *msg;
+            staged_index[staged_count++] = i;
+            staged_bytes += bytes;
+        }
+        if (staged_count > 0) {
+            run_staged(variant->batch[decrypt], pool, threshold, key_obj, staged, staged_count, staged_bytes);
+        }
+        for (size_t i = 0; i < staged_count; i++) {
+            msgs[staged_index[i]].status = staged[i].status;
+        }
+    }
+
+    for (size_t i = 0; i < msg_count; i++) {
+        if (msgs[i].status != AESBlakeStatus_OK) {
+            return msgs[i].status;
+        }
+    }
+    return AESBlakeStatus_OK;
+}
+
+
+/* --- AES-Blake256 --- */
+
+/*
+ * Same as `aes_blake256_encrypt_with_key`, on the parallel path when the message
+ * and header reach the threshold of `tuning` and inline otherwise.
+ */
+AESBlakeStatus aes_blake256_encrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+) {
+    if (use_pool(pool, tuning->parallel_min_bytes256, plaintext_len + header_len)) {
+        return aes_blake256_encrypt_parallel_with_key(
+            pool, key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag
+        );
+    }
+    return aes_blake256_encrypt_with_key(key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag);
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt_with_key`, routed like `aes_blake256_encrypt_auto`.
+ */
+AESBlakeStatus aes_blake256_decrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    if (use_pool(pool, tuning->parallel_min_bytes256, ciphertext_len + header_len)) {
+        return aes_blake256_decrypt_parallel_with_key(
+            pool, key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext
+        );
+    }
+    return aes_blake256_decrypt_with_key(key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext);
+}
+
+
+/*
+ * Same as `aes_blake256_encrypt_batch`, with large messages on the parallel path
+ * and the rest split over the pool when there is enough of it, see aes_blake_tuning.h.
+ */
+AESBlakeStatus aes_blake256_encrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch_auto(&variant256, tuning->parallel_min_bytes256, pool, key_obj, msgs, msg_count, 0);
+}
+
+
+/*
+ * Same as `aes_blake256_decrypt_batch`, routed like `aes_blake256_encrypt_batch_auto`.
+ */
+AESBlakeStatus aes_blake256_decrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch_auto(&variant256, tuning->parallel_min_bytes256, pool, key_obj, msgs, msg_count, 1);
+}
+
+
+/* --- AES-Blake512 --- */
+
+AESBlakeStatus aes_blake512_encrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        const size_t plaintext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+) {
+    if (use_pool(pool, tuning->parallel_min_bytes512, plaintext_len + header_len)) {
+        return aes_blake512_encrypt_parallel_with_key(
+            pool, key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag
+        );
+    }
+    return aes_blake512_encrypt_with_key(key_obj, nonce, plaintext, plaintext_len, header, header_len, ciphertext, auth_tag);
+}
+
+
+AESBlakeStatus aes_blake512_decrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        const size_t ciphertext_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+) {
+    if (use_pool(pool, tuning->parallel_min_bytes512, ciphertext_len + header_len)) {
+        return aes_blake512_decrypt_parallel_with_key(
+            pool, key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext
+        );
+    }
+    return aes_blake512_decrypt_with_key(key_obj, nonce, ciphertext, ciphertext_len, header, header_len, auth_tag, plaintext);
+}
+
+
+AESBlakeStatus aes_blake512_encrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch_auto(&variant512, tuning->parallel_min_bytes512, pool, key_obj, msgs, msg_count, 0);
+}
+
+
+AESBlakeStatus aes_blake512_decrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        const size_t msg_count
+) {
+    return process_batch_auto(&variant512, tuning->parallel_min_bytes512, pool, key_obj, msgs, msg_count, 1);
+}
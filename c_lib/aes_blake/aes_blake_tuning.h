@@ -0,0 +1,160 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_TUNING_H
+#define AES_BLAKE_TUNING_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_types.h"
+
+
+    /*
+     * Size-based dispatch between the inline, batch and parallel paths. A tuning
+     * profile holds, per variant, the message size from which splitting one message
+     * over the pool beats encrypting it on the calling thread. The crossover depends
+     * on the AES backend, the variant and the pool, so the profile is measured on the
+     * host by `aes_blake_tuning_calibrate` and records the backend and thread count
+     * it was measured with. `aes_blake_tuning_setup` loads a cached profile when it
+     * matches the current backend and pool, and calibrates and caches one otherwise.
+     * Select the backend before the setup, a profile of another backend is stale.
+     *
+     * The `_auto` functions produce the same output as the other entry points and
+     * differ only in speed. Single messages at or above the threshold go to the
+     * parallel path, smaller ones run inline. Batch calls send such large messages
+     * to the parallel path one at a time and run the rest through the batch API,
+     * split over the pool when their total size is at or above the threshold.
+     */
+    #define AES_BLAKE_TUNING_VERSION 1
+
+    /* Threshold of a variant for which the parallel path never wins. */
+    #define AES_BLAKE_TUNING_NEVER SIZE_MAX
+
+    typedef struct {
+        char backend[32];
+        size_t thread_count;
+        size_t parallel_min_bytes256;
+        size_t parallel_min_bytes512;
+    } AESBlakeTuning;
+
+    void aes_blake_tuning_init(AESBlakeTuning *tuning, const AESBlakePool *pool);
+
+    void aes_blake_tuning_calibrate(AESBlakeTuning *tuning, AESBlakePool *pool);
+
+    int aes_blake_tuning_save(const AESBlakeTuning *tuning, const char *path);
+
+    int aes_blake_tuning_load(AESBlakeTuning *tuning, const AESBlakePool *pool, const char *path);
+
+    void aes_blake_tuning_setup(AESBlakeTuning *tuning, AESBlakePool *pool, const char *cache_path);
+
+
+    /* --- AES-Blake256 --- */
+    AESBlakeStatus aes_blake256_encrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        const uint8_t nonce[AES_BLAKE256_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE256_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake256_encrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake256_decrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake256Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+
+    /* --- AES-Blake512 --- */
+    AESBlakeStatus aes_blake512_encrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t plaintext[],
+        size_t plaintext_len,
+        const uint8_t header[],
+        size_t header_len,
+        uint8_t ciphertext[],
+        uint8_t auth_tag[AES_BLAKE512_TAG_BYTES]
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        const uint8_t nonce[AES_BLAKE512_NONCE_BYTES],
+        const uint8_t ciphertext[],
+        size_t ciphertext_len,
+        const uint8_t header[],
+        size_t header_len,
+        const uint8_t auth_tag[AES_BLAKE512_TAG_BYTES],
+        uint8_t plaintext[]
+    );
+
+    AESBlakeStatus aes_blake512_encrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+    AESBlakeStatus aes_blake512_decrypt_batch_auto(
+        const AESBlakeTuning *tuning,
+        AESBlakePool *pool,
+        const AESBlake512Key *key_obj,
+        AESBlakeMessage msgs[],
+        size_t msg_count
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_TUNING_H
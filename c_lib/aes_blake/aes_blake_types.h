@@ -0,0 +1,36 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_TYPES_H
+#define AES_BLAKE_TYPES_H
+
+#ifdef __cplusplus
+#include <cstdint>
+extern "C" {
+#else
+#include <stdint.h>
+#endif
+
+
+    typedef enum {
+        AESBlakeStatus_OK = 0,
+        AESBlakeStatus_INVALID_LENGTH = 1,
+        AESBlakeStatus_AUTH_FAILED = 2,
+        AESBlakeStatus_INVALID_STATE = 3,
+        AESBlakeStatus_IO_ERROR = 4
+    } AESBlakeStatus;
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_BLAKE_TYPES_H
@@ -0,0 +1,221 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_block.h"
+
+
+static const AES_Backend backend_clean = {
+    "clean",
+    aes_encrypt_clean,
+    aes_decrypt_clean,
+    aes_encrypt_blocks_x2_clean,
+    aes_decrypt_blocks_x2_clean,
+    aes_encrypt_blocks_x4_clean,
+    aes_decrypt_blocks_x4_clean,
+    NULL, NULL, NULL, NULL
+};
+
+static const AES_Backend backend_optimized = {
+    "optimized",
+    aes_encrypt_optimized,
+    aes_decrypt_optimized,
+    aes_encrypt_blocks_x2_optimized,
+    aes_decrypt_blocks_x2_optimized,
+    aes_encrypt_blocks_x4_optimized,
+    aes_decrypt_blocks_x4_optimized,
+    NULL, NULL, NULL, NULL
+};
+
+/*
+ * T-table backend with one table per direction, for hosts where the cipher
+ * shares L1 with other hot code. Like the T-table backend it is never
+ * detected, as table lookups do not run in constant time.
+ */
+static const AES_Backend backend_compact = {
+    "compact",
+    aes_encrypt_compact,
+    aes_decrypt_compact,
+    aes_encrypt_blocks_x2_compact,
+    aes_decrypt_blocks_x2_compact,
+    aes_encrypt_blocks_x4_compact,
+    aes_decrypt_blocks_x4_compact,
+    NULL, NULL, NULL, NULL
+};
+
+static const AES_Backend backend_bitsliced = {
+    "bitsliced",
+    aes_encrypt_bitsliced,
+    aes_decrypt_bitsliced,
+    aes_encrypt_blocks_x2_bitsliced,
+    aes_decrypt_blocks_x2_bitsliced,
+    aes_encrypt_blocks_x4_bitsliced,
+    aes_decrypt_blocks_x4_bitsliced,
+    NULL, NULL, NULL, NULL
+};
+
+/*
+ * First-order masked backend for hardened deployments. It is never detected,
+ * only selected with `aes_set_backend(aes_find_backend("masked"))`.
+ */
+static const AES_Backend backend_masked = {
+    "masked",
+    aes_encrypt_masked,
+    aes_decrypt_masked,
+    aes_encrypt_blocks_x2_masked,
+    aes_decrypt_blocks_x2_masked,
+    aes_encrypt_blocks_x4_masked,
+    aes_decrypt_blocks_x4_masked,
+    NULL, NULL, NULL, NULL
+};
+
+#if defined(AES_ARCH_X86)
+static const AES_Backend backend_aesni = {
+    "aesni",
+    aes_encrypt_aesni,
+    aes_decrypt_aesni,
+    aes_encrypt_blocks_x2_aesni,
+    aes_decrypt_blocks_x2_aesni,
+    aes_encrypt_blocks_x4_aesni,
+    aes_decrypt_blocks_x4_aesni,
+    aes_encrypt_blocks_x2_sum_aesni,
+    aes_decrypt_blocks_x2_sum_aesni,
+    aes_encrypt_blocks_x4_sum_aesni,
+    aes_decrypt_blocks_x4_sum_aesni
+};
+
+static const AES_Backend backend_vaes_avx2 = {
+    "vaes_avx2",
+    aes_encrypt_aesni,
+    aes_decrypt_aesni,
+    aes_encrypt_blocks_x2_vaes_avx2,
+    aes_decrypt_blocks_x2_vaes_avx2,
+    aes_encrypt_blocks_x4_vaes_avx2,
+    aes_decrypt_blocks_x4_vaes_avx2,
+    aes_encrypt_blocks_x2_sum_vaes_avx2,
+    aes_decrypt_blocks_x2_sum_vaes_avx2,
+    aes_encrypt_blocks_x4_sum_vaes_avx2,
+    aes_decrypt_blocks_x4_sum_vaes_avx2
+};
+
+static const AES_Backend backend_vaes_avx512 = {
+    "vaes_avx512",
+    aes_encrypt_aesni,
+    aes_decrypt_aesni,
+    aes_encrypt_blocks_x2_vaes_avx512,
+    aes_decrypt_blocks_x2_vaes_avx512,
+    aes_encrypt_blocks_x4_vaes_avx512,
+    aes_decrypt_blocks_x4_vaes_avx512,
+    aes_encrypt_blocks_x2_sum_vaes_avx512,
+    aes_decrypt_blocks_x2_sum_vaes_avx512,
+    aes_encrypt_blocks_x4_sum_vaes_avx512,
+    aes_decrypt_blocks_x4_sum_vaes_avx512
+};
+#endif
+
+#if defined(AES_ARCH_ARM64)
+static const AES_Backend backend_armce = {
+    "armce",
+    aes_encrypt_armce,
+    aes_decrypt_armce,
+    aes_encrypt_blocks_x2_armce,
+    aes_decrypt_blocks_x2_armce,
+    aes_encrypt_blocks_x4_armce,
+    aes_decrypt_blocks_x4_armce,
+    aes_encrypt_blocks_x2_sum_armce,
+    aes_decrypt_blocks_x2_sum_armce,
+    aes_encrypt_blocks_x4_sum_armce,
+    aes_decrypt_blocks_x4_sum_armce
+};
+#endif
+
+
+static const AES_Backend *detect_backend(void) {
+#if defined(AES_ARCH_X86)
+    if (aes_cpu_has_vaes_avx512()) {
+        return &backend_vaes_avx512;
+    }
+    if (aes_cpu_has_vaes_avx2()) {
+        return &backend_vaes_avx2;
+    }
+    if (aes_cpu_has_aesni()) {
+        return &backend_aesni;
+    }
+#endif
+#if defined(AES_ARCH_ARM64)
+    if (aes_cpu_has_armce()) {
+        return &backend_armce;
+    }
+#endif
+    return &backend_bitsliced;
+}
+
+
+static _Atomic(const AES_Backend *) selected_backend = NULL;
+
+
+/*
+ * Returns the fastest AES backend supported by the running CPU. Without AES
+ * instructions this is the bitsliced backend rather than the T-table one, as
+ * only the former runs in constant time. The result is cached on first use in
+ * an atomic pointer. Detection is deterministic and the backends are constant
+ * tables, so concurrent first calls store the same pointer and relaxed
+ * ordering suffices.
+ */
+const AES_Backend *aes_select_backend(void) {
+    const AES_Backend *backend = atomic_load_explicit(&selected_backend, memory_order_relaxed);
+    if (backend == NULL) {
+        backend = detect_backend();
+        atomic_store_explicit(&selected_backend, backend, memory_order_relaxed);
+    }
+    return backend;
+}
+
+
+/*
+ * Returns the backend called `name` if it is compiled in and supported
+ * by the running CPU, otherwise NULL.
+ */
+const AES_Backend *aes_find_backend(const char *name) {
+    const AES_Backend *candidates[] = {
+        &backend_clean,
+        &backend_optimized,
+        &backend_compact,
+        &backend_bitsliced,
+        &backend_masked,
+#if defined(AES_ARCH_X86)
+        aes_cpu_has_aesni() ? &backend_aesni : NULL,
+        aes_cpu_has_vaes_avx2() ? &backend_vaes_avx2 : NULL,
+        aes_cpu_has_vaes_avx512() ? &backend_vaes_avx512 : NULL,
+#endif
+#if defined(AES_ARCH_ARM64)
+        aes_cpu_has_armce() ? &backend_armce : NULL,
+#endif
+    };
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (candidates[i] != NULL && strcmp(candidates[i]->name, name) == 0) {
+            return candidates[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*
+ * Makes `aes_select_backend` return `backend` instead of the detected one, which
+ * lets benchmarks and tests compare backends. Passing NULL restores detection.
+ * Must not be called while other threads are encrypting.
+ */
+void aes_set_backend(const AES_Backend *backend) {
+    atomic_store_explicit(&selected_backend, backend, memory_order_relaxed);
+}
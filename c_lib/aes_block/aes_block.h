@@ -13,12 +13,15 @@
 #define AES_BLOCK_H
 
 #include "aes_types.h"
+#include "aes_cpu.h"
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <cstddef>
 extern "C" {
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
 
@@ -58,6 +61,626 @@ extern "C" {
         AES_YieldCallback callback
     );
 
+    void aes_encrypt_group_clean(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+    );
+
+    void aes_decrypt_group_clean(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+    );
+
+    void aes_encrypt_group_optimized(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+    );
+
+    void aes_decrypt_group_optimized(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+    );
+
+    void aes_encrypt_blocks_x2_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_group_x2_lazy_optimized(
+        const uint8_t input[32],
+        uint8_t output[32],
+        uint8_t key_count,
+        AES_RoundKeysFunc next_keys,
+        void *ctx
+    );
+
+    void aes_encrypt_group_x4_lazy_optimized(
+        const uint8_t input[64],
+        uint8_t output[64],
+        uint8_t key_count,
+        AES_RoundKeysFunc next_keys,
+        void *ctx
+    );
+
+    void aes_encrypt_compact(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_decrypt_compact(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_encrypt_blocks_x2_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_bitsliced(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_decrypt_bitsliced(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_encrypt_blocks_x2_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_masked(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_decrypt_masked(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_encrypt_blocks_x2_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+#if defined(AES_ARCH_X86)
+
+    void aes_encrypt_aesni(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_decrypt_aesni(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_encrypt_blocks_x2_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x2_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x4_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x4_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x2_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x2_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x4_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x4_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x2_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x2_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x4_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x4_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+#endif
+
+#if defined(AES_ARCH_ARM64)
+
+    void aes_encrypt_armce(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_decrypt_armce(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        uint8_t block_index,
+        AES_YieldCallback callback
+    );
+
+    void aes_encrypt_blocks_x2_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x2_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x4_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_decrypt_blocks_x4_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    void aes_encrypt_blocks_x2_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x2_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_encrypt_blocks_x4_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    void aes_decrypt_blocks_x4_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+#endif
+
+    const AES_Backend *aes_select_backend(void);
+
+    const AES_Backend *aes_find_backend(const char *name);
+
+    void aes_set_backend(const AES_Backend *backend);
+
 
 #ifdef __cplusplus
 }
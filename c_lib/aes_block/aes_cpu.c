@@ -0,0 +1,152 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include "aes_cpu.h"
+
+#if defined(AES_ARCH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(AES_ARCH_ARM64)
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#endif
+#endif
+
+
+#if defined(AES_ARCH_X86)
+static void cpuid(const unsigned int leaf, const unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, (int)leaf, (int)subleaf);
+    for (int i = 0; i < 4; i++) {
+        regs[i] = (unsigned int)out[i];
+    }
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    if (leaf <= __get_cpuid_max(0, NULL)) {
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    }
+#endif
+}
+
+
+/*
+ * Returns the XCR0 register, which tells which vector register states the OS saves.
+ */
+static unsigned long long read_xcr0(void) {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU has VAES and AVX2 and the OS saves the YMM state,
+ * additionally requiring AVX-512F and the ZMM state when `zmm` is set.
+ */
+static int has_vaes(const int zmm) {
+    unsigned int leaf1[4], leaf7[4];
+    cpuid(1, 0, leaf1);
+    const unsigned int osxsave_bit = 1u << 27;
+    if (!aes_cpu_has_aesni() || !(leaf1[2] & osxsave_bit)) {
+        return 0;
+    }
+    const unsigned long long ymm_state = 0x6;
+    const unsigned long long zmm_state = 0xE6;
+    const unsigned long long xcr0 = read_xcr0();
+    if ((xcr0 & ymm_state) != ymm_state || (zmm && (xcr0 & zmm_state) != zmm_state)) {
+        return 0;
+    }
+    cpuid(7, 0, leaf7);
+    const unsigned int avx2_bit = 1u << 5;
+    const unsigned int avx512f_bit = 1u << 16;
+    const unsigned int vaes_bit = 1u << 9;
+    if (!(leaf7[1] & avx2_bit) || !(leaf7[2] & vaes_bit)) {
+        return 0;
+    }
+    return !zmm || (leaf7[1] & avx512f_bit);
+}
+#endif
+
+
+/*
+ * Returns non-zero when the CPU supports AES-NI together with SSE4.1,
+ * which the AES-NI backend uses for the column exchange blends.
+ */
+int aes_cpu_has_aesni(void) {
+#if defined(AES_ARCH_X86)
+    unsigned int leaf1[4];
+    cpuid(1, 0, leaf1);
+    const unsigned int aes_bit = 1u << 25;
+    const unsigned int sse41_bit = 1u << 19;
+    return (leaf1[2] & aes_bit) && (leaf1[2] & sse41_bit);
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU supports VAES on 256-bit vectors.
+ */
+int aes_cpu_has_vaes_avx2(void) {
+#if defined(AES_ARCH_X86)
+    return has_vaes(0);
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU supports VAES on 512-bit vectors.
+ */
+int aes_cpu_has_vaes_avx512(void) {
+#if defined(AES_ARCH_X86)
+    return has_vaes(1);
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU supports the ARMv8 Crypto Extensions AES instructions.
+ */
+int aes_cpu_has_armce(void) {
+#if defined(AES_ARCH_ARM64)
+#if defined(_WIN32)
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__APPLE__)
+    return 1;
+#elif defined(__linux__)
+    const unsigned long hwcap_aes = 1ul << 3;
+    return (getauxval(AT_HWCAP) & hwcap_aes) != 0;
+#elif defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO)
+    return 1;
+#else
+    return 0;
+#endif
+#else
+    return 0;
+#endif
+}
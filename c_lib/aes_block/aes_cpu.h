@@ -0,0 +1,60 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_CPU_H
+#define AES_CPU_H
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AES_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AES_ARCH_ARM64 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AES_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define AES_ALWAYS_INLINE inline
+#endif
+
+/*
+ * Runs the statements that follow `key_count` with `kc` bound to a compile-time constant
+ * for the 11 (AES-Blake default) and 15 (hardened) key counts, so that kernels marked
+ * AES_ALWAYS_INLINE are compiled with fixed round bounds and fully unrolled. Every other
+ * key count takes the generic path with `kc` equal to `key_count`.
+ */
+#define AES_SPECIALIZE_KEY_COUNT(key_count, kc, ...)                            \
+    do {                                                                        \
+        switch (key_count) {                                                    \
+            case 11: { const uint8_t kc = 11; __VA_ARGS__; break; }             \
+            case 15: { const uint8_t kc = 15; __VA_ARGS__; break; }             \
+            default: { const uint8_t kc = (key_count); __VA_ARGS__; break; }    \
+        }                                                                       \
+    } while (0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    int aes_cpu_has_aesni(void);
+
+    int aes_cpu_has_vaes_avx2(void);
+
+    int aes_cpu_has_vaes_avx512(void);
+
+    int aes_cpu_has_armce(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_CPU_H
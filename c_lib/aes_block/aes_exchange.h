@@ -0,0 +1,175 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef AES_EXCHANGE_H
+#define AES_EXCHANGE_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstring>
+extern "C" {
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+#include "aes_ops.h"
+
+/*
+ * Column exchange kernels compiled from an arbitrary `ex_cols_pattern`. Column `c`
+ * of block `i` always comes from column `c` of block `pattern[i][c]`, so a column
+ * never changes its position within the block and the whole exchange reduces to
+ * selecting each output column from one of the input blocks. The compiler turns
+ * the pattern into one dword select mask per (output block, source block) pair,
+ * which the kernels apply to a group held in vector registers with AND, OR and
+ * XOR only, without cloning any block state.
+ *
+ * With GCC and Clang a block is a 4 x 32-bit vector which the compiler maps onto
+ * SSE2 or NEON registers, the select chains become pand/por or NEON bsl.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint32_t ex_word __attribute__((vector_size(16)));
+#define EX_LANES 4
+#else
+typedef struct { uint32_t w[4]; } ex_word;
+#define EX_LANES 0
+#endif
+
+
+typedef struct {
+    uint8_t block_count;
+    ex_word select[AES_GROUP_MAX_BLOCKS][AES_GROUP_MAX_BLOCKS];
+} AES_ExchangePlan;
+
+
+#if EX_LANES
+#define EX_AND(a, b) ((a) & (b))
+#define EX_OR(a, b)  ((a) | (b))
+#define EX_XOR(a, b) ((a) ^ (b))
+#define EX_SET(x, c, v) ((x)[c] = (v))
+#else
+static inline ex_word ex_op(const ex_word a, const ex_word b, const int op) {
+    ex_word r;
+    for (int c = 0; c < 4; c++) {
+        r.w[c] = op == 0 ? a.w[c] & b.w[c] : op == 1 ? a.w[c] | b.w[c] : a.w[c] ^ b.w[c];
+    }
+    return r;
+}
+#define EX_AND(a, b) ex_op((a), (b), 0)
+#define EX_OR(a, b)  ex_op((a), (b), 1)
+#define EX_XOR(a, b) ex_op((a), (b), 2)
+#define EX_SET(x, c, v) ((x).w[c] = (v))
+#endif
+
+
+/*
+ * Compiles `pattern` of a `block_count` block group, `select[i][j]` holds the
+ * columns that block `i` takes from block `j`. Compile once per group call and
+ * reuse the plan for every round.
+ */
+static inline void compile_exchange_pattern(
+        AES_ExchangePlan *plan,
+        const uint8_t pattern[][4],
+        const uint8_t block_count
+) {
+    plan->block_count = block_count;
+    for (uint8_t i = 0; i < block_count; i++) {
+        for (uint8_t j = 0; j < block_count; j++) {
+            for (int c = 0; c < 4; c++) {
+                EX_SET(plan->select[i][j], c, pattern[i][c] == j ? 0xFFFFFFFFu : 0u);
+            }
+        }
+    }
+}
+
+
+/*
+ * Two-block exchange (AES-Blake256 groups): each output block is its own input
+ * with the columns taken from the other block flipped in through the XOR difference.
+ */
+static inline void exchange_words_x2(ex_word s[2], const AES_ExchangePlan *plan) {
+    const ex_word diff = EX_XOR(s[0], s[1]);
+    const ex_word out0 = EX_XOR(s[0], EX_AND(diff, plan->select[0][1]));
+    const ex_word out1 = EX_XOR(s[1], EX_AND(diff, plan->select[1][0]));
+    s[0] = out0;
+    s[1] = out1;
+}
+
+
+/*
+ * Four-block exchange (AES-Blake512 groups): every output block is an OR of its
+ * four masked sources, all read before any output is written.
+ */
+static inline void exchange_words_x4(ex_word s[4], const AES_ExchangePlan *plan) {
+    ex_word out[4];
+    for (int i = 0; i < 4; i++) {
+        out[i] = EX_OR(
+            EX_OR(EX_AND(s[0], plan->select[i][0]), EX_AND(s[1], plan->select[i][1])),
+            EX_OR(EX_AND(s[2], plan->select[i][2]), EX_AND(s[3], plan->select[i][3]))
+        );
+    }
+    for (int i = 0; i < 4; i++) {
+        s[i] = out[i];
+    }
+}
+
+
+static inline void load_exchange_words(ex_word s[], const uint8_t data[], const uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+        memcpy(&s[i], data + i * 16, 16);
+    }
+}
+
+
+static inline void store_exchange_words(uint8_t data[], const ex_word s[], const uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+        memcpy(data + i * 16, &s[i], 16);
+    }
+}
+
+
+/*
+ * Applies a compiled exchange to a group stored as bytes, equivalent to
+ * `exchange_columns` with the pattern the plan was compiled from. Groups of
+ * two and four blocks go through the specializations with loads and stores of
+ * a fixed size, the odd-sized groups through a generic select loop.
+ */
+static inline void exchange_planned(uint8_t data[], const AES_ExchangePlan *plan) {
+    ex_word s[AES_GROUP_MAX_BLOCKS];
+    const uint8_t n = plan->block_count;
+    if (n == 2) {
+        load_exchange_words(s, data, 2);
+        exchange_words_x2(s, plan);
+        store_exchange_words(data, s, 2);
+    } else if (n == 4) {
+        load_exchange_words(s, data, 4);
+        exchange_words_x4(s, plan);
+        store_exchange_words(data, s, 4);
+    } else {
+        ex_word out[AES_GROUP_MAX_BLOCKS];
+        load_exchange_words(s, data, n);
+        for (uint8_t i = 0; i < n; i++) {
+            out[i] = EX_AND(s[0], plan->select[i][0]);
+            for (uint8_t j = 1; j < n; j++) {
+                out[i] = EX_OR(out[i], EX_AND(s[j], plan->select[i][j]));
+            }
+        }
+        store_exchange_words(data, out, n);
+    }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //AES_EXCHANGE_H
@@ -0,0 +1,523 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "aes_cpu.h"
+
+#if defined(AES_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <wmmintrin.h>
+#include <smmintrin.h>
+#include "aes_types.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#else
+#define AESNI_TARGET
+#endif
+
+
+static inline AESNI_TARGET __m128i load_block(const uint8_t bytes[16]) {
+    return _mm_loadu_si128((const __m128i *)bytes);
+}
+
+
+static inline AESNI_TARGET void store_block(uint8_t bytes[16], const __m128i block) {
+    _mm_storeu_si128((__m128i *)bytes, block);
+}
+
+
+/*
+ * Returns the vector made of column 0 of `a`, column 1 of `b`, column 2 of `c` and column 3 of `d`.
+ */
+static inline AESNI_TARGET __m128i pick_columns(
+        const __m128i a,
+        const __m128i b,
+        const __m128i c,
+        const __m128i d
+) {
+    const __m128i ab = _mm_blend_epi16(a, b, 0x0C);
+    const __m128i cd = _mm_blend_epi16(c, d, 0xC0);
+    return _mm_blend_epi16(ab, cd, 0xF0);
+}
+
+
+/*
+ * AES-Blake256 column exchange, the odd columns are swapped between the two blocks.
+ */
+static inline AESNI_TARGET void exchange_columns_x2(__m128i *a, __m128i *b) {
+    const __m128i t = _mm_blend_epi16(*a, *b, 0xCC);
+    *b = _mm_blend_epi16(*b, *a, 0xCC);
+    *a = t;
+}
+
+
+/*
+ * AES-Blake512 column exchange, column `c` of block `i` comes from block `(i + c) % 4`.
+ */
+static inline AESNI_TARGET void exchange_columns_x4(__m128i s[4]) {
+    const __m128i t0 = pick_columns(s[0], s[1], s[2], s[3]);
+    const __m128i t1 = pick_columns(s[1], s[2], s[3], s[0]);
+    const __m128i t2 = pick_columns(s[2], s[3], s[0], s[1]);
+    const __m128i t3 = pick_columns(s[3], s[0], s[1], s[2]);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+/*
+ * Inverse AES-Blake512 column exchange, column `c` of block `i` comes from block `(i - c) % 4`.
+ */
+static inline AESNI_TARGET void inv_exchange_columns_x4(__m128i s[4]) {
+    const __m128i t0 = pick_columns(s[0], s[3], s[2], s[1]);
+    const __m128i t1 = pick_columns(s[1], s[0], s[3], s[2]);
+    const __m128i t2 = pick_columns(s[2], s[1], s[0], s[3]);
+    const __m128i t3 = pick_columns(s[3], s[2], s[1], s[0]);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+AESNI_TARGET void aes_encrypt_aesni(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    // First round
+    store_block(b, _mm_xor_si128(load_block(b), load_block(keys[0])));
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+        store_block(b, _mm_aesenc_si128(load_block(b), load_block(keys[round])));
+    }
+
+    // Final round
+    store_block(b, _mm_aesenclast_si128(load_block(b), load_block(keys[n_rounds])));
+}
+
+
+AESNI_TARGET void aes_decrypt_aesni(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+    const __m128i zero = _mm_setzero_si128();
+
+    // First round, AESDECLAST with a zero key is InvShiftRows -> InvSubBytes
+    __m128i state = _mm_xor_si128(load_block(b), load_block(keys[n_rounds]));
+    store_block(b, _mm_aesdeclast_si128(state, zero));
+
+    // Middle rounds
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        state = _mm_xor_si128(load_block(b), load_block(keys[round]));
+        state = _mm_aesimc_si128(state);
+        store_block(b, _mm_aesdeclast_si128(state, zero));
+
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+    }
+
+    // Final round
+    store_block(b, _mm_xor_si128(load_block(b), load_block(keys[0])));
+}
+
+
+/*
+ * Encrypts one AES-Blake256 group from `input` into `output`. A non-NULL `sum`
+ * accumulates the plaintext blocks as they are loaded.
+ */
+static AES_ALWAYS_INLINE AESNI_TARGET void encrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        __m128i sum[2]
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    __m128i s0 = load_block(input);
+    __m128i s1 = load_block(input + 16);
+    if (sum != NULL) {
+        sum[0] = _mm_xor_si128(sum[0], s0);
+        sum[1] = _mm_xor_si128(sum[1], s1);
+    }
+
+    // First round
+    s0 = _mm_xor_si128(s0, load_block(keys0[0]));
+    s1 = _mm_xor_si128(s1, load_block(keys1[0]));
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x2(&s0, &s1);
+        s0 = _mm_aesenc_si128(s0, load_block(keys0[round]));
+        s1 = _mm_aesenc_si128(s1, load_block(keys1[round]));
+    }
+
+    // Final round
+    s0 = _mm_aesenclast_si128(s0, load_block(keys0[n_rounds]));
+    s1 = _mm_aesenclast_si128(s1, load_block(keys1[n_rounds]));
+    exchange_columns_x2(&s0, &s1);
+
+    store_block(output, s0);
+    store_block(output + 16, s1);
+}
+
+
+/*
+ * Decrypts one AES-Blake256 group from `input` into `output`. AESDEC applies InvMixColumns
+ * before its key addition, so the middle rounds add InvMixColumns(round key) after the
+ * column exchange, which commutes with InvSubBytes and InvMixColumns but not with InvShiftRows.
+ * A non-NULL `sum` accumulates the plaintext blocks before they are stored.
+ */
+static AES_ALWAYS_INLINE AESNI_TARGET void decrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        __m128i sum[2]
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i s0 = load_block(input);
+    __m128i s1 = load_block(input + 16);
+
+    // First round
+    exchange_columns_x2(&s0, &s1);
+    s0 = _mm_xor_si128(s0, load_block(keys0[n_rounds]));
+    s1 = _mm_xor_si128(s1, load_block(keys1[n_rounds]));
+
+    // Middle rounds
+    if (n_rounds > 1) {
+        s0 = _mm_aesdec_si128(s0, _mm_aesimc_si128(load_block(keys0[n_rounds - 1])));
+        s1 = _mm_aesdec_si128(s1, _mm_aesimc_si128(load_block(keys1[n_rounds - 1])));
+    }
+    for (uint8_t round = n_rounds - 1; round > 1; round--) {
+        s0 = _mm_aesdec_si128(s0, zero);
+        s1 = _mm_aesdec_si128(s1, zero);
+        exchange_columns_x2(&s0, &s1);
+        s0 = _mm_xor_si128(s0, _mm_aesimc_si128(load_block(keys0[round - 1])));
+        s1 = _mm_xor_si128(s1, _mm_aesimc_si128(load_block(keys1[round - 1])));
+    }
+
+    // Final round
+    s0 = _mm_aesdeclast_si128(s0, zero);
+    s1 = _mm_aesdeclast_si128(s1, zero);
+    if (n_rounds > 1) {
+        exchange_columns_x2(&s0, &s1);
+    }
+    s0 = _mm_xor_si128(s0, load_block(keys0[0]));
+    s1 = _mm_xor_si128(s1, load_block(keys1[0]));
+    if (sum != NULL) {
+        sum[0] = _mm_xor_si128(sum[0], s0);
+        sum[1] = _mm_xor_si128(sum[1], s1);
+    }
+
+    store_block(output, s0);
+    store_block(output + 16, s1);
+}
+
+
+/*
+ * Encrypts one AES-Blake512 group from `input` into `output`, see `encrypt_group_x2`.
+ */
+static AES_ALWAYS_INLINE AESNI_TARGET void encrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        __m128i sum[4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+
+    __m128i s[4];
+    for (int i = 0; i < 4; i++) {
+        s[i] = load_block(input + 16 * i);
+        if (sum != NULL) {
+            sum[i] = _mm_xor_si128(sum[i], s[i]);
+        }
+        s[i] = _mm_xor_si128(s[i], load_block(round_keys[i * key_count]));
+    }
+
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x4(s);
+        for (int i = 0; i < 4; i++) {
+            s[i] = _mm_aesenc_si128(s[i], load_block(round_keys[i * key_count + round]));
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_aesenclast_si128(s[i], load_block(round_keys[i * key_count + n_rounds]));
+    }
+    exchange_columns_x4(s);
+
+    for (int i = 0; i < 4; i++) {
+        store_block(output + 16 * i, s[i]);
+    }
+}
+
+
+/*
+ * Decrypts one AES-Blake512 group from `input` into `output`, see `decrypt_group_x2`.
+ */
+static AES_ALWAYS_INLINE AESNI_TARGET void decrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        __m128i sum[4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i s[4];
+    for (int i = 0; i < 4; i++) {
+        s[i] = load_block(input + 16 * i);
+    }
+
+    // First round
+    inv_exchange_columns_x4(s);
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_xor_si128(s[i], load_block(round_keys[i * key_count + n_rounds]));
+    }
+
+    // Middle rounds
+    if (n_rounds > 1) {
+        for (int i = 0; i < 4; i++) {
+            const __m128i key = _mm_aesimc_si128(load_block(round_keys[i * key_count + n_rounds - 1]));
+            s[i] = _mm_aesdec_si128(s[i], key);
+        }
+    }
+    for (uint8_t round = n_rounds - 1; round > 1; round--) {
+        for (int i = 0; i < 4; i++) {
+            s[i] = _mm_aesdec_si128(s[i], zero);
+        }
+        inv_exchange_columns_x4(s);
+        for (int i = 0; i < 4; i++) {
+            s[i] = _mm_xor_si128(s[i], _mm_aesimc_si128(load_block(round_keys[i * key_count + round - 1])));
+        }
+    }
+
+    // Final round
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_aesdeclast_si128(s[i], zero);
+    }
+    if (n_rounds > 1) {
+        inv_exchange_columns_x4(s);
+    }
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_xor_si128(s[i], load_block(round_keys[i * key_count]));
+        if (sum != NULL) {
+            sum[i] = _mm_xor_si128(sum[i], s[i]);
+        }
+        store_block(output + 16 * i, s[i]);
+    }
+}
+
+/*
+ * AES-NI equivalent of `aes_encrypt_blocks_x2_optimized`.
+ */
+AESNI_TARGET void aes_encrypt_blocks_x2_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * AES-NI equivalent of `aes_decrypt_blocks_x2_optimized`.
+ */
+AESNI_TARGET void aes_decrypt_blocks_x2_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * AES-NI equivalent of `aes_encrypt_blocks_x4_optimized`.
+ */
+AESNI_TARGET void aes_encrypt_blocks_x4_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * AES-NI equivalent of `aes_decrypt_blocks_x4_optimized`.
+ */
+AESNI_TARGET void aes_decrypt_blocks_x4_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * Same as `aes_encrypt_blocks_x2_aesni`, and XORs every plaintext group into
+ * `checksum`. The running checksum stays in registers for the whole call, so
+ * each plaintext byte is read once for both AES and the checksum.
+ */
+AESNI_TARGET void aes_encrypt_blocks_x2_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m128i sum[2] = {load_block(checksum), load_block(checksum + 16)};
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, sum);
+        }
+    );
+    store_block(checksum, sum[0]);
+    store_block(checksum + 16, sum[1]);
+}
+
+/*
+ * Same as `aes_decrypt_blocks_x2_aesni`, and XORs every plaintext group into `checksum`.
+ */
+AESNI_TARGET void aes_decrypt_blocks_x2_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m128i sum[2] = {load_block(checksum), load_block(checksum + 16)};
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, sum);
+        }
+    );
+    store_block(checksum, sum[0]);
+    store_block(checksum + 16, sum[1]);
+}
+
+/*
+ * Same as `aes_encrypt_blocks_x4_aesni`, and XORs every plaintext group into `checksum`.
+ */
+AESNI_TARGET void aes_encrypt_blocks_x4_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m128i sum[4];
+    for (int i = 0; i < 4; i++) {
+        sum[i] = load_block(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 4; i++) {
+        store_block(checksum + 16 * i, sum[i]);
+    }
+}
+
+/*
+ * Same as `aes_decrypt_blocks_x4_aesni`, and XORs every plaintext group into `checksum`.
+ */
+AESNI_TARGET void aes_decrypt_blocks_x4_sum_aesni(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m128i sum[4];
+    for (int i = 0; i < 4; i++) {
+        sum[i] = load_block(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 4; i++) {
+        store_block(checksum + 16 * i, sum[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,501 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "aes_cpu.h"
+
+#if defined(AES_ARCH_ARM64)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <arm_neon.h>
+#include "aes_types.h"
+
+#if defined(__clang__)
+#define ARMCE_TARGET __attribute__((target("aes")))
+#elif defined(__GNUC__)
+#define ARMCE_TARGET __attribute__((target("+crypto")))
+#else
+#define ARMCE_TARGET
+#endif
+
+
+/*
+ * AESE and AESD add the round key before (Inv)ShiftRows -> (Inv)SubBytes, so the
+ * kernels below call them with a zero key and add the round keys separately,
+ * which keeps the AES-Blake column exchange in the same place as in the T-table code.
+ */
+static inline ARMCE_TARGET uint8x16_t enc_round(const uint8x16_t state, const uint8x16_t key) {
+    return veorq_u8(vaesmcq_u8(vaeseq_u8(state, vdupq_n_u8(0))), key);
+}
+
+
+static inline ARMCE_TARGET uint8x16_t enc_final_round(const uint8x16_t state, const uint8x16_t key) {
+    return veorq_u8(vaeseq_u8(state, vdupq_n_u8(0)), key);
+}
+
+
+static inline ARMCE_TARGET uint8x16_t dec_round(const uint8x16_t state, const uint8x16_t key) {
+    return vaesdq_u8(vaesimcq_u8(veorq_u8(state, key)), vdupq_n_u8(0));
+}
+
+
+/*
+ * Returns the vector made of column 0 of `a`, column 1 of `b`, column 2 of `c` and column 3 of `d`.
+ */
+static inline ARMCE_TARGET uint8x16_t pick_columns(
+        const uint8x16_t a,
+        const uint8x16_t b,
+        const uint8x16_t c,
+        const uint8x16_t d
+) {
+    static const uint32_t mask1[4] = {0, 0xFFFFFFFF, 0, 0};
+    static const uint32_t mask2[4] = {0, 0, 0xFFFFFFFF, 0};
+    static const uint32_t mask3[4] = {0, 0, 0, 0xFFFFFFFF};
+    uint8x16_t t = vbslq_u8(vreinterpretq_u8_u32(vld1q_u32(mask1)), b, a);
+    t = vbslq_u8(vreinterpretq_u8_u32(vld1q_u32(mask2)), c, t);
+    return vbslq_u8(vreinterpretq_u8_u32(vld1q_u32(mask3)), d, t);
+}
+
+
+/*
+ * AES-Blake256 column exchange, the odd columns are swapped between the two blocks.
+ */
+static inline ARMCE_TARGET void exchange_columns_x2(uint8x16_t *a, uint8x16_t *b) {
+    static const uint32_t odd_mask[4] = {0, 0xFFFFFFFF, 0, 0xFFFFFFFF};
+    const uint8x16_t mask = vreinterpretq_u8_u32(vld1q_u32(odd_mask));
+    const uint8x16_t t = vbslq_u8(mask, *b, *a);
+    *b = vbslq_u8(mask, *a, *b);
+    *a = t;
+}
+
+
+/*
+ * AES-Blake512 column exchange, column `c` of block `i` comes from block `(i + c) % 4`.
+ */
+static inline ARMCE_TARGET void exchange_columns_x4(uint8x16_t s[4]) {
+    const uint8x16_t t0 = pick_columns(s[0], s[1], s[2], s[3]);
+    const uint8x16_t t1 = pick_columns(s[1], s[2], s[3], s[0]);
+    const uint8x16_t t2 = pick_columns(s[2], s[3], s[0], s[1]);
+    const uint8x16_t t3 = pick_columns(s[3], s[0], s[1], s[2]);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+/*
+ * Inverse AES-Blake512 column exchange, column `c` of block `i` comes from block `(i - c) % 4`.
+ */
+static inline ARMCE_TARGET void inv_exchange_columns_x4(uint8x16_t s[4]) {
+    const uint8x16_t t0 = pick_columns(s[0], s[3], s[2], s[1]);
+    const uint8x16_t t1 = pick_columns(s[1], s[0], s[3], s[2]);
+    const uint8x16_t t2 = pick_columns(s[2], s[1], s[0], s[3]);
+    const uint8x16_t t3 = pick_columns(s[3], s[2], s[1], s[0]);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+ARMCE_TARGET void aes_encrypt_armce(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    // First round
+    vst1q_u8(b, veorq_u8(vld1q_u8(b), vld1q_u8(keys[0])));
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+        vst1q_u8(b, enc_round(vld1q_u8(b), vld1q_u8(keys[round])));
+    }
+
+    // Final round
+    vst1q_u8(b, enc_final_round(vld1q_u8(b), vld1q_u8(keys[n_rounds])));
+}
+
+
+ARMCE_TARGET void aes_decrypt_armce(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    // First round
+    vst1q_u8(b, vaesdq_u8(vld1q_u8(b), vld1q_u8(keys[n_rounds])));
+
+    // Middle rounds
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        vst1q_u8(b, dec_round(vld1q_u8(b), vld1q_u8(keys[round])));
+
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+    }
+
+    // Final round
+    vst1q_u8(b, veorq_u8(vld1q_u8(b), vld1q_u8(keys[0])));
+}
+
+
+/*
+ * Encrypts one AES-Blake256 group from `input` into `output`. A non-NULL `sum`
+ * accumulates the plaintext blocks as they are loaded.
+ */
+static AES_ALWAYS_INLINE ARMCE_TARGET void encrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        uint8x16_t sum[2]
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint8x16_t s0 = vld1q_u8(input);
+    uint8x16_t s1 = vld1q_u8(input + 16);
+    if (sum != NULL) {
+        sum[0] = veorq_u8(sum[0], s0);
+        sum[1] = veorq_u8(sum[1], s1);
+    }
+    s0 = veorq_u8(s0, vld1q_u8(keys0[0]));
+    s1 = veorq_u8(s1, vld1q_u8(keys1[0]));
+
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x2(&s0, &s1);
+        s0 = enc_round(s0, vld1q_u8(keys0[round]));
+        s1 = enc_round(s1, vld1q_u8(keys1[round]));
+    }
+
+    s0 = enc_final_round(s0, vld1q_u8(keys0[n_rounds]));
+    s1 = enc_final_round(s1, vld1q_u8(keys1[n_rounds]));
+    exchange_columns_x2(&s0, &s1);
+
+    vst1q_u8(output, s0);
+    vst1q_u8(output + 16, s1);
+}
+
+
+/*
+ * Decrypts one AES-Blake256 group from `input` into `output`. A non-NULL `sum`
+ * accumulates the plaintext blocks before they are stored.
+ */
+static AES_ALWAYS_INLINE ARMCE_TARGET void decrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        uint8x16_t sum[2]
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint8x16_t s0 = vld1q_u8(input);
+    uint8x16_t s1 = vld1q_u8(input + 16);
+
+    exchange_columns_x2(&s0, &s1);
+    s0 = vaesdq_u8(s0, vld1q_u8(keys0[n_rounds]));
+    s1 = vaesdq_u8(s1, vld1q_u8(keys1[n_rounds]));
+
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        s0 = dec_round(s0, vld1q_u8(keys0[round]));
+        s1 = dec_round(s1, vld1q_u8(keys1[round]));
+        exchange_columns_x2(&s0, &s1);
+    }
+
+    s0 = veorq_u8(s0, vld1q_u8(keys0[0]));
+    s1 = veorq_u8(s1, vld1q_u8(keys1[0]));
+    if (sum != NULL) {
+        sum[0] = veorq_u8(sum[0], s0);
+        sum[1] = veorq_u8(sum[1], s1);
+    }
+    vst1q_u8(output, s0);
+    vst1q_u8(output + 16, s1);
+}
+
+
+/*
+ * Encrypts one AES-Blake512 group from `input` into `output`, see `encrypt_group_x2`.
+ */
+static AES_ALWAYS_INLINE ARMCE_TARGET void encrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        uint8x16_t sum[4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+
+    uint8x16_t s[4];
+    for (int i = 0; i < 4; i++) {
+        s[i] = vld1q_u8(input + 16 * i);
+        if (sum != NULL) {
+            sum[i] = veorq_u8(sum[i], s[i]);
+        }
+        s[i] = veorq_u8(s[i], vld1q_u8(round_keys[i * key_count]));
+    }
+
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x4(s);
+        for (int i = 0; i < 4; i++) {
+            s[i] = enc_round(s[i], vld1q_u8(round_keys[i * key_count + round]));
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        s[i] = enc_final_round(s[i], vld1q_u8(round_keys[i * key_count + n_rounds]));
+    }
+    exchange_columns_x4(s);
+
+    for (int i = 0; i < 4; i++) {
+        vst1q_u8(output + 16 * i, s[i]);
+    }
+}
+
+
+/*
+ * Decrypts one AES-Blake512 group from `input` into `output`, see `decrypt_group_x2`.
+ */
+static AES_ALWAYS_INLINE ARMCE_TARGET void decrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        uint8x16_t sum[4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+
+    uint8x16_t s[4];
+    for (int i = 0; i < 4; i++) {
+        s[i] = vld1q_u8(input + 16 * i);
+    }
+
+    inv_exchange_columns_x4(s);
+    for (int i = 0; i < 4; i++) {
+        s[i] = vaesdq_u8(s[i], vld1q_u8(round_keys[i * key_count + n_rounds]));
+    }
+
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        for (int i = 0; i < 4; i++) {
+            s[i] = dec_round(s[i], vld1q_u8(round_keys[i * key_count + round]));
+        }
+        inv_exchange_columns_x4(s);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        s[i] = veorq_u8(s[i], vld1q_u8(round_keys[i * key_count]));
+        if (sum != NULL) {
+            sum[i] = veorq_u8(sum[i], s[i]);
+        }
+        vst1q_u8(output + 16 * i, s[i]);
+    }
+}
+
+/*
+ * ARMv8 CE equivalent of `aes_encrypt_blocks_x2_optimized`.
+ */
+ARMCE_TARGET void aes_encrypt_blocks_x2_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * ARMv8 CE equivalent of `aes_decrypt_blocks_x2_optimized`.
+ */
+ARMCE_TARGET void aes_decrypt_blocks_x2_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * ARMv8 CE equivalent of `aes_encrypt_blocks_x4_optimized`.
+ */
+ARMCE_TARGET void aes_encrypt_blocks_x4_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * ARMv8 CE equivalent of `aes_decrypt_blocks_x4_optimized`.
+ */
+ARMCE_TARGET void aes_decrypt_blocks_x4_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, NULL);
+        }
+    );
+}
+
+/*
+ * Same as `aes_encrypt_blocks_x2_armce`, and XORs every plaintext group into
+ * `checksum`. The running checksum stays in registers for the whole call.
+ */
+ARMCE_TARGET void aes_encrypt_blocks_x2_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    uint8x16_t sum[2];
+    for (int i = 0; i < 2; i++) {
+        sum[i] = vld1q_u8(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 2; i++) {
+        vst1q_u8(checksum + 16 * i, sum[i]);
+    }
+}
+
+/*
+ * Same as `aes_decrypt_blocks_x2_armce`, and XORs every plaintext group into `checksum`.
+ */
+ARMCE_TARGET void aes_decrypt_blocks_x2_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    uint8x16_t sum[2];
+    for (int i = 0; i < 2; i++) {
+        sum[i] = vld1q_u8(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 2; i++) {
+        vst1q_u8(checksum + 16 * i, sum[i]);
+    }
+}
+
+/*
+ * Same as `aes_encrypt_blocks_x4_armce`, and XORs every plaintext group into `checksum`.
+ */
+ARMCE_TARGET void aes_encrypt_blocks_x4_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    uint8x16_t sum[4];
+    for (int i = 0; i < 4; i++) {
+        sum[i] = vld1q_u8(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 4; i++) {
+        vst1q_u8(checksum + 16 * i, sum[i]);
+    }
+}
+
+/*
+ * Same as `aes_decrypt_blocks_x4_armce`, and XORs every plaintext group into `checksum`.
+ */
+ARMCE_TARGET void aes_decrypt_blocks_x4_sum_armce(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    uint8x16_t sum[4];
+    for (int i = 0; i < 4; i++) {
+        sum[i] = vld1q_u8(checksum + 16 * i);
+    }
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        for (size_t g = 0; g < group_count; g++) {
+            decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, sum);
+        }
+    );
+    for (int i = 0; i < 4; i++) {
+        vst1q_u8(checksum + 16 * i, sum[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,392 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_block.h"
+#include "aes_planes.h"
+
+
+/*
+ * Constant-time AES for CPUs without AES instructions, on the bit planes of
+ * `aes_planes.h`.
+ */
+
+
+/*
+ * Applies the AES S-box to all bit planes with the Boyar-Peralta circuit.
+ */
+static void sub_bytes_planes(bs_word q[8]) {
+    bs_word y[22], z[18];
+    bs_word t2, t3, t4, t5, t6, t7, t8, t9;
+    bs_word t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    bs_word t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    bs_word t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    bs_word t40, t41, t42, t43, t44, t45;
+
+    sbox_top_planes(q, y);
+
+    /* Non-linear section */
+    t2 = y[12] & y[15];
+    t3 = y[3] & y[6];
+    t4 = t3 ^ t2;
+    t5 = y[4] & y[0];
+    t6 = t5 ^ t2;
+    t7 = y[13] & y[16];
+    t8 = y[5] & y[1];
+    t9 = t8 ^ t7;
+    t10 = y[2] & y[7];
+    t11 = t10 ^ t7;
+    t12 = y[9] & y[11];
+    t13 = y[14] & y[17];
+    t14 = t13 ^ t12;
+    t15 = y[8] & y[10];
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y[20];
+    t22 = t18 ^ y[19];
+    t23 = t19 ^ y[21];
+    t24 = t20 ^ y[18];
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z[0] = t44 & y[15];
+    z[1] = t37 & y[6];
+    z[2] = t33 & y[0];
+    z[3] = t43 & y[16];
+    z[4] = t40 & y[1];
+    z[5] = t29 & y[7];
+    z[6] = t42 & y[11];
+    z[7] = t45 & y[17];
+    z[8] = t41 & y[10];
+    z[9] = t44 & y[12];
+    z[10] = t37 & y[3];
+    z[11] = t33 & y[4];
+    z[12] = t43 & y[13];
+    z[13] = t40 & y[5];
+    z[14] = t29 & y[2];
+    z[15] = t42 & y[9];
+    z[16] = t45 & y[14];
+    z[17] = t41 & y[8];
+
+    sbox_bottom_planes(q, z, ~(bs_word){0});
+}
+
+
+/*
+ * Applies the inverse S-box as A^-1(S(A^-1(x))), where A is the affine part
+ * of the forward S-box, so both directions share the same circuit.
+ */
+static void inv_sub_bytes_planes(bs_word q[8]) {
+    inv_affine_planes(q, ~(bs_word){0});
+    sub_bytes_planes(q);
+    inv_affine_planes(q, ~(bs_word){0});
+}
+
+
+/*
+ * Runs one pass of up to BS_BLOCKS consecutive blocks from `input` into `output`, each
+ * with its own `key_count` round keys. Unused slots read zeros and are discarded.
+ */
+static void encrypt_pass(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t spare[BS_BLOCKS][16];
+    const uint8_t *in_blocks[BS_BLOCKS];
+    uint8_t *out_blocks[BS_BLOCKS];
+    bs_word q[8], k[8];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        in_blocks[i] = i < block_count ? input + i * 16 : zero_block;
+        out_blocks[i] = i < block_count ? output + i * 16 : spare[i];
+    }
+    load_planes(q, in_blocks);
+
+    load_round_keys(k, round_keys, key_count, block_count, 0);
+    add_round_key_planes(q, k);
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange(q);
+        sub_bytes_planes(q);
+        shift_rows_planes(q);
+        mix_columns_planes(q);
+        load_round_keys(k, round_keys, key_count, block_count, round);
+        add_round_key_planes(q, k);
+    }
+    sub_bytes_planes(q);
+    shift_rows_planes(q);
+    load_round_keys(k, round_keys, key_count, block_count, n_rounds);
+    add_round_key_planes(q, k);
+    exchange(q);
+
+    store_planes(q, out_blocks);
+}
+
+
+/*
+ * Exactly undoes `encrypt_pass` when given the inverse exchange function.
+ */
+static void decrypt_pass(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t spare[BS_BLOCKS][16];
+    const uint8_t *in_blocks[BS_BLOCKS];
+    uint8_t *out_blocks[BS_BLOCKS];
+    bs_word q[8], k[8];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        in_blocks[i] = i < block_count ? input + i * 16 : zero_block;
+        out_blocks[i] = i < block_count ? output + i * 16 : spare[i];
+    }
+    load_planes(q, in_blocks);
+
+    exchange(q);
+    load_round_keys(k, round_keys, key_count, block_count, n_rounds);
+    add_round_key_planes(q, k);
+    inv_shift_rows_planes(q);
+    inv_sub_bytes_planes(q);
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        load_round_keys(k, round_keys, key_count, block_count, round);
+        add_round_key_planes(q, k);
+        inv_mix_columns_planes(q);
+        inv_shift_rows_planes(q);
+        inv_sub_bytes_planes(q);
+        exchange(q);
+    }
+    load_round_keys(k, round_keys, key_count, block_count, 0);
+    add_round_key_planes(q, k);
+
+    store_planes(q, out_blocks);
+}
+
+
+static void encrypt_blocks(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    for (size_t i = 0; i < block_count; i += BS_BLOCKS) {
+        const size_t n = block_count - i < BS_BLOCKS ? block_count - i : BS_BLOCKS;
+        encrypt_pass(input + i * 16, output + i * 16, &round_keys[i * key_count], key_count, n, exchange);
+    }
+}
+
+
+static void decrypt_blocks(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    for (size_t i = 0; i < block_count; i += BS_BLOCKS) {
+        const size_t n = block_count - i < BS_BLOCKS ? block_count - i : BS_BLOCKS;
+        decrypt_pass(input + i * 16, output + i * 16, &round_keys[i * key_count], key_count, n, exchange);
+    }
+}
+
+
+/**
+ * Encrypts a single 16‐byte block in place, chosen by block_index. The block
+ * is kept in bit planes for all rounds, the callback runs at the same points
+ * as in `aes_encrypt_clean`.
+ */
+void aes_encrypt_bitsliced(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    uint8_t spare[BS_BLOCKS][16] = {{0}};
+    uint8_t *blocks[BS_BLOCKS];
+    bs_word q[8], k[8];
+
+    blocks[0] = data + (size_t)block_index * 16;
+    for (size_t i = 1; i < BS_BLOCKS; i++) {
+        blocks[i] = spare[i];
+    }
+    load_planes(q, (const uint8_t *const *)blocks);
+
+    load_round_keys(k, keys, key_count, 1, 0);
+    add_round_key_planes(q, k);
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+        sub_bytes_planes(q);
+        shift_rows_planes(q);
+        mix_columns_planes(q);
+        load_round_keys(k, keys, key_count, 1, round);
+        add_round_key_planes(q, k);
+    }
+    sub_bytes_planes(q);
+    shift_rows_planes(q);
+    load_round_keys(k, keys, key_count, 1, n_rounds);
+    add_round_key_planes(q, k);
+
+    store_planes(q, blocks);
+}
+
+
+/**
+ * Decrypts a single 16‐byte block in place, chosen by block_index.
+ */
+void aes_decrypt_bitsliced(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    uint8_t spare[BS_BLOCKS][16] = {{0}};
+    uint8_t *blocks[BS_BLOCKS];
+    bs_word q[8], k[8];
+
+    blocks[0] = data + (size_t)block_index * 16;
+    for (size_t i = 1; i < BS_BLOCKS; i++) {
+        blocks[i] = spare[i];
+    }
+    load_planes(q, (const uint8_t *const *)blocks);
+
+    load_round_keys(k, keys, key_count, 1, n_rounds);
+    add_round_key_planes(q, k);
+    inv_shift_rows_planes(q);
+    inv_sub_bytes_planes(q);
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        load_round_keys(k, keys, key_count, 1, round);
+        add_round_key_planes(q, k);
+        inv_mix_columns_planes(q);
+        inv_shift_rows_planes(q);
+        inv_sub_bytes_planes(q);
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+    }
+    load_round_keys(k, keys, key_count, 1, 0);
+    add_round_key_planes(q, k);
+
+    store_planes(q, blocks);
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, BS_BLOCKS
+ * blocks per pass. The round keys of group `g` start at
+ * `round_keys[g * 2 * key_count]`.
+ */
+void aes_encrypt_blocks_x2_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, see `aes_encrypt_blocks_x2_bitsliced`.
+ */
+void aes_decrypt_blocks_x2_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, BS_BLOCKS
+ * blocks per pass. The round keys of group `g` start at
+ * `round_keys[g * 4 * key_count]`.
+ */
+void aes_encrypt_blocks_x4_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, key_count, group_count * 4, exchange_x4_enc_planes);
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, see `aes_encrypt_blocks_x4_bitsliced`.
+ */
+void aes_decrypt_blocks_x4_bitsliced(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, key_count, group_count * 4, exchange_x4_dec_planes);
+}
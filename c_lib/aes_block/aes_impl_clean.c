@@ -10,6 +10,8 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include "aes_ops.h"
 #include "aes_block.h"
 
@@ -138,3 +140,171 @@ void aes_decrypt_clean(
     }
     add_round_key(state, keys, 0);
 }
+
+
+/**
+ * Encrypts a group of `block_count` 16-byte blocks in place, advancing all
+ * blocks through each round together and exchanging their columns according
+ * to `ex_cols_pattern` before every middle round and after the final round.
+ */
+void aes_encrypt_group_clean(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+
+    for (uint8_t i = 0; i < block_count; i++) {
+        add_round_key(data + i * 16, &round_keys[i * key_count], 0);
+    }
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns(data, block_count, ex_cols_pattern);
+        for (uint8_t i = 0; i < block_count; i++) {
+            uint8_t *state = data + i * 16;
+            sub_bytes(state);
+            shift_rows(state);
+            mix_columns(state);
+            add_round_key(state, &round_keys[i * key_count], round);
+        }
+    }
+    for (uint8_t i = 0; i < block_count; i++) {
+        uint8_t *state = data + i * 16;
+        sub_bytes(state);
+        shift_rows(state);
+        add_round_key(state, &round_keys[i * key_count], n_rounds);
+    }
+    exchange_columns(data, block_count, ex_cols_pattern);
+}
+
+
+/**
+ * Decrypts a group of `block_count` 16-byte blocks in place, exactly undoing
+ * `aes_encrypt_group_clean` when given the inverse `ex_cols_pattern`.
+ */
+void aes_decrypt_group_clean(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+
+    exchange_columns(data, block_count, ex_cols_pattern);
+    for (uint8_t i = 0; i < block_count; i++) {
+        uint8_t *state = data + i * 16;
+        add_round_key(state, &round_keys[i * key_count], n_rounds);
+        inv_shift_rows(state);
+        inv_sub_bytes(state);
+    }
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        for (uint8_t i = 0; i < block_count; i++) {
+            uint8_t *state = data + i * 16;
+            add_round_key(state, &round_keys[i * key_count], round);
+            inv_mix_columns(state);
+            inv_shift_rows(state);
+            inv_sub_bytes(state);
+        }
+        exchange_columns(data, block_count, ex_cols_pattern);
+    }
+    for (uint8_t i = 0; i < block_count; i++) {
+        add_round_key(data + i * 16, &round_keys[i * key_count], 0);
+    }
+}
+
+
+/* Column exchange patterns of AES-Blake256 (x2, self-inverse) and AES-Blake512 (x4). */
+static const uint8_t pattern_x2[2][4] = {
+    {0, 1, 0, 1}, {1, 0, 1, 0}
+};
+static const uint8_t enc_pattern_x4[4][4] = {
+    {0, 1, 2, 3}, {1, 2, 3, 0}, {2, 3, 0, 1}, {3, 0, 1, 2}
+};
+static const uint8_t dec_pattern_x4[4][4] = {
+    {0, 3, 2, 1}, {1, 0, 3, 2}, {2, 1, 0, 3}, {3, 2, 1, 0}
+};
+
+
+/*
+ * The reference group functions work in place, so out-of-place calls
+ * first copy the input over to the output buffer.
+ */
+static void copy_groups(const uint8_t input[], uint8_t output[], const size_t length) {
+    if (input != output) {
+        memcpy(output, input, length);
+    }
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output` with the
+ * reference group function. The round keys of group `g` start at
+ * `round_keys[g * 2 * key_count]`.
+ */
+void aes_encrypt_blocks_x2_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    copy_groups(input, output, group_count * 32);
+    for (size_t g = 0; g < group_count; g++) {
+        aes_encrypt_group_clean(output + g * 32, &round_keys[g * 2 * key_count], key_count, 2, pattern_x2);
+    }
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, see `aes_encrypt_blocks_x2_clean`.
+ */
+void aes_decrypt_blocks_x2_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    copy_groups(input, output, group_count * 32);
+    for (size_t g = 0; g < group_count; g++) {
+        aes_decrypt_group_clean(output + g * 32, &round_keys[g * 2 * key_count], key_count, 2, pattern_x2);
+    }
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output` with the
+ * reference group function. The round keys of group `g` start at
+ * `round_keys[g * 4 * key_count]`.
+ */
+void aes_encrypt_blocks_x4_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    copy_groups(input, output, group_count * 64);
+    for (size_t g = 0; g < group_count; g++) {
+        aes_encrypt_group_clean(output + g * 64, &round_keys[g * 4 * key_count], key_count, 4, enc_pattern_x4);
+    }
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, see `aes_encrypt_blocks_x4_clean`.
+ */
+void aes_decrypt_blocks_x4_clean(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    copy_groups(input, output, group_count * 64);
+    for (size_t g = 0; g < group_count; g++) {
+        aes_decrypt_group_clean(output + g * 64, &round_keys[g * 4 * key_count], key_count, 4, dec_pattern_x4);
+    }
+}
@@ -0,0 +1,477 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_types.h"
+#include "aes_ops.h"
+#include "aes_words.h"
+#include "aes_tables.h"
+#include "aes_block.h"
+
+
+/*
+ * Compact T-table backend. The T-table backend reads four 1 KB tables per direction
+ * plus a 256-byte S-box, although Te1..Te3 and Td1..Td3 are only rotations of Te0
+ * and Td0. This backend keeps one 2 KB table per direction with every word stored
+ * twice, where an unaligned read at the right offset gives the rotated word, and takes
+ * the final round S-box from byte 1 of the Te0 entries, which holds S[x]. Decryption
+ * composes Td0 with the S-box for InvMixColumns of the round keys instead of reading
+ * the IMC tables. Encryption touches 2 KB of tables and decryption 2.5 KB instead of
+ * 4.25 KB and 8.25 KB, at the same instruction count as the T-table rounds plus the
+ * S-box reads of the keys. Output matches the T-table backend. The single-block
+ * decryption keeps the standard round order for its callbacks.
+ */
+static inline uint32_t lookup(const uint64_t table[256], const uint32_t x, const size_t offset) {
+    uint32_t w;
+    memcpy(&w, (const uint8_t *)&table[x] + offset, 4);
+    return w;
+}
+
+#define TE(x, r)  lookup(Te0_x2, x, (4 - (r)) & 3)
+#define TD(x, r)  lookup(Td0_x2, x, (4 - (r)) & 3)
+#define SBOX(x)   ((uint32_t)((const uint8_t *)&Te0_x2[x])[1])
+
+
+static inline void enc_round_words(uint32_t s[4], const uint8_t key[16]) {
+    const uint32_t t0 = TE(B0(s[0]), 0) ^ TE(B1(s[1]), 1) ^ TE(B2(s[2]), 2) ^ TE(B3(s[3]), 3);
+    const uint32_t t1 = TE(B0(s[1]), 0) ^ TE(B1(s[2]), 1) ^ TE(B2(s[3]), 2) ^ TE(B3(s[0]), 3);
+    const uint32_t t2 = TE(B0(s[2]), 0) ^ TE(B1(s[3]), 1) ^ TE(B2(s[0]), 2) ^ TE(B3(s[1]), 3);
+    const uint32_t t3 = TE(B0(s[3]), 0) ^ TE(B1(s[0]), 1) ^ TE(B2(s[1]), 2) ^ TE(B3(s[2]), 3);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+    xor_key_words(s, key);
+}
+
+
+static inline void enc_final_round_words(uint32_t s[4], const uint8_t key[16]) {
+    const uint32_t t0 = SBOX(B0(s[0]))
+                      | SBOX(B1(s[1])) <<  8
+                      | SBOX(B2(s[2])) << 16
+                      | SBOX(B3(s[3])) << 24;
+    const uint32_t t1 = SBOX(B0(s[1]))
+                      | SBOX(B1(s[2])) <<  8
+                      | SBOX(B2(s[3])) << 16
+                      | SBOX(B3(s[0])) << 24;
+    const uint32_t t2 = SBOX(B0(s[2]))
+                      | SBOX(B1(s[3])) <<  8
+                      | SBOX(B2(s[0])) << 16
+                      | SBOX(B3(s[1])) << 24;
+    const uint32_t t3 = SBOX(B0(s[3]))
+                      | SBOX(B1(s[0])) <<  8
+                      | SBOX(B2(s[1])) << 16
+                      | SBOX(B3(s[2])) << 24;
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+    xor_key_words(s, key);
+}
+
+
+/*
+ * InvMixColumns of one column word. Td0[S[x]] equals IMC0[x], so the
+ * S-box composed with Td0 stands in for an IMC table.
+ */
+static inline uint32_t inv_mix_column_word(const uint32_t w) {
+    return TD(aes_sbox[B0(w)], 0) ^ TD(aes_sbox[B1(w)], 1) ^ TD(aes_sbox[B2(w)], 2) ^ TD(aes_sbox[B3(w)], 3);
+}
+
+
+static inline void inv_mix_columns_words(uint32_t s[4]) {
+    s[0] = inv_mix_column_word(s[0]);
+    s[1] = inv_mix_column_word(s[1]);
+    s[2] = inv_mix_column_word(s[2]);
+    s[3] = inv_mix_column_word(s[3]);
+}
+
+
+/*
+ * XORs InvMixColumns of `key` into the state, the round key of the equivalent
+ * inverse cipher. The key words do not depend on the state, so their lookups run
+ * in parallel with the lookups of the round instead of after them.
+ */
+static inline void xor_inv_mix_key_words(uint32_t s[4], const uint8_t key[16]) {
+    uint32_t k[4];
+    load_words(k, key);
+    s[0] ^= inv_mix_column_word(k[0]);
+    s[1] ^= inv_mix_column_word(k[1]);
+    s[2] ^= inv_mix_column_word(k[2]);
+    s[3] ^= inv_mix_column_word(k[3]);
+}
+
+
+/*
+ * One round of the equivalent inverse cipher without the round key: InvShiftRows,
+ * InvSubBytes and InvMixColumns in one lookup per state byte.
+ */
+static inline void inv_round_words(uint32_t s[4]) {
+    const uint32_t t0 = TD(B0(s[0]), 0) ^ TD(B1(s[3]), 1) ^ TD(B2(s[2]), 2) ^ TD(B3(s[1]), 3);
+    const uint32_t t1 = TD(B0(s[1]), 0) ^ TD(B1(s[0]), 1) ^ TD(B2(s[3]), 2) ^ TD(B3(s[2]), 3);
+    const uint32_t t2 = TD(B0(s[2]), 0) ^ TD(B1(s[1]), 1) ^ TD(B2(s[0]), 2) ^ TD(B3(s[3]), 3);
+    const uint32_t t3 = TD(B0(s[3]), 0) ^ TD(B1(s[2]), 1) ^ TD(B2(s[1]), 2) ^ TD(B3(s[0]), 3);
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+void aes_encrypt_compact(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+    uint32_t s[4];
+
+    // First round
+    add_round_key(b, keys, 0);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+
+        load_words(s, b);
+        enc_round_words(s, keys[round]);
+        store_words(b, s);
+    }
+
+    // Final round
+    load_words(s, b);
+    enc_final_round_words(s, keys[n_rounds]);
+    store_words(b, s);
+}
+
+
+void aes_decrypt_compact(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    uint8_t *b = data + block_index * 16;
+
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    const uint8_t n_rounds = key_count - 1;
+    uint32_t s[4];
+
+    // First round
+    load_words(s, b);
+    xor_key_words(s, keys[n_rounds]);
+    inv_shift_rows_inv_sub_bytes_words(s);
+    store_words(b, s);
+
+    // Middle rounds
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        load_words(s, b);
+        xor_key_words(s, keys[round]);
+        inv_mix_columns_words(s);
+        inv_shift_rows_inv_sub_bytes_words(s);
+        store_words(b, s);
+
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+    }
+
+    // Final round
+    add_round_key(b, keys, 0);
+}
+
+
+/*
+ * Encrypts the two blocks of an AES-Blake256 group from `input` into `output`.
+ * Both blocks run through each round together and their columns are
+ * exchanged between rounds, producing the same output as `aes_encrypt_group_optimized`
+ * with the AES-Blake256 encryption pattern.
+ */
+static inline void encrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s0[4], s1[4];
+    load_words(s0, input);
+    load_words(s1, input + 16);
+
+    // First round
+    xor_key_words(s0, keys0[0]);
+    xor_key_words(s1, keys1[0]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x2(s0, s1);
+        enc_round_words(s0, keys0[round]);
+        enc_round_words(s1, keys1[round]);
+    }
+
+    // Final round
+    enc_final_round_words(s0, keys0[n_rounds]);
+    enc_final_round_words(s1, keys1[n_rounds]);
+    exchange_columns_x2(s0, s1);
+
+    store_words(output, s0);
+    store_words(output + 16, s1);
+}
+
+
+/*
+ * Decrypts the two blocks of an AES-Blake256 group from `input` into `output`,
+ * undoing `encrypt_group_x2`. Uses the equivalent inverse cipher of FIPS-197 5.3.5,
+ * which applies InvMixColumns to the middle round keys instead of the state, so that
+ * a round costs the same table lookups as an encryption round.
+ */
+static inline void decrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s0[4], s1[4];
+    load_words(s0, input);
+    load_words(s1, input + 16);
+
+    // First round
+    exchange_columns_x2(s0, s1);
+    xor_key_words(s0, keys0[n_rounds]);
+    xor_key_words(s1, keys1[n_rounds]);
+
+    // Middle rounds, the column exchange commutes with InvMixColumns and moves after it
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        inv_round_words(s0);
+        inv_round_words(s1);
+        if (round + 1 < n_rounds) {
+            exchange_columns_x2(s0, s1);
+        }
+        xor_inv_mix_key_words(s0, keys0[round]);
+        xor_inv_mix_key_words(s1, keys1[round]);
+    }
+
+    // Final round
+    inv_shift_rows_inv_sub_bytes_words(s0);
+    inv_shift_rows_inv_sub_bytes_words(s1);
+    if (n_rounds > 1) {
+        exchange_columns_x2(s0, s1);
+    }
+    xor_key_words(s0, keys0[0]);
+    xor_key_words(s1, keys1[0]);
+
+    store_words(output, s0);
+    store_words(output + 16, s1);
+}
+
+
+/*
+ * Encrypts the four blocks of an AES-Blake512 group from `input` into `output`.
+ * All blocks run through each round together and their columns are
+ * exchanged between rounds, producing the same output as `aes_encrypt_group_optimized`
+ * with the AES-Blake512 encryption pattern.
+ */
+static inline void encrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t (*keys2)[16] = &round_keys[key_count * 2];
+    const uint8_t (*keys3)[16] = &round_keys[key_count * 3];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s[4][4];
+    load_words(s[0], input);
+    load_words(s[1], input + 16);
+    load_words(s[2], input + 32);
+    load_words(s[3], input + 48);
+
+    // First round
+    xor_key_words(s[0], keys0[0]);
+    xor_key_words(s[1], keys1[0]);
+    xor_key_words(s[2], keys2[0]);
+    xor_key_words(s[3], keys3[0]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x4(s);
+        enc_round_words(s[0], keys0[round]);
+        enc_round_words(s[1], keys1[round]);
+        enc_round_words(s[2], keys2[round]);
+        enc_round_words(s[3], keys3[round]);
+    }
+
+    // Final round
+    enc_final_round_words(s[0], keys0[n_rounds]);
+    enc_final_round_words(s[1], keys1[n_rounds]);
+    enc_final_round_words(s[2], keys2[n_rounds]);
+    enc_final_round_words(s[3], keys3[n_rounds]);
+    exchange_columns_x4(s);
+
+    store_words(output, s[0]);
+    store_words(output + 16, s[1]);
+    store_words(output + 32, s[2]);
+    store_words(output + 48, s[3]);
+}
+
+
+/*
+ * Decrypts the four blocks of an AES-Blake512 group from `input` into
+ * `output`, undoing `encrypt_group_x4`, see `decrypt_group_x2`.
+ */
+static inline void decrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t (*keys2)[16] = &round_keys[key_count * 2];
+    const uint8_t (*keys3)[16] = &round_keys[key_count * 3];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s[4][4];
+    load_words(s[0], input);
+    load_words(s[1], input + 16);
+    load_words(s[2], input + 32);
+    load_words(s[3], input + 48);
+
+    // First round
+    inv_exchange_columns_x4(s);
+    xor_key_words(s[0], keys0[n_rounds]);
+    xor_key_words(s[1], keys1[n_rounds]);
+    xor_key_words(s[2], keys2[n_rounds]);
+    xor_key_words(s[3], keys3[n_rounds]);
+
+    // Middle rounds, the column exchange commutes with InvMixColumns and moves after it
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        inv_round_words(s[0]);
+        inv_round_words(s[1]);
+        inv_round_words(s[2]);
+        inv_round_words(s[3]);
+        if (round + 1 < n_rounds) {
+            inv_exchange_columns_x4(s);
+        }
+        xor_inv_mix_key_words(s[0], keys0[round]);
+        xor_inv_mix_key_words(s[1], keys1[round]);
+        xor_inv_mix_key_words(s[2], keys2[round]);
+        xor_inv_mix_key_words(s[3], keys3[round]);
+    }
+
+    // Final round
+    inv_shift_rows_inv_sub_bytes_words(s[0]);
+    inv_shift_rows_inv_sub_bytes_words(s[1]);
+    inv_shift_rows_inv_sub_bytes_words(s[2]);
+    inv_shift_rows_inv_sub_bytes_words(s[3]);
+    if (n_rounds > 1) {
+        inv_exchange_columns_x4(s);
+    }
+    xor_key_words(s[0], keys0[0]);
+    xor_key_words(s[1], keys1[0]);
+    xor_key_words(s[2], keys2[0]);
+    xor_key_words(s[3], keys3[0]);
+
+    store_words(output, s[0]);
+    store_words(output + 16, s[1]);
+    store_words(output + 32, s[2]);
+    store_words(output + 48, s[3]);
+}
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`. The round keys of group `g` start at `round_keys[g * 2 * key_count]`.
+ */
+void aes_encrypt_blocks_x2_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * key_count], key_count);
+    }
+}
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, see `aes_encrypt_blocks_x2_compact`.
+ */
+void aes_decrypt_blocks_x2_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * key_count], key_count);
+    }
+}
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`. The round keys of group `g` start at `round_keys[g * 4 * key_count]`.
+ */
+void aes_encrypt_blocks_x4_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * key_count], key_count);
+    }
+}
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, see `aes_encrypt_blocks_x4_compact`.
+ */
+void aes_decrypt_blocks_x4_compact(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * key_count], key_count);
+    }
+}
@@ -0,0 +1,584 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "aes_block.h"
+#include "aes_planes.h"
+#include "csprng.h"
+
+
+/*
+ * First-order masked AES on the bit planes of `aes_planes.h`. Every plane is
+ * split into two Boolean shares whose XOR is the plain plane, and the plain
+ * state is only formed again when the output blocks are stored. The linear
+ * steps run on each share separately, the AND gates of the S-box use the
+ * DOM-independent gadget of the masked Python reference.
+ *
+ * Each S-box layer takes SBOX_AND_GATES fresh random planes and each plain round
+ * key a fresh byte mask, round keys of the masked keygen arrive masked already.
+ * Both are drawn in one batch per step from the buffered CSPRNG of the calling
+ * thread, which reads the system RNG only to reseed.
+ */
+#define SBOX_AND_GATES 32
+
+
+typedef bs_word MaskedPlane[2];
+
+
+static inline void masked_xor(MaskedPlane out, const MaskedPlane a, const MaskedPlane b) {
+    out[0] = a[0] ^ b[0];
+    out[1] = a[1] ^ b[1];
+}
+
+
+/*
+ * DOM-independent AND: the cross products are remasked with `r` before they are
+ * folded into the shares, so no intermediate depends on both shares of an input.
+ */
+static inline void masked_and(MaskedPlane out, const MaskedPlane a, const MaskedPlane b, const bs_word r) {
+    const bs_word cross0 = (a[0] & b[1]) ^ r;
+    const bs_word cross1 = (a[1] & b[0]) ^ r;
+    out[0] = (a[0] & b[0]) ^ cross0;
+    out[1] = (a[1] & b[1]) ^ cross1;
+}
+
+
+/*
+ * The S-box constant is added by one share only, see `sbox_bottom_planes`.
+ */
+static inline bs_word share_not_mask(const int share) {
+    return share == 0 ? ~(bs_word){0} : (bs_word){0};
+}
+
+
+/*
+ * Loads the blocks pointed to by `blocks` as two shares, the first one from
+ * the blocks XOR a fresh random mask and the second one from the mask.
+ */
+static void load_masked_planes(bs_word q[2][8], const uint8_t *const blocks[BS_BLOCKS]) {
+    uint8_t mask[BS_BLOCKS][16];
+    uint8_t masked[BS_BLOCKS][16];
+    const uint8_t *shares[2][BS_BLOCKS];
+
+    csprng_fill(&mask[0][0], sizeof(mask));
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        for (int j = 0; j < 16; j++) {
+            masked[i][j] = blocks[i][j] ^ mask[i][j];
+        }
+        shares[0][i] = masked[i];
+        shares[1][i] = mask[i];
+    }
+    load_planes(q[0], shares[0]);
+    load_planes(q[1], shares[1]);
+}
+
+
+/*
+ * Stores both shares and recombines them into the blocks pointed to by `blocks`.
+ */
+static void store_masked_planes(bs_word q[2][8], uint8_t *const blocks[BS_BLOCKS]) {
+    uint8_t shares[2][BS_BLOCKS][16];
+    uint8_t *targets[2][BS_BLOCKS];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        targets[0][i] = shares[0][i];
+        targets[1][i] = shares[1][i];
+    }
+    store_planes(q[0], targets[0]);
+    store_planes(q[1], targets[1]);
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        for (int j = 0; j < 16; j++) {
+            blocks[i][j] = shares[0][i][j] ^ shares[1][i][j];
+        }
+    }
+}
+
+
+/*
+ * Adds round key `round` of every block to both shares. Plain round keys are
+ * masked with a fresh mask on load. Round keys that come masked, with their
+ * masks in `key_masks`, are loaded share by share and never recombined.
+ */
+static void add_masked_round_key(
+        bs_word q[2][8],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const uint8_t round
+) {
+    const uint8_t *blocks[BS_BLOCKS];
+    const uint8_t *masks[BS_BLOCKS];
+    bs_word k[2][8];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        blocks[i] = i < block_count ? round_keys[i * key_count + round] : zero_block;
+        masks[i] = i < block_count && key_masks != NULL ? key_masks[i * key_count + round] : zero_block;
+    }
+    if (key_masks == NULL) {
+        load_masked_planes(k, blocks);
+    } else {
+        load_planes(k[0], blocks);
+        load_planes(k[1], masks);
+    }
+    add_round_key_planes(q[0], k[0]);
+    add_round_key_planes(q[1], k[1]);
+}
+
+
+/*
+ * Applies the S-box to both shares with the masked Boyar-Peralta circuit.
+ */
+static void masked_sub_bytes(bs_word q[2][8]) {
+    bs_word gate_mask[SBOX_AND_GATES];
+    const bs_word *rand = gate_mask;
+    bs_word plain_y[22], plain_z[18];
+    MaskedPlane y[22], z[18];
+    MaskedPlane t2, t3, t4, t5, t6, t7, t8, t9;
+    MaskedPlane t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    MaskedPlane t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    MaskedPlane t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    MaskedPlane t40, t41, t42, t43, t44, t45;
+
+    csprng_fill((uint8_t *)gate_mask, sizeof(gate_mask));
+    for (int share = 0; share < 2; share++) {
+        sbox_top_planes(q[share], plain_y);
+        for (int i = 0; i < 22; i++) {
+            y[i][share] = plain_y[i];
+        }
+    }
+
+    /* Non-linear section */
+    masked_and(t2, y[12], y[15], *rand++);
+    masked_and(t3, y[3], y[6], *rand++);
+    masked_xor(t4, t3, t2);
+    masked_and(t5, y[4], y[0], *rand++);
+    masked_xor(t6, t5, t2);
+    masked_and(t7, y[13], y[16], *rand++);
+    masked_and(t8, y[5], y[1], *rand++);
+    masked_xor(t9, t8, t7);
+    masked_and(t10, y[2], y[7], *rand++);
+    masked_xor(t11, t10, t7);
+    masked_and(t12, y[9], y[11], *rand++);
+    masked_and(t13, y[14], y[17], *rand++);
+    masked_xor(t14, t13, t12);
+    masked_and(t15, y[8], y[10], *rand++);
+    masked_xor(t16, t15, t12);
+    masked_xor(t17, t4, t14);
+    masked_xor(t18, t6, t16);
+    masked_xor(t19, t9, t14);
+    masked_xor(t20, t11, t16);
+    masked_xor(t21, t17, y[20]);
+    masked_xor(t22, t18, y[19]);
+    masked_xor(t23, t19, y[21]);
+    masked_xor(t24, t20, y[18]);
+
+    masked_xor(t25, t21, t22);
+    masked_and(t26, t21, t23, *rand++);
+    masked_xor(t27, t24, t26);
+    masked_and(t28, t25, t27, *rand++);
+    masked_xor(t29, t28, t22);
+    masked_xor(t30, t23, t24);
+    masked_xor(t31, t22, t26);
+    masked_and(t32, t31, t30, *rand++);
+    masked_xor(t33, t32, t24);
+    masked_xor(t34, t23, t33);
+    masked_xor(t35, t27, t33);
+    masked_and(t36, t24, t35, *rand++);
+    masked_xor(t37, t36, t34);
+    masked_xor(t38, t27, t36);
+    masked_and(t39, t29, t38, *rand++);
+    masked_xor(t40, t25, t39);
+
+    masked_xor(t41, t40, t37);
+    masked_xor(t42, t29, t33);
+    masked_xor(t43, t29, t40);
+    masked_xor(t44, t33, t37);
+    masked_xor(t45, t42, t41);
+    masked_and(z[0], t44, y[15], *rand++);
+    masked_and(z[1], t37, y[6], *rand++);
+    masked_and(z[2], t33, y[0], *rand++);
+    masked_and(z[3], t43, y[16], *rand++);
+    masked_and(z[4], t40, y[1], *rand++);
+    masked_and(z[5], t29, y[7], *rand++);
+    masked_and(z[6], t42, y[11], *rand++);
+    masked_and(z[7], t45, y[17], *rand++);
+    masked_and(z[8], t41, y[10], *rand++);
+    masked_and(z[9], t44, y[12], *rand++);
+    masked_and(z[10], t37, y[3], *rand++);
+    masked_and(z[11], t33, y[4], *rand++);
+    masked_and(z[12], t43, y[13], *rand++);
+    masked_and(z[13], t40, y[5], *rand++);
+    masked_and(z[14], t29, y[2], *rand++);
+    masked_and(z[15], t42, y[9], *rand++);
+    masked_and(z[16], t45, y[14], *rand++);
+    masked_and(z[17], t41, y[8], *rand++);
+
+    for (int share = 0; share < 2; share++) {
+        for (int i = 0; i < 18; i++) {
+            plain_z[i] = z[i][share];
+        }
+        sbox_bottom_planes(q[share], plain_z, share_not_mask(share));
+    }
+}
+
+
+static void masked_inv_sub_bytes(bs_word q[2][8]) {
+    inv_affine_planes(q[0], share_not_mask(0));
+    inv_affine_planes(q[1], share_not_mask(1));
+    masked_sub_bytes(q);
+    inv_affine_planes(q[0], share_not_mask(0));
+    inv_affine_planes(q[1], share_not_mask(1));
+}
+
+
+static void masked_encrypt_round(bs_word q[2][8], const int mix) {
+    masked_sub_bytes(q);
+    for (int share = 0; share < 2; share++) {
+        shift_rows_planes(q[share]);
+        if (mix) {
+            mix_columns_planes(q[share]);
+        }
+    }
+}
+
+
+static void masked_decrypt_round(bs_word q[2][8], const int mix) {
+    for (int share = 0; share < 2; share++) {
+        if (mix) {
+            inv_mix_columns_planes(q[share]);
+        }
+        inv_shift_rows_planes(q[share]);
+    }
+    masked_inv_sub_bytes(q);
+}
+
+
+static void masked_exchange(bs_word q[2][8], const BS_ExchangeFunc exchange) {
+    exchange(q[0]);
+    exchange(q[1]);
+}
+
+
+/*
+ * Masked version of the bitsliced `encrypt_pass`.
+ */
+static void encrypt_pass(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t spare[BS_BLOCKS][16];
+    const uint8_t *in_blocks[BS_BLOCKS];
+    uint8_t *out_blocks[BS_BLOCKS];
+    bs_word q[2][8];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        in_blocks[i] = i < block_count ? input + i * 16 : zero_block;
+        out_blocks[i] = i < block_count ? output + i * 16 : spare[i];
+    }
+    load_masked_planes(q, in_blocks);
+
+    add_masked_round_key(q, round_keys, key_masks, key_count, block_count, 0);
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        masked_exchange(q, exchange);
+        masked_encrypt_round(q, 1);
+        add_masked_round_key(q, round_keys, key_masks, key_count, block_count, round);
+    }
+    masked_encrypt_round(q, 0);
+    add_masked_round_key(q, round_keys, key_masks, key_count, block_count, n_rounds);
+    masked_exchange(q, exchange);
+
+    store_masked_planes(q, out_blocks);
+}
+
+
+/*
+ * Exactly undoes `encrypt_pass` when given the inverse exchange function.
+ */
+static void decrypt_pass(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t spare[BS_BLOCKS][16];
+    const uint8_t *in_blocks[BS_BLOCKS];
+    uint8_t *out_blocks[BS_BLOCKS];
+    bs_word q[2][8];
+
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        in_blocks[i] = i < block_count ? input + i * 16 : zero_block;
+        out_blocks[i] = i < block_count ? output + i * 16 : spare[i];
+    }
+    load_masked_planes(q, in_blocks);
+
+    masked_exchange(q, exchange);
+    add_masked_round_key(q, round_keys, key_masks, key_count, block_count, n_rounds);
+    masked_decrypt_round(q, 0);
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        add_masked_round_key(q, round_keys, key_masks, key_count, block_count, round);
+        masked_decrypt_round(q, 1);
+        masked_exchange(q, exchange);
+    }
+    add_masked_round_key(q, round_keys, key_masks, key_count, block_count, 0);
+
+    store_masked_planes(q, out_blocks);
+}
+
+
+static void encrypt_blocks(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    for (size_t i = 0; i < block_count; i += BS_BLOCKS) {
+        const size_t n = block_count - i < BS_BLOCKS ? block_count - i : BS_BLOCKS;
+        const uint8_t (*masks)[16] = key_masks != NULL ? &key_masks[i * key_count] : NULL;
+        encrypt_pass(input + i * 16, output + i * 16, &round_keys[i * key_count], masks, key_count, n, exchange);
+    }
+}
+
+
+static void decrypt_blocks(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const BS_ExchangeFunc exchange
+) {
+    for (size_t i = 0; i < block_count; i += BS_BLOCKS) {
+        const size_t n = block_count - i < BS_BLOCKS ? block_count - i : BS_BLOCKS;
+        const uint8_t (*masks)[16] = key_masks != NULL ? &key_masks[i * key_count] : NULL;
+        decrypt_pass(input + i * 16, output + i * 16, &round_keys[i * key_count], masks, key_count, n, exchange);
+    }
+}
+
+
+/**
+ * Encrypts a single 16‐byte block in place, chosen by block_index. The block
+ * stays masked for all rounds, the callback runs at the same points as in
+ * `aes_encrypt_clean`.
+ */
+void aes_encrypt_masked(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    uint8_t spare[BS_BLOCKS][16] = {{0}};
+    uint8_t *blocks[BS_BLOCKS];
+    bs_word q[2][8];
+
+    blocks[0] = data + (size_t)block_index * 16;
+    for (size_t i = 1; i < BS_BLOCKS; i++) {
+        blocks[i] = spare[i];
+    }
+    load_masked_planes(q, (const uint8_t *const *)blocks);
+
+    add_masked_round_key(q, keys, NULL, key_count, 1, 0);
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+        masked_encrypt_round(q, 1);
+        add_masked_round_key(q, keys, NULL, key_count, 1, round);
+    }
+    masked_encrypt_round(q, 0);
+    add_masked_round_key(q, keys, NULL, key_count, 1, n_rounds);
+
+    store_masked_planes(q, blocks);
+}
+
+
+/**
+ * Decrypts a single 16‐byte block in place, chosen by block_index.
+ */
+void aes_decrypt_masked(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t block_index,
+        const AES_YieldCallback callback
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
+    uint8_t spare[BS_BLOCKS][16] = {{0}};
+    uint8_t *blocks[BS_BLOCKS];
+    bs_word q[2][8];
+
+    blocks[0] = data + (size_t)block_index * 16;
+    for (size_t i = 1; i < BS_BLOCKS; i++) {
+        blocks[i] = spare[i];
+    }
+    load_masked_planes(q, (const uint8_t *const *)blocks);
+
+    add_masked_round_key(q, keys, NULL, key_count, 1, n_rounds);
+    masked_decrypt_round(q, 0);
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        add_masked_round_key(q, keys, NULL, key_count, 1, round);
+        masked_decrypt_round(q, 1);
+        callback(
+            data,
+            round_keys,
+            key_count,
+            block_count,
+            block_index + 1
+        );
+    }
+    add_masked_round_key(q, keys, NULL, key_count, 1, 0);
+
+    store_masked_planes(q, blocks);
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`
+ * with masked rounds, BS_BLOCKS blocks per pass. The round keys of group `g` start
+ * at `round_keys[g * 2 * key_count]`.
+ */
+void aes_encrypt_blocks_x2_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, NULL, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, see `aes_encrypt_blocks_x2_masked`.
+ */
+void aes_decrypt_blocks_x2_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, NULL, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`
+ * with masked rounds, BS_BLOCKS blocks per pass. The round keys of group `g` start
+ * at `round_keys[g * 4 * key_count]`.
+ */
+void aes_encrypt_blocks_x4_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, NULL, key_count, group_count * 4, exchange_x4_enc_planes);
+}
+
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, see `aes_encrypt_blocks_x4_masked`.
+ */
+void aes_decrypt_blocks_x4_masked(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, NULL, key_count, group_count * 4, exchange_x4_dec_planes);
+}
+
+
+/*
+ * Same as `aes_encrypt_blocks_x2_masked`, with round keys that are already
+ * masked: round key `i` is round_keys[i] ^ key_masks[i], in the layout of
+ * `blake32_masked_derive_key_shares`, and the two shares stay apart all the way.
+ */
+void aes_encrypt_blocks_x2_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, key_masks, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+void aes_decrypt_blocks_x2_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, key_masks, key_count, group_count * 2, exchange_x2_planes);
+}
+
+
+/*
+ * AES-Blake512 version of `aes_encrypt_blocks_x2_masked_shares`, with the
+ * layout of `blake64_masked_derive_key_shares`.
+ */
+void aes_encrypt_blocks_x4_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    encrypt_blocks(input, output, round_keys, key_masks, key_count, group_count * 4, exchange_x4_enc_planes);
+}
+
+
+void aes_decrypt_blocks_x4_masked_shares(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_masks[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    decrypt_blocks(input, output, round_keys, key_masks, key_count, group_count * 4, exchange_x4_dec_planes);
+}
@@ -10,13 +10,17 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+#include "aes_types.h"
 #include "aes_ops.h"
+#include "aes_exchange.h"
+#include "aes_words.h"
 #include "aes_sbox.h"
 #include "aes_tables.h"
 #include "aes_block.h"
 
 
-static void shift_rows_sub_bytes(uint32_t state[4], const uint8_t b[16]) {
+static void shift_rows_sub_bytes(uint8_t b[16]) {
     const uint32_t t0 = aes_sbox[b[ 0]]
                       | aes_sbox[b[ 5]] <<  8
                       | aes_sbox[b[10]] << 16
@@ -37,14 +41,12 @@ static void shift_rows_sub_bytes(uint32_t state[4], const uint8_t b[16]) {
                       | aes_sbox[b[ 6]] << 16
                       | aes_sbox[b[11]] << 24;
 
-    state[0] = t0;
-    state[1] = t1;
-    state[2] = t2;
-    state[3] = t3;
+    const uint32_t state[4] = {t0, t1, t2, t3};
+    memcpy(b, state, 16);
 }
 
 
-static void inv_shift_rows_inv_sub_bytes(uint32_t state[4], const uint8_t b[16]) {
+static void inv_shift_rows_inv_sub_bytes(uint8_t b[16]) {
     const uint32_t t0 = aes_inv_sbox[b[ 0]]
                       | aes_inv_sbox[b[13]] <<  8
                       | aes_inv_sbox[b[10]] << 16
@@ -65,10 +67,30 @@ static void inv_shift_rows_inv_sub_bytes(uint32_t state[4], const uint8_t b[16])
                       | aes_inv_sbox[b[ 6]] << 16
                       | aes_inv_sbox[b[ 3]] << 24;
 
-    state[0] = t0;
-    state[1] = t1;
-    state[2] = t2;
-    state[3] = t3;
+    const uint32_t state[4] = {t0, t1, t2, t3};
+    memcpy(b, state, 16);
+}
+
+
+static void sub_bytes_shift_rows_mix_columns(uint8_t b[16]) {
+    const uint32_t t0 = AES_TE(0, b[0]) ^ AES_TE(1, b[5]) ^ AES_TE(2, b[10]) ^ AES_TE(3, b[15]);
+    const uint32_t t1 = AES_TE(0, b[4]) ^ AES_TE(1, b[9]) ^ AES_TE(2, b[14]) ^ AES_TE(3, b[3]);
+    const uint32_t t2 = AES_TE(0, b[8]) ^ AES_TE(1, b[13]) ^ AES_TE(2, b[2]) ^ AES_TE(3, b[7]);
+    const uint32_t t3 = AES_TE(0, b[12]) ^ AES_TE(1, b[1]) ^ AES_TE(2, b[6]) ^ AES_TE(3, b[11]);
+
+    const uint32_t state[4] = {t0, t1, t2, t3};
+    memcpy(b, state, 16);
+}
+
+
+static void inv_mix_columns(uint8_t b[16]) {
+    const uint32_t t0 = AES_IMC(0, b[0]) ^ AES_IMC(1, b[1]) ^ AES_IMC(2, b[2]) ^ AES_IMC(3, b[3]);
+    const uint32_t t1 = AES_IMC(0, b[4]) ^ AES_IMC(1, b[5]) ^ AES_IMC(2, b[6]) ^ AES_IMC(3, b[7]);
+    const uint32_t t2 = AES_IMC(0, b[8]) ^ AES_IMC(1, b[9]) ^ AES_IMC(2, b[10]) ^ AES_IMC(3, b[11]);
+    const uint32_t t3 = AES_IMC(0, b[12]) ^ AES_IMC(1, b[13]) ^ AES_IMC(2, b[14]) ^ AES_IMC(3, b[15]);
+
+    const uint32_t state[4] = {t0, t1, t2, t3};
+    memcpy(b, state, 16);
 }
 
 
@@ -80,7 +102,6 @@ void aes_encrypt_optimized(
         const uint8_t block_index,
         const AES_YieldCallback callback
 ) {
-    uint32_t *state = (uint32_t *)(data + block_index * 16);
     uint8_t *b = data + block_index * 16;
 
     const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
@@ -100,20 +121,13 @@ void aes_encrypt_optimized(
         );
 
         // SubBytes -> ShiftRows -> MixColumns
-        const uint32_t t0 = Te0[b[0]] ^ Te1[b[5]] ^ Te2[b[10]] ^ Te3[b[15]];
-        const uint32_t t1 = Te0[b[4]] ^ Te1[b[9]] ^ Te2[b[14]] ^ Te3[b[3]];
-        const uint32_t t2 = Te0[b[8]] ^ Te1[b[13]] ^ Te2[b[2]] ^ Te3[b[7]];
-        const uint32_t t3 = Te0[b[12]] ^ Te1[b[1]] ^ Te2[b[6]] ^ Te3[b[11]];
-        state[0] = t0;
-        state[1] = t1;
-        state[2] = t2;
-        state[3] = t3;
+        sub_bytes_shift_rows_mix_columns(b);
 
         add_round_key(b, keys, round);
     }
 
     // Final round
-    shift_rows_sub_bytes(state, b);
+    shift_rows_sub_bytes(b);
     add_round_key(b, keys, n_rounds);
 }
 
@@ -126,7 +140,6 @@ void aes_decrypt_optimized(
         const uint8_t block_index,
         const AES_YieldCallback callback
 ) {
-    uint32_t *state = (uint32_t *)(data + block_index * 16);
     uint8_t *b = data + block_index * 16;
 
     const uint8_t (*keys)[16] = &round_keys[block_index * key_count];
@@ -134,23 +147,16 @@ void aes_decrypt_optimized(
 
     // First round
     add_round_key(b, keys, n_rounds);
-    inv_shift_rows_inv_sub_bytes(state, b);
+    inv_shift_rows_inv_sub_bytes(b);
 
     // Middle rounds
     for (uint8_t round = n_rounds - 1; round > 0; round--) {
         add_round_key(b, keys, round);
 
         // InvMixColumns
-        const uint32_t t0 = IMC0[b[0]] ^ IMC1[b[1]] ^ IMC2[b[2]] ^ IMC3[b[3]];
-        const uint32_t t1 = IMC0[b[4]] ^ IMC1[b[5]] ^ IMC2[b[6]] ^ IMC3[b[7]];
-        const uint32_t t2 = IMC0[b[8]] ^ IMC1[b[9]] ^ IMC2[b[10]] ^ IMC3[b[11]];
-        const uint32_t t3 = IMC0[b[12]] ^ IMC1[b[13]] ^ IMC2[b[14]] ^ IMC3[b[15]];
-        state[0] = t0;
-        state[1] = t1;
-        state[2] = t2;
-        state[3] = t3;
+        inv_mix_columns(b);
 
-        inv_shift_rows_inv_sub_bytes(state, b);
+        inv_shift_rows_inv_sub_bytes(b);
 
         callback(
             data,
@@ -163,4 +169,511 @@ void aes_decrypt_optimized(
 
     // Final round
     add_round_key(b, keys, 0);
-}
\ No newline at end of file
+}
+
+
+void aes_encrypt_group_optimized(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+    AES_ExchangePlan plan;
+    compile_exchange_pattern(&plan, ex_cols_pattern, block_count);
+
+    // First round
+    for (uint8_t i = 0; i < block_count; i++) {
+        add_round_key(data + i * 16, &round_keys[i * key_count], 0);
+    }
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_planned(data, &plan);
+        for (uint8_t i = 0; i < block_count; i++) {
+            uint8_t *b = data + i * 16;
+            sub_bytes_shift_rows_mix_columns(b);
+            add_round_key(b, &round_keys[i * key_count], round);
+        }
+    }
+
+    // Final round
+    for (uint8_t i = 0; i < block_count; i++) {
+        uint8_t *b = data + i * 16;
+        shift_rows_sub_bytes(b);
+        add_round_key(b, &round_keys[i * key_count], n_rounds);
+    }
+    exchange_planned(data, &plan);
+}
+
+
+void aes_decrypt_group_optimized(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+) {
+    const uint8_t n_rounds = key_count - 1;
+    AES_ExchangePlan plan;
+    compile_exchange_pattern(&plan, ex_cols_pattern, block_count);
+
+    // First round
+    exchange_planned(data, &plan);
+    for (uint8_t i = 0; i < block_count; i++) {
+        uint8_t *b = data + i * 16;
+        add_round_key(b, &round_keys[i * key_count], n_rounds);
+        inv_shift_rows_inv_sub_bytes(b);
+    }
+
+    // Middle rounds
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        for (uint8_t i = 0; i < block_count; i++) {
+            uint8_t *b = data + i * 16;
+            add_round_key(b, &round_keys[i * key_count], round);
+            inv_mix_columns(b);
+            inv_shift_rows_inv_sub_bytes(b);
+        }
+        exchange_planned(data, &plan);
+    }
+
+    // Final round
+    for (uint8_t i = 0; i < block_count; i++) {
+        add_round_key(data + i * 16, &round_keys[i * key_count], 0);
+    }
+}
+
+
+/*
+ * Word-wise rounds of the batched entry points, see aes_words.h.
+ */
+static inline void enc_round_words(uint32_t s[4], const uint8_t key[16]) {
+    const uint32_t t0 = AES_TE(0, B0(s[0])) ^ AES_TE(1, B1(s[1])) ^ AES_TE(2, B2(s[2])) ^ AES_TE(3, B3(s[3]));
+    const uint32_t t1 = AES_TE(0, B0(s[1])) ^ AES_TE(1, B1(s[2])) ^ AES_TE(2, B2(s[3])) ^ AES_TE(3, B3(s[0]));
+    const uint32_t t2 = AES_TE(0, B0(s[2])) ^ AES_TE(1, B1(s[3])) ^ AES_TE(2, B2(s[0])) ^ AES_TE(3, B3(s[1]));
+    const uint32_t t3 = AES_TE(0, B0(s[3])) ^ AES_TE(1, B1(s[0])) ^ AES_TE(2, B2(s[1])) ^ AES_TE(3, B3(s[2]));
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+    xor_key_words(s, key);
+}
+
+
+static inline void enc_final_round_words(uint32_t s[4], const uint8_t key[16]) {
+    const uint32_t t0 = (uint32_t)aes_sbox[B0(s[0])]
+                      | (uint32_t)aes_sbox[B1(s[1])] <<  8
+                      | (uint32_t)aes_sbox[B2(s[2])] << 16
+                      | (uint32_t)aes_sbox[B3(s[3])] << 24;
+    const uint32_t t1 = (uint32_t)aes_sbox[B0(s[1])]
+                      | (uint32_t)aes_sbox[B1(s[2])] <<  8
+                      | (uint32_t)aes_sbox[B2(s[3])] << 16
+                      | (uint32_t)aes_sbox[B3(s[0])] << 24;
+    const uint32_t t2 = (uint32_t)aes_sbox[B0(s[2])]
+                      | (uint32_t)aes_sbox[B1(s[3])] <<  8
+                      | (uint32_t)aes_sbox[B2(s[0])] << 16
+                      | (uint32_t)aes_sbox[B3(s[1])] << 24;
+    const uint32_t t3 = (uint32_t)aes_sbox[B0(s[3])]
+                      | (uint32_t)aes_sbox[B1(s[0])] <<  8
+                      | (uint32_t)aes_sbox[B2(s[1])] << 16
+                      | (uint32_t)aes_sbox[B3(s[2])] << 24;
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+    xor_key_words(s, key);
+}
+
+
+/*
+ * One round of the equivalent inverse cipher without the round key: InvShiftRows,
+ * InvSubBytes and InvMixColumns in one lookup per state byte.
+ */
+static inline void inv_round_words(uint32_t s[4]) {
+    const uint32_t t0 = AES_TD(0, B0(s[0])) ^ AES_TD(1, B1(s[3])) ^ AES_TD(2, B2(s[2])) ^ AES_TD(3, B3(s[1]));
+    const uint32_t t1 = AES_TD(0, B0(s[1])) ^ AES_TD(1, B1(s[0])) ^ AES_TD(2, B2(s[3])) ^ AES_TD(3, B3(s[2]));
+    const uint32_t t2 = AES_TD(0, B0(s[2])) ^ AES_TD(1, B1(s[1])) ^ AES_TD(2, B2(s[0])) ^ AES_TD(3, B3(s[3]));
+    const uint32_t t3 = AES_TD(0, B0(s[3])) ^ AES_TD(1, B1(s[2])) ^ AES_TD(2, B2(s[1])) ^ AES_TD(3, B3(s[0]));
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+/*
+ * XORs InvMixColumns of `key` into the state, the round key of the equivalent
+ * inverse cipher. The key words do not depend on the state, so their lookups run
+ * in parallel with the lookups of the round instead of after them.
+ */
+static inline void xor_inv_mix_key_words(uint32_t s[4], const uint8_t key[16]) {
+    uint32_t k[4];
+    load_words(k, key);
+    s[0] ^= AES_IMC(0, B0(k[0])) ^ AES_IMC(1, B1(k[0])) ^ AES_IMC(2, B2(k[0])) ^ AES_IMC(3, B3(k[0]));
+    s[1] ^= AES_IMC(0, B0(k[1])) ^ AES_IMC(1, B1(k[1])) ^ AES_IMC(2, B2(k[1])) ^ AES_IMC(3, B3(k[1]));
+    s[2] ^= AES_IMC(0, B0(k[2])) ^ AES_IMC(1, B1(k[2])) ^ AES_IMC(2, B2(k[2])) ^ AES_IMC(3, B3(k[2]));
+    s[3] ^= AES_IMC(0, B0(k[3])) ^ AES_IMC(1, B1(k[3])) ^ AES_IMC(2, B2(k[3])) ^ AES_IMC(3, B3(k[3]));
+}
+
+
+/*
+ * Encrypts the two blocks of an AES-Blake256 group from `input` into `output`.
+ * Both blocks run through each round together and their columns are
+ * exchanged between rounds, producing the same output as `aes_encrypt_group_optimized`
+ * with the AES-Blake256 encryption pattern.
+ */
+static inline void encrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s0[4], s1[4];
+    load_words(s0, input);
+    load_words(s1, input + 16);
+
+    // First round
+    xor_key_words(s0, keys0[0]);
+    xor_key_words(s1, keys1[0]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x2(s0, s1);
+        enc_round_words(s0, keys0[round]);
+        enc_round_words(s1, keys1[round]);
+    }
+
+    // Final round
+    enc_final_round_words(s0, keys0[n_rounds]);
+    enc_final_round_words(s1, keys1[n_rounds]);
+    exchange_columns_x2(s0, s1);
+
+    store_words(output, s0);
+    store_words(output + 16, s1);
+}
+
+
+/*
+ * Decrypts the two blocks of an AES-Blake256 group from `input` into `output`,
+ * undoing `encrypt_group_x2`. Uses the equivalent inverse cipher of FIPS-197 5.3.5,
+ * which applies InvMixColumns to the middle round keys instead of the state, so that
+ * a round costs the same table lookups as an encryption round.
+ */
+static inline void decrypt_group_x2(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s0[4], s1[4];
+    load_words(s0, input);
+    load_words(s1, input + 16);
+
+    // First round
+    exchange_columns_x2(s0, s1);
+    xor_key_words(s0, keys0[n_rounds]);
+    xor_key_words(s1, keys1[n_rounds]);
+
+    // Middle rounds, the column exchange commutes with InvMixColumns and moves after it
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        inv_round_words(s0);
+        inv_round_words(s1);
+        if (round + 1 < n_rounds) {
+            exchange_columns_x2(s0, s1);
+        }
+        xor_inv_mix_key_words(s0, keys0[round]);
+        xor_inv_mix_key_words(s1, keys1[round]);
+    }
+
+    // Final round
+    inv_shift_rows_inv_sub_bytes_words(s0);
+    inv_shift_rows_inv_sub_bytes_words(s1);
+    if (n_rounds > 1) {
+        exchange_columns_x2(s0, s1);
+    }
+    xor_key_words(s0, keys0[0]);
+    xor_key_words(s1, keys1[0]);
+
+    store_words(output, s0);
+    store_words(output + 16, s1);
+}
+
+
+/*
+ * Encrypts the four blocks of an AES-Blake512 group from `input` into `output`.
+ * All blocks run through each round together and their columns are
+ * exchanged between rounds, producing the same output as `aes_encrypt_group_optimized`
+ * with the AES-Blake512 encryption pattern.
+ */
+static inline void encrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t (*keys2)[16] = &round_keys[key_count * 2];
+    const uint8_t (*keys3)[16] = &round_keys[key_count * 3];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s[4][4];
+    load_words(s[0], input);
+    load_words(s[1], input + 16);
+    load_words(s[2], input + 32);
+    load_words(s[3], input + 48);
+
+    // First round
+    xor_key_words(s[0], keys0[0]);
+    xor_key_words(s[1], keys1[0]);
+    xor_key_words(s[2], keys2[0]);
+    xor_key_words(s[3], keys3[0]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        exchange_columns_x4(s);
+        enc_round_words(s[0], keys0[round]);
+        enc_round_words(s[1], keys1[round]);
+        enc_round_words(s[2], keys2[round]);
+        enc_round_words(s[3], keys3[round]);
+    }
+
+    // Final round
+    enc_final_round_words(s[0], keys0[n_rounds]);
+    enc_final_round_words(s[1], keys1[n_rounds]);
+    enc_final_round_words(s[2], keys2[n_rounds]);
+    enc_final_round_words(s[3], keys3[n_rounds]);
+    exchange_columns_x4(s);
+
+    store_words(output, s[0]);
+    store_words(output + 16, s[1]);
+    store_words(output + 32, s[2]);
+    store_words(output + 48, s[3]);
+}
+
+
+/*
+ * Decrypts the four blocks of an AES-Blake512 group from `input` into
+ * `output`, undoing `encrypt_group_x4`, see `decrypt_group_x2`.
+ */
+static inline void decrypt_group_x4(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count
+) {
+    const uint8_t (*keys0)[16] = &round_keys[0];
+    const uint8_t (*keys1)[16] = &round_keys[key_count];
+    const uint8_t (*keys2)[16] = &round_keys[key_count * 2];
+    const uint8_t (*keys3)[16] = &round_keys[key_count * 3];
+    const uint8_t n_rounds = key_count - 1;
+
+    uint32_t s[4][4];
+    load_words(s[0], input);
+    load_words(s[1], input + 16);
+    load_words(s[2], input + 32);
+    load_words(s[3], input + 48);
+
+    // First round
+    inv_exchange_columns_x4(s);
+    xor_key_words(s[0], keys0[n_rounds]);
+    xor_key_words(s[1], keys1[n_rounds]);
+    xor_key_words(s[2], keys2[n_rounds]);
+    xor_key_words(s[3], keys3[n_rounds]);
+
+    // Middle rounds, the column exchange commutes with InvMixColumns and moves after it
+    for (uint8_t round = n_rounds - 1; round > 0; round--) {
+        inv_round_words(s[0]);
+        inv_round_words(s[1]);
+        inv_round_words(s[2]);
+        inv_round_words(s[3]);
+        if (round + 1 < n_rounds) {
+            inv_exchange_columns_x4(s);
+        }
+        xor_inv_mix_key_words(s[0], keys0[round]);
+        xor_inv_mix_key_words(s[1], keys1[round]);
+        xor_inv_mix_key_words(s[2], keys2[round]);
+        xor_inv_mix_key_words(s[3], keys3[round]);
+    }
+
+    // Final round
+    inv_shift_rows_inv_sub_bytes_words(s[0]);
+    inv_shift_rows_inv_sub_bytes_words(s[1]);
+    inv_shift_rows_inv_sub_bytes_words(s[2]);
+    inv_shift_rows_inv_sub_bytes_words(s[3]);
+    if (n_rounds > 1) {
+        inv_exchange_columns_x4(s);
+    }
+    xor_key_words(s[0], keys0[0]);
+    xor_key_words(s[1], keys1[0]);
+    xor_key_words(s[2], keys2[0]);
+    xor_key_words(s[3], keys3[0]);
+
+    store_words(output, s[0]);
+    store_words(output + 16, s[1]);
+    store_words(output + 32, s[2]);
+    store_words(output + 48, s[3]);
+}
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`. The round keys of group `g` start at `round_keys[g * 2 * key_count]`.
+ */
+void aes_encrypt_blocks_x2_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        encrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * key_count], key_count);
+    }
+}
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, see `aes_encrypt_blocks_x2_optimized`.
+ */
+void aes_decrypt_blocks_x2_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        decrypt_group_x2(input + g * 32, output + g * 32, &round_keys[g * 2 * key_count], key_count);
+    }
+}
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`. The round keys of group `g` start at `round_keys[g * 4 * key_count]`.
+ */
+void aes_encrypt_blocks_x4_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        encrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * key_count], key_count);
+    }
+}
+
+/*
+ * Decrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`, see `aes_encrypt_blocks_x4_optimized`.
+ */
+void aes_decrypt_blocks_x4_optimized(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    for (size_t g = 0; g < group_count; g++) {
+        decrypt_group_x4(input + g * 64, output + g * 64, &round_keys[g * 4 * key_count], key_count);
+    }
+}
+
+
+/*
+ * Same as `encrypt_group_x2`, but `next_keys` supplies the two round keys of each
+ * round right before it, so only one round of the key schedule exists at a time.
+ */
+void aes_encrypt_group_x2_lazy_optimized(
+        const uint8_t input[32],
+        uint8_t output[32],
+        const uint8_t key_count,
+        const AES_RoundKeysFunc next_keys,
+        void *ctx
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t keys[2][16];
+
+    uint32_t s0[4], s1[4];
+    load_words(s0, input);
+    load_words(s1, input + 16);
+
+    // First round
+    next_keys(ctx, keys);
+    xor_key_words(s0, keys[0]);
+    xor_key_words(s1, keys[1]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        next_keys(ctx, keys);
+        exchange_columns_x2(s0, s1);
+        enc_round_words(s0, keys[0]);
+        enc_round_words(s1, keys[1]);
+    }
+
+    // Final round
+    next_keys(ctx, keys);
+    enc_final_round_words(s0, keys[0]);
+    enc_final_round_words(s1, keys[1]);
+    exchange_columns_x2(s0, s1);
+
+    store_words(output, s0);
+    store_words(output + 16, s1);
+}
+
+
+/*
+ * Same as `encrypt_group_x4`, with the round keys supplied
+ * by `next_keys`, see `aes_encrypt_group_x2_lazy_optimized`.
+ */
+void aes_encrypt_group_x4_lazy_optimized(
+        const uint8_t input[64],
+        uint8_t output[64],
+        const uint8_t key_count,
+        const AES_RoundKeysFunc next_keys,
+        void *ctx
+) {
+    const uint8_t n_rounds = key_count - 1;
+    uint8_t keys[4][16];
+
+    uint32_t s[4][4];
+    load_words(s[0], input);
+    load_words(s[1], input + 16);
+    load_words(s[2], input + 32);
+    load_words(s[3], input + 48);
+
+    // First round
+    next_keys(ctx, keys);
+    xor_key_words(s[0], keys[0]);
+    xor_key_words(s[1], keys[1]);
+    xor_key_words(s[2], keys[2]);
+    xor_key_words(s[3], keys[3]);
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        next_keys(ctx, keys);
+        exchange_columns_x4(s);
+        enc_round_words(s[0], keys[0]);
+        enc_round_words(s[1], keys[1]);
+        enc_round_words(s[2], keys[2]);
+        enc_round_words(s[3], keys[3]);
+    }
+
+    // Final round
+    next_keys(ctx, keys);
+    enc_final_round_words(s[0], keys[0]);
+    enc_final_round_words(s[1], keys[1]);
+    enc_final_round_words(s[2], keys[2]);
+    enc_final_round_words(s[3], keys[3]);
+    exchange_columns_x4(s);
+
+    store_words(output, s[0]);
+    store_words(output + 16, s[1]);
+    store_words(output + 32, s[2]);
+    store_words(output + 48, s[3]);
+}
@@ -0,0 +1,724 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "aes_cpu.h"
+
+#if defined(AES_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "aes_block.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VAES512_TARGET __attribute__((target("aes,vaes,avx2,avx512f")))
+#define VAES256_TARGET __attribute__((target("aes,vaes,avx2")))
+#else
+#define VAES512_TARGET
+#define VAES256_TARGET
+#endif
+
+
+/*
+ * The wide kernels hold the blocks of several consecutive groups in one register. Lane `l`
+ * of vector `v` is block `lanes * v + l` of the batch, so its round keys are found at
+ * `round_keys[(lanes * v + l) * key_count]`, the same layout the single-group kernels use.
+ */
+#define MAX_VECTORS 4
+
+
+/*
+ * Exchange permutations as dword indices: dword `4 * i + c` is column `c` of block `i`.
+ * A 512-bit vector holds two AES-Blake256 groups or one AES-Blake512 group.
+ */
+static const int32_t ex_x2_idx[16] = {
+    0, 5, 2, 7, 4, 1, 6, 3, 8, 13, 10, 15, 12, 9, 14, 11
+};
+
+static const int32_t ex_x4_enc_idx[16] = {
+    0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11
+};
+
+static const int32_t ex_x4_dec_idx[16] = {
+    0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3
+};
+
+
+static inline VAES512_TARGET __m512i load_keys_512(
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t round
+) {
+    __m512i keys = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i *)round_keys[round]));
+    keys = _mm512_inserti32x4(keys, _mm_loadu_si128((const __m128i *)round_keys[key_count + round]), 1);
+    keys = _mm512_inserti32x4(keys, _mm_loadu_si128((const __m128i *)round_keys[key_count * 2 + round]), 2);
+    keys = _mm512_inserti32x4(keys, _mm_loadu_si128((const __m128i *)round_keys[key_count * 3 + round]), 3);
+    return keys;
+}
+
+
+/*
+ * VAES has no wide AESIMC, AESDEC(AESENCLAST(x, 0), 0) computes InvMixColumns(x) instead.
+ */
+static inline VAES512_TARGET __m512i inv_mix_columns_512(const __m512i x) {
+    const __m512i zero = _mm512_setzero_si512();
+    return _mm512_aesdec_epi128(_mm512_aesenclast_epi128(x, zero), zero);
+}
+
+
+/*
+ * Stores the XOR of both halves of a two-group accumulator as one AES-Blake256 checksum.
+ */
+static inline VAES512_TARGET void store_folded_512(uint8_t checksum[32], const __m512i sum) {
+    const __m256i folded = _mm256_xor_si256(_mm512_castsi512_si256(sum), _mm512_extracti64x4_epi64(sum, 1));
+    _mm256_storeu_si256((__m256i *)checksum, folded);
+}
+
+
+/*
+ * A non-NULL `sum` accumulates the plaintext vectors as they are loaded.
+ */
+static AES_ALWAYS_INLINE VAES512_TARGET void encrypt_vectors_512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const int n_vectors,
+        const __m512i ex_idx,
+        __m512i *sum
+) {
+    const uint8_t n_rounds = key_count - 1;
+    __m512i s[MAX_VECTORS];
+
+    // First round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, 0);
+        s[v] = _mm512_loadu_si512(input + v * 64);
+        if (sum != NULL) {
+            *sum = _mm512_xor_si512(*sum, s[v]);
+        }
+        s[v] = _mm512_xor_si512(s[v], keys);
+    }
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        for (int v = 0; v < n_vectors; v++) {
+            const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, round);
+            s[v] = _mm512_aesenc_epi128(_mm512_permutexvar_epi32(ex_idx, s[v]), keys);
+        }
+    }
+
+    // Final round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, n_rounds);
+        s[v] = _mm512_permutexvar_epi32(ex_idx, _mm512_aesenclast_epi128(s[v], keys));
+        _mm512_storeu_si512(output + v * 64, s[v]);
+    }
+}
+
+
+/*
+ * Same round structure as `aes_decrypt_blocks_x2_aesni`, with InvMixColumns
+ * of the round keys computed by `inv_mix_columns_512`. A non-NULL `sum`
+ * accumulates the plaintext vectors before they are stored.
+ */
+static AES_ALWAYS_INLINE VAES512_TARGET void decrypt_vectors_512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const int n_vectors,
+        const __m512i ex_idx,
+        __m512i *sum
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i s[MAX_VECTORS];
+
+    // First round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, n_rounds);
+        s[v] = _mm512_permutexvar_epi32(ex_idx, _mm512_loadu_si512(input + v * 64));
+        s[v] = _mm512_xor_si512(s[v], keys);
+    }
+
+    // Middle rounds
+    if (n_rounds > 1) {
+        for (int v = 0; v < n_vectors; v++) {
+            const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, n_rounds - 1);
+            s[v] = _mm512_aesdec_epi128(s[v], inv_mix_columns_512(keys));
+        }
+    }
+    for (uint8_t round = n_rounds - 1; round > 1; round--) {
+        for (int v = 0; v < n_vectors; v++) {
+            const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, round - 1);
+            s[v] = _mm512_permutexvar_epi32(ex_idx, _mm512_aesdec_epi128(s[v], zero));
+            s[v] = _mm512_xor_si512(s[v], inv_mix_columns_512(keys));
+        }
+    }
+
+    // Final round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m512i keys = load_keys_512(&round_keys[v * 4 * key_count], key_count, 0);
+        s[v] = _mm512_aesdeclast_epi128(s[v], zero);
+        if (n_rounds > 1) {
+            s[v] = _mm512_permutexvar_epi32(ex_idx, s[v]);
+        }
+        s[v] = _mm512_xor_si512(s[v], keys);
+        if (sum != NULL) {
+            *sum = _mm512_xor_si512(*sum, s[v]);
+        }
+        _mm512_storeu_si512(output + v * 64, s[v]);
+    }
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`, two groups per
+ * 512-bit vector and up to four vectors per pass. An odd trailing group is
+ * left to the AES-NI kernel.
+ */
+VAES512_TARGET void aes_encrypt_blocks_x2_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x2_idx);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 8 <= group_count; g += 8) {
+            encrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, ex_idx, NULL);
+        }
+        for (; g + 2 <= group_count; g += 2) {
+            encrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, ex_idx, NULL);
+        }
+        if (g < group_count) {
+            aes_encrypt_blocks_x2_aesni(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1);
+        }
+    );
+}
+
+
+VAES512_TARGET void aes_decrypt_blocks_x2_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x2_idx);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 8 <= group_count; g += 8) {
+            decrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, ex_idx, NULL);
+        }
+        for (; g + 2 <= group_count; g += 2) {
+            decrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, ex_idx, NULL);
+        }
+        if (g < group_count) {
+            aes_decrypt_blocks_x2_aesni(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1);
+        }
+    );
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`,
+ * one group per 512-bit vector and up to four vectors per pass.
+ */
+VAES512_TARGET void aes_encrypt_blocks_x4_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x4_enc_idx);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            encrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, ex_idx, NULL);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 1, ex_idx, NULL);
+        }
+    );
+}
+
+
+VAES512_TARGET void aes_decrypt_blocks_x4_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x4_dec_idx);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            decrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, ex_idx, NULL);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 1, ex_idx, NULL);
+        }
+    );
+}
+
+
+/*
+ * The 256-bit kernels hold two blocks per vector, so an AES-Blake256 group fits one
+ * vector and an AES-Blake512 group spans a pair of vectors. Both exchanges use the
+ * same in-lane dword permutation, the AES-Blake512 one then blends the permuted pair.
+ */
+#define EX_X4_ENC_BLEND 0x6C
+#define EX_X4_DEC_BLEND 0xC6
+
+
+static inline VAES256_TARGET __m256i load_keys_256(
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const uint8_t round
+) {
+    const __m256i keys = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)round_keys[round]));
+    return _mm256_inserti128_si256(keys, _mm_loadu_si128((const __m128i *)round_keys[key_count + round]), 1);
+}
+
+
+static inline VAES256_TARGET __m256i inv_mix_columns_256(const __m256i x) {
+    const __m256i zero = _mm256_setzero_si256();
+    return _mm256_aesdec_epi128(_mm256_aesenclast_epi128(x, zero), zero);
+}
+
+
+/*
+ * Applies the column exchange to `n_vectors` vectors. With `x4` set, each pair of
+ * vectors is one AES-Blake512 group and `blend` selects the columns taken from the
+ * other half of the group, otherwise each vector is an AES-Blake256 group.
+ */
+#define EXCHANGE_256(s, n_vectors, x4, blend)                                   \
+    do {                                                                        \
+        const __m256i ex_idx = _mm256_setr_epi32(0, 5, 2, 7, 4, 1, 6, 3);       \
+        for (int v = 0; v < (n_vectors); v++) {                                 \
+            (s)[v] = _mm256_permutevar8x32_epi32((s)[v], ex_idx);               \
+        }                                                                       \
+        if (x4) {                                                               \
+            for (int v = 0; v < (n_vectors); v += 2) {                          \
+                const __m256i lo = (s)[v];                                      \
+                (s)[v] = _mm256_blend_epi32(lo, (s)[v + 1], (blend));           \
+                (s)[v + 1] = _mm256_blend_epi32((s)[v + 1], lo, (blend));       \
+            }                                                                   \
+        }                                                                       \
+    } while (0)
+
+
+/*
+ * A non-NULL `sum` accumulates the plaintext of the even vectors in `sum[0]` and
+ * of the odd ones in `sum[1]`, so that each half of an AES-Blake512 group keeps
+ * its own accumulator. The decryption kernel does the same with its output.
+ */
+static AES_ALWAYS_INLINE VAES256_TARGET void encrypt_vectors_256(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const int n_vectors,
+        const int x4,
+        __m256i sum[2]
+) {
+    const uint8_t n_rounds = key_count - 1;
+    __m256i s[MAX_VECTORS];
+
+    // First round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, 0);
+        s[v] = _mm256_loadu_si256((const __m256i *)(input + v * 32));
+        if (sum != NULL) {
+            sum[v & 1] = _mm256_xor_si256(sum[v & 1], s[v]);
+        }
+        s[v] = _mm256_xor_si256(s[v], keys);
+    }
+
+    // Middle rounds
+    for (uint8_t round = 1; round < n_rounds; round++) {
+        EXCHANGE_256(s, n_vectors, x4, EX_X4_ENC_BLEND);
+        for (int v = 0; v < n_vectors; v++) {
+            const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, round);
+            s[v] = _mm256_aesenc_epi128(s[v], keys);
+        }
+    }
+
+    // Final round
+    for (int v = 0; v < n_vectors; v++) {
+        const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, n_rounds);
+        s[v] = _mm256_aesenclast_epi128(s[v], keys);
+    }
+    EXCHANGE_256(s, n_vectors, x4, EX_X4_ENC_BLEND);
+    for (int v = 0; v < n_vectors; v++) {
+        _mm256_storeu_si256((__m256i *)(output + v * 32), s[v]);
+    }
+}
+
+
+static AES_ALWAYS_INLINE VAES256_TARGET void decrypt_vectors_256(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const int n_vectors,
+        const int x4,
+        __m256i sum[2]
+) {
+    const uint8_t n_rounds = key_count - 1;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i s[MAX_VECTORS];
+
+    // First round
+    for (int v = 0; v < n_vectors; v++) {
+        s[v] = _mm256_loadu_si256((const __m256i *)(input + v * 32));
+    }
+    EXCHANGE_256(s, n_vectors, x4, EX_X4_DEC_BLEND);
+    for (int v = 0; v < n_vectors; v++) {
+        const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, n_rounds);
+        s[v] = _mm256_xor_si256(s[v], keys);
+    }
+
+    // Middle rounds
+    if (n_rounds > 1) {
+        for (int v = 0; v < n_vectors; v++) {
+            const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, n_rounds - 1);
+            s[v] = _mm256_aesdec_epi128(s[v], inv_mix_columns_256(keys));
+        }
+    }
+    for (uint8_t round = n_rounds - 1; round > 1; round--) {
+        for (int v = 0; v < n_vectors; v++) {
+            s[v] = _mm256_aesdec_epi128(s[v], zero);
+        }
+        EXCHANGE_256(s, n_vectors, x4, EX_X4_DEC_BLEND);
+        for (int v = 0; v < n_vectors; v++) {
+            const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, round - 1);
+            s[v] = _mm256_xor_si256(s[v], inv_mix_columns_256(keys));
+        }
+    }
+
+    // Final round
+    for (int v = 0; v < n_vectors; v++) {
+        s[v] = _mm256_aesdeclast_epi128(s[v], zero);
+    }
+    if (n_rounds > 1) {
+        EXCHANGE_256(s, n_vectors, x4, EX_X4_DEC_BLEND);
+    }
+    for (int v = 0; v < n_vectors; v++) {
+        const __m256i keys = load_keys_256(&round_keys[v * 2 * key_count], key_count, 0);
+        s[v] = _mm256_xor_si256(s[v], keys);
+        if (sum != NULL) {
+            sum[v & 1] = _mm256_xor_si256(sum[v & 1], s[v]);
+        }
+        _mm256_storeu_si256((__m256i *)(output + v * 32), s[v]);
+    }
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake256 groups from `input` into `output`,
+ * one group per 256-bit vector and up to four vectors per pass.
+ */
+VAES256_TARGET void aes_encrypt_blocks_x2_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            encrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, 0, NULL);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, 0, NULL);
+        }
+    );
+}
+
+
+VAES256_TARGET void aes_decrypt_blocks_x2_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            decrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, 0, NULL);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, 0, NULL);
+        }
+    );
+}
+
+
+/*
+ * Encrypts `group_count` consecutive AES-Blake512 groups from `input` into `output`,
+ * one group per pair of 256-bit vectors and up to two groups per pass.
+ */
+VAES256_TARGET void aes_encrypt_blocks_x4_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 2 <= group_count; g += 2) {
+            encrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, 1, NULL);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 2, 1, NULL);
+        }
+    );
+}
+
+
+VAES256_TARGET void aes_decrypt_blocks_x4_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count
+) {
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 2 <= group_count; g += 2) {
+            decrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, 1, NULL);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 2, 1, NULL);
+        }
+    );
+}
+
+/*
+ * Same as `aes_encrypt_blocks_x2_vaes_avx512`, and XORs every plaintext group into
+ * `checksum`. The accumulator holds two groups and its halves are folded at the end.
+ */
+VAES512_TARGET void aes_encrypt_blocks_x2_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x2_idx);
+    const __m256i initial = _mm256_loadu_si256((const __m256i *)checksum);
+    __m512i sum = _mm512_inserti64x4(_mm512_setzero_si512(), initial, 0);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 8 <= group_count; g += 8) {
+            encrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, ex_idx, &sum);
+        }
+        for (; g + 2 <= group_count; g += 2) {
+            encrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, ex_idx, &sum);
+        }
+        store_folded_512(checksum, sum);
+        if (g < group_count) {
+            aes_encrypt_blocks_x2_sum_aesni(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, checksum);
+        }
+    );
+}
+
+
+VAES512_TARGET void aes_decrypt_blocks_x2_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x2_idx);
+    const __m256i initial = _mm256_loadu_si256((const __m256i *)checksum);
+    __m512i sum = _mm512_inserti64x4(_mm512_setzero_si512(), initial, 0);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 8 <= group_count; g += 8) {
+            decrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, ex_idx, &sum);
+        }
+        for (; g + 2 <= group_count; g += 2) {
+            decrypt_vectors_512(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, ex_idx, &sum);
+        }
+        store_folded_512(checksum, sum);
+        if (g < group_count) {
+            aes_decrypt_blocks_x2_sum_aesni(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, checksum);
+        }
+    );
+}
+
+
+/*
+ * Same as `aes_encrypt_blocks_x4_vaes_avx512`, and XORs every plaintext group into `checksum`.
+ */
+VAES512_TARGET void aes_encrypt_blocks_x4_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x4_enc_idx);
+    __m512i sum = _mm512_loadu_si512(checksum);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            encrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, ex_idx, &sum);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 1, ex_idx, &sum);
+        }
+    );
+    _mm512_storeu_si512(checksum, sum);
+}
+
+
+VAES512_TARGET void aes_decrypt_blocks_x4_sum_vaes_avx512(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    const __m512i ex_idx = _mm512_loadu_si512(ex_x4_dec_idx);
+    __m512i sum = _mm512_loadu_si512(checksum);
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            decrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, ex_idx, &sum);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_512(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 1, ex_idx, &sum);
+        }
+    );
+    _mm512_storeu_si512(checksum, sum);
+}
+
+
+/*
+ * Same as `aes_encrypt_blocks_x2_vaes_avx2`, and XORs every plaintext group into
+ * `checksum`. Both accumulators hold whole groups and are folded at the end.
+ */
+VAES256_TARGET void aes_encrypt_blocks_x2_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m256i sum[2] = {_mm256_loadu_si256((const __m256i *)checksum), _mm256_setzero_si256()};
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            encrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, 0, sum);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, 0, sum);
+        }
+    );
+    _mm256_storeu_si256((__m256i *)checksum, _mm256_xor_si256(sum[0], sum[1]));
+}
+
+
+VAES256_TARGET void aes_decrypt_blocks_x2_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m256i sum[2] = {_mm256_loadu_si256((const __m256i *)checksum), _mm256_setzero_si256()};
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 4 <= group_count; g += 4) {
+            decrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 4, 0, sum);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_256(input + g * 32, output + g * 32, &round_keys[g * 2 * kc], kc, 1, 0, sum);
+        }
+    );
+    _mm256_storeu_si256((__m256i *)checksum, _mm256_xor_si256(sum[0], sum[1]));
+}
+
+
+/*
+ * Same as `aes_encrypt_blocks_x4_vaes_avx2`, and XORs every plaintext group into `checksum`.
+ */
+VAES256_TARGET void aes_encrypt_blocks_x4_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m256i sum[2] = {
+        _mm256_loadu_si256((const __m256i *)checksum),
+        _mm256_loadu_si256((const __m256i *)(checksum + 32))
+    };
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 2 <= group_count; g += 2) {
+            encrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, 1, sum);
+        }
+        for (; g < group_count; g++) {
+            encrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 2, 1, sum);
+        }
+    );
+    _mm256_storeu_si256((__m256i *)checksum, sum[0]);
+    _mm256_storeu_si256((__m256i *)(checksum + 32), sum[1]);
+}
+
+
+VAES256_TARGET void aes_decrypt_blocks_x4_sum_vaes_avx2(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t group_count,
+        uint8_t checksum[]
+) {
+    __m256i sum[2] = {
+        _mm256_loadu_si256((const __m256i *)checksum),
+        _mm256_loadu_si256((const __m256i *)(checksum + 32))
+    };
+    AES_SPECIALIZE_KEY_COUNT(key_count, kc,
+        size_t g = 0;
+        for (; g + 2 <= group_count; g += 2) {
+            decrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 4, 1, sum);
+        }
+        for (; g < group_count; g++) {
+            decrypt_vectors_256(input + g * 64, output + g * 64, &round_keys[g * 4 * kc], kc, 2, 1, sum);
+        }
+    );
+    _mm256_storeu_si256((__m256i *)checksum, sum[0]);
+    _mm256_storeu_si256((__m256i *)(checksum + 32), sum[1]);
+}
+
+#endif
@@ -10,6 +10,8 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+#include "aes_ops.h"
 #include "aes_sbox.h"
 
 
@@ -18,86 +20,98 @@
  * to choose between a 32-bit variant (default) and a 64-bit variant.
  *
  * To compile with 64-bit XORs, define AES_USE_64BIT_WORDS (e.g., via -DAES_USE_64BIT_WORDS).
- * Otherwise, the 32-bit version is used by default.
+ * Otherwise, the 32-bit version is used by default. Both variants go through memcpy,
+ * so `state` and the round keys may have any alignment, and compilers merge the
+ * word XORs into a single 128-bit load and XOR where the target has one.
  */
 void add_round_key(uint8_t state[16], const uint8_t round_keys[][16], const uint8_t round) {
     #ifdef AES_USE_64BIT_WORDS
-        uint64_t *s64 = (uint64_t *)state;
-        const uint64_t *rk64 = (const uint64_t *)round_keys[round];
+        uint64_t s64[2], rk64[2];
+        memcpy(s64, state, 16);
+        memcpy(rk64, round_keys[round], 16);
         s64[0] ^= rk64[0];  // XOR bytes [0..7]
         s64[1] ^= rk64[1];  // XOR bytes [8..15]
+        memcpy(state, s64, 16);
     #else
-        uint32_t *s32 = (uint32_t *)state;
-        const uint32_t *rk32 = (const uint32_t *)round_keys[round];
+        uint32_t s32[4], rk32[4];
+        memcpy(s32, state, 16);
+        memcpy(rk32, round_keys[round], 16);
         s32[0] ^= rk32[0];  // XOR bytes [0..3]
         s32[1] ^= rk32[1];  // XOR bytes [4..7]
         s32[2] ^= rk32[2];  // XOR bytes [8..11]
         s32[3] ^= rk32[3];  // XOR bytes [12..15]
+        memcpy(state, s32, 16);
     #endif
 }
 
 
 /*
- * Applies the AES ShiftRows transformation in-place on a 16-byte state.
+ * Applies the AES ShiftRows transformation in-place on a 16-byte state of any alignment.
  */
 void shift_rows(uint8_t state[16]) {
-    uint32_t *ptr = (uint32_t*)state;
-    const uint32_t buf0 = ptr[0];
-    const uint32_t buf1 = ptr[1];
-    const uint32_t buf2 = ptr[2];
-    const uint32_t buf3 = ptr[3];
-
-    ptr[0] = buf0 & 0x000000FF
-           | buf1 & 0x0000FF00
-           | buf2 & 0x00FF0000
-           | buf3 & 0xFF000000;
-
-    ptr[1] = buf1 & 0x000000FF
-           | buf2 & 0x0000FF00
-           | buf3 & 0x00FF0000
-           | buf0 & 0xFF000000;
-
-    ptr[2] = buf2 & 0x000000FF
-           | buf3 & 0x0000FF00
-           | buf0 & 0x00FF0000
-           | buf1 & 0xFF000000;
-
-    ptr[3] = buf3 & 0x000000FF
-           | buf0 & 0x0000FF00
-           | buf1 & 0x00FF0000
-           | buf2 & 0xFF000000;
+    uint32_t words[4];
+    memcpy(words, state, 16);
+    const uint32_t buf0 = words[0];
+    const uint32_t buf1 = words[1];
+    const uint32_t buf2 = words[2];
+    const uint32_t buf3 = words[3];
+
+    words[0] = buf0 & 0x000000FF
+             | buf1 & 0x0000FF00
+             | buf2 & 0x00FF0000
+             | buf3 & 0xFF000000;
+
+    words[1] = buf1 & 0x000000FF
+             | buf2 & 0x0000FF00
+             | buf3 & 0x00FF0000
+             | buf0 & 0xFF000000;
+
+    words[2] = buf2 & 0x000000FF
+             | buf3 & 0x0000FF00
+             | buf0 & 0x00FF0000
+             | buf1 & 0xFF000000;
+
+    words[3] = buf3 & 0x000000FF
+             | buf0 & 0x0000FF00
+             | buf1 & 0x00FF0000
+             | buf2 & 0xFF000000;
+
+    memcpy(state, words, 16);
 }
 
 
 /*
- * Applies the AES InvShiftRows transformation in-place on a 16-byte state.
+ * Applies the AES InvShiftRows transformation in-place on a 16-byte state of any alignment.
  */
 void inv_shift_rows(uint8_t state[16]) {
-    uint32_t *ptr = (uint32_t*)state;
-    const uint32_t buf0 = ptr[0];
-    const uint32_t buf1 = ptr[1];
-    const uint32_t buf2 = ptr[2];
-    const uint32_t buf3 = ptr[3];
-
-    ptr[0] = buf0 & 0x000000FF
-           | buf3 & 0x0000FF00
-           | buf2 & 0x00FF0000
-           | buf1 & 0xFF000000;
-
-    ptr[1] = buf1 & 0x000000FF
-           | buf0 & 0x0000FF00
-           | buf3 & 0x00FF0000
-           | buf2 & 0xFF000000;
-
-    ptr[2] = buf2 & 0x000000FF
-           | buf1 & 0x0000FF00
-           | buf0 & 0x00FF0000
-           | buf3 & 0xFF000000;
-
-    ptr[3] = buf3 & 0x000000FF
-           | buf2 & 0x0000FF00
-           | buf1 & 0x00FF0000
-           | buf0 & 0xFF000000;
+    uint32_t words[4];
+    memcpy(words, state, 16);
+    const uint32_t buf0 = words[0];
+    const uint32_t buf1 = words[1];
+    const uint32_t buf2 = words[2];
+    const uint32_t buf3 = words[3];
+
+    words[0] = buf0 & 0x000000FF
+             | buf3 & 0x0000FF00
+             | buf2 & 0x00FF0000
+             | buf1 & 0xFF000000;
+
+    words[1] = buf1 & 0x000000FF
+             | buf0 & 0x0000FF00
+             | buf3 & 0x00FF0000
+             | buf2 & 0xFF000000;
+
+    words[2] = buf2 & 0x000000FF
+             | buf1 & 0x0000FF00
+             | buf0 & 0x00FF0000
+             | buf3 & 0xFF000000;
+
+    words[3] = buf3 & 0x000000FF
+             | buf2 & 0x0000FF00
+             | buf1 & 0x00FF0000
+             | buf0 & 0xFF000000;
+
+    memcpy(state, words, 16);
 }
 
 
@@ -145,3 +159,29 @@ void inv_sub_bytes(uint8_t state[16]) {
     state[14] = aes_inv_sbox[state[14]];
     state[15] = aes_inv_sbox[state[15]];
 }
+
+
+/*
+ * Exchanges columns between the AES states of a block group in-place.
+ * Column `c` of block `i` is taken from block `pattern[i][c]`, where
+ * the source states are snapshotted before any column is overwritten.
+ * The group must not contain more than AES_GROUP_MAX_BLOCKS blocks.
+ */
+void exchange_columns(
+        uint8_t data[],
+        const uint8_t block_count,
+        const uint8_t pattern[][4]
+) {
+    uint8_t clones[AES_GROUP_MAX_BLOCKS * 16];
+    memcpy(clones, data, (size_t)block_count * 16);
+
+    for (uint8_t i = 0; i < block_count; i++) {
+        for (uint8_t c = 0; c < 4; c++) {
+            memcpy(
+                data + i * 16 + c * 4,
+                clones + pattern[i][c] * 16 + c * 4,
+                4
+            );
+        }
+    }
+}
@@ -21,6 +21,8 @@ extern "C" {
 
     #define XTIME(x) (((x) << 1) ^ ((((x) >> 7) & 1) * 0x1B))
 
+    #define AES_GROUP_MAX_BLOCKS 4
+
     void add_round_key(uint8_t state[16], const uint8_t round_keys[][16], uint8_t round);
 
     void shift_rows(uint8_t state[16]);
@@ -31,6 +33,12 @@ extern "C" {
 
     void inv_sub_bytes(uint8_t state[16]);
 
+    void exchange_columns(
+        uint8_t data[],
+        uint8_t block_count,
+        const uint8_t pattern[][4]
+    );
+
 
 #ifdef __cplusplus
 }
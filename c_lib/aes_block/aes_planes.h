@@ -0,0 +1,438 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#ifndef AES_PLANES_H
+#define AES_PLANES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Bit plane helpers of the constant-time backends. The state of four blocks
+ * is held as eight 64-bit bit planes: plane `i` holds bit `i` of every byte,
+ * and byte (row `r`, column `c`) of block `b` sits at bit position
+ * `16 * r + 4 * c + b`. Every step is a fixed sequence of logic operations,
+ * so there are no secret-dependent table lookups or branches.
+ *
+ * With GCC and Clang a plane is a 2 x 64-bit vector which the compiler maps
+ * onto SSE2 or NEON registers, so a single pass advances eight blocks. All
+ * steps except the non-linear section of the S-box are linear over GF(2),
+ * which lets the masked backend apply them to each of its shares separately.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint64_t bs_word __attribute__((vector_size(16)));
+#define BS_LANES 2
+#else
+typedef uint64_t bs_word;
+#define BS_LANES 1
+#endif
+
+#define BS_BLOCKS (4 * BS_LANES)
+
+
+typedef void (*BS_ExchangeFunc)(bs_word q[8]);
+
+
+static const uint8_t zero_block[16] = {0};
+
+
+static inline bs_word rotr16(const bs_word x) {
+    return (x >> 16) | (x << 48);
+}
+
+
+static inline bs_word rotr32(const bs_word x) {
+    return (x >> 32) | (x << 32);
+}
+
+
+static inline void swap_planes(bs_word *a, bs_word *b, const uint64_t mask, const int shift) {
+    const bs_word t = ((*a >> shift) ^ *b) & mask;
+    *b ^= t;
+    *a ^= t << shift;
+}
+
+
+static inline bs_word transpose_bytes(bs_word x) {
+    bs_word t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+
+/*
+ * Exchanges the word index of the eight planes with the low three bits of the
+ * bit position. Together with `transpose_bytes` this converts between 64
+ * packed bytes and bit planes, both steps are their own inverse.
+ */
+static inline void ortho(bs_word q[8]) {
+    for (int i = 0; i < 8; i += 2) {
+        swap_planes(&q[i], &q[i + 1], 0x5555555555555555ULL, 1);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        swap_planes(&q[i    ], &q[i + 2], 0x3333333333333333ULL, 2);
+        swap_planes(&q[i + 1], &q[i + 3], 0x3333333333333333ULL, 2);
+    }
+    for (int i = 0; i < 4; i++) {
+        swap_planes(&q[i], &q[i + 4], 0x0F0F0F0F0F0F0F0FULL, 4);
+    }
+}
+
+
+static inline uint64_t load64_le(const uint8_t *src) {
+    return (uint64_t)src[0]       | (uint64_t)src[1] << 8
+        | (uint64_t)src[2] << 16 | (uint64_t)src[3] << 24
+        | (uint64_t)src[4] << 32 | (uint64_t)src[5] << 40
+        | (uint64_t)src[6] << 48 | (uint64_t)src[7] << 56;
+}
+
+
+static inline void store64_le(uint8_t *dst, const uint64_t x) {
+    for (int i = 0; i < 8; i++) {
+        dst[i] = (uint8_t)(x >> (8 * i));
+    }
+}
+
+
+/*
+ * Word `2 * b + h` of a lane starts out as half `h` of block `b`, so a byte
+ * index splits into (block, column, row). Swapping the block bits with the
+ * row bits reorders the 64 bytes to (row, column, block), which is the
+ * bitsliced byte order before transposing. This step is its own inverse.
+ */
+static inline void interleave_bytes(bs_word q[8]) {
+    swap_planes(&q[0], &q[2], 0x00FF00FF00FF00FFULL, 8);
+    swap_planes(&q[1], &q[3], 0x00FF00FF00FF00FFULL, 8);
+    swap_planes(&q[4], &q[6], 0x00FF00FF00FF00FFULL, 8);
+    swap_planes(&q[5], &q[7], 0x00FF00FF00FF00FFULL, 8);
+    for (int i = 0; i < 4; i++) {
+        swap_planes(&q[i], &q[i + 4], 0x0000FFFF0000FFFFULL, 16);
+    }
+}
+
+
+/*
+ * Loads the 16-byte blocks pointed to by `blocks` into bit planes.
+ */
+static inline void load_planes(bs_word q[8], const uint8_t *const blocks[BS_BLOCKS]) {
+    uint64_t words[8][BS_LANES];
+
+    for (int lane = 0; lane < BS_LANES; lane++) {
+        for (int k = 0; k < 8; k++) {
+            words[k][lane] = load64_le(blocks[lane * 4 + (k >> 1)] + (k & 1) * 8);
+        }
+    }
+    for (int k = 0; k < 8; k++) {
+        memcpy(&q[k], words[k], sizeof(bs_word));
+    }
+    interleave_bytes(q);
+    ortho(q);
+    for (int k = 0; k < 8; k++) {
+        q[k] = transpose_bytes(q[k]);
+    }
+}
+
+
+/*
+ * Stores bit planes back into the 16-byte blocks pointed to by `blocks`,
+ * exactly undoing `load_planes`.
+ */
+static inline void store_planes(bs_word q[8], uint8_t *const blocks[BS_BLOCKS]) {
+    uint64_t words[8][BS_LANES];
+
+    for (int k = 0; k < 8; k++) {
+        q[k] = transpose_bytes(q[k]);
+    }
+    ortho(q);
+    interleave_bytes(q);
+    for (int k = 0; k < 8; k++) {
+        memcpy(words[k], &q[k], sizeof(bs_word));
+    }
+    for (int lane = 0; lane < BS_LANES; lane++) {
+        for (int k = 0; k < 8; k++) {
+            store64_le(blocks[lane * 4 + (k >> 1)] + (k & 1) * 8, words[k][lane]);
+        }
+    }
+}
+
+
+/*
+ * Top linear layer of the Boyar-Peralta S-box circuit. Writes the inputs of the
+ * non-linear section to y[1..21], and the input bit x7, which the non-linear
+ * section also uses, to y[0].
+ */
+static inline void sbox_top_planes(const bs_word q[8], bs_word y[22]) {
+    const bs_word x0 = q[7];
+    const bs_word x1 = q[6];
+    const bs_word x2 = q[5];
+    const bs_word x3 = q[4];
+    const bs_word x4 = q[3];
+    const bs_word x5 = q[2];
+    const bs_word x6 = q[1];
+    const bs_word x7 = q[0];
+    bs_word t0, t1;
+
+    /* Top linear transformation */
+    y[14] = x3 ^ x5;
+    y[13] = x0 ^ x6;
+    y[9] = x0 ^ x3;
+    y[8] = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y[1] = t0 ^ x7;
+    y[4] = y[1] ^ x3;
+    y[12] = y[13] ^ y[14];
+    y[2] = y[1] ^ x0;
+    y[5] = y[1] ^ x6;
+    y[3] = y[5] ^ y[8];
+    t1 = x4 ^ y[12];
+    y[15] = t1 ^ x5;
+    y[20] = t1 ^ x1;
+    y[6] = y[15] ^ x7;
+    y[10] = y[15] ^ t0;
+    y[11] = y[20] ^ y[9];
+    y[7] = x7 ^ y[11];
+    y[17] = y[10] ^ y[11];
+    y[19] = y[10] ^ y[8];
+    y[16] = t0 ^ y[11];
+    y[21] = y[13] ^ y[16];
+    y[18] = x0 ^ y[16];
+    y[0] = x7;
+}
+
+
+/*
+ * Bottom linear layer of the Boyar-Peralta S-box circuit, from the outputs
+ * z[0..17] of the non-linear section. Its NOT gates are XORs with `not_mask`,
+ * which is all ones for plain planes. Masked planes pass all ones for the first
+ * share only, so that the constant is added to the shared value exactly once.
+ */
+static inline void sbox_bottom_planes(bs_word q[8], const bs_word z[18], const bs_word not_mask) {
+    bs_word t46, t47, t48, t49, t50, t51, t52, t53, t54, t55;
+    bs_word t56, t57, t58, t59, t60, t61, t62, t63, t64, t65;
+    bs_word t66, t67;
+    bs_word s0, s1, s2, s3, s4, s5, s6, s7;
+
+    /* Bottom linear transformation */
+    t46 = z[15] ^ z[16];
+    t47 = z[10] ^ z[11];
+    t48 = z[5] ^ z[13];
+    t49 = z[9] ^ z[10];
+    t50 = z[2] ^ z[12];
+    t51 = z[2] ^ z[5];
+    t52 = z[7] ^ z[8];
+    t53 = z[0] ^ z[3];
+    t54 = z[6] ^ z[7];
+    t55 = z[16] ^ z[17];
+    t56 = z[12] ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z[4] ^ t46;
+    t59 = z[3] ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z[14] ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z[4] ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z[1] ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ t62 ^ not_mask;
+    s7 = t48 ^ t60 ^ not_mask;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ s3 ^ not_mask;
+    s2 = t55 ^ t67 ^ not_mask;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+
+/*
+ * Applies the inverse of the S-box affine transformation, including the
+ * 0x63 constant, to all bit planes. The constant is applied through
+ * `not_mask`, see `sbox_bottom_planes`.
+ */
+static inline void inv_affine_planes(bs_word q[8], const bs_word not_mask) {
+    const bs_word q0 = q[0] ^ not_mask;
+    const bs_word q1 = q[1] ^ not_mask;
+    const bs_word q2 = q[2];
+    const bs_word q3 = q[3];
+    const bs_word q4 = q[4];
+    const bs_word q5 = q[5] ^ not_mask;
+    const bs_word q6 = q[6] ^ not_mask;
+    const bs_word q7 = q[7];
+
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+
+static inline void shift_rows_planes(bs_word q[8]) {
+    for (int i = 0; i < 8; i++) {
+        const bs_word x = q[i];
+        q[i] = (x & 0x000000000000FFFFULL)
+            | ((x & 0x00000000FFF00000ULL) >> 4) | ((x & 0x00000000000F0000ULL) << 12)
+            | ((x & 0x0000FF0000000000ULL) >> 8) | ((x & 0x000000FF00000000ULL) << 8)
+            | ((x & 0xF000000000000000ULL) >> 12) | ((x & 0x0FFF000000000000ULL) << 4);
+    }
+}
+
+
+static inline void inv_shift_rows_planes(bs_word q[8]) {
+    for (int i = 0; i < 8; i++) {
+        const bs_word x = q[i];
+        q[i] = (x & 0x000000000000FFFFULL)
+            | ((x & 0x000000000FFF0000ULL) << 4) | ((x & 0x00000000F0000000ULL) >> 12)
+            | ((x & 0x000000FF00000000ULL) << 8) | ((x & 0x0000FF0000000000ULL) >> 8)
+            | ((x & 0x000F000000000000ULL) << 12) | ((x & 0xFFF0000000000000ULL) >> 4);
+    }
+}
+
+
+/*
+ * Multiplies every byte by x in GF(2^8), modulo the AES polynomial.
+ */
+static inline void xtime_planes(bs_word out[8], const bs_word in[8]) {
+    const bs_word hi = in[7];
+    out[7] = in[6];
+    out[6] = in[5];
+    out[5] = in[4];
+    out[4] = in[3] ^ hi;
+    out[3] = in[2] ^ hi;
+    out[2] = in[1];
+    out[1] = in[0] ^ hi;
+    out[0] = hi;
+}
+
+
+/*
+ * Computes 2 * a[r] ^ 3 * a[r + 1] ^ a[r + 2] ^ a[r + 3] for every row, where
+ * a rotation by 16 bits moves each row one position up within its column.
+ */
+static inline void mix_columns_planes(bs_word q[8]) {
+    bs_word t[8], x[8];
+
+    for (int i = 0; i < 8; i++) {
+        t[i] = q[i] ^ rotr16(q[i]);
+    }
+    xtime_planes(x, t);
+    for (int i = 0; i < 8; i++) {
+        q[i] = x[i] ^ rotr16(q[i]) ^ rotr32(t[i]);
+    }
+}
+
+
+/*
+ * Applies InvMixColumns as a preprocessing step followed by MixColumns,
+ * mirroring `inv_mix_columns` of the clean implementation.
+ */
+static inline void inv_mix_columns_planes(bs_word q[8]) {
+    bs_word u[8], w[8];
+
+    for (int i = 0; i < 8; i++) {
+        u[i] = q[i] ^ rotr32(q[i]);
+    }
+    xtime_planes(w, u);
+    xtime_planes(u, w);
+    for (int i = 0; i < 8; i++) {
+        q[i] ^= u[i];
+    }
+    mix_columns_planes(q);
+}
+
+
+static inline void add_round_key_planes(bs_word q[8], const bs_word k[8]) {
+    for (int i = 0; i < 8; i++) {
+        q[i] ^= k[i];
+    }
+}
+
+
+/*
+ * AES-Blake256 column exchange: blocks 2n and 2n + 1 of every lane form a
+ * group and swap their odd columns, which is its own inverse.
+ */
+static inline void exchange_x2_planes(bs_word q[8]) {
+    for (int i = 0; i < 8; i++) {
+        const bs_word x = q[i];
+        q[i] = (x & 0x0F0F0F0F0F0F0F0FULL)
+            | ((x >> 1) & 0x5050505050505050ULL)
+            | ((x << 1) & 0xA0A0A0A0A0A0A0A0ULL);
+    }
+}
+
+
+/*
+ * AES-Blake512 encryption column exchange: each lane is one group, block `b`
+ * takes column `c` from block `(b + c) % 4`, so the four block bits of
+ * column `c` rotate right by `c`.
+ */
+static inline void exchange_x4_enc_planes(bs_word q[8]) {
+    for (int i = 0; i < 8; i++) {
+        const bs_word x = q[i];
+        q[i] = (x & 0x000F000F000F000FULL)
+            | ((x >> 1) & 0x0070007000700070ULL) | ((x << 3) & 0x0080008000800080ULL)
+            | ((x >> 2) & 0x0300030003000300ULL) | ((x << 2) & 0x0C000C000C000C00ULL)
+            | ((x >> 3) & 0x1000100010001000ULL) | ((x << 1) & 0xE000E000E000E000ULL);
+    }
+}
+
+
+/*
+ * AES-Blake512 decryption column exchange, the inverse of `exchange_x4_enc_planes`.
+ */
+static inline void exchange_x4_dec_planes(bs_word q[8]) {
+    for (int i = 0; i < 8; i++) {
+        const bs_word x = q[i];
+        q[i] = (x & 0x000F000F000F000FULL)
+            | ((x << 1) & 0x00E000E000E000E0ULL) | ((x >> 3) & 0x0010001000100010ULL)
+            | ((x << 2) & 0x0C000C000C000C00ULL) | ((x >> 2) & 0x0300030003000300ULL)
+            | ((x << 3) & 0x8000800080008000ULL) | ((x >> 1) & 0x7000700070007000ULL);
+    }
+}
+
+
+static inline void load_round_keys(
+        bs_word k[8],
+        const uint8_t round_keys[][16],
+        const uint8_t key_count,
+        const size_t block_count,
+        const uint8_t round
+) {
+    const uint8_t *blocks[BS_BLOCKS];
+    for (size_t i = 0; i < BS_BLOCKS; i++) {
+        blocks[i] = i < block_count ? round_keys[i * key_count + round] : zero_block;
+    }
+    load_planes(k, (const uint8_t *const *)blocks);
+}
+
+#endif //AES_PLANES_H
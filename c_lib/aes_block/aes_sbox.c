@@ -9,6 +9,8 @@
  *   SPDX-License-Identifier: Apache-2.0
  */
 
+// Generated by gen/aes_tables_gen.c, do not edit.
+
 #include <stdint.h>
 
 const uint8_t aes_sbox[256] = {
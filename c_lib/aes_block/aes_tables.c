@@ -9,6 +9,8 @@
  *   SPDX-License-Identifier: Apache-2.0
  */
 
+// Generated by gen/aes_tables_gen.c, do not edit. Layout: split.
+
 #include <stdint.h>
 
 // ALL TABLES ARE LITTLE-ENDIAN
@@ -47,6 +49,7 @@ const uint32_t Te0[256] = {
     0x8F8C8C03U, 0xF8A1A159U, 0x80898909U, 0x170D0D1AU, 0xDABFBF65U, 0x31E6E6D7U, 0xC6424284U, 0xB86868D0U,
     0xC3414182U, 0xB0999929U, 0x772D2D5AU, 0x110F0F1EU, 0xCBB0B07BU, 0xFC5454A8U, 0xD6BBBB6DU, 0x3A16162CU,
 };
+
 const uint32_t Te1[256] = {
     0x6363C6A5U, 0x7C7CF884U, 0x7777EE99U, 0x7B7BF68DU, 0xF2F2FF0DU, 0x6B6BD6BDU, 0x6F6FDEB1U, 0xC5C59154U,
     0x30306050U, 0x01010203U, 0x6767CEA9U, 0x2B2B567DU, 0xFEFEE719U, 0xD7D7B562U, 0xABAB4DE6U, 0x7676EC9AU,
@@ -81,6 +84,7 @@ const uint32_t Te1[256] = {
     0x8C8C038FU, 0xA1A159F8U, 0x89890980U, 0x0D0D1A17U, 0xBFBF65DAU, 0xE6E6D731U, 0x424284C6U, 0x6868D0B8U,
     0x414182C3U, 0x999929B0U, 0x2D2D5A77U, 0x0F0F1E11U, 0xB0B07BCBU, 0x5454A8FCU, 0xBBBB6DD6U, 0x16162C3AU,
 };
+
 const uint32_t Te2[256] = {
     0x63C6A563U, 0x7CF8847CU, 0x77EE9977U, 0x7BF68D7BU, 0xF2FF0DF2U, 0x6BD6BD6BU, 0x6FDEB16FU, 0xC59154C5U,
     0x30605030U, 0x01020301U, 0x67CEA967U, 0x2B567D2BU, 0xFEE719FEU, 0xD7B562D7U, 0xAB4DE6ABU, 0x76EC9A76U,
@@ -115,6 +119,7 @@ const uint32_t Te2[256] = {
     0x8C038F8CU, 0xA159F8A1U, 0x89098089U, 0x0D1A170DU, 0xBF65DABFU, 0xE6D731E6U, 0x4284C642U, 0x68D0B868U,
     0x4182C341U, 0x9929B099U, 0x2D5A772DU, 0x0F1E110FU, 0xB07BCBB0U, 0x54A8FC54U, 0xBB6DD6BBU, 0x162C3A16U,
 };
+
 const uint32_t Te3[256] = {
     0xC6A56363U, 0xF8847C7CU, 0xEE997777U, 0xF68D7B7BU, 0xFF0DF2F2U, 0xD6BD6B6BU, 0xDEB16F6FU, 0x9154C5C5U,
     0x60503030U, 0x02030101U, 0xCEA96767U, 0x567D2B2BU, 0xE719FEFEU, 0xB562D7D7U, 0x4DE6ABABU, 0xEC9A7676U,
@@ -185,6 +190,7 @@ const uint32_t IMC0[256] = {
     0xCADC31D7U, 0xC1D138D9U, 0xDCC623CBU, 0xD7CB2AC5U, 0xE6E815EFU, 0xEDE51CE1U, 0xF0F207F3U, 0xFBFF0EFDU,
     0x92B479A7U, 0x99B970A9U, 0x84AE6BBBU, 0x8FA362B5U, 0xBE805D9FU, 0xB58D5491U, 0xA89A4F83U, 0xA397468DU,
 };
+
 const uint32_t IMC1[256] = {
     0x00000000U, 0x0D090E0BU, 0x1A121C16U, 0x171B121DU, 0x3424382CU, 0x392D3627U, 0x2E36243AU, 0x233F2A31U,
     0x68487058U, 0x65417E53U, 0x725A6C4EU, 0x7F536245U, 0x5C6C4874U, 0x5165467FU, 0x467E5462U, 0x4B775A69U,
@@ -219,6 +225,7 @@ const uint32_t IMC1[256] = {
     0xDC31D7CAU, 0xD138D9C1U, 0xC623CBDCU, 0xCB2AC5D7U, 0xE815EFE6U, 0xE51CE1EDU, 0xF207F3F0U, 0xFF0EFDFBU,
     0xB479A792U, 0xB970A999U, 0xAE6BBB84U, 0xA362B58FU, 0x805D9FBEU, 0x8D5491B5U, 0x9A4F83A8U, 0x97468DA3U,
 };
+
 const uint32_t IMC2[256] = {
     0x00000000U, 0x090E0B0DU, 0x121C161AU, 0x1B121D17U, 0x24382C34U, 0x2D362739U, 0x36243A2EU, 0x3F2A3123U,
     0x48705868U, 0x417E5365U, 0x5A6C4E72U, 0x5362457FU, 0x6C48745CU, 0x65467F51U, 0x7E546246U, 0x775A694BU,
@@ -253,6 +260,7 @@ const uint32_t IMC2[256] = {
     0x31D7CADCU, 0x38D9C1D1U, 0x23CBDCC6U, 0x2AC5D7CBU, 0x15EFE6E8U, 0x1CE1EDE5U, 0x07F3F0F2U, 0x0EFDFBFFU,
     0x79A792B4U, 0x70A999B9U, 0x6BBB84AEU, 0x62B58FA3U, 0x5D9FBE80U, 0x5491B58DU, 0x4F83A89AU, 0x468DA397U,
 };
+
 const uint32_t IMC3[256] = {
     0x00000000U, 0x0E0B0D09U, 0x1C161A12U, 0x121D171BU, 0x382C3424U, 0x3627392DU, 0x243A2E36U, 0x2A31233FU,
     0x70586848U, 0x7E536541U, 0x6C4E725AU, 0x62457F53U, 0x48745C6CU, 0x467F5165U, 0x5462467EU, 0x5A694B77U,
@@ -286,4 +294,289 @@ const uint32_t IMC3[256] = {
     0x472264E9U, 0x492969E0U, 0x5B347EFBU, 0x553F73F2U, 0x7F0E50CDU, 0x71055DC4U, 0x63184ADFU, 0x6D1347D6U,
     0xD7CADC31U, 0xD9C1D138U, 0xCBDCC623U, 0xC5D7CB2AU, 0xEFE6E815U, 0xE1EDE51CU, 0xF3F0F207U, 0xFDFBFF0EU,
     0xA792B479U, 0xA999B970U, 0xBB84AE6BU, 0xB58FA362U, 0x9FBE805DU, 0x91B58D54U, 0x83A89A4FU, 0x8DA39746U,
-};
\ No newline at end of file
+};
+
+
+/*
+ * Equivalent inverse cipher tables, Td0[x] = IMC0[aes_inv_sbox[x]], so that one lookup
+ * does InvSubBytes and InvMixColumns of a state byte.
+ */
+const uint32_t Td0[256] = {
+    0x50A7F451U, 0x5365417EU, 0xC3A4171AU, 0x965E273AU, 0xCB6BAB3BU, 0xF1459D1FU, 0xAB58FAACU, 0x9303E34BU,
+    0x55FA3020U, 0xF66D76ADU, 0x9176CC88U, 0x254C02F5U, 0xFCD7E54FU, 0xD7CB2AC5U, 0x80443526U, 0x8FA362B5U,
+    0x495AB1DEU, 0x671BBA25U, 0x980EEA45U, 0xE1C0FE5DU, 0x02752FC3U, 0x12F04C81U, 0xA397468DU, 0xC6F9D36BU,
+    0xE75F8F03U, 0x959C9215U, 0xEB7A6DBFU, 0xDA595295U, 0x2D83BED4U, 0xD3217458U, 0x2969E049U, 0x44C8C98EU,
+    0x6A89C275U, 0x78798EF4U, 0x6B3E5899U, 0xDD71B927U, 0xB64FE1BEU, 0x17AD88F0U, 0x66AC20C9U, 0xB43ACE7DU,
+    0x184ADF63U, 0x82311AE5U, 0x60335197U, 0x457F5362U, 0xE07764B1U, 0x84AE6BBBU, 0x1CA081FEU, 0x942B08F9U,
+    0x58684870U, 0x19FD458FU, 0x876CDE94U, 0xB7F87B52U, 0x23D373ABU, 0xE2024B72U, 0x578F1FE3U, 0x2AAB5566U,
+    0x0728EBB2U, 0x03C2B52FU, 0x9A7BC586U, 0xA50837D3U, 0xF2872830U, 0xB2A5BF23U, 0xBA6A0302U, 0x5C8216EDU,
+    0x2B1CCF8AU, 0x92B479A7U, 0xF0F207F3U, 0xA1E2694EU, 0xCDF4DA65U, 0xD5BE0506U, 0x1F6234D1U, 0x8AFEA6C4U,
+    0x9D532E34U, 0xA055F3A2U, 0x32E18A05U, 0x75EBF6A4U, 0x39EC830BU, 0xAAEF6040U, 0x069F715EU, 0x51106EBDU,
+    0xF98A213EU, 0x3D06DD96U, 0xAE053EDDU, 0x46BDE64DU, 0xB58D5491U, 0x055DC471U, 0x6FD40604U, 0xFF155060U,
+    0x24FB9819U, 0x97E9BDD6U, 0xCC434089U, 0x779ED967U, 0xBD42E8B0U, 0x888B8907U, 0x385B19E7U, 0xDBEEC879U,
+    0x470A7CA1U, 0xE90F427CU, 0xC91E84F8U, 0x00000000U, 0x83868009U, 0x48ED2B32U, 0xAC70111EU, 0x4E725A6CU,
+    0xFBFF0EFDU, 0x5638850FU, 0x1ED5AE3DU, 0x27392D36U, 0x64D90F0AU, 0x21A65C68U, 0xD1545B9BU, 0x3A2E3624U,
+    0xB1670A0CU, 0x0FE75793U, 0xD296EEB4U, 0x9E919B1BU, 0x4FC5C080U, 0xA220DC61U, 0x694B775AU, 0x161A121CU,
+    0x0ABA93E2U, 0xE52AA0C0U, 0x43E0223CU, 0x1D171B12U, 0x0B0D090EU, 0xADC78BF2U, 0xB9A8B62DU, 0xC8A91E14U,
+    0x8519F157U, 0x4C0775AFU, 0xBBDD99EEU, 0xFD607FA3U, 0x9F2601F7U, 0xBCF5725CU, 0xC53B6644U, 0x347EFB5BU,
+    0x7629438BU, 0xDCC623CBU, 0x68FCEDB6U, 0x63F1E4B8U, 0xCADC31D7U, 0x10856342U, 0x40229713U, 0x2011C684U,
+    0x7D244A85U, 0xF83DBBD2U, 0x1132F9AEU, 0x6DA129C7U, 0x4B2F9E1DU, 0xF330B2DCU, 0xEC52860DU, 0xD0E3C177U,
+    0x6C16B32BU, 0x99B970A9U, 0xFA489411U, 0x2264E947U, 0xC48CFCA8U, 0x1A3FF0A0U, 0xD82C7D56U, 0xEF903322U,
+    0xC74E4987U, 0xC1D138D9U, 0xFEA2CA8CU, 0x360BD498U, 0xCF81F5A6U, 0x28DE7AA5U, 0x268EB7DAU, 0xA4BFAD3FU,
+    0xE49D3A2CU, 0x0D927850U, 0x9BCC5F6AU, 0x62467E54U, 0xC2138DF6U, 0xE8B8D890U, 0x5EF7392EU, 0xF5AFC382U,
+    0xBE805D9FU, 0x7C93D069U, 0xA92DD56FU, 0xB31225CFU, 0x3B99ACC8U, 0xA77D1810U, 0x6E639CE8U, 0x7BBB3BDBU,
+    0x097826CDU, 0xF418596EU, 0x01B79AECU, 0xA89A4F83U, 0x656E95E6U, 0x7EE6FFAAU, 0x08CFBC21U, 0xE6E815EFU,
+    0xD99BE7BAU, 0xCE366F4AU, 0xD4099FEAU, 0xD67CB029U, 0xAFB2A431U, 0x31233F2AU, 0x3094A5C6U, 0xC066A235U,
+    0x37BC4E74U, 0xA6CA82FCU, 0xB0D090E0U, 0x15D8A733U, 0x4A9804F1U, 0xF7DAEC41U, 0x0E50CD7FU, 0x2FF69117U,
+    0x8DD64D76U, 0x4DB0EF43U, 0x544DAACCU, 0xDF0496E4U, 0xE3B5D19EU, 0x1B886A4CU, 0xB81F2CC1U, 0x7F516546U,
+    0x04EA5E9DU, 0x5D358C01U, 0x737487FAU, 0x2E410BFBU, 0x5A1D67B3U, 0x52D2DB92U, 0x335610E9U, 0x1347D66DU,
+    0x8C61D79AU, 0x7A0CA137U, 0x8E14F859U, 0x893C13EBU, 0xEE27A9CEU, 0x35C961B7U, 0xEDE51CE1U, 0x3CB1477AU,
+    0x59DFD29CU, 0x3F73F255U, 0x79CE1418U, 0xBF37C773U, 0xEACDF753U, 0x5BAAFD5FU, 0x146F3DDFU, 0x86DB4478U,
+    0x81F3AFCAU, 0x3EC468B9U, 0x2C342438U, 0x5F40A3C2U, 0x72C31D16U, 0x0C25E2BCU, 0x8B493C28U, 0x41950DFFU,
+    0x7101A839U, 0xDEB30C08U, 0x9CE4B4D8U, 0x90C15664U, 0x6184CB7BU, 0x70B632D5U, 0x745C6C48U, 0x4257B8D0U,
+};
+
+const uint32_t Td1[256] = {
+    0xA7F45150U, 0x65417E53U, 0xA4171AC3U, 0x5E273A96U, 0x6BAB3BCBU, 0x459D1FF1U, 0x58FAACABU, 0x03E34B93U,
+    0xFA302055U, 0x6D76ADF6U, 0x76CC8891U, 0x4C02F525U, 0xD7E54FFCU, 0xCB2AC5D7U, 0x44352680U, 0xA362B58FU,
+    0x5AB1DE49U, 0x1BBA2567U, 0x0EEA4598U, 0xC0FE5DE1U, 0x752FC302U, 0xF04C8112U, 0x97468DA3U, 0xF9D36BC6U,
+    0x5F8F03E7U, 0x9C921595U, 0x7A6DBFEBU, 0x595295DAU, 0x83BED42DU, 0x217458D3U, 0x69E04929U, 0xC8C98E44U,
+    0x89C2756AU, 0x798EF478U, 0x3E58996BU, 0x71B927DDU, 0x4FE1BEB6U, 0xAD88F017U, 0xAC20C966U, 0x3ACE7DB4U,
+    0x4ADF6318U, 0x311AE582U, 0x33519760U, 0x7F536245U, 0x7764B1E0U, 0xAE6BBB84U, 0xA081FE1CU, 0x2B08F994U,
+    0x68487058U, 0xFD458F19U, 0x6CDE9487U, 0xF87B52B7U, 0xD373AB23U, 0x024B72E2U, 0x8F1FE357U, 0xAB55662AU,
+    0x28EBB207U, 0xC2B52F03U, 0x7BC5869AU, 0x0837D3A5U, 0x872830F2U, 0xA5BF23B2U, 0x6A0302BAU, 0x8216ED5CU,
+    0x1CCF8A2BU, 0xB479A792U, 0xF207F3F0U, 0xE2694EA1U, 0xF4DA65CDU, 0xBE0506D5U, 0x6234D11FU, 0xFEA6C48AU,
+    0x532E349DU, 0x55F3A2A0U, 0xE18A0532U, 0xEBF6A475U, 0xEC830B39U, 0xEF6040AAU, 0x9F715E06U, 0x106EBD51U,
+    0x8A213EF9U, 0x06DD963DU, 0x053EDDAEU, 0xBDE64D46U, 0x8D5491B5U, 0x5DC47105U, 0xD406046FU, 0x155060FFU,
+    0xFB981924U, 0xE9BDD697U, 0x434089CCU, 0x9ED96777U, 0x42E8B0BDU, 0x8B890788U, 0x5B19E738U, 0xEEC879DBU,
+    0x0A7CA147U, 0x0F427CE9U, 0x1E84F8C9U, 0x00000000U, 0x86800983U, 0xED2B3248U, 0x70111EACU, 0x725A6C4EU,
+    0xFF0EFDFBU, 0x38850F56U, 0xD5AE3D1EU, 0x392D3627U, 0xD90F0A64U, 0xA65C6821U, 0x545B9BD1U, 0x2E36243AU,
+    0x670A0CB1U, 0xE757930FU, 0x96EEB4D2U, 0x919B1B9EU, 0xC5C0804FU, 0x20DC61A2U, 0x4B775A69U, 0x1A121C16U,
+    0xBA93E20AU, 0x2AA0C0E5U, 0xE0223C43U, 0x171B121DU, 0x0D090E0BU, 0xC78BF2ADU, 0xA8B62DB9U, 0xA91E14C8U,
+    0x19F15785U, 0x0775AF4CU, 0xDD99EEBBU, 0x607FA3FDU, 0x2601F79FU, 0xF5725CBCU, 0x3B6644C5U, 0x7EFB5B34U,
+    0x29438B76U, 0xC623CBDCU, 0xFCEDB668U, 0xF1E4B863U, 0xDC31D7CAU, 0x85634210U, 0x22971340U, 0x11C68420U,
+    0x244A857DU, 0x3DBBD2F8U, 0x32F9AE11U, 0xA129C76DU, 0x2F9E1D4BU, 0x30B2DCF3U, 0x52860DECU, 0xE3C177D0U,
+    0x16B32B6CU, 0xB970A999U, 0x489411FAU, 0x64E94722U, 0x8CFCA8C4U, 0x3FF0A01AU, 0x2C7D56D8U, 0x903322EFU,
+    0x4E4987C7U, 0xD138D9C1U, 0xA2CA8CFEU, 0x0BD49836U, 0x81F5A6CFU, 0xDE7AA528U, 0x8EB7DA26U, 0xBFAD3FA4U,
+    0x9D3A2CE4U, 0x9278500DU, 0xCC5F6A9BU, 0x467E5462U, 0x138DF6C2U, 0xB8D890E8U, 0xF7392E5EU, 0xAFC382F5U,
+    0x805D9FBEU, 0x93D0697CU, 0x2DD56FA9U, 0x1225CFB3U, 0x99ACC83BU, 0x7D1810A7U, 0x639CE86EU, 0xBB3BDB7BU,
+    0x7826CD09U, 0x18596EF4U, 0xB79AEC01U, 0x9A4F83A8U, 0x6E95E665U, 0xE6FFAA7EU, 0xCFBC2108U, 0xE815EFE6U,
+    0x9BE7BAD9U, 0x366F4ACEU, 0x099FEAD4U, 0x7CB029D6U, 0xB2A431AFU, 0x233F2A31U, 0x94A5C630U, 0x66A235C0U,
+    0xBC4E7437U, 0xCA82FCA6U, 0xD090E0B0U, 0xD8A73315U, 0x9804F14AU, 0xDAEC41F7U, 0x50CD7F0EU, 0xF691172FU,
+    0xD64D768DU, 0xB0EF434DU, 0x4DAACC54U, 0x0496E4DFU, 0xB5D19EE3U, 0x886A4C1BU, 0x1F2CC1B8U, 0x5165467FU,
+    0xEA5E9D04U, 0x358C015DU, 0x7487FA73U, 0x410BFB2EU, 0x1D67B35AU, 0xD2DB9252U, 0x5610E933U, 0x47D66D13U,
+    0x61D79A8CU, 0x0CA1377AU, 0x14F8598EU, 0x3C13EB89U, 0x27A9CEEEU, 0xC961B735U, 0xE51CE1EDU, 0xB1477A3CU,
+    0xDFD29C59U, 0x73F2553FU, 0xCE141879U, 0x37C773BFU, 0xCDF753EAU, 0xAAFD5F5BU, 0x6F3DDF14U, 0xDB447886U,
+    0xF3AFCA81U, 0xC468B93EU, 0x3424382CU, 0x40A3C25FU, 0xC31D1672U, 0x25E2BC0CU, 0x493C288BU, 0x950DFF41U,
+    0x01A83971U, 0xB30C08DEU, 0xE4B4D89CU, 0xC1566490U, 0x84CB7B61U, 0xB632D570U, 0x5C6C4874U, 0x57B8D042U,
+};
+
+const uint32_t Td2[256] = {
+    0xF45150A7U, 0x417E5365U, 0x171AC3A4U, 0x273A965EU, 0xAB3BCB6BU, 0x9D1FF145U, 0xFAACAB58U, 0xE34B9303U,
+    0x302055FAU, 0x76ADF66DU, 0xCC889176U, 0x02F5254CU, 0xE54FFCD7U, 0x2AC5D7CBU, 0x35268044U, 0x62B58FA3U,
+    0xB1DE495AU, 0xBA25671BU, 0xEA45980EU, 0xFE5DE1C0U, 0x2FC30275U, 0x4C8112F0U, 0x468DA397U, 0xD36BC6F9U,
+    0x8F03E75FU, 0x9215959CU, 0x6DBFEB7AU, 0x5295DA59U, 0xBED42D83U, 0x7458D321U, 0xE0492969U, 0xC98E44C8U,
+    0xC2756A89U, 0x8EF47879U, 0x58996B3EU, 0xB927DD71U, 0xE1BEB64FU, 0x88F017ADU, 0x20C966ACU, 0xCE7DB43AU,
+    0xDF63184AU, 0x1AE58231U, 0x51976033U, 0x5362457FU, 0x64B1E077U, 0x6BBB84AEU, 0x81FE1CA0U, 0x08F9942BU,
+    0x48705868U, 0x458F19FDU, 0xDE94876CU, 0x7B52B7F8U, 0x73AB23D3U, 0x4B72E202U, 0x1FE3578FU, 0x55662AABU,
+    0xEBB20728U, 0xB52F03C2U, 0xC5869A7BU, 0x37D3A508U, 0x2830F287U, 0xBF23B2A5U, 0x0302BA6AU, 0x16ED5C82U,
+    0xCF8A2B1CU, 0x79A792B4U, 0x07F3F0F2U, 0x694EA1E2U, 0xDA65CDF4U, 0x0506D5BEU, 0x34D11F62U, 0xA6C48AFEU,
+    0x2E349D53U, 0xF3A2A055U, 0x8A0532E1U, 0xF6A475EBU, 0x830B39ECU, 0x6040AAEFU, 0x715E069FU, 0x6EBD5110U,
+    0x213EF98AU, 0xDD963D06U, 0x3EDDAE05U, 0xE64D46BDU, 0x5491B58DU, 0xC471055DU, 0x06046FD4U, 0x5060FF15U,
+    0x981924FBU, 0xBDD697E9U, 0x4089CC43U, 0xD967779EU, 0xE8B0BD42U, 0x8907888BU, 0x19E7385BU, 0xC879DBEEU,
+    0x7CA1470AU, 0x427CE90FU, 0x84F8C91EU, 0x00000000U, 0x80098386U, 0x2B3248EDU, 0x111EAC70U, 0x5A6C4E72U,
+    0x0EFDFBFFU, 0x850F5638U, 0xAE3D1ED5U, 0x2D362739U, 0x0F0A64D9U, 0x5C6821A6U, 0x5B9BD154U, 0x36243A2EU,
+    0x0A0CB167U, 0x57930FE7U, 0xEEB4D296U, 0x9B1B9E91U, 0xC0804FC5U, 0xDC61A220U, 0x775A694BU, 0x121C161AU,
+    0x93E20ABAU, 0xA0C0E52AU, 0x223C43E0U, 0x1B121D17U, 0x090E0B0DU, 0x8BF2ADC7U, 0xB62DB9A8U, 0x1E14C8A9U,
+    0xF1578519U, 0x75AF4C07U, 0x99EEBBDDU, 0x7FA3FD60U, 0x01F79F26U, 0x725CBCF5U, 0x6644C53BU, 0xFB5B347EU,
+    0x438B7629U, 0x23CBDCC6U, 0xEDB668FCU, 0xE4B863F1U, 0x31D7CADCU, 0x63421085U, 0x97134022U, 0xC6842011U,
+    0x4A857D24U, 0xBBD2F83DU, 0xF9AE1132U, 0x29C76DA1U, 0x9E1D4B2FU, 0xB2DCF330U, 0x860DEC52U, 0xC177D0E3U,
+    0xB32B6C16U, 0x70A999B9U, 0x9411FA48U, 0xE9472264U, 0xFCA8C48CU, 0xF0A01A3FU, 0x7D56D82CU, 0x3322EF90U,
+    0x4987C74EU, 0x38D9C1D1U, 0xCA8CFEA2U, 0xD498360BU, 0xF5A6CF81U, 0x7AA528DEU, 0xB7DA268EU, 0xAD3FA4BFU,
+    0x3A2CE49DU, 0x78500D92U, 0x5F6A9BCCU, 0x7E546246U, 0x8DF6C213U, 0xD890E8B8U, 0x392E5EF7U, 0xC382F5AFU,
+    0x5D9FBE80U, 0xD0697C93U, 0xD56FA92DU, 0x25CFB312U, 0xACC83B99U, 0x1810A77DU, 0x9CE86E63U, 0x3BDB7BBBU,
+    0x26CD0978U, 0x596EF418U, 0x9AEC01B7U, 0x4F83A89AU, 0x95E6656EU, 0xFFAA7EE6U, 0xBC2108CFU, 0x15EFE6E8U,
+    0xE7BAD99BU, 0x6F4ACE36U, 0x9FEAD409U, 0xB029D67CU, 0xA431AFB2U, 0x3F2A3123U, 0xA5C63094U, 0xA235C066U,
+    0x4E7437BCU, 0x82FCA6CAU, 0x90E0B0D0U, 0xA73315D8U, 0x04F14A98U, 0xEC41F7DAU, 0xCD7F0E50U, 0x91172FF6U,
+    0x4D768DD6U, 0xEF434DB0U, 0xAACC544DU, 0x96E4DF04U, 0xD19EE3B5U, 0x6A4C1B88U, 0x2CC1B81FU, 0x65467F51U,
+    0x5E9D04EAU, 0x8C015D35U, 0x87FA7374U, 0x0BFB2E41U, 0x67B35A1DU, 0xDB9252D2U, 0x10E93356U, 0xD66D1347U,
+    0xD79A8C61U, 0xA1377A0CU, 0xF8598E14U, 0x13EB893CU, 0xA9CEEE27U, 0x61B735C9U, 0x1CE1EDE5U, 0x477A3CB1U,
+    0xD29C59DFU, 0xF2553F73U, 0x141879CEU, 0xC773BF37U, 0xF753EACDU, 0xFD5F5BAAU, 0x3DDF146FU, 0x447886DBU,
+    0xAFCA81F3U, 0x68B93EC4U, 0x24382C34U, 0xA3C25F40U, 0x1D1672C3U, 0xE2BC0C25U, 0x3C288B49U, 0x0DFF4195U,
+    0xA8397101U, 0x0C08DEB3U, 0xB4D89CE4U, 0x566490C1U, 0xCB7B6184U, 0x32D570B6U, 0x6C48745CU, 0xB8D04257U,
+};
+
+const uint32_t Td3[256] = {
+    0x5150A7F4U, 0x7E536541U, 0x1AC3A417U, 0x3A965E27U, 0x3BCB6BABU, 0x1FF1459DU, 0xACAB58FAU, 0x4B9303E3U,
+    0x2055FA30U, 0xADF66D76U, 0x889176CCU, 0xF5254C02U, 0x4FFCD7E5U, 0xC5D7CB2AU, 0x26804435U, 0xB58FA362U,
+    0xDE495AB1U, 0x25671BBAU, 0x45980EEAU, 0x5DE1C0FEU, 0xC302752FU, 0x8112F04CU, 0x8DA39746U, 0x6BC6F9D3U,
+    0x03E75F8FU, 0x15959C92U, 0xBFEB7A6DU, 0x95DA5952U, 0xD42D83BEU, 0x58D32174U, 0x492969E0U, 0x8E44C8C9U,
+    0x756A89C2U, 0xF478798EU, 0x996B3E58U, 0x27DD71B9U, 0xBEB64FE1U, 0xF017AD88U, 0xC966AC20U, 0x7DB43ACEU,
+    0x63184ADFU, 0xE582311AU, 0x97603351U, 0x62457F53U, 0xB1E07764U, 0xBB84AE6BU, 0xFE1CA081U, 0xF9942B08U,
+    0x70586848U, 0x8F19FD45U, 0x94876CDEU, 0x52B7F87BU, 0xAB23D373U, 0x72E2024BU, 0xE3578F1FU, 0x662AAB55U,
+    0xB20728EBU, 0x2F03C2B5U, 0x869A7BC5U, 0xD3A50837U, 0x30F28728U, 0x23B2A5BFU, 0x02BA6A03U, 0xED5C8216U,
+    0x8A2B1CCFU, 0xA792B479U, 0xF3F0F207U, 0x4EA1E269U, 0x65CDF4DAU, 0x06D5BE05U, 0xD11F6234U, 0xC48AFEA6U,
+    0x349D532EU, 0xA2A055F3U, 0x0532E18AU, 0xA475EBF6U, 0x0B39EC83U, 0x40AAEF60U, 0x5E069F71U, 0xBD51106EU,
+    0x3EF98A21U, 0x963D06DDU, 0xDDAE053EU, 0x4D46BDE6U, 0x91B58D54U, 0x71055DC4U, 0x046FD406U, 0x60FF1550U,
+    0x1924FB98U, 0xD697E9BDU, 0x89CC4340U, 0x67779ED9U, 0xB0BD42E8U, 0x07888B89U, 0xE7385B19U, 0x79DBEEC8U,
+    0xA1470A7CU, 0x7CE90F42U, 0xF8C91E84U, 0x00000000U, 0x09838680U, 0x3248ED2BU, 0x1EAC7011U, 0x6C4E725AU,
+    0xFDFBFF0EU, 0x0F563885U, 0x3D1ED5AEU, 0x3627392DU, 0x0A64D90FU, 0x6821A65CU, 0x9BD1545BU, 0x243A2E36U,
+    0x0CB1670AU, 0x930FE757U, 0xB4D296EEU, 0x1B9E919BU, 0x804FC5C0U, 0x61A220DCU, 0x5A694B77U, 0x1C161A12U,
+    0xE20ABA93U, 0xC0E52AA0U, 0x3C43E022U, 0x121D171BU, 0x0E0B0D09U, 0xF2ADC78BU, 0x2DB9A8B6U, 0x14C8A91EU,
+    0x578519F1U, 0xAF4C0775U, 0xEEBBDD99U, 0xA3FD607FU, 0xF79F2601U, 0x5CBCF572U, 0x44C53B66U, 0x5B347EFBU,
+    0x8B762943U, 0xCBDCC623U, 0xB668FCEDU, 0xB863F1E4U, 0xD7CADC31U, 0x42108563U, 0x13402297U, 0x842011C6U,
+    0x857D244AU, 0xD2F83DBBU, 0xAE1132F9U, 0xC76DA129U, 0x1D4B2F9EU, 0xDCF330B2U, 0x0DEC5286U, 0x77D0E3C1U,
+    0x2B6C16B3U, 0xA999B970U, 0x11FA4894U, 0x472264E9U, 0xA8C48CFCU, 0xA01A3FF0U, 0x56D82C7DU, 0x22EF9033U,
+    0x87C74E49U, 0xD9C1D138U, 0x8CFEA2CAU, 0x98360BD4U, 0xA6CF81F5U, 0xA528DE7AU, 0xDA268EB7U, 0x3FA4BFADU,
+    0x2CE49D3AU, 0x500D9278U, 0x6A9BCC5FU, 0x5462467EU, 0xF6C2138DU, 0x90E8B8D8U, 0x2E5EF739U, 0x82F5AFC3U,
+    0x9FBE805DU, 0x697C93D0U, 0x6FA92DD5U, 0xCFB31225U, 0xC83B99ACU, 0x10A77D18U, 0xE86E639CU, 0xDB7BBB3BU,
+    0xCD097826U, 0x6EF41859U, 0xEC01B79AU, 0x83A89A4FU, 0xE6656E95U, 0xAA7EE6FFU, 0x2108CFBCU, 0xEFE6E815U,
+    0xBAD99BE7U, 0x4ACE366FU, 0xEAD4099FU, 0x29D67CB0U, 0x31AFB2A4U, 0x2A31233FU, 0xC63094A5U, 0x35C066A2U,
+    0x7437BC4EU, 0xFCA6CA82U, 0xE0B0D090U, 0x3315D8A7U, 0xF14A9804U, 0x41F7DAECU, 0x7F0E50CDU, 0x172FF691U,
+    0x768DD64DU, 0x434DB0EFU, 0xCC544DAAU, 0xE4DF0496U, 0x9EE3B5D1U, 0x4C1B886AU, 0xC1B81F2CU, 0x467F5165U,
+    0x9D04EA5EU, 0x015D358CU, 0xFA737487U, 0xFB2E410BU, 0xB35A1D67U, 0x9252D2DBU, 0xE9335610U, 0x6D1347D6U,
+    0x9A8C61D7U, 0x377A0CA1U, 0x598E14F8U, 0xEB893C13U, 0xCEEE27A9U, 0xB735C961U, 0xE1EDE51CU, 0x7A3CB147U,
+    0x9C59DFD2U, 0x553F73F2U, 0x1879CE14U, 0x73BF37C7U, 0x53EACDF7U, 0x5F5BAAFDU, 0xDF146F3DU, 0x7886DB44U,
+    0xCA81F3AFU, 0xB93EC468U, 0x382C3424U, 0xC25F40A3U, 0x1672C31DU, 0xBC0C25E2U, 0x288B493CU, 0xFF41950DU,
+    0x397101A8U, 0x08DEB30CU, 0xD89CE4B4U, 0x6490C156U, 0x7B6184CBU, 0xD570B632U, 0x48745C6CU, 0xD04257B8U,
+};
+
+
+/*
+ * Te0 and Td0 with every word stored twice, for the compact backend. Reading four bytes
+ * at offset 0, 3, 2 or 1 of an entry yields the word rotated like Te0..Te3 (Td0..Td3),
+ * and the eight-byte entries keep every such read inside one cache line.
+ */
+const uint64_t Te0_x2[256] = {
+    0xA56363C6A56363C6ULL, 0x847C7CF8847C7CF8ULL, 0x997777EE997777EEULL, 0x8D7B7BF68D7B7BF6ULL,
+    0x0DF2F2FF0DF2F2FFULL, 0xBD6B6BD6BD6B6BD6ULL, 0xB16F6FDEB16F6FDEULL, 0x54C5C59154C5C591ULL,
+    0x5030306050303060ULL, 0x0301010203010102ULL, 0xA96767CEA96767CEULL, 0x7D2B2B567D2B2B56ULL,
+    0x19FEFEE719FEFEE7ULL, 0x62D7D7B562D7D7B5ULL, 0xE6ABAB4DE6ABAB4DULL, 0x9A7676EC9A7676ECULL,
+    0x45CACA8F45CACA8FULL, 0x9D82821F9D82821FULL, 0x40C9C98940C9C989ULL, 0x877D7DFA877D7DFAULL,
+    0x15FAFAEF15FAFAEFULL, 0xEB5959B2EB5959B2ULL, 0xC947478EC947478EULL, 0x0BF0F0FB0BF0F0FBULL,
+    0xECADAD41ECADAD41ULL, 0x67D4D4B367D4D4B3ULL, 0xFDA2A25FFDA2A25FULL, 0xEAAFAF45EAAFAF45ULL,
+    0xBF9C9C23BF9C9C23ULL, 0xF7A4A453F7A4A453ULL, 0x967272E4967272E4ULL, 0x5BC0C09B5BC0C09BULL,
+    0xC2B7B775C2B7B775ULL, 0x1CFDFDE11CFDFDE1ULL, 0xAE93933DAE93933DULL, 0x6A26264C6A26264CULL,
+    0x5A36366C5A36366CULL, 0x413F3F7E413F3F7EULL, 0x02F7F7F502F7F7F5ULL, 0x4FCCCC834FCCCC83ULL,
+    0x5C3434685C343468ULL, 0xF4A5A551F4A5A551ULL, 0x34E5E5D134E5E5D1ULL, 0x08F1F1F908F1F1F9ULL,
+    0x937171E2937171E2ULL, 0x73D8D8AB73D8D8ABULL, 0x5331316253313162ULL, 0x3F15152A3F15152AULL,
+    0x0C0404080C040408ULL, 0x52C7C79552C7C795ULL, 0x6523234665232346ULL, 0x5EC3C39D5EC3C39DULL,
+    0x2818183028181830ULL, 0xA1969637A1969637ULL, 0x0F05050A0F05050AULL, 0xB59A9A2FB59A9A2FULL,
+    0x0907070E0907070EULL, 0x3612122436121224ULL, 0x9B80801B9B80801BULL, 0x3DE2E2DF3DE2E2DFULL,
+    0x26EBEBCD26EBEBCDULL, 0x6927274E6927274EULL, 0xCDB2B27FCDB2B27FULL, 0x9F7575EA9F7575EAULL,
+    0x1B0909121B090912ULL, 0x9E83831D9E83831DULL, 0x742C2C58742C2C58ULL, 0x2E1A1A342E1A1A34ULL,
+    0x2D1B1B362D1B1B36ULL, 0xB26E6EDCB26E6EDCULL, 0xEE5A5AB4EE5A5AB4ULL, 0xFBA0A05BFBA0A05BULL,
+    0xF65252A4F65252A4ULL, 0x4D3B3B764D3B3B76ULL, 0x61D6D6B761D6D6B7ULL, 0xCEB3B37DCEB3B37DULL,
+    0x7B2929527B292952ULL, 0x3EE3E3DD3EE3E3DDULL, 0x712F2F5E712F2F5EULL, 0x9784841397848413ULL,
+    0xF55353A6F55353A6ULL, 0x68D1D1B968D1D1B9ULL, 0x0000000000000000ULL, 0x2CEDEDC12CEDEDC1ULL,
+    0x6020204060202040ULL, 0x1FFCFCE31FFCFCE3ULL, 0xC8B1B179C8B1B179ULL, 0xED5B5BB6ED5B5BB6ULL,
+    0xBE6A6AD4BE6A6AD4ULL, 0x46CBCB8D46CBCB8DULL, 0xD9BEBE67D9BEBE67ULL, 0x4B3939724B393972ULL,
+    0xDE4A4A94DE4A4A94ULL, 0xD44C4C98D44C4C98ULL, 0xE85858B0E85858B0ULL, 0x4ACFCF854ACFCF85ULL,
+    0x6BD0D0BB6BD0D0BBULL, 0x2AEFEFC52AEFEFC5ULL, 0xE5AAAA4FE5AAAA4FULL, 0x16FBFBED16FBFBEDULL,
+    0xC5434386C5434386ULL, 0xD74D4D9AD74D4D9AULL, 0x5533336655333366ULL, 0x9485851194858511ULL,
+    0xCF45458ACF45458AULL, 0x10F9F9E910F9F9E9ULL, 0x0602020406020204ULL, 0x817F7FFE817F7FFEULL,
+    0xF05050A0F05050A0ULL, 0x443C3C78443C3C78ULL, 0xBA9F9F25BA9F9F25ULL, 0xE3A8A84BE3A8A84BULL,
+    0xF35151A2F35151A2ULL, 0xFEA3A35DFEA3A35DULL, 0xC0404080C0404080ULL, 0x8A8F8F058A8F8F05ULL,
+    0xAD92923FAD92923FULL, 0xBC9D9D21BC9D9D21ULL, 0x4838387048383870ULL, 0x04F5F5F104F5F5F1ULL,
+    0xDFBCBC63DFBCBC63ULL, 0xC1B6B677C1B6B677ULL, 0x75DADAAF75DADAAFULL, 0x6321214263212142ULL,
+    0x3010102030101020ULL, 0x1AFFFFE51AFFFFE5ULL, 0x0EF3F3FD0EF3F3FDULL, 0x6DD2D2BF6DD2D2BFULL,
+    0x4CCDCD814CCDCD81ULL, 0x140C0C18140C0C18ULL, 0x3513132635131326ULL, 0x2FECECC32FECECC3ULL,
+    0xE15F5FBEE15F5FBEULL, 0xA2979735A2979735ULL, 0xCC444488CC444488ULL, 0x3917172E3917172EULL,
+    0x57C4C49357C4C493ULL, 0xF2A7A755F2A7A755ULL, 0x827E7EFC827E7EFCULL, 0x473D3D7A473D3D7AULL,
+    0xAC6464C8AC6464C8ULL, 0xE75D5DBAE75D5DBAULL, 0x2B1919322B191932ULL, 0x957373E6957373E6ULL,
+    0xA06060C0A06060C0ULL, 0x9881811998818119ULL, 0xD14F4F9ED14F4F9EULL, 0x7FDCDCA37FDCDCA3ULL,
+    0x6622224466222244ULL, 0x7E2A2A547E2A2A54ULL, 0xAB90903BAB90903BULL, 0x8388880B8388880BULL,
+    0xCA46468CCA46468CULL, 0x29EEEEC729EEEEC7ULL, 0xD3B8B86BD3B8B86BULL, 0x3C1414283C141428ULL,
+    0x79DEDEA779DEDEA7ULL, 0xE25E5EBCE25E5EBCULL, 0x1D0B0B161D0B0B16ULL, 0x76DBDBAD76DBDBADULL,
+    0x3BE0E0DB3BE0E0DBULL, 0x5632326456323264ULL, 0x4E3A3A744E3A3A74ULL, 0x1E0A0A141E0A0A14ULL,
+    0xDB494992DB494992ULL, 0x0A06060C0A06060CULL, 0x6C2424486C242448ULL, 0xE45C5CB8E45C5CB8ULL,
+    0x5DC2C29F5DC2C29FULL, 0x6ED3D3BD6ED3D3BDULL, 0xEFACAC43EFACAC43ULL, 0xA66262C4A66262C4ULL,
+    0xA8919139A8919139ULL, 0xA4959531A4959531ULL, 0x37E4E4D337E4E4D3ULL, 0x8B7979F28B7979F2ULL,
+    0x32E7E7D532E7E7D5ULL, 0x43C8C88B43C8C88BULL, 0x5937376E5937376EULL, 0xB76D6DDAB76D6DDAULL,
+    0x8C8D8D018C8D8D01ULL, 0x64D5D5B164D5D5B1ULL, 0xD24E4E9CD24E4E9CULL, 0xE0A9A949E0A9A949ULL,
+    0xB46C6CD8B46C6CD8ULL, 0xFA5656ACFA5656ACULL, 0x07F4F4F307F4F4F3ULL, 0x25EAEACF25EAEACFULL,
+    0xAF6565CAAF6565CAULL, 0x8E7A7AF48E7A7AF4ULL, 0xE9AEAE47E9AEAE47ULL, 0x1808081018080810ULL,
+    0xD5BABA6FD5BABA6FULL, 0x887878F0887878F0ULL, 0x6F25254A6F25254AULL, 0x722E2E5C722E2E5CULL,
+    0x241C1C38241C1C38ULL, 0xF1A6A657F1A6A657ULL, 0xC7B4B473C7B4B473ULL, 0x51C6C69751C6C697ULL,
+    0x23E8E8CB23E8E8CBULL, 0x7CDDDDA17CDDDDA1ULL, 0x9C7474E89C7474E8ULL, 0x211F1F3E211F1F3EULL,
+    0xDD4B4B96DD4B4B96ULL, 0xDCBDBD61DCBDBD61ULL, 0x868B8B0D868B8B0DULL, 0x858A8A0F858A8A0FULL,
+    0x907070E0907070E0ULL, 0x423E3E7C423E3E7CULL, 0xC4B5B571C4B5B571ULL, 0xAA6666CCAA6666CCULL,
+    0xD8484890D8484890ULL, 0x0503030605030306ULL, 0x01F6F6F701F6F6F7ULL, 0x120E0E1C120E0E1CULL,
+    0xA36161C2A36161C2ULL, 0x5F35356A5F35356AULL, 0xF95757AEF95757AEULL, 0xD0B9B969D0B9B969ULL,
+    0x9186861791868617ULL, 0x58C1C19958C1C199ULL, 0x271D1D3A271D1D3AULL, 0xB99E9E27B99E9E27ULL,
+    0x38E1E1D938E1E1D9ULL, 0x13F8F8EB13F8F8EBULL, 0xB398982BB398982BULL, 0x3311112233111122ULL,
+    0xBB6969D2BB6969D2ULL, 0x70D9D9A970D9D9A9ULL, 0x898E8E07898E8E07ULL, 0xA7949433A7949433ULL,
+    0xB69B9B2DB69B9B2DULL, 0x221E1E3C221E1E3CULL, 0x9287871592878715ULL, 0x20E9E9C920E9E9C9ULL,
+    0x49CECE8749CECE87ULL, 0xFF5555AAFF5555AAULL, 0x7828285078282850ULL, 0x7ADFDFA57ADFDFA5ULL,
+    0x8F8C8C038F8C8C03ULL, 0xF8A1A159F8A1A159ULL, 0x8089890980898909ULL, 0x170D0D1A170D0D1AULL,
+    0xDABFBF65DABFBF65ULL, 0x31E6E6D731E6E6D7ULL, 0xC6424284C6424284ULL, 0xB86868D0B86868D0ULL,
+    0xC3414182C3414182ULL, 0xB0999929B0999929ULL, 0x772D2D5A772D2D5AULL, 0x110F0F1E110F0F1EULL,
+    0xCBB0B07BCBB0B07BULL, 0xFC5454A8FC5454A8ULL, 0xD6BBBB6DD6BBBB6DULL, 0x3A16162C3A16162CULL,
+};
+
+const uint64_t Td0_x2[256] = {
+    0x50A7F45150A7F451ULL, 0x5365417E5365417EULL, 0xC3A4171AC3A4171AULL, 0x965E273A965E273AULL,
+    0xCB6BAB3BCB6BAB3BULL, 0xF1459D1FF1459D1FULL, 0xAB58FAACAB58FAACULL, 0x9303E34B9303E34BULL,
+    0x55FA302055FA3020ULL, 0xF66D76ADF66D76ADULL, 0x9176CC889176CC88ULL, 0x254C02F5254C02F5ULL,
+    0xFCD7E54FFCD7E54FULL, 0xD7CB2AC5D7CB2AC5ULL, 0x8044352680443526ULL, 0x8FA362B58FA362B5ULL,
+    0x495AB1DE495AB1DEULL, 0x671BBA25671BBA25ULL, 0x980EEA45980EEA45ULL, 0xE1C0FE5DE1C0FE5DULL,
+    0x02752FC302752FC3ULL, 0x12F04C8112F04C81ULL, 0xA397468DA397468DULL, 0xC6F9D36BC6F9D36BULL,
+    0xE75F8F03E75F8F03ULL, 0x959C9215959C9215ULL, 0xEB7A6DBFEB7A6DBFULL, 0xDA595295DA595295ULL,
+    0x2D83BED42D83BED4ULL, 0xD3217458D3217458ULL, 0x2969E0492969E049ULL, 0x44C8C98E44C8C98EULL,
+    0x6A89C2756A89C275ULL, 0x78798EF478798EF4ULL, 0x6B3E58996B3E5899ULL, 0xDD71B927DD71B927ULL,
+    0xB64FE1BEB64FE1BEULL, 0x17AD88F017AD88F0ULL, 0x66AC20C966AC20C9ULL, 0xB43ACE7DB43ACE7DULL,
+    0x184ADF63184ADF63ULL, 0x82311AE582311AE5ULL, 0x6033519760335197ULL, 0x457F5362457F5362ULL,
+    0xE07764B1E07764B1ULL, 0x84AE6BBB84AE6BBBULL, 0x1CA081FE1CA081FEULL, 0x942B08F9942B08F9ULL,
+    0x5868487058684870ULL, 0x19FD458F19FD458FULL, 0x876CDE94876CDE94ULL, 0xB7F87B52B7F87B52ULL,
+    0x23D373AB23D373ABULL, 0xE2024B72E2024B72ULL, 0x578F1FE3578F1FE3ULL, 0x2AAB55662AAB5566ULL,
+    0x0728EBB20728EBB2ULL, 0x03C2B52F03C2B52FULL, 0x9A7BC5869A7BC586ULL, 0xA50837D3A50837D3ULL,
+    0xF2872830F2872830ULL, 0xB2A5BF23B2A5BF23ULL, 0xBA6A0302BA6A0302ULL, 0x5C8216ED5C8216EDULL,
+    0x2B1CCF8A2B1CCF8AULL, 0x92B479A792B479A7ULL, 0xF0F207F3F0F207F3ULL, 0xA1E2694EA1E2694EULL,
+    0xCDF4DA65CDF4DA65ULL, 0xD5BE0506D5BE0506ULL, 0x1F6234D11F6234D1ULL, 0x8AFEA6C48AFEA6C4ULL,
+    0x9D532E349D532E34ULL, 0xA055F3A2A055F3A2ULL, 0x32E18A0532E18A05ULL, 0x75EBF6A475EBF6A4ULL,
+    0x39EC830B39EC830BULL, 0xAAEF6040AAEF6040ULL, 0x069F715E069F715EULL, 0x51106EBD51106EBDULL,
+    0xF98A213EF98A213EULL, 0x3D06DD963D06DD96ULL, 0xAE053EDDAE053EDDULL, 0x46BDE64D46BDE64DULL,
+    0xB58D5491B58D5491ULL, 0x055DC471055DC471ULL, 0x6FD406046FD40604ULL, 0xFF155060FF155060ULL,
+    0x24FB981924FB9819ULL, 0x97E9BDD697E9BDD6ULL, 0xCC434089CC434089ULL, 0x779ED967779ED967ULL,
+    0xBD42E8B0BD42E8B0ULL, 0x888B8907888B8907ULL, 0x385B19E7385B19E7ULL, 0xDBEEC879DBEEC879ULL,
+    0x470A7CA1470A7CA1ULL, 0xE90F427CE90F427CULL, 0xC91E84F8C91E84F8ULL, 0x0000000000000000ULL,
+    0x8386800983868009ULL, 0x48ED2B3248ED2B32ULL, 0xAC70111EAC70111EULL, 0x4E725A6C4E725A6CULL,
+    0xFBFF0EFDFBFF0EFDULL, 0x5638850F5638850FULL, 0x1ED5AE3D1ED5AE3DULL, 0x27392D3627392D36ULL,
+    0x64D90F0A64D90F0AULL, 0x21A65C6821A65C68ULL, 0xD1545B9BD1545B9BULL, 0x3A2E36243A2E3624ULL,
+    0xB1670A0CB1670A0CULL, 0x0FE757930FE75793ULL, 0xD296EEB4D296EEB4ULL, 0x9E919B1B9E919B1BULL,
+    0x4FC5C0804FC5C080ULL, 0xA220DC61A220DC61ULL, 0x694B775A694B775AULL, 0x161A121C161A121CULL,
+    0x0ABA93E20ABA93E2ULL, 0xE52AA0C0E52AA0C0ULL, 0x43E0223C43E0223CULL, 0x1D171B121D171B12ULL,
+    0x0B0D090E0B0D090EULL, 0xADC78BF2ADC78BF2ULL, 0xB9A8B62DB9A8B62DULL, 0xC8A91E14C8A91E14ULL,
+    0x8519F1578519F157ULL, 0x4C0775AF4C0775AFULL, 0xBBDD99EEBBDD99EEULL, 0xFD607FA3FD607FA3ULL,
+    0x9F2601F79F2601F7ULL, 0xBCF5725CBCF5725CULL, 0xC53B6644C53B6644ULL, 0x347EFB5B347EFB5BULL,
+    0x7629438B7629438BULL, 0xDCC623CBDCC623CBULL, 0x68FCEDB668FCEDB6ULL, 0x63F1E4B863F1E4B8ULL,
+    0xCADC31D7CADC31D7ULL, 0x1085634210856342ULL, 0x4022971340229713ULL, 0x2011C6842011C684ULL,
+    0x7D244A857D244A85ULL, 0xF83DBBD2F83DBBD2ULL, 0x1132F9AE1132F9AEULL, 0x6DA129C76DA129C7ULL,
+    0x4B2F9E1D4B2F9E1DULL, 0xF330B2DCF330B2DCULL, 0xEC52860DEC52860DULL, 0xD0E3C177D0E3C177ULL,
+    0x6C16B32B6C16B32BULL, 0x99B970A999B970A9ULL, 0xFA489411FA489411ULL, 0x2264E9472264E947ULL,
+    0xC48CFCA8C48CFCA8ULL, 0x1A3FF0A01A3FF0A0ULL, 0xD82C7D56D82C7D56ULL, 0xEF903322EF903322ULL,
+    0xC74E4987C74E4987ULL, 0xC1D138D9C1D138D9ULL, 0xFEA2CA8CFEA2CA8CULL, 0x360BD498360BD498ULL,
+    0xCF81F5A6CF81F5A6ULL, 0x28DE7AA528DE7AA5ULL, 0x268EB7DA268EB7DAULL, 0xA4BFAD3FA4BFAD3FULL,
+    0xE49D3A2CE49D3A2CULL, 0x0D9278500D927850ULL, 0x9BCC5F6A9BCC5F6AULL, 0x62467E5462467E54ULL,
+    0xC2138DF6C2138DF6ULL, 0xE8B8D890E8B8D890ULL, 0x5EF7392E5EF7392EULL, 0xF5AFC382F5AFC382ULL,
+    0xBE805D9FBE805D9FULL, 0x7C93D0697C93D069ULL, 0xA92DD56FA92DD56FULL, 0xB31225CFB31225CFULL,
+    0x3B99ACC83B99ACC8ULL, 0xA77D1810A77D1810ULL, 0x6E639CE86E639CE8ULL, 0x7BBB3BDB7BBB3BDBULL,
+    0x097826CD097826CDULL, 0xF418596EF418596EULL, 0x01B79AEC01B79AECULL, 0xA89A4F83A89A4F83ULL,
+    0x656E95E6656E95E6ULL, 0x7EE6FFAA7EE6FFAAULL, 0x08CFBC2108CFBC21ULL, 0xE6E815EFE6E815EFULL,
+    0xD99BE7BAD99BE7BAULL, 0xCE366F4ACE366F4AULL, 0xD4099FEAD4099FEAULL, 0xD67CB029D67CB029ULL,
+    0xAFB2A431AFB2A431ULL, 0x31233F2A31233F2AULL, 0x3094A5C63094A5C6ULL, 0xC066A235C066A235ULL,
+    0x37BC4E7437BC4E74ULL, 0xA6CA82FCA6CA82FCULL, 0xB0D090E0B0D090E0ULL, 0x15D8A73315D8A733ULL,
+    0x4A9804F14A9804F1ULL, 0xF7DAEC41F7DAEC41ULL, 0x0E50CD7F0E50CD7FULL, 0x2FF691172FF69117ULL,
+    0x8DD64D768DD64D76ULL, 0x4DB0EF434DB0EF43ULL, 0x544DAACC544DAACCULL, 0xDF0496E4DF0496E4ULL,
+    0xE3B5D19EE3B5D19EULL, 0x1B886A4C1B886A4CULL, 0xB81F2CC1B81F2CC1ULL, 0x7F5165467F516546ULL,
+    0x04EA5E9D04EA5E9DULL, 0x5D358C015D358C01ULL, 0x737487FA737487FAULL, 0x2E410BFB2E410BFBULL,
+    0x5A1D67B35A1D67B3ULL, 0x52D2DB9252D2DB92ULL, 0x335610E9335610E9ULL, 0x1347D66D1347D66DULL,
+    0x8C61D79A8C61D79AULL, 0x7A0CA1377A0CA137ULL, 0x8E14F8598E14F859ULL, 0x893C13EB893C13EBULL,
+    0xEE27A9CEEE27A9CEULL, 0x35C961B735C961B7ULL, 0xEDE51CE1EDE51CE1ULL, 0x3CB1477A3CB1477AULL,
+    0x59DFD29C59DFD29CULL, 0x3F73F2553F73F255ULL, 0x79CE141879CE1418ULL, 0xBF37C773BF37C773ULL,
+    0xEACDF753EACDF753ULL, 0x5BAAFD5F5BAAFD5FULL, 0x146F3DDF146F3DDFULL, 0x86DB447886DB4478ULL,
+    0x81F3AFCA81F3AFCAULL, 0x3EC468B93EC468B9ULL, 0x2C3424382C342438ULL, 0x5F40A3C25F40A3C2ULL,
+    0x72C31D1672C31D16ULL, 0x0C25E2BC0C25E2BCULL, 0x8B493C288B493C28ULL, 0x41950DFF41950DFFULL,
+    0x7101A8397101A839ULL, 0xDEB30C08DEB30C08ULL, 0x9CE4B4D89CE4B4D8ULL, 0x90C1566490C15664ULL,
+    0x6184CB7B6184CB7BULL, 0x70B632D570B632D5ULL, 0x745C6C48745C6C48ULL, 0x4257B8D04257B8D0ULL,
+};
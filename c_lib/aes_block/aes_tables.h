@@ -20,6 +20,33 @@ extern "C" {
 #endif
 
 
+    /*
+     * Round tables of the T-table backends, generated by gen/aes_tables_gen.c in the
+     * layout chosen with the AES_BLOCK_TABLES_LAYOUT build option. Row r of each table
+     * is row 0 rotated left by 8 * r bits. Kernels read a word through AES_TE, AES_TD
+     * and AES_IMC with a literal row, so the same code compiles against every layout.
+     */
+#if defined(AES_TABLES_INTERLEAVED)
+    extern const uint32_t Te[256][4];
+    extern const uint32_t IMC[256][4];
+    extern const uint32_t Td[256][4];
+
+    #define AES_TE(r, x)   (Te[x][r])
+    #define AES_IMC(r, x)  (IMC[x][r])
+    #define AES_TD(r, x)   (Td[x][r])
+#elif defined(AES_TABLES_ROTATED)
+    extern const uint32_t Te0[256];
+    extern const uint32_t IMC0[256];
+    extern const uint32_t Td0[256];
+
+    static inline uint32_t aes_table_rotl(const uint32_t word, const unsigned row) {
+        return row == 0 ? word : word << 8 * row | word >> (32 - 8 * row);
+    }
+
+    #define AES_TE(r, x)   aes_table_rotl(Te0[x], r)
+    #define AES_IMC(r, x)  aes_table_rotl(IMC0[x], r)
+    #define AES_TD(r, x)   aes_table_rotl(Td0[x], r)
+#else
     extern const uint32_t Te0[256];
     extern const uint32_t Te1[256];
     extern const uint32_t Te2[256];
@@ -30,6 +57,19 @@ extern "C" {
     extern const uint32_t IMC2[256];
     extern const uint32_t IMC3[256];
 
+    extern const uint32_t Td0[256];
+    extern const uint32_t Td1[256];
+    extern const uint32_t Td2[256];
+    extern const uint32_t Td3[256];
+
+    #define AES_TE(r, x)   (Te##r[x])
+    #define AES_IMC(r, x)  (IMC##r[x])
+    #define AES_TD(r, x)   (Td##r[x])
+#endif
+
+    extern const uint64_t Te0_x2[256];
+    extern const uint64_t Td0_x2[256];
+
 
 #ifdef __cplusplus
 }
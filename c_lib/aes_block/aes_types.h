@@ -14,9 +14,11 @@
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <cstddef>
 extern "C" {
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
 
@@ -37,6 +39,60 @@ extern "C" {
         AES_YieldCallback callback
     );
 
+    typedef void (*AES_GroupFunc)(
+        uint8_t data[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        uint8_t block_count,
+        const uint8_t ex_cols_pattern[][4]
+    );
+
+    /* `input` and `output` are either the same buffer or disjoint, with any alignment. */
+    typedef void (*AES_BlocksFunc)(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count
+    );
+
+    /*
+     * Same as AES_BlocksFunc, and XORs every plaintext group (the input of encryption,
+     * the output of decryption) into the group-sized running `checksum`.
+     */
+    typedef void (*AES_BlocksSumFunc)(
+        const uint8_t input[],
+        uint8_t output[],
+        const uint8_t round_keys[][16],
+        uint8_t key_count,
+        size_t group_count,
+        uint8_t checksum[]
+    );
+
+    /*
+     * Fills `round_keys` with the keys of the next AES round, one per block of
+     * the group, for the lazy group kernels that never hold the whole schedule.
+     */
+    typedef void (*AES_RoundKeysFunc)(
+        void *ctx,
+        uint8_t round_keys[][16]
+    );
+
+    /* The `_sum` kernels are NULL on backends without a fused checksum. */
+    typedef struct {
+        const char *name;
+        AES_Func encrypt;
+        AES_Func decrypt;
+        AES_BlocksFunc encrypt_x2;
+        AES_BlocksFunc decrypt_x2;
+        AES_BlocksFunc encrypt_x4;
+        AES_BlocksFunc decrypt_x4;
+        AES_BlocksSumFunc encrypt_x2_sum;
+        AES_BlocksSumFunc decrypt_x2_sum;
+        AES_BlocksSumFunc encrypt_x4_sum;
+        AES_BlocksSumFunc decrypt_x4_sum;
+    } AES_Backend;
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,140 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_WORDS_H
+#define AES_WORDS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "aes_sbox.h"
+
+
+/*
+ * Word-wise helpers of the T-table batched entry points. The AES state is kept
+ * in four little-endian column words, so that byte `4*c + r` of the state is
+ * byte `r` of word `c`, which lets the compiler hold every block in registers.
+ */
+#define B0(w) ((w) & 0xFF)
+#define B1(w) ((w) >> 8 & 0xFF)
+#define B2(w) ((w) >> 16 & 0xFF)
+#define B3(w) ((w) >> 24)
+
+
+static inline void load_words(uint32_t w[4], const uint8_t bytes[16]) {
+    memcpy(w, bytes, 16);
+}
+
+
+static inline void store_words(uint8_t bytes[16], const uint32_t w[4]) {
+    memcpy(bytes, w, 16);
+}
+
+
+static inline void xor_key_words(uint32_t s[4], const uint8_t key[16]) {
+    uint32_t k[4];
+    load_words(k, key);
+    s[0] ^= k[0];
+    s[1] ^= k[1];
+    s[2] ^= k[2];
+    s[3] ^= k[3];
+}
+
+
+static inline void inv_shift_rows_inv_sub_bytes_words(uint32_t s[4]) {
+    const uint32_t t0 = (uint32_t)aes_inv_sbox[B0(s[0])]
+                      | (uint32_t)aes_inv_sbox[B1(s[3])] <<  8
+                      | (uint32_t)aes_inv_sbox[B2(s[2])] << 16
+                      | (uint32_t)aes_inv_sbox[B3(s[1])] << 24;
+    const uint32_t t1 = (uint32_t)aes_inv_sbox[B0(s[1])]
+                      | (uint32_t)aes_inv_sbox[B1(s[0])] <<  8
+                      | (uint32_t)aes_inv_sbox[B2(s[3])] << 16
+                      | (uint32_t)aes_inv_sbox[B3(s[2])] << 24;
+    const uint32_t t2 = (uint32_t)aes_inv_sbox[B0(s[2])]
+                      | (uint32_t)aes_inv_sbox[B1(s[1])] <<  8
+                      | (uint32_t)aes_inv_sbox[B2(s[0])] << 16
+                      | (uint32_t)aes_inv_sbox[B3(s[3])] << 24;
+    const uint32_t t3 = (uint32_t)aes_inv_sbox[B0(s[3])]
+                      | (uint32_t)aes_inv_sbox[B1(s[2])] <<  8
+                      | (uint32_t)aes_inv_sbox[B2(s[1])] << 16
+                      | (uint32_t)aes_inv_sbox[B3(s[0])] << 24;
+    s[0] = t0;
+    s[1] = t1;
+    s[2] = t2;
+    s[3] = t3;
+}
+
+
+
+/*
+ * AES-Blake256 column exchange, patterns {0, 1, 0, 1} and {1, 0, 1, 0}:
+ * the odd columns are swapped between the two blocks. Self-inverse.
+ */
+static inline void exchange_columns_x2(uint32_t a[4], uint32_t b[4]) {
+    const uint32_t t1 = a[1];
+    const uint32_t t3 = a[3];
+    a[1] = b[1];
+    a[3] = b[3];
+    b[1] = t1;
+    b[3] = t3;
+}
+
+
+/*
+ * AES-Blake512 column exchange, column `c` of block `i` comes from block `(i + c) % 4`.
+ */
+static inline void exchange_columns_x4(uint32_t s[4][4]) {
+    const uint32_t c1 = s[0][1];
+    s[0][1] = s[1][1];
+    s[1][1] = s[2][1];
+    s[2][1] = s[3][1];
+    s[3][1] = c1;
+
+    const uint32_t c2a = s[0][2];
+    const uint32_t c2b = s[1][2];
+    s[0][2] = s[2][2];
+    s[1][2] = s[3][2];
+    s[2][2] = c2a;
+    s[3][2] = c2b;
+
+    const uint32_t c3 = s[3][3];
+    s[3][3] = s[2][3];
+    s[2][3] = s[1][3];
+    s[1][3] = s[0][3];
+    s[0][3] = c3;
+}
+
+
+/*
+ * Inverse AES-Blake512 column exchange, column `c` of block `i` comes from block `(i - c) % 4`.
+ */
+static inline void inv_exchange_columns_x4(uint32_t s[4][4]) {
+    const uint32_t c1 = s[3][1];
+    s[3][1] = s[2][1];
+    s[2][1] = s[1][1];
+    s[1][1] = s[0][1];
+    s[0][1] = c1;
+
+    const uint32_t c2a = s[0][2];
+    const uint32_t c2b = s[1][2];
+    s[0][2] = s[2][2];
+    s[1][2] = s[3][2];
+    s[2][2] = c2a;
+    s[3][2] = c2b;
+
+    const uint32_t c3 = s[0][3];
+    s[0][3] = s[1][3];
+    s[1][3] = s[2][3];
+    s[2][3] = s[3][3];
+    s[3][3] = c3;
+}
+
+
+#endif //AES_WORDS_H
@@ -0,0 +1,298 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Generates aes_sbox.c and aes_tables.c from the GF(2^8) definitions of AES, so
+ * that the tables never have to be edited by hand. The S-box is the affine map
+ * of the multiplicative inverse modulo x^8 + x^4 + x^3 + x + 1, the T-tables are
+ * MixColumns and InvMixColumns of single bytes, and every table word is stored
+ * little-endian like the kernels read it.
+ *
+ *   aes_tables_gen <output_dir> [split|interleaved|rotated] [align]
+ *
+ * The layout selects how the Te, Td and IMC tables are stored, see aes_tables.h:
+ *
+ *   split        Te0..Te3, Td0..Td3 and IMC0..IMC3 as separate 1 KB tables
+ *   interleaved  Te[256][4], Td[256][4] and IMC[256][4], the four words of a byte
+ *                next to each other
+ *   rotated      Te0, Td0 and IMC0 only, the kernels rotate the words instead
+ *
+ * With a non-zero `align` every table starts at a multiple of `align` bytes.
+ * Te0_x2 and Td0_x2 of the compact backend are emitted in every layout. The
+ * sources checked in next to aes_tables.h are the output of the split layout
+ * with natural alignment, refresh them with the aes_block_update_tables target.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef enum {
+    Layout_SPLIT,
+    Layout_INTERLEAVED,
+    Layout_ROTATED
+} Layout;
+
+
+static const char *license =
+    "/*\n"
+    " *   Apache License 2.0\n"
+    " *\n"
+    " *   Copyright (c) 2024, Mattias Aabmets\n"
+    " *\n"
+    " *   The contents of this file are subject to the terms and conditions defined in the License.\n"
+    " *   You may not use, modify, or distribute this file except in compliance with the License.\n"
+    " *\n"
+    " *   SPDX-License-Identifier: Apache-2.0\n"
+    " */\n";
+
+
+static uint8_t xtime(const uint8_t x) {
+    return (uint8_t)(x << 1 ^ (x >> 7) * 0x1B);
+}
+
+
+static uint8_t gf_mul(uint8_t x, uint8_t y) {
+    uint8_t r = 0;
+    while (y != 0) {
+        if (y & 1) {
+            r ^= x;
+        }
+        x = xtime(x);
+        y >>= 1;
+    }
+    return r;
+}
+
+
+/*
+ * Multiplicative inverse in GF(2^8) as x^254, with 0 mapped to 0.
+ */
+static uint8_t gf_inv(const uint8_t x) {
+    uint8_t result = 1;
+    uint8_t base = x;
+    for (unsigned exp = 254; exp != 0; exp >>= 1) {
+        if (exp & 1) {
+            result = gf_mul(result, base);
+        }
+        base = gf_mul(base, base);
+    }
+    return x == 0 ? 0 : result;
+}
+
+
+static uint8_t rotl8(const uint8_t x, const unsigned n) {
+    return (uint8_t)(x << n | x >> (8 - n));
+}
+
+
+static uint32_t rotl32(const uint32_t x, const unsigned n) {
+    return n == 0 ? x : x << n | x >> (32 - n);
+}
+
+
+/*
+ * Little-endian word of the bytes b0..b3 in memory order.
+ */
+static uint32_t le_word(const uint8_t b0, const uint8_t b1, const uint8_t b2, const uint8_t b3) {
+    return (uint32_t)b0 | (uint32_t)b1 << 8 | (uint32_t)b2 << 16 | (uint32_t)b3 << 24;
+}
+
+
+typedef struct {
+    uint8_t sbox[256];
+    uint8_t inv_sbox[256];
+    uint32_t te[4][256];
+    uint32_t td[4][256];
+    uint32_t imc[4][256];
+} Tables;
+
+
+/*
+ * Te0[x] is the MixColumns column of S[x] in row 0, IMC0[x] the InvMixColumns
+ * column of x in row 0 and Td0[x] = IMC0[S^-1[x]]. Row r of each table is the
+ * row 0 word rotated left by 8 * r bits.
+ */
+static void compute_tables(Tables *t) {
+    for (unsigned x = 0; x < 256; x++) {
+        const uint8_t inv = gf_inv((uint8_t)x);
+        const uint8_t s = inv ^ rotl8(inv, 1) ^ rotl8(inv, 2) ^ rotl8(inv, 3) ^ rotl8(inv, 4) ^ 0x63;
+        t->sbox[x] = s;
+        t->inv_sbox[s] = (uint8_t)x;
+    }
+    for (unsigned x = 0; x < 256; x++) {
+        const uint8_t s = t->sbox[x];
+        const uint8_t b = (uint8_t)x;
+        const uint8_t i = t->inv_sbox[x];
+        const uint32_t te0 = le_word(gf_mul(s, 2), s, s, gf_mul(s, 3));
+        const uint32_t imc0 = le_word(gf_mul(b, 14), gf_mul(b, 9), gf_mul(b, 13), gf_mul(b, 11));
+        const uint32_t td0 = le_word(gf_mul(i, 14), gf_mul(i, 9), gf_mul(i, 13), gf_mul(i, 11));
+        for (unsigned r = 0; r < 4; r++) {
+            t->te[r][x] = rotl32(te0, 8 * r);
+            t->imc[r][x] = rotl32(imc0, 8 * r);
+            t->td[r][x] = rotl32(td0, 8 * r);
+        }
+    }
+}
+
+
+static void write_alignment(FILE *out, const unsigned align) {
+    if (align > 0) {
+        fprintf(out, "_Alignas(%u) ", align);
+    }
+}
+
+
+static void write_bytes(FILE *out, const char *name, const uint8_t table[256]) {
+    fprintf(out, "const uint8_t %s[256] = {\n", name);
+    for (unsigned x = 0; x < 256; x++) {
+        fprintf(out, "%s0x%02X,%s", x % 16 == 0 ? "    " : "", table[x], x % 16 == 15 ? "\n" : " ");
+    }
+    fprintf(out, "};\n");
+}
+
+
+static void write_words(FILE *out, const char *name, const uint32_t table[256], const unsigned align) {
+    write_alignment(out, align);
+    fprintf(out, "const uint32_t %s[256] = {\n", name);
+    for (unsigned x = 0; x < 256; x++) {
+        fprintf(out, "%s0x%08XU,%s", x % 8 == 0 ? "    " : "", table[x], x % 8 == 7 ? "\n" : " ");
+    }
+    fprintf(out, "};\n");
+}
+
+
+static void write_interleaved(FILE *out, const char *name, const uint32_t table[4][256], const unsigned align) {
+    write_alignment(out, align);
+    fprintf(out, "const uint32_t %s[256][4] = {\n", name);
+    for (unsigned x = 0; x < 256; x++) {
+        fprintf(
+            out, "%s{0x%08XU, 0x%08XU, 0x%08XU, 0x%08XU},%s", x % 2 == 0 ? "    " : "",
+            table[0][x], table[1][x], table[2][x], table[3][x], x % 2 == 1 ? "\n" : " "
+        );
+    }
+    fprintf(out, "};\n");
+}
+
+
+static void write_doubled(FILE *out, const char *name, const uint32_t table[256], const unsigned align) {
+    write_alignment(out, align);
+    fprintf(out, "const uint64_t %s[256] = {\n", name);
+    for (unsigned x = 0; x < 256; x++) {
+        const uint64_t word = (uint64_t)table[x] << 32 | table[x];
+        fprintf(out, "%s0x%016llXULL,%s", x % 4 == 0 ? "    " : "", (unsigned long long)word, x % 4 == 3 ? "\n" : " ");
+    }
+    fprintf(out, "};\n");
+}
+
+
+/*
+ * Writes one family of round tables, Te, Td or IMC, in the chosen layout.
+ */
+static void write_family(FILE *out, const char *name, const uint32_t table[4][256], const Layout layout, const unsigned align) {
+    char row_name[16];
+    if (layout == Layout_INTERLEAVED) {
+        write_interleaved(out, name, table, align);
+        return;
+    }
+    const unsigned rows = layout == Layout_ROTATED ? 1 : 4;
+    for (unsigned r = 0; r < rows; r++) {
+        snprintf(row_name, sizeof(row_name), "%s%u", name, r);
+        if (r > 0) {
+            fputc('\n', out);
+        }
+        write_words(out, row_name, table[r], align);
+    }
+}
+
+
+static FILE *open_output(const char *dir, const char *name) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "aes_tables_gen: cannot write %s\n", path);
+    }
+    return out;
+}
+
+
+static int write_sbox_source(const char *dir, const Tables *t) {
+    FILE *out = open_output(dir, "aes_sbox.c");
+    if (out == NULL) {
+        return 0;
+    }
+    fprintf(out, "%s\n// Generated by gen/aes_tables_gen.c, do not edit.\n\n#include <stdint.h>\n\n", license);
+    write_bytes(out, "aes_sbox", t->sbox);
+    fprintf(out, "\n");
+    write_bytes(out, "aes_inv_sbox", t->inv_sbox);
+    return fclose(out) == 0;
+}
+
+
+static int write_tables_source(const char *dir, const Tables *t, const Layout layout, const char *layout_name, const unsigned align) {
+    FILE *out = open_output(dir, "aes_tables.c");
+    if (out == NULL) {
+        return 0;
+    }
+    fprintf(out, "%s\n// Generated by gen/aes_tables_gen.c, do not edit. Layout: %s", license, layout_name);
+    if (align > 0) {
+        fprintf(out, ", aligned to %u bytes", align);
+    }
+    fprintf(out, ".\n");
+    fprintf(out, "\n#include <stdint.h>\n\n// ALL TABLES ARE LITTLE-ENDIAN\n\n");
+    write_family(out, "Te", t->te, layout, align);
+    fprintf(out, "\n\n");
+    write_family(out, "IMC", t->imc, layout, align);
+    fprintf(out,
+        "\n\n/*\n"
+        " * Equivalent inverse cipher tables, Td0[x] = IMC0[aes_inv_sbox[x]], so that one lookup\n"
+        " * does InvSubBytes and InvMixColumns of a state byte.\n"
+        " */\n"
+    );
+    write_family(out, "Td", t->td, layout, align);
+    fprintf(out,
+        "\n\n/*\n"
+        " * Te0 and Td0 with every word stored twice, for the compact backend. Reading four bytes\n"
+        " * at offset 0, 3, 2 or 1 of an entry yields the word rotated like Te0..Te3 (Td0..Td3),\n"
+        " * and the eight-byte entries keep every such read inside one cache line.\n"
+        " */\n"
+    );
+    write_doubled(out, "Te0_x2", t->te[0], align);
+    fprintf(out, "\n");
+    write_doubled(out, "Td0_x2", t->td[0], align);
+    return fclose(out) == 0;
+}
+
+
+int main(const int argc, char **argv) {
+    static const char *layout_names[] = {"split", "interleaved", "rotated"};
+    const char *layout_name = argc > 2 ? argv[2] : "split";
+    const unsigned align = argc > 3 ? (unsigned)strtoul(argv[3], NULL, 10) : 0;
+
+    int layout = -1;
+    for (int i = 0; i < 3; i++) {
+        layout = strcmp(layout_name, layout_names[i]) == 0 ? i : layout;
+    }
+    if (argc < 2 || argc > 4 || layout < 0 || (align & (align - 1)) != 0) {
+        fprintf(stderr, "usage: %s <output_dir> [split|interleaved|rotated] [align]\n", argv[0]);
+        return 2;
+    }
+
+    Tables tables;
+    compute_tables(&tables);
+    if (!write_sbox_source(argv[1], &tables) || !write_tables_source(argv[1], &tables, (Layout)layout, layout_name, align)) {
+        return 1;
+    }
+    return 0;
+}
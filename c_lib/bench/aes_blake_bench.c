@@ -0,0 +1,717 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Throughput benchmark of AES-Blake256/512. Sweeps message sizes, AES backends,
+ * thread counts, re-encryption, the batch API and streams fed one by one or
+ * through the multi-buffer manager, prints a table to stderr and writes the
+ * results as JSON to stdout or to the file given with --json.
+ *
+ *   aes_blake_bench [--min-size 16] [--max-size 1G] [--variant 256|512|all]
+ *                   [--backend <name>|all] [--threads <max>] [--min-time <sec>]
+ *                   [--numa 0|1] [--json <path>]
+ *
+ * With --numa 1 the thread pools spread their workers over the NUMA nodes of the
+ * host and pin them there, see `aes_blake_pool_create_numa`.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csprng.h"
+#include "aes_block.h"
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_stats.h"
+#include "aes_blake_multibuffer.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCH_HAS_TSC 1
+#else
+#define BENCH_HAS_TSC 0
+#endif
+
+/* Messages per call of the batch API, and the largest message size it is measured at. */
+#define BATCH_MESSAGES   64
+#define BATCH_MAX_BYTES  4096
+
+/* Streams under their own keys fed one update each per call in the stream modes. */
+#define BENCH_STREAMS    AES_BLAKE_MB_MAX_LANES
+
+static const char *all_backends[] = {"clean", "optimized", "bitsliced", "aesni", "vaes_avx2", "vaes_avx512", "armce"};
+
+
+typedef struct {
+    size_t min_size;
+    size_t max_size;
+    int variants;
+    const char *backend;
+    size_t max_threads;
+    double min_time;
+    int numa;
+    const char *json_path;
+} BenchOptions;
+
+
+typedef struct {
+    const char *variant;
+    const char *backend;
+    const char *operation;
+    const char *mode;
+    size_t threads;
+    size_t message_bytes;
+    uint64_t messages;
+    double seconds;
+    double cycles;
+} BenchResult;
+
+
+typedef struct {
+    BenchResult *items;
+    size_t count;
+    size_t capacity;
+} BenchResults;
+
+
+/*
+ * Contexts of the stream modes, each stream at its own offset of the buffers.
+ */
+typedef struct {
+    AESBlake256Ctx ctx256[BENCH_STREAMS];
+    AESBlake512Ctx ctx512[BENCH_STREAMS];
+    AESBlake256StreamJob jobs256[BENCH_STREAMS];
+    AESBlake512StreamJob jobs512[BENCH_STREAMS];
+    AESBlake256MultiBuffer mb256;
+    AESBlake512MultiBuffer mb512;
+    size_t stride;
+} BenchStreams;
+
+
+/*
+ * Everything a single measured call needs. `run` encrypts or decrypts one
+ * message of `length` bytes, one batch of BATCH_MESSAGES messages, or one
+ * update of `length` bytes on each of BENCH_STREAMS streams.
+ */
+typedef struct BenchCase BenchCase;
+
+struct BenchCase {
+    void (*run)(const BenchCase *bench);
+    AESBlakePool *pool;
+    int decrypt;
+    uint8_t *input;
+    uint8_t *output;
+    uint8_t *auth_tag;
+    size_t length;
+    AESBlakeMessage *msgs;
+    BenchStreams *streams;
+};
+
+
+static uint8_t bench_key[AES_BLAKE512_KEY_BYTES];
+static uint8_t bench_nonce[AES_BLAKE512_NONCE_BYTES];
+static uint8_t bench_context[AES_BLAKE512_CONTEXT_BYTES];
+static AESBlake256Key bench_key256;
+static AESBlake512Key bench_key512;
+
+
+/*
+ * Steps through the measured thread counts: powers of two, then `max_threads`.
+ * Returns 0 after the last one.
+ */
+static size_t next_threads(const size_t threads, const size_t max_threads) {
+    if (threads >= max_threads) {
+        return 0;
+    }
+    return 2 * threads < max_threads ? 2 * threads : max_threads;
+}
+
+
+static double now_seconds(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+
+static uint64_t read_cycles(void) {
+#if BENCH_HAS_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+static void run_single256(const BenchCase *bench) {
+    if (bench->pool == NULL && bench->decrypt) {
+        aes_blake256_decrypt(
+            bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output
+        );
+    } else if (bench->pool == NULL) {
+        aes_blake256_encrypt(
+            bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->output, bench->auth_tag
+        );
+    } else if (bench->decrypt) {
+        aes_blake256_decrypt_parallel(
+            bench->pool, bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output
+        );
+    } else {
+        aes_blake256_encrypt_parallel(
+            bench->pool, bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->output, bench->auth_tag
+        );
+    }
+}
+
+
+static void run_single512(const BenchCase *bench) {
+    if (bench->pool == NULL && bench->decrypt) {
+        aes_blake512_decrypt(
+            bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output
+        );
+    } else if (bench->pool == NULL) {
+        aes_blake512_encrypt(
+            bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->output, bench->auth_tag
+        );
+    } else if (bench->decrypt) {
+        aes_blake512_decrypt_parallel(
+            bench->pool, bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output
+        );
+    } else {
+        aes_blake512_encrypt_parallel(
+            bench->pool, bench_key, bench_nonce, bench_context,
+            bench->input, bench->length, NULL, 0, bench->output, bench->auth_tag
+        );
+    }
+}
+
+
+/*
+ * Re-encrypts one message under the same key and nonce, which costs the same as
+ * under another key. The input tag stays valid, the new tag goes to `new_tag`.
+ */
+static void run_reencrypt256(const BenchCase *bench) {
+    uint8_t new_tag[AES_BLAKE256_TAG_BYTES];
+    aes_blake256_reencrypt_parallel_with_key(
+        bench->pool, &bench_key256, bench_nonce, &bench_key256, bench_nonce,
+        bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output, new_tag
+    );
+}
+
+
+static void run_reencrypt512(const BenchCase *bench) {
+    uint8_t new_tag[AES_BLAKE512_TAG_BYTES];
+    aes_blake512_reencrypt_parallel_with_key(
+        bench->pool, &bench_key512, bench_nonce, &bench_key512, bench_nonce,
+        bench->input, bench->length, NULL, 0, bench->auth_tag, bench->output, new_tag
+    );
+}
+
+
+static void run_batch256(const BenchCase *bench) {
+    if (bench->decrypt) {
+        aes_blake256_decrypt_batch(&bench_key256, bench->msgs, BATCH_MESSAGES);
+    } else {
+        aes_blake256_encrypt_batch(&bench_key256, bench->msgs, BATCH_MESSAGES);
+    }
+}
+
+
+static void run_batch512(const BenchCase *bench) {
+    if (bench->decrypt) {
+        aes_blake512_decrypt_batch(&bench_key512, bench->msgs, BATCH_MESSAGES);
+    } else {
+        aes_blake512_encrypt_batch(&bench_key512, bench->msgs, BATCH_MESSAGES);
+    }
+}
+
+
+static void run_streams256(const BenchCase *bench) {
+    BenchStreams *streams = bench->streams;
+    for (size_t s = 0; s < BENCH_STREAMS; s++) {
+        size_t written;
+        const uint8_t *input = bench->input + s * streams->stride;
+        uint8_t *output = bench->output + s * streams->stride;
+        if (bench->decrypt) {
+            aes_blake256_ctx_decrypt_update(&streams->ctx256[s], input, bench->length, output, &written);
+        } else {
+            aes_blake256_ctx_encrypt_update(&streams->ctx256[s], input, bench->length, output, &written);
+        }
+    }
+}
+
+
+static void run_streams512(const BenchCase *bench) {
+    BenchStreams *streams = bench->streams;
+    for (size_t s = 0; s < BENCH_STREAMS; s++) {
+        size_t written;
+        const uint8_t *input = bench->input + s * streams->stride;
+        uint8_t *output = bench->output + s * streams->stride;
+        if (bench->decrypt) {
+            aes_blake512_ctx_decrypt_update(&streams->ctx512[s], input, bench->length, output, &written);
+        } else {
+            aes_blake512_ctx_encrypt_update(&streams->ctx512[s], input, bench->length, output, &written);
+        }
+    }
+}
+
+
+static void run_mb256(const BenchCase *bench) {
+    BenchStreams *streams = bench->streams;
+    for (size_t s = 0; s < BENCH_STREAMS; s++) {
+        streams->jobs256[s] = (AESBlake256StreamJob){
+            &streams->ctx256[s], bench->input + s * streams->stride, bench->length,
+            bench->output + s * streams->stride, bench->decrypt, NULL, AESBlakeStatus_OK, 0
+        };
+        aes_blake256_mb_submit(&streams->mb256, &streams->jobs256[s]);
+    }
+    while (aes_blake256_mb_flush(&streams->mb256) != NULL) {
+    }
+}
+
+
+static void run_mb512(const BenchCase *bench) {
+    BenchStreams *streams = bench->streams;
+    for (size_t s = 0; s < BENCH_STREAMS; s++) {
+        streams->jobs512[s] = (AESBlake512StreamJob){
+            &streams->ctx512[s], bench->input + s * streams->stride, bench->length,
+            bench->output + s * streams->stride, bench->decrypt, NULL, AESBlakeStatus_OK, 0
+        };
+        aes_blake512_mb_submit(&streams->mb512, &streams->jobs512[s]);
+    }
+    while (aes_blake512_mb_flush(&streams->mb512) != NULL) {
+    }
+}
+
+
+/*
+ * Starts every stream of the stream modes under a key of its own.
+ */
+static void init_streams(BenchStreams *streams) {
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    memcpy(key, bench_key, sizeof(key));
+    for (size_t s = 0; s < BENCH_STREAMS; s++) {
+        key[0] = (uint8_t)s;
+        aes_blake256_ctx_init(&streams->ctx256[s], key, bench_nonce, bench_context);
+        aes_blake512_ctx_init(&streams->ctx512[s], key, bench_nonce, bench_context);
+    }
+    aes_blake256_mb_init(&streams->mb256, 0);
+    aes_blake512_mb_init(&streams->mb512, 0);
+}
+
+
+/*
+ * Repeats the call, doubling the repetition count, until one round of
+ * repetitions takes at least `min_time` seconds.
+ */
+static void measure(const BenchCase *bench, const double min_time, uint64_t *calls, double *seconds, double *cycles) {
+    bench->run(bench);
+
+    uint64_t repeats = 1;
+    for (;;) {
+        const uint64_t c0 = read_cycles();
+        const double t0 = now_seconds();
+        for (uint64_t i = 0; i < repeats; i++) {
+            bench->run(bench);
+        }
+        const double elapsed = now_seconds() - t0;
+        const uint64_t c1 = read_cycles();
+
+        if (elapsed >= min_time || repeats >= (UINT64_C(1) << 40)) {
+            *calls = repeats;
+            *seconds = elapsed;
+            *cycles = (double)(c1 - c0);
+            return;
+        }
+        repeats *= 2;
+    }
+}
+
+
+static void add_result(BenchResults *results, const BenchResult *result) {
+    if (results->count == results->capacity) {
+        const size_t capacity = results->capacity ? 2 * results->capacity : 64;
+        BenchResult *items = realloc(results->items, capacity * sizeof(BenchResult));
+        if (items == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        results->items = items;
+        results->capacity = capacity;
+    }
+    results->items[results->count++] = *result;
+}
+
+
+static void print_result(const BenchResult *r) {
+    const double bytes = (double)r->message_bytes * (double)r->messages;
+    fprintf(
+        stderr, "%-13s %-12s %-8s %-7s %3zu thr %11zu B  %9.3f GB/s  %12.0f msg/s",
+        r->variant, r->backend, r->operation, r->mode, r->threads, r->message_bytes,
+        bytes / r->seconds / 1e9, (double)r->messages / r->seconds
+    );
+    if (BENCH_HAS_TSC) {
+        fprintf(stderr, "  %8.2f cyc/B", r->cycles / bytes);
+    }
+    fprintf(stderr, "\n");
+}
+
+
+static void write_json(FILE *out, const BenchResults *results, const BenchOptions *options) {
+    fprintf(out, "{\n  \"min_time\": %.3f,\n  \"cycle_counter\": \"%s\",\n  \"results\": [\n",
+            options->min_time, BENCH_HAS_TSC ? "tsc" : "none");
+    for (size_t i = 0; i < results->count; i++) {
+        const BenchResult *r = &results->items[i];
+        const double bytes = (double)r->message_bytes * (double)r->messages;
+        fprintf(
+            out,
+            "    {\"variant\": \"%s\", \"backend\": \"%s\", \"operation\": \"%s\", \"mode\": \"%s\", "
+            "\"threads\": %zu, \"message_bytes\": %zu, \"messages\": %llu, \"seconds\": %.6f, "
+            "\"gb_per_s\": %.6f, \"msgs_per_s\": %.3f, ",
+            r->variant, r->backend, r->operation, r->mode, r->threads, r->message_bytes,
+            (unsigned long long)r->messages, r->seconds, bytes / r->seconds / 1e9,
+            (double)r->messages / r->seconds
+        );
+        if (BENCH_HAS_TSC) {
+            fprintf(out, "\"cycles_per_byte\": %.4f}", r->cycles / bytes);
+        } else {
+            fprintf(out, "\"cycles_per_byte\": null}");
+        }
+        fprintf(out, "%s\n", i + 1 < results->count ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"stats\": {");
+    if (aes_blake_stats_enabled()) {
+        // Totals over the whole run when the library is built with AES_BLAKE_STATS
+        AESBlakeStats stats;
+        aes_blake_stats_snapshot(&stats);
+        for (int p = 0; p < AESBlakePhase_COUNT; p++) {
+            fprintf(out, "%s\n    \"%s\": {\"ticks\": %llu, \"calls\": %llu}", p ? "," : "",
+                    aes_blake_stats_phase_name((AESBlakePhase)p),
+                    (unsigned long long)stats.ticks[p], (unsigned long long)stats.calls[p]);
+        }
+        fprintf(out, "\n  ");
+    }
+    fprintf(out, "}\n}\n");
+}
+
+
+/*
+ * Runs BENCH_STREAMS streams with updates of `message_bytes` each, one stream
+ * after another ("stream") and through the multi-buffer manager ("mb").
+ */
+static void bench_streams(
+        BenchResults *results,
+        const BenchOptions *options,
+        const int variant,
+        const char *backend,
+        const size_t message_bytes
+) {
+    const char *variant_name = variant == 256 ? "aes_blake256" : "aes_blake512";
+    BenchStreams *streams = malloc(sizeof(BenchStreams));
+    const size_t stride = message_bytes + AES_BLAKE512_GROUP_BYTES;
+    uint8_t *input = malloc(BENCH_STREAMS * stride);
+    uint8_t *output = malloc(BENCH_STREAMS * stride);
+    if (streams != NULL && input != NULL && output != NULL) {
+        memset(input, 0x5A, BENCH_STREAMS * stride);
+        streams->stride = stride;
+        for (int mb = 0; mb <= 1; mb++) {
+            for (int decrypt = 0; decrypt <= 1; decrypt++) {
+                // Each measurement starts fresh contexts, as a context runs in one direction only
+                init_streams(streams);
+                BenchCase bench = {0};
+                bench.run = variant == 256 ? (mb ? run_mb256 : run_streams256) : (mb ? run_mb512 : run_streams512);
+                bench.decrypt = decrypt;
+                bench.input = input;
+                bench.output = output;
+                bench.length = message_bytes;
+                bench.streams = streams;
+                BenchResult result = {
+                    variant_name, backend, decrypt ? "decrypt" : "encrypt", mb ? "mb" : "stream", 1, message_bytes, 0, 0, 0
+                };
+                measure(&bench, options->min_time, &result.messages, &result.seconds, &result.cycles);
+                result.messages *= BENCH_STREAMS;
+                print_result(&result);
+                add_result(results, &result);
+            }
+        }
+    }
+    free(streams);
+    free(input);
+    free(output);
+}
+
+
+/*
+ * Runs the encrypt and decrypt cases of one message size for every thread
+ * count, and through the batch API and the stream modes when the messages are small.
+ */
+static void bench_size(
+        BenchResults *results,
+        const BenchOptions *options,
+        const int variant,
+        const char *backend,
+        const size_t message_bytes,
+        AESBlakePool **pools
+) {
+    const char *variant_name = variant == 256 ? "aes_blake256" : "aes_blake512";
+    const size_t tag_bytes = variant == 256 ? AES_BLAKE256_TAG_BYTES : AES_BLAKE512_TAG_BYTES;
+    const size_t buffer_bytes = message_bytes > 0 ? message_bytes : 1;
+
+    uint8_t *input = malloc(buffer_bytes);
+    uint8_t *output = malloc(buffer_bytes);
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+    if (input == NULL || output == NULL) {
+        fprintf(stderr, "skipping %zu B: out of memory\n", message_bytes);
+        free(input);
+        free(output);
+        return;
+    }
+    memset(input, 0x5A, buffer_bytes);
+
+    for (int decrypt = 0; decrypt <= 1; decrypt++) {
+        for (size_t threads = 1; threads != 0; threads = next_threads(threads, options->max_threads)) {
+            // Messages too small to be split gain nothing from more threads
+            if (threads > 1 && message_bytes < 2 * AES_BLAKE_POOL_MIN_TASK_BYTES) {
+                break;
+            }
+            BenchCase bench = {
+                variant == 256 ? run_single256 : run_single512,
+                pools[threads], decrypt, decrypt ? output : input, decrypt ? input : output,
+                auth_tag, message_bytes, NULL, NULL
+            };
+            if (decrypt) {
+                // Decrypt a valid ciphertext so that the tag check succeeds
+                BenchCase encrypt = bench;
+                encrypt.decrypt = 0;
+                encrypt.input = input;
+                encrypt.output = output;
+                encrypt.run(&encrypt);
+            }
+
+            BenchResult result = {
+                variant_name, backend, decrypt ? "decrypt" : "encrypt", "single", threads, message_bytes, 0, 0, 0
+            };
+            measure(&bench, options->min_time, &result.messages, &result.seconds, &result.cycles);
+            print_result(&result);
+            add_result(results, &result);
+        }
+    }
+
+    // The decrypt cases left a valid ciphertext and tag in `output`
+    for (size_t threads = 1; threads != 0; threads = next_threads(threads, options->max_threads)) {
+        if (threads > 1 && message_bytes < 2 * AES_BLAKE_POOL_MIN_TASK_BYTES) {
+            break;
+        }
+        BenchCase bench = {
+            variant == 256 ? run_reencrypt256 : run_reencrypt512,
+            pools[threads], 0, output, input, auth_tag, message_bytes, NULL, NULL
+        };
+        BenchResult result = {variant_name, backend, "reencrypt", "single", threads, message_bytes, 0, 0, 0};
+        measure(&bench, options->min_time, &result.messages, &result.seconds, &result.cycles);
+        print_result(&result);
+        add_result(results, &result);
+    }
+
+    if (message_bytes <= BATCH_MAX_BYTES) {
+        AESBlakeMessage msgs[BATCH_MESSAGES];
+        uint8_t *batch_input = malloc(BATCH_MESSAGES * buffer_bytes);
+        uint8_t *batch_output = malloc(BATCH_MESSAGES * buffer_bytes);
+        uint8_t *batch_tags = malloc(BATCH_MESSAGES * tag_bytes);
+        if (batch_input != NULL && batch_output != NULL && batch_tags != NULL) {
+            memset(batch_input, 0x5A, BATCH_MESSAGES * buffer_bytes);
+            for (size_t i = 0; i < BATCH_MESSAGES; i++) {
+                msgs[i] = (AESBlakeMessage){
+                    bench_nonce, batch_input + i * buffer_bytes, message_bytes, NULL, 0,
+                    batch_output + i * buffer_bytes, batch_tags + i * tag_bytes, AESBlakeStatus_OK
+                };
+            }
+            BenchCase bench = {
+                variant == 256 ? run_batch256 : run_batch512, NULL, 0, NULL, NULL, NULL, message_bytes, msgs, NULL
+            };
+            for (int decrypt = 0; decrypt <= 1; decrypt++) {
+                if (decrypt) {
+                    for (size_t i = 0; i < BATCH_MESSAGES; i++) {
+                        msgs[i].input = batch_output + i * buffer_bytes;
+                        msgs[i].output = batch_input + i * buffer_bytes;
+                    }
+                }
+                bench.decrypt = decrypt;
+                BenchResult result = {
+                    variant_name, backend, decrypt ? "decrypt" : "encrypt", "batch", 1, message_bytes, 0, 0, 0
+                };
+                measure(&bench, options->min_time, &result.messages, &result.seconds, &result.cycles);
+                result.messages *= BATCH_MESSAGES;
+                print_result(&result);
+                add_result(results, &result);
+            }
+        }
+        free(batch_input);
+        free(batch_output);
+        free(batch_tags);
+        bench_streams(results, options, variant, backend, message_bytes);
+    }
+    free(input);
+    free(output);
+}
+
+
+static size_t parse_size(const char *text) {
+    char *end = NULL;
+    size_t value = (size_t)strtoull(text, &end, 10);
+    switch (end != NULL ? *end : '\0') {
+        case 'K': case 'k': value <<= 10; break;
+        case 'M': case 'm': value <<= 20; break;
+        case 'G': case 'g': value <<= 30; break;
+        default: break;
+    }
+    return value;
+}
+
+
+static int parse_options(const int argc, char **argv, BenchOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return 0;
+        }
+        if (strcmp(arg, "--min-size") == 0) {
+            options->min_size = parse_size(value);
+        } else if (strcmp(arg, "--max-size") == 0) {
+            options->max_size = parse_size(value);
+        } else if (strcmp(arg, "--variant") == 0) {
+            options->variants = strcmp(value, "256") == 0 ? 1 : strcmp(value, "512") == 0 ? 2 : 3;
+        } else if (strcmp(arg, "--backend") == 0) {
+            options->backend = value;
+        } else if (strcmp(arg, "--threads") == 0) {
+            options->max_threads = (size_t)strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "--min-time") == 0) {
+            options->min_time = strtod(value, NULL);
+        } else if (strcmp(arg, "--numa") == 0) {
+            options->numa = strcmp(value, "0") != 0;
+        } else if (strcmp(arg, "--json") == 0) {
+            options->json_path = value;
+        } else {
+            return 0;
+        }
+        i++;
+    }
+    return options->min_size > 0 && options->max_size >= options->min_size && options->max_threads > 0;
+}
+
+
+int main(const int argc, char **argv) {
+    AESBlakePool *probe = aes_blake_pool_create(0);
+    BenchOptions options = {16, (size_t)1 << 30, 3, NULL, aes_blake_pool_thread_count(probe) + 1, 0.2, 0, NULL};
+    aes_blake_pool_destroy(probe);
+
+    if (!parse_options(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--min-size 16] [--max-size 1G] [--variant 256|512|all] "
+                        "[--backend <name>|all] [--threads <max>] [--min-time <sec>] [--numa 0|1] [--json <path>]\n", argv[0]);
+        return 2;
+    }
+
+    csprng_read_array(bench_key, sizeof(bench_key));
+    csprng_read_array(bench_nonce, sizeof(bench_nonce));
+    csprng_read_array(bench_context, sizeof(bench_context));
+    aes_blake256_key_init(&bench_key256, bench_key, bench_context);
+    aes_blake512_key_init(&bench_key512, bench_key, bench_context);
+
+    // pools[t] runs t threads in total, the caller included; pools[1] is the serial path
+    AESBlakePool **pools = calloc(options.max_threads + 1, sizeof(AESBlakePool *));
+    for (size_t t = next_threads(1, options.max_threads); t != 0; t = next_threads(t, options.max_threads)) {
+        pools[t] = options.numa ? aes_blake_pool_create_numa(t - 1) : aes_blake_pool_create(t - 1);
+    }
+
+    const char *detected = aes_select_backend()->name;
+    const char *default_backends[] = {detected};
+    const char **backends = default_backends;
+    size_t backend_count = 1;
+    if (options.backend != NULL && strcmp(options.backend, "all") == 0) {
+        backends = all_backends;
+        backend_count = sizeof(all_backends) / sizeof(all_backends[0]);
+    } else if (options.backend != NULL) {
+        default_backends[0] = options.backend;
+    }
+
+    BenchResults results = {NULL, 0, 0};
+    for (size_t b = 0; b < backend_count; b++) {
+        const AES_Backend *backend = aes_find_backend(backends[b]);
+        if (backend == NULL) {
+            fprintf(stderr, "skipping backend %s: not supported on this CPU\n", backends[b]);
+            continue;
+        }
+        aes_set_backend(backend);
+
+        for (int variant = 256; variant <= 512; variant *= 2) {
+            if (!(options.variants & (variant == 256 ? 1 : 2))) {
+                continue;
+            }
+            const size_t group_bytes = variant == 256 ? AES_BLAKE256_GROUP_BYTES : AES_BLAKE512_GROUP_BYTES;
+            size_t previous = 0;
+            for (size_t size = options.min_size; size <= options.max_size; size *= 4) {
+                // Messages are whole groups, so small sizes round up to one group
+                const size_t message_bytes = (size + group_bytes - 1) / group_bytes * group_bytes;
+                if (message_bytes != previous) {
+                    bench_size(&results, &options, variant, backend->name, message_bytes, pools);
+                    previous = message_bytes;
+                }
+            }
+        }
+    }
+    aes_set_backend(NULL);
+
+    FILE *out = stdout;
+    if (options.json_path != NULL) {
+        out = fopen(options.json_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "cannot open %s\n", options.json_path);
+            return 1;
+        }
+    }
+    write_json(out, &results, &options);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    for (size_t t = next_threads(1, options.max_threads); t != 0; t = next_threads(t, options.max_threads)) {
+        aes_blake_pool_destroy(pools[t]);
+    }
+    free(pools);
+    free(results.items);
+    return 0;
+}
@@ -0,0 +1,569 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Performance regression harness. Runs every primitive on its clean, optimized
+ * and SIMD paths, the ones the CPU supports: Blake mix_state, derive_keys and
+ * derive_keys_many, the AES x2 kernels of each backend and the one-shot AEAD, also
+ * decrypting from a key schedule, on the clean, optimized and detected backends. Each case takes the median of many
+ * samples and is compared with a baseline file, any case slower than the baseline
+ * by more than the threshold counts as a regression and fails the run.
+ *
+ *   aes_blake_perf [--baseline <path>] [--record <path>] [--threshold <percent>]
+ *                  [--samples <n>] [--sample-ms <ms>] [--cpu <index>] [--filter <text>]
+ *
+ * --baseline compares with the file, or records it when it does not exist yet,
+ * --record always overwrites it. The process is pinned to one CPU and warmed up
+ * before measuring. Frequency scaling cannot be fixed from here, so on Linux the
+ * harness warns unless the CPU runs the "performance" governor; set it with
+ * `cpupower frequency-set -g performance` and turn off turbo for stable medians.
+ * Baselines hold times of one host and build, record them on the machine that checks.
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_block.h"
+#include "aes_blake.h"
+#include "aes_blake_schedule.h"
+#include "blake_cpu.h"
+#include "blake_internals.h"
+#include "blake_keygen.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#define PERF_MAX_CASES    64
+#define PERF_MAX_SAMPLES  1001
+#define PERF_NAME_BYTES   64
+
+/* Round keys per block, AES block groups per kernel call and AEAD message size. */
+#define PERF_KEY_COUNT    11
+#define PERF_AES_GROUPS   64
+#define PERF_AEAD_BYTES   4096
+
+/* Key schedules of one AEAD message, its groups plus the CHK group, see aes_blake_schedule.h. */
+#define PERF_SCHEDULE256_BYTES (AES_BLAKE_SCHEDULE_HEADER_BYTES + (PERF_AEAD_BYTES / 32 + 1) * 2 * AES_BLAKE_ROUNDS * 16)
+#define PERF_SCHEDULE512_BYTES (AES_BLAKE_SCHEDULE_HEADER_BYTES + (PERF_AEAD_BYTES / 64 + 1) * 4 * AES_BLAKE_ROUNDS * 16)
+
+
+typedef struct {
+    const char *baseline_path;
+    const char *record_path;
+    double threshold;
+    size_t samples;
+    double sample_ms;
+    int cpu;
+    const char *filter;
+} PerfOptions;
+
+
+typedef struct PerfCase PerfCase;
+
+struct PerfCase {
+    char name[PERF_NAME_BYTES];
+    void (*run)(const PerfCase *perf);
+    MixStateFunc32 mix32;
+    MixStateFunc64 mix64;
+    DeriveFunc32 derive32;
+    DeriveFunc64 derive64;
+    DeriveManyFunc32 many32;
+    DeriveManyFunc64 many64;
+    const AES_Backend *backend;
+    int decrypt;  // 0 encrypts, 1 decrypts, 2 decrypts with a key schedule
+    double median_ns;
+};
+
+
+typedef struct {
+    char name[PERF_NAME_BYTES];
+    double median_ns;
+} PerfBaseline;
+
+
+static uint32_t state32[16], message32[16], init_state32[16], knc32[16];
+static uint64_t state64[16], message64[16], init_state64[16], knc64[16];
+static uint8_t round_keys[PERF_AES_GROUPS * 4 * PERF_KEY_COUNT][16];
+static uint8_t aes_data[PERF_AES_GROUPS * 64];
+static uint8_t aead_plaintext[PERF_AEAD_BYTES], aead_output[PERF_AEAD_BYTES];
+static uint8_t aead_ciphertext256[PERF_AEAD_BYTES], aead_ciphertext512[PERF_AEAD_BYTES];
+static uint8_t aead_tag256[AES_BLAKE256_TAG_BYTES], aead_tag512[AES_BLAKE512_TAG_BYTES];
+static uint8_t aead_tag_output[AES_BLAKE512_TAG_BYTES];
+static uint8_t aead_nonce[AES_BLAKE512_NONCE_BYTES];
+static AESBlake256Key aead_key256;
+static AESBlake512Key aead_key512;
+static uint8_t aead_schedule256[PERF_SCHEDULE256_BYTES], aead_schedule512[PERF_SCHEDULE512_BYTES];
+
+
+static double now_seconds(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+
+/*
+ * Pins the process to CPU `cpu`, so that every sample runs on the same core
+ * with the same caches. Returns 0 where pinning is unsupported or refused.
+ */
+static int pin_cpu(const int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+
+static void check_governor(const int cpu) {
+#if defined(__linux__)
+    char path[96], governor[32] = {0};
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return;
+    }
+    if (fscanf(file, "%31s", governor) == 1 && strcmp(governor, "performance") != 0) {
+        fprintf(stderr, "warning: cpu%d runs the '%s' governor, medians may drift with the clock\n", cpu, governor);
+    }
+    fclose(file);
+#else
+    (void)cpu;
+#endif
+}
+
+
+/* --- Cases --- */
+
+static void run_mix32(const PerfCase *perf) {
+    perf->mix32(state32, message32);
+}
+
+
+static void run_mix64(const PerfCase *perf) {
+    perf->mix64(state64, message64);
+}
+
+
+static void run_derive32(const PerfCase *perf) {
+    perf->derive32(init_state32, knc32, PERF_KEY_COUNT, 7, KDFDomain_MSG, &round_keys[0], &round_keys[PERF_KEY_COUNT]);
+}
+
+
+static void run_derive64(const PerfCase *perf) {
+    perf->derive64(
+        init_state64, knc64, PERF_KEY_COUNT, 7, KDFDomain_MSG, &round_keys[0], &round_keys[PERF_KEY_COUNT],
+        &round_keys[2 * PERF_KEY_COUNT], &round_keys[3 * PERF_KEY_COUNT]
+    );
+}
+
+
+static void run_many32(const PerfCase *perf) {
+    perf->many32(init_state32, knc32, PERF_KEY_COUNT, 0, PERF_AES_GROUPS, KDFDomain_MSG, round_keys);
+}
+
+
+static void run_many64(const PerfCase *perf) {
+    perf->many64(init_state64, knc64, PERF_KEY_COUNT, 0, PERF_AES_GROUPS, KDFDomain_MSG, round_keys);
+}
+
+
+static void run_aes_x2(const PerfCase *perf) {
+    const AES_BlocksFunc kernel = perf->decrypt ? perf->backend->decrypt_x2 : perf->backend->encrypt_x2;
+    kernel(aes_data, aes_data, round_keys, PERF_KEY_COUNT, PERF_AES_GROUPS);
+}
+
+
+static void run_aead256(const PerfCase *perf) {
+    if (perf->decrypt == 2) {
+        aes_blake256_decrypt_with_schedule(
+            aead_schedule256, aes_blake256_schedule_size(PERF_AEAD_BYTES, 0), aead_ciphertext256, PERF_AEAD_BYTES,
+            NULL, 0, aead_tag256, aead_output
+        );
+    } else if (perf->decrypt) {
+        aes_blake256_decrypt_with_key(
+            &aead_key256, aead_nonce, aead_ciphertext256, PERF_AEAD_BYTES, NULL, 0, aead_tag256, aead_output
+        );
+    } else {
+        aes_blake256_encrypt_with_key(
+            &aead_key256, aead_nonce, aead_plaintext, PERF_AEAD_BYTES, NULL, 0, aead_output, aead_tag_output
+        );
+    }
+}
+
+
+static void run_aead512(const PerfCase *perf) {
+    if (perf->decrypt == 2) {
+        aes_blake512_decrypt_with_schedule(
+            aead_schedule512, aes_blake512_schedule_size(PERF_AEAD_BYTES, 0), aead_ciphertext512, PERF_AEAD_BYTES,
+            NULL, 0, aead_tag512, aead_output
+        );
+    } else if (perf->decrypt) {
+        aes_blake512_decrypt_with_key(
+            &aead_key512, aead_nonce, aead_ciphertext512, PERF_AEAD_BYTES, NULL, 0, aead_tag512, aead_output
+        );
+    } else {
+        aes_blake512_encrypt_with_key(
+            &aead_key512, aead_nonce, aead_plaintext, PERF_AEAD_BYTES, NULL, 0, aead_output, aead_tag_output
+        );
+    }
+}
+
+
+static PerfCase *add_case(PerfCase cases[], size_t *count, const char *name, void (*run)(const PerfCase *)) {
+    PerfCase *perf = &cases[(*count)++];
+    memset(perf, 0, sizeof(*perf));
+    snprintf(perf->name, sizeof(perf->name), "%s", name);
+    perf->run = run;
+    return perf;
+}
+
+
+static void add_blake_cases(PerfCase cases[], size_t *count) {
+    add_case(cases, count, "blake32_mix_state/clean", run_mix32)->mix32 = blake32_clean_mix_state;
+    add_case(cases, count, "blake32_mix_state/optimized", run_mix32)->mix32 = blake32_optimized_mix_state;
+    add_case(cases, count, "blake64_mix_state/clean", run_mix64)->mix64 = blake64_clean_mix_state;
+    add_case(cases, count, "blake64_mix_state/optimized", run_mix64)->mix64 = blake64_optimized_mix_state;
+    add_case(cases, count, "blake32_derive_keys/clean", run_derive32)->derive32 = blake32_clean_derive_keys;
+    add_case(cases, count, "blake32_derive_keys/optimized", run_derive32)->derive32 = blake32_optimized_derive_keys;
+    add_case(cases, count, "blake64_derive_keys/clean", run_derive64)->derive64 = blake64_clean_derive_keys;
+    add_case(cases, count, "blake64_derive_keys/optimized", run_derive64)->derive64 = blake64_optimized_derive_keys;
+    add_case(cases, count, "blake32_derive_keys_many/optimized", run_many32)->many32 = blake32_optimized_derive_keys_many;
+    add_case(cases, count, "blake64_derive_keys_many/optimized", run_many64)->many64 = blake64_optimized_derive_keys_many;
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_sse41()) {
+        add_case(cases, count, "blake32_mix_state/sse41", run_mix32)->mix32 = blake32_sse41_mix_state;
+        add_case(cases, count, "blake32_derive_keys/sse41", run_derive32)->derive32 = blake32_sse41_derive_keys;
+    }
+    if (blake_cpu_has_avx2()) {
+        add_case(cases, count, "blake64_mix_state/avx2", run_mix64)->mix64 = blake64_avx2_mix_state;
+        add_case(cases, count, "blake32_derive_keys/avx2", run_derive32)->derive32 = blake32_avx2_derive_keys;
+        add_case(cases, count, "blake64_derive_keys/avx2", run_derive64)->derive64 = blake64_avx2_derive_keys;
+        add_case(cases, count, "blake32_derive_keys_many/avx2", run_many32)->many32 = blake32_avx2_derive_keys_many;
+        add_case(cases, count, "blake64_derive_keys_many/avx2", run_many64)->many64 = blake64_avx2_derive_keys_many;
+    }
+    if (blake_cpu_has_avx512()) {
+        add_case(cases, count, "blake32_derive_keys_many/avx512", run_many32)->many32 = blake32_avx512_derive_keys_many;
+    }
+    if (blake_cpu_has_avx512vl()) {
+        add_case(cases, count, "blake64_mix_state/avx512", run_mix64)->mix64 = blake64_avx512_mix_state;
+        add_case(cases, count, "blake64_derive_keys/avx512", run_derive64)->derive64 = blake64_avx512_derive_keys;
+        add_case(cases, count, "blake64_derive_keys_many/avx512", run_many64)->many64 = blake64_avx512_derive_keys_many;
+    }
+#endif
+#if defined(BLAKE_ARCH_ARM64)
+    add_case(cases, count, "blake32_mix_state/neon", run_mix32)->mix32 = blake32_neon_mix_state;
+    add_case(cases, count, "blake32_derive_keys/neon", run_derive32)->derive32 = blake32_neon_derive_keys;
+#endif
+}
+
+
+/*
+ * AES kernels of every backend the CPU supports, and the AEAD on the clean,
+ * optimized and detected backends, which covers the reference path, the
+ * portable fast path and the one callers get.
+ */
+static void add_aes_cases(PerfCase cases[], size_t *count) {
+    static const char *backends[] = {
+        "clean", "optimized", "compact", "bitsliced", "masked", "aesni", "vaes_avx2", "vaes_avx512", "armce"
+    };
+    const char *detected = aes_select_backend()->name;
+    char name[PERF_NAME_BYTES];
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        const AES_Backend *backend = aes_find_backend(backends[b]);
+        if (backend == NULL) {
+            continue;
+        }
+        for (int decrypt = 0; decrypt <= 1; decrypt++) {
+            snprintf(name, sizeof(name), "aes_%s_x2/%s", decrypt ? "decrypt" : "encrypt", backend->name);
+            PerfCase *perf = add_case(cases, count, name, run_aes_x2);
+            perf->backend = backend;
+            perf->decrypt = decrypt;
+        }
+        const int aead = strcmp(backends[b], "clean") == 0 || strcmp(backends[b], "optimized") == 0
+                      || strcmp(backends[b], detected) == 0;
+        static const char *operations[] = {"encrypt", "decrypt", "decrypt_schedule"};
+        for (int variant = 256; aead && variant <= 512; variant *= 2) {
+            for (int decrypt = 0; decrypt <= 2; decrypt++) {
+                snprintf(name, sizeof(name), "aes_blake%d_%s/%s", variant, operations[decrypt], backend->name);
+                PerfCase *perf = add_case(cases, count, name, variant == 256 ? run_aead256 : run_aead512);
+                perf->backend = backend;
+                perf->decrypt = decrypt;
+            }
+        }
+    }
+}
+
+
+static void init_inputs(void) {
+    uint8_t key[AES_BLAKE512_KEY_BYTES], context[AES_BLAKE512_CONTEXT_BYTES];
+    for (size_t i = 0; i < 16; i++) {
+        state32[i] = message32[i] = init_state32[i] = knc32[i] = (uint32_t)(0x9E3779B9U * (i + 1));
+        state64[i] = message64[i] = init_state64[i] = knc64[i] = UINT64_C(0x9E3779B97F4A7C15) * (i + 1);
+    }
+    for (size_t i = 0; i < sizeof(round_keys); i++) {
+        round_keys[i / 16][i % 16] = (uint8_t)(i * 131 + 7);
+    }
+    for (size_t i = 0; i < sizeof(aes_data); i++) {
+        aes_data[i] = (uint8_t)i;
+    }
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(i + 1);
+    }
+    memset(context, 0x3C, sizeof(context));
+    memset(aead_nonce, 0xA5, sizeof(aead_nonce));
+    memset(aead_plaintext, 0x5A, sizeof(aead_plaintext));
+    aes_blake256_key_init(&aead_key256, key, context);
+    aes_blake512_key_init(&aead_key512, key, context);
+
+    // Every backend produces the same ciphertext, so one valid input serves all decrypt cases
+    aes_blake256_encrypt_with_key(
+        &aead_key256, aead_nonce, aead_plaintext, PERF_AEAD_BYTES, NULL, 0, aead_ciphertext256, aead_tag256
+    );
+    aes_blake512_encrypt_with_key(
+        &aead_key512, aead_nonce, aead_plaintext, PERF_AEAD_BYTES, NULL, 0, aead_ciphertext512, aead_tag512
+    );
+    aes_blake256_schedule_export(
+        &aead_key256, aead_nonce, PERF_AEAD_BYTES, 0, aead_schedule256, aes_blake256_schedule_size(PERF_AEAD_BYTES, 0)
+    );
+    aes_blake512_schedule_export(
+        &aead_key512, aead_nonce, PERF_AEAD_BYTES, 0, aead_schedule512, aes_blake512_schedule_size(PERF_AEAD_BYTES, 0)
+    );
+}
+
+
+/* --- Measurement --- */
+
+static int compare_doubles(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+ * Calibrates the calls per sample to about `sample_ms`, discards one sample
+ * as warm-up and returns the median time per call over `samples` samples.
+ */
+static double measure_median(const PerfCase *perf, const size_t samples, const double sample_ms) {
+    static double times[PERF_MAX_SAMPLES];
+    uint64_t calls = 1;
+    for (;;) {
+        const double t0 = now_seconds();
+        for (uint64_t i = 0; i < calls; i++) {
+            perf->run(perf);
+        }
+        const double elapsed = now_seconds() - t0;
+        if (elapsed * 1e3 >= sample_ms || calls >= (UINT64_C(1) << 32)) {
+            break;
+        }
+        calls *= 2;
+    }
+    for (size_t s = 0; s < samples; s++) {
+        const double t0 = now_seconds();
+        for (uint64_t i = 0; i < calls; i++) {
+            perf->run(perf);
+        }
+        times[s] = (now_seconds() - t0) * 1e9 / (double)calls;
+    }
+    qsort(times, samples, sizeof(double), compare_doubles);
+    return samples % 2 == 1 ? times[samples / 2] : (times[samples / 2 - 1] + times[samples / 2]) / 2;
+}
+
+
+/* --- Baseline files --- */
+
+static size_t load_baseline(const char *path, PerfBaseline baseline[], const size_t capacity) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return SIZE_MAX;
+    }
+    size_t count = 0;
+    char line[256];
+    while (count < capacity && fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (sscanf(line, "%63s %lf", baseline[count].name, &baseline[count].median_ns) == 2) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+
+static int save_baseline(const char *path, const PerfCase cases[], const size_t count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 0;
+    }
+    fprintf(file, "# aes_blake_perf baseline: case and median nanoseconds per call\n");
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%s %.3f\n", cases[i].name, cases[i].median_ns);
+    }
+    return fclose(file) == 0;
+}
+
+
+/*
+ * Prints every case next to its baseline and returns the number of cases
+ * slower than the baseline by more than `threshold` percent.
+ */
+static size_t compare_baseline(
+        const PerfCase cases[],
+        const size_t count,
+        const PerfBaseline baseline[],
+        const size_t baseline_count,
+        const double threshold
+) {
+    size_t regressions = 0;
+    fprintf(stderr, "%-42s %12s %12s %9s\n", "case", "median ns", "baseline ns", "change");
+    for (size_t i = 0; i < count; i++) {
+        const PerfBaseline *base = NULL;
+        for (size_t j = 0; j < baseline_count && base == NULL; j++) {
+            base = strcmp(baseline[j].name, cases[i].name) == 0 ? &baseline[j] : NULL;
+        }
+        if (base == NULL || base->median_ns <= 0) {
+            fprintf(stderr, "%-42s %12.1f %12s %9s  new\n", cases[i].name, cases[i].median_ns, "-", "-");
+            continue;
+        }
+        const double change = (cases[i].median_ns / base->median_ns - 1) * 100;
+        const int regressed = change > threshold;
+        regressions += regressed;
+        fprintf(
+            stderr, "%-42s %12.1f %12.1f %+8.1f%%%s\n", cases[i].name, cases[i].median_ns, base->median_ns, change,
+            regressed ? "  REGRESSION" : ""
+        );
+    }
+    return regressions;
+}
+
+
+static int parse_options(const int argc, char **argv, PerfOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return 0;
+        }
+        if (strcmp(arg, "--baseline") == 0) {
+            options->baseline_path = value;
+        } else if (strcmp(arg, "--record") == 0) {
+            options->record_path = value;
+        } else if (strcmp(arg, "--threshold") == 0) {
+            options->threshold = strtod(value, NULL);
+        } else if (strcmp(arg, "--samples") == 0) {
+            options->samples = (size_t)strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "--sample-ms") == 0) {
+            options->sample_ms = strtod(value, NULL);
+        } else if (strcmp(arg, "--cpu") == 0) {
+            options->cpu = atoi(value);
+        } else if (strcmp(arg, "--filter") == 0) {
+            options->filter = value;
+        } else {
+            return 0;
+        }
+        i++;
+    }
+    return options->samples > 0 && options->samples <= PERF_MAX_SAMPLES && options->threshold >= 0
+        && options->sample_ms > 0 && options->cpu >= 0;
+}
+
+
+int main(const int argc, char **argv) {
+    PerfOptions options = {NULL, NULL, 10.0, 25, 2.0, 0, NULL};
+    if (!parse_options(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--baseline <path>] [--record <path>] [--threshold 10] [--samples 25] "
+                        "[--sample-ms 2] [--cpu 0] [--filter <text>]\n", argv[0]);
+        return 2;
+    }
+    if (!pin_cpu(options.cpu)) {
+        fprintf(stderr, "warning: could not pin to cpu%d, samples may migrate between cores\n", options.cpu);
+    }
+    check_governor(options.cpu);
+    init_inputs();
+
+    static PerfCase cases[PERF_MAX_CASES];
+    size_t case_count = 0;
+    add_blake_cases(cases, &case_count);
+    add_aes_cases(cases, &case_count);
+
+    // Warm up the clock and caches before the first measured case
+    const double warmup_end = now_seconds() + 0.2;
+    while (now_seconds() < warmup_end) {
+        cases[0].run(&cases[0]);
+    }
+
+    size_t measured = 0;
+    for (size_t i = 0; i < case_count; i++) {
+        if (options.filter != NULL && strstr(cases[i].name, options.filter) == NULL) {
+            continue;
+        }
+        aes_set_backend(cases[i].backend);
+        cases[i].median_ns = measure_median(&cases[i], options.samples, options.sample_ms);
+        cases[measured++] = cases[i];
+    }
+    aes_set_backend(NULL);
+
+    static PerfBaseline baseline[PERF_MAX_CASES * 2];
+    size_t baseline_count = SIZE_MAX;
+    if (options.baseline_path != NULL) {
+        baseline_count = load_baseline(options.baseline_path, baseline, sizeof(baseline) / sizeof(baseline[0]));
+    }
+    const size_t regressions = compare_baseline(
+        cases, measured, baseline, baseline_count == SIZE_MAX ? 0 : baseline_count, options.threshold
+    );
+
+    const char *record_path = options.record_path;
+    if (record_path == NULL && options.baseline_path != NULL && baseline_count == SIZE_MAX) {
+        record_path = options.baseline_path;
+    }
+    if (record_path != NULL) {
+        if (!save_baseline(record_path, cases, measured)) {
+            return 1;
+        }
+        fprintf(stderr, "recorded %zu cases to %s\n", measured, record_path);
+        return 0;
+    }
+    if (regressions > 0) {
+        fprintf(stderr, "%zu of %zu cases regressed by more than %.1f%%\n", regressions, measured, options.threshold);
+        return 1;
+    }
+    return 0;
+}
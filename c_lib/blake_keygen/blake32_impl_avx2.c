@@ -0,0 +1,447 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "blake_internals.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+#define SHUFFLE_PS(a, b, imm) \
+    _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), (imm)))
+
+
+/*
+ * Same row layout as the SSE4.1 version, with key stream #1 in the low
+ * 128-bit lane of every register and key stream #2 in the high lane.
+ * The message rows hold the same knc words in both lanes.
+ */
+static inline AVX2_TARGET __m256i rotr16(const __m256i x) {
+    const __m256i mask = _mm256_setr_epi8(
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+    );
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+
+static inline AVX2_TARGET __m256i rotr8(const __m256i x) {
+    const __m256i mask = _mm256_setr_epi8(
+        1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+        1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+    );
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+
+static inline AVX2_TARGET __m256i rotr12(const __m256i x) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, 12), _mm256_slli_epi32(x, 20));
+}
+
+
+static inline AVX2_TARGET __m256i rotr7(const __m256i x) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, 7), _mm256_slli_epi32(x, 25));
+}
+
+
+static inline AVX2_TARGET void g_mix_rows(
+        __m256i *r0,
+        __m256i *r1,
+        __m256i *r2,
+        __m256i *r3,
+        const __m256i mx,
+        const __m256i my
+) {
+    *r0 = _mm256_add_epi32(_mm256_add_epi32(*r0, *r1), mx);
+    *r3 = rotr16(_mm256_xor_si256(*r3, *r0));
+    *r2 = _mm256_add_epi32(*r2, *r3);
+    *r1 = rotr12(_mm256_xor_si256(*r1, *r2));
+
+    *r0 = _mm256_add_epi32(_mm256_add_epi32(*r0, *r1), my);
+    *r3 = rotr8(_mm256_xor_si256(*r3, *r0));
+    *r2 = _mm256_add_epi32(*r2, *r3);
+    *r1 = rotr7(_mm256_xor_si256(*r1, *r2));
+}
+
+
+static inline AVX2_TARGET void mix_rows(__m256i r[4], const __m256i m[4]) {
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(2, 0, 2, 0)),
+        SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(3, 1, 3, 1))
+    );
+
+    r[1] = _mm256_shuffle_epi32(r[1], _MM_SHUFFLE(0, 3, 2, 1));
+    r[2] = _mm256_shuffle_epi32(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_shuffle_epi32(r[3], _MM_SHUFFLE(2, 1, 0, 3));
+
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(2, 0, 2, 0)),
+        SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(3, 1, 3, 1))
+    );
+
+    r[1] = _mm256_shuffle_epi32(r[1], _MM_SHUFFLE(2, 1, 0, 3));
+    r[2] = _mm256_shuffle_epi32(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_shuffle_epi32(r[3], _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+
+static inline AVX2_TARGET void permute_rows(__m256i m[4]) {
+    const __m256i p0 = SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(2, 2, 2, 2));
+    const __m256i q0 = SHUFFLE_PS(m[0], m[2], _MM_SHUFFLE(2, 2, 3, 3));
+    const __m256i p1 = SHUFFLE_PS(m[1], m[0], _MM_SHUFFLE(0, 0, 3, 3));
+    const __m256i q1 = SHUFFLE_PS(m[1], m[3], _MM_SHUFFLE(1, 1, 0, 0));
+    const __m256i p2 = SHUFFLE_PS(m[0], m[2], _MM_SHUFFLE(3, 3, 1, 1));
+    const __m256i q2 = SHUFFLE_PS(m[3], m[1], _MM_SHUFFLE(1, 1, 0, 0));
+    const __m256i p3 = SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(2, 2, 1, 1));
+    const __m256i q3 = SHUFFLE_PS(m[3], m[2], _MM_SHUFFLE(0, 0, 3, 3));
+
+    m[0] = SHUFFLE_PS(p0, q0, _MM_SHUFFLE(2, 0, 2, 0));
+    m[1] = SHUFFLE_PS(p1, q1, _MM_SHUFFLE(2, 0, 2, 0));
+    m[2] = SHUFFLE_PS(p2, q2, _MM_SHUFFLE(2, 0, 2, 0));
+    m[3] = SHUFFLE_PS(p3, q3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+
+static inline AVX2_TARGET __m256i load_lanes(const uint32_t lo[4], const uint32_t hi[4]) {
+    return _mm256_loadu2_m128i((const __m128i *)hi, (const __m128i *)lo);
+}
+
+
+/*
+ * AVX2 version of `blake32_optimized_derive_keys`. Each 256-bit row carries
+ * the same row of both key streams, so every vector operation advances the
+ * two streams together and the knc is permuted only once per round.
+ */
+AVX2_TARGET void blake32_avx2_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    const __m256i bswap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+    );
+    const __m256i ctr_low = _mm256_set1_epi32((int)(uint32_t)block_counter);
+    const __m256i ctr_high = _mm256_set1_epi32((int)(uint32_t)(block_counter >> 32));
+    const __m256i d_mask = _mm256_set1_epi32((int)blake32_get_domain_mask(domain));
+
+    __m256i r[4], mr[4];
+    r[0] = load_lanes(IV32, IV32);
+    r[1] = _mm256_add_epi32(load_lanes(init_state, init_state + 4), ctr_low);
+    r[2] = _mm256_add_epi32(load_lanes(init_state + 8, init_state + 12), ctr_high);
+    r[3] = _mm256_xor_si256(load_lanes(IV32 + 4, IV32 + 4), d_mask);
+
+    for (int i = 0; i < 4; i++) {
+        mr[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(knc + 4 * i)));
+    }
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_rows(r, mr);
+
+        const __m256i keys = _mm256_shuffle_epi8(r[1], bswap);
+        _mm_storeu_si128((__m128i *)out_keys1[round], _mm256_castsi256_si128(keys));
+        _mm_storeu_si128((__m128i *)out_keys2[round], _mm256_extracti128_si256(keys, 1));
+
+        if (round + 1 < key_count) {
+            permute_rows(mr);
+        }
+    }
+}
+
+
+
+/*
+ * Counter-parallel layout used by `blake32_avx2_derive_keys_many`: vector v[w]
+ * holds state word w of eight independent states, lanes 0..3 being stream #1
+ * of four slots and lanes 4..7 stream #2 of the same slots. A slot is one block
+ * counter and the message words are vectors, so every slot may use its own knc.
+ */
+#define MANY_COUNTERS 4
+
+static inline AVX2_TARGET void g_mix_lanes(
+        __m256i v[16],
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const __m256i mx,
+        const __m256i my
+) {
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), mx);
+    v[d] = rotr16(_mm256_xor_si256(v[d], v[a]));
+    v[c] = _mm256_add_epi32(v[c], v[d]);
+    v[b] = rotr12(_mm256_xor_si256(v[b], v[c]));
+
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), my);
+    v[d] = rotr8(_mm256_xor_si256(v[d], v[a]));
+    v[c] = _mm256_add_epi32(v[c], v[d]);
+    v[b] = rotr7(_mm256_xor_si256(v[b], v[c]));
+}
+
+
+static inline AVX2_TARGET void mix_lanes(__m256i v[16], const __m256i m[16]) {
+    g_mix_lanes(v, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, 3, 4,  9, 14, m[14], m[15]);
+}
+
+
+static inline AVX2_TARGET void permute_lanes(__m256i m[16]) {
+    __m256i t[16];
+    for (int i = 0; i < 16; i++) {
+        t[i] = m[MSG_PERMUTATION[i]];
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = t[i];
+    }
+}
+
+
+/*
+ * Loads the states and message words of one pass. Slot j of the pass, which
+ * fills lanes j and j + 4, has its own init state, counter, domain mask and knc.
+ */
+static inline AVX2_TARGET void init_lanes(
+        __m256i v[16],
+        __m256i m[16],
+        const uint32_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint32_t d_masks[MANY_COUNTERS],
+        const uint32_t *kncs[MANY_COUNTERS]
+) {
+    uint32_t words[12][8];
+    uint32_t m_words[16][8];
+    for (int lane = 0; lane < 8; lane++) {
+        const int slot = lane % MANY_COUNTERS;
+        const uint64_t counter = counters[slot];
+        const uint32_t *entropy = lane < MANY_COUNTERS ? init_states[slot] : init_states[slot] + 4;
+        for (int w = 0; w < 4; w++) {
+            words[w][lane] = entropy[w] + (uint32_t)counter;
+            words[4 + w][lane] = entropy[8 + w] + (uint32_t)(counter >> 32);
+            words[8 + w][lane] = IV32[4 + w] ^ d_masks[slot];
+        }
+        for (int i = 0; i < 16; i++) {
+            m_words[i][lane] = kncs[slot][i];
+        }
+    }
+    for (int w = 0; w < 4; w++) {
+        v[w] = _mm256_set1_epi32((int)IV32[w]);
+        v[4 + w] = _mm256_loadu_si256((const __m256i *)words[w]);
+        v[8 + w] = _mm256_loadu_si256((const __m256i *)words[4 + w]);
+        v[12 + w] = _mm256_loadu_si256((const __m256i *)words[8 + w]);
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = _mm256_loadu_si256((const __m256i *)m_words[i]);
+    }
+}
+
+
+/*
+ * Transposes four state word vectors of all lanes, words 4..7 in the standard
+ * profile, into big-endian round keys. After the in-lane 4x4 transpose, key vector
+ * j holds counter j of stream #1 in its low half and counter j of stream #2 in its
+ * high half.
+ */
+static inline AVX2_TARGET void store_lane_keys(
+        uint8_t out_keys[][16],
+        const __m256i rows[4],
+        const uint8_t key_count,
+        const uint8_t round,
+        const size_t counters
+) {
+    const __m256i bswap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+    );
+    const __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    const __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    const __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    const __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+
+    __m256i keys[4];
+    keys[0] = _mm256_unpacklo_epi64(t0, t2);
+    keys[1] = _mm256_unpackhi_epi64(t0, t2);
+    keys[2] = _mm256_unpacklo_epi64(t1, t3);
+    keys[3] = _mm256_unpackhi_epi64(t1, t3);
+
+    for (size_t j = 0; j < counters; j++) {
+        const __m256i k = _mm256_shuffle_epi8(keys[j], bswap);
+        _mm_storeu_si128((__m128i *)out_keys[(2 * j) * key_count + round], _mm256_castsi256_si128(k));
+        _mm_storeu_si128((__m128i *)out_keys[(2 * j + 1) * key_count + round], _mm256_extracti128_si256(k, 1));
+    }
+}
+
+
+static AVX2_TARGET void derive_pass(
+        const uint32_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint32_t d_masks[MANY_COUNTERS],
+        const uint32_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m256i v[16], m[16];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, &v[4], key_count, round, slots);
+        if (round + 1 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+
+/*
+ * Reduced profile version of `derive_pass`, see `blake32_clean_derive_keys_reduced`.
+ * The profile mask is already part of `d_masks`.
+ */
+static AVX2_TARGET void derive_pass_reduced(
+        const uint32_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint32_t d_masks[MANY_COUNTERS],
+        const uint32_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m256i v[16], m[16], folded[4];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round += 2) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, &v[4], key_count, round, slots);
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = _mm256_xor_si256(v[w], v[8 + w]);
+            }
+            store_lane_keys(out_keys, folded, key_count, round + 1, slots);
+        }
+        if (round + 2 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+/*
+ * AVX2 version of `blake32_derive_keys_many`, four block counters per pass.
+ */
+AVX2_TARGET void blake32_avx2_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint32_t d_masks[MANY_COUNTERS];
+    const uint32_t *kncs[MANY_COUNTERS];
+    const uint32_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake32_get_domain_mask(domain);
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 2 * key_count]);
+    }
+}
+
+
+/*
+ * AVX2 version of `blake32_derive_keys_jobs`, four jobs per pass.
+ */
+AVX2_TARGET void blake32_avx2_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint32_t d_masks[MANY_COUNTERS];
+    const uint32_t *kncs[MANY_COUNTERS];
+    const uint32_t *init_states[MANY_COUNTERS];
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (size_t j = 0; j < MANY_COUNTERS; j++) {
+            const Blake32KeyJob *job = &jobs[done + (j < slots ? j : 0)];
+            counters[j] = job->counter;
+            d_masks[j] = blake32_get_domain_mask(job->domain);
+            kncs[j] = job->knc;
+            init_states[j] = job->init_state != NULL ? job->init_state : init_state;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 2 * key_count]);
+    }
+}
+
+/*
+ * AVX2 version of `blake32_derive_keys_many_reduced`, four block counters per pass.
+ */
+AVX2_TARGET void blake32_avx2_derive_keys_many_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint32_t d_masks[MANY_COUNTERS];
+    const uint32_t *kncs[MANY_COUNTERS];
+    const uint32_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake32_get_domain_mask(domain) ^ BLAKE32_REDUCED_V1_MASK;
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass_reduced(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 2 * key_count]);
+    }
+}
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "blake_internals.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+#else
+#define AVX512_TARGET
+#endif
+
+#define MANY_COUNTERS 8
+
+
+/*
+ * Counter-parallel layout used by `blake32_avx512_derive_keys_many`: vector v[w]
+ * holds state word w of sixteen independent states. Each 128-bit chunk q covers
+ * four consecutive counters, chunks 0 and 2 of stream #1 and chunks 1 and 3 of
+ * stream #2, with chunks 2 and 3 four counters further than chunks 0 and 1.
+ */
+static inline AVX512_TARGET void g_mix_lanes(
+        __m512i v[16],
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const __m512i mx,
+        const __m512i my
+) {
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), mx);
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 16);
+    v[c] = _mm512_add_epi32(v[c], v[d]);
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 12);
+
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), my);
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 8);
+    v[c] = _mm512_add_epi32(v[c], v[d]);
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 7);
+}
+
+
+static inline AVX512_TARGET void mix_lanes(__m512i v[16], const __m512i m[16]) {
+    g_mix_lanes(v, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, 3, 4,  9, 14, m[14], m[15]);
+}
+
+
+static inline AVX512_TARGET void permute_lanes(__m512i m[16]) {
+    __m512i t[16];
+    for (int i = 0; i < 16; i++) {
+        t[i] = m[MSG_PERMUTATION[i]];
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = t[i];
+    }
+}
+
+
+static inline size_t lane_counter(const int chunk, const int j) {
+    return (size_t)(chunk >> 1) * 4 + (size_t)j;
+}
+
+
+/*
+ * Loads the states and message words of one pass, every slot (counter) having
+ * its own init state, counter, domain mask and knc.
+ */
+static inline AVX512_TARGET void init_lanes(
+        __m512i v[16],
+        __m512i m[16],
+        const uint32_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint32_t d_masks[MANY_COUNTERS],
+        const uint32_t *kncs[MANY_COUNTERS]
+) {
+    uint32_t words[12][16];
+    uint32_t m_words[16][16];
+    for (int lane = 0; lane < 16; lane++) {
+        const int chunk = lane >> 2;
+        const size_t slot = lane_counter(chunk, lane & 3);
+        const uint64_t counter = counters[slot];
+        const uint32_t *entropy = chunk & 1 ? init_states[slot] + 4 : init_states[slot];
+        for (int w = 0; w < 4; w++) {
+            words[w][lane] = entropy[w] + (uint32_t)counter;
+            words[4 + w][lane] = entropy[8 + w] + (uint32_t)(counter >> 32);
+            words[8 + w][lane] = IV32[4 + w] ^ d_masks[slot];
+        }
+        for (int i = 0; i < 16; i++) {
+            m_words[i][lane] = kncs[slot][i];
+        }
+    }
+    for (int w = 0; w < 4; w++) {
+        v[w] = _mm512_set1_epi32((int)IV32[w]);
+        v[4 + w] = _mm512_loadu_si512(words[w]);
+        v[8 + w] = _mm512_loadu_si512(words[4 + w]);
+        v[12 + w] = _mm512_loadu_si512(words[8 + w]);
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = _mm512_loadu_si512(m_words[i]);
+    }
+}
+
+
+static inline AVX512_TARGET __m128i key_chunk(const __m512i keys, const int chunk) {
+    switch (chunk) {
+        case 1:  return _mm512_extracti32x4_epi32(keys, 1);
+        case 2:  return _mm512_extracti32x4_epi32(keys, 2);
+        case 3:  return _mm512_extracti32x4_epi32(keys, 3);
+        default: return _mm512_castsi512_si128(keys);
+    }
+}
+
+
+/*
+ * Transposes state words 4..7 of all lanes into big-endian round keys,
+ * key vector j holding lane j of every 128-bit chunk.
+ */
+static inline AVX512_TARGET void store_lane_keys(
+        uint8_t out_keys[][16],
+        const __m512i v[16],
+        const uint8_t key_count,
+        const uint8_t round,
+        const size_t counters
+) {
+    const __m512i bswap = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+    );
+    const __m512i t0 = _mm512_unpacklo_epi32(v[4], v[5]);
+    const __m512i t1 = _mm512_unpackhi_epi32(v[4], v[5]);
+    const __m512i t2 = _mm512_unpacklo_epi32(v[6], v[7]);
+    const __m512i t3 = _mm512_unpackhi_epi32(v[6], v[7]);
+
+    __m512i keys[4];
+    keys[0] = _mm512_shuffle_epi8(_mm512_unpacklo_epi64(t0, t2), bswap);
+    keys[1] = _mm512_shuffle_epi8(_mm512_unpackhi_epi64(t0, t2), bswap);
+    keys[2] = _mm512_shuffle_epi8(_mm512_unpacklo_epi64(t1, t3), bswap);
+    keys[3] = _mm512_shuffle_epi8(_mm512_unpackhi_epi64(t1, t3), bswap);
+
+    for (int chunk = 0; chunk < 4; chunk++) {
+        for (int j = 0; j < 4; j++) {
+            const size_t counter = lane_counter(chunk, j);
+            if (counter < counters) {
+                const size_t stream = (size_t)(chunk & 1);
+                _mm_storeu_si128(
+                    (__m128i *)out_keys[(2 * counter + stream) * key_count + round],
+                    key_chunk(keys[j], chunk)
+                );
+            }
+        }
+    }
+}
+
+
+static AVX512_TARGET void derive_pass(
+        const uint32_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint32_t d_masks[MANY_COUNTERS],
+        const uint32_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m512i v[16], m[16];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, v, key_count, round, slots);
+        if (round + 1 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+
+/*
+ * AVX-512 version of `blake32_derive_keys_many`, eight block counters per pass.
+ */
+AVX512_TARGET void blake32_avx512_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint32_t d_masks[MANY_COUNTERS];
+    const uint32_t *kncs[MANY_COUNTERS];
+    const uint32_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake32_get_domain_mask(domain);
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 2 * key_count]);
+    }
+}
+
+
+/*
+ * AVX-512 version of `blake32_derive_keys_jobs`, eight jobs per pass.
+ */
+AVX512_TARGET void blake32_avx512_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint32_t d_masks[MANY_COUNTERS];
+    const uint32_t *kncs[MANY_COUNTERS];
+    const uint32_t *init_states[MANY_COUNTERS];
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (size_t j = 0; j < MANY_COUNTERS; j++) {
+            const Blake32KeyJob *job = &jobs[done + (j < slots ? j : 0)];
+            counters[j] = job->counter;
+            d_masks[j] = blake32_get_domain_mask(job->domain);
+            kncs[j] = job->knc;
+            init_states[j] = job->init_state != NULL ? job->init_state : init_state;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 2 * key_count]);
+    }
+}
+
+#endif
@@ -111,7 +111,7 @@ void blake32_clean_compute_knc(
 void blake32_clean_digest_context(
         uint32_t state[16],
         const uint32_t key[8],
-        uint32_t context[8]
+        uint32_t context[16]
 ) {
     blake32_init_state_vector(state, key, 0, KDFDomain_CTX);
     for (int i = 0; i < 9; i++) {
@@ -221,3 +221,87 @@ void blake32_clean_derive_keys(
         out_keys2
     );
 }
+
+
+/*
+ * Writes four state words as a big-endian 128-bit round key.
+ */
+static void store_round_key(uint8_t out_key[16], const uint32_t words[4]) {
+    for (int w = 0; w < 4; w++) {
+        const uint32_t v = words[w];
+        out_key[4*w + 0] = (uint8_t)(v >> 24);
+        out_key[4*w + 1] = (uint8_t)(v >> 16);
+        out_key[4*w + 2] = (uint8_t)(v >>  8);
+        out_key[4*w + 3] = (uint8_t)(v      );
+    }
+}
+
+
+/*
+ * Reduced profile version of `compute_round_keys`. Every mix step yields two
+ * round keys: the even key from state_buf[4..7] as in the standard profile and
+ * the odd key from the BLAKE3 output fold state_buf[0..3] ^ state_buf[8..11],
+ * which leaves row 3 unexposed. Eleven keys take six mix steps instead of eleven.
+ */
+static void compute_round_keys_reduced(
+        const uint32_t entropy[8],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint32_t state_buf[16];
+    uint32_t knc_local[16];
+    uint32_t folded[4];
+
+    for (int i = 0; i < 16; i++) {
+        knc_local[i] = knc[i];
+    }
+
+    blake32_init_state_vector(state_buf, entropy, block_counter, domain);
+    for (int i = 12; i < 16; i++) {
+        state_buf[i] ^= BLAKE32_REDUCED_V1_MASK;
+    }
+
+    for (size_t round = 0; round < key_count; round += 2) {
+        blake32_clean_mix_state(state_buf, knc_local);
+        store_round_key(out_keys[round], &state_buf[4]);
+
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = state_buf[w] ^ state_buf[8 + w];
+            }
+            store_round_key(out_keys[round + 1], folded);
+        }
+        if (round + 2 < key_count) {
+            blake32_clean_permute(knc_local);
+        }
+    }
+}
+
+
+/*
+ * Reference implementation of version 1 of the reduced keygen profile, with the
+ * same arguments and output layout as `blake32_clean_derive_keys`. It is not
+ * interchangeable with the standard profile, every key it derives is different.
+ */
+void blake32_clean_derive_keys_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    uint32_t entropy1[8], entropy2[8];
+    for (int i = 0; i < 4; i++) {
+        entropy1[i]      = init_state[i];
+        entropy2[i]      = init_state[4 + i];
+        entropy1[4 + i]  = init_state[8 + i];
+        entropy2[4 + i]  = init_state[12 + i];
+    }
+    compute_round_keys_reduced(entropy1, knc, key_count, block_counter, domain, out_keys1);
+    compute_round_keys_reduced(entropy2, knc, key_count, block_counter, domain, out_keys2);
+}
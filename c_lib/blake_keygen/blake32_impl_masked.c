@@ -0,0 +1,378 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "csprng.h"
+
+
+/*
+ * First-order masked Blake32 key derivation. Every state and message word is
+ * split into a masked value and its mask. Rows 0 and 2 of the state and the
+ * message are masked arithmetically, value = x + mask, so that additions act
+ * on each share separately. Rows 1 and 3 are masked with XOR, value = x ^ mask,
+ * so that XOR and rotation act on each share separately. Where the G function
+ * mixes the two, the operand is converted with Goubin's first-order algorithms,
+ * the equivalents of `btoa` and `atob` of the masked Python reference. Each
+ * conversion keeps the mask and takes one fresh random word.
+ *
+ * Both Blake instances of a derive_keys call run in the lanes of one row
+ * vector, lane `4 * i + c` holds column `c` of instance `i`, so that every
+ * step of the round function is a loop the compiler turns into SIMD code.
+ * The random words of a whole mix_state are drawn in one batch from the
+ * buffered CSPRNG of the calling thread.
+ */
+#define MASKED_LANES 8
+#define STREAMS 2
+#define WORD_BITS 32
+
+/* Four conversions to each domain per G step, a column and a diagonal step per mix */
+#define STEP_CONVERSIONS 8
+#define MIX_RANDOM_WORDS (2 * STEP_CONVERSIONS * MASKED_LANES)
+
+
+/* Share 0 holds the masked values and share 1 the masks */
+typedef uint32_t MaskedRow[2][MASKED_LANES];
+
+
+static inline void row_xor(MaskedRow out, const MaskedRow a, const MaskedRow b) {
+    for (int s = 0; s < 2; s++) {
+        for (int l = 0; l < MASKED_LANES; l++) {
+            out[s][l] = a[s][l] ^ b[s][l];
+        }
+    }
+}
+
+
+static inline void row_add(MaskedRow out, const MaskedRow a, const MaskedRow b) {
+    for (int s = 0; s < 2; s++) {
+        for (int l = 0; l < MASKED_LANES; l++) {
+            out[s][l] = a[s][l] + b[s][l];
+        }
+    }
+}
+
+
+static inline void row_rotr(MaskedRow x, const int n) {
+    for (int s = 0; s < 2; s++) {
+        for (int l = 0; l < MASKED_LANES; l++) {
+            x[s][l] = x[s][l] >> n | x[s][l] << (WORD_BITS - n);
+        }
+    }
+}
+
+
+/*
+ * Goubin's arithmetic to Boolean conversion: turns A = x - r into x ^ r without
+ * computing x. The carries of A + r are formed from a random word instead.
+ */
+static inline void to_boolean(MaskedRow out, const MaskedRow in, const uint32_t **rand) {
+    const uint32_t *gamma = *rand;
+    for (int l = 0; l < MASKED_LANES; l++) {
+        const uint32_t A = in[0][l];
+        const uint32_t r = in[1][l];
+        uint32_t g = gamma[l];
+        uint32_t T = g << 1;
+        uint32_t x = g ^ r;
+        uint32_t omega = g & x;
+        x = T ^ A;
+        g ^= x;
+        g &= r;
+        omega ^= g;
+        g = T & A;
+        omega ^= g;
+        for (int k = 1; k < WORD_BITS; k++) {
+            g = T & r;
+            g ^= omega;
+            T &= A;
+            g ^= T;
+            T = g << 1;
+        }
+        out[0][l] = x ^ T;
+        out[1][l] = r;
+    }
+    *rand = gamma + MASKED_LANES;
+}
+
+
+/*
+ * Goubin's Boolean to arithmetic conversion: turns x ^ r into x - r, using
+ * that (x ^ r) - r is affine in r over GF(2).
+ */
+static inline void to_arithmetic(MaskedRow out, const MaskedRow in, const uint32_t **rand) {
+    const uint32_t *gamma = *rand;
+    for (int l = 0; l < MASKED_LANES; l++) {
+        const uint32_t x = in[0][l];
+        const uint32_t r = in[1][l];
+        uint32_t g = gamma[l];
+        uint32_t T = x ^ g;
+        T -= g;
+        T ^= x;
+        g ^= r;
+        uint32_t A = x ^ g;
+        A -= g;
+        out[0][l] = A ^ T;
+        out[1][l] = r;
+    }
+    *rand = gamma + MASKED_LANES;
+}
+
+
+static void masked_gmix(MaskedRow rows[4], const MaskedRow mx, const MaskedRow my, const uint32_t **rand) {
+    MaskedRow t;
+
+    /* First mixing round */
+    to_arithmetic(t, rows[1], rand);
+    row_add(rows[0], rows[0], t);
+    row_add(rows[0], rows[0], mx);
+    to_boolean(t, rows[0], rand);
+    row_xor(rows[3], rows[3], t);
+    row_rotr(rows[3], 16);
+    to_arithmetic(t, rows[3], rand);
+    row_add(rows[2], rows[2], t);
+    to_boolean(t, rows[2], rand);
+    row_xor(rows[1], rows[1], t);
+    row_rotr(rows[1], 12);
+
+    /* Second mixing round */
+    to_arithmetic(t, rows[1], rand);
+    row_add(rows[0], rows[0], t);
+    row_add(rows[0], rows[0], my);
+    to_boolean(t, rows[0], rand);
+    row_xor(rows[3], rows[3], t);
+    row_rotr(rows[3], 8);
+    to_arithmetic(t, rows[3], rand);
+    row_add(rows[2], rows[2], t);
+    to_boolean(t, rows[2], rand);
+    row_xor(rows[1], rows[1], t);
+    row_rotr(rows[1], 7);
+}
+
+
+/*
+ * Rotates row `r` of every instance left by `r * shift` columns, which moves
+ * the diagonals into the columns and back again.
+ */
+static void rotate_columns(MaskedRow rows[4], const int shift) {
+    for (int r = 1; r < 4; r++) {
+        MaskedRow tmp;
+        for (int s = 0; s < 2; s++) {
+            for (int l = 0; l < MASKED_LANES; l++) {
+                const int base = l & ~3;
+                tmp[s][l] = rows[r][s][base + ((l + r * shift) & 3)];
+            }
+        }
+        for (int s = 0; s < 2; s++) {
+            for (int l = 0; l < MASKED_LANES; l++) {
+                rows[r][s][l] = tmp[s][l];
+            }
+        }
+    }
+}
+
+
+/*
+ * Broadcasts message words `first + 2 * c` and `first + 2 * c + 1` of the
+ * masked message to column `c` of every instance.
+ */
+static void load_message_rows(MaskedRow mx, MaskedRow my, const uint32_t m[2][16], const int first) {
+    for (int s = 0; s < 2; s++) {
+        for (int l = 0; l < MASKED_LANES; l++) {
+            mx[s][l] = m[s][first + 2 * (l & 3)];
+            my[s][l] = m[s][first + 2 * (l & 3) + 1];
+        }
+    }
+}
+
+
+static void masked_mix_state(MaskedRow rows[4], const uint32_t m[2][16]) {
+    uint32_t random_words[MIX_RANDOM_WORDS];
+    const uint32_t *rand = random_words;
+    MaskedRow mx, my;
+
+    csprng_fill((uint8_t *)random_words, sizeof(random_words));
+
+    // columnar mixing
+    load_message_rows(mx, my, m, 0);
+    masked_gmix(rows, mx, my, &rand);
+    // diagonal mixing
+    rotate_columns(rows, 1);
+    load_message_rows(mx, my, m, 8);
+    masked_gmix(rows, mx, my, &rand);
+    rotate_columns(rows, 3);
+}
+
+
+static void masked_permute(uint32_t m[2][16]) {
+    for (int s = 0; s < 2; s++) {
+        uint32_t tmp[16];
+        for (int i = 0; i < 16; i++) {
+            tmp[i] = m[s][MSG_PERMUTATION[i]];
+        }
+        for (int i = 0; i < 16; i++) {
+            m[s][i] = tmp[i];
+        }
+    }
+}
+
+
+/*
+ * Masks the plain words with fresh random masks, arithmetically or with XOR.
+ */
+static void mask_words(uint32_t masked[], uint32_t masks[], const uint32_t plain[], const size_t count, const int arithmetic) {
+    csprng_fill((uint8_t *)masks, count * sizeof(uint32_t));
+    for (size_t i = 0; i < count; i++) {
+        masked[i] = arithmetic ? plain[i] - masks[i] : plain[i] ^ masks[i];
+    }
+}
+
+
+/*
+ * Loads the initial state of both instances in masked form. Rows 0 and 3 are
+ * public constants. The entropy words of rows 1 and 2 are masked arithmetically
+ * before the block counter is added to the masked share, and row 1 is then
+ * converted to the Boolean domain, so the state of a counter is never formed
+ * unmasked. Only `init_state` itself arrives unmasked from the key object.
+ */
+static void load_masked_state(
+        MaskedRow rows[4],
+        const uint32_t init_state[16],
+        const uint64_t block_counter,
+        const KDFDomain domain
+) {
+    uint32_t masks[4][MASKED_LANES], gamma[MASKED_LANES];
+    const uint32_t *rand = gamma;
+    const uint32_t ctr_low  = (uint32_t)(block_counter & 0xFFFFFFFFu);
+    const uint32_t ctr_high = (uint32_t)(block_counter >> 32 & 0xFFFFFFFFu);
+    const uint32_t d_mask = blake32_get_domain_mask(domain);
+    MaskedRow row1;
+
+    csprng_fill((uint8_t *)masks, sizeof(masks));
+    csprng_fill((uint8_t *)gamma, sizeof(gamma));
+    for (int l = 0; l < MASKED_LANES; l++) {
+        const int inst = l / 4;
+        const int c = l % 4;
+        rows[0][0][l] = IV32[c] - masks[0][l];
+        rows[0][1][l] = masks[0][l];
+        row1[0][l] = init_state[4 * inst + c] - masks[1][l] + ctr_low;
+        row1[1][l] = masks[1][l];
+        rows[2][0][l] = init_state[8 + 4 * inst + c] - masks[2][l] + ctr_high;
+        rows[2][1][l] = masks[2][l];
+        rows[3][0][l] = (IV32[4 + c] ^ d_mask) ^ masks[3][l];
+        rows[3][1][l] = masks[3][l];
+    }
+    to_boolean(rows[1], row1, &rand);
+}
+
+
+/*
+ * Writes the row 1 words of both instances to their round key slots, big endian.
+ */
+static void store_row_keys(uint8_t (*const out_keys[STREAMS])[16], const size_t round, const uint32_t words[MASKED_LANES]) {
+    for (int inst = 0; inst < 2; inst++) {
+        for (int w = 0; w < 4; w++) {
+            const uint32_t v = words[4 * inst + w];
+            out_keys[inst][round][4*w + 0] = (uint8_t)(v >> 24);
+            out_keys[inst][round][4*w + 1] = (uint8_t)(v >> 16);
+            out_keys[inst][round][4*w + 2] = (uint8_t)(v >>  8);
+            out_keys[inst][round][4*w + 3] = (uint8_t)(v      );
+        }
+    }
+}
+
+
+/*
+ * Runs the masked derivation of one block counter. Row 1 holds the round key
+ * of every round masked with XOR, its masked values go to `out_keys` and its
+ * masks to `out_masks`. With `out_masks` NULL the two are combined into plain
+ * round keys in `out_keys` instead.
+ */
+static void derive_masked(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t (*const out_keys[STREAMS])[16],
+        uint8_t (*const out_masks[STREAMS])[16]
+) {
+    uint32_t m[2][16];
+    MaskedRow rows[4];
+
+    load_masked_state(rows, init_state, block_counter, domain);
+    mask_words(m[0], m[1], knc, 16, 1);
+
+    for (size_t round = 0; round < key_count; round++) {
+        masked_mix_state(rows, (const uint32_t (*)[16])m);
+
+        if (out_masks == NULL) {
+            uint32_t plain[MASKED_LANES];
+            for (int l = 0; l < MASKED_LANES; l++) {
+                plain[l] = rows[1][0][l] ^ rows[1][1][l];
+            }
+            store_row_keys(out_keys, round, plain);
+        } else {
+            store_row_keys(out_keys, round, rows[1][0]);
+            store_row_keys(out_masks, round, rows[1][1]);
+        }
+
+        if (round + 1 < key_count) {
+            masked_permute(m);
+        }
+    }
+}
+
+
+/**
+ * Masked version of `blake32_clean_derive_keys` with the same signature and
+ * output. The state and the knc are masked as soon as they are loaded, only
+ * the finished round keys are written out unmasked.
+ */
+void blake32_masked_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    uint8_t (*const out_keys[STREAMS])[16] = {out_keys1, out_keys2};
+    derive_masked(init_state, knc, key_count, block_counter, domain, out_keys, NULL);
+}
+
+
+/**
+ * Derives the round keys of `n` consecutive block counters as two Boolean shares
+ * for `aes_encrypt_blocks_x2_masked_shares`. The masked round keys go to `out_keys`
+ * and their masks to `out_masks`, both in the layout of `blake32_derive_keys_many`,
+ * and the two are never combined.
+ */
+void blake32_masked_derive_key_shares(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16],
+        uint8_t out_masks[][16]
+) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * STREAMS * key_count];
+        uint8_t (*masks)[16] = &out_masks[i * STREAMS * key_count];
+        uint8_t (*const key_streams[STREAMS])[16] = {keys, &keys[key_count]};
+        uint8_t (*const mask_streams[STREAMS])[16] = {masks, &masks[key_count]};
+        derive_masked(init_state, knc, key_count, first_counter + i, domain, key_streams, mask_streams);
+    }
+}
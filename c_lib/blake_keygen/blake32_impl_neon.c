@@ -0,0 +1,213 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_ARM64)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <arm_neon.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+
+
+/*
+ * NEON is mandatory on AArch64, so these functions need no target attributes.
+ * The state is held as four row vectors, as in the SSE4.1 version.
+ */
+static inline uint32x4_t rotr16(const uint32x4_t x) {
+    return vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(x)));
+}
+
+
+static inline uint32x4_t rotr8(const uint32x4_t x) {
+    static const uint8_t mask[16] = {1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12};
+    return vreinterpretq_u32_u8(vqtbl1q_u8(vreinterpretq_u8_u32(x), vld1q_u8(mask)));
+}
+
+
+static inline uint32x4_t rotr12(const uint32x4_t x) {
+    return vsriq_n_u32(vshlq_n_u32(x, 20), x, 12);
+}
+
+
+static inline uint32x4_t rotr7(const uint32x4_t x) {
+    return vsriq_n_u32(vshlq_n_u32(x, 25), x, 7);
+}
+
+
+static inline void g_mix_rows(
+        uint32x4_t *r0,
+        uint32x4_t *r1,
+        uint32x4_t *r2,
+        uint32x4_t *r3,
+        const uint32x4_t mx,
+        const uint32x4_t my
+) {
+    *r0 = vaddq_u32(vaddq_u32(*r0, *r1), mx);
+    *r3 = rotr16(veorq_u32(*r3, *r0));
+    *r2 = vaddq_u32(*r2, *r3);
+    *r1 = rotr12(veorq_u32(*r1, *r2));
+
+    *r0 = vaddq_u32(vaddq_u32(*r0, *r1), my);
+    *r3 = rotr8(veorq_u32(*r3, *r0));
+    *r2 = vaddq_u32(*r2, *r3);
+    *r1 = rotr7(veorq_u32(*r1, *r2));
+}
+
+
+static inline void mix_rows(uint32x4_t r[4], const uint32x4_t m[4]) {
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3], vuzp1q_u32(m[0], m[1]), vuzp2q_u32(m[0], m[1]));
+
+    r[1] = vextq_u32(r[1], r[1], 1);
+    r[2] = vextq_u32(r[2], r[2], 2);
+    r[3] = vextq_u32(r[3], r[3], 3);
+
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3], vuzp1q_u32(m[2], m[3]), vuzp2q_u32(m[2], m[3]));
+
+    r[1] = vextq_u32(r[1], r[1], 3);
+    r[2] = vextq_u32(r[2], r[2], 2);
+    r[3] = vextq_u32(r[3], r[3], 1);
+}
+
+
+/*
+ * Message permutation as one 64-byte table lookup per output row.
+ */
+static inline void permute_rows(uint32x4_t m[4]) {
+    static const uint8_t index[4][16] = {
+        { 8,  9, 10, 11, 24, 25, 26, 27, 12, 13, 14, 15, 40, 41, 42, 43},
+        {28, 29, 30, 31,  0,  1,  2,  3, 16, 17, 18, 19, 52, 53, 54, 55},
+        { 4,  5,  6,  7, 44, 45, 46, 47, 48, 49, 50, 51, 20, 21, 22, 23},
+        {36, 37, 38, 39, 56, 57, 58, 59, 60, 61, 62, 63, 32, 33, 34, 35}
+    };
+    uint8x16x4_t table;
+    table.val[0] = vreinterpretq_u8_u32(m[0]);
+    table.val[1] = vreinterpretq_u8_u32(m[1]);
+    table.val[2] = vreinterpretq_u8_u32(m[2]);
+    table.val[3] = vreinterpretq_u8_u32(m[3]);
+
+    for (int i = 0; i < 4; i++) {
+        m[i] = vreinterpretq_u32_u8(vqtbl4q_u8(table, vld1q_u8(index[i])));
+    }
+}
+
+
+static inline void load_rows(uint32x4_t r[4], const uint32_t words[16]) {
+    for (int i = 0; i < 4; i++) {
+        r[i] = vld1q_u32(words + 4 * i);
+    }
+}
+
+
+static inline void store_rows(uint32_t words[16], const uint32x4_t r[4]) {
+    for (int i = 0; i < 4; i++) {
+        vst1q_u32(words + 4 * i, r[i]);
+    }
+}
+
+
+static inline void init_rows(
+        uint32x4_t r[4],
+        const uint32_t entropy_lo[4],
+        const uint32_t entropy_hi[4],
+        const uint64_t counter,
+        const KDFDomain domain
+) {
+    r[0] = vld1q_u32(IV32);
+    r[1] = vaddq_u32(vld1q_u32(entropy_lo), vdupq_n_u32((uint32_t)counter));
+    r[2] = vaddq_u32(vld1q_u32(entropy_hi), vdupq_n_u32((uint32_t)(counter >> 32)));
+    r[3] = veorq_u32(vld1q_u32(IV32 + 4), vdupq_n_u32(blake32_get_domain_mask(domain)));
+}
+
+
+static inline void store_round_key(uint8_t out_key[16], const uint32x4_t row1) {
+    vst1q_u8(out_key, vrev32q_u8(vreinterpretq_u8_u32(row1)));
+}
+
+
+/*
+ * NEON version of `blake32_optimized_mix_state`.
+ */
+void blake32_neon_mix_state(uint32_t state[16], const uint32_t m[16]) {
+    uint32x4_t r[4], mr[4];
+    load_rows(r, state);
+    load_rows(mr, m);
+    mix_rows(r, mr);
+    store_rows(state, r);
+}
+
+
+/*
+ * NEON version of `blake32_optimized_permute`.
+ */
+void blake32_neon_permute(uint32_t m[16]) {
+    uint32x4_t mr[4];
+    load_rows(mr, m);
+    permute_rows(mr);
+    store_rows(m, mr);
+}
+
+
+/*
+ * NEON version of `blake32_optimized_digest_context`.
+ */
+void blake32_neon_digest_context(
+        uint32_t state[16],
+        const uint32_t key[8],
+        uint32_t context[16]
+) {
+    uint32x4_t r[4], mr[4];
+    init_rows(r, key, key + 4, 0, KDFDomain_CTX);
+    load_rows(mr, context);
+
+    for (int round = 0; round < 10; round++) {
+        mix_rows(r, mr);
+        if (round < 9) {
+            permute_rows(mr);
+        }
+    }
+    store_rows(state, r);
+    store_rows(context, mr);
+}
+
+
+/*
+ * NEON version of `blake32_optimized_derive_keys`. Both key streams
+ * are mixed side by side and share one permuted copy of the knc.
+ */
+void blake32_neon_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    uint32x4_t r1[4], r2[4], mr[4];
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_rows(mr, knc);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_rows(r1, mr);
+        mix_rows(r2, mr);
+        store_round_key(out_keys1[round], r1[1]);
+        store_round_key(out_keys2[round], r2[1]);
+        if (round + 1 < key_count) {
+            permute_rows(mr);
+        }
+    }
+}
+
+#endif
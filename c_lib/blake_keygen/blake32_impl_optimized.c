@@ -233,7 +233,7 @@ void blake32_optimized_compute_knc(
 void blake32_optimized_digest_context(
         uint32_t state[16],
         const uint32_t key[8],
-        uint32_t context[8]
+        uint32_t context[16]
 ) {
     blake32_init_state_vector(state, key, 0, KDFDomain_CTX);
 
@@ -279,49 +279,110 @@ void blake32_optimized_digest_context(
 
 
 /*
- * derive_keys32 helper: Generates `key_count` 128‐bit round keys.
- *   - entropy[8]:     eight 32‐bit words
- *   - knc[16]:        precomputed key+nonce composite
- *   - key_count:      number of round keys to output
- *   - block_counter:  64‐bit counter for init_state_vector32
- *   - domain:         KDFDomain for domain separation
- *   - out_keys[][16]: output buffer for 128‐bit keys
+ * Structure-of-arrays layout of the portable keygen: v[w][lane] holds state word
+ * w of SOA_LANES independent states, so that every step of the mix is one loop
+ * over adjacent words, which the compiler turns into SIMD lanes. Lane 2c + e
+ * belongs to entropy half e (stream #1 or #2) of the c-th counter of the pass.
+ * All lanes share the knc, so it is permuted once per round for all of them.
  */
-static void compute_round_keys(
-        const uint32_t entropy[8],
+#define SOA_COUNTERS 4
+#define SOA_LANES    (2 * SOA_COUNTERS)
+
+
+static inline void g_mix_lanes(
+        uint32_t v[16][SOA_LANES],
+        const int lanes,
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const uint32_t mx,
+        const uint32_t my
+) {
+    for (int l = 0; l < lanes; l++) {
+        uint32_t va = v[a][l], vb = v[b][l], vc = v[c][l], vd = v[d][l];
+
+        va = va + vb + mx;
+        vd = rotr32(vd ^ va, 16);
+        vc = vc + vd;
+        vb = rotr32(vb ^ vc, 12);
+
+        va = va + vb + my;
+        vd = rotr32(vd ^ va, 8);
+        vc = vc + vd;
+        vb = rotr32(vb ^ vc, 7);
+
+        v[a][l] = va, v[b][l] = vb, v[c][l] = vc, v[d][l] = vd;
+    }
+}
+
+
+static inline void mix_lanes(uint32_t v[16][SOA_LANES], const int lanes, const uint32_t m[16]) {
+    g_mix_lanes(v, lanes, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, lanes, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, lanes, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, lanes, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, lanes, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, lanes, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, lanes, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, lanes, 3, 4,  9, 14, m[14], m[15]);
+}
+
+
+/*
+ * Writes state words 4..7 of lane `l` as a big-endian 128-bit round key.
+ */
+static inline void store_lane_key(uint8_t out_key[16], uint32_t v[16][SOA_LANES], const int l) {
+    for (int w = 0; w < 4; w++) {
+        out_key[4*w + 0] = (uint8_t)(v[4 + w][l] >> 24);
+        out_key[4*w + 1] = (uint8_t)(v[4 + w][l] >> 16);
+        out_key[4*w + 2] = (uint8_t)(v[4 + w][l] >>  8);
+        out_key[4*w + 3] = (uint8_t)(v[4 + w][l]      );
+    }
+}
+
+
+/*
+ * Derives the keys of `counters` consecutive block counters, at most SOA_COUNTERS.
+ * Each mix advances both streams of every counter, and the keys go straight from
+ * the lanes into the key arrays, out_keys[2c + s] of stream #s+1 of counter c.
+ */
+static inline void derive_lanes(
+        const uint32_t init_state[16],
         const uint32_t knc[16],
         const uint8_t key_count,
-        const uint64_t block_counter,
+        const uint64_t first_counter,
+        const int counters,
         const KDFDomain domain,
-        uint8_t out_keys[][16]
+        uint8_t (*const out_keys[SOA_LANES])[16]
 ) {
-    uint32_t state_buf[16];
+    uint32_t v[16][SOA_LANES];
     uint32_t knc_local[16];
+    uint32_t entropy[2][8];
+    uint32_t state[16];
+    const int lanes = 2 * counters;
 
-    // 1) Copy master knc[] into the local buffer
+    for (int i = 0; i < 4; i++) {
+        entropy[0][i]     = init_state[i];
+        entropy[1][i]     = init_state[4 + i];
+        entropy[0][4 + i] = init_state[8 + i];
+        entropy[1][4 + i] = init_state[12 + i];
+    }
+    for (int l = 0; l < lanes; l++) {
+        blake32_init_state_vector(state, entropy[l & 1], first_counter + (l >> 1), domain);
+        for (int w = 0; w < 16; w++) {
+            v[w][l] = state[w];
+        }
+    }
     for (int i = 0; i < 16; i++) {
         knc_local[i] = knc[i];
     }
 
-    // 2) Initialize BLAKE state from this entropy, counter, and domain
-    blake32_init_state_vector(state_buf, entropy, block_counter, domain);
-
-    // 3) For each round, mix and extract a 128‐bit key
-    for (size_t round = 0; round < key_count; round++) {
-
-        // a) Mix key+nonce composite into the state
-        blake32_optimized_mix_state(state_buf, knc_local);
-
-        // b) Extract state_buf[4..7] → out_keys[round][0..15]
-        for (int w = 0; w < 4; w++) {
-            const uint32_t v = state_buf[4 + w];
-            out_keys[round][4*w + 0] = (uint8_t)(v >> 24);
-            out_keys[round][4*w + 1] = (uint8_t)(v >> 16);
-            out_keys[round][4*w + 2] = (uint8_t)(v >>  8);
-            out_keys[round][4*w + 3] = (uint8_t)(v      );
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, lanes, knc_local);
+        for (int l = 0; l < lanes; l++) {
+            store_lane_key(out_keys[l][round], v, l);
         }
-
-        // c) Permute knc_local for the next round (unless this was the last round)
         if (round + 1 < key_count) {
             blake32_optimized_permute(knc_local);
         }
@@ -348,7 +409,103 @@ void blake32_optimized_derive_keys(
         uint8_t out_keys1[][16],
         uint8_t out_keys2[][16]
 ) {
-    // 1) Build two 8‐word entropy arrays from init_state
+    uint8_t (*const out_keys[SOA_LANES])[16] = {out_keys1, out_keys2};
+    derive_lanes(init_state, knc, key_count, block_counter, 1, domain, out_keys);
+}
+
+
+/*
+ * Portable `blake32_derive_keys_many`, SOA_COUNTERS counters per pass.
+ */
+void blake32_optimized_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint8_t (*streams[SOA_LANES])[16];
+    for (size_t i = 0; i < n; i += SOA_COUNTERS) {
+        const int counters = n - i < SOA_COUNTERS ? (int)(n - i) : SOA_COUNTERS;
+        for (int s = 0; s < 2 * counters; s++) {
+            streams[s] = &out_keys[(2 * i + s) * key_count];
+        }
+        derive_lanes(init_state, knc, key_count, first_counter + i, counters, domain, streams);
+    }
+}
+
+
+/*
+ * Writes four state words as a big-endian 128-bit round key.
+ */
+static void store_round_key(uint8_t out_key[16], const uint32_t words[4]) {
+    for (int w = 0; w < 4; w++) {
+        const uint32_t v = words[w];
+        out_key[4*w + 0] = (uint8_t)(v >> 24);
+        out_key[4*w + 1] = (uint8_t)(v >> 16);
+        out_key[4*w + 2] = (uint8_t)(v >>  8);
+        out_key[4*w + 3] = (uint8_t)(v      );
+    }
+}
+
+
+/*
+ * Reduced profile version of `compute_round_keys`, two round keys per mix
+ * step, see `blake32_clean_derive_keys_reduced`.
+ */
+static void compute_round_keys_reduced(
+        const uint32_t entropy[8],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint32_t state_buf[16];
+    uint32_t knc_local[16];
+    uint32_t folded[4];
+
+    for (int i = 0; i < 16; i++) {
+        knc_local[i] = knc[i];
+    }
+
+    blake32_init_state_vector(state_buf, entropy, block_counter, domain);
+    for (int i = 12; i < 16; i++) {
+        state_buf[i] ^= BLAKE32_REDUCED_V1_MASK;
+    }
+
+    for (size_t round = 0; round < key_count; round += 2) {
+        blake32_optimized_mix_state(state_buf, knc_local);
+        store_round_key(out_keys[round], &state_buf[4]);
+
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = state_buf[w] ^ state_buf[8 + w];
+            }
+            store_round_key(out_keys[round + 1], folded);
+        }
+        if (round + 2 < key_count) {
+            blake32_optimized_permute(knc_local);
+        }
+    }
+}
+
+
+/*
+ * Scalar version of `blake32_clean_derive_keys_reduced`, the portable
+ * fallback of `blake32_derive_keys_many_reduced`.
+ */
+void blake32_optimized_derive_keys_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
     uint32_t entropy1[8], entropy2[8];
     for (int i = 0; i < 4; i++) {
         entropy1[i]      = init_state[i];
@@ -356,24 +513,48 @@ void blake32_optimized_derive_keys(
         entropy1[4 + i]  = init_state[8 + i];
         entropy2[4 + i]  = init_state[12 + i];
     }
+    compute_round_keys_reduced(entropy1, knc, key_count, block_counter, domain, out_keys1);
+    compute_round_keys_reduced(entropy2, knc, key_count, block_counter, domain, out_keys2);
+}
+
 
-    // 2) Derive stream #1 keys from entropy1
-    compute_round_keys(
-        entropy1,
-        knc,
-        key_count,
-        block_counter,
-        domain,
-        out_keys1
-    );
-
-    // 3) Derive stream #2 keys from entropy2
-    compute_round_keys(
-        entropy2,
-        knc,
-        key_count,
-        block_counter,
-        domain,
-        out_keys2
-    );
+/*
+ * Starts a key stream at `block_counter`, which then yields the same keys
+ * as `blake32_optimized_derive_keys` one round at a time.
+ */
+void blake32_optimized_key_stream_init(
+        Blake32KeyStream *stream,
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain
+) {
+    uint32_t entropy1[8], entropy2[8];
+    for (int i = 0; i < 4; i++) {
+        entropy1[i]      = init_state[i];
+        entropy2[i]      = init_state[4 + i];
+        entropy1[4 + i]  = init_state[8 + i];
+        entropy2[4 + i]  = init_state[12 + i];
+    }
+    blake32_init_state_vector(stream->states[0], entropy1, block_counter, domain);
+    blake32_init_state_vector(stream->states[1], entropy2, block_counter, domain);
+    for (int i = 0; i < 16; i++) {
+        stream->knc[i] = knc[i];
+    }
+}
+
+
+/*
+ * Writes the round keys of the next round, of stream #1 and #2 in that order,
+ * and permutes the knc for the round after it.
+ */
+void blake32_optimized_key_stream_next(
+        Blake32KeyStream *stream,
+        uint8_t out_keys[2][16]
+) {
+    blake32_optimized_mix_state(stream->states[0], stream->knc);
+    blake32_optimized_mix_state(stream->states[1], stream->knc);
+    store_round_key(out_keys[0], &stream->states[0][4]);
+    store_round_key(out_keys[1], &stream->states[1][4]);
+    blake32_optimized_permute(stream->knc);
 }
@@ -0,0 +1,108 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <smmintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "blake32_rows_sse41.h"
+
+
+/*
+ * Writes state words 4..7 as a big-endian 128-bit round key.
+ */
+static inline SSE41_TARGET void store_round_key(uint8_t out_key[16], const __m128i row1) {
+    const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    _mm_storeu_si128((__m128i *)out_key, _mm_shuffle_epi8(row1, bswap));
+}
+
+
+/*
+ * SSE4.1 version of `blake32_optimized_mix_state`.
+ */
+SSE41_TARGET void blake32_sse41_mix_state(uint32_t state[16], const uint32_t m[16]) {
+    __m128i r[4], mr[4];
+    load_rows(r, state);
+    load_rows(mr, m);
+    mix_rows(r, mr);
+    store_rows(state, r);
+}
+
+
+/*
+ * SSE4.1 version of `blake32_optimized_permute`.
+ */
+SSE41_TARGET void blake32_sse41_permute(uint32_t m[16]) {
+    __m128i mr[4];
+    load_rows(mr, m);
+    permute_rows(mr);
+    store_rows(m, mr);
+}
+
+
+/*
+ * SSE4.1 version of `blake32_optimized_digest_context`.
+ */
+SSE41_TARGET void blake32_sse41_digest_context(
+        uint32_t state[16],
+        const uint32_t key[8],
+        uint32_t context[16]
+) {
+    __m128i r[4], mr[4];
+    init_rows(r, key, key + 4, 0, KDFDomain_CTX);
+    load_rows(mr, context);
+
+    for (int round = 0; round < 10; round++) {
+        mix_rows(r, mr);
+        if (round < 9) {
+            permute_rows(mr);
+        }
+    }
+    store_rows(state, r);
+    store_rows(context, mr);
+}
+
+
+/*
+ * SSE4.1 version of `blake32_optimized_derive_keys`. Both key streams
+ * are mixed side by side and share one permuted copy of the knc.
+ */
+SSE41_TARGET void blake32_sse41_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    __m128i r1[4], r2[4], mr[4];
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_rows(mr, knc);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_rows(r1, mr);
+        mix_rows(r2, mr);
+        store_round_key(out_keys1[round], r1[1]);
+        store_round_key(out_keys2[round], r2[1]);
+        if (round + 1 < key_count) {
+            permute_rows(mr);
+        }
+    }
+}
+
+#endif
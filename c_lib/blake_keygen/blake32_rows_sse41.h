@@ -0,0 +1,168 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BLAKE32_ROWS_SSE41_H
+#define BLAKE32_ROWS_SSE41_H
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <smmintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+
+/*
+ * Row-vector Blake32 round helpers of the SSE4.1 kernels. They live in a header
+ * so that fused kernels outside this library can keep the state in registers.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SSE41_TARGET __attribute__((target("sse4.1")))
+#else
+#define SSE41_TARGET
+#endif
+
+#define SHUFFLE_PS(a, b, imm) \
+    _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), (imm)))
+
+
+/*
+ * The state matrix is held as four row vectors {s0..s3}, {s4..s7}, {s8..s11}, {s12..s15},
+ * so that one vector operation runs the four column (or diagonal) G functions at once.
+ */
+static inline SSE41_TARGET __m128i rotr16(const __m128i x) {
+    const __m128i mask = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+
+static inline SSE41_TARGET __m128i rotr8(const __m128i x) {
+    const __m128i mask = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+
+static inline SSE41_TARGET __m128i rotr12(const __m128i x) {
+    return _mm_or_si128(_mm_srli_epi32(x, 12), _mm_slli_epi32(x, 20));
+}
+
+
+static inline SSE41_TARGET __m128i rotr7(const __m128i x) {
+    return _mm_or_si128(_mm_srli_epi32(x, 7), _mm_slli_epi32(x, 25));
+}
+
+
+static inline SSE41_TARGET void g_mix_rows(
+        __m128i *r0,
+        __m128i *r1,
+        __m128i *r2,
+        __m128i *r3,
+        const __m128i mx,
+        const __m128i my
+) {
+    *r0 = _mm_add_epi32(_mm_add_epi32(*r0, *r1), mx);
+    *r3 = rotr16(_mm_xor_si128(*r3, *r0));
+    *r2 = _mm_add_epi32(*r2, *r3);
+    *r1 = rotr12(_mm_xor_si128(*r1, *r2));
+
+    *r0 = _mm_add_epi32(_mm_add_epi32(*r0, *r1), my);
+    *r3 = rotr8(_mm_xor_si128(*r3, *r0));
+    *r2 = _mm_add_epi32(*r2, *r3);
+    *r1 = rotr7(_mm_xor_si128(*r1, *r2));
+}
+
+
+/*
+ * One round of the mixing function: G over the columns, then over the diagonals,
+ * which are lined up by rotating rows 1..3 left by 1..3 lanes and back again.
+ */
+static inline SSE41_TARGET void mix_rows(__m128i r[4], const __m128i m[4]) {
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(2, 0, 2, 0)),
+        SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(3, 1, 3, 1))
+    );
+
+    r[1] = _mm_shuffle_epi32(r[1], _MM_SHUFFLE(0, 3, 2, 1));
+    r[2] = _mm_shuffle_epi32(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm_shuffle_epi32(r[3], _MM_SHUFFLE(2, 1, 0, 3));
+
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(2, 0, 2, 0)),
+        SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(3, 1, 3, 1))
+    );
+
+    r[1] = _mm_shuffle_epi32(r[1], _MM_SHUFFLE(2, 1, 0, 3));
+    r[2] = _mm_shuffle_epi32(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm_shuffle_epi32(r[3], _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+
+/*
+ * Message permutation {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8} on row vectors.
+ * Each output row gathers its first two words into the even lanes of one shuffle and
+ * its last two words into the even lanes of another, then merges the even lanes.
+ */
+static inline SSE41_TARGET void permute_rows(__m128i m[4]) {
+    const __m128i p0 = SHUFFLE_PS(m[0], m[1], _MM_SHUFFLE(2, 2, 2, 2));
+    const __m128i q0 = SHUFFLE_PS(m[0], m[2], _MM_SHUFFLE(2, 2, 3, 3));
+    const __m128i p1 = SHUFFLE_PS(m[1], m[0], _MM_SHUFFLE(0, 0, 3, 3));
+    const __m128i q1 = SHUFFLE_PS(m[1], m[3], _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128i p2 = SHUFFLE_PS(m[0], m[2], _MM_SHUFFLE(3, 3, 1, 1));
+    const __m128i q2 = SHUFFLE_PS(m[3], m[1], _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128i p3 = SHUFFLE_PS(m[2], m[3], _MM_SHUFFLE(2, 2, 1, 1));
+    const __m128i q3 = SHUFFLE_PS(m[3], m[2], _MM_SHUFFLE(0, 0, 3, 3));
+
+    m[0] = SHUFFLE_PS(p0, q0, _MM_SHUFFLE(2, 0, 2, 0));
+    m[1] = SHUFFLE_PS(p1, q1, _MM_SHUFFLE(2, 0, 2, 0));
+    m[2] = SHUFFLE_PS(p2, q2, _MM_SHUFFLE(2, 0, 2, 0));
+    m[3] = SHUFFLE_PS(p3, q3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+
+static inline SSE41_TARGET void load_rows(__m128i r[4], const uint32_t words[16]) {
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm_loadu_si128((const __m128i *)(words + 4 * i));
+    }
+}
+
+
+static inline SSE41_TARGET void store_rows(uint32_t words[16], const __m128i r[4]) {
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(words + 4 * i), r[i]);
+    }
+}
+
+
+/*
+ * Builds the state rows of `blake32_init_state_vector` from the two entropy rows.
+ */
+static inline SSE41_TARGET void init_rows(
+        __m128i r[4],
+        const uint32_t entropy_lo[4],
+        const uint32_t entropy_hi[4],
+        const uint64_t counter,
+        const KDFDomain domain
+) {
+    const __m128i ctr_low = _mm_set1_epi32((int)(uint32_t)counter);
+    const __m128i ctr_high = _mm_set1_epi32((int)(uint32_t)(counter >> 32));
+    const __m128i d_mask = _mm_set1_epi32((int)blake32_get_domain_mask(domain));
+
+    r[0] = _mm_loadu_si128((const __m128i *)IV32);
+    r[1] = _mm_add_epi32(_mm_loadu_si128((const __m128i *)entropy_lo), ctr_low);
+    r[2] = _mm_add_epi32(_mm_loadu_si128((const __m128i *)entropy_hi), ctr_high);
+    r[3] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(IV32 + 4)), d_mask);
+}
+
+#endif
+
+#endif //BLAKE32_ROWS_SSE41_H
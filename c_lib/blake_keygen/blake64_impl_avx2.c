@@ -0,0 +1,409 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "blake_internals.h"
+#include "blake64_rows_avx2.h"
+
+#define MANY_COUNTERS 2
+
+
+/*
+ * Writes state words 4/5 and 6/7 as two big-endian 128-bit round keys.
+ */
+static inline AVX2_TARGET void store_round_keys(
+        uint8_t out_key_a[16],
+        uint8_t out_key_b[16],
+        const __m256i row1
+) {
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    );
+    const __m256i keys = _mm256_shuffle_epi8(row1, bswap);
+    _mm_storeu_si128((__m128i *)out_key_a, _mm256_castsi256_si128(keys));
+    _mm_storeu_si128((__m128i *)out_key_b, _mm256_extracti128_si256(keys, 1));
+}
+
+
+/*
+ * AVX2 version of `blake64_optimized_mix_state`.
+ */
+AVX2_TARGET void blake64_avx2_mix_state(uint64_t state[16], const uint64_t m[16]) {
+    __m256i r[4], ms[4];
+    load_rows(r, state);
+    load_schedule(ms, m);
+    mix_rows(r, ms);
+    store_rows(state, r);
+}
+
+
+/*
+ * AVX2 version of `blake64_optimized_permute`.
+ */
+AVX2_TARGET void blake64_avx2_permute(uint64_t m[16]) {
+    __m256i ms[4];
+    load_schedule(ms, m);
+    permute_schedule(ms);
+    store_schedule(m, ms);
+}
+
+
+/*
+ * AVX2 version of `blake64_optimized_digest_context`.
+ */
+AVX2_TARGET void blake64_avx2_digest_context(
+        uint64_t state[16],
+        const uint64_t key[8],
+        uint64_t context[16]
+) {
+    __m256i r[4], ms[4];
+    init_rows(r, key, key + 4, 0, KDFDomain_CTX);
+    load_schedule(ms, context);
+
+    for (int round = 0; round < 10; round++) {
+        mix_rows(r, ms);
+        if (round < 9) {
+            permute_schedule(ms);
+        }
+    }
+    store_rows(state, r);
+    store_schedule(context, ms);
+}
+
+
+/*
+ * AVX2 version of `blake64_optimized_derive_keys`. Both entropy halves are
+ * mixed side by side and share one permuted copy of the knc schedule.
+ */
+AVX2_TARGET void blake64_avx2_derive_keys(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+) {
+    __m256i r1[4], r2[4], ms[4];
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_schedule(ms, knc);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_rows(r1, ms);
+        mix_rows(r2, ms);
+        store_round_keys(out_keys1[round], out_keys2[round], r1[1]);
+        store_round_keys(out_keys3[round], out_keys4[round], r2[1]);
+        if (round + 1 < key_count) {
+            permute_schedule(ms);
+        }
+    }
+}
+
+
+/*
+ * Counter-parallel layout used by `blake64_avx2_derive_keys_many`: vector v[w]
+ * holds state word w of four independent states. Lane 2e + c belongs to entropy
+ * half e (streams #1/#2 or #3/#4) of the c-th counter of the pass.
+ */
+static inline AVX2_TARGET void g_mix_lanes(
+        __m256i v[16],
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const __m256i mx,
+        const __m256i my
+) {
+    v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), mx);
+    v[d] = rotr64_by32(_mm256_xor_si256(v[d], v[a]));
+    v[c] = _mm256_add_epi64(v[c], v[d]);
+    v[b] = rotr64_by24(_mm256_xor_si256(v[b], v[c]));
+
+    v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), my);
+    v[d] = rotr64_by16(_mm256_xor_si256(v[d], v[a]));
+    v[c] = _mm256_add_epi64(v[c], v[d]);
+    v[b] = rotr64_by63(_mm256_xor_si256(v[b], v[c]));
+}
+
+
+static inline AVX2_TARGET void mix_lanes(__m256i v[16], const __m256i m[16]) {
+    g_mix_lanes(v, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, 3, 4,  9, 14, m[14], m[15]);
+}
+
+
+static inline AVX2_TARGET void permute_lanes(__m256i m[16]) {
+    __m256i t[16];
+    for (int i = 0; i < 16; i++) {
+        t[i] = m[MSG_PERMUTATION[i]];
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = t[i];
+    }
+}
+
+
+/*
+ * Loads the states and message words of one pass, every slot (counter) having
+ * its own init state, counter, domain mask and knc.
+ */
+static inline AVX2_TARGET void init_lanes(
+        __m256i v[16],
+        __m256i m[16],
+        const uint64_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint64_t d_masks[MANY_COUNTERS],
+        const uint64_t *kncs[MANY_COUNTERS]
+) {
+    uint64_t words[12][4];
+    uint64_t m_words[16][4];
+    for (int lane = 0; lane < 4; lane++) {
+        const int slot = lane & 1;
+        const uint64_t counter = counters[slot];
+        const uint64_t *entropy = lane >> 1 ? init_states[slot] + 4 : init_states[slot];
+        for (int w = 0; w < 4; w++) {
+            words[w][lane] = entropy[w] + (uint32_t)counter;
+            words[4 + w][lane] = entropy[8 + w] + (uint32_t)(counter >> 32);
+            words[8 + w][lane] = IV64[4 + w] ^ d_masks[slot];
+        }
+        for (int i = 0; i < 16; i++) {
+            m_words[i][lane] = kncs[slot][i];
+        }
+    }
+    for (int w = 0; w < 4; w++) {
+        v[w] = _mm256_set1_epi64x((long long)IV64[w]);
+        v[4 + w] = _mm256_loadu_si256((const __m256i *)words[w]);
+        v[8 + w] = _mm256_loadu_si256((const __m256i *)words[4 + w]);
+        v[12 + w] = _mm256_loadu_si256((const __m256i *)words[8 + w]);
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = _mm256_loadu_si256((const __m256i *)m_words[i]);
+    }
+}
+
+
+/*
+ * Pairs words 0/1 and 2/3 of four state word vectors of each lane, words 4..7 in
+ * the standard profile, into big-endian round keys. The low/high unpack of a word
+ * pair yields counter 0/1 of entropy half 0 in the low 128 bits and of entropy
+ * half 1 in the high 128 bits.
+ */
+static inline AVX2_TARGET void store_lane_keys(
+        uint8_t out_keys[][16],
+        const __m256i rows[4],
+        const uint8_t key_count,
+        const uint8_t round,
+        const size_t counters
+) {
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    );
+    __m256i keys_a[2], keys_b[2];
+    keys_a[0] = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(rows[0], rows[1]), bswap);
+    keys_a[1] = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(rows[0], rows[1]), bswap);
+    keys_b[0] = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(rows[2], rows[3]), bswap);
+    keys_b[1] = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(rows[2], rows[3]), bswap);
+
+    for (size_t c = 0; c < counters; c++) {
+        uint8_t (*keys)[16] = &out_keys[4 * c * key_count + round];
+        _mm_storeu_si128((__m128i *)keys[0], _mm256_castsi256_si128(keys_a[c]));
+        _mm_storeu_si128((__m128i *)keys[key_count], _mm256_castsi256_si128(keys_b[c]));
+        _mm_storeu_si128((__m128i *)keys[2 * key_count], _mm256_extracti128_si256(keys_a[c], 1));
+        _mm_storeu_si128((__m128i *)keys[3 * key_count], _mm256_extracti128_si256(keys_b[c], 1));
+    }
+}
+
+
+static AVX2_TARGET void derive_pass(
+        const uint64_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint64_t d_masks[MANY_COUNTERS],
+        const uint64_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m256i v[16], m[16];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, &v[4], key_count, round, slots);
+        if (round + 1 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+
+/*
+ * Reduced profile version of `derive_pass`, see `blake64_clean_derive_keys_reduced`.
+ * The profile mask is already part of `d_masks`.
+ */
+static AVX2_TARGET void derive_pass_reduced(
+        const uint64_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint64_t d_masks[MANY_COUNTERS],
+        const uint64_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m256i v[16], m[16], folded[4];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round += 2) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, &v[4], key_count, round, slots);
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = _mm256_xor_si256(v[w], v[8 + w]);
+            }
+            store_lane_keys(out_keys, folded, key_count, round + 1, slots);
+        }
+        if (round + 2 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+/*
+ * AVX2 version of `blake64_derive_keys_many`, two block counters per pass.
+ * A lone remaining counter goes through the row kernel, which keeps
+ * all lanes busy with a single state.
+ */
+AVX2_TARGET void blake64_avx2_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint64_t d_masks[MANY_COUNTERS];
+    const uint64_t *kncs[MANY_COUNTERS];
+    const uint64_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake64_get_domain_mask(domain);
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        if (slots == 1) {
+            uint8_t (*keys)[16] = &out_keys[done * 4 * key_count];
+            blake64_avx2_derive_keys(
+                init_state, knc, key_count, first_counter + done, domain,
+                &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+            );
+            break;
+        }
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 4 * key_count]);
+    }
+}
+
+
+/*
+ * AVX2 version of `blake64_derive_keys_jobs`, two jobs per pass. A lone remaining
+ * job goes through the row kernel.
+ */
+AVX2_TARGET void blake64_avx2_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint64_t d_masks[MANY_COUNTERS];
+    const uint64_t *kncs[MANY_COUNTERS];
+    const uint64_t *init_states[MANY_COUNTERS];
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        if (slots == 1) {
+            const Blake64KeyJob *job = &jobs[done];
+            const uint64_t *job_state = job->init_state != NULL ? job->init_state : init_state;
+            uint8_t (*keys)[16] = &out_keys[done * 4 * key_count];
+            blake64_avx2_derive_keys(
+                job_state, job->knc, key_count, job->counter, job->domain,
+                &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+            );
+            break;
+        }
+        for (size_t j = 0; j < MANY_COUNTERS; j++) {
+            const Blake64KeyJob *job = &jobs[done + (j < slots ? j : 0)];
+            counters[j] = job->counter;
+            d_masks[j] = blake64_get_domain_mask(job->domain);
+            kncs[j] = job->knc;
+            init_states[j] = job->init_state != NULL ? job->init_state : init_state;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 4 * key_count]);
+    }
+}
+
+/*
+ * AVX2 version of `blake64_derive_keys_many_reduced`, two block counters per pass.
+ */
+AVX2_TARGET void blake64_avx2_derive_keys_many_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint64_t d_masks[MANY_COUNTERS];
+    const uint64_t *kncs[MANY_COUNTERS];
+    const uint64_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake64_get_domain_mask(domain) ^ BLAKE64_REDUCED_V1_MASK;
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass_reduced(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 4 * key_count]);
+    }
+}
+
+#endif
@@ -0,0 +1,488 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+#include "blake_internals.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+#define AVX512VL_TARGET __attribute__((target("avx512f,avx512vl")))
+#else
+#define AVX512_TARGET
+#define AVX512VL_TARGET
+#endif
+
+#define MANY_COUNTERS 4
+
+
+/*
+ * Row layout used by the single-state functions, as in the AVX2 version: four
+ * 256-bit state rows rotated with native `vprorq`. The message schedule
+ * {m0, m2, m4, m6, m1, m3, m5, m7} and {m8, m10, m12, m14, m9, m11, m13, m15}
+ * is held in two 512-bit registers, so that one round of the message
+ * permutation is a single two-source permute per register.
+ */
+static inline AVX512VL_TARGET void g_mix_rows(
+        __m256i *r0,
+        __m256i *r1,
+        __m256i *r2,
+        __m256i *r3,
+        const __m256i mx,
+        const __m256i my
+) {
+    *r0 = _mm256_add_epi64(_mm256_add_epi64(*r0, *r1), mx);
+    *r3 = _mm256_ror_epi64(_mm256_xor_si256(*r3, *r0), 32);
+    *r2 = _mm256_add_epi64(*r2, *r3);
+    *r1 = _mm256_ror_epi64(_mm256_xor_si256(*r1, *r2), 24);
+
+    *r0 = _mm256_add_epi64(_mm256_add_epi64(*r0, *r1), my);
+    *r3 = _mm256_ror_epi64(_mm256_xor_si256(*r3, *r0), 16);
+    *r2 = _mm256_add_epi64(*r2, *r3);
+    *r1 = _mm256_ror_epi64(_mm256_xor_si256(*r1, *r2), 63);
+}
+
+
+/*
+ * One round of the mixing function: G over the columns, then over the diagonals,
+ * which are lined up by rotating rows 1..3 left by 1..3 lanes and back again.
+ */
+static inline AVX512VL_TARGET void mix_rows(__m256i r[4], const __m512i ms_lo, const __m512i ms_hi) {
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        _mm512_castsi512_si256(ms_lo),
+        _mm512_extracti64x4_epi64(ms_lo, 1)
+    );
+
+    r[1] = _mm256_permute4x64_epi64(r[1], _MM_SHUFFLE(0, 3, 2, 1));
+    r[2] = _mm256_permute4x64_epi64(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_permute4x64_epi64(r[3], _MM_SHUFFLE(2, 1, 0, 3));
+
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3],
+        _mm512_castsi512_si256(ms_hi),
+        _mm512_extracti64x4_epi64(ms_hi, 1)
+    );
+
+    r[1] = _mm256_permute4x64_epi64(r[1], _MM_SHUFFLE(2, 1, 0, 3));
+    r[2] = _mm256_permute4x64_epi64(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_permute4x64_epi64(r[3], _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+
+/*
+ * Message permutation on the schedule registers, indices 0..7 select from
+ * `ms_lo` and 8..15 from `ms_hi`.
+ */
+static inline AVX512VL_TARGET void permute_schedule(__m512i *ms_lo, __m512i *ms_hi) {
+    const __m512i idx_lo = _mm512_set_epi64(14, 0, 9, 3, 2, 7, 5, 1);
+    const __m512i idx_hi = _mm512_set_epi64(8, 11, 6, 13, 15, 12, 10, 4);
+    const __m512i lo = *ms_lo;
+    *ms_lo = _mm512_permutex2var_epi64(lo, idx_lo, *ms_hi);
+    *ms_hi = _mm512_permutex2var_epi64(lo, idx_hi, *ms_hi);
+}
+
+
+static inline AVX512VL_TARGET void load_rows(__m256i r[4], const uint64_t words[16]) {
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm256_loadu_si256((const __m256i *)(words + 4 * i));
+    }
+}
+
+
+static inline AVX512VL_TARGET void store_rows(uint64_t words[16], const __m256i r[4]) {
+    for (int i = 0; i < 4; i++) {
+        _mm256_storeu_si256((__m256i *)(words + 4 * i), r[i]);
+    }
+}
+
+
+static inline AVX512VL_TARGET void load_schedule(__m512i *ms_lo, __m512i *ms_hi, const uint64_t m[16]) {
+    const __m512i idx = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+    *ms_lo = _mm512_permutexvar_epi64(idx, _mm512_loadu_si512((const void *)m));
+    *ms_hi = _mm512_permutexvar_epi64(idx, _mm512_loadu_si512((const void *)(m + 8)));
+}
+
+
+static inline AVX512VL_TARGET void store_schedule(uint64_t m[16], const __m512i ms_lo, const __m512i ms_hi) {
+    const __m512i idx = _mm512_set_epi64(7, 3, 6, 2, 5, 1, 4, 0);
+    _mm512_storeu_si512((void *)m, _mm512_permutexvar_epi64(idx, ms_lo));
+    _mm512_storeu_si512((void *)(m + 8), _mm512_permutexvar_epi64(idx, ms_hi));
+}
+
+
+/*
+ * Builds the state rows of `blake64_init_state_vector` from the two entropy rows.
+ */
+static inline AVX512VL_TARGET void init_rows(
+        __m256i r[4],
+        const uint64_t entropy_lo[4],
+        const uint64_t entropy_hi[4],
+        const uint64_t counter,
+        const KDFDomain domain
+) {
+    const __m256i ctr_low = _mm256_set1_epi64x((long long)(uint32_t)counter);
+    const __m256i ctr_high = _mm256_set1_epi64x((long long)(counter >> 32));
+    const __m256i d_mask = _mm256_set1_epi64x((long long)blake64_get_domain_mask(domain));
+
+    r[0] = _mm256_loadu_si256((const __m256i *)IV64);
+    r[1] = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)entropy_lo), ctr_low);
+    r[2] = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)entropy_hi), ctr_high);
+    r[3] = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(IV64 + 4)), d_mask);
+}
+
+
+/*
+ * Writes state words 4/5 and 6/7 as two big-endian 128-bit round keys.
+ */
+static inline AVX512VL_TARGET void store_round_keys(
+        uint8_t out_key_a[16],
+        uint8_t out_key_b[16],
+        const __m256i row1
+) {
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    );
+    const __m256i keys = _mm256_shuffle_epi8(row1, bswap);
+    _mm_storeu_si128((__m128i *)out_key_a, _mm256_castsi256_si128(keys));
+    _mm_storeu_si128((__m128i *)out_key_b, _mm256_extracti128_si256(keys, 1));
+}
+
+
+/*
+ * AVX-512VL version of `blake64_optimized_mix_state`.
+ */
+AVX512VL_TARGET void blake64_avx512_mix_state(uint64_t state[16], const uint64_t m[16]) {
+    __m256i r[4];
+    __m512i ms_lo, ms_hi;
+    load_rows(r, state);
+    load_schedule(&ms_lo, &ms_hi, m);
+    mix_rows(r, ms_lo, ms_hi);
+    store_rows(state, r);
+}
+
+
+/*
+ * AVX-512VL version of `blake64_optimized_permute`.
+ */
+AVX512VL_TARGET void blake64_avx512_permute(uint64_t m[16]) {
+    __m512i ms_lo, ms_hi;
+    load_schedule(&ms_lo, &ms_hi, m);
+    permute_schedule(&ms_lo, &ms_hi);
+    store_schedule(m, ms_lo, ms_hi);
+}
+
+
+/*
+ * AVX-512VL version of `blake64_optimized_digest_context`.
+ */
+AVX512VL_TARGET void blake64_avx512_digest_context(
+        uint64_t state[16],
+        const uint64_t key[8],
+        uint64_t context[16]
+) {
+    __m256i r[4];
+    __m512i ms_lo, ms_hi;
+    init_rows(r, key, key + 4, 0, KDFDomain_CTX);
+    load_schedule(&ms_lo, &ms_hi, context);
+
+    for (int round = 0; round < 10; round++) {
+        mix_rows(r, ms_lo, ms_hi);
+        if (round < 9) {
+            permute_schedule(&ms_lo, &ms_hi);
+        }
+    }
+    store_rows(state, r);
+    store_schedule(context, ms_lo, ms_hi);
+}
+
+
+/*
+ * AVX-512VL version of `blake64_optimized_derive_keys`. Both entropy halves
+ * are mixed side by side and share one permuted copy of the knc schedule.
+ */
+AVX512VL_TARGET void blake64_avx512_derive_keys(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+) {
+    __m256i r1[4], r2[4];
+    __m512i ms_lo, ms_hi;
+    init_rows(r1, init_state, init_state + 8, block_counter, domain);
+    init_rows(r2, init_state + 4, init_state + 12, block_counter, domain);
+    load_schedule(&ms_lo, &ms_hi, knc);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_rows(r1, ms_lo, ms_hi);
+        mix_rows(r2, ms_lo, ms_hi);
+        store_round_keys(out_keys1[round], out_keys2[round], r1[1]);
+        store_round_keys(out_keys3[round], out_keys4[round], r2[1]);
+        if (round + 1 < key_count) {
+            permute_schedule(&ms_lo, &ms_hi);
+        }
+    }
+}
+
+
+/*
+ * Counter-parallel layout used by `blake64_avx512_derive_keys_many`: vector v[w]
+ * holds state word w of eight independent states. Lane 2q + j belongs to entropy
+ * half (q & 1) of counter 2 * (q >> 1) + j of the pass.
+ */
+static inline AVX512_TARGET void g_mix_lanes(
+        __m512i v[16],
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const __m512i mx,
+        const __m512i my
+) {
+    v[a] = _mm512_add_epi64(_mm512_add_epi64(v[a], v[b]), mx);
+    v[d] = _mm512_ror_epi64(_mm512_xor_si512(v[d], v[a]), 32);
+    v[c] = _mm512_add_epi64(v[c], v[d]);
+    v[b] = _mm512_ror_epi64(_mm512_xor_si512(v[b], v[c]), 24);
+
+    v[a] = _mm512_add_epi64(_mm512_add_epi64(v[a], v[b]), my);
+    v[d] = _mm512_ror_epi64(_mm512_xor_si512(v[d], v[a]), 16);
+    v[c] = _mm512_add_epi64(v[c], v[d]);
+    v[b] = _mm512_ror_epi64(_mm512_xor_si512(v[b], v[c]), 63);
+}
+
+
+static inline AVX512_TARGET void mix_lanes(__m512i v[16], const __m512i m[16]) {
+    g_mix_lanes(v, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, 3, 4,  9, 14, m[14], m[15]);
+}
+
+
+static inline AVX512_TARGET void permute_lanes(__m512i m[16]) {
+    __m512i t[16];
+    for (int i = 0; i < 16; i++) {
+        t[i] = m[MSG_PERMUTATION[i]];
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = t[i];
+    }
+}
+
+
+static inline size_t lane_counter(const int chunk, const int j) {
+    return (size_t)(chunk >> 1) * 2 + (size_t)j;
+}
+
+
+/*
+ * Loads the states and message words of one pass, every slot (counter) having
+ * its own init state, counter, domain mask and knc.
+ */
+static inline AVX512_TARGET void init_lanes(
+        __m512i v[16],
+        __m512i m[16],
+        const uint64_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint64_t d_masks[MANY_COUNTERS],
+        const uint64_t *kncs[MANY_COUNTERS]
+) {
+    uint64_t words[12][8];
+    uint64_t m_words[16][8];
+    for (int lane = 0; lane < 8; lane++) {
+        const int chunk = lane >> 1;
+        const size_t slot = lane_counter(chunk, lane & 1);
+        const uint64_t counter = counters[slot];
+        const uint64_t *entropy = chunk & 1 ? init_states[slot] + 4 : init_states[slot];
+        for (int w = 0; w < 4; w++) {
+            words[w][lane] = entropy[w] + (uint32_t)counter;
+            words[4 + w][lane] = entropy[8 + w] + (uint32_t)(counter >> 32);
+            words[8 + w][lane] = IV64[4 + w] ^ d_masks[slot];
+        }
+        for (int i = 0; i < 16; i++) {
+            m_words[i][lane] = kncs[slot][i];
+        }
+    }
+    for (int w = 0; w < 4; w++) {
+        v[w] = _mm512_set1_epi64((long long)IV64[w]);
+        v[4 + w] = _mm512_loadu_si512(words[w]);
+        v[8 + w] = _mm512_loadu_si512(words[4 + w]);
+        v[12 + w] = _mm512_loadu_si512(words[8 + w]);
+    }
+    for (int i = 0; i < 16; i++) {
+        m[i] = _mm512_loadu_si512(m_words[i]);
+    }
+}
+
+
+static inline AVX512_TARGET __m128i key_chunk(const __m512i keys, const int chunk) {
+    switch (chunk) {
+        case 1:  return _mm512_extracti32x4_epi32(keys, 1);
+        case 2:  return _mm512_extracti32x4_epi32(keys, 2);
+        case 3:  return _mm512_extracti32x4_epi32(keys, 3);
+        default: return _mm512_castsi512_si128(keys);
+    }
+}
+
+
+/*
+ * Pairs state words 4/5 and 6/7 of each lane into big-endian round keys,
+ * the low/high unpack holding lane j = 0/1 of every 128-bit chunk.
+ */
+static inline AVX512_TARGET void store_lane_keys(
+        uint8_t out_keys[][16],
+        const __m512i v[16],
+        const uint8_t key_count,
+        const uint8_t round,
+        const size_t counters
+) {
+    const __m512i bswap = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8)
+    );
+    __m512i keys_a[2], keys_b[2];
+    keys_a[0] = _mm512_shuffle_epi8(_mm512_unpacklo_epi64(v[4], v[5]), bswap);
+    keys_a[1] = _mm512_shuffle_epi8(_mm512_unpackhi_epi64(v[4], v[5]), bswap);
+    keys_b[0] = _mm512_shuffle_epi8(_mm512_unpacklo_epi64(v[6], v[7]), bswap);
+    keys_b[1] = _mm512_shuffle_epi8(_mm512_unpackhi_epi64(v[6], v[7]), bswap);
+
+    for (int chunk = 0; chunk < 4; chunk++) {
+        for (int j = 0; j < 2; j++) {
+            const size_t counter = lane_counter(chunk, j);
+            if (counter < counters) {
+                const size_t stream = 2 * (size_t)(chunk & 1);
+                uint8_t (*keys)[16] = &out_keys[(4 * counter + stream) * key_count + round];
+                _mm_storeu_si128((__m128i *)keys[0], key_chunk(keys_a[j], chunk));
+                _mm_storeu_si128((__m128i *)keys[key_count], key_chunk(keys_b[j], chunk));
+            }
+        }
+    }
+}
+
+
+static AVX512_TARGET void derive_pass(
+        const uint64_t *init_states[MANY_COUNTERS],
+        const uint64_t counters[MANY_COUNTERS],
+        const uint64_t d_masks[MANY_COUNTERS],
+        const uint64_t *kncs[MANY_COUNTERS],
+        const uint8_t key_count,
+        const size_t slots,
+        uint8_t out_keys[][16]
+) {
+    __m512i v[16], m[16];
+    init_lanes(v, m, init_states, counters, d_masks, kncs);
+
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, m);
+        store_lane_keys(out_keys, v, key_count, round, slots);
+        if (round + 1 < key_count) {
+            permute_lanes(m);
+        }
+    }
+}
+
+
+/*
+ * AVX-512 version of `blake64_derive_keys_many`, four block counters per pass.
+ * A lone remaining counter goes through the row kernel, which keeps
+ * all lanes busy with a single state.
+ */
+AVX512_TARGET void blake64_avx512_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint64_t d_masks[MANY_COUNTERS];
+    const uint64_t *kncs[MANY_COUNTERS];
+    const uint64_t *init_states[MANY_COUNTERS];
+    for (int j = 0; j < MANY_COUNTERS; j++) {
+        d_masks[j] = blake64_get_domain_mask(domain);
+        kncs[j] = knc;
+        init_states[j] = init_state;
+    }
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        if (slots == 1) {
+            uint8_t (*keys)[16] = &out_keys[done * 4 * key_count];
+            blake64_avx512_derive_keys(
+                init_state, knc, key_count, first_counter + done, domain,
+                &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+            );
+            break;
+        }
+        for (int j = 0; j < MANY_COUNTERS; j++) {
+            counters[j] = first_counter + done + (uint64_t)j;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 4 * key_count]);
+    }
+}
+
+
+/*
+ * AVX-512 version of `blake64_derive_keys_jobs`, four jobs per pass. A lone remaining
+ * job goes through the row kernel.
+ */
+AVX512_TARGET void blake64_avx512_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    uint64_t counters[MANY_COUNTERS];
+    uint64_t d_masks[MANY_COUNTERS];
+    const uint64_t *kncs[MANY_COUNTERS];
+    const uint64_t *init_states[MANY_COUNTERS];
+
+    for (size_t done = 0; done < n; done += MANY_COUNTERS) {
+        const size_t slots = n - done < MANY_COUNTERS ? n - done : MANY_COUNTERS;
+        if (slots == 1) {
+            const Blake64KeyJob *job = &jobs[done];
+            const uint64_t *job_state = job->init_state != NULL ? job->init_state : init_state;
+            uint8_t (*keys)[16] = &out_keys[done * 4 * key_count];
+            blake64_avx512_derive_keys(
+                job_state, job->knc, key_count, job->counter, job->domain,
+                &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+            );
+            break;
+        }
+        for (size_t j = 0; j < MANY_COUNTERS; j++) {
+            const Blake64KeyJob *job = &jobs[done + (j < slots ? j : 0)];
+            counters[j] = job->counter;
+            d_masks[j] = blake64_get_domain_mask(job->domain);
+            kncs[j] = job->knc;
+            init_states[j] = job->init_state != NULL ? job->init_state : init_state;
+        }
+        derive_pass(init_states, counters, d_masks, kncs, key_count, slots, &out_keys[done * 4 * key_count]);
+    }
+}
+
+#endif
@@ -111,7 +111,7 @@ void blake64_clean_compute_knc(
 void blake64_clean_digest_context(
         uint64_t state[16],
         const uint64_t key[8],
-        uint64_t context[8]
+        uint64_t context[16]
 ) {
     blake64_init_state_vector(state, key, 0, KDFDomain_CTX);
     for (int i = 0; i < 9; i++) {
@@ -245,4 +245,95 @@ void blake64_clean_derive_keys(
         out_keys3,
         out_keys4
     );
-}
\ No newline at end of file
+}
+
+/*
+ * Writes two state words as a big-endian 128-bit round key.
+ */
+static void store_round_key(uint8_t out_key[16], const uint64_t words[2]) {
+    for (int w = 0; w < 2; w++) {
+        const uint64_t v = words[w];
+        out_key[8*w + 0] = (uint8_t)(v >> 56);
+        out_key[8*w + 1] = (uint8_t)(v >> 48);
+        out_key[8*w + 2] = (uint8_t)(v >> 40);
+        out_key[8*w + 3] = (uint8_t)(v >> 32);
+        out_key[8*w + 4] = (uint8_t)(v >> 24);
+        out_key[8*w + 5] = (uint8_t)(v >> 16);
+        out_key[8*w + 6] = (uint8_t)(v >>  8);
+        out_key[8*w + 7] = (uint8_t)(v      );
+    }
+}
+
+
+/*
+ * Reduced profile version of `compute_round_keys`, see the 32-bit version.
+ * The even keys come from state_buf[4..7] and the odd keys from the fold
+ * state_buf[0..3] ^ state_buf[8..11], two words per stream each.
+ */
+static void compute_round_keys_reduced(
+        const uint64_t entropy[8],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    uint64_t state_buf[16];
+    uint64_t knc_local[16];
+    uint64_t folded[4];
+
+    for (int i = 0; i < 16; i++) {
+        knc_local[i] = knc[i];
+    }
+
+    blake64_init_state_vector(state_buf, entropy, block_counter, domain);
+    for (int i = 12; i < 16; i++) {
+        state_buf[i] ^= BLAKE64_REDUCED_V1_MASK;
+    }
+
+    for (size_t round = 0; round < key_count; round += 2) {
+        blake64_clean_mix_state(state_buf, knc_local);
+        store_round_key(out_keys1[round], &state_buf[4]);
+        store_round_key(out_keys2[round], &state_buf[6]);
+
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = state_buf[w] ^ state_buf[8 + w];
+            }
+            store_round_key(out_keys1[round + 1], &folded[0]);
+            store_round_key(out_keys2[round + 1], &folded[2]);
+        }
+        if (round + 2 < key_count) {
+            blake64_clean_permute(knc_local);
+        }
+    }
+}
+
+
+/*
+ * Reference implementation of version 1 of the reduced keygen profile,
+ * see `blake32_clean_derive_keys_reduced`.
+ */
+void blake64_clean_derive_keys_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+) {
+    uint64_t entropy1[8];
+    uint64_t entropy2[8];
+    for (int i = 0; i < 4; i++) {
+        entropy1[i]      = init_state[i];
+        entropy2[i]      = init_state[4 + i];
+        entropy1[4 + i]  = init_state[8 + i];
+        entropy2[4 + i]  = init_state[12 + i];
+    }
+    compute_round_keys_reduced(entropy1, knc, key_count, block_counter, domain, out_keys1, out_keys2);
+    compute_round_keys_reduced(entropy2, knc, key_count, block_counter, domain, out_keys3, out_keys4);
+}
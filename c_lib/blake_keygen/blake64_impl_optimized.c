@@ -233,7 +233,7 @@ void blake64_optimized_compute_knc(
 void blake64_optimized_digest_context(
         uint64_t state[16],
         const uint64_t key[8],
-        uint64_t context[8]
+        uint64_t context[16]
 ) {
     blake64_init_state_vector(state, key, 0, KDFDomain_CTX);
 
@@ -279,67 +279,109 @@ void blake64_optimized_digest_context(
 
 
 /*
- * derive_keys64 helper: Generates `key_count` 128‐bit round keys.
- *   - entropy[8]:     eight 64‐bit words
- *   - knc[16]:        precomputed key+nonce composite
- *   - key_count:      number of round keys to output
- *   - block_counter:  64‐bit counter for init_state_vector64
- *   - domain:         KDFDomain for domain separation
- *   - out_keys[][16]: output buffer for 128‐bit keys
+ * Structure-of-arrays layout of the portable keygen: v[w][lane] holds state word
+ * w of SOA_LANES independent states, so that every step of the mix is one loop
+ * over adjacent words, which the compiler turns into SIMD lanes. Lane 2c + e
+ * belongs to entropy half e (streams #1/#2 or #3/#4) of the c-th counter of the
+ * pass. All lanes share the knc, so it is permuted once per round for all of them.
  */
-static void compute_round_keys(
-        const uint64_t entropy[8],
-        const uint64_t knc[16],
-        const size_t key_count,
-        const uint64_t block_counter,
-        const KDFDomain domain,
-        uint8_t out_keys1[][16],
-        uint8_t out_keys2[][16]
+#define SOA_COUNTERS 2
+#define SOA_LANES    (2 * SOA_COUNTERS)
+
+
+static inline void g_mix_lanes(
+        uint64_t v[16][SOA_LANES],
+        const int lanes,
+        const int a,
+        const int b,
+        const int c,
+        const int d,
+        const uint64_t mx,
+        const uint64_t my
 ) {
-    uint64_t state_buf[16];
-    uint64_t knc_local[16];
+    for (int l = 0; l < lanes; l++) {
+        uint64_t va = v[a][l], vb = v[b][l], vc = v[c][l], vd = v[d][l];
 
-    // 1) Copy master knc[] into the local buffer
-    for (int i = 0; i < 16; i++) {
-        knc_local[i] = knc[i];
+        va = va + vb + mx;
+        vd = rotr64(vd ^ va, 32);
+        vc = vc + vd;
+        vb = rotr64(vb ^ vc, 24);
+
+        va = va + vb + my;
+        vd = rotr64(vd ^ va, 16);
+        vc = vc + vd;
+        vb = rotr64(vb ^ vc, 63);
+
+        v[a][l] = va, v[b][l] = vb, v[c][l] = vc, v[d][l] = vd;
     }
+}
 
-    // 2) Initialize BLAKE state from this entropy, counter, and domain
-    blake64_init_state_vector(state_buf, entropy, block_counter, domain);
 
-    // 3) For each round, mix and extract two 128-bit keys
-    for (size_t round = 0; round < key_count; round++) {
+static inline void mix_lanes(uint64_t v[16][SOA_LANES], const int lanes, const uint64_t m[16]) {
+    g_mix_lanes(v, lanes, 0, 4,  8, 12, m[0],  m[1]);
+    g_mix_lanes(v, lanes, 1, 5,  9, 13, m[2],  m[3]);
+    g_mix_lanes(v, lanes, 2, 6, 10, 14, m[4],  m[5]);
+    g_mix_lanes(v, lanes, 3, 7, 11, 15, m[6],  m[7]);
+    g_mix_lanes(v, lanes, 0, 5, 10, 15, m[8],  m[9]);
+    g_mix_lanes(v, lanes, 1, 6, 11, 12, m[10], m[11]);
+    g_mix_lanes(v, lanes, 2, 7,  8, 13, m[12], m[13]);
+    g_mix_lanes(v, lanes, 3, 4,  9, 14, m[14], m[15]);
+}
 
-        // a) Mix key+nonce composite into the state
-        blake64_optimized_mix_state(state_buf, knc_local);
 
-        // b) Extract state_buf[4..5] → out_keys1[round][0..15]
-        for (int w = 0; w < 2; w++) {
-            const uint64_t v = state_buf[4 + w];
-            out_keys1[round][8*w + 0] = (uint8_t)(v >> 56);
-            out_keys1[round][8*w + 1] = (uint8_t)(v >> 48);
-            out_keys1[round][8*w + 2] = (uint8_t)(v >> 40);
-            out_keys1[round][8*w + 3] = (uint8_t)(v >> 32);
-            out_keys1[round][8*w + 4] = (uint8_t)(v >> 24);
-            out_keys1[round][8*w + 5] = (uint8_t)(v >> 16);
-            out_keys1[round][8*w + 6] = (uint8_t)(v >>  8);
-            out_keys1[round][8*w + 7] = (uint8_t)(v      );
-        }
+/*
+ * Writes state words `hi` and `lo` as a big-endian 128-bit round key.
+ */
+static inline void store_lane_key(uint8_t out_key[16], const uint64_t hi, const uint64_t lo) {
+    for (int i = 0; i < 8; i++) {
+        out_key[i] = (uint8_t)(hi >> (56 - 8 * i));
+        out_key[8 + i] = (uint8_t)(lo >> (56 - 8 * i));
+    }
+}
+
+
+/*
+ * Derives the keys of `counters` consecutive block counters, at most SOA_COUNTERS.
+ * Each mix advances all four streams of every counter, and the keys go straight
+ * from the lanes into the key arrays, out_keys[4c + s] of stream #s+1 of counter c.
+ */
+static inline void derive_lanes(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const int counters,
+        const KDFDomain domain,
+        uint8_t (*const out_keys[2 * SOA_LANES])[16]
+) {
+    uint64_t v[16][SOA_LANES];
+    uint64_t knc_local[16];
+    uint64_t entropy[2][8];
+    uint64_t state[16];
+    const int lanes = 2 * counters;
 
-        // c) Extract state_buf[6..7] → out_keys2[round][0..15]
-        for (int w = 0; w < 2; w++) {
-            const uint64_t v = state_buf[6 + w];
-            out_keys2[round][8*w + 0] = (uint8_t)(v >> 56);
-            out_keys2[round][8*w + 1] = (uint8_t)(v >> 48);
-            out_keys2[round][8*w + 2] = (uint8_t)(v >> 40);
-            out_keys2[round][8*w + 3] = (uint8_t)(v >> 32);
-            out_keys2[round][8*w + 4] = (uint8_t)(v >> 24);
-            out_keys2[round][8*w + 5] = (uint8_t)(v >> 16);
-            out_keys2[round][8*w + 6] = (uint8_t)(v >>  8);
-            out_keys2[round][8*w + 7] = (uint8_t)(v      );
+    for (int i = 0; i < 4; i++) {
+        entropy[0][i]     = init_state[i];
+        entropy[1][i]     = init_state[4 + i];
+        entropy[0][4 + i] = init_state[8 + i];
+        entropy[1][4 + i] = init_state[12 + i];
+    }
+    for (int l = 0; l < lanes; l++) {
+        blake64_init_state_vector(state, entropy[l & 1], first_counter + (l >> 1), domain);
+        for (int w = 0; w < 16; w++) {
+            v[w][l] = state[w];
         }
+    }
+    for (int i = 0; i < 16; i++) {
+        knc_local[i] = knc[i];
+    }
 
-        // d) Permute knc_local for the next round (unless this was the last round)
+    for (uint8_t round = 0; round < key_count; round++) {
+        mix_lanes(v, lanes, knc_local);
+        for (int l = 0; l < lanes; l++) {
+            store_lane_key(out_keys[2 * l][round], v[4][l], v[5][l]);
+            store_lane_key(out_keys[2 * l + 1][round], v[6][l], v[7][l]);
+        }
         if (round + 1 < key_count) {
             blake64_optimized_permute(knc_local);
         }
@@ -370,7 +412,112 @@ void blake64_optimized_derive_keys(
         uint8_t out_keys3[][16],
         uint8_t out_keys4[][16]
 ) {
-    // 1) Build two 8-word entropy arrays from init_state
+    uint8_t (*const out_keys[2 * SOA_LANES])[16] = {out_keys1, out_keys2, out_keys3, out_keys4};
+    derive_lanes(init_state, knc, key_count, block_counter, 1, domain, out_keys);
+}
+
+
+/*
+ * Portable `blake64_derive_keys_many`, SOA_COUNTERS counters per pass.
+ */
+void blake64_optimized_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    uint8_t (*streams[2 * SOA_LANES])[16];
+    for (size_t i = 0; i < n; i += SOA_COUNTERS) {
+        const int counters = n - i < SOA_COUNTERS ? (int)(n - i) : SOA_COUNTERS;
+        for (int s = 0; s < 4 * counters; s++) {
+            streams[s] = &out_keys[(4 * i + s) * key_count];
+        }
+        derive_lanes(init_state, knc, key_count, first_counter + i, counters, domain, streams);
+    }
+}
+
+
+/*
+ * Writes two state words as a big-endian 128-bit round key.
+ */
+static void store_round_key(uint8_t out_key[16], const uint64_t words[2]) {
+    for (int w = 0; w < 2; w++) {
+        const uint64_t v = words[w];
+        out_key[8*w + 0] = (uint8_t)(v >> 56);
+        out_key[8*w + 1] = (uint8_t)(v >> 48);
+        out_key[8*w + 2] = (uint8_t)(v >> 40);
+        out_key[8*w + 3] = (uint8_t)(v >> 32);
+        out_key[8*w + 4] = (uint8_t)(v >> 24);
+        out_key[8*w + 5] = (uint8_t)(v >> 16);
+        out_key[8*w + 6] = (uint8_t)(v >>  8);
+        out_key[8*w + 7] = (uint8_t)(v      );
+    }
+}
+
+
+/*
+ * Reduced profile version of `compute_round_keys`, two round keys per mix
+ * step and stream pair, see `blake64_clean_derive_keys_reduced`.
+ */
+static void compute_round_keys_reduced(
+        const uint64_t entropy[8],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+) {
+    uint64_t state_buf[16];
+    uint64_t knc_local[16];
+    uint64_t folded[4];
+
+    for (int i = 0; i < 16; i++) {
+        knc_local[i] = knc[i];
+    }
+
+    blake64_init_state_vector(state_buf, entropy, block_counter, domain);
+    for (int i = 12; i < 16; i++) {
+        state_buf[i] ^= BLAKE64_REDUCED_V1_MASK;
+    }
+
+    for (size_t round = 0; round < key_count; round += 2) {
+        blake64_optimized_mix_state(state_buf, knc_local);
+        store_round_key(out_keys1[round], &state_buf[4]);
+        store_round_key(out_keys2[round], &state_buf[6]);
+
+        if (round + 1 < key_count) {
+            for (int w = 0; w < 4; w++) {
+                folded[w] = state_buf[w] ^ state_buf[8 + w];
+            }
+            store_round_key(out_keys1[round + 1], &folded[0]);
+            store_round_key(out_keys2[round + 1], &folded[2]);
+        }
+        if (round + 2 < key_count) {
+            blake64_optimized_permute(knc_local);
+        }
+    }
+}
+
+
+/*
+ * Scalar version of `blake64_clean_derive_keys_reduced`, the portable
+ * fallback of `blake64_derive_keys_many_reduced`.
+ */
+void blake64_optimized_derive_keys_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t block_counter,
+        const KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+) {
     uint64_t entropy1[8];
     uint64_t entropy2[8];
     for (int i = 0; i < 4; i++) {
@@ -379,26 +526,50 @@ void blake64_optimized_derive_keys(
         entropy1[4 + i]  = init_state[8 + i];
         entropy2[4 + i]  = init_state[12 + i];
     }
+    compute_round_keys_reduced(entropy1, knc, key_count, block_counter, domain, out_keys1, out_keys2);
+    compute_round_keys_reduced(entropy2, knc, key_count, block_counter, domain, out_keys3, out_keys4);
+}
+
 
-    // 2) Derive streams #1 and #2 from entropy1
-    compute_round_keys(
-        entropy1,
-        knc,
-        key_count,
-        block_counter,
-        domain,
-        out_keys1,
-        out_keys2
-    );
-
-    // 3) Derive streams #3 and #4 from entropy2
-    compute_round_keys(
-        entropy2,
-        knc,
-        key_count,
-        block_counter,
-        domain,
-        out_keys3,
-        out_keys4
-    );
-}
\ No newline at end of file
+/*
+ * Starts a key stream at `block_counter`, which then yields the same keys
+ * as `blake64_optimized_derive_keys` one round at a time.
+ */
+void blake64_optimized_key_stream_init(
+        Blake64KeyStream *stream,
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint64_t block_counter,
+        const KDFDomain domain
+) {
+    uint64_t entropy1[8], entropy2[8];
+    for (int i = 0; i < 4; i++) {
+        entropy1[i]      = init_state[i];
+        entropy2[i]      = init_state[4 + i];
+        entropy1[4 + i]  = init_state[8 + i];
+        entropy2[4 + i]  = init_state[12 + i];
+    }
+    blake64_init_state_vector(stream->states[0], entropy1, block_counter, domain);
+    blake64_init_state_vector(stream->states[1], entropy2, block_counter, domain);
+    for (int i = 0; i < 16; i++) {
+        stream->knc[i] = knc[i];
+    }
+}
+
+
+/*
+ * Writes the round keys of the next round, of streams #1 to #4 in that order,
+ * and permutes the knc for the round after it.
+ */
+void blake64_optimized_key_stream_next(
+        Blake64KeyStream *stream,
+        uint8_t out_keys[4][16]
+) {
+    blake64_optimized_mix_state(stream->states[0], stream->knc);
+    blake64_optimized_mix_state(stream->states[1], stream->knc);
+    store_round_key(out_keys[0], &stream->states[0][4]);
+    store_round_key(out_keys[1], &stream->states[0][6]);
+    store_round_key(out_keys[2], &stream->states[1][4]);
+    store_round_key(out_keys[3], &stream->states[1][6]);
+    blake64_optimized_permute(stream->knc);
+}
@@ -0,0 +1,214 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BLAKE64_ROWS_AVX2_H
+#define BLAKE64_ROWS_AVX2_H
+
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+
+#include <stdint.h>
+#include <immintrin.h>
+#include "blake_types.h"
+#include "blake_shared.h"
+
+/*
+ * Row-vector Blake64 round helpers of the AVX2 kernels, see blake32_rows_sse41.h.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+
+static inline AVX2_TARGET __m256i rotr64_by32(const __m256i x) {
+    return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+
+static inline AVX2_TARGET __m256i rotr64_by24(const __m256i x) {
+    const __m256i mask = _mm256_setr_epi8(
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10
+    );
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+
+static inline AVX2_TARGET __m256i rotr64_by16(const __m256i x) {
+    const __m256i mask = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9
+    );
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+
+static inline AVX2_TARGET __m256i rotr64_by63(const __m256i x) {
+    return _mm256_or_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x));
+}
+
+
+/*
+ * Row layout used by the single-state functions: the state matrix is held as
+ * four row vectors {s0..s3}, {s4..s7}, {s8..s11}, {s12..s15}, so that one vector
+ * operation runs the four column (or diagonal) G functions at once. The message
+ * is kept in schedule order {m0, m2, m4, m6}, {m1, m3, m5, m7}, {m8, m10, m12, m14},
+ * {m9, m11, m13, m15}, which are exactly the mx/my operands of both G steps.
+ */
+static inline AVX2_TARGET void g_mix_rows(
+        __m256i *r0,
+        __m256i *r1,
+        __m256i *r2,
+        __m256i *r3,
+        const __m256i mx,
+        const __m256i my
+) {
+    *r0 = _mm256_add_epi64(_mm256_add_epi64(*r0, *r1), mx);
+    *r3 = rotr64_by32(_mm256_xor_si256(*r3, *r0));
+    *r2 = _mm256_add_epi64(*r2, *r3);
+    *r1 = rotr64_by24(_mm256_xor_si256(*r1, *r2));
+
+    *r0 = _mm256_add_epi64(_mm256_add_epi64(*r0, *r1), my);
+    *r3 = rotr64_by16(_mm256_xor_si256(*r3, *r0));
+    *r2 = _mm256_add_epi64(*r2, *r3);
+    *r1 = rotr64_by63(_mm256_xor_si256(*r1, *r2));
+}
+
+
+/*
+ * One round of the mixing function: G over the columns, then over the diagonals,
+ * which are lined up by rotating rows 1..3 left by 1..3 lanes and back again.
+ */
+static inline AVX2_TARGET void mix_rows(__m256i r[4], const __m256i ms[4]) {
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3], ms[0], ms[1]);
+
+    r[1] = _mm256_permute4x64_epi64(r[1], _MM_SHUFFLE(0, 3, 2, 1));
+    r[2] = _mm256_permute4x64_epi64(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_permute4x64_epi64(r[3], _MM_SHUFFLE(2, 1, 0, 3));
+
+    g_mix_rows(&r[0], &r[1], &r[2], &r[3], ms[2], ms[3]);
+
+    r[1] = _mm256_permute4x64_epi64(r[1], _MM_SHUFFLE(2, 1, 0, 3));
+    r[2] = _mm256_permute4x64_epi64(r[2], _MM_SHUFFLE(1, 0, 3, 2));
+    r[3] = _mm256_permute4x64_epi64(r[3], _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+
+/*
+ * Message permutation on schedule-order vectors. Every output word is moved
+ * into place with a lane permute of its source vector and the pieces are
+ * merged with 32-bit blends.
+ */
+static inline AVX2_TARGET void permute_schedule(__m256i ms[4]) {
+    const __m256i x0 = ms[0], y0 = ms[1], x1 = ms[2], y1 = ms[3];
+
+    ms[0] = _mm256_blend_epi32(
+        _mm256_permute4x64_epi64(x0, _MM_SHUFFLE(2, 2, 1, 1)),
+        _mm256_permute4x64_epi64(y0, _MM_SHUFFLE(3, 3, 1, 1)),
+        0x3C
+    );
+    ms[1] = _mm256_blend_epi32(
+        _mm256_blend_epi32(
+            _mm256_permute4x64_epi64(x0, _MM_SHUFFLE(3, 0, 1, 3)),
+            x1,
+            0x0C
+        ),
+        _mm256_permute4x64_epi64(y1, _MM_SHUFFLE(2, 2, 1, 0)),
+        0xC0
+    );
+    ms[2] = _mm256_blend_epi32(
+        _mm256_blend_epi32(
+            y0,
+            _mm256_permute4x64_epi64(x1, _MM_SHUFFLE(3, 2, 2, 0)),
+            0x0C
+        ),
+        _mm256_permute4x64_epi64(y1, _MM_SHUFFLE(3, 0, 1, 0)),
+        0xF0
+    );
+    ms[3] = _mm256_blend_epi32(
+        _mm256_blend_epi32(
+            _mm256_permute4x64_epi64(y1, _MM_SHUFFLE(3, 2, 1, 1)),
+            _mm256_permute4x64_epi64(y0, _MM_SHUFFLE(3, 2, 2, 0)),
+            0x0C
+        ),
+        _mm256_permute4x64_epi64(x1, _MM_SHUFFLE(0, 3, 1, 0)),
+        0xF0
+    );
+}
+
+
+static inline AVX2_TARGET void load_rows(__m256i r[4], const uint64_t words[16]) {
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm256_loadu_si256((const __m256i *)(words + 4 * i));
+    }
+}
+
+
+static inline AVX2_TARGET void store_rows(uint64_t words[16], const __m256i r[4]) {
+    for (int i = 0; i < 4; i++) {
+        _mm256_storeu_si256((__m256i *)(words + 4 * i), r[i]);
+    }
+}
+
+
+static inline AVX2_TARGET void load_schedule(__m256i ms[4], const uint64_t m[16]) {
+    __m256i r[4];
+    load_rows(r, m);
+    for (int i = 0; i < 2; i++) {
+        ms[2 * i] = _mm256_permute4x64_epi64(
+            _mm256_unpacklo_epi64(r[2 * i], r[2 * i + 1]), _MM_SHUFFLE(3, 1, 2, 0)
+        );
+        ms[2 * i + 1] = _mm256_permute4x64_epi64(
+            _mm256_unpackhi_epi64(r[2 * i], r[2 * i + 1]), _MM_SHUFFLE(3, 1, 2, 0)
+        );
+    }
+}
+
+
+static inline AVX2_TARGET void store_schedule(uint64_t m[16], const __m256i ms[4]) {
+    __m256i r[4];
+    for (int i = 0; i < 2; i++) {
+        const __m256i x = _mm256_permute4x64_epi64(ms[2 * i], _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i y = _mm256_permute4x64_epi64(ms[2 * i + 1], _MM_SHUFFLE(3, 1, 2, 0));
+        r[2 * i] = _mm256_unpacklo_epi64(x, y);
+        r[2 * i + 1] = _mm256_unpackhi_epi64(x, y);
+    }
+    store_rows(m, r);
+}
+
+
+/*
+ * Builds the state rows of `blake64_init_state_vector` from the two entropy rows.
+ */
+static inline AVX2_TARGET void init_rows(
+        __m256i r[4],
+        const uint64_t entropy_lo[4],
+        const uint64_t entropy_hi[4],
+        const uint64_t counter,
+        const KDFDomain domain
+) {
+    const __m256i ctr_low = _mm256_set1_epi64x((long long)(uint32_t)counter);
+    const __m256i ctr_high = _mm256_set1_epi64x((long long)(counter >> 32));
+    const __m256i d_mask = _mm256_set1_epi64x((long long)blake64_get_domain_mask(domain));
+
+    r[0] = _mm256_loadu_si256((const __m256i *)IV64);
+    r[1] = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)entropy_lo), ctr_low);
+    r[2] = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)entropy_hi), ctr_high);
+    r[3] = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(IV64 + 4)), d_mask);
+}
+
+#endif
+
+#endif //BLAKE64_ROWS_AVX2_H
@@ -0,0 +1,133 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include "blake_cpu.h"
+
+#if defined(BLAKE_ARCH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+
+static void cpuid(const unsigned int leaf, const unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, (int)leaf, (int)subleaf);
+    for (int i = 0; i < 4; i++) {
+        regs[i] = (unsigned int)out[i];
+    }
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    if (leaf <= __get_cpuid_max(0, NULL)) {
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    }
+#endif
+}
+
+
+static unsigned long long read_xcr0(void) {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+
+/*
+ * Returns non-zero when the CPU supports SSE4.1 (which implies SSSE3).
+ */
+int blake_cpu_has_sse41(void) {
+#if defined(BLAKE_ARCH_X86)
+    unsigned int leaf1[4];
+    cpuid(1, 0, leaf1);
+    const unsigned int sse41_bit = 1u << 19;
+    return (leaf1[2] & sse41_bit) != 0;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU supports AVX2 and the OS saves the YMM state.
+ */
+int blake_cpu_has_avx2(void) {
+#if defined(BLAKE_ARCH_X86)
+    unsigned int leaf1[4], leaf7[4];
+    cpuid(1, 0, leaf1);
+    const unsigned int osxsave_bit = 1u << 27;
+    const unsigned int avx_bit = 1u << 28;
+    if (!(leaf1[2] & osxsave_bit) || !(leaf1[2] & avx_bit)) {
+        return 0;
+    }
+    const unsigned long long ymm_state = 0x6;
+    if ((read_xcr0() & ymm_state) != ymm_state) {
+        return 0;
+    }
+    cpuid(7, 0, leaf7);
+    const unsigned int avx2_bit = 1u << 5;
+    return (leaf7[1] & avx2_bit) != 0;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when the CPU supports AVX-512F/BW and the OS saves the ZMM state.
+ */
+int blake_cpu_has_avx512(void) {
+#if defined(BLAKE_ARCH_X86)
+    unsigned int leaf1[4], leaf7[4];
+    cpuid(1, 0, leaf1);
+    const unsigned int osxsave_bit = 1u << 27;
+    if (!(leaf1[2] & osxsave_bit)) {
+        return 0;
+    }
+    const unsigned long long zmm_state = 0xE6;
+    if ((read_xcr0() & zmm_state) != zmm_state) {
+        return 0;
+    }
+    cpuid(7, 0, leaf7);
+    const unsigned int avx512f_bit = 1u << 16;
+    const unsigned int avx512bw_bit = 1u << 30;
+    return (leaf7[1] & avx512f_bit) && (leaf7[1] & avx512bw_bit);
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * Returns non-zero when `blake_cpu_has_avx512` holds and the CPU also
+ * supports the AVX-512VL encodings for 128/256-bit registers.
+ */
+int blake_cpu_has_avx512vl(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (!blake_cpu_has_avx512()) {
+        return 0;
+    }
+    unsigned int leaf7[4];
+    cpuid(7, 0, leaf7);
+    const unsigned int avx512vl_bit = 1u << 31;
+    return (leaf7[1] & avx512vl_bit) != 0;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,39 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BLAKE_CPU_H
+#define BLAKE_CPU_H
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BLAKE_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BLAKE_ARCH_ARM64 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+    int blake_cpu_has_sse41(void);
+
+    int blake_cpu_has_avx2(void);
+
+    int blake_cpu_has_avx512(void);
+
+    int blake_cpu_has_avx512vl(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //BLAKE_CPU_H
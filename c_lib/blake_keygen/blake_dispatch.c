@@ -0,0 +1,530 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include "blake_keygen.h"
+#include "blake_cpu.h"
+
+
+static DeriveFunc32 detect_derive_keys32(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx2()) {
+        return blake32_avx2_derive_keys;
+    }
+    if (blake_cpu_has_sse41()) {
+        return blake32_sse41_derive_keys;
+    }
+#endif
+#if defined(BLAKE_ARCH_ARM64)
+    return blake32_neon_derive_keys;
+#else
+    return blake32_optimized_derive_keys;
+#endif
+}
+
+
+static DeriveFunc32 selected_derive_keys32 = NULL;
+
+
+/*
+ * Returns the fastest 32-bit derive_keys implementation supported by the
+ * running CPU. The result is cached on first use, detection is deterministic
+ * so concurrent first calls store the same pointer.
+ */
+DeriveFunc32 blake32_select_derive_keys(void) {
+    DeriveFunc32 derive = selected_derive_keys32;
+    if (derive == NULL) {
+        derive = detect_derive_keys32();
+        selected_derive_keys32 = derive;
+    }
+    return derive;
+}
+
+
+static DigestFunc32 detect_digest_context32(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_sse41()) {
+        return blake32_sse41_digest_context;
+    }
+#endif
+#if defined(BLAKE_ARCH_ARM64)
+    return blake32_neon_digest_context;
+#else
+    return blake32_optimized_digest_context;
+#endif
+}
+
+
+static DeriveFunc64 detect_derive_keys64(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512vl()) {
+        return blake64_avx512_derive_keys;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake64_avx2_derive_keys;
+    }
+#endif
+    return blake64_optimized_derive_keys;
+}
+
+
+static DigestFunc64 detect_digest_context64(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512vl()) {
+        return blake64_avx512_digest_context;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake64_avx2_digest_context;
+    }
+#endif
+    return blake64_optimized_digest_context;
+}
+
+
+static DigestFunc32 selected_digest_context32 = NULL;
+static DeriveFunc64 selected_derive_keys64 = NULL;
+static DigestFunc64 selected_digest_context64 = NULL;
+
+
+/*
+ * Returns the fastest 32-bit digest_context implementation supported
+ * by the running CPU, cached like `blake32_select_derive_keys`.
+ */
+DigestFunc32 blake32_select_digest_context(void) {
+    DigestFunc32 digest = selected_digest_context32;
+    if (digest == NULL) {
+        digest = detect_digest_context32();
+        selected_digest_context32 = digest;
+    }
+    return digest;
+}
+
+
+/*
+ * 64-bit version of `blake32_select_derive_keys`.
+ */
+DeriveFunc64 blake64_select_derive_keys(void) {
+    DeriveFunc64 derive = selected_derive_keys64;
+    if (derive == NULL) {
+        derive = detect_derive_keys64();
+        selected_derive_keys64 = derive;
+    }
+    return derive;
+}
+
+
+/*
+ * 64-bit version of `blake32_select_digest_context`.
+ */
+DigestFunc64 blake64_select_digest_context(void) {
+    DigestFunc64 digest = selected_digest_context64;
+    if (digest == NULL) {
+        digest = detect_digest_context64();
+        selected_digest_context64 = digest;
+    }
+    return digest;
+}
+
+
+/*
+ * Portable `blake32_derive_keys_many`, one derive_keys call per counter, or
+ * the lane-interleaved portable keygen when derive_keys is the optimized one.
+ */
+static void derive_keys_many32_fallback(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    const DeriveFunc32 derive_keys = blake32_select_derive_keys();
+    if (derive_keys == blake32_optimized_derive_keys) {
+        blake32_optimized_derive_keys_many(init_state, knc, key_count, first_counter, n, domain, out_keys);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 2 * key_count];
+        derive_keys(init_state, knc, key_count, first_counter + i, domain, &keys[0], &keys[key_count]);
+    }
+}
+
+
+/*
+ * Portable `blake64_derive_keys_many`, one derive_keys call per counter, or
+ * the lane-interleaved portable keygen when derive_keys is the optimized one.
+ */
+static void derive_keys_many64_fallback(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    const DeriveFunc64 derive_keys = blake64_select_derive_keys();
+    if (derive_keys == blake64_optimized_derive_keys) {
+        blake64_optimized_derive_keys_many(init_state, knc, key_count, first_counter, n, domain, out_keys);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 4 * key_count];
+        derive_keys(
+            init_state,
+            knc,
+            key_count,
+            first_counter + i,
+            domain,
+            &keys[0],
+            &keys[key_count],
+            &keys[2 * key_count],
+            &keys[3 * key_count]
+        );
+    }
+}
+
+
+/*
+ * Portable `blake32_derive_keys_jobs`, one derive_keys call per job.
+ */
+static void derive_keys_jobs32_fallback(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    const DeriveFunc32 derive_keys = blake32_select_derive_keys();
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 2 * key_count];
+        const uint32_t *job_state = jobs[i].init_state != NULL ? jobs[i].init_state : init_state;
+        derive_keys(job_state, jobs[i].knc, key_count, jobs[i].counter, jobs[i].domain, &keys[0], &keys[key_count]);
+    }
+}
+
+
+/*
+ * Portable `blake64_derive_keys_jobs`, one derive_keys call per job.
+ */
+static void derive_keys_jobs64_fallback(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    const DeriveFunc64 derive_keys = blake64_select_derive_keys();
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 4 * key_count];
+        derive_keys(
+            jobs[i].init_state != NULL ? jobs[i].init_state : init_state,
+            jobs[i].knc,
+            key_count,
+            jobs[i].counter,
+            jobs[i].domain,
+            &keys[0],
+            &keys[key_count],
+            &keys[2 * key_count],
+            &keys[3 * key_count]
+        );
+    }
+}
+
+
+static DeriveManyFunc32 detect_derive_keys_many32(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512()) {
+        return blake32_avx512_derive_keys_many;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake32_avx2_derive_keys_many;
+    }
+#endif
+    return derive_keys_many32_fallback;
+}
+
+
+static DeriveManyFunc64 detect_derive_keys_many64(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512vl()) {
+        return blake64_avx512_derive_keys_many;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake64_avx2_derive_keys_many;
+    }
+#endif
+    return derive_keys_many64_fallback;
+}
+
+
+static DeriveJobsFunc32 detect_derive_keys_jobs32(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512()) {
+        return blake32_avx512_derive_keys_jobs;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake32_avx2_derive_keys_jobs;
+    }
+#endif
+    return derive_keys_jobs32_fallback;
+}
+
+
+static DeriveJobsFunc64 detect_derive_keys_jobs64(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx512vl()) {
+        return blake64_avx512_derive_keys_jobs;
+    }
+    if (blake_cpu_has_avx2()) {
+        return blake64_avx2_derive_keys_jobs;
+    }
+#endif
+    return derive_keys_jobs64_fallback;
+}
+
+
+static DeriveManyFunc32 selected_derive_keys_many32 = NULL;
+static DeriveManyFunc64 selected_derive_keys_many64 = NULL;
+static DeriveJobsFunc32 selected_derive_keys_jobs32 = NULL;
+static DeriveJobsFunc64 selected_derive_keys_jobs64 = NULL;
+
+
+/*
+ * Derives the round keys of `n` consecutive block counters starting at
+ * `first_counter` into one contiguous buffer. The keys of counter i, stream s
+ * and round r are written to out_keys[(i * 2 + s) * key_count + r], which is
+ * the layout of `n` consecutive blake32 derive_keys calls.
+ */
+void blake32_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    DeriveManyFunc32 derive = selected_derive_keys_many32;
+    if (derive == NULL) {
+        derive = detect_derive_keys_many32();
+        selected_derive_keys_many32 = derive;
+    }
+    derive(init_state, knc, key_count, first_counter, n, domain, out_keys);
+}
+
+
+/*
+ * 64-bit version of `blake32_derive_keys_many`. Every counter yields four
+ * streams, so its keys are written to out_keys[(i * 4 + s) * key_count + r].
+ */
+void blake64_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    DeriveManyFunc64 derive = selected_derive_keys_many64;
+    if (derive == NULL) {
+        derive = detect_derive_keys_many64();
+        selected_derive_keys_many64 = derive;
+    }
+    derive(init_state, knc, key_count, first_counter, n, domain, out_keys);
+}
+
+
+/*
+ * Derives the round keys of a list of independent jobs, each with its own
+ * knc, block counter and domain, so that block groups of different messages
+ * can share the SIMD lanes. Jobs with an init state of their own, which lets
+ * messages under different keys share a pass, use it in place of `init_state`.
+ * The keys of job i are laid out like those of counter i in `blake32_derive_keys_many`.
+ */
+void blake32_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    DeriveJobsFunc32 derive = selected_derive_keys_jobs32;
+    if (derive == NULL) {
+        derive = detect_derive_keys_jobs32();
+        selected_derive_keys_jobs32 = derive;
+    }
+    derive(init_state, jobs, key_count, n, out_keys);
+}
+
+
+/*
+ * 64-bit version of `blake32_derive_keys_jobs`, with the key layout
+ * of `blake64_derive_keys_many`.
+ */
+void blake64_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        const uint8_t key_count,
+        const size_t n,
+        uint8_t out_keys[][16]
+) {
+    DeriveJobsFunc64 derive = selected_derive_keys_jobs64;
+    if (derive == NULL) {
+        derive = detect_derive_keys_jobs64();
+        selected_derive_keys_jobs64 = derive;
+    }
+    derive(init_state, jobs, key_count, n, out_keys);
+}
+
+
+/*
+ * Portable `blake32_derive_keys_many_reduced`, one scalar derive call per counter.
+ */
+static void derive_keys_many32_reduced_fallback(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 2 * key_count];
+        blake32_optimized_derive_keys_reduced(
+            init_state, knc, key_count, first_counter + i, domain, &keys[0], &keys[key_count]
+        );
+    }
+}
+
+
+/*
+ * Portable `blake64_derive_keys_many_reduced`, one scalar derive call per counter.
+ */
+static void derive_keys_many64_reduced_fallback(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t (*keys)[16] = &out_keys[i * 4 * key_count];
+        blake64_optimized_derive_keys_reduced(
+            init_state,
+            knc,
+            key_count,
+            first_counter + i,
+            domain,
+            &keys[0],
+            &keys[key_count],
+            &keys[2 * key_count],
+            &keys[3 * key_count]
+        );
+    }
+}
+
+
+static DeriveManyFunc32 detect_derive_keys_many32_reduced(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx2()) {
+        return blake32_avx2_derive_keys_many_reduced;
+    }
+#endif
+    return derive_keys_many32_reduced_fallback;
+}
+
+
+static DeriveManyFunc64 detect_derive_keys_many64_reduced(void) {
+#if defined(BLAKE_ARCH_X86)
+    if (blake_cpu_has_avx2()) {
+        return blake64_avx2_derive_keys_many_reduced;
+    }
+#endif
+    return derive_keys_many64_reduced_fallback;
+}
+
+
+static DeriveManyFunc32 selected_derive_keys_many32_reduced = NULL;
+static DeriveManyFunc64 selected_derive_keys_many64_reduced = NULL;
+
+
+/*
+ * Reduced profile version of `blake32_derive_keys_many`, with the same key
+ * layout, see `blake32_clean_derive_keys_reduced`. It is not affected by
+ * `blake32_set_derive_keys`, the masked kernel has no reduced profile.
+ */
+void blake32_derive_keys_many_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    DeriveManyFunc32 derive = selected_derive_keys_many32_reduced;
+    if (derive == NULL) {
+        derive = detect_derive_keys_many32_reduced();
+        selected_derive_keys_many32_reduced = derive;
+    }
+    derive(init_state, knc, key_count, first_counter, n, domain, out_keys);
+}
+
+
+/*
+ * 64-bit version of `blake32_derive_keys_many_reduced`, with the
+ * key layout of `blake64_derive_keys_many`.
+ */
+void blake64_derive_keys_many_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t first_counter,
+        const size_t n,
+        const KDFDomain domain,
+        uint8_t out_keys[][16]
+) {
+    DeriveManyFunc64 derive = selected_derive_keys_many64_reduced;
+    if (derive == NULL) {
+        derive = detect_derive_keys_many64_reduced();
+        selected_derive_keys_many64_reduced = derive;
+    }
+    derive(init_state, knc, key_count, first_counter, n, domain, out_keys);
+}
+
+/*
+ * Makes `blake32_select_derive_keys` return `derive` instead of the detected
+ * kernel and routes `blake32_derive_keys_many` and `blake32_derive_keys_jobs`
+ * through it, so that a hardened deployment can run every key derivation
+ * through `blake32_masked_derive_keys`. Passing NULL restores detection.
+ * Must not be called while other threads are deriving keys.
+ */
+void blake32_set_derive_keys(const DeriveFunc32 derive) {
+    selected_derive_keys32 = derive;
+    selected_derive_keys_many32 = derive != NULL ? derive_keys_many32_fallback : NULL;
+    selected_derive_keys_jobs32 = derive != NULL ? derive_keys_jobs32_fallback : NULL;
+}
+
+
+/*
+ * 64-bit version of `blake32_set_derive_keys`.
+ */
+void blake64_set_derive_keys(const DeriveFunc64 derive) {
+    selected_derive_keys64 = derive;
+    selected_derive_keys_many64 = derive != NULL ? derive_keys_many64_fallback : NULL;
+    selected_derive_keys_jobs64 = derive != NULL ? derive_keys_jobs64_fallback : NULL;
+}
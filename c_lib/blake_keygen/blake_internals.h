@@ -12,6 +12,8 @@
 #ifndef BLAKE_INTERNALS_H
 #define BLAKE_INTERNALS_H
 
+#include "blake_cpu.h"
+
 #ifdef __cplusplus
 #include <cstdint>
 extern "C" {
@@ -51,6 +53,22 @@ extern "C" {
     void blake32_optimized_permute(uint32_t m[16]);
     void blake64_optimized_permute(uint64_t m[16]);
 
+#if defined(BLAKE_ARCH_X86)
+    void blake32_sse41_mix_state(uint32_t state[16], const uint32_t m[16]);
+    void blake32_sse41_permute(uint32_t m[16]);
+
+    void blake64_avx2_mix_state(uint64_t state[16], const uint64_t m[16]);
+    void blake64_avx2_permute(uint64_t m[16]);
+
+    void blake64_avx512_mix_state(uint64_t state[16], const uint64_t m[16]);
+    void blake64_avx512_permute(uint64_t m[16]);
+#endif
+
+#if defined(BLAKE_ARCH_ARM64)
+    void blake32_neon_mix_state(uint32_t state[16], const uint32_t m[16]);
+    void blake32_neon_permute(uint32_t m[16]);
+#endif
+
 
 #ifdef __cplusplus
 }
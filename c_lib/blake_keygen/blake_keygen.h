@@ -13,6 +13,7 @@
 #define BLAKE_KEYGEN_H
 
 #include "blake_types.h"
+#include "blake_cpu.h"
 
 #ifdef __cplusplus
 #include <cstdint>
@@ -32,7 +33,7 @@ extern "C" {
     void blake32_clean_digest_context(
         uint32_t state[16],
         const uint32_t key[8],
-        uint32_t context[8]
+        uint32_t context[16]
     );
 
     void blake32_clean_derive_keys(
@@ -56,7 +57,7 @@ extern "C" {
     void blake32_optimized_digest_context(
         uint32_t state[16],
         const uint32_t key[8],
-        uint32_t context[8]
+        uint32_t context[16]
     );
 
     void blake32_optimized_derive_keys(
@@ -69,6 +70,102 @@ extern "C" {
         uint8_t out_keys2[][16]
     );
 
+    void blake32_optimized_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake32_optimized_key_stream_init(
+        Blake32KeyStream *stream,
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain
+    );
+
+    void blake32_optimized_key_stream_next(
+        Blake32KeyStream *stream,
+        uint8_t out_keys[2][16]
+    );
+
+
+    /* --- First-order masked 32-bit Blake --- */
+    void blake32_masked_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+
+    void blake32_masked_derive_key_shares(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16],
+        uint8_t out_masks[][16]
+    );
+
+
+#if defined(BLAKE_ARCH_X86)
+    /* --- SSE4.1 / AVX2 32-bit Blake --- */
+    void blake32_sse41_digest_context(
+        uint32_t state[16],
+        const uint32_t key[8],
+        uint32_t context[16]
+    );
+
+    void blake32_sse41_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+
+    void blake32_avx2_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+#endif
+
+
+#if defined(BLAKE_ARCH_ARM64)
+    /* --- NEON 32-bit Blake --- */
+    void blake32_neon_digest_context(
+        uint32_t state[16],
+        const uint32_t key[8],
+        uint32_t context[16]
+    );
+
+    void blake32_neon_derive_keys(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+#endif
+
 
     /* --- Clean 64-bit Blake --- */
     void blake64_clean_compute_knc(
@@ -80,7 +177,7 @@ extern "C" {
     void blake64_clean_digest_context(
         uint64_t state[16],
         const uint64_t key[8],
-        uint64_t context[8]
+        uint64_t context[16]
     );
 
     void blake64_clean_derive_keys(
@@ -106,7 +203,7 @@ extern "C" {
     void blake64_optimized_digest_context(
         uint64_t state[16],
         const uint64_t key[8],
-        uint64_t context[8]
+        uint64_t context[16]
     );
 
     void blake64_optimized_derive_keys(
@@ -121,6 +218,316 @@ extern "C" {
         uint8_t out_keys4[][16]
     );
 
+    void blake64_optimized_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_optimized_key_stream_init(
+        Blake64KeyStream *stream,
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint64_t block_counter,
+        KDFDomain domain
+    );
+
+    void blake64_optimized_key_stream_next(
+        Blake64KeyStream *stream,
+        uint8_t out_keys[4][16]
+    );
+
+
+    /* --- First-order masked 64-bit Blake --- */
+    void blake64_masked_derive_keys(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+    );
+
+    void blake64_masked_derive_key_shares(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16],
+        uint8_t out_masks[][16]
+    );
+
+
+#if defined(BLAKE_ARCH_X86)
+    /* --- AVX2 / AVX-512VL 64-bit Blake --- */
+    void blake64_avx2_digest_context(
+        uint64_t state[16],
+        const uint64_t key[8],
+        uint64_t context[16]
+    );
+
+    void blake64_avx2_derive_keys(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+    );
+
+    void blake64_avx512_digest_context(
+        uint64_t state[16],
+        const uint64_t key[8],
+        uint64_t context[16]
+    );
+
+    void blake64_avx512_derive_keys(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+    );
+#endif
+
+
+#if defined(BLAKE_ARCH_X86)
+    /* --- AVX2 / AVX-512 multi-counter and job list Blake --- */
+    void blake32_avx2_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake32_avx512_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_avx2_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_avx512_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake32_avx2_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+    void blake32_avx512_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_avx2_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_avx512_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+#endif
+
+
+    /* --- Reduced keygen profile --- */
+
+    /*
+     * Opt-in profile that takes two round keys from every mix step instead of one,
+     * roughly halving the keygen cost. Its keys differ from the standard profile,
+     * so data encrypted with one profile cannot be decrypted with the other.
+     */
+    #define BLAKE_REDUCED_PROFILE_VERSION 1
+
+    void blake32_clean_derive_keys_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+
+    void blake32_optimized_derive_keys_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16]
+    );
+
+    void blake64_clean_derive_keys_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+    );
+
+    void blake64_optimized_derive_keys_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t block_counter,
+        KDFDomain domain,
+        uint8_t out_keys1[][16],
+        uint8_t out_keys2[][16],
+        uint8_t out_keys3[][16],
+        uint8_t out_keys4[][16]
+    );
+
+#if defined(BLAKE_ARCH_X86)
+    void blake32_avx2_derive_keys_many_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_avx2_derive_keys_many_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+#endif
+
+    void blake32_derive_keys_many_reduced(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_derive_keys_many_reduced(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+
+    /* --- Runtime dispatch --- */
+    DeriveFunc32 blake32_select_derive_keys(void);
+
+    DigestFunc32 blake32_select_digest_context(void);
+
+    DeriveFunc64 blake64_select_derive_keys(void);
+
+    DigestFunc64 blake64_select_digest_context(void);
+
+    void blake32_set_derive_keys(DeriveFunc32 derive);
+
+    void blake64_set_derive_keys(DeriveFunc64 derive);
+
+    void blake32_derive_keys_many(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_derive_keys_many(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    void blake32_derive_keys_jobs(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+    void blake64_derive_keys_jobs(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
 
 #ifdef __cplusplus
 }
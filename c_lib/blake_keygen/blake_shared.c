@@ -27,6 +27,11 @@ const uint64_t IV64[8] = {
     0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
 };
 
+/* Source index of every message word in the BLAKE3 permutation, see `blake32_optimized_permute`. */
+const uint8_t MSG_PERMUTATION[16] = {
+    2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8
+};
+
 
 /*
  * Initializes the 16-word state matrix for the compression function.
@@ -26,6 +26,7 @@ extern "C" {
 
     extern const uint32_t IV32[8];
     extern const uint64_t IV64[8];
+    extern const uint8_t MSG_PERMUTATION[16];
 
     inline uint32_t blake32_get_domain_mask(const KDFDomain domain) {
         switch (domain) {
@@ -47,6 +48,14 @@ extern "C" {
         }
     }
 
+    /*
+     * XORed into state[12..15] on top of the domain mask by version 1 of the
+     * reduced keygen profile ("RD01"), so that its keys never coincide with
+     * the keys of the standard profile for the same inputs.
+     */
+    #define BLAKE32_REDUCED_V1_MASK 0x52443031u
+    #define BLAKE64_REDUCED_V1_MASK 0x5244303152443031ULL
+
     inline uint32_t rotr32(const uint32_t x, const uint8_t r) {
         return x >> r | x << (CHAR_BIT * sizeof(uint32_t) - r);
     }
@@ -14,9 +14,11 @@
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <cstddef>
 extern "C" {
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
 
@@ -80,13 +82,13 @@ extern "C" {
     typedef void (*DigestFunc32)(
         uint32_t state[16],
         const uint32_t key[8],
-        uint32_t context[8]
+        uint32_t context[16]
     );
 
     typedef void (*DigestFunc64)(
         uint64_t state[16],
         const uint64_t key[8],
-        uint64_t context[8]
+        uint64_t context[16]
     );
 
     typedef void (*DeriveFunc32)(
@@ -111,6 +113,77 @@ extern "C" {
         uint8_t out_keys4[][16]
     );
 
+    typedef void (*DeriveManyFunc32)(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+    typedef void (*DeriveManyFunc64)(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        uint8_t key_count,
+        uint64_t first_counter,
+        size_t n,
+        KDFDomain domain,
+        uint8_t out_keys[][16]
+    );
+
+
+    /*
+     * One entry of a key derivation job list: the key-nonce composite,
+     * block counter and domain of a single block group, and its init
+     * state, or NULL for the init state passed with the list.
+     */
+    typedef struct {
+        const uint32_t *knc;
+        uint64_t counter;
+        KDFDomain domain;
+        const uint32_t *init_state;
+    } Blake32KeyJob;
+
+    typedef struct {
+        const uint64_t *knc;
+        uint64_t counter;
+        KDFDomain domain;
+        const uint64_t *init_state;
+    } Blake64KeyJob;
+
+    typedef void (*DeriveJobsFunc32)(
+        const uint32_t init_state[16],
+        const Blake32KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+    typedef void (*DeriveJobsFunc64)(
+        const uint64_t init_state[16],
+        const Blake64KeyJob jobs[],
+        uint8_t key_count,
+        size_t n,
+        uint8_t out_keys[][16]
+    );
+
+
+    /*
+     * Incremental round key generator of one block group: the Blake states of both
+     * entropy halves and the knc permuted up to the next round. Each step yields the
+     * keys of one AES round, so the key schedule is never stored as a whole.
+     */
+    typedef struct {
+        uint32_t states[2][16];
+        uint32_t knc[16];
+    } Blake32KeyStream;
+
+    typedef struct {
+        uint64_t states[2][16];
+        uint64_t knc[16];
+    } Blake64KeyStream;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,230 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Encrypts and decrypts files with the memory mapped file API. Key, context and
+ * header are read from files of raw bytes, the nonce is given in hex. Without
+ * --nonce, encryption draws a random nonce and prints it to stdout.
+ *
+ *   aes_blake_cli encrypt|decrypt --in <path> --out <path> --key-file <path>
+ *                 [--variant 256|512] [--nonce <hex>] [--context-file <path>]
+ *                 [--header-file <path>] [--threads <count>]
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_file.h"
+#include "aes_blake_pool.h"
+
+
+typedef struct {
+    int decrypt;
+    int variant;
+    const char *in_path;
+    const char *out_path;
+    const char *key_path;
+    const char *nonce_hex;
+    const char *context_path;
+    const char *header_path;
+    size_t threads;
+} CliOptions;
+
+
+static const char *status_name(const AESBlakeStatus status) {
+    switch (status) {
+        case AESBlakeStatus_OK: return "ok";
+        case AESBlakeStatus_INVALID_LENGTH: return "invalid length";
+        case AESBlakeStatus_AUTH_FAILED: return "authentication failed";
+        case AESBlakeStatus_INVALID_STATE: return "invalid state";
+        case AESBlakeStatus_IO_ERROR: return "i/o error";
+    }
+    return "unknown error";
+}
+
+
+/*
+ * Reads the whole file at `path` into a new buffer. Returns NULL on failure.
+ */
+static uint8_t *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    size_t capacity = 4096;
+    size_t used = 0;
+    uint8_t *data = malloc(capacity);
+    while (data != NULL) {
+        used += fread(data + used, 1, capacity - used, file);
+        if (used < capacity) {
+            break;
+        }
+        uint8_t *grown = realloc(data, 2 * capacity);
+        if (grown == NULL) {
+            free(data);
+        }
+        data = grown;
+        capacity *= 2;
+    }
+    if (data != NULL && ferror(file)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *length = used;
+    return data;
+}
+
+
+/*
+ * Fills `out` from the file at `path`, which must be exactly `length` bytes.
+ */
+static int read_exact(const char *path, uint8_t out[], const size_t length) {
+    size_t read = 0;
+    uint8_t *data = read_file(path, &read);
+    const int ok = data != NULL && read == length;
+    if (ok) {
+        memcpy(out, data, length);
+    } else {
+        fprintf(stderr, "%s must contain exactly %zu bytes\n", path, length);
+    }
+    free(data);
+    return ok;
+}
+
+
+static int parse_hex(const char *hex, uint8_t out[], const size_t length) {
+    if (strlen(hex) != 2 * length) {
+        return 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            return 0;
+        }
+        out[i] = (uint8_t)byte;
+    }
+    return 1;
+}
+
+
+static int parse_options(const int argc, char **argv, CliOptions *options) {
+    if (argc < 2) {
+        return 0;
+    }
+    if (strcmp(argv[1], "encrypt") == 0) {
+        options->decrypt = 0;
+    } else if (strcmp(argv[1], "decrypt") == 0) {
+        options->decrypt = 1;
+    } else {
+        return 0;
+    }
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return 0;
+        }
+        if (strcmp(arg, "--in") == 0) {
+            options->in_path = value;
+        } else if (strcmp(arg, "--out") == 0) {
+            options->out_path = value;
+        } else if (strcmp(arg, "--key-file") == 0) {
+            options->key_path = value;
+        } else if (strcmp(arg, "--variant") == 0) {
+            options->variant = strcmp(value, "256") == 0 ? 256 : strcmp(value, "512") == 0 ? 512 : 0;
+        } else if (strcmp(arg, "--nonce") == 0) {
+            options->nonce_hex = value;
+        } else if (strcmp(arg, "--context-file") == 0) {
+            options->context_path = value;
+        } else if (strcmp(arg, "--header-file") == 0) {
+            options->header_path = value;
+        } else if (strcmp(arg, "--threads") == 0) {
+            options->threads = (size_t)strtoull(value, NULL, 10);
+        } else {
+            return 0;
+        }
+        i++;
+    }
+    return options->in_path != NULL && options->out_path != NULL && options->key_path != NULL &&
+           options->variant != 0 && (options->nonce_hex != NULL || !options->decrypt);
+}
+
+
+int main(const int argc, char **argv) {
+    CliOptions options = {0, 256, NULL, NULL, NULL, NULL, NULL, NULL, 0};
+    if (!parse_options(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s encrypt|decrypt --in <path> --out <path> --key-file <path> "
+                        "[--variant 256|512] [--nonce <hex>] [--context-file <path>] "
+                        "[--header-file <path>] [--threads <count>]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t key_bytes = options.variant == 256 ? AES_BLAKE256_KEY_BYTES : AES_BLAKE512_KEY_BYTES;
+    const size_t nonce_bytes = options.variant == 256 ? AES_BLAKE256_NONCE_BYTES : AES_BLAKE512_NONCE_BYTES;
+    const size_t context_bytes = options.variant == 256 ? AES_BLAKE256_CONTEXT_BYTES : AES_BLAKE512_CONTEXT_BYTES;
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES];
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES] = {0};
+
+    if (!read_exact(options.key_path, key, key_bytes)) {
+        return 1;
+    }
+    if (options.context_path != NULL && !read_exact(options.context_path, context, context_bytes)) {
+        return 1;
+    }
+    if (options.nonce_hex != NULL && !parse_hex(options.nonce_hex, nonce, nonce_bytes)) {
+        fprintf(stderr, "--nonce must be %zu hex digits\n", 2 * nonce_bytes);
+        return 1;
+    }
+    if (options.nonce_hex == NULL) {
+        csprng_read_array(nonce, (uint32_t)nonce_bytes);
+        for (size_t i = 0; i < nonce_bytes; i++) {
+            printf("%02x", nonce[i]);
+        }
+        printf("\n");
+    }
+    size_t header_len = 0;
+    uint8_t *header = NULL;
+    if (options.header_path != NULL && (header = read_file(options.header_path, &header_len)) == NULL) {
+        fprintf(stderr, "cannot read %s\n", options.header_path);
+        return 1;
+    }
+
+    // --threads counts the caller, so a single thread runs without a pool
+    AESBlakePool *pool = NULL;
+    if (options.threads != 1) {
+        pool = aes_blake_pool_create(options.threads == 0 ? 0 : options.threads - 1);
+    }
+
+    AESBlakeStatus status;
+    if (options.variant == 256) {
+        status = options.decrypt
+            ? aes_blake256_decrypt_file(pool, key, nonce, context, header, header_len, options.in_path, options.out_path)
+            : aes_blake256_encrypt_file(pool, key, nonce, context, header, header_len, options.in_path, options.out_path);
+    } else {
+        status = options.decrypt
+            ? aes_blake512_decrypt_file(pool, key, nonce, context, header, header_len, options.in_path, options.out_path)
+            : aes_blake512_encrypt_file(pool, key, nonce, context, header, header_len, options.in_path, options.out_path);
+    }
+
+    aes_blake_pool_destroy(pool);
+    free(header);
+    if (status != AESBlakeStatus_OK) {
+        fprintf(stderr, "%s %s: %s\n", options.decrypt ? "decrypting" : "encrypting", options.in_path, status_name(status));
+        return 1;
+    }
+    return 0;
+}
@@ -11,6 +11,7 @@
 
 #include <catch2/catch_all.hpp>
 #include <random>
+#include <vector>
 #include "aes_block.h"
 
 
@@ -76,3 +77,49 @@ TEST_CASE("Benchmark AES implementations with 1KB data", "[benchmark][aes]") {
         benchmark_aes_1kb(aes_decrypt_optimized, "Optimized AES Decrypt 1KB");
     }
 }
+
+
+/*
+ * Benchmarks one 1KB AES-Blake256 batch (32 groups) of `kernel`. With `pressure` set, a
+ * 32KB buffer standing in for other hot code on the core is read at cache line stride
+ * before every batch, which evicts most of the AES tables from L1 between batches.
+ */
+static void benchmark_tables_1kb(const AES_BlocksFunc kernel, const bool pressure, const char* benchmark_name) {
+    constexpr size_t group_count = 32;
+    constexpr uint8_t key_count = 11;
+    std::vector<uint8_t> data(group_count * 32);
+    std::vector<uint8_t> round_keys(group_count * 2 * key_count * 16);
+    std::vector<uint8_t> other(32 * 1024);
+    generate_random_data(data.data(), data.size());
+    generate_random_data(round_keys.data(), round_keys.size());
+    generate_random_data(other.data(), other.size());
+
+    BENCHMARK(benchmark_name) {
+        uint8_t sink = 0;
+        if (pressure) {
+            for (size_t i = 0; i < other.size(); i += 64) {
+                sink ^= *static_cast<volatile uint8_t *>(&other[i]);
+            }
+        }
+        kernel(
+            data.data(), data.data(), reinterpret_cast<uint8_t (*)[16]>(round_keys.data()), key_count, group_count
+        );
+        return data[0] ^ sink;
+    };
+}
+
+
+TEST_CASE("Benchmark T-table layouts with 1KB data under cache pressure", "[benchmark][aes]") {
+    if (std::getenv("BENCHMARK")) {
+        const AES_Backend *optimized = aes_find_backend("optimized");
+        const AES_Backend *compact = aes_find_backend("compact");
+        benchmark_tables_1kb(optimized->encrypt_x2, false, "Four-table T-table AES-Blake256 Encrypt 1KB, warm");
+        benchmark_tables_1kb(compact->encrypt_x2, false, "Compact T-table AES-Blake256 Encrypt 1KB, warm");
+        benchmark_tables_1kb(optimized->encrypt_x2, true, "Four-table T-table AES-Blake256 Encrypt 1KB, 32KB sweep");
+        benchmark_tables_1kb(compact->encrypt_x2, true, "Compact T-table AES-Blake256 Encrypt 1KB, 32KB sweep");
+        benchmark_tables_1kb(optimized->decrypt_x2, false, "Four-table T-table AES-Blake256 Decrypt 1KB, warm");
+        benchmark_tables_1kb(compact->decrypt_x2, false, "Compact T-table AES-Blake256 Decrypt 1KB, warm");
+        benchmark_tables_1kb(optimized->decrypt_x2, true, "Four-table T-table AES-Blake256 Decrypt 1KB, 32KB sweep");
+        benchmark_tables_1kb(compact->decrypt_x2, true, "Compact T-table AES-Blake256 Decrypt 1KB, 32KB sweep");
+    }
+}
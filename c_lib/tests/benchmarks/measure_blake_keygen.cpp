@@ -28,9 +28,10 @@ static void benchmark_blake32_1kb(
 ) {
     uint32_t zero_key[8]   = {};
     uint32_t zero_nonce[8] = {};
+    uint32_t zero_context[16] = {};
 
     uint32_t init_state[16] = {};
-    digest_fn(init_state, zero_key, zero_nonce);
+    digest_fn(init_state, zero_key, zero_context);
 
     uint32_t knc[16];
     knc_fn(zero_key, zero_nonce, knc);
@@ -69,9 +70,10 @@ static void benchmark_blake64_1kb(
 ) {
     uint64_t zero_key[8]   = {};
     uint64_t zero_nonce[8] = {};
+    uint64_t zero_context[16] = {};
 
     uint64_t init_state[16] = {};
-    digest_fn(init_state, zero_key, zero_nonce);
+    digest_fn(init_state, zero_key, zero_context);
 
     uint64_t knc[16];
     knc_fn(zero_key, zero_nonce, knc);
@@ -101,6 +103,52 @@ static void benchmark_blake64_1kb(
 }
 
 
+/*
+ * Benchmarks keygen for encrypting 1KB of data with one derive_keys_many call,
+ * which derives the keys of all 32 (Blake32) or 16 (Blake64) block counters.
+ */
+static void benchmark_blake32_many_1kb(const DeriveManyFunc32 derive_many_fn, const char* benchmark_name) {
+    uint32_t zero_key[8]   = {};
+    uint32_t zero_nonce[8] = {};
+    uint32_t zero_context[16] = {};
+
+    uint32_t init_state[16] = {};
+    blake32_optimized_digest_context(init_state, zero_key, zero_context);
+
+    uint32_t knc[16];
+    blake32_optimized_compute_knc(zero_key, zero_nonce, knc);
+
+    constexpr size_t key_count = 11;
+    static uint8_t out_keys[32 * 2 * key_count][16];
+
+    BENCHMARK(benchmark_name) {
+        derive_many_fn(init_state, knc, key_count, 0, 32, KDFDomain_MSG, out_keys);
+        return out_keys[0][0]; // Prevent optimization
+    };
+}
+
+
+static void benchmark_blake64_many_1kb(const DeriveManyFunc64 derive_many_fn, const char* benchmark_name) {
+    uint64_t zero_key[8]   = {};
+    uint64_t zero_nonce[8] = {};
+    uint64_t zero_context[16] = {};
+
+    uint64_t init_state[16] = {};
+    blake64_optimized_digest_context(init_state, zero_key, zero_context);
+
+    uint64_t knc[16];
+    blake64_optimized_compute_knc(zero_key, zero_nonce, knc);
+
+    constexpr size_t key_count = 11;
+    static uint8_t out_keys[16 * 4 * key_count][16];
+
+    BENCHMARK(benchmark_name) {
+        derive_many_fn(init_state, knc, key_count, 0, 16, KDFDomain_MSG, out_keys);
+        return out_keys[0][0]; // Prevent optimization
+    };
+}
+
+
 TEST_CASE("Benchmark BLAKE key generation (1KB)", "[benchmark][keygen]") {
     if (std::getenv("BENCHMARK")) {
         benchmark_blake32_1kb(
@@ -127,5 +175,55 @@ TEST_CASE("Benchmark BLAKE key generation (1KB)", "[benchmark][keygen]") {
             blake64_optimized_derive_keys,
             "Optimized Blake64 Keygen 1KB"
         );
+#if defined(BLAKE_ARCH_X86)
+        if (blake_cpu_has_sse41()) {
+            benchmark_blake32_1kb(
+                blake32_optimized_compute_knc,
+                blake32_sse41_digest_context,
+                blake32_sse41_derive_keys,
+                "SSE4.1 Blake32 Keygen 1KB"
+            );
+        }
+        if (blake_cpu_has_avx2()) {
+            benchmark_blake32_1kb(
+                blake32_optimized_compute_knc,
+                blake32_optimized_digest_context,
+                blake32_avx2_derive_keys,
+                "AVX2 Blake32 Keygen 1KB"
+            );
+        }
+#endif
+#if defined(BLAKE_ARCH_ARM64)
+        benchmark_blake32_1kb(
+            blake32_optimized_compute_knc,
+            blake32_neon_digest_context,
+            blake32_neon_derive_keys,
+            "NEON Blake32 Keygen 1KB"
+        );
+#endif
+#if defined(BLAKE_ARCH_X86)
+        if (blake_cpu_has_avx2()) {
+            benchmark_blake32_many_1kb(blake32_avx2_derive_keys_many, "AVX2 Blake32 Keygen Many 1KB");
+            benchmark_blake64_many_1kb(blake64_avx2_derive_keys_many, "AVX2 Blake64 Keygen Many 1KB");
+        }
+        if (blake_cpu_has_avx512()) {
+            benchmark_blake32_many_1kb(blake32_avx512_derive_keys_many, "AVX-512 Blake32 Keygen Many 1KB");
+            benchmark_blake64_many_1kb(blake64_avx512_derive_keys_many, "AVX-512 Blake64 Keygen Many 1KB");
+        }
+#endif
+        benchmark_blake32_1kb(
+            blake32_optimized_compute_knc,
+            blake32_optimized_digest_context,
+            blake32_optimized_derive_keys_reduced,
+            "Optimized Blake32 Reduced Keygen 1KB"
+        );
+        benchmark_blake64_1kb(
+            blake64_optimized_compute_knc,
+            blake64_optimized_digest_context,
+            blake64_optimized_derive_keys_reduced,
+            "Optimized Blake64 Reduced Keygen 1KB"
+        );
+        benchmark_blake32_many_1kb(blake32_derive_keys_many_reduced, "Dispatched Blake32 Reduced Keygen Many 1KB");
+        benchmark_blake64_many_1kb(blake64_derive_keys_many_reduced, "Dispatched Blake64 Reduced Keygen Many 1KB");
     }
 }
@@ -0,0 +1,126 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AES_BLAKE_HELPERS_H
+#define AES_BLAKE_HELPERS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_multibuffer.h"
+#include "aes_blake_reduced.h"
+#include "aes_blake_schedule.h"
+#include "aes_blake_tuning.h"
+
+
+    struct AESBlakeReference {
+        const uint8_t *key;
+        const uint8_t *nonce;
+        const uint8_t *context;
+        const uint8_t *plaintext;
+        size_t plaintext_len;
+        const uint8_t *header;
+        size_t header_len;
+        const uint8_t *ciphertext;
+        const uint8_t *auth_tag;
+    };
+
+    // Inputs and outputs of test_reference_inputs.py in the Python reference
+    const AESBlakeReference& aes_blake256_reference();
+    const AESBlakeReference& aes_blake512_reference();
+
+    // Multi-group messages and headers checked against the Python reference
+    const AESBlakeReference& aes_blake256_long_reference();
+    const AESBlakeReference& aes_blake512_long_reference();
+
+    // Random bytes from the library generator, empty for a zero length
+    inline std::vector<uint8_t> random_bytes(const size_t length) {
+        std::vector<uint8_t> data(length);
+        if (length > 0) {
+            csprng_read_array(data.data(), static_cast<uint32_t>(length));
+        }
+        return data;
+    }
+
+    // Sizes and functions of one cipher variant, for tests templated on its key type
+    template <typename Key>
+    struct AESBlakeVariant;
+
+    template <>
+    struct AESBlakeVariant<AESBlake256Key> {
+        using OtherKey = AESBlake512Key;
+        using Ctx = AESBlake256Ctx;
+        using StreamJob = AESBlake256StreamJob;
+        using MultiBuffer = AESBlake256MultiBuffer;
+        static constexpr size_t key_bytes = AES_BLAKE256_KEY_BYTES;
+        static constexpr size_t nonce_bytes = AES_BLAKE256_NONCE_BYTES;
+        static constexpr size_t context_bytes = AES_BLAKE256_CONTEXT_BYTES;
+        static constexpr size_t group_bytes = AES_BLAKE256_GROUP_BYTES;
+        static constexpr size_t tag_bytes = AES_BLAKE256_TAG_BYTES;
+        static constexpr size_t block_count = 2;
+        static constexpr auto key_init = aes_blake256_key_init;
+        static constexpr auto encrypt = aes_blake256_encrypt;
+        static constexpr auto encrypt_with_key = aes_blake256_encrypt_with_key;
+        static constexpr auto reencrypt_parallel_with_key = aes_blake256_reencrypt_parallel_with_key;
+        static constexpr auto reduced_encrypt = aes_blake256_reduced_encrypt;
+        static constexpr auto reduced_decrypt = aes_blake256_reduced_decrypt;
+        static constexpr auto schedule_size = aes_blake256_schedule_size;
+        static constexpr auto schedule_export = aes_blake256_schedule_export;
+        static constexpr auto decrypt_with_schedule = aes_blake256_decrypt_with_schedule;
+        static constexpr auto encrypt_batch_auto = aes_blake256_encrypt_batch_auto;
+        static constexpr auto decrypt_batch_auto = aes_blake256_decrypt_batch_auto;
+        static constexpr auto ctx_init = aes_blake256_ctx_init;
+        static constexpr auto ctx_update_header = aes_blake256_ctx_update_header;
+        static constexpr auto ctx_encrypt_final = aes_blake256_ctx_encrypt_final;
+        static constexpr auto ctx_decrypt_final = aes_blake256_ctx_decrypt_final;
+        static constexpr auto mb_init = aes_blake256_mb_init;
+        static constexpr auto mb_submit = aes_blake256_mb_submit;
+        static constexpr auto mb_flush = aes_blake256_mb_flush;
+        static constexpr auto mb_in_flight = aes_blake256_mb_in_flight;
+    };
+
+    template <>
+    struct AESBlakeVariant<AESBlake512Key> {
+        using OtherKey = AESBlake256Key;
+        using Ctx = AESBlake512Ctx;
+        using StreamJob = AESBlake512StreamJob;
+        using MultiBuffer = AESBlake512MultiBuffer;
+        static constexpr size_t key_bytes = AES_BLAKE512_KEY_BYTES;
+        static constexpr size_t nonce_bytes = AES_BLAKE512_NONCE_BYTES;
+        static constexpr size_t context_bytes = AES_BLAKE512_CONTEXT_BYTES;
+        static constexpr size_t group_bytes = AES_BLAKE512_GROUP_BYTES;
+        static constexpr size_t tag_bytes = AES_BLAKE512_TAG_BYTES;
+        static constexpr size_t block_count = 4;
+        static constexpr auto key_init = aes_blake512_key_init;
+        static constexpr auto encrypt = aes_blake512_encrypt;
+        static constexpr auto encrypt_with_key = aes_blake512_encrypt_with_key;
+        static constexpr auto reencrypt_parallel_with_key = aes_blake512_reencrypt_parallel_with_key;
+        static constexpr auto reduced_encrypt = aes_blake512_reduced_encrypt;
+        static constexpr auto reduced_decrypt = aes_blake512_reduced_decrypt;
+        static constexpr auto schedule_size = aes_blake512_schedule_size;
+        static constexpr auto schedule_export = aes_blake512_schedule_export;
+        static constexpr auto decrypt_with_schedule = aes_blake512_decrypt_with_schedule;
+        static constexpr auto encrypt_batch_auto = aes_blake512_encrypt_batch_auto;
+        static constexpr auto decrypt_batch_auto = aes_blake512_decrypt_batch_auto;
+        static constexpr auto ctx_init = aes_blake512_ctx_init;
+        static constexpr auto ctx_update_header = aes_blake512_ctx_update_header;
+        static constexpr auto ctx_encrypt_final = aes_blake512_ctx_encrypt_final;
+        static constexpr auto ctx_decrypt_final = aes_blake512_ctx_decrypt_final;
+        static constexpr auto mb_init = aes_blake512_mb_init;
+        static constexpr auto mb_submit = aes_blake512_mb_submit;
+        static constexpr auto mb_flush = aes_blake512_mb_flush;
+        static constexpr auto mb_in_flight = aes_blake512_mb_in_flight;
+    };
+
+
+#endif // AES_BLAKE_HELPERS_H
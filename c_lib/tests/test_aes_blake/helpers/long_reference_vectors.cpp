@@ -0,0 +1,170 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include "helpers.h"
+
+
+/*
+ * Long messages and headers that span several engine batches. The plaintext is
+ * bytes(i % 256 for i in range(n)), the header is bytes((i * 7 + 3) % 256 for i in range(n)),
+ * and the key, nonce and context are those of the short reference vectors.
+ */
+template <size_t N>
+static std::array<uint8_t, N> make_plaintext() {
+    std::array<uint8_t, N> data{};
+    for (size_t i = 0; i < N; i++) {
+        data[i] = static_cast<uint8_t>(i % 256);
+    }
+    return data;
+}
+
+
+template <size_t N>
+static std::array<uint8_t, N> make_header() {
+    std::array<uint8_t, N> data{};
+    for (size_t i = 0; i < N; i++) {
+        data[i] = static_cast<uint8_t>((i * 7 + 3) % 256);
+    }
+    return data;
+}
+
+
+
+const AESBlakeReference& aes_blake256_long_reference() {
+    static const auto plaintext = make_plaintext<608>();
+    static const auto header = make_header<288>();
+    static constexpr uint8_t expected_ct[608] = {
+        0xFC, 0xB9, 0x06, 0xCA, 0xA6, 0xDA, 0xAD, 0x1A, 0x2D, 0x09, 0x52, 0x2B, 0x67, 0x5D, 0x85, 0xB1,
+        0x31, 0x1F, 0x54, 0x1B, 0x4B, 0x50, 0xE1, 0xA4, 0xE8, 0x8E, 0xF5, 0xCE, 0x3B, 0xC2, 0xD0, 0xDA,
+        0x11, 0x2B, 0x50, 0x78, 0x68, 0xB5, 0x18, 0xF1, 0x76, 0x39, 0x1D, 0x8D, 0xD7, 0x9A, 0xC0, 0x9B,
+        0x23, 0x6F, 0xA1, 0xEC, 0x41, 0x7A, 0x48, 0x25, 0x46, 0x3D, 0xE7, 0x90, 0x57, 0xDE, 0x06, 0x8A,
+        0x36, 0x44, 0x26, 0xF9, 0x0C, 0x80, 0x39, 0x70, 0x28, 0xDF, 0x5A, 0xE3, 0x3D, 0x3D, 0x33, 0xC2,
+        0x81, 0x4C, 0x23, 0x46, 0xA0, 0x9B, 0x81, 0x49, 0x9F, 0x61, 0x13, 0x79, 0x6A, 0x13, 0x34, 0x6A,
+        0xEB, 0x62, 0xCA, 0x72, 0xB1, 0xB8, 0x59, 0x09, 0xEF, 0x3B, 0x3F, 0xF7, 0x36, 0xBC, 0xED, 0xB1,
+        0x5F, 0x18, 0xDA, 0x2E, 0xEE, 0xFE, 0x61, 0x71, 0x58, 0x9A, 0x2C, 0xC2, 0x06, 0x33, 0x7C, 0x1E,
+        0x75, 0x97, 0x60, 0x71, 0xB1, 0xF3, 0x75, 0xC8, 0xCE, 0xE0, 0xE3, 0xF7, 0x86, 0x5F, 0xEF, 0x4A,
+        0xB6, 0xFB, 0x2C, 0x5F, 0xEB, 0x4F, 0x6B, 0x68, 0xC7, 0x0A, 0x86, 0xF0, 0xB2, 0xE6, 0x4F, 0x4A,
+        0x25, 0x72, 0x66, 0x89, 0xF9, 0x0F, 0x72, 0x16, 0xF4, 0x6B, 0xB2, 0x04, 0xF6, 0x36, 0xCD, 0x6D,
+        0x01, 0x26, 0x0F, 0xF4, 0xB7, 0x0B, 0x92, 0x6C, 0x81, 0xCA, 0xA1, 0x3F, 0x49, 0x43, 0x08, 0x39,
+        0x39, 0x6C, 0x80, 0x09, 0xF9, 0x13, 0xC9, 0x8D, 0xD6, 0x5A, 0xC1, 0xF4, 0x1D, 0x8F, 0xA8, 0x7A,
+        0xD5, 0x58, 0x29, 0x49, 0x9C, 0x12, 0x20, 0xB7, 0x39, 0x3E, 0xFD, 0x75, 0xF5, 0x50, 0xEB, 0x77,
+        0x85, 0x2E, 0xE1, 0x06, 0xEC, 0xEB, 0xCB, 0x80, 0x05, 0xEB, 0x4C, 0x44, 0x5D, 0xF1, 0xD7, 0x03,
+        0xB7, 0xBE, 0xB8, 0x43, 0x9A, 0xEB, 0xAD, 0xDC, 0x60, 0xA4, 0x78, 0xE1, 0x67, 0x51, 0xAF, 0x99,
+        0xFC, 0x36, 0xB5, 0x3A, 0x7F, 0x1F, 0xC4, 0xE5, 0x53, 0x50, 0x16, 0x3E, 0x59, 0xE3, 0x61, 0xA4,
+        0x8B, 0xF5, 0xC2, 0xCD, 0xAE, 0x98, 0x2E, 0xF6, 0x6A, 0x10, 0xFB, 0xAE, 0x79, 0xF0, 0x6C, 0x39,
+        0x76, 0xBC, 0x11, 0xCA, 0xAC, 0xA9, 0xB2, 0xB2, 0x0F, 0xDB, 0xA6, 0x15, 0xE3, 0x92, 0xCE, 0xD7,
+        0xE6, 0xC6, 0xB4, 0xA3, 0x94, 0x77, 0xB8, 0x9B, 0x9E, 0xF5, 0x3C, 0x3F, 0xA1, 0xBD, 0x02, 0x13,
+        0xD1, 0x11, 0x3E, 0x0A, 0x1F, 0x81, 0x2E, 0xD7, 0x22, 0x17, 0x0C, 0x1A, 0x91, 0xBD, 0x8C, 0x72,
+        0x81, 0xF0, 0xB9, 0x8A, 0x1A, 0x4E, 0xCF, 0xEE, 0x6B, 0x31, 0x10, 0xF3, 0x51, 0xDE, 0xEB, 0x78,
+        0x8B, 0xB0, 0x85, 0xEC, 0x7D, 0xE7, 0xDF, 0x0A, 0xBD, 0xCA, 0x67, 0x1D, 0xB9, 0x36, 0x09, 0xD2,
+        0x25, 0xFA, 0x7B, 0x5A, 0x96, 0x05, 0x4E, 0x59, 0x49, 0x8C, 0xCE, 0xE7, 0x69, 0x90, 0x89, 0x40,
+        0x3E, 0x8C, 0x0C, 0x4E, 0x39, 0x33, 0xAD, 0x12, 0x8F, 0x3F, 0xB7, 0x2D, 0x22, 0xB0, 0x23, 0x80,
+        0x6F, 0x40, 0x03, 0x6B, 0xBA, 0xC4, 0xDF, 0x87, 0x70, 0xBE, 0x39, 0x8A, 0xC5, 0x17, 0xFF, 0x97,
+        0xFE, 0xD2, 0x0C, 0x2B, 0xC7, 0x87, 0xD1, 0x8B, 0x16, 0x22, 0x07, 0x6B, 0x2A, 0x4F, 0xFC, 0x7C,
+        0x60, 0x01, 0xE9, 0xBD, 0x1A, 0x3E, 0x9B, 0xA1, 0x3A, 0x8D, 0xDB, 0x3E, 0x4C, 0x53, 0x5C, 0x2E,
+        0xFC, 0x1A, 0x20, 0xCF, 0xAA, 0x27, 0xEF, 0xCE, 0xD9, 0x1B, 0x3A, 0x7C, 0x8D, 0x13, 0x11, 0x70,
+        0xB2, 0xEE, 0x6D, 0xE5, 0xF8, 0x03, 0xD2, 0x21, 0xA7, 0x92, 0x73, 0x10, 0xA3, 0xBA, 0x1B, 0xC8,
+        0xFC, 0xF4, 0x66, 0xC4, 0x8B, 0xA8, 0xDA, 0x34, 0x4A, 0x46, 0x35, 0xAC, 0x59, 0x23, 0xB5, 0xBA,
+        0x71, 0x5F, 0xCB, 0x6A, 0x5C, 0xED, 0x4F, 0x05, 0x8B, 0x90, 0x27, 0x87, 0xE6, 0xD9, 0xB3, 0xD9,
+        0x76, 0xB8, 0x52, 0xEF, 0x02, 0x57, 0x3F, 0x76, 0xAD, 0x3A, 0x33, 0x3E, 0x98, 0xCC, 0x74, 0xAC,
+        0xB8, 0xCE, 0x7B, 0x5E, 0x93, 0x9E, 0xFC, 0x44, 0xD8, 0xC4, 0xFF, 0xE4, 0x39, 0x61, 0x15, 0x52,
+        0xFB, 0x2E, 0x51, 0x3B, 0x6B, 0xA5, 0x75, 0x52, 0x33, 0x69, 0xD4, 0x76, 0x93, 0x2A, 0x6C, 0xFE,
+        0xDF, 0x27, 0x00, 0x4F, 0xD5, 0x38, 0x38, 0x88, 0xE3, 0xD1, 0xB0, 0x0F, 0x1F, 0x9E, 0x2B, 0x88,
+        0xB3, 0x0F, 0x35, 0x98, 0xCD, 0x5F, 0x62, 0x25, 0x50, 0x9B, 0x2D, 0xA0, 0xE5, 0xFA, 0x65, 0x6A,
+        0x36, 0x4B, 0x77, 0x3E, 0xE6, 0x1D, 0xA1, 0x30, 0xC4, 0x1D, 0x4E, 0xE2, 0x96, 0x9B, 0x1D, 0x0D,
+    };
+    static constexpr uint8_t expected_tag[32] = {
+        0xBC, 0xDB, 0xE6, 0xAF, 0x2A, 0x0D, 0x64, 0xF3, 0x13, 0xC3, 0x04, 0x50, 0xB4, 0xE4, 0x2F, 0xE4,
+        0xE7, 0x33, 0x46, 0xA8, 0xB0, 0x02, 0xC5, 0xB1, 0x40, 0x41, 0x3B, 0x75, 0xAF, 0x8F, 0xC7, 0xB4,
+    };
+
+    const AESBlakeReference& base = aes_blake256_reference();
+    static const AESBlakeReference reference = {
+        base.key,
+        base.nonce,
+        base.context,
+        plaintext.data(),
+        plaintext.size(),
+        header.data(),
+        header.size(),
+        expected_ct,
+        expected_tag
+    };
+    return reference;
+}
+
+
+const AESBlakeReference& aes_blake512_long_reference() {
+    static const auto plaintext = make_plaintext<576>();
+    static const auto header = make_header<320>();
+    static constexpr uint8_t expected_ct[576] = {
+        0xD8, 0xFC, 0xB8, 0x5C, 0x1F, 0x41, 0x9D, 0xDB, 0x62, 0xA1, 0xC8, 0x89, 0x3C, 0x3E, 0x0B, 0x31,
+        0x81, 0x16, 0x4B, 0xB1, 0x49, 0x04, 0x6F, 0xE4, 0x85, 0x3D, 0x66, 0x3A, 0x62, 0xC9, 0xA0, 0x7D,
+        0x8C, 0x9F, 0xD2, 0xC8, 0xB5, 0x5E, 0x4A, 0x20, 0x88, 0x78, 0x1D, 0xD2, 0x6E, 0xC2, 0xF8, 0x2F,
+        0x4E, 0xA1, 0x9B, 0xD5, 0x28, 0xE6, 0xC0, 0x3C, 0xD8, 0x5D, 0x97, 0xBE, 0x22, 0x95, 0xD4, 0xEB,
+        0xA6, 0x60, 0x1C, 0xA6, 0x4D, 0x69, 0xDB, 0x0A, 0x17, 0x38, 0x92, 0x62, 0xB4, 0x91, 0xF0, 0x3F,
+        0x18, 0xC1, 0xE7, 0xC1, 0xDB, 0x15, 0x01, 0xF3, 0xB1, 0x93, 0xEF, 0x05, 0x20, 0x42, 0x39, 0x78,
+        0x53, 0xA9, 0xE7, 0x32, 0xB2, 0x50, 0xEA, 0x5A, 0x29, 0x72, 0xE0, 0x8A, 0xF9, 0x9B, 0x84, 0xD4,
+        0xD0, 0xB9, 0x20, 0xD8, 0x18, 0x40, 0xC7, 0xBC, 0x59, 0x77, 0xA0, 0xBF, 0x6B, 0x97, 0xF5, 0x61,
+        0xD4, 0x5B, 0xCB, 0xAD, 0x23, 0xCB, 0x3E, 0xBA, 0x14, 0xC0, 0xC3, 0x9A, 0x77, 0x6D, 0x3B, 0x30,
+        0xA9, 0x6B, 0x3A, 0xE4, 0x4D, 0xE0, 0x1E, 0x7E, 0x29, 0x8F, 0xAC, 0x52, 0xC8, 0x71, 0x33, 0xF5,
+        0x0D, 0x58, 0xDB, 0xD3, 0x95, 0xB8, 0x32, 0xEA, 0x66, 0x5C, 0x81, 0xA7, 0x19, 0x0F, 0xF6, 0x76,
+        0xF0, 0xE4, 0x79, 0x04, 0x8A, 0xFB, 0xF3, 0x65, 0x7A, 0x00, 0xA4, 0x76, 0x89, 0x08, 0xCC, 0x1F,
+        0x27, 0x19, 0x0F, 0xDB, 0x9D, 0x38, 0x6C, 0xF0, 0x98, 0x73, 0x72, 0xC0, 0x30, 0xCC, 0xF7, 0x57,
+        0xA7, 0x9B, 0xF4, 0x81, 0x0F, 0x3F, 0x93, 0xFA, 0x13, 0x1D, 0x0F, 0x1D, 0x67, 0xAD, 0xD8, 0xCE,
+        0x82, 0x7D, 0x55, 0xA9, 0xF5, 0xC0, 0x2F, 0xFE, 0xCB, 0x97, 0x21, 0x9B, 0x3A, 0x76, 0xA2, 0xA3,
+        0xCB, 0xB4, 0xD2, 0x7D, 0x7F, 0x75, 0x6E, 0xD2, 0x15, 0x9C, 0x19, 0xE8, 0xEF, 0xF6, 0x0C, 0xCE,
+        0x23, 0x3B, 0xB2, 0x38, 0x0E, 0x4C, 0x00, 0xA4, 0x1E, 0xD5, 0x46, 0xE4, 0x5F, 0x1F, 0x2E, 0x94,
+        0x5C, 0xB5, 0x7B, 0x9C, 0xF8, 0xFC, 0xB2, 0xAD, 0xEB, 0xBC, 0x9C, 0x07, 0x0C, 0xA5, 0x81, 0xC1,
+        0x35, 0xBB, 0x78, 0x21, 0xF6, 0xE0, 0x2D, 0xE1, 0x00, 0xA8, 0x35, 0x35, 0x1A, 0xCC, 0x20, 0x5A,
+        0x09, 0x4B, 0xF9, 0xFD, 0xCD, 0x40, 0x68, 0xC1, 0xED, 0x57, 0x21, 0x53, 0xEF, 0xD7, 0xB2, 0x36,
+        0x46, 0x95, 0xEC, 0xD3, 0xC7, 0xB0, 0x13, 0x33, 0xED, 0x6F, 0x6F, 0xB2, 0x01, 0xFF, 0x29, 0x68,
+        0x9E, 0x53, 0x32, 0x14, 0x72, 0x39, 0x81, 0x67, 0x34, 0xC9, 0x59, 0xB0, 0x70, 0x30, 0x44, 0x60,
+        0xD6, 0x1D, 0xA1, 0x2F, 0x82, 0x4D, 0x5B, 0x04, 0xE3, 0x18, 0x0B, 0x9F, 0x36, 0x9E, 0x4A, 0x5D,
+        0x1E, 0x90, 0x24, 0x68, 0x1E, 0xE1, 0x33, 0x12, 0x42, 0x26, 0xC3, 0x21, 0x3B, 0x10, 0x1D, 0xD9,
+        0xC3, 0xB3, 0xEE, 0xF5, 0xE7, 0x7F, 0x0F, 0x52, 0x08, 0x40, 0x45, 0xB7, 0x5E, 0xEB, 0x41, 0xCE,
+        0xA6, 0x08, 0xB4, 0x00, 0x5A, 0xAD, 0x83, 0xFD, 0xFA, 0x59, 0x1C, 0xF6, 0x7A, 0x51, 0xA1, 0x3E,
+        0xD2, 0xBF, 0x36, 0xF4, 0x29, 0x95, 0xBE, 0xBE, 0x77, 0xC9, 0x67, 0x03, 0x47, 0xA4, 0x6C, 0x95,
+        0x4E, 0x17, 0x9F, 0x5F, 0x11, 0x54, 0xFC, 0x4A, 0xEA, 0xC9, 0xCE, 0x34, 0xE4, 0x6E, 0x5F, 0xF1,
+        0x23, 0x9A, 0xE4, 0x6B, 0xC7, 0xAA, 0x7E, 0xE5, 0x48, 0x86, 0x67, 0xEF, 0x80, 0x3E, 0xE3, 0xB9,
+        0xEC, 0xCB, 0x51, 0xF4, 0xD4, 0x18, 0x33, 0x11, 0xF3, 0xCA, 0x3E, 0xE4, 0x9E, 0x11, 0xA8, 0x8E,
+        0x32, 0xC1, 0xA9, 0xF6, 0xC2, 0x19, 0x9C, 0x47, 0x96, 0xD2, 0x7D, 0x10, 0x8B, 0x06, 0x55, 0xE7,
+        0x52, 0x8D, 0xFA, 0x31, 0x5B, 0x91, 0x97, 0x16, 0x55, 0x9A, 0x1E, 0x83, 0x58, 0x60, 0xF2, 0x8B,
+        0x01, 0xB4, 0x34, 0x9F, 0x1E, 0xF5, 0x82, 0x58, 0xD4, 0x02, 0x25, 0x85, 0x51, 0x51, 0xD9, 0x1D,
+        0xBC, 0x51, 0xC2, 0xF4, 0x4E, 0x4D, 0x97, 0x36, 0xE6, 0xD5, 0x78, 0x48, 0x5F, 0x27, 0x5E, 0xB8,
+        0x71, 0x81, 0xCA, 0x5E, 0xB9, 0x01, 0x8B, 0x74, 0x6A, 0xAC, 0x07, 0x8B, 0x42, 0x73, 0x45, 0x83,
+        0xFF, 0x20, 0x37, 0x13, 0xAD, 0x4D, 0x51, 0xF3, 0xB6, 0x15, 0x3B, 0x19, 0x9E, 0x97, 0x24, 0xF7,
+    };
+    static constexpr uint8_t expected_tag[64] = {
+        0x44, 0xD9, 0xD7, 0x47, 0x89, 0x83, 0x99, 0x96, 0xF5, 0xC0, 0x03, 0x4B, 0x04, 0xAB, 0xB4, 0xFB,
+        0x8E, 0x0A, 0x26, 0xC9, 0x13, 0x68, 0x0F, 0x60, 0x8A, 0xBB, 0xC9, 0xEC, 0x76, 0x66, 0x1B, 0xD9,
+        0xDB, 0x1B, 0xE4, 0x23, 0xD6, 0x1A, 0x42, 0x05, 0x40, 0x5A, 0x89, 0x95, 0x3A, 0xB5, 0x2C, 0x1A,
+        0x05, 0x16, 0xE0, 0x13, 0xB0, 0x1D, 0xC1, 0x92, 0x7A, 0xC7, 0x0E, 0x5A, 0xF4, 0x50, 0xA8, 0xE0,
+    };
+
+    const AESBlakeReference& base = aes_blake512_reference();
+    static const AESBlakeReference reference = {
+        base.key,
+        base.nonce,
+        base.context,
+        plaintext.data(),
+        plaintext.size(),
+        header.data(),
+        header.size(),
+        expected_ct,
+        expected_tag
+    };
+    return reference;
+}
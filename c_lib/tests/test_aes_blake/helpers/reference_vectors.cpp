@@ -0,0 +1,153 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstdint>
+#include "helpers.h"
+
+
+const AESBlakeReference& aes_blake256_reference() {
+    static constexpr uint8_t key[32] = {
+        0x3A, 0xCC, 0xAB, 0xE8, 0x11, 0x9E, 0xCD, 0x4F, 0xBF, 0x85, 0x50, 0xCC, 0xC4, 0x8B, 0x67, 0xFD,
+        0x43, 0xB3, 0x62, 0x40, 0xC9, 0x24, 0xB4, 0xCC, 0xB2, 0xAC, 0x23, 0x76, 0x47, 0xAC, 0x4A, 0x8E,
+    };
+    static constexpr uint8_t nonce[32] = {
+        0x69, 0xB9, 0xA5, 0x9E, 0xF9, 0xFB, 0x34, 0x25, 0x4E, 0xF7, 0x34, 0x65, 0x4B, 0x5C, 0xBA, 0xA4,
+        0xED, 0x36, 0x17, 0x22, 0xFF, 0x3D, 0x2F, 0x85, 0x47, 0x79, 0xD7, 0xE1, 0x2E, 0xB0, 0xA6, 0x3C,
+    };
+    static constexpr uint8_t context[64] = {
+        0x40, 0x42, 0x44, 0x46, 0x48, 0x4A, 0x4C, 0x4E, 0x50, 0x52, 0x54, 0x56, 0x58, 0x5A, 0x5C, 0x5E,
+        0x60, 0x62, 0x64, 0x66, 0x68, 0x6A, 0x6C, 0x6E, 0x70, 0x72, 0x74, 0x76, 0x78, 0x7A, 0x7C, 0x7E,
+        0x80, 0x82, 0x84, 0x86, 0x88, 0x8A, 0x8C, 0x8E, 0x90, 0x92, 0x94, 0x96, 0x98, 0x9A, 0x9C, 0x9E,
+        0xA0, 0xA2, 0xA4, 0xA6, 0xA8, 0xAA, 0xAC, 0xAE, 0xB0, 0xB2, 0xB4, 0xB6, 0xB8, 0xBA, 0xBC, 0xBE,
+    };
+    static constexpr uint8_t plaintext[128] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+        0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+        0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+        0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+    };
+    static constexpr uint8_t header[128] = {
+        0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+        0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+        0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+        0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+        0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+        0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+    };
+    static constexpr uint8_t expected_ct[128] = {
+        0xFC, 0xB9, 0x06, 0xCA, 0xA6, 0xDA, 0xAD, 0x1A, 0x2D, 0x09, 0x52, 0x2B, 0x67, 0x5D, 0x85, 0xB1,
+        0x31, 0x1F, 0x54, 0x1B, 0x4B, 0x50, 0xE1, 0xA4, 0xE8, 0x8E, 0xF5, 0xCE, 0x3B, 0xC2, 0xD0, 0xDA,
+        0x11, 0x2B, 0x50, 0x78, 0x68, 0xB5, 0x18, 0xF1, 0x76, 0x39, 0x1D, 0x8D, 0xD7, 0x9A, 0xC0, 0x9B,
+        0x23, 0x6F, 0xA1, 0xEC, 0x41, 0x7A, 0x48, 0x25, 0x46, 0x3D, 0xE7, 0x90, 0x57, 0xDE, 0x06, 0x8A,
+        0x36, 0x44, 0x26, 0xF9, 0x0C, 0x80, 0x39, 0x70, 0x28, 0xDF, 0x5A, 0xE3, 0x3D, 0x3D, 0x33, 0xC2,
+        0x81, 0x4C, 0x23, 0x46, 0xA0, 0x9B, 0x81, 0x49, 0x9F, 0x61, 0x13, 0x79, 0x6A, 0x13, 0x34, 0x6A,
+        0xEB, 0x62, 0xCA, 0x72, 0xB1, 0xB8, 0x59, 0x09, 0xEF, 0x3B, 0x3F, 0xF7, 0x36, 0xBC, 0xED, 0xB1,
+        0x5F, 0x18, 0xDA, 0x2E, 0xEE, 0xFE, 0x61, 0x71, 0x58, 0x9A, 0x2C, 0xC2, 0x06, 0x33, 0x7C, 0x1E,
+    };
+    static constexpr uint8_t expected_tag[32] = {
+        0x74, 0x3A, 0x5E, 0xFC, 0x11, 0x57, 0x2D, 0xCB, 0xCC, 0x01, 0x16, 0x07, 0xE4, 0xF1, 0xC1, 0xCE,
+        0xF2, 0x6B, 0x00, 0x62, 0xC3, 0x86, 0x67, 0xD7, 0x57, 0xFE, 0x50, 0x34, 0x78, 0x6E, 0x0A, 0x31,
+    };
+
+    static const AESBlakeReference reference = {
+        key,
+        nonce,
+        context,
+        plaintext,
+        sizeof(plaintext),
+        header,
+        sizeof(header),
+        expected_ct,
+        expected_tag
+    };
+    return reference;
+}
+
+
+const AESBlakeReference& aes_blake512_reference() {
+    static constexpr uint8_t key[64] = {
+        0xF1, 0x48, 0x33, 0x09, 0xCD, 0xB9, 0x40, 0x36, 0xB2, 0x78, 0x2F, 0x5F, 0xCD, 0x48, 0x42, 0x8C,
+        0xCB, 0xBB, 0xF8, 0xB0, 0x08, 0x55, 0x44, 0xAE, 0x41, 0x10, 0x86, 0xE3, 0x77, 0x8B, 0xD9, 0xF6,
+        0xF0, 0x12, 0xC7, 0x84, 0x0F, 0x87, 0x99, 0x08, 0x80, 0x1E, 0xA3, 0xFB, 0xD1, 0xD1, 0x48, 0xCF,
+        0x6D, 0x16, 0xE2, 0xE3, 0xA3, 0x9E, 0xE2, 0x7C, 0x31, 0x52, 0xCE, 0xEB, 0x74, 0xBC, 0xD2, 0x68,
+    };
+    static constexpr uint8_t nonce[64] = {
+        0x87, 0xF2, 0xB3, 0x0B, 0x47, 0xAC, 0xC9, 0x7A, 0xC0, 0x92, 0x22, 0x0D, 0xBA, 0xFB, 0xF2, 0xDC,
+        0xCD, 0xA5, 0x66, 0x5B, 0xE8, 0xDC, 0x7C, 0x1B, 0xFC, 0xFC, 0x96, 0x12, 0x8D, 0xE5, 0x7B, 0xFF,
+        0x35, 0x67, 0x72, 0xE3, 0x99, 0x14, 0x6E, 0xFC, 0xB0, 0x72, 0x85, 0x7D, 0x87, 0xE0, 0x58, 0x59,
+        0x92, 0xC8, 0x2F, 0x66, 0x43, 0x66, 0x31, 0xB5, 0x65, 0x65, 0xCC, 0x16, 0x40, 0xCE, 0x88, 0xA8,
+    };
+    static constexpr uint8_t context[128] = {
+        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+        0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+        0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+        0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+        0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+        0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+        0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    };
+    static constexpr uint8_t plaintext[128] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+        0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+        0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+        0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+    };
+    static constexpr uint8_t header[128] = {
+        0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+        0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+        0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+        0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+        0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+        0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+    };
+    static constexpr uint8_t expected_ct[128] = {
+        0xD8, 0xFC, 0xB8, 0x5C, 0x1F, 0x41, 0x9D, 0xDB, 0x62, 0xA1, 0xC8, 0x89, 0x3C, 0x3E, 0x0B, 0x31,
+        0x81, 0x16, 0x4B, 0xB1, 0x49, 0x04, 0x6F, 0xE4, 0x85, 0x3D, 0x66, 0x3A, 0x62, 0xC9, 0xA0, 0x7D,
+        0x8C, 0x9F, 0xD2, 0xC8, 0xB5, 0x5E, 0x4A, 0x20, 0x88, 0x78, 0x1D, 0xD2, 0x6E, 0xC2, 0xF8, 0x2F,
+        0x4E, 0xA1, 0x9B, 0xD5, 0x28, 0xE6, 0xC0, 0x3C, 0xD8, 0x5D, 0x97, 0xBE, 0x22, 0x95, 0xD4, 0xEB,
+        0xA6, 0x60, 0x1C, 0xA6, 0x4D, 0x69, 0xDB, 0x0A, 0x17, 0x38, 0x92, 0x62, 0xB4, 0x91, 0xF0, 0x3F,
+        0x18, 0xC1, 0xE7, 0xC1, 0xDB, 0x15, 0x01, 0xF3, 0xB1, 0x93, 0xEF, 0x05, 0x20, 0x42, 0x39, 0x78,
+        0x53, 0xA9, 0xE7, 0x32, 0xB2, 0x50, 0xEA, 0x5A, 0x29, 0x72, 0xE0, 0x8A, 0xF9, 0x9B, 0x84, 0xD4,
+        0xD0, 0xB9, 0x20, 0xD8, 0x18, 0x40, 0xC7, 0xBC, 0x59, 0x77, 0xA0, 0xBF, 0x6B, 0x97, 0xF5, 0x61,
+    };
+    static constexpr uint8_t expected_tag[64] = {
+        0x99, 0xF1, 0x62, 0xA4, 0x24, 0x26, 0x13, 0xFA, 0x4E, 0xA4, 0x5E, 0xA3, 0xC3, 0x34, 0x83, 0x74,
+        0x45, 0x69, 0x0F, 0x07, 0x21, 0xF0, 0xFE, 0x01, 0xEF, 0xF6, 0xEA, 0x06, 0x36, 0xE9, 0x1F, 0x62,
+        0x20, 0x19, 0xC6, 0x6C, 0xE4, 0xB3, 0x67, 0x1F, 0x06, 0x68, 0x10, 0x97, 0x32, 0x14, 0x7D, 0x50,
+        0x27, 0x91, 0xF5, 0xA2, 0x4D, 0xDD, 0x5B, 0x66, 0x63, 0xB8, 0x33, 0x3C, 0xD7, 0x79, 0xD2, 0x1E,
+    };
+
+    static const AESBlakeReference reference = {
+        key,
+        nonce,
+        context,
+        plaintext,
+        sizeof(plaintext),
+        header,
+        sizeof(header),
+        expected_ct,
+        expected_tag
+    };
+    return reference;
+}
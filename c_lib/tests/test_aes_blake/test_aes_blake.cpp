@@ -0,0 +1,308 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
+#include "aes_block.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "helpers/helpers.h"
+
+
+static void check_aes_blake256_reference(const AESBlakeReference &ref) {
+    std::vector<uint8_t> ciphertext(ref.plaintext_len);
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+
+    REQUIRE(aes_blake256_encrypt(
+        ref.key, ref.nonce, ref.context,
+        ref.plaintext, ref.plaintext_len,
+        ref.header, ref.header_len,
+        ciphertext.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag, ref.auth_tag, AES_BLAKE256_TAG_BYTES) == 0);
+
+    std::vector<uint8_t> plaintext(ref.plaintext_len);
+    REQUIRE(aes_blake256_decrypt(
+        ref.key, ref.nonce, ref.context,
+        ciphertext.data(), ciphertext.size(),
+        ref.header, ref.header_len,
+        auth_tag, plaintext.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+}
+
+
+TEST_CASE("AES-Blake256 matches Python reference inputs", "[unittest][aes_blake]") {
+    check_aes_blake256_reference(aes_blake256_reference());
+}
+
+
+TEST_CASE("AES-Blake256 matches Python reference inputs across batch boundaries", "[unittest][aes_blake]") {
+    check_aes_blake256_reference(aes_blake256_long_reference());
+}
+
+
+static void check_aes_blake512_reference(const AESBlakeReference &ref) {
+    std::vector<uint8_t> ciphertext(ref.plaintext_len);
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+
+    REQUIRE(aes_blake512_encrypt(
+        ref.key, ref.nonce, ref.context,
+        ref.plaintext, ref.plaintext_len,
+        ref.header, ref.header_len,
+        ciphertext.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag, ref.auth_tag, AES_BLAKE512_TAG_BYTES) == 0);
+
+    std::vector<uint8_t> plaintext(ref.plaintext_len);
+    REQUIRE(aes_blake512_decrypt(
+        ref.key, ref.nonce, ref.context,
+        ciphertext.data(), ciphertext.size(),
+        ref.header, ref.header_len,
+        auth_tag, plaintext.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+}
+
+
+TEST_CASE("AES-Blake512 matches Python reference inputs", "[unittest][aes_blake]") {
+    check_aes_blake512_reference(aes_blake512_reference());
+}
+
+
+TEST_CASE("AES-Blake512 matches Python reference inputs across batch boundaries", "[unittest][aes_blake]") {
+    check_aes_blake512_reference(aes_blake512_long_reference());
+}
+
+
+TEST_CASE("AES-Blake matches Python reference inputs with masked AES and keygen", "[unittest][aes_blake]") {
+    aes_set_backend(aes_find_backend("masked"));
+    blake32_set_derive_keys(blake32_masked_derive_keys);
+    blake64_set_derive_keys(blake64_masked_derive_keys);
+
+    check_aes_blake256_reference(aes_blake256_long_reference());
+    check_aes_blake512_reference(aes_blake512_long_reference());
+
+    // The batch functions go message by message so that the key shares stay apart
+    const auto &ref = aes_blake256_reference();
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, ref.key, ref.context);
+    std::vector<uint8_t> ciphertext(ref.plaintext_len);
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+    AESBlakeMessage msg = {
+        ref.nonce, ref.plaintext, ref.plaintext_len, ref.header, ref.header_len,
+        ciphertext.data(), auth_tag, AESBlakeStatus_INVALID_STATE
+    };
+    REQUIRE(aes_blake256_encrypt_batch(&key_obj, &msg, 1) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag, ref.auth_tag, AES_BLAKE256_TAG_BYTES) == 0);
+
+    aes_set_backend(nullptr);
+    blake32_set_derive_keys(nullptr);
+    blake64_set_derive_keys(nullptr);
+}
+
+
+TEST_CASE("AES-Blake matches Python reference inputs with the T-table backend", "[unittest][aes_blake]") {
+    aes_set_backend(aes_find_backend("optimized"));
+
+    check_aes_blake256_reference(aes_blake256_long_reference());
+    check_aes_blake512_reference(aes_blake512_long_reference());
+
+    aes_set_backend(nullptr);
+}
+
+
+TEST_CASE("AES-Blake256 encrypts and decrypts in-place", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_reference();
+    std::vector<uint8_t> buffer(ref.plaintext, ref.plaintext + ref.plaintext_len);
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+
+    REQUIRE(aes_blake256_encrypt(
+        ref.key, ref.nonce, ref.context,
+        buffer.data(), buffer.size(),
+        ref.header, ref.header_len,
+        buffer.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(buffer.data(), ref.ciphertext, ref.plaintext_len) == 0);
+
+    REQUIRE(aes_blake256_decrypt(
+        ref.key, ref.nonce, ref.context,
+        buffer.data(), buffer.size(),
+        ref.header, ref.header_len,
+        auth_tag, buffer.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(buffer.data(), ref.plaintext, ref.plaintext_len) == 0);
+}
+
+
+TEST_CASE("AES-Blake512 round-trips random data", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES];
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+
+    std::vector<uint8_t> plaintext(64 * AES_BLAKE512_GROUP_BYTES);
+    std::vector<uint8_t> header(3 * AES_BLAKE512_GROUP_BYTES);
+    csprng_read_array(plaintext.data(), static_cast<uint32_t>(plaintext.size()));
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    std::vector<uint8_t> recovered(plaintext.size());
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+
+    REQUIRE(aes_blake512_encrypt(
+        key, nonce, context,
+        plaintext.data(), plaintext.size(),
+        header.data(), header.size(),
+        ciphertext.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(ciphertext != plaintext);
+
+    REQUIRE(aes_blake512_decrypt(
+        key, nonce, context,
+        ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(),
+        auth_tag, recovered.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(recovered == plaintext);
+}
+
+
+TEST_CASE("AES-Blake256 rejects tampered ciphertext, header and auth tag", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_reference();
+    std::vector<uint8_t> plaintext(ref.plaintext_len);
+
+    SECTION("tampered ciphertext") {
+        std::vector<uint8_t> ciphertext(ref.ciphertext, ref.ciphertext + ref.plaintext_len);
+        ciphertext[37] ^= 0x01;
+        REQUIRE(aes_blake256_decrypt(
+            ref.key, ref.nonce, ref.context,
+            ciphertext.data(), ciphertext.size(),
+            ref.header, ref.header_len,
+            ref.auth_tag, plaintext.data()
+        ) == AESBlakeStatus_AUTH_FAILED);
+    }
+
+    SECTION("tampered header") {
+        std::vector<uint8_t> header(ref.header, ref.header + ref.header_len);
+        header[100] ^= 0x80;
+        REQUIRE(aes_blake256_decrypt(
+            ref.key, ref.nonce, ref.context,
+            ref.ciphertext, ref.plaintext_len,
+            header.data(), header.size(),
+            ref.auth_tag, plaintext.data()
+        ) == AESBlakeStatus_AUTH_FAILED);
+    }
+
+    SECTION("tampered auth tag") {
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+        memcpy(auth_tag, ref.auth_tag, sizeof(auth_tag));
+        auth_tag[AES_BLAKE256_TAG_BYTES - 1] ^= 0x10;
+        REQUIRE(aes_blake256_decrypt(
+            ref.key, ref.nonce, ref.context,
+            ref.ciphertext, ref.plaintext_len,
+            ref.header, ref.header_len,
+            auth_tag, plaintext.data()
+        ) == AESBlakeStatus_AUTH_FAILED);
+    }
+}
+
+
+TEST_CASE("AES-Blake zeroes the plaintext buffer when authentication fails", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_reference();
+    std::vector<uint8_t> ciphertext(ref.ciphertext, ref.ciphertext + ref.plaintext_len);
+    std::vector<uint8_t> plaintext(ref.plaintext_len, 0xAA);
+    ciphertext[5] ^= 0x01;
+
+    REQUIRE(aes_blake256_decrypt(
+        ref.key, ref.nonce, ref.context,
+        ciphertext.data(), ciphertext.size(),
+        ref.header, ref.header_len,
+        ref.auth_tag, plaintext.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(plaintext == std::vector<uint8_t>(ref.plaintext_len, 0));
+}
+
+
+TEST_CASE("AES-Blake verify-first decryption never writes forged plaintext", "[unittest][aes_blake]") {
+    const auto &ref256 = aes_blake256_long_reference();
+    REQUIRE(aes_blake256_verify(
+        ref256.key, ref256.nonce, ref256.context,
+        ref256.ciphertext, ref256.plaintext_len,
+        ref256.header, ref256.header_len, ref256.auth_tag
+    ) == AESBlakeStatus_OK);
+
+    std::vector<uint8_t> plaintext256(ref256.plaintext_len);
+    REQUIRE(aes_blake256_decrypt_verified(
+        ref256.key, ref256.nonce, ref256.context,
+        ref256.ciphertext, ref256.plaintext_len,
+        ref256.header, ref256.header_len,
+        ref256.auth_tag, plaintext256.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext256.data(), ref256.plaintext, ref256.plaintext_len) == 0);
+
+    const auto &ref512 = aes_blake512_long_reference();
+    std::vector<uint8_t> buffer(ref512.ciphertext, ref512.ciphertext + ref512.plaintext_len);
+    REQUIRE(aes_blake512_decrypt_verified(
+        ref512.key, ref512.nonce, ref512.context,
+        buffer.data(), buffer.size(),
+        ref512.header, ref512.header_len,
+        ref512.auth_tag, buffer.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(buffer.data(), ref512.plaintext, ref512.plaintext_len) == 0);
+
+    // Forged messages leave the output buffer exactly as it was
+    std::vector<uint8_t> header(ref512.header, ref512.header + ref512.header_len);
+    std::vector<uint8_t> untouched(ref512.plaintext_len, 0xAA);
+    header[0] ^= 0x01;
+    REQUIRE(aes_blake512_verify(
+        ref512.key, ref512.nonce, ref512.context,
+        ref512.ciphertext, ref512.plaintext_len,
+        header.data(), header.size(), ref512.auth_tag
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(aes_blake512_decrypt_verified(
+        ref512.key, ref512.nonce, ref512.context,
+        ref512.ciphertext, ref512.plaintext_len,
+        header.data(), header.size(),
+        ref512.auth_tag, untouched.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(untouched == std::vector<uint8_t>(ref512.plaintext_len, 0xAA));
+}
+
+
+TEST_CASE("AES-Blake rejects lengths that are not multiples of the group size", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE512_KEY_BYTES] = {};
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES] = {};
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES] = {};
+    uint8_t data[2 * AES_BLAKE512_GROUP_BYTES] = {};
+    uint8_t out[2 * AES_BLAKE512_GROUP_BYTES];
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+
+    REQUIRE(aes_blake256_encrypt(
+        key, nonce, context, data, 31, data, 32, out, auth_tag
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(aes_blake256_encrypt(
+        key, nonce, context, data, 32, data, 48, out, auth_tag
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(aes_blake512_encrypt(
+        key, nonce, context, data, 32, data, 64, out, auth_tag
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(aes_blake512_decrypt(
+        key, nonce, context, data, 64, data, 96, auth_tag, out
+    ) == AESBlakeStatus_INVALID_LENGTH);
+}
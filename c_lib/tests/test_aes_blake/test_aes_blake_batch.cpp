@@ -0,0 +1,144 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "helpers/helpers.h"
+
+
+// Group counts of the batch messages; the last one is too large for a shared window
+static constexpr size_t message_groups[] = {1, 2, 0, 4, 1, 3, 1, 2, 1, 1, 40, 1, 2};
+
+
+struct BatchMessage {
+    std::vector<uint8_t> nonce, input, header, output, auth_tag;
+};
+
+
+template <typename Key, typename KeyInitFn, typename EncryptFn, typename BatchFn, typename DecryptBatchFn>
+static void run_batch_test(
+        const AESBlakeReference &ref,
+        const KeyInitFn key_init_fn,
+        const EncryptFn encrypt_with_key_fn,
+        const BatchFn encrypt_batch_fn,
+        const DecryptBatchFn decrypt_batch_fn,
+        const size_t nonce_bytes,
+        const size_t group_bytes,
+        const size_t tag_bytes
+) {
+    Key key_obj;
+    key_init_fn(&key_obj, ref.key, ref.context);
+
+    // The first message is the reference vector, the rest are random
+    std::vector<BatchMessage> data(std::size(message_groups) + 1);
+    data[0].nonce.assign(ref.nonce, ref.nonce + nonce_bytes);
+    data[0].input.assign(ref.plaintext, ref.plaintext + ref.plaintext_len);
+    data[0].header.assign(ref.header, ref.header + ref.header_len);
+    for (size_t i = 1; i < data.size(); i++) {
+        data[i].nonce.resize(nonce_bytes);
+        data[i].input.resize(message_groups[i - 1] * group_bytes);
+        data[i].header.resize((i % 3) * group_bytes);
+        csprng_read_array(data[i].nonce.data(), nonce_bytes);
+        csprng_read_array(data[i].input.data(), data[i].input.size());
+        csprng_read_array(data[i].header.data(), data[i].header.size());
+    }
+
+    std::vector<AESBlakeMessage> msgs(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i].output.resize(data[i].input.size());
+        data[i].auth_tag.resize(tag_bytes);
+        msgs[i] = AESBlakeMessage{
+            data[i].nonce.data(), data[i].input.data(), data[i].input.size(),
+            data[i].header.data(), data[i].header.size(),
+            data[i].output.data(), data[i].auth_tag.data(), AESBlakeStatus_INVALID_STATE
+        };
+    }
+    REQUIRE(encrypt_batch_fn(&key_obj, msgs.data(), msgs.size()) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(data[0].output.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(data[0].auth_tag.data(), ref.auth_tag, tag_bytes) == 0);
+
+    for (auto &d : data) {
+        std::vector<uint8_t> expected_ct(d.input.size()), expected_tag(tag_bytes);
+        REQUIRE(encrypt_with_key_fn(
+            &key_obj, d.nonce.data(), d.input.data(), d.input.size(), d.header.data(), d.header.size(),
+            expected_ct.data(), expected_tag.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(d.output == expected_ct);
+        REQUIRE(d.auth_tag == expected_tag);
+    }
+
+    // Decrypt the ciphertexts back, with one tampered tag and one invalid length
+    std::vector<std::vector<uint8_t>> plaintexts(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        plaintexts[i].assign(data[i].input.size(), 0xAA);
+        msgs[i].input = data[i].output.data();
+        msgs[i].output = plaintexts[i].data();
+        msgs[i].status = AESBlakeStatus_INVALID_STATE;
+    }
+    data[2].auth_tag[5] ^= 0x01;
+    msgs[4].header_len -= 1;
+
+    REQUIRE(decrypt_batch_fn(&key_obj, msgs.data(), msgs.size()) == AESBlakeStatus_AUTH_FAILED);
+    for (size_t i = 0; i < data.size(); i++) {
+        if (i == 2) {
+            REQUIRE(msgs[i].status == AESBlakeStatus_AUTH_FAILED);
+            REQUIRE(plaintexts[i] == std::vector<uint8_t>(plaintexts[i].size(), 0));
+        } else if (i == 4) {
+            REQUIRE(msgs[i].status == AESBlakeStatus_INVALID_LENGTH);
+        } else {
+            REQUIRE(msgs[i].status == AESBlakeStatus_OK);
+            REQUIRE(plaintexts[i] == data[i].input);
+        }
+    }
+}
+
+
+TEST_CASE("AES-Blake256 batch matches single-message encryption", "[unittest][aes_blake]") {
+    for (const auto *ref : {&aes_blake256_reference(), &aes_blake256_long_reference()}) {
+        run_batch_test<AESBlake256Key>(
+            *ref,
+            aes_blake256_key_init,
+            aes_blake256_encrypt_with_key,
+            aes_blake256_encrypt_batch,
+            aes_blake256_decrypt_batch,
+            AES_BLAKE256_NONCE_BYTES,
+            AES_BLAKE256_GROUP_BYTES,
+            AES_BLAKE256_TAG_BYTES
+        );
+    }
+}
+
+
+TEST_CASE("AES-Blake512 batch matches single-message encryption", "[unittest][aes_blake]") {
+    for (const auto *ref : {&aes_blake512_reference(), &aes_blake512_long_reference()}) {
+        run_batch_test<AESBlake512Key>(
+            *ref,
+            aes_blake512_key_init,
+            aes_blake512_encrypt_with_key,
+            aes_blake512_encrypt_batch,
+            aes_blake512_decrypt_batch,
+            AES_BLAKE512_NONCE_BYTES,
+            AES_BLAKE512_GROUP_BYTES,
+            AES_BLAKE512_TAG_BYTES
+        );
+    }
+}
+
+
+TEST_CASE("AES-Blake batch accepts an empty message list", "[unittest][aes_blake]") {
+    AESBlake256Key key256 = {};
+    AESBlake512Key key512 = {};
+    REQUIRE(aes_blake256_encrypt_batch(&key256, nullptr, 0) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake512_decrypt_batch(&key512, nullptr, 0) == AESBlakeStatus_OK);
+}
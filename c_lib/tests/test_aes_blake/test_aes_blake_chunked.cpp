@@ -0,0 +1,245 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_chunked.h"
+#include "aes_blake_pool.h"
+#include "helpers/helpers.h"
+
+
+/*
+ * Decrypts plaintext bytes [offset, offset + length) of `container` the way a
+ * ranged read would, fetching only the located frames.
+ */
+static AESBlakeStatus decrypt_range256(
+        AESBlakePool *pool,
+        const AESBlake256Key *key,
+        const std::vector<uint8_t> &nonce,
+        const std::vector<uint8_t> &header,
+        const std::vector<uint8_t> &container,
+        const uint64_t offset,
+        const size_t length,
+        std::vector<uint8_t> &plaintext
+) {
+    AESBlakeChunkedInfo info;
+    REQUIRE(aes_blake_chunked_parse_header(container.data(), &info) == AESBlakeStatus_OK);
+    uint64_t frames_offset, frames_len;
+    REQUIRE(aes_blake_chunked_locate(&info, offset, length, &frames_offset, &frames_len) == AESBlakeStatus_OK);
+    REQUIRE(frames_offset + frames_len <= container.size());
+    plaintext.assign(length, 0xAA);
+    return aes_blake256_chunked_decrypt_range(
+        pool, key, nonce.data(), container.data(), header.data(), header.size(),
+        container.data() + frames_offset, frames_len, offset, length, plaintext.data()
+    );
+}
+
+
+TEST_CASE("AES-Blake256 chunked container uses the message block counters", "[unittest][aes_blake]") {
+    const auto raw_key = random_bytes(AES_BLAKE256_KEY_BYTES);
+    const auto context = random_bytes(AES_BLAKE256_CONTEXT_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE256_NONCE_BYTES);
+    AESBlake256Key key;
+    aes_blake256_key_init(&key, raw_key.data(), context.data());
+
+    const size_t chunk_bytes = 4096;
+    const auto plaintext = random_bytes(3 * chunk_bytes + 100);
+    AESBlakeChunkedInfo info;
+    REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE256_CHUNKED_VARIANT, plaintext.size(), chunk_bytes) == AESBlakeStatus_OK);
+    REQUIRE(info.chunk_count == 4);
+    REQUIRE(aes_blake_chunked_container_size(&info) == AES_BLAKE_CHUNKED_HEADER_BYTES + 3 * chunk_bytes + 128 + 4 * AES_BLAKE256_TAG_BYTES);
+
+    std::vector<uint8_t> container(aes_blake_chunked_container_size(&info));
+    REQUIRE(aes_blake256_chunked_encrypt(
+        nullptr, &key, nonce.data(), plaintext.data(), plaintext.size(), nullptr, 0, chunk_bytes, container.data()
+    ) == AESBlakeStatus_OK);
+
+    std::vector<uint8_t> padded = plaintext;
+    padded.resize(3 * chunk_bytes + 128, 0);
+    std::vector<uint8_t> ciphertext(padded.size());
+    uint8_t tag[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_encrypt_with_key(
+        &key, nonce.data(), padded.data(), padded.size(), nullptr, 0, ciphertext.data(), tag
+    ) == AESBlakeStatus_OK);
+
+    for (size_t chunk = 0; chunk < 4; chunk++) {
+        const size_t frame = AES_BLAKE_CHUNKED_HEADER_BYTES + chunk * (chunk_bytes + AES_BLAKE256_TAG_BYTES);
+        const size_t len = chunk < 3 ? chunk_bytes : 128;
+        REQUIRE(memcmp(container.data() + frame, ciphertext.data() + chunk * chunk_bytes, len) == 0);
+    }
+
+    AESBlake256Key key_pooled;
+    aes_blake256_key_init(&key_pooled, raw_key.data(), context.data());
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    std::vector<uint8_t> pooled(container.size());
+    REQUIRE(aes_blake256_chunked_encrypt(
+        pool, &key_pooled, nonce.data(), plaintext.data(), plaintext.size(), nullptr, 0, chunk_bytes, pooled.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(pooled == container);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake256 chunked container decrypts arbitrary ranges", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    const auto raw_key = random_bytes(AES_BLAKE256_KEY_BYTES);
+    const auto context = random_bytes(AES_BLAKE256_CONTEXT_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE256_NONCE_BYTES);
+    const auto header = random_bytes(2 * AES_BLAKE256_GROUP_BYTES);
+    AESBlake256Key key;
+    aes_blake256_key_init(&key, raw_key.data(), context.data());
+
+    for (const size_t length : {size_t(0), size_t(1), size_t(4096), size_t(200000)}) {
+        for (const size_t chunk_bytes : {size_t(32), size_t(4096), size_t(AES_BLAKE_CHUNKED_DEFAULT_CHUNK_BYTES)}) {
+            const auto plaintext = random_bytes(length);
+            AESBlakeChunkedInfo info;
+            REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE256_CHUNKED_VARIANT, length, chunk_bytes) == AESBlakeStatus_OK);
+            std::vector<uint8_t> container(aes_blake_chunked_container_size(&info));
+            REQUIRE(aes_blake256_chunked_encrypt(
+                pool, &key, nonce.data(), plaintext.data(), length, header.data(), header.size(), chunk_bytes, container.data()
+            ) == AESBlakeStatus_OK);
+
+            std::vector<std::pair<uint64_t, size_t>> ranges = {{0, length}, {length, 0}, {0, 0}};
+            for (int i = 0; i < 20 && length > 0; i++) {
+                uint64_t bounds[2];
+                csprng_read_array(reinterpret_cast<uint8_t *>(bounds), sizeof(bounds));
+                const uint64_t a = bounds[0] % (length + 1);
+                const uint64_t b = bounds[1] % (length + 1);
+                ranges.emplace_back(a < b ? a : b, static_cast<size_t>(a < b ? b - a : a - b));
+            }
+            for (const auto &[offset, range_len] : ranges) {
+                std::vector<uint8_t> out;
+                REQUIRE(decrypt_range256(pool, &key, nonce, header, container, offset, range_len, out) == AESBlakeStatus_OK);
+                REQUIRE(std::vector<uint8_t>(plaintext.begin() + static_cast<std::ptrdiff_t>(offset),
+                                             plaintext.begin() + static_cast<std::ptrdiff_t>(offset + range_len)) == out);
+            }
+        }
+    }
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake256 chunked container rejects tampering", "[unittest][aes_blake]") {
+    const auto raw_key = random_bytes(AES_BLAKE256_KEY_BYTES);
+    const auto context = random_bytes(AES_BLAKE256_CONTEXT_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE256_NONCE_BYTES);
+    const auto header = random_bytes(AES_BLAKE256_GROUP_BYTES);
+    AESBlake256Key key;
+    aes_blake256_key_init(&key, raw_key.data(), context.data());
+
+    const size_t chunk_bytes = 1024;
+    const auto plaintext = random_bytes(4 * chunk_bytes);
+    AESBlakeChunkedInfo info;
+    REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE256_CHUNKED_VARIANT, plaintext.size(), chunk_bytes) == AESBlakeStatus_OK);
+    std::vector<uint8_t> container(aes_blake_chunked_container_size(&info));
+    REQUIRE(aes_blake256_chunked_encrypt(
+        nullptr, &key, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(), chunk_bytes, container.data()
+    ) == AESBlakeStatus_OK);
+    const size_t frame_bytes = chunk_bytes + AES_BLAKE256_TAG_BYTES;
+    std::vector<uint8_t> out;
+
+    SECTION("Flipped ciphertext and tag bytes fail only in their own chunk") {
+        for (const size_t position : {size_t(0), frame_bytes + 5, 2 * frame_bytes - 1}) {
+            auto tampered = container;
+            tampered[AES_BLAKE_CHUNKED_HEADER_BYTES + position] ^= 0x01;
+            const uint64_t chunk = position / frame_bytes;
+            REQUIRE(decrypt_range256(nullptr, &key, nonce, header, tampered, chunk * chunk_bytes + 10, 10, out) == AESBlakeStatus_AUTH_FAILED);
+            REQUIRE(out == std::vector<uint8_t>(10, 0));
+            REQUIRE(decrypt_range256(nullptr, &key, nonce, header, tampered, 3 * chunk_bytes, chunk_bytes, out) == AESBlakeStatus_OK);
+        }
+    }
+
+    SECTION("Swapped frames fail") {
+        auto tampered = container;
+        std::swap_ranges(
+            tampered.begin() + AES_BLAKE_CHUNKED_HEADER_BYTES,
+            tampered.begin() + static_cast<std::ptrdiff_t>(AES_BLAKE_CHUNKED_HEADER_BYTES + frame_bytes),
+            tampered.begin() + static_cast<std::ptrdiff_t>(AES_BLAKE_CHUNKED_HEADER_BYTES + frame_bytes)
+        );
+        REQUIRE(decrypt_range256(nullptr, &key, nonce, header, tampered, 0, 1, out) == AESBlakeStatus_AUTH_FAILED);
+        REQUIRE(decrypt_range256(nullptr, &key, nonce, header, tampered, chunk_bytes, 1, out) == AESBlakeStatus_AUTH_FAILED);
+    }
+
+    SECTION("A changed index header, user header or nonce fails") {
+        auto truncated = container;
+        truncated[AES_BLAKE_CHUNKED_HEADER_BYTES - 9] -= 1;
+        REQUIRE(decrypt_range256(nullptr, &key, nonce, header, truncated, 0, 100, out) == AESBlakeStatus_AUTH_FAILED);
+
+        auto other_header = header;
+        other_header[0] ^= 0x01;
+        REQUIRE(decrypt_range256(nullptr, &key, nonce, other_header, container, 0, 100, out) == AESBlakeStatus_AUTH_FAILED);
+
+        auto other_nonce = nonce;
+        other_nonce[0] ^= 0x01;
+        REQUIRE(decrypt_range256(nullptr, &key, other_nonce, header, container, 0, 100, out) == AESBlakeStatus_AUTH_FAILED);
+    }
+
+    SECTION("Malformed headers and ranges are rejected") {
+        auto bad_magic = container;
+        bad_magic[0] ^= 0x01;
+        REQUIRE(aes_blake_chunked_parse_header(bad_magic.data(), &info) == AESBlakeStatus_INVALID_LENGTH);
+
+        uint64_t frames_offset, frames_len;
+        REQUIRE(aes_blake_chunked_locate(&info, 1, plaintext.size(), &frames_offset, &frames_len) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE(aes_blake_chunked_locate(&info, 100, 10, &frames_offset, &frames_len) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_chunked_decrypt_range(
+            nullptr, &key, nonce.data(), container.data(), header.data(), header.size(),
+            container.data() + frames_offset, frames_len + 1, 100, 10, out.data()
+        ) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE256_CHUNKED_VARIANT, 100, 48) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE512_CHUNKED_VARIANT, 100, 32) == AESBlakeStatus_INVALID_LENGTH);
+    }
+}
+
+
+TEST_CASE("AES-Blake512 chunked container roundtrips ranges", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    const auto raw_key = random_bytes(AES_BLAKE512_KEY_BYTES);
+    const auto context = random_bytes(AES_BLAKE512_CONTEXT_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE512_NONCE_BYTES);
+    AESBlake512Key key;
+    aes_blake512_key_init(&key, raw_key.data(), context.data());
+
+    const size_t chunk_bytes = 2048;
+    const auto plaintext = random_bytes(50000);
+    AESBlakeChunkedInfo info;
+    REQUIRE(aes_blake_chunked_info_init(&info, AES_BLAKE512_CHUNKED_VARIANT, plaintext.size(), chunk_bytes) == AESBlakeStatus_OK);
+    std::vector<uint8_t> container(aes_blake_chunked_container_size(&info));
+    REQUIRE(aes_blake512_chunked_encrypt(
+        pool, &key, nonce.data(), plaintext.data(), plaintext.size(), nullptr, 0, chunk_bytes, container.data()
+    ) == AESBlakeStatus_OK);
+
+    for (const auto &[offset, length] : std::vector<std::pair<uint64_t, size_t>>{{0, 50000}, {2047, 2}, {49999, 1}, {3000, 20000}}) {
+        uint64_t frames_offset, frames_len;
+        REQUIRE(aes_blake_chunked_locate(&info, offset, length, &frames_offset, &frames_len) == AESBlakeStatus_OK);
+        std::vector<uint8_t> out(length);
+        REQUIRE(aes_blake512_chunked_decrypt_range(
+            pool, &key, nonce.data(), container.data(), nullptr, 0,
+            container.data() + frames_offset, frames_len, offset, length, out.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(out.data(), plaintext.data() + offset, length) == 0);
+    }
+
+    container[container.size() - 1] ^= 0x01;
+    uint64_t frames_offset, frames_len;
+    REQUIRE(aes_blake_chunked_locate(&info, 49990, 10, &frames_offset, &frames_len) == AESBlakeStatus_OK);
+    std::vector<uint8_t> out(10);
+    REQUIRE(aes_blake512_chunked_decrypt_range(
+        pool, &key, nonce.data(), container.data(), nullptr, 0,
+        container.data() + frames_offset, frames_len, 49990, 10, out.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    aes_blake_pool_destroy(pool);
+}
@@ -0,0 +1,205 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_file.h"
+#include "aes_blake_pool.h"
+#include "helpers/helpers.h"
+
+
+namespace fs = std::filesystem;
+
+
+static fs::path temp_file(const std::string &name) {
+    return fs::temp_directory_path() / ("aes_blake_file_test_" + name);
+}
+
+
+static void write_bytes(const fs::path &path, const std::vector<uint8_t> &data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+
+static std::vector<uint8_t> read_bytes(const fs::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+
+TEST_CASE("AES-Blake256 file encryption matches the parallel API on padded input", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    const auto key = random_bytes(AES_BLAKE256_KEY_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE256_NONCE_BYTES);
+    const auto context = random_bytes(AES_BLAKE256_CONTEXT_BYTES);
+    const auto header = random_bytes(2 * AES_BLAKE256_GROUP_BYTES);
+    const fs::path plain_path = temp_file("256_plain");
+    const fs::path cipher_path = temp_file("256_cipher");
+    const fs::path decrypted_path = temp_file("256_decrypted");
+
+    for (const size_t length : {size_t(0), size_t(1), size_t(31), size_t(32), size_t(4095), size_t(4096), size_t(3 << 20) + 5}) {
+        const auto plaintext = random_bytes(length);
+        write_bytes(plain_path, plaintext);
+
+        REQUIRE(aes_blake256_encrypt_file(
+            pool, key.data(), nonce.data(), context.data(),
+            header.data(), header.size(),
+            plain_path.string().c_str(), cipher_path.string().c_str()
+        ) == AESBlakeStatus_OK);
+
+        std::vector<uint8_t> padded = plaintext;
+        padded.push_back(0x80);
+        padded.resize((length / AES_BLAKE256_GROUP_BYTES + 1) * AES_BLAKE256_GROUP_BYTES, 0);
+        std::vector<uint8_t> expected(padded.size() + AES_BLAKE256_TAG_BYTES);
+        REQUIRE(aes_blake256_encrypt_parallel(
+            nullptr, key.data(), nonce.data(), context.data(),
+            padded.data(), padded.size(),
+            header.data(), header.size(),
+            expected.data(), expected.data() + padded.size()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(read_bytes(cipher_path) == expected);
+
+        REQUIRE(aes_blake256_decrypt_file(
+            pool, key.data(), nonce.data(), context.data(),
+            header.data(), header.size(),
+            cipher_path.string().c_str(), decrypted_path.string().c_str()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(read_bytes(decrypted_path) == plaintext);
+    }
+
+    fs::remove(plain_path);
+    fs::remove(cipher_path);
+    fs::remove(decrypted_path);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake512 file encryption roundtrips", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    const auto key = random_bytes(AES_BLAKE512_KEY_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE512_NONCE_BYTES);
+    const auto context = random_bytes(AES_BLAKE512_CONTEXT_BYTES);
+    const fs::path plain_path = temp_file("512_plain");
+    const fs::path cipher_path = temp_file("512_cipher");
+    const fs::path decrypted_path = temp_file("512_decrypted");
+
+    for (const size_t length : {size_t(0), size_t(63), size_t(64), size_t(1 << 20) + 17}) {
+        const auto plaintext = random_bytes(length);
+        write_bytes(plain_path, plaintext);
+
+        REQUIRE(aes_blake512_encrypt_file(
+            pool, key.data(), nonce.data(), context.data(), nullptr, 0,
+            plain_path.string().c_str(), cipher_path.string().c_str()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(fs::file_size(cipher_path) == (length / AES_BLAKE512_GROUP_BYTES + 1) * AES_BLAKE512_GROUP_BYTES + AES_BLAKE512_TAG_BYTES);
+
+        REQUIRE(aes_blake512_decrypt_file(
+            pool, key.data(), nonce.data(), context.data(), nullptr, 0,
+            cipher_path.string().c_str(), decrypted_path.string().c_str()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(read_bytes(decrypted_path) == plaintext);
+    }
+
+    fs::remove(plain_path);
+    fs::remove(cipher_path);
+    fs::remove(decrypted_path);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake file decryption rejects tampered and malformed files", "[unittest][aes_blake]") {
+    const auto key = random_bytes(AES_BLAKE256_KEY_BYTES);
+    const auto nonce = random_bytes(AES_BLAKE256_NONCE_BYTES);
+    const auto context = random_bytes(AES_BLAKE256_CONTEXT_BYTES);
+    const fs::path plain_path = temp_file("bad_plain");
+    const fs::path cipher_path = temp_file("bad_cipher");
+    const fs::path tampered_path = temp_file("bad_tampered");
+    const fs::path decrypted_path = temp_file("bad_decrypted");
+
+    write_bytes(plain_path, random_bytes(1000));
+    REQUIRE(aes_blake256_encrypt_file(
+        nullptr, key.data(), nonce.data(), context.data(), nullptr, 0,
+        plain_path.string().c_str(), cipher_path.string().c_str()
+    ) == AESBlakeStatus_OK);
+    const auto ciphertext = read_bytes(cipher_path);
+
+    auto decrypt = [&](const fs::path &input) {
+        return aes_blake256_decrypt_file(
+            nullptr, key.data(), nonce.data(), context.data(), nullptr, 0,
+            input.string().c_str(), decrypted_path.string().c_str()
+        );
+    };
+
+    for (const size_t position : {size_t(0), ciphertext.size() - AES_BLAKE256_TAG_BYTES - 1, ciphertext.size() - 1}) {
+        auto tampered = ciphertext;
+        tampered[position] ^= 0x01;
+        write_bytes(tampered_path, tampered);
+        REQUIRE(decrypt(tampered_path) == AESBlakeStatus_AUTH_FAILED);
+        REQUIRE_FALSE(fs::exists(decrypted_path));
+    }
+
+    // An existing output survives a failed decryption untouched
+    const auto previous = random_bytes(100);
+    write_bytes(decrypted_path, previous);
+    auto tampered = ciphertext;
+    tampered[0] ^= 0x01;
+    write_bytes(tampered_path, tampered);
+    REQUIRE(decrypt(tampered_path) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(read_bytes(decrypted_path) == previous);
+    for (const auto &entry : fs::directory_iterator(decrypted_path.parent_path())) {
+        REQUIRE(entry.path().filename().string().rfind(decrypted_path.filename().string() + ".", 0) == std::string::npos);
+    }
+    REQUIRE(decrypt(cipher_path) == AESBlakeStatus_OK);
+    REQUIRE(fs::file_size(decrypted_path) == 1000);
+    fs::remove(decrypted_path);
+
+    for (const size_t length : {size_t(0), size_t(AES_BLAKE256_TAG_BYTES), ciphertext.size() - 1}) {
+        write_bytes(tampered_path, std::vector<uint8_t>(ciphertext.begin(), ciphertext.begin() + static_cast<std::ptrdiff_t>(length)));
+        REQUIRE(decrypt(tampered_path) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE_FALSE(fs::exists(decrypted_path));
+    }
+
+    // Authentic files whose last group holds no padding marker are malformed
+    for (const size_t marker : {SIZE_MAX, size_t(AES_BLAKE256_GROUP_BYTES - 1)}) {
+        std::vector<uint8_t> padded(marker == SIZE_MAX ? AES_BLAKE256_GROUP_BYTES : 2 * AES_BLAKE256_GROUP_BYTES, 0);
+        if (marker != SIZE_MAX) {
+            padded[marker] = 0x80;
+        }
+        std::vector<uint8_t> forged(padded.size() + AES_BLAKE256_TAG_BYTES);
+        REQUIRE(aes_blake256_encrypt_parallel(
+            nullptr, key.data(), nonce.data(), context.data(),
+            padded.data(), padded.size(), nullptr, 0,
+            forged.data(), forged.data() + padded.size()
+        ) == AESBlakeStatus_OK);
+        write_bytes(tampered_path, forged);
+        REQUIRE(decrypt(tampered_path) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE_FALSE(fs::exists(decrypted_path));
+    }
+
+    REQUIRE(decrypt(temp_file("missing")) == AESBlakeStatus_IO_ERROR);
+    REQUIRE(aes_blake256_encrypt_file(
+        nullptr, key.data(), nonce.data(), context.data(), nullptr, 0,
+        cipher_path.string().c_str(), cipher_path.string().c_str()
+    ) == AESBlakeStatus_IO_ERROR);
+    REQUIRE(read_bytes(cipher_path) == ciphertext);
+
+    fs::remove(plain_path);
+    fs::remove(cipher_path);
+    fs::remove(tampered_path);
+}
@@ -0,0 +1,139 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include "csprng.h"
+#include "aes_block.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_fused.h"
+
+
+TEST_CASE("AES-Blake256 fused group encryption matches keygen and AES passes", "[unittest][aes_blake]") {
+    if (!aes_blake256_fused_usable()) {
+        SKIP("The selected AES backend has no fused kernel");
+    }
+    constexpr KDFDomain domains[] = {KDFDomain_MSG, KDFDomain_HDR, KDFDomain_CHK};
+
+    for (const KDFDomain domain : domains) {
+        uint32_t init_state[16], knc[16];
+        uint64_t block_counter;
+        uint8_t group[AES_BLAKE256_GROUP_BYTES];
+        csprng_read_array(reinterpret_cast<uint8_t *>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t *>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t *>(&block_counter), sizeof(block_counter));
+        csprng_read_array(group, sizeof(group));
+
+        uint8_t round_keys[2 * AES_BLAKE_ROUNDS][16];
+        uint8_t expected[AES_BLAKE256_GROUP_BYTES];
+        memcpy(expected, group, sizeof(group));
+        blake32_derive_keys_many(init_state, knc, AES_BLAKE_ROUNDS, block_counter, 1, domain, round_keys);
+        aes_encrypt_blocks_x2_optimized(expected, expected, round_keys, AES_BLAKE_ROUNDS, 1);
+
+        aes_blake256_fused_encrypt_group(init_state, knc, block_counter, domain, group);
+        REQUIRE(memcmp(group, expected, sizeof(group)) == 0);
+    }
+}
+
+
+TEST_CASE("AES-Blake512 fused group encryption matches keygen and AES passes", "[unittest][aes_blake]") {
+    if (!aes_blake512_fused_usable()) {
+        SKIP("The selected AES backend has no fused kernel");
+    }
+    constexpr KDFDomain domains[] = {KDFDomain_MSG, KDFDomain_HDR, KDFDomain_CHK};
+
+    for (const KDFDomain domain : domains) {
+        uint64_t init_state[16], knc[16];
+        uint64_t block_counter;
+        uint8_t group[AES_BLAKE512_GROUP_BYTES];
+        csprng_read_array(reinterpret_cast<uint8_t *>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t *>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t *>(&block_counter), sizeof(block_counter));
+        csprng_read_array(group, sizeof(group));
+
+        uint8_t round_keys[4 * AES_BLAKE_ROUNDS][16];
+        uint8_t expected[AES_BLAKE512_GROUP_BYTES];
+        memcpy(expected, group, sizeof(group));
+        blake64_derive_keys_many(init_state, knc, AES_BLAKE_ROUNDS, block_counter, 1, domain, round_keys);
+        aes_encrypt_blocks_x4_optimized(expected, expected, round_keys, AES_BLAKE_ROUNDS, 1);
+
+        aes_blake512_fused_encrypt_group(init_state, knc, block_counter, domain, group);
+        REQUIRE(memcmp(group, expected, sizeof(group)) == 0);
+    }
+}
+
+
+TEST_CASE("AES-Blake256 lazy group encryption matches keygen and AES passes", "[unittest][aes_blake]") {
+    constexpr KDFDomain domains[] = {KDFDomain_MSG, KDFDomain_HDR, KDFDomain_CHK};
+
+    for (const KDFDomain domain : domains) {
+        uint32_t init_state[16], knc[16];
+        uint64_t block_counter;
+        uint8_t group[AES_BLAKE256_GROUP_BYTES];
+        csprng_read_array(reinterpret_cast<uint8_t *>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t *>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t *>(&block_counter), sizeof(block_counter));
+        csprng_read_array(group, sizeof(group));
+
+        uint8_t round_keys[2 * AES_BLAKE_ROUNDS][16];
+        uint8_t expected[AES_BLAKE256_GROUP_BYTES];
+        memcpy(expected, group, sizeof(group));
+        blake32_derive_keys_many(init_state, knc, AES_BLAKE_ROUNDS, block_counter, 1, domain, round_keys);
+        aes_encrypt_blocks_x2_optimized(expected, expected, round_keys, AES_BLAKE_ROUNDS, 1);
+
+        aes_blake256_lazy_encrypt_group(init_state, knc, block_counter, domain, group);
+        REQUIRE(memcmp(group, expected, sizeof(group)) == 0);
+    }
+}
+
+
+TEST_CASE("AES-Blake512 lazy group encryption matches keygen and AES passes", "[unittest][aes_blake]") {
+    constexpr KDFDomain domains[] = {KDFDomain_MSG, KDFDomain_HDR, KDFDomain_CHK};
+
+    for (const KDFDomain domain : domains) {
+        uint64_t init_state[16], knc[16];
+        uint64_t block_counter;
+        uint8_t group[AES_BLAKE512_GROUP_BYTES];
+        csprng_read_array(reinterpret_cast<uint8_t *>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t *>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t *>(&block_counter), sizeof(block_counter));
+        csprng_read_array(group, sizeof(group));
+
+        uint8_t round_keys[4 * AES_BLAKE_ROUNDS][16];
+        uint8_t expected[AES_BLAKE512_GROUP_BYTES];
+        memcpy(expected, group, sizeof(group));
+        blake64_derive_keys_many(init_state, knc, AES_BLAKE_ROUNDS, block_counter, 1, domain, round_keys);
+        aes_encrypt_blocks_x4_optimized(expected, expected, round_keys, AES_BLAKE_ROUNDS, 1);
+
+        aes_blake512_lazy_encrypt_group(init_state, knc, block_counter, domain, group);
+        REQUIRE(memcmp(group, expected, sizeof(group)) == 0);
+    }
+}
+
+
+TEST_CASE("Lazy group encryption is used only with the T-table backend", "[unittest][aes_blake]") {
+    aes_set_backend(aes_find_backend("optimized"));
+    REQUIRE(aes_blake256_lazy_usable());
+    REQUIRE(aes_blake512_lazy_usable());
+
+    blake32_set_derive_keys(blake32_masked_derive_keys);
+    blake64_set_derive_keys(blake64_masked_derive_keys);
+    REQUIRE_FALSE(aes_blake256_lazy_usable());
+    REQUIRE_FALSE(aes_blake512_lazy_usable());
+    blake32_set_derive_keys(nullptr);
+    blake64_set_derive_keys(nullptr);
+
+    aes_set_backend(aes_find_backend("clean"));
+    REQUIRE_FALSE(aes_blake256_lazy_usable());
+    REQUIRE_FALSE(aes_blake512_lazy_usable());
+    aes_set_backend(nullptr);
+}
@@ -0,0 +1,128 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "helpers/helpers.h"
+
+
+static_assert(alignof(AESBlake256Key) == 64);
+static_assert(alignof(AESBlake512Key) == 64);
+
+
+template <
+    typename Key, typename Ctx, typename KeyInitFn, typename EncryptFn, typename EncryptWithKeyFn,
+    typename DecryptWithKeyFn, typename CtxInitFn, typename UpdateFn, typename HeaderFn, typename FinalFn
+>
+static void run_key_object_test(
+        const AESBlakeReference &ref,
+        const KeyInitFn key_init_fn,
+        const EncryptFn encrypt_fn,
+        const EncryptWithKeyFn encrypt_with_key_fn,
+        const DecryptWithKeyFn decrypt_with_key_fn,
+        const CtxInitFn ctx_init_with_key_fn,
+        const UpdateFn update_fn,
+        const HeaderFn header_fn,
+        const FinalFn final_fn,
+        const size_t nonce_bytes,
+        const size_t tag_bytes
+) {
+    Key key_obj;
+    key_init_fn(&key_obj, ref.key, ref.context);
+    REQUIRE(reinterpret_cast<uintptr_t>(&key_obj) % 64 == 0);
+
+    std::vector<uint8_t> ciphertext(ref.plaintext_len);
+    std::vector<uint8_t> plaintext(ref.plaintext_len);
+    std::vector<uint8_t> auth_tag(tag_bytes);
+    REQUIRE(encrypt_with_key_fn(
+        &key_obj, ref.nonce, ref.plaintext, ref.plaintext_len, ref.header, ref.header_len,
+        ciphertext.data(), auth_tag.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag.data(), ref.auth_tag, tag_bytes) == 0);
+
+    REQUIRE(decrypt_with_key_fn(
+        &key_obj, ref.nonce, ref.ciphertext, ref.plaintext_len, ref.header, ref.header_len,
+        ref.auth_tag, plaintext.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+
+    // The same key object serves many nonces and matches the one-shot functions for each
+    const Key snapshot = key_obj;
+    std::vector<uint8_t> nonce(nonce_bytes);
+    std::vector<uint8_t> expected_ct(ref.plaintext_len);
+    std::vector<uint8_t> expected_tag(tag_bytes);
+    for (int i = 0; i < 4; i++) {
+        csprng_read_array(nonce.data(), nonce_bytes);
+        REQUIRE(encrypt_fn(
+            ref.key, nonce.data(), ref.context, ref.plaintext, ref.plaintext_len, ref.header, ref.header_len,
+            expected_ct.data(), expected_tag.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(encrypt_with_key_fn(
+            &key_obj, nonce.data(), ref.plaintext, ref.plaintext_len, ref.header, ref.header_len,
+            ciphertext.data(), auth_tag.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(ciphertext == expected_ct);
+        REQUIRE(auth_tag == expected_tag);
+    }
+    REQUIRE(memcmp(&snapshot, &key_obj, sizeof(Key)) == 0);
+
+    Ctx ctx;
+    ctx_init_with_key_fn(&ctx, &key_obj, ref.nonce);
+    size_t out_len = 0;
+    REQUIRE(update_fn(&ctx, ref.plaintext, ref.plaintext_len, ciphertext.data(), &out_len) == AESBlakeStatus_OK);
+    REQUIRE(out_len == ref.plaintext_len);
+    REQUIRE(header_fn(&ctx, ref.header, ref.header_len) == AESBlakeStatus_OK);
+    REQUIRE(final_fn(&ctx, auth_tag.data()) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag.data(), ref.auth_tag, tag_bytes) == 0);
+}
+
+
+TEST_CASE("AES-Blake256 key object matches Python reference inputs", "[unittest][aes_blake]") {
+    for (const auto *ref : {&aes_blake256_reference(), &aes_blake256_long_reference()}) {
+        run_key_object_test<AESBlake256Key, AESBlake256Ctx>(
+            *ref,
+            aes_blake256_key_init,
+            aes_blake256_encrypt,
+            aes_blake256_encrypt_with_key,
+            aes_blake256_decrypt_with_key,
+            aes_blake256_ctx_init_with_key,
+            aes_blake256_ctx_encrypt_update,
+            aes_blake256_ctx_update_header,
+            aes_blake256_ctx_encrypt_final,
+            AES_BLAKE256_NONCE_BYTES,
+            AES_BLAKE256_TAG_BYTES
+        );
+    }
+}
+
+
+TEST_CASE("AES-Blake512 key object matches Python reference inputs", "[unittest][aes_blake]") {
+    for (const auto *ref : {&aes_blake512_reference(), &aes_blake512_long_reference()}) {
+        run_key_object_test<AESBlake512Key, AESBlake512Ctx>(
+            *ref,
+            aes_blake512_key_init,
+            aes_blake512_encrypt,
+            aes_blake512_encrypt_with_key,
+            aes_blake512_decrypt_with_key,
+            aes_blake512_ctx_init_with_key,
+            aes_blake512_ctx_encrypt_update,
+            aes_blake512_ctx_update_header,
+            aes_blake512_ctx_encrypt_final,
+            AES_BLAKE512_NONCE_BYTES,
+            AES_BLAKE512_TAG_BYTES
+        );
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "aes_blake.h"
+#include "aes_blake_multibuffer.h"
+#include "csprng.h"
+#include "helpers/helpers.h"
+
+
+// Update sizes cycled through per stream, most of them not group-aligned
+static constexpr size_t update_sizes[] = {64, 1, 7, 200, 33, 1460, 0, 31, 96, 3};
+
+
+/*
+ * One stream with its own key, nonce and context. Even streams encrypt their
+ * plaintext, odd ones decrypt the one-shot ciphertext, in the same manager.
+ */
+template <typename Key>
+struct MbStream {
+    using V = AESBlakeVariant<Key>;
+    std::vector<uint8_t> key, nonce, context, plaintext, header, ciphertext, auth_tag, output;
+    typename V::Ctx ctx;
+    typename V::StreamJob job;
+    size_t offset = 0, written = 0, updates = 0;
+    bool decrypt = false, busy = false;
+
+    MbStream(const size_t index, const size_t groups) {
+        key.resize(V::key_bytes);
+        nonce.resize(V::nonce_bytes);
+        context.resize(V::context_bytes);
+        plaintext.resize(groups * V::group_bytes);
+        header.resize((index % 3) * V::group_bytes);
+        ciphertext.resize(plaintext.size());
+        auth_tag.resize(V::tag_bytes);
+        output.resize(plaintext.size() + V::group_bytes);
+        for (auto *buffer : {&key, &nonce, &context, &plaintext, &header}) {
+            csprng_read_array(buffer->data(), static_cast<uint32_t>(buffer->size()));
+        }
+        REQUIRE(V::encrypt(
+            key.data(), nonce.data(), context.data(), plaintext.data(), plaintext.size(),
+            header.data(), header.size(), ciphertext.data(), auth_tag.data()
+        ) == AESBlakeStatus_OK);
+        decrypt = index % 2 == 1;
+        V::ctx_init(&ctx, key.data(), nonce.data(), context.data());
+    }
+
+    const std::vector<uint8_t> &input() const {
+        return decrypt ? ciphertext : plaintext;
+    }
+
+    bool remaining() const {
+        return offset < input().size();
+    }
+
+    void next_job() {
+        const size_t length = std::min(update_sizes[updates++ % std::size(update_sizes)], input().size() - offset);
+        job = typename V::StreamJob{};
+        job.ctx = &ctx;
+        job.input = input().data() + offset;
+        job.input_len = length;
+        job.output = output.data() + written;
+        job.decrypt = decrypt;
+        job.user_data = this;
+        job.status = AESBlakeStatus_INVALID_STATE;
+        offset += length;
+        busy = true;
+    }
+};
+
+
+template <typename Key>
+static void complete(typename AESBlakeVariant<Key>::StreamJob *job) {
+    auto *stream = static_cast<MbStream<Key> *>(job->user_data);
+    REQUIRE(job == &stream->job);
+    REQUIRE(job->status == AESBlakeStatus_OK);
+    REQUIRE(job->output_len % AESBlakeVariant<Key>::group_bytes == 0);
+    stream->written += job->output_len;
+    stream->busy = false;
+}
+
+
+template <typename Key>
+static void check_streams(const size_t lane_count) {
+    using V = AESBlakeVariant<Key>;
+    std::vector<MbStream<Key>> streams;
+    streams.reserve(21);
+    for (size_t i = 0; i < 21; i++) {
+        streams.emplace_back(i, (i * 7) % 40);
+    }
+
+    typename V::MultiBuffer mb;
+    V::mb_init(&mb, lane_count);
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        bool submitted = false;
+        for (auto &stream : streams) {
+            if (!stream.busy && stream.remaining()) {
+                stream.next_job();
+                submitted = progress = true;
+                if (auto *done = V::mb_submit(&mb, &stream.job)) {
+                    complete<Key>(done);
+                }
+            }
+        }
+        if (!submitted) {
+            if (auto *done = V::mb_flush(&mb)) {
+                complete<Key>(done);
+                progress = true;
+            }
+        }
+    }
+    REQUIRE(V::mb_in_flight(&mb) == 0);
+    REQUIRE(V::mb_flush(&mb) == nullptr);
+
+    for (auto &stream : streams) {
+        REQUIRE(stream.written == stream.plaintext.size());
+        REQUIRE(V::ctx_update_header(&stream.ctx, stream.header.data(), stream.header.size()) == AESBlakeStatus_OK);
+        if (stream.decrypt) {
+            REQUIRE(V::ctx_decrypt_final(&stream.ctx, stream.auth_tag.data()) == AESBlakeStatus_OK);
+            REQUIRE(std::equal(stream.plaintext.begin(), stream.plaintext.end(), stream.output.begin()));
+        } else {
+            std::vector<uint8_t> auth_tag(V::tag_bytes);
+            REQUIRE(V::ctx_encrypt_final(&stream.ctx, auth_tag.data()) == AESBlakeStatus_OK);
+            REQUIRE(auth_tag == stream.auth_tag);
+            REQUIRE(std::equal(stream.ciphertext.begin(), stream.ciphertext.end(), stream.output.begin()));
+        }
+    }
+}
+
+
+TEST_CASE("Multi-buffer AES-Blake256 streams match the one-shot engine", "[unittest][aes_blake]") {
+    for (const size_t lane_count : {size_t(0), size_t(1), size_t(5), size_t(AES_BLAKE_MB_MAX_LANES)}) {
+        check_streams<AESBlake256Key>(lane_count);
+    }
+}
+
+
+TEST_CASE("Multi-buffer AES-Blake512 streams match the one-shot engine", "[unittest][aes_blake]") {
+    for (const size_t lane_count : {size_t(0), size_t(3), size_t(AES_BLAKE_MB_MAX_LANES)}) {
+        check_streams<AESBlake512Key>(lane_count);
+    }
+}
+
+
+TEST_CASE("Multi-buffer AES-Blake256 rejects jobs of busy or finished contexts", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE256_KEY_BYTES] = {1}, nonce[AES_BLAKE256_NONCE_BYTES] = {2};
+    uint8_t context[AES_BLAKE256_CONTEXT_BYTES] = {3};
+    uint8_t input[4 * AES_BLAKE256_GROUP_BYTES] = {4}, output[5 * AES_BLAKE256_GROUP_BYTES];
+
+    AESBlake256MultiBuffer mb;
+    aes_blake256_mb_init(&mb, 4);
+    AESBlake256Ctx ctx, header_ctx;
+    aes_blake256_ctx_init(&ctx, key, nonce, context);
+    aes_blake256_ctx_init(&header_ctx, key, nonce, context);
+    REQUIRE(aes_blake256_ctx_update_header(&header_ctx, input, AES_BLAKE256_GROUP_BYTES) == AESBlakeStatus_OK);
+
+    // The first job waits in its lane, a second one of the same context is rejected
+    AESBlake256StreamJob first = {&ctx, input, sizeof(input), output, 0, nullptr, AESBlakeStatus_OK, 0};
+    AESBlake256StreamJob second = first;
+    REQUIRE(aes_blake256_mb_submit(&mb, &first) == nullptr);
+    REQUIRE(aes_blake256_mb_submit(&mb, &second) == &second);
+    REQUIRE(second.status == AESBlakeStatus_INVALID_STATE);
+    REQUIRE(aes_blake256_mb_in_flight(&mb) == 1);
+
+    // Contexts past the message phase take no more message updates
+    AESBlake256StreamJob late = {&header_ctx, input, sizeof(input), output, 0, nullptr, AESBlakeStatus_OK, 0};
+    REQUIRE(aes_blake256_mb_submit(&mb, &late) == &late);
+    REQUIRE(late.status == AESBlakeStatus_INVALID_STATE);
+
+    // Short updates are buffered in the context and return without a pass
+    AESBlake256StreamJob partial = {&ctx, input, 5, output, 0, nullptr, AESBlakeStatus_OK, 0};
+    REQUIRE(aes_blake256_mb_flush(&mb) == &first);
+    REQUIRE(first.status == AESBlakeStatus_OK);
+    REQUIRE(first.output_len == sizeof(input));
+    REQUIRE(aes_blake256_mb_submit(&mb, &partial) == &partial);
+    REQUIRE(partial.status == AESBlakeStatus_OK);
+    REQUIRE(partial.output_len == 0);
+
+    // Once encrypting, the context takes no decrypting jobs
+    AESBlake256StreamJob decrypting = {&ctx, input, sizeof(input), output, 1, nullptr, AESBlakeStatus_OK, 0};
+    REQUIRE(aes_blake256_mb_submit(&mb, &decrypting) == &decrypting);
+    REQUIRE(decrypting.status == AESBlakeStatus_INVALID_STATE);
+    REQUIRE(aes_blake256_mb_flush(&mb) == nullptr);
+}
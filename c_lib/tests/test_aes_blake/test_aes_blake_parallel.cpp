@@ -0,0 +1,409 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "helpers/helpers.h"
+
+
+static void count_task(void *arg, const size_t task_index) {
+    auto *counts = static_cast<std::vector<int>*>(arg);
+    (*counts)[task_index] += 1;
+}
+
+
+TEST_CASE("AES-Blake pool runs every task exactly once", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    REQUIRE(pool != nullptr);
+    REQUIRE(aes_blake_pool_thread_count(pool) == 3);
+
+    for (const size_t task_count : {size_t(0), size_t(1), size_t(7), size_t(AES_BLAKE_POOL_MAX_TASKS)}) {
+        std::vector<int> counts(task_count, 0);
+        aes_blake_pool_run(pool, count_task, &counts, task_count);
+        REQUIRE(counts == std::vector<int>(task_count, 1));
+    }
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake NUMA pool runs every placed task exactly once", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create_numa(3);
+    REQUIRE(pool != nullptr);
+    REQUIRE(aes_blake_pool_thread_count(pool) == 3);
+    const size_t node_count = aes_blake_pool_node_count(pool);
+    REQUIRE(node_count >= 1);
+
+    // Unplaced tasks, tasks on every node and tasks on a node without workers
+    std::vector<int> task_nodes(AES_BLAKE_POOL_MAX_TASKS);
+    for (size_t i = 0; i < task_nodes.size(); i++) {
+        task_nodes[i] = static_cast<int>(i % (node_count + 2)) - 1;
+    }
+    for (const size_t task_count : {size_t(1), size_t(7), size_t(AES_BLAKE_POOL_MAX_TASKS)}) {
+        std::vector<int> counts(task_count, 0);
+        aes_blake_pool_run_placed(pool, count_task, &counts, task_count, task_nodes.data());
+        REQUIRE(counts == std::vector<int>(task_count, 1));
+    }
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake pool reports page nodes within its topology", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create_numa(1);
+    std::vector<uint8_t> buffer(16 * 4096, 0x5A);
+    const void *addrs[3] = {buffer.data(), buffer.data() + buffer.size() / 2, buffer.data() + buffer.size() - 1};
+    int nodes[3];
+
+    aes_blake_pool_page_nodes(pool, addrs, 3, nodes);
+    for (const int node : nodes) {
+        REQUIRE(node >= -1);
+        REQUIRE(node < static_cast<int>(aes_blake_pool_node_count(pool)));
+        if (aes_blake_pool_node_count(pool) == 1) {
+            REQUIRE(node == -1);
+        }
+    }
+    aes_blake_pool_destroy(pool);
+
+    // Plain pools and NULL count as one node
+    AESBlakePool *plain = aes_blake_pool_create(1);
+    REQUIRE(aes_blake_pool_node_count(plain) == 1);
+    REQUIRE(aes_blake_pool_node_count(nullptr) == 1);
+    aes_blake_pool_page_nodes(nullptr, addrs, 3, nodes);
+    REQUIRE((nodes[0] == -1 && nodes[1] == -1 && nodes[2] == -1));
+    aes_blake_pool_destroy(plain);
+}
+
+
+TEST_CASE("AES-Blake pool splits work into bounded tasks", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    REQUIRE(aes_blake_pool_task_count(pool, 0) == 1);
+    REQUIRE(aes_blake_pool_task_count(pool, AES_BLAKE_POOL_MIN_TASK_BYTES - 1) == 1);
+    REQUIRE(aes_blake_pool_task_count(pool, 3 * AES_BLAKE_POOL_MIN_TASK_BYTES) == 3);
+    REQUIRE(aes_blake_pool_task_count(pool, 1000 * AES_BLAKE_POOL_MIN_TASK_BYTES) == 16);
+    REQUIRE(aes_blake_pool_task_count(nullptr, 1000 * AES_BLAKE_POOL_MIN_TASK_BYTES) == 4);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("Parallel AES-Blake matches Python reference inputs", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+
+    for (AESBlakePool *p : {pool, static_cast<AESBlakePool*>(nullptr)}) {
+        const auto &ref256 = aes_blake256_long_reference();
+        std::vector<uint8_t> ct256(ref256.plaintext_len);
+        uint8_t tag256[AES_BLAKE256_TAG_BYTES];
+        REQUIRE(aes_blake256_encrypt_parallel(
+            p, ref256.key, ref256.nonce, ref256.context,
+            ref256.plaintext, ref256.plaintext_len,
+            ref256.header, ref256.header_len,
+            ct256.data(), tag256
+        ) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(ct256.data(), ref256.ciphertext, ref256.plaintext_len) == 0);
+        REQUIRE(memcmp(tag256, ref256.auth_tag, sizeof(tag256)) == 0);
+
+        const auto &ref512 = aes_blake512_long_reference();
+        std::vector<uint8_t> ct512(ref512.plaintext_len);
+        uint8_t tag512[AES_BLAKE512_TAG_BYTES];
+        REQUIRE(aes_blake512_encrypt_parallel(
+            p, ref512.key, ref512.nonce, ref512.context,
+            ref512.plaintext, ref512.plaintext_len,
+            ref512.header, ref512.header_len,
+            ct512.data(), tag512
+        ) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(ct512.data(), ref512.ciphertext, ref512.plaintext_len) == 0);
+        REQUIRE(memcmp(tag512, ref512.auth_tag, sizeof(tag512)) == 0);
+    }
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("Parallel AES-Blake256 matches the single-threaded engine on large messages", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE256_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE256_NONCE_BYTES];
+    uint8_t context[AES_BLAKE256_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+
+    // An uneven group count spreads a remainder over the tasks
+    std::vector<uint8_t> plaintext(20 * AES_BLAKE_POOL_MIN_TASK_BYTES + 3 * AES_BLAKE256_GROUP_BYTES);
+    std::vector<uint8_t> header(5 * AES_BLAKE256_GROUP_BYTES);
+    csprng_read_array(plaintext.data(), static_cast<uint32_t>(plaintext.size()));
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    std::vector<uint8_t> expected(plaintext.size());
+    uint8_t expected_tag[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_encrypt(
+        key, nonce, context,
+        plaintext.data(), plaintext.size(),
+        header.data(), header.size(),
+        expected.data(), expected_tag
+    ) == AESBlakeStatus_OK);
+
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    std::vector<uint8_t> buffer(plaintext);
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_encrypt_parallel(
+        pool, key, nonce, context,
+        buffer.data(), buffer.size(),
+        header.data(), header.size(),
+        buffer.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(buffer == expected);
+    REQUIRE(memcmp(auth_tag, expected_tag, sizeof(auth_tag)) == 0);
+
+    REQUIRE(aes_blake256_decrypt_parallel(
+        pool, key, nonce, context,
+        buffer.data(), buffer.size(),
+        header.data(), header.size(),
+        auth_tag, buffer.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(buffer == plaintext);
+
+    auth_tag[0] ^= 0x01;
+    REQUIRE(aes_blake256_decrypt_parallel(
+        pool, key, nonce, context,
+        expected.data(), expected.size(),
+        header.data(), header.size(),
+        auth_tag, buffer.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("Parallel AES-Blake512 matches the single-threaded engine on large messages", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES];
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+
+    std::vector<uint8_t> plaintext(20 * AES_BLAKE_POOL_MIN_TASK_BYTES + 3 * AES_BLAKE512_GROUP_BYTES);
+    std::vector<uint8_t> header(5 * AES_BLAKE512_GROUP_BYTES);
+    csprng_read_array(plaintext.data(), static_cast<uint32_t>(plaintext.size()));
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    std::vector<uint8_t> expected(plaintext.size());
+    uint8_t expected_tag[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_encrypt(
+        key, nonce, context,
+        plaintext.data(), plaintext.size(),
+        header.data(), header.size(),
+        expected.data(), expected_tag
+    ) == AESBlakeStatus_OK);
+
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_encrypt_parallel(
+        pool, key, nonce, context,
+        plaintext.data(), plaintext.size(),
+        header.data(), header.size(),
+        ciphertext.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    REQUIRE(ciphertext == expected);
+    REQUIRE(memcmp(auth_tag, expected_tag, sizeof(auth_tag)) == 0);
+
+    std::vector<uint8_t> recovered(plaintext.size());
+    REQUIRE(aes_blake512_decrypt_parallel(
+        pool, key, nonce, context,
+        ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(),
+        auth_tag, recovered.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(recovered == plaintext);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("Parallel AES-Blake on a NUMA pool matches the single-threaded engine", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES];
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+
+    std::vector<uint8_t> plaintext(9 * AES_BLAKE_POOL_MIN_TASK_BYTES + 5 * AES_BLAKE512_GROUP_BYTES);
+    std::vector<uint8_t> header(3 * AES_BLAKE_POOL_MIN_TASK_BYTES);
+    csprng_read_array(plaintext.data(), static_cast<uint32_t>(plaintext.size()));
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    AESBlakePool *pool = aes_blake_pool_create_numa(3);
+    REQUIRE(pool != nullptr);
+
+    std::vector<uint8_t> expected256(plaintext.size()), ciphertext256(plaintext.size());
+    uint8_t expected_tag256[AES_BLAKE256_TAG_BYTES], tag256[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_encrypt(
+        key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), expected256.data(), expected_tag256
+    ) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake256_encrypt_parallel(
+        pool, key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), ciphertext256.data(), tag256
+    ) == AESBlakeStatus_OK);
+    REQUIRE(ciphertext256 == expected256);
+    REQUIRE(memcmp(tag256, expected_tag256, sizeof(tag256)) == 0);
+
+    std::vector<uint8_t> buffer512(plaintext), expected512(plaintext.size());
+    uint8_t expected_tag512[AES_BLAKE512_TAG_BYTES], tag512[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_encrypt(
+        key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), expected512.data(), expected_tag512
+    ) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake512_encrypt_parallel(
+        pool, key, nonce, context, buffer512.data(), buffer512.size(),
+        header.data(), header.size(), buffer512.data(), tag512
+    ) == AESBlakeStatus_OK);
+    REQUIRE(buffer512 == expected512);
+    REQUIRE(memcmp(tag512, expected_tag512, sizeof(tag512)) == 0);
+    REQUIRE(aes_blake512_decrypt_parallel(
+        pool, key, nonce, context, buffer512.data(), buffer512.size(),
+        header.data(), header.size(), tag512, buffer512.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(buffer512 == plaintext);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("Parallel AES-Blake splits large headers over the tasks", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE512_KEY_BYTES];
+    uint8_t nonce[AES_BLAKE512_NONCE_BYTES];
+    uint8_t context[AES_BLAKE512_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+
+    // The header dominates the work, so tasks cover header groups only or straddle both domains
+    std::vector<uint8_t> plaintext(AES_BLAKE_POOL_MIN_TASK_BYTES + 7 * AES_BLAKE512_GROUP_BYTES);
+    std::vector<uint8_t> header(12 * AES_BLAKE_POOL_MIN_TASK_BYTES + 5 * AES_BLAKE512_GROUP_BYTES);
+    csprng_read_array(plaintext.data(), static_cast<uint32_t>(plaintext.size()));
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    AESBlakePool *pool = aes_blake_pool_create(3);
+
+    std::vector<uint8_t> expected256(plaintext.size()), ciphertext256(plaintext.size());
+    uint8_t expected_tag256[AES_BLAKE256_TAG_BYTES], tag256[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_encrypt(
+        key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), expected256.data(), expected_tag256
+    ) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake256_encrypt_parallel(
+        pool, key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), ciphertext256.data(), tag256
+    ) == AESBlakeStatus_OK);
+    REQUIRE(ciphertext256 == expected256);
+    REQUIRE(memcmp(tag256, expected_tag256, sizeof(tag256)) == 0);
+
+    std::vector<uint8_t> expected512(plaintext.size()), ciphertext512(plaintext.size());
+    uint8_t expected_tag512[AES_BLAKE512_TAG_BYTES], tag512[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_encrypt(
+        key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), expected512.data(), expected_tag512
+    ) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake512_encrypt_parallel(
+        pool, key, nonce, context, plaintext.data(), plaintext.size(),
+        header.data(), header.size(), ciphertext512.data(), tag512
+    ) == AESBlakeStatus_OK);
+    REQUIRE(ciphertext512 == expected512);
+    REQUIRE(memcmp(tag512, expected_tag512, sizeof(tag512)) == 0);
+
+    // A corrupted header group in the middle is caught by the task that owns it
+    std::vector<uint8_t> recovered(plaintext.size());
+    header[header.size() / 2] ^= 0x01;
+    REQUIRE(aes_blake512_decrypt_parallel(
+        pool, key, nonce, context, ciphertext512.data(), ciphertext512.size(),
+        header.data(), header.size(), tag512, recovered.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    header[header.size() / 2] ^= 0x01;
+    REQUIRE(aes_blake512_decrypt_parallel(
+        pool, key, nonce, context, ciphertext512.data(), ciphertext512.size(),
+        header.data(), header.size(), tag512, recovered.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(recovered == plaintext);
+    aes_blake_pool_destroy(pool);
+}
+
+
+/*
+ * Re-encryption must match encrypting the plaintext under the new key and
+ * nonce, in place or not, and reject a forged old tag with a zeroed separate
+ * output or an untouched in-place buffer.
+ */
+template <typename Key>
+static void check_reencrypt(AESBlakePool *pool) {
+    using V = AESBlakeVariant<Key>;
+    std::vector<uint8_t> old_key(V::key_bytes), new_key(V::key_bytes), context(V::context_bytes);
+    std::vector<uint8_t> old_nonce(V::nonce_bytes), new_nonce(V::nonce_bytes);
+    std::vector<uint8_t> plaintext(9 * AES_BLAKE_POOL_MIN_TASK_BYTES + 5 * V::group_bytes);
+    std::vector<uint8_t> header(AES_BLAKE_POOL_MIN_TASK_BYTES + 3 * V::group_bytes);
+    for (auto *buffer : {&old_key, &new_key, &context, &old_nonce, &new_nonce, &plaintext, &header}) {
+        csprng_read_array(buffer->data(), static_cast<uint32_t>(buffer->size()));
+    }
+
+    Key old_key_obj, new_key_obj;
+    V::key_init(&old_key_obj, old_key.data(), context.data());
+    V::key_init(&new_key_obj, new_key.data(), context.data());
+    std::vector<uint8_t> ciphertext(plaintext.size()), expected(plaintext.size());
+    std::vector<uint8_t> auth_tag(V::tag_bytes), expected_tag(V::tag_bytes), new_tag(V::tag_bytes);
+    REQUIRE(V::encrypt_with_key(
+        &old_key_obj, old_nonce.data(), plaintext.data(), plaintext.size(),
+        header.data(), header.size(), ciphertext.data(), auth_tag.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(V::encrypt_with_key(
+        &new_key_obj, new_nonce.data(), plaintext.data(), plaintext.size(),
+        header.data(), header.size(), expected.data(), expected_tag.data()
+    ) == AESBlakeStatus_OK);
+
+    std::vector<uint8_t> output(plaintext.size());
+    REQUIRE(V::reencrypt_parallel_with_key(
+        pool, &old_key_obj, old_nonce.data(), &new_key_obj, new_nonce.data(), ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(), auth_tag.data(), output.data(), new_tag.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(output == expected);
+    REQUIRE(new_tag == expected_tag);
+
+    std::vector<uint8_t> buffer(ciphertext);
+    REQUIRE(V::reencrypt_parallel_with_key(
+        pool, &old_key_obj, old_nonce.data(), &new_key_obj, new_nonce.data(), buffer.data(), buffer.size(),
+        header.data(), header.size(), auth_tag.data(), buffer.data(), new_tag.data()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(buffer == expected);
+
+    auth_tag[0] ^= 0x01;
+    REQUIRE(V::reencrypt_parallel_with_key(
+        pool, &old_key_obj, old_nonce.data(), &new_key_obj, new_nonce.data(), ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(), auth_tag.data(), output.data(), new_tag.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(output == std::vector<uint8_t>(output.size(), 0));
+    buffer = ciphertext;
+    REQUIRE(V::reencrypt_parallel_with_key(
+        pool, &old_key_obj, old_nonce.data(), &new_key_obj, new_nonce.data(), buffer.data(), buffer.size(),
+        header.data(), header.size(), auth_tag.data(), buffer.data(), new_tag.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(buffer == ciphertext);
+    REQUIRE(V::reencrypt_parallel_with_key(
+        pool, &old_key_obj, old_nonce.data(), &new_key_obj, new_nonce.data(), ciphertext.data(), ciphertext.size() - 1,
+        header.data(), header.size(), auth_tag.data(), output.data(), new_tag.data()
+    ) == AESBlakeStatus_INVALID_LENGTH);
+}
+
+
+TEST_CASE("Parallel AES-Blake re-encryption matches encrypting under the new key", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    check_reencrypt<AESBlake256Key>(pool);
+    check_reencrypt<AESBlake512Key>(pool);
+    aes_blake_pool_destroy(pool);
+}
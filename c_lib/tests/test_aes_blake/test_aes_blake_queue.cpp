@@ -0,0 +1,279 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <vector>
+#include "aes_blake.h"
+#include "aes_blake_queue.h"
+#include "helpers/helpers.h"
+
+#if !defined(_WIN32)
+#include <poll.h>
+#endif
+
+
+// Segment sizes cycled through for the fragmented input and output buffers
+static constexpr size_t input_sizes[] = {1, 1460, 7, 31, 33, 64, 100, 3, 257, 0, 65};
+static constexpr size_t output_sizes[] = {5, 40, 1, 300, 17, 2048, 63, 0};
+static constexpr size_t segments_per_job = 4;
+
+
+static std::vector<AESBlakeIovec> split(const uint8_t data[], const size_t length, const std::span<const size_t> sizes) {
+    std::vector<AESBlakeIovec> segments;
+    for (size_t offset = 0, i = 0; offset < length; i++) {
+        const size_t take = std::min(sizes[i % sizes.size()], length - offset);
+        segments.push_back({const_cast<uint8_t *>(data + offset), take});
+        offset += take;
+    }
+    return segments;
+}
+
+
+/*
+ * One message split into update jobs of a few input segments each, written across
+ * fragmented output segments, followed by a header job and a final job.
+ */
+struct QueuedStream {
+    std::vector<AESBlakeIovec> input_segments;
+    std::vector<AESBlakeIovec> header_segments;
+    std::vector<std::vector<AESBlakeIovec>> output_segments;
+    std::vector<uint8_t> output_buffer;
+    std::vector<AESBlakeQueueJob> jobs;
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES] = {};
+
+    QueuedStream(
+            const int variant,
+            const AESBlakeQueueOp op,
+            void *ctx,
+            const uint8_t input[],
+            const size_t input_len,
+            const uint8_t header[],
+            const size_t header_len,
+            const size_t group_bytes
+    ) {
+        input_segments = split(input, input_len, input_sizes);
+        header_segments = split(header, header_len, input_sizes);
+        const size_t update_jobs = (input_segments.size() + segments_per_job - 1) / segments_per_job;
+        output_buffer.resize(input_len + update_jobs * (group_bytes - 1));
+
+        size_t output_offset = 0;
+        for (size_t first = 0; first < input_segments.size(); first += segments_per_job) {
+            const size_t count = std::min(segments_per_job, input_segments.size() - first);
+            size_t capacity = group_bytes - 1;
+            for (size_t i = first; i < first + count; i++) {
+                capacity += input_segments[i].iov_len;
+            }
+            output_segments.push_back(split(output_buffer.data() + output_offset, capacity, output_sizes));
+            output_offset += capacity;
+
+            AESBlakeQueueJob job = {};
+            job.variant = variant;
+            job.op = op;
+            job.ctx = ctx;
+            job.input = input_segments.data() + first;
+            job.input_count = count;
+            jobs.push_back(job);
+        }
+        for (size_t i = 0; i < jobs.size(); i++) {
+            jobs[i].output = output_segments[i].data();
+            jobs[i].output_count = output_segments[i].size();
+        }
+
+        AESBlakeQueueJob header_job = {};
+        header_job.variant = variant;
+        header_job.op = AESBlakeQueueOp_UPDATE_HEADER;
+        header_job.ctx = ctx;
+        header_job.input = header_segments.data();
+        header_job.input_count = header_segments.size();
+        jobs.push_back(header_job);
+
+        AESBlakeQueueJob final_job = {};
+        final_job.variant = variant;
+        final_job.op = op == AESBlakeQueueOp_ENCRYPT_UPDATE ? AESBlakeQueueOp_ENCRYPT_FINAL : AESBlakeQueueOp_DECRYPT_FINAL;
+        final_job.ctx = ctx;
+        final_job.auth_tag = auth_tag;
+        jobs.push_back(final_job);
+    }
+
+    void submit(AESBlakeQueue *queue, const AESBlakeQueueCallback callback, void *user_data) {
+        for (auto &job : jobs) {
+            job.callback = callback;
+            job.user_data = user_data;
+            REQUIRE(aes_blake_queue_submit(queue, &job) == AESBlakeStatus_OK);
+        }
+    }
+
+    std::vector<uint8_t> gather() const {
+        std::vector<uint8_t> result;
+        for (size_t i = 0; i < output_segments.size(); i++) {
+            size_t remaining = jobs[i].output_len;
+            for (const auto &segment : output_segments[i]) {
+                const size_t take = std::min(segment.iov_len, remaining);
+                const auto *data = static_cast<const uint8_t *>(segment.iov_base);
+                result.insert(result.end(), data, data + take);
+                remaining -= take;
+            }
+        }
+        return result;
+    }
+};
+
+
+static void count_completion(AESBlakeQueueJob *job) {
+    static_cast<std::atomic<size_t> *>(job->user_data)->fetch_add(1);
+}
+
+
+TEST_CASE("Queued AES-Blake256 streams match Python reference inputs", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_long_reference();
+    AESBlakeQueue *queue = aes_blake_queue_create(3);
+    REQUIRE(queue != nullptr);
+
+    constexpr size_t stream_count = 6;
+    std::vector<AESBlake256Ctx> contexts(stream_count);
+    std::vector<std::unique_ptr<QueuedStream>> streams;
+    std::atomic<size_t> completed = 0;
+    size_t submitted = 0;
+
+    for (auto &ctx : contexts) {
+        aes_blake256_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+        streams.push_back(std::make_unique<QueuedStream>(
+            AES_BLAKE256_QUEUE_VARIANT, AESBlakeQueueOp_ENCRYPT_UPDATE, &ctx,
+            ref.plaintext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE256_GROUP_BYTES
+        ));
+    }
+    for (const auto &stream : streams) {
+        stream->submit(queue, count_completion, &completed);
+        submitted += stream->jobs.size();
+    }
+    aes_blake_queue_drain(queue);
+    REQUIRE(completed == submitted);
+
+    for (const auto &stream : streams) {
+        for (const auto &job : stream->jobs) {
+            REQUIRE(job.status == AESBlakeStatus_OK);
+        }
+        const auto ciphertext = stream->gather();
+        REQUIRE(ciphertext.size() == ref.plaintext_len);
+        REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+        REQUIRE(memcmp(stream->auth_tag, ref.auth_tag, AES_BLAKE256_TAG_BYTES) == 0);
+    }
+    aes_blake_queue_destroy(queue);
+}
+
+
+TEST_CASE("Queued AES-Blake512 decryption completes through the notify fd", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake512_long_reference();
+    AESBlakeQueue *queue = aes_blake_queue_create(2);
+    REQUIRE(queue != nullptr);
+
+    constexpr size_t stream_count = 4;
+    std::vector<AESBlake512Ctx> contexts(stream_count);
+    std::vector<std::unique_ptr<QueuedStream>> streams;
+    size_t submitted = 0;
+
+    for (size_t i = 0; i < stream_count; i++) {
+        aes_blake512_ctx_init(&contexts[i], ref.key, ref.nonce, ref.context);
+        streams.push_back(std::make_unique<QueuedStream>(
+            AES_BLAKE512_QUEUE_VARIANT, AESBlakeQueueOp_DECRYPT_UPDATE, &contexts[i],
+            ref.ciphertext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE512_GROUP_BYTES
+        ));
+        memcpy(streams[i]->auth_tag, ref.auth_tag, AES_BLAKE512_TAG_BYTES);
+    }
+    streams.back()->auth_tag[0] ^= 0x01;
+    for (const auto &stream : streams) {
+        stream->submit(queue, nullptr, nullptr);
+        submitted += stream->jobs.size();
+    }
+
+    std::vector<AESBlakeQueueJob *> reaped;
+    AESBlakeQueueJob *batch[8];
+    while (reaped.size() < submitted) {
+#if !defined(_WIN32)
+        pollfd notify = {aes_blake_queue_notify_fd(queue), POLLIN, 0};
+        REQUIRE(poll(&notify, 1, 10000) == 1);
+#else
+        aes_blake_queue_drain(queue);
+#endif
+        const size_t count = aes_blake_queue_poll(queue, batch, std::size(batch));
+        reaped.insert(reaped.end(), batch, batch + count);
+    }
+    REQUIRE(aes_blake_queue_poll(queue, batch, std::size(batch)) == 0);
+    REQUIRE(reaped.size() == submitted);
+
+    for (size_t i = 0; i < stream_count; i++) {
+        const auto &jobs = streams[i]->jobs;
+        for (size_t j = 0; j + 1 < jobs.size(); j++) {
+            REQUIRE(jobs[j].status == AESBlakeStatus_OK);
+        }
+        const AESBlakeStatus expected = i + 1 < stream_count ? AESBlakeStatus_OK : AESBlakeStatus_AUTH_FAILED;
+        REQUIRE(jobs.back().status == expected);
+
+        const auto plaintext = streams[i]->gather();
+        REQUIRE(plaintext.size() == ref.plaintext_len);
+        REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+    }
+    aes_blake_queue_destroy(queue);
+}
+
+
+TEST_CASE("AES-Blake queue rejects invalid jobs", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_reference();
+    AESBlakeQueue *queue = aes_blake_queue_create(1);
+    REQUIRE(queue != nullptr);
+
+    AESBlake256Ctx ctx;
+    aes_blake256_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    std::vector<uint8_t> output(AES_BLAKE256_GROUP_BYTES * 2);
+    const AESBlakeIovec input = {const_cast<uint8_t *>(ref.plaintext), AES_BLAKE256_GROUP_BYTES};
+    const AESBlakeIovec short_output = {output.data(), AES_BLAKE256_GROUP_BYTES};
+
+    AESBlakeQueueJob *reaped[4];
+    AESBlakeQueueJob job = {};
+    job.variant = 384;
+    job.op = AESBlakeQueueOp_ENCRYPT_UPDATE;
+    job.ctx = &ctx;
+    job.input = &input;
+    job.input_count = 1;
+    job.output = &short_output;
+    job.output_count = 1;
+    REQUIRE(aes_blake_queue_submit(queue, &job) == AESBlakeStatus_INVALID_LENGTH);
+
+    job.variant = AES_BLAKE256_QUEUE_VARIANT;
+    REQUIRE(aes_blake_queue_submit(queue, &job) == AESBlakeStatus_OK);
+    aes_blake_queue_drain(queue);
+    REQUIRE(aes_blake_queue_poll(queue, reaped, std::size(reaped)) == 1);
+    REQUIRE(job.status == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(job.output_len == 0);
+
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES] = {};
+    job.op = AESBlakeQueueOp_DECRYPT_UPDATE;
+    const AESBlakeIovec full_output = {output.data(), output.size()};
+    job.output = &full_output;
+    REQUIRE(aes_blake_queue_submit(queue, &job) == AESBlakeStatus_OK);
+    aes_blake_queue_drain(queue);
+    REQUIRE(aes_blake_queue_poll(queue, reaped, std::size(reaped)) == 1);
+    REQUIRE(job.status == AESBlakeStatus_OK);
+    REQUIRE(job.output_len == AES_BLAKE256_GROUP_BYTES);
+
+    job.op = AESBlakeQueueOp_ENCRYPT_FINAL;
+    job.auth_tag = auth_tag;
+    REQUIRE(aes_blake_queue_submit(queue, &job) == AESBlakeStatus_OK);
+    aes_blake_queue_drain(queue);
+    REQUIRE(aes_blake_queue_poll(queue, reaped, std::size(reaped)) == 1);
+    REQUIRE(reaped[0] == &job);
+    REQUIRE(job.status == AESBlakeStatus_INVALID_STATE);
+    aes_blake_queue_destroy(queue);
+}
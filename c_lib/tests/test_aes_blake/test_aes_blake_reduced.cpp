@@ -0,0 +1,174 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
+#include "aes_block.h"
+#include "blake_keygen.h"
+#include "aes_blake.h"
+#include "aes_blake_shared.h"
+#include "aes_blake_reduced.h"
+#include "helpers/helpers.h"
+
+
+template <typename Key>
+static Key random_key_obj(std::vector<uint8_t> &nonce) {
+    using V = AESBlakeVariant<Key>;
+    uint8_t key[V::key_bytes], context[V::context_bytes];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(context, sizeof(context));
+    nonce.resize(V::nonce_bytes);
+    csprng_read_array(nonce.data(), nonce.size());
+
+    Key key_obj;
+    V::key_init(&key_obj, key, context);
+    return key_obj;
+}
+
+
+template <typename Key>
+static void check_roundtrip() {
+    using V = AESBlakeVariant<Key>;
+    std::vector<uint8_t> nonce;
+    const Key key_obj = random_key_obj<Key>(nonce);
+
+    // 0 and 1 groups, one past a batch of the 256 variant and an uneven header
+    for (const size_t groups : {size_t(0), size_t(1), size_t(9), size_t(33)}) {
+        std::vector<uint8_t> plaintext(groups * V::group_bytes), header(3 * V::group_bytes);
+        csprng_read_array(plaintext.data(), plaintext.size());
+        csprng_read_array(header.data(), header.size());
+
+        std::vector<uint8_t> ciphertext(plaintext.size()), decrypted(plaintext.size());
+        uint8_t tag[V::tag_bytes], standard_tag[V::tag_bytes];
+        REQUIRE(V::reduced_encrypt(&key_obj, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(), ciphertext.data(), tag) == AESBlakeStatus_OK);
+        REQUIRE(V::reduced_decrypt(&key_obj, nonce.data(), ciphertext.data(), ciphertext.size(), header.data(), header.size(), tag, decrypted.data()) == AESBlakeStatus_OK);
+        REQUIRE(decrypted == plaintext);
+
+        // In-place encryption gives the same output
+        std::vector<uint8_t> in_place = plaintext;
+        uint8_t in_place_tag[V::tag_bytes];
+        REQUIRE(V::reduced_encrypt(&key_obj, nonce.data(), in_place.data(), in_place.size(), header.data(), header.size(), in_place.data(), in_place_tag) == AESBlakeStatus_OK);
+        REQUIRE(in_place == ciphertext);
+        REQUIRE(memcmp(in_place_tag, tag, sizeof(tag)) == 0);
+
+        // The standard profile derives different keys from the same inputs
+        std::vector<uint8_t> standard(plaintext.size());
+        REQUIRE(V::encrypt_with_key(&key_obj, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(), standard.data(), standard_tag) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(standard_tag, tag, sizeof(tag)) != 0);
+        if (groups > 0) {
+            REQUIRE(standard != ciphertext);
+        }
+    }
+}
+
+
+template <typename Key>
+static void check_rejects_forgeries() {
+    using V = AESBlakeVariant<Key>;
+    std::vector<uint8_t> nonce;
+    const Key key_obj = random_key_obj<Key>(nonce);
+
+    std::vector<uint8_t> plaintext(4 * V::group_bytes), header(V::group_bytes);
+    csprng_read_array(plaintext.data(), plaintext.size());
+    csprng_read_array(header.data(), header.size());
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    uint8_t tag[V::tag_bytes];
+    REQUIRE(V::reduced_encrypt(&key_obj, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(), ciphertext.data(), tag) == AESBlakeStatus_OK);
+
+    std::vector<uint8_t> output(plaintext.size(), 0xFF);
+    ciphertext[V::group_bytes + 5] ^= 0x01;
+    REQUIRE(V::reduced_decrypt(&key_obj, nonce.data(), ciphertext.data(), ciphertext.size(), header.data(), header.size(), tag, output.data()) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(output == std::vector<uint8_t>(plaintext.size(), 0));
+    ciphertext[V::group_bytes + 5] ^= 0x01;
+
+    header[0] ^= 0x80;
+    REQUIRE(V::reduced_decrypt(&key_obj, nonce.data(), ciphertext.data(), ciphertext.size(), header.data(), header.size(), tag, output.data()) == AESBlakeStatus_AUTH_FAILED);
+    header[0] ^= 0x80;
+
+    REQUIRE(V::reduced_encrypt(&key_obj, nonce.data(), plaintext.data(), plaintext.size() - 1, header.data(), header.size(), ciphertext.data(), tag) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(V::reduced_decrypt(&key_obj, nonce.data(), ciphertext.data(), ciphertext.size(), header.data(), 1, tag, output.data()) == AESBlakeStatus_INVALID_LENGTH);
+}
+
+
+TEST_CASE("AES-Blake256 reduced profile roundtrips and differs from the standard profile", "[unittest][aes_blake]") {
+    check_roundtrip<AESBlake256Key>();
+}
+
+
+TEST_CASE("AES-Blake512 reduced profile roundtrips and differs from the standard profile", "[unittest][aes_blake]") {
+    check_roundtrip<AESBlake512Key>();
+}
+
+
+TEST_CASE("AES-Blake256 reduced profile rejects forged messages", "[unittest][aes_blake]") {
+    check_rejects_forgeries<AESBlake256Key>();
+}
+
+
+TEST_CASE("AES-Blake512 reduced profile rejects forged messages", "[unittest][aes_blake]") {
+    check_rejects_forgeries<AESBlake512Key>();
+}
+
+
+TEST_CASE("AES-Blake256 reduced profile matches reference keygen and AES passes", "[unittest][aes_blake]") {
+    std::vector<uint8_t> nonce;
+    const AESBlake256Key key_obj = random_key_obj<AESBlake256Key>(nonce);
+    uint8_t plaintext[AES_BLAKE256_GROUP_BYTES];
+    csprng_read_array(plaintext, sizeof(plaintext));
+
+    uint32_t nonce_words[8], knc[16];
+    load_words32_be(nonce_words, nonce.data(), 8);
+    blake32_clean_compute_knc(key_obj.key_words, nonce_words, knc);
+
+    // One message group at counter 0, no header, then the checksum at counter 1
+    uint8_t round_keys[2][2 * AES_BLAKE_ROUNDS][16];
+    blake32_clean_derive_keys_reduced(key_obj.init_state, knc, AES_BLAKE_ROUNDS, 0, KDFDomain_MSG, &round_keys[0][0], &round_keys[0][AES_BLAKE_ROUNDS]);
+    blake32_clean_derive_keys_reduced(key_obj.init_state, knc, AES_BLAKE_ROUNDS, 1, KDFDomain_CHK, &round_keys[1][0], &round_keys[1][AES_BLAKE_ROUNDS]);
+    uint8_t expected_ct[AES_BLAKE256_GROUP_BYTES], expected_tag[AES_BLAKE256_TAG_BYTES];
+    aes_encrypt_blocks_x2_clean(plaintext, expected_ct, round_keys[0], AES_BLAKE_ROUNDS, 1);
+    aes_encrypt_blocks_x2_clean(plaintext, expected_tag, round_keys[1], AES_BLAKE_ROUNDS, 1);
+
+    uint8_t ciphertext[AES_BLAKE256_GROUP_BYTES], tag[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_reduced_encrypt(&key_obj, nonce.data(), plaintext, sizeof(plaintext), nullptr, 0, ciphertext, tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext, expected_ct, sizeof(ciphertext)) == 0);
+    REQUIRE(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+}
+
+
+TEST_CASE("AES-Blake512 reduced profile matches reference keygen and AES passes", "[unittest][aes_blake]") {
+    std::vector<uint8_t> nonce;
+    const AESBlake512Key key_obj = random_key_obj<AESBlake512Key>(nonce);
+    uint8_t plaintext[AES_BLAKE512_GROUP_BYTES];
+    csprng_read_array(plaintext, sizeof(plaintext));
+
+    uint64_t nonce_words[8], knc[16];
+    load_words64_be(nonce_words, nonce.data(), 8);
+    blake64_clean_compute_knc(key_obj.key_words, nonce_words, knc);
+
+    uint8_t round_keys[2][4 * AES_BLAKE_ROUNDS][16];
+    for (size_t i = 0; i < 2; i++) {
+        uint8_t (*keys)[16] = round_keys[i];
+        blake64_clean_derive_keys_reduced(
+            key_obj.init_state, knc, AES_BLAKE_ROUNDS, i, i == 0 ? KDFDomain_MSG : KDFDomain_CHK,
+            &keys[0], &keys[AES_BLAKE_ROUNDS], &keys[2 * AES_BLAKE_ROUNDS], &keys[3 * AES_BLAKE_ROUNDS]
+        );
+    }
+    uint8_t expected_ct[AES_BLAKE512_GROUP_BYTES], expected_tag[AES_BLAKE512_TAG_BYTES];
+    aes_encrypt_blocks_x4_clean(plaintext, expected_ct, round_keys[0], AES_BLAKE_ROUNDS, 1);
+    aes_encrypt_blocks_x4_clean(plaintext, expected_tag, round_keys[1], AES_BLAKE_ROUNDS, 1);
+
+    uint8_t ciphertext[AES_BLAKE512_GROUP_BYTES], tag[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_reduced_encrypt(&key_obj, nonce.data(), plaintext, sizeof(plaintext), nullptr, 0, ciphertext, tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext, expected_ct, sizeof(ciphertext)) == 0);
+    REQUIRE(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+}
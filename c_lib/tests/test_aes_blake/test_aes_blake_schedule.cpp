@@ -0,0 +1,124 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include "csprng.h"
+#include "aes_blake.h"
+#include "aes_blake_schedule.h"
+#include "helpers/helpers.h"
+
+
+/*
+ * Exports schedules for messages of several shapes and checks that decrypting
+ * with them matches the keyed engine, and that mismatched schedules are rejected.
+ */
+template <typename Key>
+static void check_schedule() {
+    using V = AESBlakeVariant<Key>;
+    const auto raw_key = random_bytes(V::key_bytes);
+    const auto context = random_bytes(V::context_bytes);
+    const auto nonce = random_bytes(V::nonce_bytes);
+    const auto other_nonce = random_bytes(V::nonce_bytes);
+    Key key;
+    V::key_init(&key, raw_key.data(), context.data());
+
+    const size_t group_keys_bytes = V::block_count * AES_BLAKE_ROUNDS * 16;
+    for (const size_t message_groups : {size_t(0), size_t(1), size_t(9), size_t(37)}) {
+        for (const size_t header_groups : {size_t(0), size_t(1), size_t(9)}) {
+            const auto plaintext = random_bytes(message_groups * V::group_bytes);
+            const auto header = random_bytes(header_groups * V::group_bytes);
+            std::vector<uint8_t> ciphertext(plaintext.size()), auth_tag(V::tag_bytes);
+            REQUIRE(V::encrypt_with_key(
+                &key, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(),
+                ciphertext.data(), auth_tag.data()
+            ) == AESBlakeStatus_OK);
+
+            const size_t schedule_len = V::schedule_size(ciphertext.size(), header.size());
+            REQUIRE(schedule_len == AES_BLAKE_SCHEDULE_HEADER_BYTES + (message_groups + header_groups + 1) * group_keys_bytes);
+            std::vector<uint8_t> schedule(schedule_len);
+            REQUIRE(V::schedule_export(
+                &key, nonce.data(), ciphertext.size(), header.size(), schedule.data(), schedule.size()
+            ) == AESBlakeStatus_OK);
+
+            AESBlakeScheduleInfo info;
+            REQUIRE(aes_blake_schedule_parse_header(schedule.data(), &info) == AESBlakeStatus_OK);
+            REQUIRE(info.message_groups == message_groups);
+            REQUIRE(info.header_groups == header_groups);
+
+            // Repeated reads of the same object decrypt from the one schedule
+            for (int read = 0; read < 2; read++) {
+                std::vector<uint8_t> decrypted(plaintext.size(), 0xAA);
+                REQUIRE(V::decrypt_with_schedule(
+                    schedule.data(), schedule.size(), ciphertext.data(), ciphertext.size(),
+                    header.data(), header.size(), auth_tag.data(), decrypted.data()
+                ) == AESBlakeStatus_OK);
+                REQUIRE(decrypted == plaintext);
+            }
+
+            // A tampered tag fails and wipes the plaintext
+            std::vector<uint8_t> bad_tag = auth_tag;
+            bad_tag[0] ^= 1;
+            std::vector<uint8_t> decrypted(plaintext.size(), 0xAA);
+            REQUIRE(V::decrypt_with_schedule(
+                schedule.data(), schedule.size(), ciphertext.data(), ciphertext.size(),
+                header.data(), header.size(), bad_tag.data(), decrypted.data()
+            ) == AESBlakeStatus_AUTH_FAILED);
+            REQUIRE(decrypted == std::vector<uint8_t>(plaintext.size(), 0));
+        }
+    }
+
+    // Schedules of another nonce fail the tag, of other lengths or variants are rejected
+    const auto plaintext = random_bytes(5 * V::group_bytes);
+    const auto header = random_bytes(V::group_bytes);
+    std::vector<uint8_t> ciphertext(plaintext.size()), auth_tag(V::tag_bytes), decrypted(plaintext.size());
+    REQUIRE(V::encrypt_with_key(
+        &key, nonce.data(), plaintext.data(), plaintext.size(), header.data(), header.size(),
+        ciphertext.data(), auth_tag.data()
+    ) == AESBlakeStatus_OK);
+    std::vector<uint8_t> schedule(V::schedule_size(plaintext.size(), header.size()));
+    REQUIRE(V::schedule_export(
+        &key, other_nonce.data(), ciphertext.size(), header.size(), schedule.data(), schedule.size()
+    ) == AESBlakeStatus_OK);
+    REQUIRE(V::decrypt_with_schedule(
+        schedule.data(), schedule.size(), ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(), auth_tag.data(), decrypted.data()
+    ) == AESBlakeStatus_AUTH_FAILED);
+    REQUIRE(V::decrypt_with_schedule(
+        schedule.data(), schedule.size(), ciphertext.data(), ciphertext.size() - V::group_bytes,
+        header.data(), header.size(), auth_tag.data(), decrypted.data()
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(AESBlakeVariant<typename V::OtherKey>::decrypt_with_schedule(
+        schedule.data(), schedule.size(), ciphertext.data(), 0, header.data(), 0, auth_tag.data(), decrypted.data()
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(V::schedule_export(
+        &key, nonce.data(), ciphertext.size(), header.size(), schedule.data(), schedule.size() - 1
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    REQUIRE(V::schedule_size(ciphertext.size() + 1, header.size()) == 0);
+
+    schedule[7] = 1;
+    REQUIRE(V::decrypt_with_schedule(
+        schedule.data(), schedule.size(), ciphertext.data(), ciphertext.size(),
+        header.data(), header.size(), auth_tag.data(), decrypted.data()
+    ) == AESBlakeStatus_INVALID_LENGTH);
+    aes_blake_schedule_wipe(schedule.data(), schedule.size());
+    REQUIRE(schedule == std::vector<uint8_t>(schedule.size(), 0));
+}
+
+
+TEST_CASE("AES-Blake256 key schedules decrypt like the keyed engine", "[unittest][aes_blake]") {
+    check_schedule<AESBlake256Key>();
+}
+
+
+TEST_CASE("AES-Blake512 key schedules decrypt like the keyed engine", "[unittest][aes_blake]") {
+    check_schedule<AESBlake512Key>();
+}
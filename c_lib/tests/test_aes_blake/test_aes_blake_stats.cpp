@@ -0,0 +1,52 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "aes_blake.h"
+#include "aes_blake_stats.h"
+#include "helpers/helpers.h"
+
+
+TEST_CASE("AES-Blake stats phases have names", "[unittest][aes_blake]") {
+    REQUIRE(strcmp(aes_blake_stats_phase_name(AESBlakePhase_KEYGEN), "keygen") == 0);
+    REQUIRE(strcmp(aes_blake_stats_phase_name(AESBlakePhase_FINALIZE), "finalize") == 0);
+    REQUIRE(aes_blake_stats_phase_name(AESBlakePhase_COUNT) == nullptr);
+}
+
+
+TEST_CASE("AES-Blake stats count the phases of an encryption", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_long_reference();
+    std::vector<uint8_t> ciphertext(ref.plaintext_len);
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+
+    AESBlakeStats before, after;
+    aes_blake_stats_snapshot(&before);
+    REQUIRE(aes_blake256_encrypt(
+        ref.key, ref.nonce, ref.context, ref.plaintext, ref.plaintext_len,
+        ref.header, ref.header_len, ciphertext.data(), auth_tag
+    ) == AESBlakeStatus_OK);
+    aes_blake_stats_snapshot(&after);
+
+    for (int p = 0; p < AESBlakePhase_COUNT; p++) {
+        REQUIRE(after.calls[p] >= before.calls[p]);
+        const uint64_t calls = after.calls[p] - before.calls[p];
+        if (!aes_blake_stats_enabled()) {
+            REQUIRE(after.calls[p] == 0);
+            REQUIRE(after.ticks[p] == 0);
+        } else if (p == AESBlakePhase_HEADER || p == AESBlakePhase_FINALIZE) {
+            REQUIRE(calls == 1);
+        } else {
+            REQUIRE(calls > 0);
+        }
+    }
+}
@@ -0,0 +1,240 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "aes_blake.h"
+#include "helpers/helpers.h"
+
+
+// Chunk sizes cycled through while streaming, most of them not group-aligned
+static constexpr size_t chunk_sizes[] = {1, 7, 31, 33, 64, 100, 3, 257, 0, 65};
+
+
+template <typename Ctx, typename UpdateFn, typename HeaderFn>
+static std::vector<uint8_t> stream_message(
+        Ctx &ctx,
+        const UpdateFn update_fn,
+        const HeaderFn header_fn,
+        const uint8_t input[],
+        const size_t input_len,
+        const uint8_t header[],
+        const size_t header_len,
+        const size_t group_bytes
+) {
+    std::vector<uint8_t> output(input_len + group_bytes);
+    size_t written = 0;
+    size_t chunk = 0;
+    for (size_t offset = 0; offset < input_len; chunk++) {
+        const size_t length = std::min(chunk_sizes[chunk % std::size(chunk_sizes)], input_len - offset);
+        size_t out_len = 0;
+        REQUIRE(update_fn(&ctx, input + offset, length, output.data() + written, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(out_len % group_bytes == 0);
+        written += out_len;
+        offset += length;
+    }
+    for (size_t offset = 0; offset < header_len; chunk++) {
+        const size_t length = std::min(chunk_sizes[chunk % std::size(chunk_sizes)], header_len - offset);
+        REQUIRE(header_fn(&ctx, header + offset, length) == AESBlakeStatus_OK);
+        offset += length;
+    }
+    REQUIRE(written == input_len);
+    output.resize(written);
+    return output;
+}
+
+
+TEST_CASE("Streaming AES-Blake256 matches Python reference inputs", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_long_reference();
+
+    AESBlake256Ctx ctx;
+    aes_blake256_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    const auto ciphertext = stream_message(
+        ctx, aes_blake256_ctx_encrypt_update, aes_blake256_ctx_update_header,
+        ref.plaintext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE256_GROUP_BYTES
+    );
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+    REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag, ref.auth_tag, sizeof(auth_tag)) == 0);
+
+    aes_blake256_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    const auto plaintext = stream_message(
+        ctx, aes_blake256_ctx_decrypt_update, aes_blake256_ctx_update_header,
+        ref.ciphertext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE256_GROUP_BYTES
+    );
+    REQUIRE(aes_blake256_ctx_decrypt_final(&ctx, ref.auth_tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+}
+
+
+TEST_CASE("Streaming AES-Blake512 matches Python reference inputs", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake512_long_reference();
+
+    AESBlake512Ctx ctx;
+    aes_blake512_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    const auto ciphertext = stream_message(
+        ctx, aes_blake512_ctx_encrypt_update, aes_blake512_ctx_update_header,
+        ref.plaintext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE512_GROUP_BYTES
+    );
+    uint8_t auth_tag[AES_BLAKE512_TAG_BYTES];
+    REQUIRE(aes_blake512_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(ciphertext.data(), ref.ciphertext, ref.plaintext_len) == 0);
+    REQUIRE(memcmp(auth_tag, ref.auth_tag, sizeof(auth_tag)) == 0);
+
+    aes_blake512_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    const auto plaintext = stream_message(
+        ctx, aes_blake512_ctx_decrypt_update, aes_blake512_ctx_update_header,
+        ref.ciphertext, ref.plaintext_len, ref.header, ref.header_len, AES_BLAKE512_GROUP_BYTES
+    );
+    REQUIRE(aes_blake512_ctx_decrypt_final(&ctx, ref.auth_tag) == AESBlakeStatus_OK);
+    REQUIRE(memcmp(plaintext.data(), ref.plaintext, ref.plaintext_len) == 0);
+}
+
+
+TEST_CASE("Streaming AES-Blake256 rejects a tampered auth tag", "[unittest][aes_blake]") {
+    const auto &ref = aes_blake256_reference();
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+    memcpy(auth_tag, ref.auth_tag, sizeof(auth_tag));
+    auth_tag[5] ^= 0x04;
+
+    AESBlake256Ctx ctx;
+    aes_blake256_ctx_init(&ctx, ref.key, ref.nonce, ref.context);
+    std::vector<uint8_t> plaintext(ref.plaintext_len);
+    size_t out_len = 0;
+    REQUIRE(aes_blake256_ctx_decrypt_update(
+        &ctx, ref.ciphertext, ref.plaintext_len, plaintext.data(), &out_len
+    ) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake256_ctx_update_header(&ctx, ref.header, ref.header_len) == AESBlakeStatus_OK);
+    REQUIRE(aes_blake256_ctx_decrypt_final(&ctx, auth_tag) == AESBlakeStatus_AUTH_FAILED);
+}
+
+
+TEST_CASE("Streaming AES-Blake256 enforces call order and group alignment", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE256_KEY_BYTES] = {};
+    uint8_t nonce[AES_BLAKE256_NONCE_BYTES] = {};
+    uint8_t context[AES_BLAKE256_CONTEXT_BYTES] = {};
+    uint8_t data[4 * AES_BLAKE256_GROUP_BYTES] = {};
+    uint8_t out[5 * AES_BLAKE256_GROUP_BYTES];
+    uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+    size_t out_len = 0;
+
+    AESBlake256Ctx ctx;
+
+    SECTION("header after an unaligned message") {
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 40, out, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(out_len == AES_BLAKE256_GROUP_BYTES);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data, 32) == AESBlakeStatus_INVALID_LENGTH);
+        REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_INVALID_LENGTH);
+    }
+
+    SECTION("message after the header") {
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data, 32) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 32, out, &out_len) == AESBlakeStatus_INVALID_STATE);
+    }
+
+    SECTION("unaligned header") {
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data, 20) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_INVALID_LENGTH);
+    }
+
+    SECTION("mixed directions") {
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 32, out, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_decrypt_update(&ctx, data, 32, out, &out_len) == AESBlakeStatus_INVALID_STATE);
+        REQUIRE(aes_blake256_ctx_decrypt_final(&ctx, auth_tag) == AESBlakeStatus_INVALID_STATE);
+    }
+
+    SECTION("empty updates with NULL buffers") {
+        // A partial group is pending while the empty updates come in
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 40, out, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, nullptr, 0, out + out_len, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(out_len == 0);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data + 40, 24, out + 32, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data, 20) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, nullptr, 0) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data + 20, 12) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, nullptr, 0) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_OK);
+
+        uint8_t expected[2 * AES_BLAKE256_GROUP_BYTES];
+        uint8_t expected_tag[AES_BLAKE256_TAG_BYTES];
+        REQUIRE(aes_blake256_encrypt(
+            key, nonce, context, data, sizeof(expected), data, 32, expected, expected_tag
+        ) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(out, expected, sizeof(expected)) == 0);
+        REQUIRE(memcmp(auth_tag, expected_tag, sizeof(expected_tag)) == 0);
+    }
+
+    SECTION("use after final") {
+        aes_blake256_ctx_init(&ctx, key, nonce, context);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 64, out, &out_len) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_ctx_encrypt_update(&ctx, data, 32, out, &out_len) == AESBlakeStatus_INVALID_STATE);
+        REQUIRE(aes_blake256_ctx_update_header(&ctx, data, 32) == AESBlakeStatus_INVALID_STATE);
+        REQUIRE(aes_blake256_ctx_encrypt_final(&ctx, auth_tag) == AESBlakeStatus_INVALID_STATE);
+    }
+}
+
+
+TEST_CASE("Arena-backed streaming AES-Blake matches Python reference inputs", "[unittest][aes_blake]") {
+    const auto &ref256 = aes_blake256_long_reference();
+    const auto &ref512 = aes_blake512_long_reference();
+    AESBlake256Key key256;
+    AESBlake512Key key512;
+    aes_blake256_key_init(&key256, ref256.key, ref256.context);
+    aes_blake512_key_init(&key512, ref512.key, ref512.context);
+
+    for (const size_t misalignment : {size_t(0), size_t(1), size_t(63)}) {
+        std::vector<uint8_t> arena(aes_blake256_ctx_size() + misalignment);
+        uint8_t *base = arena.data() + misalignment;
+        REQUIRE(aes_blake256_ctx_init_arena(base, aes_blake256_ctx_size() - 1, &key256, ref256.nonce) == nullptr);
+
+        AESBlake256Ctx *ctx = aes_blake256_ctx_init_arena(base, aes_blake256_ctx_size(), &key256, ref256.nonce);
+        REQUIRE(ctx != nullptr);
+        REQUIRE(reinterpret_cast<uintptr_t>(ctx) % 64 == 0);
+        REQUIRE(reinterpret_cast<uint8_t *>(ctx) + sizeof(AESBlake256Ctx) <= arena.data() + arena.size());
+        const auto ciphertext = stream_message(
+            *ctx, aes_blake256_ctx_encrypt_update, aes_blake256_ctx_update_header,
+            ref256.plaintext, ref256.plaintext_len, ref256.header, ref256.header_len, AES_BLAKE256_GROUP_BYTES
+        );
+        uint8_t auth_tag[AES_BLAKE256_TAG_BYTES];
+        REQUIRE(aes_blake256_ctx_encrypt_final(ctx, auth_tag) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(ciphertext.data(), ref256.ciphertext, ref256.plaintext_len) == 0);
+        REQUIRE(memcmp(auth_tag, ref256.auth_tag, sizeof(auth_tag)) == 0);
+
+        // The final call wipes the scratch, only the context itself keeps its DONE phase
+        const auto *ctx_bytes = reinterpret_cast<const uint8_t *>(ctx);
+        size_t dirty = 0;
+        for (const uint8_t &byte : arena) {
+            const bool in_ctx = &byte >= ctx_bytes && &byte < ctx_bytes + sizeof(AESBlake256Ctx);
+            dirty += !in_ctx && byte != 0;
+        }
+        REQUIRE(dirty == 0);
+
+        std::vector<uint8_t> arena512(aes_blake512_ctx_size() + misalignment);
+        AESBlake512Ctx *ctx512 = aes_blake512_ctx_init_arena(
+            arena512.data() + misalignment, aes_blake512_ctx_size(), &key512, ref512.nonce
+        );
+        REQUIRE(ctx512 != nullptr);
+        const auto plaintext = stream_message(
+            *ctx512, aes_blake512_ctx_decrypt_update, aes_blake512_ctx_update_header,
+            ref512.ciphertext, ref512.plaintext_len, ref512.header, ref512.header_len, AES_BLAKE512_GROUP_BYTES
+        );
+        REQUIRE(aes_blake512_ctx_decrypt_final(ctx512, ref512.auth_tag) == AESBlakeStatus_OK);
+        REQUIRE(memcmp(plaintext.data(), ref512.plaintext, ref512.plaintext_len) == 0);
+    }
+}
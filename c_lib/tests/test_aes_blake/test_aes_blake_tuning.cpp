@@ -0,0 +1,238 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "csprng.h"
+#include "aes_block.h"
+#include "aes_blake.h"
+#include "aes_blake_pool.h"
+#include "aes_blake_tuning.h"
+#include "helpers/helpers.h"
+
+
+namespace fs = std::filesystem;
+
+
+static fs::path temp_file(const std::string &name) {
+    return fs::temp_directory_path() / ("aes_blake_tuning_test_" + name);
+}
+
+
+// A profile that sends everything from two tasks' worth of data to the pool
+static AESBlakeTuning forced_tuning(const AESBlakePool *pool) {
+    AESBlakeTuning tuning;
+    aes_blake_tuning_init(&tuning, pool);
+    tuning.parallel_min_bytes256 = 2 * AES_BLAKE_POOL_MIN_TASK_BYTES;
+    tuning.parallel_min_bytes512 = 2 * AES_BLAKE_POOL_MIN_TASK_BYTES;
+    return tuning;
+}
+
+
+TEST_CASE("AES-Blake tuning defaults follow the pool", "[unittest][aes_blake]") {
+    AESBlakeTuning tuning;
+    aes_blake_tuning_init(&tuning, nullptr);
+    REQUIRE(std::string(tuning.backend) == aes_select_backend()->name);
+    REQUIRE(tuning.thread_count == 0);
+    REQUIRE(tuning.parallel_min_bytes256 == AES_BLAKE_TUNING_NEVER);
+    REQUIRE(tuning.parallel_min_bytes512 == AES_BLAKE_TUNING_NEVER);
+
+    AESBlakePool *pool = aes_blake_pool_create(2);
+    aes_blake_tuning_init(&tuning, pool);
+    REQUIRE(tuning.thread_count == 2);
+    REQUIRE(tuning.parallel_min_bytes256 != AES_BLAKE_TUNING_NEVER);
+    REQUIRE(tuning.parallel_min_bytes512 != AES_BLAKE_TUNING_NEVER);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake tuning profiles roundtrip and reject stale caches", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(2);
+    AESBlakePool *other = aes_blake_pool_create(1);
+    const fs::path path = temp_file("profile");
+    fs::remove(path);
+
+    AESBlakeTuning tuning = forced_tuning(pool), loaded;
+    tuning.parallel_min_bytes512 = AES_BLAKE_TUNING_NEVER;
+    REQUIRE(aes_blake_tuning_load(&loaded, pool, path.string().c_str()) == 0);
+    REQUIRE(aes_blake_tuning_save(&tuning, path.string().c_str()) != 0);
+    REQUIRE(aes_blake_tuning_load(&loaded, pool, path.string().c_str()) == 1);
+    REQUIRE(memcmp(&loaded, &tuning, sizeof(tuning)) == 0);
+
+    // Another thread count, another backend or a damaged file leave the output alone
+    memset(&loaded, 0xA5, sizeof(loaded));
+    const AESBlakeTuning untouched = loaded;
+    REQUIRE(aes_blake_tuning_load(&loaded, other, path.string().c_str()) == 0);
+
+    aes_set_backend(aes_find_backend("clean"));
+    REQUIRE(aes_blake_tuning_load(&loaded, pool, path.string().c_str()) == 0);
+    aes_set_backend(nullptr);
+
+    std::ofstream(path, std::ios::trunc) << "aes_blake_tuning 1\nbackend";
+    REQUIRE(aes_blake_tuning_load(&loaded, pool, path.string().c_str()) == 0);
+    REQUIRE(memcmp(&loaded, &untouched, sizeof(loaded)) == 0);
+
+    // Setup replaces the damaged cache with a fresh calibration and then reuses it
+    aes_blake_tuning_setup(&tuning, pool, path.string().c_str());
+    REQUIRE(aes_blake_tuning_load(&loaded, pool, path.string().c_str()) == 1);
+    REQUIRE(memcmp(&loaded, &tuning, sizeof(tuning)) == 0);
+    fs::remove(path);
+
+    aes_blake_pool_destroy(other);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake calibration picks a measured size or never", "[unittest][aes_blake]") {
+    AESBlakePool *pool = aes_blake_pool_create(2);
+    AESBlakeTuning tuning;
+    aes_blake_tuning_calibrate(&tuning, pool);
+    REQUIRE(tuning.thread_count == 2);
+    for (const size_t threshold : {tuning.parallel_min_bytes256, tuning.parallel_min_bytes512}) {
+        if (threshold != AES_BLAKE_TUNING_NEVER) {
+            REQUIRE(threshold >= 2 * AES_BLAKE_POOL_MIN_TASK_BYTES);
+            REQUIRE(threshold <= (size_t(16) << 20));
+            REQUIRE((threshold & (threshold - 1)) == 0);
+        }
+    }
+
+    aes_blake_tuning_calibrate(&tuning, nullptr);
+    REQUIRE(tuning.parallel_min_bytes256 == AES_BLAKE_TUNING_NEVER);
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake256 auto dispatch matches the inline engine on both paths", "[unittest][aes_blake]") {
+    uint8_t key[AES_BLAKE256_KEY_BYTES], nonce[AES_BLAKE256_NONCE_BYTES], context[AES_BLAKE256_CONTEXT_BYTES];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(nonce, sizeof(nonce));
+    csprng_read_array(context, sizeof(context));
+    AESBlake256Key key_obj;
+    aes_blake256_key_init(&key_obj, key, context);
+
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    const AESBlakeTuning tuning = forced_tuning(pool);
+    std::vector<uint8_t> header(2 * AES_BLAKE256_GROUP_BYTES);
+    csprng_read_array(header.data(), static_cast<uint32_t>(header.size()));
+
+    // Below the threshold, at it and well above it
+    const size_t lengths[] = {5 * AES_BLAKE256_GROUP_BYTES, 2 * AES_BLAKE_POOL_MIN_TASK_BYTES, 9 * AES_BLAKE_POOL_MIN_TASK_BYTES};
+    for (const size_t length : lengths) {
+        std::vector<uint8_t> plaintext(length), expected(length), ciphertext(length), recovered(length);
+        csprng_read_array(plaintext.data(), static_cast<uint32_t>(length));
+        uint8_t expected_tag[AES_BLAKE256_TAG_BYTES], tag[AES_BLAKE256_TAG_BYTES];
+        REQUIRE(aes_blake256_encrypt_with_key(
+            &key_obj, nonce, plaintext.data(), length, header.data(), header.size(), expected.data(), expected_tag
+        ) == AESBlakeStatus_OK);
+        REQUIRE(aes_blake256_encrypt_auto(
+            &tuning, pool, &key_obj, nonce, plaintext.data(), length, header.data(), header.size(), ciphertext.data(), tag
+        ) == AESBlakeStatus_OK);
+        REQUIRE(ciphertext == expected);
+        REQUIRE(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+
+        REQUIRE(aes_blake256_decrypt_auto(
+            &tuning, pool, &key_obj, nonce, ciphertext.data(), length, header.data(), header.size(), tag, recovered.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(recovered == plaintext);
+        tag[0] ^= 0x01;
+        REQUIRE(aes_blake256_decrypt_auto(
+            &tuning, pool, &key_obj, nonce, ciphertext.data(), length, header.data(), header.size(), tag, recovered.data()
+        ) == AESBlakeStatus_AUTH_FAILED);
+    }
+    aes_blake_pool_destroy(pool);
+    aes_blake256_key_wipe(&key_obj);
+}
+
+
+struct AutoMessage {
+    std::vector<uint8_t> nonce, input, header, output, auth_tag;
+};
+
+
+template <typename Key>
+static void check_batch_auto() {
+    using V = AESBlakeVariant<Key>;
+    uint8_t key[V::key_bytes], context[V::context_bytes];
+    csprng_read_array(key, sizeof(key));
+    csprng_read_array(context, sizeof(context));
+    Key key_obj;
+    V::key_init(&key_obj, key, context);
+
+    // More messages than one staging window, with a few large enough for the parallel path
+    std::vector<AutoMessage> data(150);
+    std::vector<AESBlakeMessage> msgs(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        AutoMessage &d = data[i];
+        const size_t groups = i % 50 == 7 ? 3 * AES_BLAKE_POOL_MIN_TASK_BYTES / V::group_bytes : i % 9;
+        d.nonce.resize(V::nonce_bytes);
+        d.input.resize(groups * V::group_bytes);
+        d.header.resize((i % 2) * V::group_bytes);
+        d.output.resize(d.input.size());
+        d.auth_tag.resize(V::tag_bytes);
+        csprng_read_array(d.nonce.data(), static_cast<uint32_t>(d.nonce.size()));
+        csprng_read_array(d.input.data(), static_cast<uint32_t>(d.input.size()));
+        csprng_read_array(d.header.data(), static_cast<uint32_t>(d.header.size()));
+        msgs[i] = AESBlakeMessage{
+            d.nonce.data(), d.input.data(), d.input.size(), d.header.data(), d.header.size(),
+            d.output.data(), d.auth_tag.data(), AESBlakeStatus_INVALID_STATE
+        };
+    }
+
+    // Small messages fill more than the threshold together and are split over the pool
+    AESBlakePool *pool = aes_blake_pool_create(3);
+    AESBlakeTuning tuning = forced_tuning(pool);
+    tuning.parallel_min_bytes256 = tuning.parallel_min_bytes512 = 8 * V::group_bytes;
+    REQUIRE(V::encrypt_batch_auto(&tuning, pool, &key_obj, msgs.data(), msgs.size()) == AESBlakeStatus_OK);
+    for (size_t i = 0; i < data.size(); i++) {
+        AutoMessage &d = data[i];
+        std::vector<uint8_t> expected(d.input.size()), expected_tag(V::tag_bytes);
+        REQUIRE(V::encrypt_with_key(
+            &key_obj, d.nonce.data(), d.input.data(), d.input.size(), d.header.data(), d.header.size(),
+            expected.data(), expected_tag.data()
+        ) == AESBlakeStatus_OK);
+        REQUIRE(msgs[i].status == AESBlakeStatus_OK);
+        REQUIRE(d.output == expected);
+        REQUIRE(d.auth_tag == expected_tag);
+    }
+
+    // Decrypt in place, with one small and one large forged message
+    data[3].auth_tag[0] ^= 0x01;
+    data[57].auth_tag[0] ^= 0x01;
+    for (size_t i = 0; i < data.size(); i++) {
+        msgs[i].input = data[i].output.data();
+        msgs[i].status = AESBlakeStatus_INVALID_STATE;
+    }
+    REQUIRE(V::decrypt_batch_auto(&tuning, pool, &key_obj, msgs.data(), msgs.size()) == AESBlakeStatus_AUTH_FAILED);
+    for (size_t i = 0; i < data.size(); i++) {
+        if (i == 3 || i == 57) {
+            REQUIRE(msgs[i].status == AESBlakeStatus_AUTH_FAILED);
+            REQUIRE(data[i].output == std::vector<uint8_t>(data[i].input.size(), 0));
+        } else {
+            REQUIRE(msgs[i].status == AESBlakeStatus_OK);
+            REQUIRE(data[i].output == data[i].input);
+        }
+    }
+    aes_blake_pool_destroy(pool);
+}
+
+
+TEST_CASE("AES-Blake256 batch auto dispatch matches the inline engine", "[unittest][aes_blake]") {
+    check_batch_auto<AESBlake256Key>();
+}
+
+
+TEST_CASE("AES-Blake512 batch auto dispatch matches the inline engine", "[unittest][aes_blake]") {
+    check_batch_auto<AESBlake512Key>();
+}
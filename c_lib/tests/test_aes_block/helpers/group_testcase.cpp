@@ -0,0 +1,191 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "csprng.h"
+#include "aes_types.h"
+#include "aes_block.h"
+#include "helpers.h"
+
+
+void run_group_fips197_vectors(const AES_GroupFunc encrypt_fn, const AES_GroupFunc decrypt_fn) {
+    // A single-block group with an identity exchange pattern is plain AES
+    constexpr uint8_t identity_pattern[1][4] = {{0, 0, 0, 0}};
+
+    uint8_t plaintext[16], key[16], expected_ct[16];
+    hex_to_bytes("00112233445566778899aabbccddeeff", plaintext);
+    hex_to_bytes("000102030405060708090a0b0c0d0e0f", key);
+    hex_to_bytes("69c4e0d86a7b0430d8cdb78070b4c55a", expected_ct);
+
+    constexpr uint8_t key_count = 11;
+    uint8_t round_keys[key_count][16];
+    generate_original_aes128_round_keys(key, round_keys);
+
+    uint8_t state[16];
+    memcpy(state, plaintext, 16);
+    encrypt_fn(state, round_keys, key_count, 1, identity_pattern);
+    REQUIRE(memcmp(state, expected_ct, 16) == 0);
+
+    decrypt_fn(state, round_keys, key_count, 1, identity_pattern);
+    REQUIRE(memcmp(state, plaintext, 16) == 0);
+}
+
+
+void run_group_random_vectors(
+        const AES_GroupFunc encrypt_fn,
+        const AES_GroupFunc decrypt_fn,
+        const AES_GroupFunc reference_encrypt_fn
+) {
+    constexpr uint8_t enc_pattern[4][4] = {
+        {0, 1, 2, 3}, {1, 2, 3, 0}, {2, 3, 0, 1}, {3, 0, 1, 2}
+    };
+    constexpr uint8_t dec_pattern[4][4] = {
+        {0, 3, 2, 1}, {1, 0, 3, 2}, {2, 1, 0, 3}, {3, 2, 1, 0}
+    };
+    constexpr uint8_t key_count = 11;
+    constexpr uint8_t block_count = 4;
+
+    uint8_t plaintext[block_count * 16];
+    uint8_t round_keys[block_count * key_count][16];
+    csprng_read_array(plaintext, sizeof(plaintext));
+    csprng_read_array(&round_keys[0][0], sizeof(round_keys));
+
+    uint8_t data[block_count * 16];
+    uint8_t reference[block_count * 16];
+    memcpy(data, plaintext, sizeof(data));
+    memcpy(reference, plaintext, sizeof(reference));
+
+    encrypt_fn(data, round_keys, key_count, block_count, enc_pattern);
+    reference_encrypt_fn(reference, round_keys, key_count, block_count, enc_pattern);
+    REQUIRE(memcmp(data, reference, sizeof(data)) == 0);
+
+    decrypt_fn(data, round_keys, key_count, block_count, dec_pattern);
+    REQUIRE(memcmp(data, plaintext, sizeof(data)) == 0);
+}
+
+
+void run_blocks_random_vectors(
+        const AES_BlocksFunc encrypt_fn,
+        const AES_BlocksFunc decrypt_fn,
+        const uint8_t block_count
+) {
+    // The batched functions have the AES-Blake256 (x2) and AES-Blake512 (x4) patterns built in
+    constexpr uint8_t pattern_x2[2][4] = {
+        {0, 1, 0, 1}, {1, 0, 1, 0}
+    };
+    constexpr uint8_t pattern_x4[4][4] = {
+        {0, 1, 2, 3}, {1, 2, 3, 0}, {2, 3, 0, 1}, {3, 0, 1, 2}
+    };
+    const uint8_t (*enc_pattern)[4] = block_count == 2 ? pattern_x2 : pattern_x4;
+
+    // The kernels have specialized paths for 11 and 15 keys, 13 takes the generic path
+    constexpr uint8_t key_counts[] = {11, 13, 15};
+    constexpr uint8_t max_key_count = 15;
+
+    // An odd group count exercises both the wide and the tail paths of the kernels
+    constexpr size_t group_count = 11;
+    const size_t group_bytes = block_count * 16;
+    const size_t data_bytes = group_count * group_bytes;
+
+    for (const uint8_t key_count : key_counts) {
+        uint8_t plaintext[group_count * 64];
+        uint8_t round_keys[group_count * 4 * max_key_count][16];
+        csprng_read_array(plaintext, sizeof(plaintext));
+        csprng_read_array(&round_keys[0][0], sizeof(round_keys));
+
+        uint8_t data[group_count * 64];
+        uint8_t reference[group_count * 64];
+        memcpy(data, plaintext, sizeof(data));
+        memcpy(reference, plaintext, sizeof(reference));
+
+        encrypt_fn(data, data, round_keys, key_count, group_count);
+        for (size_t g = 0; g < group_count; g++) {
+            aes_encrypt_group_clean(
+                reference + g * group_bytes,
+                &round_keys[g * block_count * key_count],
+                key_count,
+                block_count,
+                enc_pattern
+            );
+        }
+        REQUIRE(memcmp(data, reference, data_bytes) == 0);
+
+        decrypt_fn(data, data, round_keys, key_count, group_count);
+        REQUIRE(memcmp(data, plaintext, data_bytes) == 0);
+
+        // Out of place through a misaligned output buffer must give the same result
+        uint8_t unaligned[group_count * 64 + 1];
+        uint8_t restored[group_count * 64];
+        encrypt_fn(plaintext, unaligned + 1, round_keys, key_count, group_count);
+        REQUIRE(memcmp(unaligned + 1, reference, data_bytes) == 0);
+
+        decrypt_fn(unaligned + 1, restored, round_keys, key_count, group_count);
+        REQUIRE(memcmp(restored, plaintext, data_bytes) == 0);
+    }
+}
+
+
+void run_blocks_sum_vectors(
+        const AES_BlocksFunc encrypt_fn,
+        const AES_BlocksSumFunc encrypt_sum_fn,
+        const AES_BlocksSumFunc decrypt_sum_fn,
+        const uint8_t block_count
+) {
+    constexpr uint8_t key_counts[] = {11, 13, 15};
+    constexpr uint8_t max_key_count = 15;
+    const size_t group_bytes = block_count * 16;
+
+    // Zero, one and odd group counts reach every wide and tail path of the kernels
+    for (const size_t group_count : {0, 1, 2, 5, 11}) {
+        for (const uint8_t key_count : key_counts) {
+            uint8_t plaintext[11 * 64];
+            uint8_t round_keys[11 * 4 * max_key_count][16];
+            uint8_t initial[64];
+            csprng_read_array(plaintext, sizeof(plaintext));
+            csprng_read_array(&round_keys[0][0], sizeof(round_keys));
+            csprng_read_array(initial, sizeof(initial));
+
+            // The checksum continues from its previous value
+            uint8_t expected[64];
+            memcpy(expected, initial, sizeof(expected));
+            for (size_t g = 0; g < group_count; g++) {
+                for (size_t i = 0; i < group_bytes; i++) {
+                    expected[i] ^= plaintext[g * group_bytes + i];
+                }
+            }
+
+            uint8_t reference[11 * 64];
+            encrypt_fn(plaintext, reference, round_keys, key_count, group_count);
+
+            uint8_t ciphertext[11 * 64 + 1];
+            uint8_t checksum[64];
+            memcpy(checksum, initial, sizeof(checksum));
+            encrypt_sum_fn(plaintext, ciphertext + 1, round_keys, key_count, group_count, checksum);
+            REQUIRE(memcmp(ciphertext + 1, reference, group_count * group_bytes) == 0);
+            REQUIRE(memcmp(checksum, expected, group_bytes) == 0);
+
+            uint8_t restored[11 * 64];
+            memcpy(checksum, initial, sizeof(checksum));
+            decrypt_sum_fn(ciphertext + 1, restored, round_keys, key_count, group_count, checksum);
+            REQUIRE(memcmp(restored, plaintext, group_count * group_bytes) == 0);
+            REQUIRE(memcmp(checksum, expected, group_bytes) == 0);
+
+            // In place, as the engine calls them
+            memcpy(checksum, initial, sizeof(checksum));
+            decrypt_sum_fn(reference, reference, round_keys, key_count, group_count, checksum);
+            REQUIRE(memcmp(reference, plaintext, group_count * group_bytes) == 0);
+            REQUIRE(memcmp(checksum, expected, group_bytes) == 0);
+        }
+    }
+}
@@ -102,5 +102,29 @@
         AES_Func decrypt_fn
     );
 
+    void run_group_fips197_vectors(
+        AES_GroupFunc encrypt_fn,
+        AES_GroupFunc decrypt_fn
+    );
+
+    void run_group_random_vectors(
+        AES_GroupFunc encrypt_fn,
+        AES_GroupFunc decrypt_fn,
+        AES_GroupFunc reference_encrypt_fn
+    );
+
+    void run_blocks_random_vectors(
+        AES_BlocksFunc encrypt_fn,
+        AES_BlocksFunc decrypt_fn,
+        uint8_t block_count
+    );
+
+    void run_blocks_sum_vectors(
+        AES_BlocksFunc encrypt_fn,
+        AES_BlocksSumFunc encrypt_sum_fn,
+        AES_BlocksSumFunc decrypt_sum_fn,
+        uint8_t block_count
+    );
+
 
 #endif // AES_BLOCK_HELPERS_H
\ No newline at end of file
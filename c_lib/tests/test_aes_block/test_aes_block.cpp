@@ -12,6 +12,8 @@
 #include <catch2/catch_all.hpp>
 #include <cstring>
 #include "aes_block.h"
+#include "aes_exchange.h"
+#include "csprng.h"
 #include "helpers/helpers.h"
 
 
@@ -33,3 +35,316 @@ TEST_CASE("T-table AES-128 FIPS-197 Vectors", "[unittest][aes]") {
 TEST_CASE("T-table AES-128 Two-Block Random Keys", "[unittest][aes]") {
     run_two_block_random_vectors(aes_encrypt_optimized, aes_decrypt_optimized);
 }
+
+
+TEST_CASE("Compact T-table AES-128 FIPS-197 Vectors", "[unittest][aes]") {
+    run_fips197_vectors(aes_encrypt_compact, aes_decrypt_compact);
+}
+
+
+TEST_CASE("Compact T-table AES-128 Two-Block Random Keys", "[unittest][aes]") {
+    run_two_block_random_vectors(aes_encrypt_compact, aes_decrypt_compact);
+}
+
+
+TEST_CASE("Bitsliced AES-128 FIPS-197 Vectors", "[unittest][aes]") {
+    run_fips197_vectors(aes_encrypt_bitsliced, aes_decrypt_bitsliced);
+}
+
+
+TEST_CASE("Bitsliced AES-128 Two-Block Random Keys", "[unittest][aes]") {
+    run_two_block_random_vectors(aes_encrypt_bitsliced, aes_decrypt_bitsliced);
+}
+
+
+TEST_CASE("Masked AES-128 FIPS-197 Vectors", "[unittest][aes]") {
+    run_fips197_vectors(aes_encrypt_masked, aes_decrypt_masked);
+}
+
+
+TEST_CASE("Masked AES-128 Two-Block Random Keys", "[unittest][aes]") {
+    run_two_block_random_vectors(aes_encrypt_masked, aes_decrypt_masked);
+}
+
+
+TEST_CASE("Clean AES-128 Group FIPS-197 Vectors", "[unittest][aes]") {
+    run_group_fips197_vectors(aes_encrypt_group_clean, aes_decrypt_group_clean);
+}
+
+
+TEST_CASE("Clean AES-128 Four-Block Group Random Keys", "[unittest][aes]") {
+    run_group_random_vectors(aes_encrypt_group_clean, aes_decrypt_group_clean, aes_encrypt_group_clean);
+}
+
+
+TEST_CASE("T-table AES-128 Group FIPS-197 Vectors", "[unittest][aes]") {
+    run_group_fips197_vectors(aes_encrypt_group_optimized, aes_decrypt_group_optimized);
+}
+
+
+TEST_CASE("T-table AES-128 Four-Block Group Random Keys", "[unittest][aes]") {
+    run_group_random_vectors(aes_encrypt_group_optimized, aes_decrypt_group_optimized, aes_encrypt_group_clean);
+}
+
+
+TEST_CASE("Compiled column exchange matches the reference exchange", "[unittest][aes]") {
+    for (uint8_t block_count = 1; block_count <= AES_GROUP_MAX_BLOCKS; block_count++) {
+        for (int trial = 0; trial < 64; trial++) {
+            uint8_t pattern[AES_GROUP_MAX_BLOCKS][4];
+            uint8_t data[AES_GROUP_MAX_BLOCKS * 16];
+            uint8_t reference[AES_GROUP_MAX_BLOCKS * 16];
+            csprng_read_array(&pattern[0][0], sizeof(pattern));
+            csprng_read_array(data, sizeof(data));
+            for (auto &row : pattern) {
+                for (uint8_t &source : row) {
+                    source %= block_count;
+                }
+            }
+            memcpy(reference, data, sizeof(data));
+
+            AES_ExchangePlan plan;
+            compile_exchange_pattern(&plan, pattern, block_count);
+            exchange_planned(data, &plan);
+            exchange_columns(reference, block_count, pattern);
+            REQUIRE(memcmp(data, reference, block_count * 16) == 0);
+        }
+    }
+}
+
+
+TEST_CASE("Clean AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_clean, aes_decrypt_blocks_x2_clean, 2);
+}
+
+
+TEST_CASE("Clean AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_clean, aes_decrypt_blocks_x4_clean, 4);
+}
+
+
+TEST_CASE("T-table AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_optimized, aes_decrypt_blocks_x2_optimized, 2);
+}
+
+
+TEST_CASE("T-table AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_optimized, aes_decrypt_blocks_x4_optimized, 4);
+}
+
+
+TEST_CASE("Compact T-table AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_compact, aes_decrypt_blocks_x2_compact, 2);
+}
+
+
+TEST_CASE("Compact T-table AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_compact, aes_decrypt_blocks_x4_compact, 4);
+}
+
+
+TEST_CASE("Bitsliced AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_bitsliced, aes_decrypt_blocks_x2_bitsliced, 2);
+}
+
+
+TEST_CASE("Bitsliced AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_bitsliced, aes_decrypt_blocks_x4_bitsliced, 4);
+}
+
+
+TEST_CASE("Masked AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_masked, aes_decrypt_blocks_x2_masked, 2);
+}
+
+
+TEST_CASE("Masked AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_masked, aes_decrypt_blocks_x4_masked, 4);
+}
+
+
+/*
+ * Splits random round keys into two shares and checks that the share-wise
+ * kernels match the plain masked ones and invert each other.
+ */
+static void run_masked_shares_vectors(
+        const AES_BlocksFunc encrypt_fn,
+        decltype(&aes_encrypt_blocks_x2_masked_shares) encrypt_shares_fn,
+        decltype(&aes_decrypt_blocks_x2_masked_shares) decrypt_shares_fn,
+        const uint8_t block_count
+) {
+    constexpr uint8_t key_count = 11;
+    constexpr size_t group_count = 5;
+    uint8_t round_keys[group_count * 4 * key_count][16];
+    uint8_t key_masks[group_count * 4 * key_count][16];
+    uint8_t masked_keys[group_count * 4 * key_count][16];
+    uint8_t plaintext[group_count * 64], expected[group_count * 64], data[group_count * 64];
+    csprng_read_array(&round_keys[0][0], sizeof(round_keys));
+    csprng_read_array(&key_masks[0][0], sizeof(key_masks));
+    csprng_read_array(plaintext, sizeof(plaintext));
+    for (size_t i = 0; i < group_count * 4 * key_count; i++) {
+        for (int j = 0; j < 16; j++) {
+            masked_keys[i][j] = round_keys[i][j] ^ key_masks[i][j];
+        }
+    }
+    const size_t data_bytes = group_count * block_count * 16;
+
+    encrypt_fn(plaintext, expected, round_keys, key_count, group_count);
+    encrypt_shares_fn(plaintext, data, masked_keys, key_masks, key_count, group_count);
+    REQUIRE(memcmp(data, expected, data_bytes) == 0);
+    decrypt_shares_fn(data, data, masked_keys, key_masks, key_count, group_count);
+    REQUIRE(memcmp(data, plaintext, data_bytes) == 0);
+}
+
+
+TEST_CASE("Masked AES-128 Batched Key Shares", "[unittest][aes]") {
+    run_masked_shares_vectors(
+        aes_encrypt_blocks_x2_masked, aes_encrypt_blocks_x2_masked_shares, aes_decrypt_blocks_x2_masked_shares, 2
+    );
+    run_masked_shares_vectors(
+        aes_encrypt_blocks_x4_masked, aes_encrypt_blocks_x4_masked_shares, aes_decrypt_blocks_x4_masked_shares, 4
+    );
+}
+
+
+#if defined(AES_ARCH_X86)
+
+TEST_CASE("AES-NI AES-128 FIPS-197 Vectors", "[unittest][aes]") {
+    if (!aes_cpu_has_aesni()) {
+        SKIP("AES-NI is not supported by this CPU");
+    }
+    run_fips197_vectors(aes_encrypt_aesni, aes_decrypt_aesni);
+}
+
+
+TEST_CASE("AES-NI AES-128 Two-Block Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_aesni()) {
+        SKIP("AES-NI is not supported by this CPU");
+    }
+    run_two_block_random_vectors(aes_encrypt_aesni, aes_decrypt_aesni);
+}
+
+
+TEST_CASE("AES-NI AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_aesni()) {
+        SKIP("AES-NI is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_aesni, aes_decrypt_blocks_x2_aesni, 2);
+}
+
+
+TEST_CASE("AES-NI AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_aesni()) {
+        SKIP("AES-NI is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_aesni, aes_decrypt_blocks_x4_aesni, 4);
+}
+
+
+TEST_CASE("VAES AVX2 AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_vaes_avx2()) {
+        SKIP("VAES AVX2 is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_vaes_avx2, aes_decrypt_blocks_x2_vaes_avx2, 2);
+}
+
+
+TEST_CASE("VAES AVX2 AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_vaes_avx2()) {
+        SKIP("VAES AVX2 is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_vaes_avx2, aes_decrypt_blocks_x4_vaes_avx2, 4);
+}
+
+
+TEST_CASE("VAES AVX-512 AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_vaes_avx512()) {
+        SKIP("VAES AVX-512 is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_vaes_avx512, aes_decrypt_blocks_x2_vaes_avx512, 2);
+}
+
+
+TEST_CASE("VAES AVX-512 AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_vaes_avx512()) {
+        SKIP("VAES AVX-512 is not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_vaes_avx512, aes_decrypt_blocks_x4_vaes_avx512, 4);
+}
+
+#endif
+
+
+#if defined(AES_ARCH_ARM64)
+
+TEST_CASE("ARMv8 CE AES-128 FIPS-197 Vectors", "[unittest][aes]") {
+    if (!aes_cpu_has_armce()) {
+        SKIP("ARMv8 Crypto Extensions are not supported by this CPU");
+    }
+    run_fips197_vectors(aes_encrypt_armce, aes_decrypt_armce);
+}
+
+
+TEST_CASE("ARMv8 CE AES-128 Two-Block Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_armce()) {
+        SKIP("ARMv8 Crypto Extensions are not supported by this CPU");
+    }
+    run_two_block_random_vectors(aes_encrypt_armce, aes_decrypt_armce);
+}
+
+
+TEST_CASE("ARMv8 CE AES-128 Batched x2 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_armce()) {
+        SKIP("ARMv8 Crypto Extensions are not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x2_armce, aes_decrypt_blocks_x2_armce, 2);
+}
+
+
+TEST_CASE("ARMv8 CE AES-128 Batched x4 Random Keys", "[unittest][aes]") {
+    if (!aes_cpu_has_armce()) {
+        SKIP("ARMv8 Crypto Extensions are not supported by this CPU");
+    }
+    run_blocks_random_vectors(aes_encrypt_blocks_x4_armce, aes_decrypt_blocks_x4_armce, 4);
+}
+
+#endif
+
+
+TEST_CASE("Selected AES-128 Backend Batched Random Keys", "[unittest][aes]") {
+    const AES_Backend *backend = aes_select_backend();
+    REQUIRE(backend != nullptr);
+    REQUIRE(backend == aes_select_backend());
+    run_fips197_vectors(backend->encrypt, backend->decrypt);
+    run_blocks_random_vectors(backend->encrypt_x2, backend->decrypt_x2, 2);
+    run_blocks_random_vectors(backend->encrypt_x4, backend->decrypt_x4, 4);
+}
+
+
+TEST_CASE("AES-128 Fused Checksum Kernels Match The Separate Passes", "[unittest][aes]") {
+    for (const char *name : {"clean", "optimized", "compact", "bitsliced", "masked", "aesni", "vaes_avx2", "vaes_avx512", "armce"}) {
+        const AES_Backend *backend = aes_find_backend(name);
+        if (backend == nullptr || backend->encrypt_x2_sum == nullptr) {
+            continue;
+        }
+        INFO("backend " << name);
+        run_blocks_sum_vectors(backend->encrypt_x2, backend->encrypt_x2_sum, backend->decrypt_x2_sum, 2);
+        run_blocks_sum_vectors(backend->encrypt_x4, backend->encrypt_x4_sum, backend->decrypt_x4_sum, 4);
+    }
+}
+
+
+TEST_CASE("AES-128 Backends Can Be Found And Forced", "[unittest][aes]") {
+    const AES_Backend *detected = aes_select_backend();
+    REQUIRE(aes_find_backend(detected->name) == detected);
+    REQUIRE(aes_find_backend("no_such_backend") == nullptr);
+
+    for (const char *name : {"clean", "optimized", "compact", "bitsliced", "masked"}) {
+        const AES_Backend *backend = aes_find_backend(name);
+        REQUIRE(backend != nullptr);
+        REQUIRE(strcmp(backend->name, name) == 0);
+        aes_set_backend(backend);
+        REQUIRE(aes_select_backend() == backend);
+    }
+    aes_set_backend(nullptr);
+    REQUIRE(aes_select_backend() == detected);
+}
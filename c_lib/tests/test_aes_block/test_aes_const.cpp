@@ -39,10 +39,10 @@ TEST_CASE("Computed AES encryption T-tables match hardcoded arrays", "[unittest]
         uint32_t t0, t1, t2, t3;
         compute_enc_table_words(idx, &t0, &t1, &t2, &t3, true);
 
-        REQUIRE(Te0[x] == t0);
-        REQUIRE(Te1[x] == t1);
-        REQUIRE(Te2[x] == t2);
-        REQUIRE(Te3[x] == t3);
+        REQUIRE(AES_TE(0, x) == t0);
+        REQUIRE(AES_TE(1, x) == t1);
+        REQUIRE(AES_TE(2, x) == t2);
+        REQUIRE(AES_TE(3, x) == t3);
     }
 }
 
@@ -54,10 +54,39 @@ TEST_CASE("Computed AES decryption IMC tables match hardcoded arrays", "[unittes
         uint32_t t0, t1, t2, t3;
         compute_imc_table_words(idx, &t0, &t1, &t2, &t3, true);
 
-        REQUIRE(IMC0[x] == t0);
-        REQUIRE(IMC1[x] == t1);
-        REQUIRE(IMC2[x] == t2);
-        REQUIRE(IMC3[x] == t3);
+        REQUIRE(AES_IMC(0, x) == t0);
+        REQUIRE(AES_IMC(1, x) == t1);
+        REQUIRE(AES_IMC(2, x) == t2);
+        REQUIRE(AES_IMC(3, x) == t3);
     }
 }
 
+
+
+TEST_CASE("Computed AES equivalent inverse Td tables match hardcoded arrays", "[unittest][aes]") {
+    for (int x = 0; x < 256; x++) {
+        const auto idx = static_cast<uint8_t>(x);
+
+        uint32_t t0, t1, t2, t3;
+        compute_imc_table_words(aes_inv_sbox[idx], &t0, &t1, &t2, &t3, true);
+
+        REQUIRE(AES_TD(0, x) == t0);
+        REQUIRE(AES_TD(1, x) == t1);
+        REQUIRE(AES_TD(2, x) == t2);
+        REQUIRE(AES_TD(3, x) == t3);
+    }
+}
+
+
+TEST_CASE("Compact AES tables hold every T-table word twice", "[unittest][aes]") {
+    for (int x = 0; x < 256; x++) {
+        const auto idx = static_cast<uint8_t>(x);
+
+        uint32_t t0, t1, t2, t3;
+        compute_enc_table_words(idx, &t0, &t1, &t2, &t3, true);
+        REQUIRE(Te0_x2[x] == (static_cast<uint64_t>(t0) << 32 | t0));
+
+        compute_imc_table_words(aes_inv_sbox[idx], &t0, &t1, &t2, &t3, true);
+        REQUIRE(Td0_x2[x] == (static_cast<uint64_t>(t0) << 32 | t0));
+    }
+}
@@ -18,13 +18,14 @@ void run_blake32_derive_keys_test(
         const DigestFunc32 digest_fn,
         const DeriveFunc32 derive_fn
 ) {
-    // 1) Prepare a zeroed key[8] and zeroed nonce/context[8].
+    // 1) Prepare a zeroed key[8], nonce[8] and context[16].
     uint32_t zero_key[8]   = {};
     uint32_t zero_nonce[8] = {};
+    uint32_t zero_context[16] = {};
 
     // 2) Compute the initial state by “digesting the context” (all-zero key/nonce).
     uint32_t init_state[16] = {};
-    digest_fn(init_state, zero_key, zero_nonce);
+    digest_fn(init_state, zero_key, zero_context);
 
     // 3) Compute knc[16] via compute_key_nonce_composite32(zero_key, zero_nonce, knc).
     uint32_t knc[16];
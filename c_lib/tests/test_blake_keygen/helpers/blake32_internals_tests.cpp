@@ -136,7 +136,7 @@ void run_blake32_compute_knc_test(const KncFunc32 knc_fn) {
 
 void run_blake32_digest_context_test(const DigestFunc32 digest_fn) {
     constexpr uint32_t key[8] = {};
-    uint32_t context[8] = {};
+    uint32_t context[16] = {};
     uint32_t state[16] = {};
 
     digest_fn(state, key, context);
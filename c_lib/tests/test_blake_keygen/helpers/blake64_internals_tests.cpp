@@ -137,7 +137,7 @@ void run_blake64_compute_knc_test(const KncFunc64 knc_fn) {
 
 void run_blake64_digest_context_test(const DigestFunc64 digest_fn) {
     constexpr uint64_t key[8] = {};
-    uint64_t context[8] = {};
+    uint64_t context[16] = {};
     uint64_t state[16] = {};
 
     digest_fn(state, key, context);
@@ -0,0 +1,163 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csprng.h"
+#include "blake_types.h"
+#include "blake_keygen.h"
+
+
+// The first counters straddle a 32-bit boundary so that the carry into the high counter word is covered
+static constexpr uint64_t first_counters[3] = {0, 0xFFFFFFFDull, 0x123456789ull};
+static constexpr size_t max_counters = 19;
+
+
+void run_blake32_derive_keys_many_test(const DeriveManyFunc32 derive_many_fn) {
+    for (const uint8_t key_count : {uint8_t(11), uint8_t(7)}) {
+        for (const uint64_t first_counter : first_counters) {
+            uint32_t init_state[16], knc[16];
+            csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+            csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+
+            const size_t keys_per_counter = 2 * key_count;
+            std::vector<uint8_t> expected(max_counters * keys_per_counter * 16);
+            auto *expected_keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+            for (size_t i = 0; i < max_counters; i++) {
+                uint8_t (*keys)[16] = &expected_keys[i * keys_per_counter];
+                blake32_optimized_derive_keys(
+                    init_state, knc, key_count, first_counter + i, KDFDomain_MSG, &keys[0], &keys[key_count]
+                );
+            }
+
+            for (size_t n = 0; n <= max_counters; n++) {
+                // One spare key after the output catches writes past the last counter
+                std::vector<uint8_t> actual((n * keys_per_counter + 1) * 16, 0xA5);
+                derive_many_fn(
+                    init_state, knc, key_count, first_counter, n, KDFDomain_MSG,
+                    reinterpret_cast<uint8_t(*)[16]>(actual.data())
+                );
+                const size_t key_bytes = n * keys_per_counter * 16;
+                REQUIRE(memcmp(actual.data(), expected.data(), key_bytes) == 0);
+                REQUIRE(actual[key_bytes] == 0xA5);
+            }
+        }
+    }
+}
+
+
+void run_blake64_derive_keys_many_test(const DeriveManyFunc64 derive_many_fn) {
+    for (const uint8_t key_count : {uint8_t(11), uint8_t(7)}) {
+        for (const uint64_t first_counter : first_counters) {
+            uint64_t init_state[16], knc[16];
+            csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+            csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+
+            const size_t keys_per_counter = 4 * key_count;
+            std::vector<uint8_t> expected(max_counters * keys_per_counter * 16);
+            auto *expected_keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+            for (size_t i = 0; i < max_counters; i++) {
+                uint8_t (*keys)[16] = &expected_keys[i * keys_per_counter];
+                blake64_optimized_derive_keys(
+                    init_state, knc, key_count, first_counter + i, KDFDomain_MSG,
+                    &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+                );
+            }
+
+            for (size_t n = 0; n <= max_counters; n++) {
+                std::vector<uint8_t> actual((n * keys_per_counter + 1) * 16, 0xA5);
+                derive_many_fn(
+                    init_state, knc, key_count, first_counter, n, KDFDomain_MSG,
+                    reinterpret_cast<uint8_t(*)[16]>(actual.data())
+                );
+                const size_t key_bytes = n * keys_per_counter * 16;
+                REQUIRE(memcmp(actual.data(), expected.data(), key_bytes) == 0);
+                REQUIRE(actual[key_bytes] == 0xA5);
+            }
+        }
+    }
+}
+
+
+// Jobs cycle through several knc values, domains and scattered counters, as in a batch of messages,
+// and every job but each fourth one brings its own init state, as do streams under different keys
+static constexpr KDFDomain job_domains[3] = {KDFDomain_MSG, KDFDomain_HDR, KDFDomain_CHK};
+static constexpr size_t job_kncs = 3;
+static constexpr size_t job_states = 2;
+
+
+template <typename Word, typename Job, typename DeriveJobsFn, typename DeriveFn>
+static void run_derive_keys_jobs_test(
+        const DeriveJobsFn derive_jobs_fn,
+        const DeriveFn derive_fn,
+        const size_t streams
+) {
+    for (const uint8_t key_count : {uint8_t(11), uint8_t(7)}) {
+        Word init_state[16], own_states[job_states][16], knc[job_kncs][16];
+        csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t*>(own_states), sizeof(own_states));
+        csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+
+        std::vector<Job> jobs(max_counters);
+        for (size_t i = 0; i < max_counters; i++) {
+            jobs[i].knc = knc[i % job_kncs];
+            jobs[i].counter = first_counters[i % 3] + i / 2;
+            jobs[i].domain = job_domains[i % 3];
+            jobs[i].init_state = i % 4 == 0 ? nullptr : own_states[i % job_states];
+        }
+
+        const size_t keys_per_job = streams * key_count;
+        std::vector<uint8_t> expected(max_counters * keys_per_job * 16);
+        auto *expected_keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+        for (size_t i = 0; i < max_counters; i++) {
+            const Word *job_state = jobs[i].init_state != nullptr ? jobs[i].init_state : init_state;
+            derive_fn(job_state, jobs[i], key_count, &expected_keys[i * keys_per_job]);
+        }
+
+        for (size_t n = 0; n <= max_counters; n++) {
+            std::vector<uint8_t> actual((n * keys_per_job + 1) * 16, 0xA5);
+            derive_jobs_fn(init_state, jobs.data(), key_count, n, reinterpret_cast<uint8_t(*)[16]>(actual.data()));
+            const size_t key_bytes = n * keys_per_job * 16;
+            REQUIRE(memcmp(actual.data(), expected.data(), key_bytes) == 0);
+            REQUIRE(actual[key_bytes] == 0xA5);
+        }
+    }
+}
+
+
+void run_blake32_derive_keys_jobs_test(const DeriveJobsFunc32 derive_jobs_fn) {
+    run_derive_keys_jobs_test<uint32_t, Blake32KeyJob>(
+        derive_jobs_fn,
+        [](const uint32_t *init_state, const Blake32KeyJob &job, const uint8_t key_count, uint8_t keys[][16]) {
+            blake32_optimized_derive_keys(
+                init_state, job.knc, key_count, job.counter, job.domain, &keys[0], &keys[key_count]
+            );
+        },
+        2
+    );
+}
+
+
+void run_blake64_derive_keys_jobs_test(const DeriveJobsFunc64 derive_jobs_fn) {
+    run_derive_keys_jobs_test<uint64_t, Blake64KeyJob>(
+        derive_jobs_fn,
+        [](const uint64_t *init_state, const Blake64KeyJob &job, const uint8_t key_count, uint8_t keys[][16]) {
+            blake64_optimized_derive_keys(
+                init_state, job.knc, key_count, job.counter, job.domain,
+                &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+            );
+        },
+        4
+    );
+}
@@ -26,6 +26,11 @@
         DeriveFunc64 derive_fn
     );
 
+    void run_blake32_derive_keys_many_test(DeriveManyFunc32 derive_many_fn);
+    void run_blake64_derive_keys_many_test(DeriveManyFunc64 derive_many_fn);
+    void run_blake32_derive_keys_jobs_test(DeriveJobsFunc32 derive_jobs_fn);
+    void run_blake64_derive_keys_jobs_test(DeriveJobsFunc64 derive_jobs_fn);
+
     void run_blake32_permutation_test(PermuteFunc32 permute_fn);
     void run_blake64_permutation_test(PermuteFunc64 permute_fn);
 
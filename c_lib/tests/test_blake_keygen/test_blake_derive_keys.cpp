@@ -10,6 +10,9 @@
  */
 
 #include <catch2/catch_all.hpp>
+#include <cstring>
+#include <vector>
+#include "csprng.h"
 #include "blake_keygen.h"
 #include "helpers/helpers.h"
 
@@ -47,4 +50,315 @@ TEST_CASE("Blake64 optimized derive_keys matches Python test vectors", "[unittes
         blake64_optimized_digest_context,
         blake64_optimized_derive_keys
     );
-}
\ No newline at end of file
+}
+
+
+TEST_CASE("Blake32 masked derive_keys matches Python test vectors", "[unittest][keygen]") {
+    run_blake32_derive_keys_test(
+        blake32_clean_compute_knc,
+        blake32_clean_digest_context,
+        blake32_masked_derive_keys
+    );
+}
+
+
+TEST_CASE("Blake64 masked derive_keys matches Python test vectors", "[unittest][keygen]") {
+    run_blake64_derive_keys_test(
+        blake64_clean_compute_knc,
+        blake64_clean_digest_context,
+        blake64_masked_derive_keys
+    );
+}
+
+#if defined(BLAKE_ARCH_X86)
+
+TEST_CASE("Blake32 SSE4.1 derive_keys matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_sse41()) {
+        SKIP("SSE4.1 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_test(
+        blake32_optimized_compute_knc,
+        blake32_sse41_digest_context,
+        blake32_sse41_derive_keys
+    );
+}
+
+
+TEST_CASE("Blake32 AVX2 derive_keys matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2() || !blake_cpu_has_sse41()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_test(
+        blake32_optimized_compute_knc,
+        blake32_sse41_digest_context,
+        blake32_avx2_derive_keys
+    );
+}
+
+
+TEST_CASE("Blake64 AVX2 derive_keys matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake64_derive_keys_test(
+        blake64_optimized_compute_knc,
+        blake64_avx2_digest_context,
+        blake64_avx2_derive_keys
+    );
+}
+
+
+TEST_CASE("Blake64 AVX-512VL derive_keys matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512vl()) {
+        SKIP("AVX-512VL is not supported by this CPU");
+    }
+    run_blake64_derive_keys_test(
+        blake64_optimized_compute_knc,
+        blake64_avx512_digest_context,
+        blake64_avx512_derive_keys
+    );
+}
+
+#endif
+
+
+#if defined(BLAKE_ARCH_ARM64)
+
+TEST_CASE("Blake32 NEON derive_keys matches Python test vectors", "[unittest][keygen]") {
+    run_blake32_derive_keys_test(
+        blake32_optimized_compute_knc,
+        blake32_neon_digest_context,
+        blake32_neon_derive_keys
+    );
+}
+
+#endif
+
+
+TEST_CASE("Blake32 selected derive_keys matches Python test vectors", "[unittest][keygen]") {
+    run_blake32_derive_keys_test(
+        blake32_optimized_compute_knc,
+        blake32_optimized_digest_context,
+        blake32_select_derive_keys()
+    );
+}
+
+
+TEST_CASE("Blake64 selected derive_keys matches Python test vectors", "[unittest][keygen]") {
+    run_blake64_derive_keys_test(
+        blake64_optimized_compute_knc,
+        blake64_select_digest_context(),
+        blake64_select_derive_keys()
+    );
+}
+
+
+TEST_CASE("Blake32 optimized derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    run_blake32_derive_keys_many_test(blake32_optimized_derive_keys_many);
+}
+
+
+TEST_CASE("Blake64 optimized derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    run_blake64_derive_keys_many_test(blake64_optimized_derive_keys_many);
+}
+
+
+#if defined(BLAKE_ARCH_X86)
+
+TEST_CASE("Blake32 AVX2 derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_many_test(blake32_avx2_derive_keys_many);
+}
+
+
+TEST_CASE("Blake32 AVX-512 derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512()) {
+        SKIP("AVX-512 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_many_test(blake32_avx512_derive_keys_many);
+}
+
+
+TEST_CASE("Blake64 AVX2 derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake64_derive_keys_many_test(blake64_avx2_derive_keys_many);
+}
+
+
+TEST_CASE("Blake64 AVX-512 derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512vl()) {
+        SKIP("AVX-512VL is not supported by this CPU");
+    }
+    run_blake64_derive_keys_many_test(blake64_avx512_derive_keys_many);
+}
+
+
+TEST_CASE("Blake32 AVX2 derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_jobs_test(blake32_avx2_derive_keys_jobs);
+}
+
+
+TEST_CASE("Blake32 AVX-512 derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512()) {
+        SKIP("AVX-512 is not supported by this CPU");
+    }
+    run_blake32_derive_keys_jobs_test(blake32_avx512_derive_keys_jobs);
+}
+
+
+TEST_CASE("Blake64 AVX2 derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake64_derive_keys_jobs_test(blake64_avx2_derive_keys_jobs);
+}
+
+
+TEST_CASE("Blake64 AVX-512 derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512vl()) {
+        SKIP("AVX-512VL is not supported by this CPU");
+    }
+    run_blake64_derive_keys_jobs_test(blake64_avx512_derive_keys_jobs);
+}
+
+#endif
+
+
+TEST_CASE("Blake32 dispatched derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    run_blake32_derive_keys_many_test(blake32_derive_keys_many);
+}
+
+
+TEST_CASE("Blake64 dispatched derive_keys_many matches derive_keys", "[unittest][keygen]") {
+    run_blake64_derive_keys_many_test(blake64_derive_keys_many);
+}
+
+
+TEST_CASE("Blake32 dispatched derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    run_blake32_derive_keys_jobs_test(blake32_derive_keys_jobs);
+}
+
+
+TEST_CASE("Blake64 dispatched derive_keys_jobs matches derive_keys", "[unittest][keygen]") {
+    run_blake64_derive_keys_jobs_test(blake64_derive_keys_jobs);
+}
+
+
+/*
+ * The shares of the masked keygen must XOR to the keys of `derive_keys_many`,
+ * with fresh masks on every call.
+ */
+template <typename Word, typename SharesFunc, typename ManyFunc>
+static void run_masked_key_shares_test(SharesFunc shares_fn, ManyFunc many_fn, const size_t streams) {
+    constexpr uint8_t key_count = 11;
+    constexpr size_t n = 3;
+    Word init_state[16], knc[16];
+    uint64_t first_counter;
+    csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+    csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+    csprng_read_array(reinterpret_cast<uint8_t*>(&first_counter), sizeof(first_counter));
+
+    const size_t key_total = n * streams * key_count;
+    std::vector<uint8_t> expected(key_total * 16), keys(key_total * 16), masks(key_total * 16), first_keys;
+    auto as_keys = [](std::vector<uint8_t> &v) { return reinterpret_cast<uint8_t (*)[16]>(v.data()); };
+    many_fn(init_state, knc, key_count, first_counter, n, KDFDomain_MSG, as_keys(expected));
+
+    for (int call = 0; call < 2; call++) {
+        shares_fn(init_state, knc, key_count, first_counter, n, KDFDomain_MSG, as_keys(keys), as_keys(masks));
+        std::vector<uint8_t> combined(key_total * 16);
+        for (size_t i = 0; i < combined.size(); i++) {
+            combined[i] = keys[i] ^ masks[i];
+        }
+        REQUIRE(combined == expected);
+        REQUIRE(keys != expected);
+        if (call == 0) {
+            first_keys = keys;
+        }
+    }
+    REQUIRE(keys != first_keys);
+}
+
+
+TEST_CASE("Masked key shares recombine to the derived round keys", "[unittest][keygen]") {
+    run_masked_key_shares_test<uint32_t>(blake32_masked_derive_key_shares, blake32_derive_keys_many, 2);
+    run_masked_key_shares_test<uint64_t>(blake64_masked_derive_key_shares, blake64_derive_keys_many, 4);
+}
+
+
+TEST_CASE("Forced masked derive_keys routes all dispatched entry points", "[unittest][keygen]") {
+    const DeriveFunc32 detected32 = blake32_select_derive_keys();
+    const DeriveFunc64 detected64 = blake64_select_derive_keys();
+
+    blake32_set_derive_keys(blake32_masked_derive_keys);
+    blake64_set_derive_keys(blake64_masked_derive_keys);
+    REQUIRE(blake32_select_derive_keys() == blake32_masked_derive_keys);
+    REQUIRE(blake64_select_derive_keys() == blake64_masked_derive_keys);
+    run_blake32_derive_keys_many_test(blake32_derive_keys_many);
+    run_blake64_derive_keys_many_test(blake64_derive_keys_many);
+    run_blake32_derive_keys_jobs_test(blake32_derive_keys_jobs);
+    run_blake64_derive_keys_jobs_test(blake64_derive_keys_jobs);
+
+    blake32_set_derive_keys(nullptr);
+    blake64_set_derive_keys(nullptr);
+    REQUIRE(blake32_select_derive_keys() == detected32);
+    REQUIRE(blake64_select_derive_keys() == detected64);
+}
+
+
+TEST_CASE("Blake32 key stream yields the optimized derive_keys schedule", "[unittest][keygen]") {
+    for (const uint8_t key_count : {uint8_t(1), uint8_t(11), uint8_t(40)}) {
+        uint32_t init_state[16], knc[16];
+        uint64_t block_counter;
+        csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t*>(&block_counter), sizeof(block_counter));
+
+        std::vector<uint8_t> expected(2 * key_count * 16);
+        auto *keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+        blake32_optimized_derive_keys(init_state, knc, key_count, block_counter, KDFDomain_HDR, &keys[0], &keys[key_count]);
+
+        Blake32KeyStream stream;
+        blake32_optimized_key_stream_init(&stream, init_state, knc, block_counter, KDFDomain_HDR);
+        for (uint8_t round = 0; round < key_count; round++) {
+            uint8_t round_keys[2][16];
+            blake32_optimized_key_stream_next(&stream, round_keys);
+            REQUIRE(memcmp(round_keys[0], keys[round], 16) == 0);
+            REQUIRE(memcmp(round_keys[1], keys[key_count + round], 16) == 0);
+        }
+    }
+}
+
+
+TEST_CASE("Blake64 key stream yields the optimized derive_keys schedule", "[unittest][keygen]") {
+    for (const uint8_t key_count : {uint8_t(1), uint8_t(11), uint8_t(40)}) {
+        uint64_t init_state[16], knc[16];
+        uint64_t block_counter;
+        csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+        csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+        csprng_read_array(reinterpret_cast<uint8_t*>(&block_counter), sizeof(block_counter));
+
+        std::vector<uint8_t> expected(4 * key_count * 16);
+        auto *keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+        blake64_optimized_derive_keys(
+            init_state, knc, key_count, block_counter, KDFDomain_HDR,
+            &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+        );
+
+        Blake64KeyStream stream;
+        blake64_optimized_key_stream_init(&stream, init_state, knc, block_counter, KDFDomain_HDR);
+        for (uint8_t round = 0; round < key_count; round++) {
+            uint8_t round_keys[4][16];
+            blake64_optimized_key_stream_next(&stream, round_keys);
+            for (size_t block = 0; block < 4; block++) {
+                REQUIRE(memcmp(round_keys[block], keys[block * key_count + round], 16) == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,305 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csprng.h"
+#include "blake_cpu.h"
+#include "blake_keygen.h"
+
+
+// Keys 0, 1 and 10 of every stream for an all-zero key, nonce and context and
+// key_count 11, printed by py_ref/scripts/reduced_keygen_vectors.py from the
+// ReducedBlake32/64 reference classes. Key 1 is the first folded key and key 10
+// the even key of the sixth and last mix step.
+template <size_t Streams>
+struct ReducedVector {
+    KDFDomain domain;
+    uint64_t counter;
+    uint8_t keys[Streams][3][16];
+};
+
+static constexpr size_t vector_rounds[3] = {0, 1, 10};
+static constexpr uint8_t vector_key_count = 11;
+
+
+static const ReducedVector<2> reduced32_vectors[] = {
+    {KDFDomain_MSG, 0ULL, {
+        {
+            {0xAC, 0x93, 0x64, 0x75, 0x73, 0xE8, 0xFE, 0x6A, 0x5D, 0x2D, 0x0F, 0xA2, 0xD6, 0xEA, 0x9C, 0x8D},
+            {0x57, 0xF0, 0x59, 0xDE, 0xBD, 0x07, 0xE6, 0xFF, 0x3B, 0x7E, 0xC9, 0xD1, 0x96, 0x22, 0x8B, 0xB9},
+            {0x6F, 0xEA, 0xDB, 0xEC, 0xF2, 0xE4, 0x18, 0xC6, 0x17, 0xE5, 0x11, 0x80, 0xAA, 0x60, 0x1B, 0x7F},
+        },
+        {
+            {0xD0, 0xA7, 0x46, 0xE3, 0x02, 0x6E, 0xCF, 0x4A, 0xD8, 0xF1, 0xD9, 0xBF, 0x21, 0x92, 0x09, 0x8A},
+            {0x60, 0xBD, 0xEA, 0xD1, 0xC1, 0x96, 0x09, 0xA9, 0xE5, 0x77, 0x0D, 0xA3, 0x0C, 0x7E, 0x4E, 0xB1},
+            {0x01, 0x2A, 0x91, 0xC1, 0x85, 0xE5, 0x66, 0xA4, 0xAC, 0xC9, 0xBD, 0x95, 0xAE, 0x81, 0x36, 0x9A},
+        },
+    }},
+    {KDFDomain_HDR, 1ULL, {
+        {
+            {0x44, 0x9E, 0x93, 0x81, 0xCC, 0xD6, 0x63, 0xF8, 0x12, 0x15, 0xA2, 0x0E, 0xEF, 0xC4, 0xD9, 0x3C},
+            {0x9F, 0xA6, 0x01, 0xD6, 0xA1, 0x3F, 0x18, 0x11, 0x02, 0x13, 0x38, 0xAC, 0x31, 0x5F, 0xA3, 0xAE},
+            {0xA7, 0xC3, 0x94, 0xFD, 0xC5, 0xAC, 0x22, 0xCA, 0x0C, 0x56, 0x2B, 0x38, 0xFE, 0x3F, 0x07, 0x61},
+        },
+        {
+            {0x12, 0xE4, 0x9F, 0x53, 0x1B, 0xCE, 0x80, 0xD9, 0x25, 0x17, 0x94, 0x6A, 0xA0, 0x76, 0xA4, 0xD3},
+            {0x2D, 0x7D, 0xB9, 0x26, 0x6B, 0xA7, 0x7B, 0x07, 0x9F, 0xC5, 0x1D, 0xD1, 0x43, 0x2F, 0xB4, 0x9B},
+            {0xFC, 0xEB, 0x18, 0x6D, 0xB1, 0x42, 0xE3, 0x99, 0x9A, 0x44, 0xCA, 0xE2, 0x33, 0xF5, 0xD4, 0xF2},
+        },
+    }},
+    {KDFDomain_CHK, 0x100000002ULL, {
+        {
+            {0xED, 0x6E, 0xFC, 0x86, 0xCD, 0x92, 0x69, 0x2B, 0x02, 0x4B, 0x64, 0xE2, 0xC0, 0xA9, 0xCB, 0x6C},
+            {0xFE, 0x08, 0x46, 0x09, 0x3E, 0x6D, 0x73, 0xC6, 0xDE, 0x07, 0xBD, 0xC8, 0x19, 0xDD, 0x62, 0xB5},
+            {0x8A, 0x67, 0xC1, 0x80, 0xD8, 0x28, 0x5D, 0x96, 0xD7, 0x1C, 0xAF, 0x40, 0x85, 0x27, 0x78, 0x4B},
+        },
+        {
+            {0xF6, 0x7D, 0xEB, 0x5C, 0x5C, 0x1D, 0x22, 0x35, 0x69, 0x61, 0xB7, 0xD3, 0xF3, 0xBE, 0x87, 0xF5},
+            {0xB9, 0xE2, 0x84, 0xA0, 0x5B, 0x37, 0x43, 0xF3, 0xC3, 0x3A, 0xC2, 0xC4, 0xFB, 0xD2, 0xEC, 0xCA},
+            {0xC0, 0x50, 0x83, 0xBE, 0x10, 0xBC, 0x24, 0x6D, 0x66, 0xAB, 0x6B, 0xB2, 0x22, 0x80, 0x84, 0xD3},
+        },
+    }},
+};
+
+
+static const ReducedVector<4> reduced64_vectors[] = {
+    {KDFDomain_MSG, 0ULL, {
+        {
+            {0x34, 0x89, 0xB0, 0xCC, 0xBC, 0x2E, 0x6F, 0xAB, 0xFC, 0xBB, 0xB3, 0x42, 0xEF, 0xBF, 0x63, 0x7F},
+            {0x8E, 0xC9, 0x75, 0x73, 0x5A, 0x7E, 0x5A, 0xB8, 0x29, 0xB9, 0x1B, 0x47, 0x9C, 0xD5, 0x59, 0x62},
+            {0x5A, 0x5E, 0x4A, 0x20, 0x9F, 0x82, 0xB6, 0x0D, 0xC7, 0x60, 0xC3, 0x99, 0x0D, 0x21, 0xE1, 0x4C},
+        },
+        {
+            {0xC5, 0x39, 0x0F, 0xC1, 0xD4, 0xA6, 0x47, 0xCD, 0x2C, 0x81, 0xA6, 0xF2, 0x3B, 0x9B, 0x64, 0x6E},
+            {0x00, 0x6E, 0xE3, 0x85, 0x42, 0x02, 0x95, 0x22, 0x71, 0x54, 0x1B, 0xFD, 0xB0, 0xCA, 0xCF, 0x34},
+            {0x6C, 0xE8, 0xA3, 0x78, 0xFC, 0x67, 0xF0, 0x59, 0xF9, 0x58, 0xC5, 0x8F, 0x61, 0x56, 0xD8, 0x06},
+        },
+        {
+            {0x3A, 0xC8, 0x65, 0xC7, 0xB1, 0x03, 0x05, 0x22, 0x4F, 0x00, 0x50, 0x53, 0x2D, 0xA2, 0x2E, 0x60},
+            {0x38, 0x96, 0x27, 0xF5, 0xB3, 0xFC, 0x43, 0x1B, 0x75, 0x80, 0xA8, 0xBF, 0x71, 0xAB, 0xE5, 0x9B},
+            {0x02, 0x03, 0xB7, 0x7F, 0x3A, 0x95, 0xE9, 0xEE, 0xEA, 0xC2, 0x2D, 0x2B, 0x2C, 0x22, 0xC6, 0xD0},
+        },
+        {
+            {0x64, 0xB1, 0x13, 0x00, 0xEF, 0x48, 0x7F, 0x94, 0x35, 0xB5, 0xAF, 0x0E, 0x03, 0x7D, 0xFA, 0xCF},
+            {0x11, 0x81, 0xF0, 0xE2, 0x34, 0xE5, 0xED, 0x69, 0x31, 0xEF, 0xE9, 0x87, 0x81, 0x81, 0x3D, 0xCA},
+            {0xE9, 0x3D, 0xC2, 0xC0, 0x88, 0x09, 0x11, 0xE9, 0xE3, 0x0E, 0x2C, 0xD0, 0x56, 0x66, 0xC2, 0xC5},
+        },
+    }},
+    {KDFDomain_HDR, 1ULL, {
+        {
+            {0xE4, 0xCE, 0x38, 0x3F, 0x0D, 0xE3, 0xAD, 0xA3, 0xF1, 0x64, 0x04, 0xED, 0x7D, 0xF4, 0x3A, 0xA5},
+            {0xEB, 0xAD, 0xCD, 0xF3, 0x0E, 0x2C, 0x8E, 0x7C, 0x1C, 0xC5, 0x74, 0xD7, 0xEB, 0xE7, 0x0B, 0x7D},
+            {0xB8, 0xF3, 0x01, 0x4D, 0x8A, 0xC5, 0x1D, 0x30, 0x16, 0x9B, 0xD5, 0x7D, 0x46, 0xF4, 0x46, 0x09},
+        },
+        {
+            {0x37, 0x11, 0x98, 0x17, 0x51, 0x4F, 0xF8, 0x4F, 0xA4, 0xB0, 0xC9, 0x85, 0x04, 0x74, 0x27, 0x24},
+            {0xC4, 0x97, 0x04, 0x82, 0xA2, 0x5B, 0x24, 0xBF, 0xBD, 0x20, 0xBF, 0xCF, 0xD3, 0x58, 0x81, 0x36},
+            {0x87, 0x29, 0xE7, 0x60, 0x14, 0x34, 0xB9, 0x67, 0xA3, 0x76, 0x90, 0xDB, 0xBA, 0x73, 0x0B, 0x78},
+        },
+        {
+            {0x13, 0xE6, 0x57, 0xA9, 0x1D, 0xE4, 0xBB, 0x28, 0xD2, 0x4D, 0xB3, 0xEE, 0xB9, 0xEE, 0x91, 0x9D},
+            {0xFE, 0xBF, 0xED, 0xDF, 0xE3, 0x7F, 0x0D, 0xBC, 0x3F, 0x0B, 0xF2, 0x46, 0xC3, 0xF9, 0x7C, 0x75},
+            {0x0D, 0x67, 0x13, 0xAD, 0xB6, 0xA2, 0xD0, 0x80, 0xC5, 0xF6, 0x9B, 0x68, 0xD3, 0xAB, 0x8C, 0xBE},
+        },
+        {
+            {0x98, 0x6E, 0x1B, 0x17, 0x51, 0x7F, 0x79, 0x88, 0x31, 0x4F, 0xF5, 0xEC, 0x9D, 0x7A, 0x63, 0xF2},
+            {0xFB, 0x81, 0x8A, 0xB3, 0x0D, 0x65, 0xD3, 0x63, 0xB8, 0x78, 0x95, 0x91, 0xBF, 0x5F, 0xFD, 0xD3},
+            {0xB3, 0x66, 0xBB, 0x32, 0x27, 0xFB, 0x14, 0x18, 0xAA, 0xAD, 0x57, 0xB7, 0x0A, 0xEC, 0x00, 0x3F},
+        },
+    }},
+    {KDFDomain_CHK, 0x100000002ULL, {
+        {
+            {0xCC, 0x45, 0x42, 0xC6, 0xF3, 0xCD, 0x81, 0x15, 0x5E, 0xE2, 0x41, 0x38, 0x50, 0xB6, 0xAF, 0x01},
+            {0xA4, 0x42, 0xD4, 0x4F, 0xE4, 0x28, 0xFB, 0x55, 0xA8, 0x20, 0xBA, 0xEF, 0x96, 0x18, 0xF9, 0x86},
+            {0x19, 0x93, 0x39, 0x50, 0x9C, 0xAF, 0xF4, 0x5A, 0xE6, 0x22, 0x07, 0xBB, 0x3F, 0xEC, 0xCF, 0x55},
+        },
+        {
+            {0x5C, 0xD6, 0x18, 0xDA, 0x05, 0x9F, 0x3A, 0x39, 0xFA, 0x5A, 0xD4, 0x94, 0x77, 0xD8, 0xB6, 0xC8},
+            {0xDE, 0xC6, 0x12, 0xF1, 0x9E, 0xA7, 0x2F, 0x21, 0xFE, 0x60, 0x18, 0x82, 0x14, 0x90, 0x79, 0x7C},
+            {0x7A, 0x7A, 0xF6, 0xD5, 0x48, 0x2B, 0xCF, 0x75, 0x71, 0xA5, 0xF8, 0x1A, 0xBC, 0x25, 0x37, 0x59},
+        },
+        {
+            {0xD7, 0x26, 0xDA, 0xCD, 0x45, 0x03, 0xB9, 0xA3, 0xA8, 0xFB, 0x1F, 0x50, 0xF0, 0x4F, 0xB0, 0x37},
+            {0x6B, 0x8D, 0xBD, 0x73, 0x8B, 0x16, 0x2D, 0x1B, 0xAB, 0xC2, 0xD5, 0x8F, 0xFF, 0x7E, 0x8D, 0xC5},
+            {0x0D, 0x9F, 0xB9, 0xBF, 0xB0, 0x2E, 0x86, 0x18, 0x6B, 0x0D, 0xC4, 0x86, 0x5D, 0xA5, 0xEA, 0xDE},
+        },
+        {
+            {0xD5, 0x19, 0xA0, 0x36, 0xA4, 0xF8, 0x90, 0x9D, 0xEA, 0x75, 0x93, 0xDB, 0x29, 0x73, 0x2F, 0x62},
+            {0x1F, 0x88, 0xF7, 0xDF, 0x89, 0x05, 0x19, 0x81, 0xB5, 0x67, 0x55, 0x5F, 0x7A, 0xA6, 0x4D, 0x48},
+            {0xC8, 0x8C, 0x34, 0x22, 0xC2, 0xDA, 0x90, 0xFD, 0x7E, 0x80, 0xA6, 0x9B, 0xD6, 0xD8, 0xAA, 0x5D},
+        },
+    }},
+};
+
+
+static void check_reduced32_vectors(const DeriveFunc32 derive_fn) {
+    uint32_t key[8] = {}, nonce[8] = {}, context[16] = {};
+    uint32_t init_state[16], knc[16];
+    blake32_clean_digest_context(init_state, key, context);
+    blake32_clean_compute_knc(key, nonce, knc);
+
+    for (const auto &vector : reduced32_vectors) {
+        uint8_t keys[2][vector_key_count][16];
+        derive_fn(init_state, knc, vector_key_count, vector.counter, vector.domain, keys[0], keys[1]);
+        for (size_t s = 0; s < 2; s++) {
+            for (size_t i = 0; i < 3; i++) {
+                REQUIRE(memcmp(keys[s][vector_rounds[i]], vector.keys[s][i], 16) == 0);
+            }
+        }
+    }
+}
+
+
+static void check_reduced64_vectors(const DeriveFunc64 derive_fn) {
+    uint64_t key[8] = {}, nonce[8] = {}, context[16] = {};
+    uint64_t init_state[16], knc[16];
+    blake64_clean_digest_context(init_state, key, context);
+    blake64_clean_compute_knc(key, nonce, knc);
+
+    for (const auto &vector : reduced64_vectors) {
+        uint8_t keys[4][vector_key_count][16];
+        derive_fn(init_state, knc, vector_key_count, vector.counter, vector.domain, keys[0], keys[1], keys[2], keys[3]);
+        for (size_t s = 0; s < 4; s++) {
+            for (size_t i = 0; i < 3; i++) {
+                REQUIRE(memcmp(keys[s][vector_rounds[i]], vector.keys[s][i], 16) == 0);
+            }
+        }
+    }
+}
+
+
+// Compares a derive_keys_many_reduced kernel with consecutive calls of the reference,
+// for odd and even key counts and counters straddling a 32-bit boundary.
+template <typename Word, typename DeriveManyFn, typename DeriveFn>
+static void check_reduced_many(const DeriveManyFn derive_many_fn, const DeriveFn derive_fn, const size_t streams) {
+    for (const uint8_t key_count : {uint8_t(11), uint8_t(10), uint8_t(1)}) {
+        for (const uint64_t first_counter : {0ull, 0xFFFFFFFDull}) {
+            Word init_state[16], knc[16];
+            csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+            csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+
+            constexpr size_t max_counters = 9;
+            const size_t keys_per_counter = streams * key_count;
+            std::vector<uint8_t> expected(max_counters * keys_per_counter * 16);
+            auto *expected_keys = reinterpret_cast<uint8_t(*)[16]>(expected.data());
+            for (size_t i = 0; i < max_counters; i++) {
+                derive_fn(init_state, knc, key_count, first_counter + i, &expected_keys[i * keys_per_counter]);
+            }
+
+            for (size_t n = 0; n <= max_counters; n++) {
+                std::vector<uint8_t> actual((n * keys_per_counter + 1) * 16, 0xA5);
+                derive_many_fn(
+                    init_state, knc, key_count, first_counter, n, KDFDomain_HDR,
+                    reinterpret_cast<uint8_t(*)[16]>(actual.data())
+                );
+                const size_t key_bytes = n * keys_per_counter * 16;
+                REQUIRE(memcmp(actual.data(), expected.data(), key_bytes) == 0);
+                REQUIRE(actual[key_bytes] == 0xA5);
+            }
+        }
+    }
+}
+
+
+static void reference32(
+        const uint32_t init_state[16],
+        const uint32_t knc[16],
+        const uint8_t key_count,
+        const uint64_t counter,
+        uint8_t keys[][16]
+) {
+    blake32_clean_derive_keys_reduced(init_state, knc, key_count, counter, KDFDomain_HDR, &keys[0], &keys[key_count]);
+}
+
+
+static void reference64(
+        const uint64_t init_state[16],
+        const uint64_t knc[16],
+        const uint8_t key_count,
+        const uint64_t counter,
+        uint8_t keys[][16]
+) {
+    blake64_clean_derive_keys_reduced(
+        init_state, knc, key_count, counter, KDFDomain_HDR,
+        &keys[0], &keys[key_count], &keys[2 * key_count], &keys[3 * key_count]
+    );
+}
+
+
+TEST_CASE("Blake32 clean reduced derive_keys matches Python test vectors", "[unittest][keygen]") {
+    check_reduced32_vectors(blake32_clean_derive_keys_reduced);
+}
+
+
+TEST_CASE("Blake64 clean reduced derive_keys matches Python test vectors", "[unittest][keygen]") {
+    check_reduced64_vectors(blake64_clean_derive_keys_reduced);
+}
+
+
+TEST_CASE("Blake32 optimized reduced derive_keys matches Python test vectors", "[unittest][keygen]") {
+    check_reduced32_vectors(blake32_optimized_derive_keys_reduced);
+}
+
+
+TEST_CASE("Blake64 optimized reduced derive_keys matches Python test vectors", "[unittest][keygen]") {
+    check_reduced64_vectors(blake64_optimized_derive_keys_reduced);
+}
+
+
+TEST_CASE("Blake32 dispatched reduced derive_keys_many matches the reference", "[unittest][keygen]") {
+    check_reduced_many<uint32_t>(blake32_derive_keys_many_reduced, reference32, 2);
+}
+
+
+TEST_CASE("Blake64 dispatched reduced derive_keys_many matches the reference", "[unittest][keygen]") {
+    check_reduced_many<uint64_t>(blake64_derive_keys_many_reduced, reference64, 4);
+}
+
+#if defined(BLAKE_ARCH_X86)
+
+TEST_CASE("Blake32 AVX2 reduced derive_keys_many matches the reference", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    check_reduced_many<uint32_t>(blake32_avx2_derive_keys_many_reduced, reference32, 2);
+}
+
+
+TEST_CASE("Blake64 AVX2 reduced derive_keys_many matches the reference", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    check_reduced_many<uint64_t>(blake64_avx2_derive_keys_many_reduced, reference64, 4);
+}
+
+#endif
+
+
+TEST_CASE("Reduced profile keys differ from the standard profile", "[unittest][keygen]") {
+    uint32_t init_state[16], knc[16];
+    csprng_read_array(reinterpret_cast<uint8_t*>(init_state), sizeof(init_state));
+    csprng_read_array(reinterpret_cast<uint8_t*>(knc), sizeof(knc));
+
+    uint8_t standard[2][vector_key_count][16], reduced[2][vector_key_count][16];
+    blake32_clean_derive_keys(init_state, knc, vector_key_count, 5, KDFDomain_MSG, standard[0], standard[1]);
+    blake32_clean_derive_keys_reduced(init_state, knc, vector_key_count, 5, KDFDomain_MSG, reduced[0], reduced[1]);
+    for (size_t s = 0; s < 2; s++) {
+        for (size_t i = 0; i < vector_key_count; i++) {
+            for (size_t j = 0; j < vector_key_count; j++) {
+                REQUIRE(memcmp(standard[s][i], reduced[s][j], 16) != 0);
+            }
+        }
+    }
+}
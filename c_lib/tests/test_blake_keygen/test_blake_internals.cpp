@@ -60,4 +60,61 @@ TEST_CASE("Blake32 digest_context matches Python test vectors", "[unittest][keyg
 TEST_CASE("Blake64 digest_context matches Python test vectors", "[unittest][keygen]") {
     run_blake64_digest_context_test(blake64_clean_digest_context);
     run_blake64_digest_context_test(blake64_optimized_digest_context);
-}
\ No newline at end of file
+}
+
+#if defined(BLAKE_ARCH_X86)
+
+TEST_CASE("Blake32 SSE4.1 permute and mix_state match Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_sse41()) {
+        SKIP("SSE4.1 is not supported by this CPU");
+    }
+    run_blake32_permutation_test(blake32_sse41_permute);
+    run_blake32_mix_state_test(blake32_sse41_mix_state);
+}
+TEST_CASE("Blake32 SSE4.1 digest_context matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_sse41()) {
+        SKIP("SSE4.1 is not supported by this CPU");
+    }
+    run_blake32_digest_context_test(blake32_sse41_digest_context);
+}
+TEST_CASE("Blake64 AVX2 permute and mix_state match Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake64_permutation_test(blake64_avx2_permute);
+    run_blake64_mix_state_test(blake64_avx2_mix_state);
+}
+TEST_CASE("Blake64 AVX2 digest_context matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx2()) {
+        SKIP("AVX2 is not supported by this CPU");
+    }
+    run_blake64_digest_context_test(blake64_avx2_digest_context);
+}
+TEST_CASE("Blake64 AVX-512VL permute and mix_state match Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512vl()) {
+        SKIP("AVX-512VL is not supported by this CPU");
+    }
+    run_blake64_permutation_test(blake64_avx512_permute);
+    run_blake64_mix_state_test(blake64_avx512_mix_state);
+}
+TEST_CASE("Blake64 AVX-512VL digest_context matches Python test vectors", "[unittest][keygen]") {
+    if (!blake_cpu_has_avx512vl()) {
+        SKIP("AVX-512VL is not supported by this CPU");
+    }
+    run_blake64_digest_context_test(blake64_avx512_digest_context);
+}
+
+#endif
+
+
+#if defined(BLAKE_ARCH_ARM64)
+
+TEST_CASE("Blake32 NEON permute and mix_state match Python test vectors", "[unittest][keygen]") {
+    run_blake32_permutation_test(blake32_neon_permute);
+    run_blake32_mix_state_test(blake32_neon_mix_state);
+}
+TEST_CASE("Blake32 NEON digest_context matches Python test vectors", "[unittest][keygen]") {
+    run_blake32_digest_context_test(blake32_neon_digest_context);
+}
+
+#endif
@@ -14,7 +14,17 @@
 #include <vector>
 #include <cstddef>
 #include <array>
+#include <set>
+#include <thread>
+#include <algorithm>
+#include <cstring>
 #include "csprng.h"
+#include "csprng_internals.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 
 // Helper function to read csprng samples only once
@@ -122,3 +132,172 @@ TEST_CASE("CSPRNG generated data passes Maurer's universal statistical test", "[
     INFO("Maurer fn: " << fn << ", p-value: " << p_value);
     REQUIRE(p_value > MIN_P_VALUE);
 }
+
+
+TEST_CASE("CSPRNG serves unique nonces across buffer refills", "[unittest][csprng]") {
+    // 32-byte draws do not divide the buffer size, so some nonces straddle two refills
+    constexpr int N_NONCES = 20000;
+    std::set<std::array<uint8_t, 32>> nonces;
+    for (int i = 0; i < N_NONCES; ++i) {
+        std::array<uint8_t, 32> nonce{};
+        csprng_fill(nonce.data(), i % 2 == 0 ? nonce.size() : nonce.size() - 7);
+        nonces.insert(nonce);
+    }
+    REQUIRE(nonces.size() == N_NONCES);
+
+    std::vector<uint8_t> bulk(3 * 1024 * 1024 + 5, 0);
+    csprng_fill(bulk.data(), bulk.size());
+    REQUIRE(std::count(bulk.end() - 64, bulk.end(), 0) < 8);
+}
+
+
+TEST_CASE("CSPRNG threads and reseeds draw independent streams", "[unittest][csprng]") {
+    std::array<uint8_t, 32> a{}, b{}, c{};
+    std::thread worker([&b]() { csprng_fill(b.data(), b.size()); });
+    csprng_fill(a.data(), a.size());
+    worker.join();
+    csprng_reseed();
+    csprng_fill(c.data(), c.size());
+    REQUIRE(a != b);
+    REQUIRE(a != c);
+    REQUIRE(b != c);
+}
+
+
+
+static std::array<uint8_t, 32> rfc8439_key() {
+    std::array<uint8_t, 32> key{};
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>(i);
+    }
+    return key;
+}
+
+
+TEST_CASE("CSPRNG ChaCha20 core matches the RFC 8439 block function vector", "[unittest][csprng]") {
+    // RFC 8439 section 2.3.2
+    constexpr uint8_t nonce[12] = {0, 0, 0, 0x09, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+    constexpr uint8_t expected[64] = {
+        0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4,
+        0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0, 0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e,
+        0xd2, 0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2,
+        0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8, 0xa2, 0x50, 0x3c, 0x4e,
+    };
+    const auto key = rfc8439_key();
+    uint8_t block[64];
+    csprng_chacha20_keystream(block, 1, key.data(), nonce, 1);
+    REQUIRE(std::memcmp(block, expected, sizeof(expected)) == 0);
+}
+
+
+TEST_CASE("CSPRNG ChaCha20 core matches the RFC 8439 encryption vector", "[unittest][csprng]") {
+    // RFC 8439 section 2.4.2
+    constexpr uint8_t nonce[12] = {0, 0, 0, 0, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+    constexpr char plaintext[] =
+        "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, "
+        "sunscreen would be it.";
+    constexpr uint8_t expected[114] = {
+        0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81,
+        0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b,
+        0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+        0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8,
+        0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e,
+        0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+        0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42,
+        0x87, 0x4d,
+    };
+    static_assert(sizeof(plaintext) - 1 == sizeof(expected));
+    const auto key = rfc8439_key();
+    uint8_t keystream[2 * 64];
+    csprng_chacha20_keystream(keystream, 2, key.data(), nonce, 1);
+    uint8_t ciphertext[sizeof(expected)];
+    for (std::size_t i = 0; i < sizeof(expected); ++i) {
+        ciphertext[i] = static_cast<uint8_t>(plaintext[i]) ^ keystream[i];
+    }
+    REQUIRE(std::memcmp(ciphertext, expected, sizeof(expected)) == 0);
+
+    // Every block of a long run, full lane groups and the tail alike, is its own counter
+    constexpr std::size_t n_blocks = 11;
+    uint8_t run[n_blocks * 64];
+    csprng_chacha20_keystream(run, n_blocks, key.data(), nonce, 0xFFFFFFFCu);
+    for (std::size_t i = 0; i < n_blocks; ++i) {
+        uint8_t single[64];
+        const uint32_t counter = static_cast<uint32_t>(0xFFFFFFFCu + i);
+        uint8_t carried_nonce[12];
+        std::memcpy(carried_nonce, nonce, sizeof(nonce));
+        carried_nonce[0] = static_cast<uint8_t>(i >= 4);
+        csprng_chacha20_keystream(single, 1, key.data(), carried_nonce, counter);
+        REQUIRE(std::memcmp(run + 64 * i, single, 64) == 0);
+    }
+}
+
+
+TEST_CASE("CSPRNG output is the ChaCha20 keystream of its key after fast key erasure", "[unittest][csprng]") {
+    // RFC 8439 appendix A.1 vectors 1 and 2: zero key and nonce, block counters 0 and 1
+    constexpr uint8_t block0[64] = {
+        0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90, 0x40, 0x5d, 0x6a, 0xe5, 0x53, 0x86, 0xbd, 0x28,
+        0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d, 0xed, 0x1a, 0xa8, 0x36, 0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7,
+        0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37,
+        0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+    };
+    constexpr uint8_t block1[64] = {
+        0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d,
+        0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3, 0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed,
+        0x29, 0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0, 0x74, 0xd8, 0x39, 0xd5,
+        0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb, 0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f,
+    };
+    constexpr uint8_t zero[32] = {};
+    constexpr std::size_t refill_bytes = 16 * 64;
+    csprng_seed_deterministic(zero);
+
+    // The first 32 bytes of a refill become the next key, the rest is served in order
+    std::vector<uint8_t> served(2 * (refill_bytes - 32));
+    csprng_fill(served.data(), served.size());
+    REQUIRE(std::memcmp(served.data(), block0 + 32, 32) == 0);
+    REQUIRE(std::memcmp(served.data() + 32, block1, 64) == 0);
+
+    const uint8_t nonce[12] = {};
+    std::vector<uint8_t> expected(2 * refill_bytes);
+    csprng_chacha20_keystream(expected.data(), 16, zero, nonce, 0);
+    csprng_chacha20_keystream(expected.data() + refill_bytes, 16, block0, nonce, 0);
+    REQUIRE(std::equal(served.begin(), served.begin() + refill_bytes - 32, expected.begin() + 32));
+    REQUIRE(std::equal(served.begin() + refill_bytes - 32, served.end(), expected.begin() + refill_bytes + 32));
+
+    // Seeding again restarts the same stream, reseeding leaves it
+    std::array<uint8_t, 32> again{}, fresh{};
+    csprng_seed_deterministic(zero);
+    csprng_fill(again.data(), again.size());
+    REQUIRE(std::memcmp(again.data(), block0 + 32, 32) == 0);
+    csprng_reseed();
+    csprng_fill(fresh.data(), fresh.size());
+    REQUIRE(fresh != again);
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+TEST_CASE("CSPRNG reseeds in the child after fork", "[unittest][csprng]") {
+    // Buffered output exists before the fork, the child must not repeat it
+    std::array<uint8_t, 32> warmup{};
+    csprng_fill(warmup.data(), warmup.size());
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        uint8_t child[32];
+        csprng_fill(child, sizeof(child));
+        const ssize_t written = write(fds[1], child, sizeof(child));
+        _exit(written == sizeof(child) ? 0 : 1);
+    }
+    std::array<uint8_t, 32> parent{}, child{};
+    csprng_fill(parent.data(), parent.size());
+    REQUIRE(read(fds[0], child.data(), child.size()) == static_cast<ssize_t>(child.size()));
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    close(fds[1]);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE(parent != child);
+}
+#endif
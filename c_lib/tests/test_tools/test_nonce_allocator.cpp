@@ -0,0 +1,118 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <catch2/catch_all.hpp>
+#include <array>
+#include <set>
+#include <thread>
+#include <vector>
+#include "nonce_allocator.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using Nonce = std::array<uint8_t, 32>;
+
+
+TEST_CASE("Nonce allocator rejects unsupported nonce lengths", "[unittest][nonce]") {
+    REQUIRE(nonce_allocator_create(NONCE_ALLOCATOR_MIN_BYTES - 1, NonceMode_COUNTER) == nullptr);
+    REQUIRE(nonce_allocator_create(NONCE_ALLOCATOR_MAX_BYTES + 1, NonceMode_COUNTER) == nullptr);
+
+    NonceAllocator *allocator = nonce_allocator_create(NONCE_ALLOCATOR_MAX_BYTES, NonceMode_COUNTER);
+    REQUIRE(allocator != nullptr);
+    nonce_allocator_destroy(allocator);
+}
+
+
+TEST_CASE("Nonce allocator counter nonces share a prefix and never repeat", "[unittest][nonce]") {
+    NonceAllocator *allocator = nonce_allocator_create(32, NonceMode_COUNTER);
+    NonceLease lease;
+    nonce_lease_init(&lease, allocator);
+
+    Nonce first{}, second{};
+    REQUIRE(nonce_lease_next(&lease, first.data()) == 0);
+    REQUIRE(nonce_lease_next(&lease, second.data()) == 0);
+    REQUIRE(std::equal(first.begin(), first.begin() + 24, second.begin()));
+    REQUIRE(first[31] + 1 == second[31]);
+
+    // Two leases of one allocator hold disjoint ranges
+    NonceLease other;
+    nonce_lease_init(&other, allocator);
+    Nonce third{};
+    REQUIRE(nonce_lease_next(&other, third.data()) == 0);
+    REQUIRE(third[30] == first[30] + NONCE_ALLOCATOR_RANGE / 256);
+    nonce_allocator_destroy(allocator);
+}
+
+
+TEST_CASE("Nonce allocator hands out unique nonces across threads", "[unittest][nonce]") {
+    constexpr int N_THREADS = 8;
+    constexpr int N_NONCES = 3 * NONCE_ALLOCATOR_RANGE + 17;
+
+    for (const NonceMode mode : {NonceMode_COUNTER, NonceMode_RANDOM}) {
+        NonceAllocator *allocator = nonce_allocator_create(32, mode);
+        std::vector<std::vector<Nonce>> drawn(N_THREADS, std::vector<Nonce>(N_NONCES));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < N_THREADS; t++) {
+            threads.emplace_back([allocator, &drawn, t]() {
+                for (auto &nonce : drawn[t]) {
+                    nonce_allocator_next(allocator, nonce.data());
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        std::set<Nonce> unique;
+        for (const auto &nonces : drawn) {
+            unique.insert(nonces.begin(), nonces.end());
+        }
+        REQUIRE(unique.size() == static_cast<size_t>(N_THREADS * N_NONCES));
+        nonce_allocator_destroy(allocator);
+    }
+}
+
+
+#if !defined(_WIN32) && !defined(_WIN64)
+TEST_CASE("Nonce allocator gives a forked child its own prefix", "[unittest][nonce]") {
+    NonceAllocator *allocator = nonce_allocator_create(32, NonceMode_COUNTER);
+    NonceLease lease;
+    nonce_lease_init(&lease, allocator);
+    Nonce warmup{};
+    REQUIRE(nonce_lease_next(&lease, warmup.data()) == 0);
+
+    // Without fork handling the child would continue the parent's reserved range
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        Nonce child{};
+        const int status = nonce_lease_next(&lease, child.data());
+        const ssize_t written = write(fds[1], child.data(), child.size());
+        _exit(status == 0 && written == static_cast<ssize_t>(child.size()) ? 0 : 1);
+    }
+    Nonce parent{}, child{};
+    REQUIRE(nonce_lease_next(&lease, parent.data()) == 0);
+    REQUIRE(read(fds[0], child.data(), child.size()) == static_cast<ssize_t>(child.size()));
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    close(fds[1]);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE_FALSE(std::equal(parent.begin(), parent.begin() + 24, child.begin()));
+    nonce_allocator_destroy(allocator);
+}
+#endif
@@ -12,15 +12,35 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include "csprng.h"
+#include "csprng_internals.h"
+
+#if defined(_MSC_VER)
+#define CSPRNG_THREAD_LOCAL __declspec(thread)
+#else
+#define CSPRNG_THREAD_LOCAL _Thread_local
+#endif
+
+#define CHACHA_BLOCK_BYTES 64
+#define CSPRNG_KEY_BYTES 32
+#define CSPRNG_BUFFER_BLOCKS 16
+#define CSPRNG_BUFFER_BYTES (CSPRNG_BUFFER_BLOCKS * CHACHA_BLOCK_BYTES)
+
+/* Refills between reseeds from the operating system, 1 MiB of output. */
+#define CSPRNG_RESEED_REFILLS 1024
 
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 #include <wincrypt.h>
 
-void csprng_read_array(uint8_t* buffer, const uint32_t length) {
+/*
+ * Reads `length` bytes from the system RNG, used only to seed the generator.
+ */
+static void system_random(uint8_t* buffer, const size_t length) {
     const NTSTATUS status = BCryptGenRandom(
-        NULL, buffer, length, BCRYPT_USE_SYSTEM_PREFERRED_RNG
+        NULL, buffer, (ULONG)length, BCRYPT_USE_SYSTEM_PREFERRED_RNG
     );
     if (status != 0) {
         fprintf(stderr, "BCryptGenRandom failed: 0x%lx\n", status);
@@ -28,34 +48,399 @@ void csprng_read_array(uint8_t* buffer, const uint32_t length) {
     }
 }
 
-uint8_t csprng_read(void) {
-    uint8_t value;
-    csprng_read_array(&value, 1);
-    return value;
+static unsigned fork_generation(void) {
+    return 0;
 }
 
 #else
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 
-void csprng_read_array(uint8_t* buffer, const uint32_t length) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#include <sys/random.h>
+#define CSPRNG_HAS_GETRANDOM
+#endif
+
+/*
+ * Reads `length` bytes from the system RNG, used only to seed the generator.
+ * getrandom() needs no file descriptor, /dev/urandom is the fallback where it
+ * is missing or not supported by the kernel.
+ */
+static void system_random(uint8_t* buffer, const size_t length) {
+#if defined(CSPRNG_HAS_GETRANDOM)
+    size_t offset = 0;
+    while (offset < length) {
+        const ssize_t ret = getrandom(buffer + offset, length - offset, 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            break;
+        }
+        offset += (size_t)ret;
+    }
+    if (offset == length) {
+        return;
+    }
+#endif
     const int fd = open("/dev/urandom", O_RDONLY);
     if (fd < 0) {
         perror("Failed to open /dev/urandom");
         exit(EXIT_FAILURE);
     }
-    const ssize_t ret = read(fd, buffer, length);
+    size_t done = 0;
+    while (done < length) {
+        const ssize_t ret = read(fd, buffer + done, length - done);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            close(fd);
+            perror("Failed to read /dev/urandom");
+            exit(EXIT_FAILURE);
+        }
+        done += (size_t)ret;
+    }
     close(fd);
-    if (ret != length) {
-        perror("Failed to read /dev/urandom");
-        exit(EXIT_FAILURE);
+}
+
+
+/*
+ * Bumped in the child after every fork. A child starts with a copy of the
+ * forking thread's generator, so it must never serve bytes from that copy.
+ * Only the child handler writes it, while the child is still single-threaded.
+ */
+static volatile unsigned fork_counter = 0;
+static pthread_once_t fork_handler_once = PTHREAD_ONCE_INIT;
+
+static void on_fork_child(void) {
+    fork_counter += 1;
+}
+
+static void register_fork_handler(void) {
+    pthread_atfork(NULL, NULL, on_fork_child);
+}
+
+static unsigned fork_generation(void) {
+    return fork_counter;
+}
+
+#endif
+
+
+/*
+ * Per-thread ChaCha20 generator with fast key erasure: every refill expands the
+ * key into CSPRNG_BUFFER_BLOCKS blocks, the first 32 bytes replace the key and
+ * the rest are served. Served bytes are zeroed in the buffer, so a later state
+ * compromise does not reveal earlier output.
+ */
+typedef struct {
+    uint32_t key[8];
+    uint8_t buffer[CSPRNG_BUFFER_BYTES];
+    size_t available;
+    uint32_t refills;
+    unsigned fork_generation;
+    int seeded;
+} CsprngState;
+
+static CSPRNG_THREAD_LOCAL CsprngState thread_state;
+
+
+/*
+ * Zeroes a buffer through a volatile pointer, so that the wipe of a local
+ * that is dead afterwards is not optimized away as a plain memset can be.
+ */
+static void wipe(void *buffer, const size_t length) {
+    volatile uint8_t *p = buffer;
+    for (size_t i = 0; i < length; i++) {
+        p[i] = 0;
     }
 }
 
+
+static uint32_t load32_le(const uint8_t bytes[4]) {
+    return (uint32_t)bytes[0]
+        | (uint32_t)bytes[1] << 8
+        | (uint32_t)bytes[2] << 16
+        | (uint32_t)bytes[3] << 24;
+}
+
+
+static void store32_le(uint8_t bytes[4], const uint32_t word) {
+    bytes[0] = (uint8_t)word;
+    bytes[1] = (uint8_t)(word >> 8);
+    bytes[2] = (uint8_t)(word >> 16);
+    bytes[3] = (uint8_t)(word >> 24);
+}
+
+
+/*
+ * RFC 8439 ChaCha20 block function. The generator runs it with a 64-bit block
+ * counter in words 12-13 and a zero nonce in words 14-15, each key is used for
+ * one refill only. With GCC and Clang four consecutive blocks are computed at
+ * once: lane `i` of every state vector belongs to block `counter + i`, and the
+ * compiler maps the vectors onto SSE2 or NEON registers.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint32_t chacha_vec __attribute__((vector_size(16)));
+
+#define CHACHA_LANES 4
+
+static inline chacha_vec rotl32x4(const chacha_vec x, const int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+
+#define QUARTER_ROUND_X4(a, b, c, d)           \
+    a += b; d = rotl32x4(d ^ a, 16);           \
+    c += d; b = rotl32x4(b ^ c, 12);           \
+    a += b; d = rotl32x4(d ^ a, 8);            \
+    c += d; b = rotl32x4(b ^ c, 7)
+
+
+static void chacha20_blocks_x4(
+        uint8_t out[CHACHA_LANES * CHACHA_BLOCK_BYTES],
+        const uint32_t key[8],
+        const uint64_t counter,
+        const uint32_t nonce[2]
+) {
+    chacha_vec input[16];
+    chacha_vec x[16];
+    const uint32_t constants[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    for (int i = 0; i < 4; i++) {
+        input[i] = (chacha_vec){0} + constants[i];
+    }
+    for (int i = 0; i < 8; i++) {
+        input[4 + i] = (chacha_vec){0} + key[i];
+    }
+    for (int lane = 0; lane < CHACHA_LANES; lane++) {
+        input[12][lane] = (uint32_t)(counter + lane);
+        input[13][lane] = (uint32_t)((counter + lane) >> 32);
+    }
+    input[14] = (chacha_vec){0} + nonce[0];
+    input[15] = (chacha_vec){0} + nonce[1];
+    memcpy(x, input, sizeof(x));
+
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND_X4(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND_X4(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND_X4(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND_X4(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND_X4(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND_X4(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND_X4(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND_X4(x[3], x[4], x[9], x[14]);
+    }
+    uint32_t words[16][CHACHA_LANES];
+    for (int i = 0; i < 16; i++) {
+        x[i] += input[i];
+        memcpy(words[i], &x[i], sizeof(chacha_vec));
+    }
+    for (int lane = 0; lane < CHACHA_LANES; lane++) {
+        for (int i = 0; i < 16; i++) {
+            store32_le(out + lane * CHACHA_BLOCK_BYTES + 4 * i, words[i][lane]);
+        }
+    }
+}
+
+
+static void chacha20_blocks(
+        uint8_t out[],
+        const uint32_t key[8],
+        const uint64_t counter,
+        const uint32_t nonce[2],
+        const size_t block_count
+) {
+    size_t i = 0;
+    for (; i + CHACHA_LANES <= block_count; i += CHACHA_LANES) {
+        chacha20_blocks_x4(out + i * CHACHA_BLOCK_BYTES, key, counter + i, nonce);
+    }
+    if (i < block_count) {
+        uint8_t tail[CHACHA_LANES * CHACHA_BLOCK_BYTES];
+        chacha20_blocks_x4(tail, key, counter + i, nonce);
+        memcpy(out + i * CHACHA_BLOCK_BYTES, tail, (block_count - i) * CHACHA_BLOCK_BYTES);
+        wipe(tail, sizeof(tail));
+    }
+}
+#else
+
+static uint32_t rotl32(const uint32_t x, const int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+
+#define QUARTER_ROUND(a, b, c, d)              \
+    a += b; d = rotl32(d ^ a, 16);             \
+    c += d; b = rotl32(b ^ c, 12);             \
+    a += b; d = rotl32(d ^ a, 8);              \
+    c += d; b = rotl32(b ^ c, 7)
+
+
+static void chacha20_block(
+        uint8_t out[CHACHA_BLOCK_BYTES],
+        const uint32_t key[8],
+        const uint64_t counter,
+        const uint32_t nonce[2]
+) {
+    const uint32_t input[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        key[0], key[1], key[2], key[3],
+        key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter >> 32), nonce[0], nonce[1]
+    };
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) {
+        store32_le(out + 4 * i, x[i] + input[i]);
+    }
+}
+
+
+static void chacha20_blocks(
+        uint8_t out[],
+        const uint32_t key[8],
+        const uint64_t counter,
+        const uint32_t nonce[2],
+        const size_t block_count
+) {
+    for (size_t i = 0; i < block_count; i++) {
+        chacha20_block(out + i * CHACHA_BLOCK_BYTES, key, counter + i, nonce);
+    }
+}
+#endif
+
+
+static void seed_key(CsprngState *state, const uint8_t seed[CSPRNG_KEY_BYTES]) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    pthread_once(&fork_handler_once, register_fork_handler);
+#endif
+    for (int i = 0; i < 8; i++) {
+        state->key[i] = load32_le(seed + 4 * i);
+    }
+    state->refills = 0;
+    state->fork_generation = fork_generation();
+    state->seeded = 1;
+}
+
+
+static void reseed(CsprngState *state) {
+    uint8_t seed[CSPRNG_KEY_BYTES];
+    system_random(seed, sizeof(seed));
+    seed_key(state, seed);
+    wipe(seed, sizeof(seed));
+}
+
+
+static void refill(CsprngState *state) {
+    if (!state->seeded || state->refills >= CSPRNG_RESEED_REFILLS) {
+        reseed(state);
+    }
+    const uint32_t zero_nonce[2] = {0, 0};
+    chacha20_blocks(state->buffer, state->key, 0, zero_nonce, CSPRNG_BUFFER_BLOCKS);
+    for (int i = 0; i < 8; i++) {
+        state->key[i] = load32_le(state->buffer + 4 * i);
+    }
+    memset(state->buffer, 0, CSPRNG_KEY_BYTES);
+    state->available = CSPRNG_BUFFER_BYTES - CSPRNG_KEY_BYTES;
+    state->refills += 1;
+}
+
+
+/*
+ * Fills `buffer` with `length` random bytes from the calling thread's generator.
+ * The system RNG is only read to seed each thread, after every 1 MiB of output
+ * and in the child after a fork, so small reads such as nonces cost no syscall.
+ */
+void csprng_fill(uint8_t* buffer, size_t length) {
+    CsprngState *state = &thread_state;
+    if (state->seeded && state->fork_generation != fork_generation()) {
+        state->seeded = 0;
+        state->available = 0;
+    }
+    while (length > 0) {
+        if (state->available == 0) {
+            refill(state);
+        }
+        uint8_t *source = state->buffer + CSPRNG_BUFFER_BYTES - state->available;
+        const size_t take = length < state->available ? length : state->available;
+        memcpy(buffer, source, take);
+        memset(source, 0, take);
+        state->available -= take;
+        buffer += take;
+        length -= take;
+    }
+}
+
+
+/*
+ * Drops the buffered output of the calling thread and reseeds it from the system RNG.
+ */
+void csprng_reseed(void) {
+    CsprngState *state = &thread_state;
+    memset(state->buffer, 0, sizeof(state->buffer));
+    state->available = 0;
+    reseed(state);
+}
+
+
+/*
+ * Drops the buffered output of the calling thread and seeds it with `key`
+ * instead of the system RNG. Its output is then fixed by `key` until the next
+ * reseed, which only known-answer tests of the generator may rely on.
+ */
+void csprng_seed_deterministic(const uint8_t key[CSPRNG_KEY_BYTES]) {
+    CsprngState *state = &thread_state;
+    memset(state->buffer, 0, sizeof(state->buffer));
+    state->available = 0;
+    seed_key(state, key);
+}
+
+
+void csprng_read_array(uint8_t* buffer, const uint32_t length) {
+    csprng_fill(buffer, length);
+}
+
+
 uint8_t csprng_read(void) {
     uint8_t value;
-    csprng_read_array(&value, 1);
+    csprng_fill(&value, 1);
     return value;
 }
 
-#endif
\ No newline at end of file
+
+/*
+ * Writes `block_count` blocks of the RFC 8439 ChaCha20 keystream for `key`,
+ * `nonce` and the initial block `counter`, on the same block function the
+ * generator runs. It exists for known-answer checks of that core. The counter
+ * carries into the first nonce word like the 64-bit counter of the generator,
+ * where RFC 8439 leaves a wrapping 32-bit counter undefined.
+ */
+void csprng_chacha20_keystream(
+        uint8_t* output,
+        const size_t block_count,
+        const uint8_t key[32],
+        const uint8_t nonce[12],
+        const uint32_t counter
+) {
+    uint32_t key_words[8];
+    for (int i = 0; i < 8; i++) {
+        key_words[i] = load32_le(key + 4 * i);
+    }
+    const uint32_t nonce_words[2] = {load32_le(nonce + 4), load32_le(nonce + 8)};
+    const uint64_t block_counter = counter | (uint64_t)load32_le(nonce) << 32;
+    chacha20_blocks(output, key_words, block_counter, nonce_words, block_count);
+    wipe(key_words, sizeof(key_words));
+}
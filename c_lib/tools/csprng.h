@@ -14,12 +14,18 @@
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <cstddef>
 extern "C" {
 #else
 #include <stdint.h>
+#include <stddef.h>
 #endif
 
 
+    void csprng_fill(uint8_t* buffer, size_t length);
+
+    void csprng_reseed(void);
+
     void csprng_read_array(uint8_t* buffer, uint32_t length);
 
     uint8_t csprng_read(void);
@@ -0,0 +1,45 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CSPRNG_INTERNALS_H
+#define CSPRNG_INTERNALS_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    /*
+     * Known-answer hooks of the generator for its tests, not for callers that
+     * need random bytes. A deterministic seed makes the output predictable.
+     */
+
+    void csprng_seed_deterministic(const uint8_t key[32]);
+
+    void csprng_chacha20_keystream(
+        uint8_t* output,
+        size_t block_count,
+        const uint8_t key[32],
+        const uint8_t nonce[12],
+        uint32_t counter
+    );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CSPRNG_INTERNALS_H
@@ -0,0 +1,232 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "csprng.h"
+#include "nonce_allocator.h"
+
+#if defined(_MSC_VER)
+#define NONCE_THREAD_LOCAL __declspec(thread)
+#else
+#define NONCE_THREAD_LOCAL _Thread_local
+#endif
+
+#define COUNTER_BYTES 8
+
+
+/*
+ * Nonces of the counter mode are a random prefix followed by a big-endian
+ * 64-bit counter. Threads reserve NONCE_ALLOCATOR_RANGE counters at a time
+ * with one fetch-add, so the shared cache line is touched once per range.
+ * The epoch changes whenever the prefix does, which invalidates every lease
+ * taken under the old prefix.
+ */
+struct NonceAllocator {
+    _Atomic uint64_t next_counter;
+    _Atomic uint64_t epoch;
+    uint8_t prefix[NONCE_ALLOCATOR_MAX_BYTES - COUNTER_BYTES];
+    size_t nonce_bytes;
+    NonceMode mode;
+    struct NonceAllocator *prev;
+    struct NonceAllocator *next;
+};
+
+/* Epoch 0 is never assigned, so a fresh lease always reserves a range first. */
+static _Atomic uint64_t epoch_source = 0;
+static NONCE_THREAD_LOCAL NonceLease thread_lease;
+
+
+/*
+ * Draws a new prefix and epoch and restarts the counter.
+ */
+static void refresh_allocator(NonceAllocator *allocator) {
+    csprng_fill(allocator->prefix, allocator->nonce_bytes - COUNTER_BYTES);
+    atomic_store_explicit(&allocator->next_counter, 0, memory_order_relaxed);
+    const uint64_t epoch = atomic_fetch_add_explicit(&epoch_source, 1, memory_order_relaxed) + 1;
+    atomic_store_explicit(&allocator->epoch, epoch, memory_order_release);
+}
+
+
+#if defined(_WIN32) || defined(_WIN64)
+
+static void register_allocator(NonceAllocator *allocator) {
+    (void)allocator;
+}
+
+static void unregister_allocator(NonceAllocator *allocator) {
+    (void)allocator;
+}
+
+#else
+#include <pthread.h>
+
+/*
+ * Live allocators, so that the fork child handler can give each of them a
+ * new prefix. A forked child inherits the counters and the leases of the
+ * parent, and would otherwise hand out the nonces the parent is still using.
+ * The lock is held across fork, so the child sees a consistent list.
+ */
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t fork_handler_once = PTHREAD_ONCE_INIT;
+static NonceAllocator *registry = NULL;
+
+
+static void on_fork_prepare(void) {
+    pthread_mutex_lock(&registry_lock);
+}
+
+
+static void on_fork_parent(void) {
+    pthread_mutex_unlock(&registry_lock);
+}
+
+
+static void on_fork_child(void) {
+    csprng_reseed();
+    for (NonceAllocator *allocator = registry; allocator != NULL; allocator = allocator->next) {
+        refresh_allocator(allocator);
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+
+static void register_fork_handler(void) {
+    pthread_atfork(on_fork_prepare, on_fork_parent, on_fork_child);
+}
+
+
+static void register_allocator(NonceAllocator *allocator) {
+    pthread_once(&fork_handler_once, register_fork_handler);
+    pthread_mutex_lock(&registry_lock);
+    allocator->next = registry;
+    if (registry != NULL) {
+        registry->prev = allocator;
+    }
+    registry = allocator;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+
+static void unregister_allocator(NonceAllocator *allocator) {
+    pthread_mutex_lock(&registry_lock);
+    if (allocator->prev != NULL) {
+        allocator->prev->next = allocator->next;
+    } else {
+        registry = allocator->next;
+    }
+    if (allocator->next != NULL) {
+        allocator->next->prev = allocator->prev;
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+#endif
+
+
+/*
+ * Creates an allocator of `nonce_bytes` long nonces, between NONCE_ALLOCATOR_MIN_BYTES
+ * and NONCE_ALLOCATOR_MAX_BYTES. NonceMode_COUNTER never repeats a nonce within one
+ * allocator, NonceMode_RANDOM draws every nonce from the CSPRNG. Returns NULL on an
+ * unsupported length or when out of memory.
+ */
+NonceAllocator *nonce_allocator_create(const size_t nonce_bytes, const NonceMode mode) {
+    if (nonce_bytes < NONCE_ALLOCATOR_MIN_BYTES || nonce_bytes > NONCE_ALLOCATOR_MAX_BYTES) {
+        return NULL;
+    }
+    NonceAllocator *allocator = calloc(1, sizeof(NonceAllocator));
+    if (allocator == NULL) {
+        return NULL;
+    }
+    allocator->nonce_bytes = nonce_bytes;
+    allocator->mode = mode;
+    refresh_allocator(allocator);
+    register_allocator(allocator);
+    return allocator;
+}
+
+
+/*
+ * Destroys an allocator. No lease of it may be used afterwards.
+ */
+void nonce_allocator_destroy(NonceAllocator *allocator) {
+    if (allocator == NULL) {
+        return;
+    }
+    unregister_allocator(allocator);
+    free(allocator);
+}
+
+
+/*
+ * Prepares a lease, the per-thread handle that nonces are drawn through.
+ * A lease must only be used by one thread at a time.
+ */
+void nonce_lease_init(NonceLease *lease, NonceAllocator *allocator) {
+    lease->allocator = allocator;
+    lease->epoch = 0;
+    lease->next = 0;
+    lease->end = 0;
+}
+
+
+/*
+ * Writes the next nonce of the lease. A new counter range is reserved when the
+ * current one is used up or was taken before the prefix changed. Returns 0 on
+ * success and -1 when the 64-bit counter space of the allocator is exhausted.
+ */
+int nonce_lease_next(NonceLease *lease, uint8_t nonce[]) {
+    NonceAllocator *allocator = lease->allocator;
+    if (allocator->mode == NonceMode_RANDOM) {
+        csprng_fill(nonce, allocator->nonce_bytes);
+        return 0;
+    }
+
+    const uint64_t epoch = atomic_load_explicit(&allocator->epoch, memory_order_acquire);
+    if (lease->epoch != epoch || lease->next == lease->end) {
+        // Checked before and after the fetch-add, so the counter can never wrap around
+        const uint64_t last_start = UINT64_MAX - NONCE_ALLOCATOR_RANGE;
+        if (atomic_load_explicit(&allocator->next_counter, memory_order_relaxed) > last_start) {
+            return -1;
+        }
+        const uint64_t start = atomic_fetch_add_explicit(
+            &allocator->next_counter, NONCE_ALLOCATOR_RANGE, memory_order_relaxed
+        );
+        if (start > last_start) {
+            return -1;
+        }
+        lease->epoch = epoch;
+        lease->next = start;
+        lease->end = start + NONCE_ALLOCATOR_RANGE;
+    }
+
+    const size_t prefix_bytes = allocator->nonce_bytes - COUNTER_BYTES;
+    memcpy(nonce, allocator->prefix, prefix_bytes);
+    const uint64_t counter = lease->next++;
+    for (int i = 0; i < COUNTER_BYTES; i++) {
+        nonce[prefix_bytes + i] = (uint8_t)(counter >> (56 - 8 * i));
+    }
+    return 0;
+}
+
+
+/*
+ * Same as `nonce_lease_next`, through a lease kept by the calling thread. A
+ * thread that switches between allocators reserves a new range on each switch.
+ */
+int nonce_allocator_next(NonceAllocator *allocator, uint8_t nonce[]) {
+    if (thread_lease.allocator != allocator) {
+        nonce_lease_init(&thread_lease, allocator);
+    }
+    return nonce_lease_next(&thread_lease, nonce);
+}
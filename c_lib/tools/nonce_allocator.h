@@ -0,0 +1,60 @@
+/*
+ *   Apache License 2.0
+ *
+ *   Copyright (c) 2024, Mattias Aabmets
+ *
+ *   The contents of this file are subject to the terms and conditions defined in the License.
+ *   You may not use, modify, or distribute this file except in compliance with the License.
+ *
+ *   SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef NONCE_ALLOCATOR_H
+#define NONCE_ALLOCATOR_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+
+    #define NONCE_ALLOCATOR_MIN_BYTES   16
+    #define NONCE_ALLOCATOR_MAX_BYTES   64
+    #define NONCE_ALLOCATOR_RANGE       1024
+
+
+    typedef enum {
+        NonceMode_COUNTER = 0,
+        NonceMode_RANDOM = 1
+    } NonceMode;
+
+    typedef struct NonceAllocator NonceAllocator;
+
+    typedef struct {
+        NonceAllocator *allocator;
+        uint64_t epoch;
+        uint64_t next;
+        uint64_t end;
+    } NonceLease;
+
+
+    NonceAllocator *nonce_allocator_create(size_t nonce_bytes, NonceMode mode);
+
+    void nonce_allocator_destroy(NonceAllocator *allocator);
+
+    void nonce_lease_init(NonceLease *lease, NonceAllocator *allocator);
+
+    int nonce_lease_next(NonceLease *lease, uint8_t nonce[]);
+
+    int nonce_allocator_next(NonceAllocator *allocator, uint8_t nonce[]);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NONCE_ALLOCATOR_H
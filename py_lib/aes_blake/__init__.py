@@ -0,0 +1,21 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from aes_blake.aes_blake_pool import AESBlakePool
+from aes_blake.base_aes_blake import BaseAESBlake
+from aes_blake.native_aes_blake import AESBlake256, AESBlake512
+
+__all__ = [
+    "AESBlakePool",
+    "BaseAESBlake",
+    "AESBlake256",
+    "AESBlake512"
+]
@@ -0,0 +1,82 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from __future__ import annotations
+
+import threading
+import typing as t
+from contextlib import contextmanager
+
+from aes_blake.internal.bindings import ffi, lib
+
+__all__ = ["AESBlakePool"]
+
+
+class AESBlakePool:
+    """
+    Worker threads of the C engine that split one message over several cores.
+    A thread count of 0 starts one worker per CPU besides the calling thread.
+    A pool may be shared by many ciphers, calls on one pool run one at a time.
+    Python threads may close the pool while others run calls on it, closing
+    waits for the calls in flight to return and later calls raise ValueError.
+    """
+
+    def __init__(self, thread_count: int = 0) -> None:
+        if thread_count < 0:
+            raise ValueError("Thread count cannot be negative")
+        pool = lib.aes_blake_pool_create(thread_count)
+        if pool == ffi.NULL:
+            raise MemoryError("Failed to create the AES-Blake worker pool")
+        self._pool = ffi.gc(pool, lib.aes_blake_pool_destroy)
+        self._calls = 0
+        self._idle = threading.Condition()
+
+    @contextmanager
+    def handle(self) -> t.Iterator[t.Any]:
+        """
+        Yields the C pool for one call. The call counts as in flight until the
+        block exits, so that `close` cannot destroy the pool under it while the
+        GIL is released.
+        """
+        with self._idle:
+            if self._pool is None:
+                raise ValueError("The AES-Blake worker pool is closed")
+            self._calls += 1
+            pool = self._pool
+        try:
+            yield pool
+        finally:
+            with self._idle:
+                self._calls -= 1
+                if self._calls == 0:
+                    self._idle.notify_all()
+
+    @property
+    def thread_count(self) -> int:
+        with self.handle() as pool:
+            return lib.aes_blake_pool_thread_count(pool)
+
+    def close(self) -> None:
+        """
+        Joins the worker threads once the calls in flight have returned.
+        Ciphers using the pool raise ValueError afterwards.
+        """
+        with self._idle:
+            pool, self._pool = self._pool, None
+            self._idle.wait_for(lambda: self._calls == 0)
+        if pool is not None:
+            ffi.release(pool)
+
+    def __enter__(self) -> AESBlakePool:
+        return self
+
+    def __exit__(self, *_) -> None:
+        self.close()
@@ -0,0 +1,141 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from __future__ import annotations
+
+import typing as t
+
+from aes_blake.aes_blake_pool import AESBlakePool
+from aes_blake.internal.bindings import (Buffer, aligned_new, check_status, ffi, input_buffer,
+                                         output_buffer)
+
+__all__ = ["BaseAESBlake"]
+
+
+class BaseAESBlake:
+    """
+    AES-Blake cipher backed by the C engine, with the same interface as the
+    reference implementation. All buffers are passed to C without copying and
+    the GIL is released while a message is processed, so threads sharing one
+    cipher run in parallel. With a pool, each message is also split over its
+    worker threads. Message and header lengths must be multiples of `group_bytes`.
+    """
+
+    key_bytes: t.ClassVar[int]
+    nonce_bytes: t.ClassVar[int]
+    context_bytes: t.ClassVar[int]
+    group_bytes: t.ClassVar[int]
+    tag_bytes: t.ClassVar[int]
+
+    key_type: t.ClassVar[str]
+    key_init: t.ClassVar[t.Callable]
+    key_wipe: t.ClassVar[t.Callable]
+    encrypt_with_key: t.ClassVar[t.Callable]
+    decrypt_with_key: t.ClassVar[t.Callable]
+    encrypt_parallel_with_key: t.ClassVar[t.Callable]
+    decrypt_parallel_with_key: t.ClassVar[t.Callable]
+
+    def __init__(
+            self,
+            key: Buffer,
+            nonce: Buffer,
+            context: Buffer,
+            pool: AESBlakePool | None = None
+    ) -> None:
+        for name, data, length in [
+            ("key", key, self.key_bytes),
+            ("nonce", nonce, self.nonce_bytes),
+            ("context", context, self.context_bytes)
+        ]:
+            if memoryview(data).nbytes != length:
+                raise ValueError(f"Invalid {name} length, expected {length} bytes")
+
+        self.pool = pool
+        self._nonce = input_buffer(bytes(nonce))
+        self._key_obj, self._key_storage = aligned_new(self.key_type)
+        self.key_init(self._key_obj, input_buffer(key), input_buffer(context))
+
+    def __del__(self) -> None:
+        if getattr(self, "_key_obj", None) is not None:
+            self.key_wipe(self._key_obj)
+
+    def encrypt(self, plaintext: Buffer, header: Buffer) -> tuple[bytes, bytes]:
+        ciphertext = bytearray(memoryview(plaintext).nbytes)
+        auth_tag = bytearray(self.tag_bytes)
+        self.encrypt_into(plaintext, header, ciphertext, auth_tag)
+        return bytes(ciphertext), bytes(auth_tag)
+
+    def decrypt(self, ciphertext: Buffer, header: Buffer, auth_tag: Buffer) -> bytes:
+        plaintext = bytearray(memoryview(ciphertext).nbytes)
+        self.decrypt_into(ciphertext, header, auth_tag, plaintext)
+        return bytes(plaintext)
+
+    def encrypt_into(
+            self,
+            plaintext: Buffer,
+            header: Buffer,
+            ciphertext: Buffer,
+            auth_tag: Buffer
+    ) -> None:
+        """
+        Encrypts into preallocated writable buffers, such as a bytearray or a
+        memoryview slice of a larger buffer, without any allocation or copying.
+        """
+        src, hdr = input_buffer(plaintext), input_buffer(header)
+        dst, tag = output_buffer(ciphertext), output_buffer(auth_tag)
+        if len(dst) < len(src) or len(tag) < self.tag_bytes:
+            raise ValueError("Invalid output buffer length")
+
+        if self.pool is None:
+            status = self.encrypt_with_key(
+                self._key_obj, self._nonce, src, len(src), hdr, len(hdr), dst, tag
+            )
+        else:
+            with self.pool.handle() as pool:
+                status = self.encrypt_parallel_with_key(
+                    pool, self._key_obj, self._nonce,
+                    src, len(src), hdr, len(hdr), dst, tag
+                )
+        check_status(status)
+
+    def decrypt_into(
+            self,
+            ciphertext: Buffer,
+            header: Buffer,
+            auth_tag: Buffer,
+            plaintext: Buffer
+    ) -> None:
+        """
+        Decrypts into a preallocated writable buffer. Its first `len(ciphertext)`
+        bytes are zeroed before ValueError is raised for a forged or corrupted
+        message, an auth tag of the wrong length included, so they never hold
+        stale or unverified data. A buffer shorter than the ciphertext is
+        rejected before anything is written to it.
+        """
+        src, hdr, tag = input_buffer(ciphertext), input_buffer(header), input_buffer(auth_tag)
+        dst = output_buffer(plaintext)
+        if len(dst) < len(src):
+            raise ValueError("Invalid output buffer length")
+        if len(tag) != self.tag_bytes:
+            ffi.memmove(dst, bytes(len(src)), len(src))
+            raise ValueError("Failed to verify auth tag")
+
+        if self.pool is None:
+            status = self.decrypt_with_key(
+                self._key_obj, self._nonce, src, len(src), hdr, len(hdr), tag, dst
+            )
+        else:
+            with self.pool.handle() as pool:
+                status = self.decrypt_parallel_with_key(
+                    pool, self._key_obj, self._nonce,
+                    src, len(src), hdr, len(hdr), tag, dst
+                )
+        check_status(status)
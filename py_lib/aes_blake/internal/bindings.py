@@ -0,0 +1,72 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from __future__ import annotations
+
+import typing as t
+
+try:
+    from aes_blake.internal.bin._aes_blake import ffi, lib
+except ImportError as ex:  # pragma: no cover
+    msg = "The AES-Blake extension is not compiled, run `python scripts/build.py --compile`"
+    raise ImportError(msg) from ex
+
+__all__ = [
+    "ffi",
+    "lib",
+    "Buffer",
+    "input_buffer",
+    "output_buffer",
+    "aligned_new",
+    "check_status"
+]
+
+
+# Any object supporting the buffer protocol, such as bytes, bytearray or memoryview
+Buffer = t.Union[bytes, bytearray, memoryview]
+
+ALIGNMENT = 64
+
+
+def input_buffer(data: Buffer) -> t.Any:
+    """Borrows the memory of a contiguous buffer without copying it."""
+    return ffi.from_buffer("uint8_t[]", data)
+
+
+def output_buffer(data: Buffer) -> t.Any:
+    """
+    Borrows the memory of a writable contiguous buffer without copying it.
+    Raises TypeError for a read-only buffer, cffi leaves the error type of
+    `require_writable` to the buffer object.
+    """
+    if memoryview(data).readonly:
+        raise TypeError("Output buffer must be writable")
+    return ffi.from_buffer("uint8_t[]", data, require_writable=True)
+
+
+def aligned_new(ctype: str) -> tuple[t.Any, t.Any]:
+    """
+    Allocates a zeroed `ctype` on a cache line, as the key objects are declared
+    cache aligned and ffi.new only guarantees malloc alignment. Returns the
+    pointer and the owning storage, which must be kept alive with it.
+    """
+    storage = ffi.new("uint8_t[]", ffi.sizeof(ctype) + ALIGNMENT - 1)
+    offset = -int(ffi.cast("uintptr_t", storage)) % ALIGNMENT
+    return ffi.cast(f"{ctype} *", storage + offset), storage
+
+
+def check_status(status: int) -> None:
+    if status == lib.AESBlakeStatus_INVALID_LENGTH:
+        raise ValueError("Invalid input data length")
+    elif status == lib.AESBlakeStatus_AUTH_FAILED:
+        raise ValueError("Failed to verify auth tag")
+    elif status != lib.AESBlakeStatus_OK:
+        raise RuntimeError(f"AES-Blake call failed with status {status}")
@@ -0,0 +1,49 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from __future__ import annotations
+
+from aes_blake.base_aes_blake import BaseAESBlake
+from aes_blake.internal.bindings import lib
+
+__all__ = ["AESBlake256", "AESBlake512"]
+
+
+class AESBlake256(BaseAESBlake):
+    key_bytes = lib.AES_BLAKE256_KEY_BYTES
+    nonce_bytes = lib.AES_BLAKE256_NONCE_BYTES
+    context_bytes = lib.AES_BLAKE256_CONTEXT_BYTES
+    group_bytes = lib.AES_BLAKE256_GROUP_BYTES
+    tag_bytes = lib.AES_BLAKE256_TAG_BYTES
+
+    key_type = "AESBlake256Key"
+    key_init = staticmethod(lib.aes_blake256_key_init)
+    key_wipe = staticmethod(lib.aes_blake256_key_wipe)
+    encrypt_with_key = staticmethod(lib.aes_blake256_encrypt_with_key)
+    decrypt_with_key = staticmethod(lib.aes_blake256_decrypt_with_key)
+    encrypt_parallel_with_key = staticmethod(lib.aes_blake256_encrypt_parallel_with_key)
+    decrypt_parallel_with_key = staticmethod(lib.aes_blake256_decrypt_parallel_with_key)
+
+
+class AESBlake512(BaseAESBlake):
+    key_bytes = lib.AES_BLAKE512_KEY_BYTES
+    nonce_bytes = lib.AES_BLAKE512_NONCE_BYTES
+    context_bytes = lib.AES_BLAKE512_CONTEXT_BYTES
+    group_bytes = lib.AES_BLAKE512_GROUP_BYTES
+    tag_bytes = lib.AES_BLAKE512_TAG_BYTES
+
+    key_type = "AESBlake512Key"
+    key_init = staticmethod(lib.aes_blake512_key_init)
+    key_wipe = staticmethod(lib.aes_blake512_key_wipe)
+    encrypt_with_key = staticmethod(lib.aes_blake512_encrypt_with_key)
+    decrypt_with_key = staticmethod(lib.aes_blake512_decrypt_with_key)
+    encrypt_parallel_with_key = staticmethod(lib.aes_blake512_encrypt_parallel_with_key)
+    decrypt_parallel_with_key = staticmethod(lib.aes_blake512_decrypt_parallel_with_key)
@@ -10,13 +10,146 @@
 #
 
 import argparse
+import shutil
+import sys
+import tempfile
+from pathlib import Path
 from typing import Any
 from packaging import tags
 from hatchling.builders.hooks.plugin.interface import BuildHookInterface
 
+PY_LIB_DIR = Path(__file__).resolve().parents[1]
+C_LIB_DIR = PY_LIB_DIR.parent / "c_lib"
+BIN_DIR = PY_LIB_DIR / "aes_blake" / "internal" / "bin"
+MODULE_NAME = "aes_blake.internal.bin._aes_blake"
+C_LIB_MODULES = ["aes_block", "blake_keygen", "aes_blake", "tools"]
+
+
+# Subset of aes_blake.h and aes_blake_pool.h used by the bindings. The key
+# objects stay opaque, their size and layout are taken from the real headers.
+CDEFS = """
+    #define AES_BLAKE256_KEY_BYTES      32
+    #define AES_BLAKE256_NONCE_BYTES    32
+    #define AES_BLAKE256_CONTEXT_BYTES  64
+    #define AES_BLAKE256_GROUP_BYTES    32
+    #define AES_BLAKE256_TAG_BYTES      32
+
+    #define AES_BLAKE512_KEY_BYTES      64
+    #define AES_BLAKE512_NONCE_BYTES    64
+    #define AES_BLAKE512_CONTEXT_BYTES  128
+    #define AES_BLAKE512_GROUP_BYTES    64
+    #define AES_BLAKE512_TAG_BYTES      64
+
+    typedef enum {
+        AESBlakeStatus_OK = 0,
+        AESBlakeStatus_INVALID_LENGTH = 1,
+        AESBlakeStatus_AUTH_FAILED = 2,
+        AESBlakeStatus_INVALID_STATE = 3,
+        AESBlakeStatus_IO_ERROR = 4
+    } AESBlakeStatus;
+
+    typedef struct { ...; } AESBlake256Key;
+    typedef struct { ...; } AESBlake512Key;
+    typedef struct AESBlakePool AESBlakePool;
+
+    AESBlakePool *aes_blake_pool_create(size_t thread_count);
+    void aes_blake_pool_destroy(AESBlakePool *pool);
+    size_t aes_blake_pool_thread_count(const AESBlakePool *pool);
+
+    void aes_blake256_key_init(AESBlake256Key *key_obj, const uint8_t key[], const uint8_t context[]);
+    void aes_blake256_key_wipe(AESBlake256Key *key_obj);
+    AESBlakeStatus aes_blake256_encrypt_with_key(
+        const AESBlake256Key *key_obj, const uint8_t nonce[],
+        const uint8_t plaintext[], size_t plaintext_len, const uint8_t header[], size_t header_len,
+        uint8_t ciphertext[], uint8_t auth_tag[]
+    );
+    AESBlakeStatus aes_blake256_decrypt_with_key(
+        const AESBlake256Key *key_obj, const uint8_t nonce[],
+        const uint8_t ciphertext[], size_t ciphertext_len, const uint8_t header[], size_t header_len,
+        const uint8_t auth_tag[], uint8_t plaintext[]
+    );
+    AESBlakeStatus aes_blake256_encrypt_parallel_with_key(
+        AESBlakePool *pool, const AESBlake256Key *key_obj, const uint8_t nonce[],
+        const uint8_t plaintext[], size_t plaintext_len, const uint8_t header[], size_t header_len,
+        uint8_t ciphertext[], uint8_t auth_tag[]
+    );
+    AESBlakeStatus aes_blake256_decrypt_parallel_with_key(
+        AESBlakePool *pool, const AESBlake256Key *key_obj, const uint8_t nonce[],
+        const uint8_t ciphertext[], size_t ciphertext_len, const uint8_t header[], size_t header_len,
+        const uint8_t auth_tag[], uint8_t plaintext[]
+    );
+
+    void aes_blake512_key_init(AESBlake512Key *key_obj, const uint8_t key[], const uint8_t context[]);
+    void aes_blake512_key_wipe(AESBlake512Key *key_obj);
+    AESBlakeStatus aes_blake512_encrypt_with_key(
+        const AESBlake512Key *key_obj, const uint8_t nonce[],
+        const uint8_t plaintext[], size_t plaintext_len, const uint8_t header[], size_t header_len,
+        uint8_t ciphertext[], uint8_t auth_tag[]
+    );
+    AESBlakeStatus aes_blake512_decrypt_with_key(
+        const AESBlake512Key *key_obj, const uint8_t nonce[],
+        const uint8_t ciphertext[], size_t ciphertext_len, const uint8_t header[], size_t header_len,
+        const uint8_t auth_tag[], uint8_t plaintext[]
+    );
+    AESBlakeStatus aes_blake512_encrypt_parallel_with_key(
+        AESBlakePool *pool, const AESBlake512Key *key_obj, const uint8_t nonce[],
+        const uint8_t plaintext[], size_t plaintext_len, const uint8_t header[], size_t header_len,
+        uint8_t ciphertext[], uint8_t auth_tag[]
+    );
+    AESBlakeStatus aes_blake512_decrypt_parallel_with_key(
+        AESBlakePool *pool, const AESBlake512Key *key_obj, const uint8_t nonce[],
+        const uint8_t ciphertext[], size_t ciphertext_len, const uint8_t header[], size_t header_len,
+        const uint8_t auth_tag[], uint8_t plaintext[]
+    );
+"""
+
+SOURCE = """
+    #include "aes_blake.h"
+    #include "aes_blake_pool.h"
+"""
+
+
+def compile_extension() -> Path:
+    """
+    Compiles the C library into a CFFI extension module and copies it into
+    aes_blake/internal/bin. CFFI releases the GIL around every call into it.
+    """
+    from cffi import FFI
+
+    if not C_LIB_DIR.is_dir():
+        raise FileNotFoundError(f"C library sources not found at {C_LIB_DIR}")
+
+    if sys.platform == "win32":
+        compile_args = ["/O2", "/std:c11"]
+        link_args = []
+        libraries = ["bcrypt"]
+    else:
+        compile_args = ["-O3", "-std=gnu11", "-pthread"]
+        link_args = ["-pthread"]
+        libraries = []
+
+    ffibuilder = FFI()
+    ffibuilder.cdef(CDEFS)
+    ffibuilder.set_source(
+        MODULE_NAME,
+        SOURCE,
+        sources=sorted(str(path) for module in C_LIB_MODULES for path in (C_LIB_DIR / module).glob("*.c")),
+        include_dirs=[str(C_LIB_DIR / module) for module in C_LIB_MODULES],
+        extra_compile_args=compile_args,
+        extra_link_args=link_args,
+        libraries=libraries,
+    )
+    BIN_DIR.mkdir(parents=True, exist_ok=True)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        built = Path(ffibuilder.compile(tmpdir=tmpdir))
+        target = BIN_DIR / built.name
+        shutil.copy2(built, target)
+    return target
+
 
 class CustomBuildHook(BuildHookInterface):
     def initialize(self, version: str, build_data: dict[str, Any]) -> None:
+        compile_extension()
         first_tag = list(tags.sys_tags())[0]
         build_data["pure_python"] = False
         build_data["infer_tag"] = False
@@ -33,4 +166,4 @@ if __name__ == "__main__":
     args = parser.parse_args()
 
     if args.compile:
-        raise NotImplementedError()
+        print(f"Compiled {compile_extension()}")
@@ -0,0 +1,17 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+import build
+
+
+def pytest_configure(config):
+    if not any(build.BIN_DIR.glob("_aes_blake.*")):
+        build.compile_extension()
@@ -0,0 +1,180 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+import secrets
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from aes_blake import AESBlake256, AESBlake512, AESBlakePool
+
+__all__ = [
+    "test_buffer_types",
+    "test_encrypt_decrypt_into_slices",
+    "test_forged_message_zeroes_output",
+    "test_invalid_lengths",
+    "test_read_only_output_buffers",
+    "test_pool_matches_single_thread",
+    "test_threads_share_cipher",
+    "test_closed_pool",
+    "test_close_waits_for_calls_in_flight",
+]
+
+
+def create_cipher(cls, pool=None):
+    key = secrets.token_bytes(cls.key_bytes)
+    nonce = secrets.token_bytes(cls.nonce_bytes)
+    context = secrets.token_bytes(cls.context_bytes)
+    return cls(key, nonce, context, pool), (key, nonce, context)
+
+
+@pytest.mark.parametrize("cls", [AESBlake256, AESBlake512])
+def test_buffer_types(cls):
+    cipher, _ = create_cipher(cls)
+    plaintext = secrets.token_bytes(cls.group_bytes * 5)
+    header = secrets.token_bytes(cls.group_bytes)
+    ciphertext, auth_tag = cipher.encrypt(plaintext, header)
+
+    for convert in [bytes, bytearray, memoryview]:
+        assert cipher.encrypt(convert(plaintext), convert(header)) == (ciphertext, auth_tag)
+        assert cipher.decrypt(convert(ciphertext), convert(header), convert(auth_tag)) == plaintext
+    assert cipher.encrypt(b"", b"") == cipher.encrypt(bytearray(), memoryview(b""))
+
+
+@pytest.mark.parametrize("cls", [AESBlake256, AESBlake512])
+def test_encrypt_decrypt_into_slices(cls):
+    cipher, _ = create_cipher(cls)
+    packet = bytearray(secrets.token_bytes(8 + cls.group_bytes * 3))
+    header = memoryview(packet)[:8 + cls.group_bytes][8:]
+    plaintext = memoryview(packet)[8 + cls.group_bytes:]
+    expected_ct, expected_tag = cipher.encrypt(plaintext, header)
+
+    frame = bytearray(len(plaintext) + cls.tag_bytes + 3)
+    view = memoryview(frame)
+    cipher.encrypt_into(plaintext, header, view[3:3 + len(plaintext)], view[3 + len(plaintext):])
+    assert bytes(view[3:3 + len(plaintext)]) == expected_ct
+    assert bytes(view[3 + len(plaintext):]) == expected_tag
+
+    output = bytearray(len(plaintext))
+    cipher.decrypt_into(view[3:3 + len(plaintext)], header, view[3 + len(plaintext):], output)
+    assert output == plaintext
+
+
+@pytest.mark.parametrize("cls", [AESBlake256, AESBlake512])
+def test_forged_message_zeroes_output(cls):
+    cipher, _ = create_cipher(cls)
+    plaintext = secrets.token_bytes(cls.group_bytes * 2)
+    ciphertext, auth_tag = cipher.encrypt(plaintext, b"")
+    forged = bytearray(ciphertext)
+    forged[0] ^= 0x01
+
+    output = bytearray(b"\xFF" * len(plaintext))
+    with pytest.raises(ValueError, match="Failed to verify auth tag"):
+        cipher.decrypt_into(forged, b"", auth_tag, output)
+    assert output == bytes(len(plaintext))
+
+    output = bytearray(b"\xFF" * len(plaintext))
+    with pytest.raises(ValueError, match="Failed to verify auth tag"):
+        cipher.decrypt_into(ciphertext, b"", auth_tag[:-1], output)
+    assert output == bytes(len(plaintext))
+
+
+@pytest.mark.parametrize("cls", [AESBlake256, AESBlake512])
+def test_invalid_lengths(cls):
+    cipher, (key, nonce, context) = create_cipher(cls)
+    with pytest.raises(ValueError, match="Invalid key length"):
+        cls(key[:-1], nonce, context)
+    with pytest.raises(ValueError, match="Invalid nonce length"):
+        cls(key, nonce + b"\x00", context)
+    with pytest.raises(ValueError, match="Invalid context length"):
+        cls(key, nonce, b"")
+
+    with pytest.raises(ValueError, match="Invalid input data length"):
+        cipher.encrypt(bytes(cls.group_bytes + 1), b"")
+    with pytest.raises(ValueError, match="Invalid input data length"):
+        cipher.encrypt(b"", bytes(1))
+    with pytest.raises(ValueError, match="Invalid output buffer length"):
+        cipher.encrypt_into(bytes(cls.group_bytes), b"", bytearray(cls.group_bytes - 1), bytearray(cls.tag_bytes))
+    with pytest.raises(ValueError, match="Invalid output buffer length"):
+        cipher.encrypt_into(bytes(cls.group_bytes), b"", bytearray(cls.group_bytes), bytearray(1))
+
+
+def test_read_only_output_buffers():
+    cipher, _ = create_cipher(AESBlake256)
+    plaintext = bytes(AESBlake256.group_bytes)
+    with pytest.raises(TypeError):
+        cipher.encrypt_into(plaintext, b"", bytes(len(plaintext)), bytearray(AESBlake256.tag_bytes))
+    with pytest.raises(TypeError):
+        cipher.encrypt_into(plaintext, b"", bytearray(len(plaintext)), memoryview(bytes(64)))
+
+
+@pytest.mark.parametrize("cls", [AESBlake256, AESBlake512])
+def test_pool_matches_single_thread(cls):
+    _, inputs = create_cipher(cls)
+    plaintext = secrets.token_bytes(1 << 20)
+    header = secrets.token_bytes(cls.group_bytes * 4)
+    expected = cls(*inputs).encrypt(plaintext, header)
+
+    with AESBlakePool(3) as pool:
+        cipher = cls(*inputs, pool=pool)
+        assert pool.thread_count == 3
+        assert cipher.encrypt(plaintext, header) == expected
+        assert cipher.decrypt(*expected[:1], header, expected[1]) == plaintext
+
+
+def test_threads_share_cipher():
+    cipher, _ = create_cipher(AESBlake512)
+    messages = [secrets.token_bytes(AESBlake512.group_bytes * (i + 64)) for i in range(32)]
+    expected = [cipher.encrypt(message, b"") for message in messages]
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(lambda message: cipher.encrypt(message, b""), messages))
+    assert results == expected
+
+
+def test_closed_pool():
+    pool = AESBlakePool(1)
+    cipher, _ = create_cipher(AESBlake256, pool)
+    pool.close()
+    pool.close()
+    with pytest.raises(ValueError, match="pool is closed"):
+        cipher.encrypt(bytes(AESBlake256.group_bytes), b"")
+    with pytest.raises(ValueError, match="cannot be negative"):
+        AESBlakePool(-1)
+
+
+def test_close_waits_for_calls_in_flight():
+    pool = AESBlakePool(2)
+    cipher, inputs = create_cipher(AESBlake256, pool)
+    plaintext = secrets.token_bytes(8 << 20)
+    expected = AESBlake256(*inputs).encrypt(plaintext, b"")
+    started = threading.Barrier(5)
+    results, errors = [], []
+
+    def worker():
+        started.wait()
+        while True:
+            try:
+                results.append(cipher.encrypt(plaintext, b""))
+            except ValueError as ex:
+                errors.append(ex)
+                return
+
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    started.wait()
+    pool.close()
+    for thread in threads:
+        thread.join()
+    assert all(result == expected for result in results)
+    assert len(errors) == 4 and all("pool is closed" in str(ex) for ex in errors)
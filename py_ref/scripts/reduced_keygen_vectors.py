@@ -0,0 +1,55 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Prints the reduced keygen profile vectors of
+c_lib/tests/test_blake_keygen/test_blake_derive_keys_reduced.cpp,
+run from the py_ref directory with `python -m scripts.reduced_keygen_vectors`.
+"""
+
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from src.blake_keygen import KDFDomain, ReducedBlake32, ReducedBlake64  # noqa: E402
+
+KEY_COUNT = 11
+VECTOR_ROUNDS = (0, 1, 10)
+VECTOR_INPUTS = (
+    (KDFDomain.MSG, 0, "0ULL"),
+    (KDFDomain.HDR, 1, "1ULL"),
+    (KDFDomain.CHK, 0x100000002, "0x100000002ULL"),
+)
+
+
+def format_vectors(cls: type, name: str, streams: int) -> str:
+    keygen = cls(key=b"", nonce=b"", context=b"")
+    keygen.digest_context()
+    lines = [f"static const ReducedVector<{streams}> {name}[] = {{"]
+    for domain, counter, counter_literal in VECTOR_INPUTS:
+        stream_keys = keygen.derive_keys(KEY_COUNT, counter, domain)
+        lines.append(f"    {{KDFDomain_{domain.name}, {counter_literal}, {{")
+        for keys in stream_keys:
+            lines.append("        {")
+            for i in VECTOR_ROUNDS:
+                key = ", ".join(f"0x{int(b):02X}" for b in keys[i])
+                lines.append(f"            {{{key}}},")
+            lines.append("        },")
+        lines.append("    }},")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+if __name__ == "__main__":
+    print(format_vectors(ReducedBlake32, "reduced32_vectors", 2))
+    print("\n")
+    print(format_vectors(ReducedBlake64, "reduced64_vectors", 4))
@@ -13,6 +13,7 @@ from src.blake_keygen.base_blake_keygen import (AnyUintList, BaseBlake,
                                                 KDFDomain, RoundKeys)
 from src.blake_keygen.clean_blake_keygen import Blake32, Blake64
 from src.blake_keygen.masked_blake_keygen import MaskedBlake32, MaskedBlake64
+from src.blake_keygen.reduced_blake_keygen import ReducedBlake32, ReducedBlake64
 from src.blake_keygen.with_derive_keys import (WithDeriveKeys32,
                                                WithDeriveKeys64)
 
@@ -26,5 +27,7 @@ __all__ = [
     "WithDeriveKeys32",
     "WithDeriveKeys64",
     "MaskedBlake32",
-    "MaskedBlake64"
+    "MaskedBlake64",
+    "ReducedBlake32",
+    "ReducedBlake64"
 ]
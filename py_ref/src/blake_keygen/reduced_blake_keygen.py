@@ -0,0 +1,117 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from __future__ import annotations
+
+from copy import deepcopy
+
+from src.blake_keygen.base_blake_keygen import BaseBlake, KDFDomain, RoundKeys
+from src.blake_keygen.clean_blake_keygen import Blake32, Blake64
+from src.integers import Uint8
+
+__all__ = ["ReducedBlake32", "ReducedBlake64"]
+
+
+class ReducedBlake32(Blake32):
+    """
+    Version 1 of the reduced keygen profile, the reference of the C
+    `blake32_*_derive_keys_reduced` kernels. Every mix step yields two round
+    keys: the even key from state words 4–7 as in the standard profile and the
+    odd key from the BLAKE3 output fold of words 0–3 with words 8–11.
+    The profile mask "RD01" XORed into words 12–15 keeps its keys apart
+    from the standard profile.
+    """
+    profile_mask = 0x52443031
+
+    def derive_keys(
+            self, key_count: int, block_counter: int, domain: KDFDomain
+    ) -> list[RoundKeys]:
+        ent_src = deepcopy(self)
+        entropy_1 = ent_src.state[0:4] + ent_src.state[8:12]
+        entropy_2 = ent_src.state[4:8] + ent_src.state[12:16]
+        blocks_round_keys: list[RoundKeys] = [[], []]
+
+        for i, entropy in enumerate([entropy_1, entropy_2]):
+            keygen = deepcopy(self)
+            init_reduced_state(keygen, entropy, block_counter, domain)
+            round_keys = blocks_round_keys[i]
+
+            while True:
+                keygen.mix_into_state(keygen.knc)
+                round_keys.append(words_to_key(keygen.state[4:8]))
+                if len(round_keys) == key_count:
+                    break
+                round_keys.append(words_to_key(folded_words(keygen)))
+                if len(round_keys) == key_count:
+                    break
+                keygen.knc = keygen.permute(keygen.knc)
+
+        return blocks_round_keys
+
+
+class ReducedBlake64(Blake64):
+    """
+    Version 1 of the reduced keygen profile for the 64-bit variant, the
+    reference of the C `blake64_*_derive_keys_reduced` kernels. Both halves
+    of the even key words 4–7 and of the folded words feed two streams.
+    """
+    profile_mask = 0x5244303152443031
+
+    def derive_keys(
+            self, key_count: int, block_counter: int, domain: KDFDomain
+    ) -> list[RoundKeys]:
+        ent_src = deepcopy(self)
+        entropy_1 = ent_src.state[0:4] + ent_src.state[8:12]
+        entropy_2 = ent_src.state[4:8] + ent_src.state[12:16]
+        group1 = (entropy_1, [], [])
+        group2 = (entropy_2, [], [])
+
+        for entropy, b1_round_keys, b2_round_keys in [group1, group2]:
+            keygen = deepcopy(self)
+            init_reduced_state(keygen, entropy, block_counter, domain)
+
+            while True:
+                keygen.mix_into_state(keygen.knc)
+                b1_round_keys.append(words_to_key(keygen.state[4:6]))
+                b2_round_keys.append(words_to_key(keygen.state[6:8]))
+                if len(b1_round_keys) == key_count:
+                    break
+                folded = folded_words(keygen)
+                b1_round_keys.append(words_to_key(folded[0:2]))
+                b2_round_keys.append(words_to_key(folded[2:4]))
+                if len(b1_round_keys) == key_count:
+                    break
+                keygen.knc = keygen.permute(keygen.knc)
+
+        _, keys1, keys2 = group1
+        _, keys3, keys4 = group2
+
+        return [keys1, keys2, keys3, keys4]
+
+
+def init_reduced_state(
+        keygen: ReducedBlake32 | ReducedBlake64,
+        entropy: list,
+        block_counter: int,
+        domain: KDFDomain
+) -> None:
+    keygen.init_state_vector(entropy, block_counter, domain)
+    profile_mask = keygen.create_uint(keygen.profile_mask)
+    for i in range(12, 16):
+        keygen.state[i] ^= profile_mask
+
+
+def folded_words(keygen: BaseBlake) -> list:
+    return [keygen.state[i] ^ keygen.state[8 + i] for i in range(4)]
+
+
+def words_to_key(words: list) -> list[Uint8]:
+    return [Uint8(b) for v in words for b in v.to_bytes()]
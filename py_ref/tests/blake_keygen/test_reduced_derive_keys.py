@@ -0,0 +1,68 @@
+#
+#   Apache License 2.0
+#
+#   Copyright (c) 2024, Mattias Aabmets
+#
+#   The contents of this file are subject to the terms and conditions defined in the License.
+#   You may not use, modify, or distribute this file except in compliance with the License.
+#
+#   SPDX-License-Identifier: Apache-2.0
+#
+
+from src.blake_keygen import (Blake32, Blake64, KDFDomain, ReducedBlake32,
+                              ReducedBlake64)
+
+__all__ = [
+    "test_reduced_blake32_derive_keys",
+    "test_reduced_blake64_derive_keys"
+]
+
+
+def get_blake_keygen(cls):
+    blake = cls(key=b'', nonce=b'', context=b'')
+    blake.digest_context()
+    return blake
+
+
+def test_reduced_blake32_derive_keys():
+    standard = get_blake_keygen(Blake32).derive_keys(11, 0, KDFDomain.MSG)
+    reduced = get_blake_keygen(ReducedBlake32).derive_keys(11, 0, KDFDomain.MSG)
+
+    assert [len(keys) for keys in reduced] == [11, 11]
+    assert reduced[0][0] == [
+        0xAC, 0x93, 0x64, 0x75,
+        0x73, 0xE8, 0xFE, 0x6A,
+        0x5D, 0x2D, 0x0F, 0xA2,
+        0xD6, 0xEA, 0x9C, 0x8D,
+    ]
+    assert reduced[1][10] == [
+        0x01, 0x2A, 0x91, 0xC1,
+        0x85, 0xE5, 0x66, 0xA4,
+        0xAC, 0xC9, 0xBD, 0x95,
+        0xAE, 0x81, 0x36, 0x9A,
+    ]
+    assert all(a != b for s, r in zip(standard, reduced) for a, b in zip(s, r))
+
+    # A key count cut short keeps the leading keys
+    assert get_blake_keygen(ReducedBlake32).derive_keys(4, 0, KDFDomain.MSG)[1] == reduced[1][:4]
+
+
+def test_reduced_blake64_derive_keys():
+    standard = get_blake_keygen(Blake64).derive_keys(11, 0, KDFDomain.MSG)
+    reduced = get_blake_keygen(ReducedBlake64).derive_keys(11, 0, KDFDomain.MSG)
+
+    assert [len(keys) for keys in reduced] == [11, 11, 11, 11]
+    assert reduced[0][0] == [
+        0x34, 0x89, 0xB0, 0xCC,
+        0xBC, 0x2E, 0x6F, 0xAB,
+        0xFC, 0xBB, 0xB3, 0x42,
+        0xEF, 0xBF, 0x63, 0x7F,
+    ]
+    assert reduced[0][1] == [
+        0x8E, 0xC9, 0x75, 0x73,
+        0x5A, 0x7E, 0x5A, 0xB8,
+        0x29, 0xB9, 0x1B, 0x47,
+        0x9C, 0xD5, 0x59, 0x62,
+    ]
+    assert all(a != b for s, r in zip(standard, reduced) for a, b in zip(s, r))
+    assert get_blake_keygen(ReducedBlake64).derive_keys(4, 0, KDFDomain.MSG)[3] == reduced[3][:4]